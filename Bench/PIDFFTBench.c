@@ -0,0 +1,132 @@
+//
+//  PIDFFTBench.c
+//  PID_Liner
+//
+//  可移植FFT后端基准：各长度的实数正/逆变换耗时，以及与直接DFT的误差
+//  窗口长度覆盖分析中实际出现的情况：2的幂、1秒窗口（8000 = 2^6·5^3）、补零后的快速长度和质数长度（Bluestein）
+//
+
+#define _POSIX_C_SOURCE 199309L
+
+#include "PIDFFTPlan.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+static const double kBenchPi = 3.14159265358979323846;
+
+// 每个长度的计时至少持续的时间（秒）
+static const double kBenchMinSeconds = 0.2;
+
+static double PIDBenchNow(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+/**
+ * 直接DFT（O(n²)）的最大误差，只检查前若干个频点以控制耗时
+ */
+static double PIDBenchMaxError(const double *input, const double *outReal, const double *outImag, size_t n) {
+    size_t bins = n / 2 + 1 < 64 ? n / 2 + 1 : 64;
+    double maxError = 0.0;
+    for (size_t k = 0; k < bins; k++) {
+        double re = 0.0;
+        double im = 0.0;
+        for (size_t j = 0; j < n; j++) {
+            double angle = -2.0 * kBenchPi * (double)((k * j) % n) / (double)n;
+            re += input[j] * cos(angle);
+            im += input[j] * sin(angle);
+        }
+        double error = hypot(outReal[k] - re, outImag[k] - im);
+        maxError = error > maxError ? error : maxError;
+    }
+    return maxError;
+}
+
+static int PIDBenchLength(size_t n) {
+    const PIDFFTPlan *plan = PIDFFTPlanForLength(n, PIDFFTBackendPortable);
+    double *input = malloc(n * sizeof(double));
+    double *output = malloc(n * sizeof(double));
+    double *outReal = malloc((n / 2 + 1) * sizeof(double));
+    double *outImag = malloc((n / 2 + 1) * sizeof(double));
+    if (!plan || !input || !output || !outReal || !outImag) {
+        fprintf(stderr, "长度%zu: 计划或内存分配失败\n", n);
+        free(input);
+        free(output);
+        free(outReal);
+        free(outImag);
+        return 1;
+    }
+
+    srand(1234);
+    for (size_t i = 0; i < n; i++) {
+        input[i] = (double)rand() / RAND_MAX - 0.5;
+    }
+
+    int status = 0;
+    if (!PIDFFTRealForward(plan, input, outReal, outImag) ||
+        !PIDFFTRealInverse(plan, outReal, outImag, output)) {
+        fprintf(stderr, "长度%zu: 变换失败\n", n);
+        status = 1;
+    }
+
+    double dftError = PIDBenchMaxError(input, outReal, outImag, n);
+    double roundTripError = 0.0;
+    for (size_t i = 0; i < n; i++) {
+        double error = fabs(output[i] - input[i]);
+        roundTripError = error > roundTripError ? error : roundTripError;
+    }
+
+    // 正逆变换交替执行，直到累计时间超过下限
+    size_t iterations = 0;
+    double start = PIDBenchNow();
+    double elapsed = 0.0;
+    while (elapsed < kBenchMinSeconds) {
+        for (int i = 0; i < 16; i++) {
+            PIDFFTRealForward(plan, input, outReal, outImag);
+            PIDFFTRealInverse(plan, outReal, outImag, output);
+        }
+        iterations += 16;
+        elapsed = PIDBenchNow() - start;
+    }
+
+    double microseconds = elapsed / (double)iterations * 1e6;
+    printf("%8zu  %10.2f  %10.1f  %10.2e  %10.2e\n",
+           n, microseconds, (double)n / microseconds, dftError, roundTripError);
+
+    if (dftError > 1e-9 * (double)n || roundTripError > 1e-12 * (double)n) {
+        status = 1;
+    }
+
+    free(input);
+    free(output);
+    free(outReal);
+    free(outImag);
+    return status;
+}
+
+int main(int argc, char **argv) {
+    static const size_t kDefaultLengths[] = { 1024, 1000, 2000, 4096, 8000, 8192, 16000, 16384, 7919 };
+
+    printf("后端: %s\n", PIDFFTBackendName(PIDFFTBackendPortable));
+    printf("%8s  %10s  %10s  %10s  %10s\n", "长度", "正+逆(us)", "点/us", "DFT误差", "往返误差");
+
+    int status = 0;
+    if (argc > 1) {
+        for (int i = 1; i < argc; i++) {
+            status |= PIDBenchLength((size_t)strtoul(argv[i], NULL, 10));
+        }
+    } else {
+        for (size_t i = 0; i < sizeof(kDefaultLengths) / sizeof(kDefaultLengths[0]); i++) {
+            status |= PIDBenchLength(kDefaultLengths[i]);
+        }
+    }
+
+    if (status != 0) {
+        fprintf(stderr, "❌ 存在超出误差范围或失败的长度\n");
+    }
+    return status;
+}
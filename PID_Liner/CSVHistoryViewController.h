@@ -9,6 +9,8 @@
 
 NS_ASSUME_NONNULL_BEGIN
 
+@class PIDSessionCatalogEntry;
+
 // CSV记录模型
 @interface CSVRecord : NSObject
 
@@ -19,6 +21,9 @@ NS_ASSUME_NONNULL_BEGIN
 @property (nonatomic, strong) NSDate *createTime;       // 创建时间
 @property (nonatomic, assign) NSInteger fileSize;       // 文件大小(字节)
 @property (nonatomic, assign) NSInteger lineCount;      // 行数
+@property (nonatomic, assign) double durationSeconds;   // 时长(秒)
+@property (nonatomic, assign) double sampleRate;        // 采样率(Hz)
+@property (nonatomic, copy, nullable) NSDictionary<NSString *, NSNumber *> *metrics; // 分析摘要指标
 
 // 便捷初始化方法
 - (instancetype)initWithFileName:(NSString *)fileName
@@ -26,6 +31,9 @@ NS_ASSUME_NONNULL_BEGIN
                        sourceBBL:(NSString *)sourceBBL
                     sessionIndex:(NSInteger)sessionIndex;
 
+// 从Session目录条目初始化（不访问文件系统）
+- (instancetype)initWithCatalogEntry:(PIDSessionCatalogEntry *)entry;
+
 // 格式化文件大小
 - (NSString *)formattedFileSize;
 
@@ -7,6 +7,13 @@
 
 #import "CSVHistoryViewController.h"
 #import "PIDAnalysisViewController.h"
+#import "PIDSessionCatalog.h"
+
+// 每页从Session目录读取的条数
+static const NSInteger kHistoryPageSize = 50;
+
+// 距离列表末尾多少行时预取下一页
+static const NSInteger kHistoryPrefetchThreshold = 10;
 
 #pragma mark - CSVRecord Implementation
 
@@ -32,6 +39,23 @@
     return self;
 }
 
+- (instancetype)initWithCatalogEntry:(PIDSessionCatalogEntry *)entry {
+    self = [super init];
+    if (self) {
+        _fileName = entry.fileName;
+        _filePath = entry.filePath;
+        _sourceBBL = entry.sourceBBL;
+        _sessionIndex = entry.sessionIndex;
+        _createTime = entry.createTime;
+        _fileSize = (NSInteger)entry.fileSize;
+        _lineCount = entry.rowCount + 1;  // 与loadFileInfo一致，包含表头
+        _durationSeconds = entry.durationSeconds;
+        _sampleRate = entry.sampleRate;
+        _metrics = entry.metrics;
+    }
+    return self;
+}
+
 - (void)loadFileInfo {
     NSFileManager *fm = [NSFileManager defaultManager];
     NSDictionary *attrs = [fm attributesOfItemAtPath:_filePath error:nil];
@@ -104,6 +128,17 @@
 
 @interface CSVHistoryViewController ()
 @property (nonatomic, strong) UILabel *emptyLabel;
+
+// 分页状态
+@property (nonatomic, assign) NSInteger totalRecordCount;
+@property (nonatomic, assign) BOOL loadingPage;
+
+// 下一页在目录中的偏移：由已读取的条数累计，本地增删记录时按目录中对应的移动调整，
+// 不使用 csvRecords.count（分页查询进行中插入的记录会使两者错开）
+@property (nonatomic, assign) NSInteger catalogOffset;
+
+// 每次重新加载递增，用于丢弃过期的分页回调
+@property (nonatomic, assign) NSUInteger pageGeneration;
 @end
 
 @implementation CSVHistoryViewController
@@ -167,49 +202,63 @@
 
 #pragma mark - Data Management
 
+/**
+ * 加载历史记录
+ * 先从Session目录读第一页立即显示，再让后台索引器同步磁盘，有变化时重新读第一页
+ */
 - (void)loadExistingCSVFiles {
-    NSArray *paths = NSSearchPathForDirectoriesInDomains(NSDocumentDirectory, NSUserDomainMask, YES);
-    NSString *documentsDir = [paths firstObject];
+    [self reloadFirstPage];
 
-    NSFileManager *fm = [NSFileManager defaultManager];
-    NSArray *files = [fm contentsOfDirectoryAtPath:documentsDir error:nil];
+    __weak typeof(self) weakSelf = self;
+    [[PIDSessionCatalog sharedCatalog] refreshIndexWithCompletion:^(NSInteger changedCount) {
+        if (changedCount > 0) {
+            [weakSelf reloadFirstPage];
+        }
+    }];
+}
 
+- (void)reloadFirstPage {
+    self.pageGeneration++;
+    self.loadingPage = NO;
     [_csvRecords removeAllObjects];
+    self.totalRecordCount = 0;
+    self.catalogOffset = 0;
+    [self loadNextPage];
+}
 
-    for (NSString *file in files) {
-        if ([file.pathExtension.lowercaseString isEqualToString:@"csv"]) {
-            NSString *fullPath = [documentsDir stringByAppendingPathComponent:file];
-
-            // 解析文件名获取源BBL和Session信息
-            // 格式: {源文件}_{日期}_{时间戳}_session{N}.csv
-            NSString *baseName = [file stringByDeletingPathExtension];
-            NSArray *parts = [baseName componentsSeparatedByString:@"_session"];
-
-            NSString *sourceBBL = @"未知";
-            NSInteger sessionIndex = 0;
+/**
+ * 读取下一页（主线程调用，查询在目录队列执行）
+ */
+- (void)loadNextPage {
+    if (self.loadingPage) {
+        return;
+    }
+    self.loadingPage = YES;
+
+    NSUInteger generation = self.pageGeneration;
+    __weak typeof(self) weakSelf = self;
+    [[PIDSessionCatalog sharedCatalog] fetchEntriesWithOffset:self.catalogOffset
+                                                        limit:kHistoryPageSize
+                                                   completion:^(NSArray<PIDSessionCatalogEntry *> *entries, NSInteger totalCount) {
+        __strong typeof(weakSelf) strongSelf = weakSelf;
+        if (!strongSelf || generation != strongSelf.pageGeneration) {
+            return;
+        }
 
-            if (parts.count >= 2) {
-                sourceBBL = parts[0];
-                sessionIndex = [parts[1] integerValue];
-            } else {
-                sourceBBL = baseName;
+        // 查询与本地插入交错时，本页可能包含刚插入到列表头部的文件：按路径去重
+        NSSet<NSString *> *loadedPaths = [NSSet setWithArray:[strongSelf.csvRecords valueForKey:@"filePath"]];
+        for (PIDSessionCatalogEntry *entry in entries) {
+            if (![loadedPaths containsObject:entry.filePath]) {
+                [strongSelf.csvRecords addObject:[[CSVRecord alloc] initWithCatalogEntry:entry]];
             }
-
-            CSVRecord *record = [[CSVRecord alloc] initWithFileName:file
-                                                           filePath:fullPath
-                                                          sourceBBL:sourceBBL
-                                                       sessionIndex:sessionIndex];
-            [_csvRecords addObject:record];
         }
-    }
+        strongSelf.catalogOffset += entries.count;
+        strongSelf.totalRecordCount = totalCount;
+        strongSelf.loadingPage = NO;
 
-    // 按创建时间倒序排列
-    [_csvRecords sortUsingComparator:^NSComparisonResult(CSVRecord *obj1, CSVRecord *obj2) {
-        return [obj2.createTime compare:obj1.createTime];
+        [strongSelf updateEmptyState];
+        [strongSelf.tableView reloadData];
     }];
-
-    [self updateEmptyState];
-    [_tableView reloadData];
 }
 
 - (void)reloadData {
@@ -217,7 +266,17 @@
 }
 
 - (void)addRecord:(CSVRecord *)record {
+    // 同一文件重新转换时替换已有的记录；新文件索引后排在目录最前，
+    // 之后提交的分页查询都在索引之后执行（目录队列串行），偏移后移一位
+    NSUInteger existingIndex = [[_csvRecords valueForKey:@"filePath"] indexOfObject:record.filePath];
+    if (existingIndex != NSNotFound) {
+        [_csvRecords removeObjectAtIndex:existingIndex];
+    } else {
+        self.totalRecordCount++;
+        self.catalogOffset++;
+    }
     [_csvRecords insertObject:record atIndex:0];
+    [[PIDSessionCatalog sharedCatalog] indexFileAtPath:record.filePath];
     [self updateEmptyState];
     [_tableView reloadData];
 }
@@ -242,19 +301,26 @@
 }
 
 - (void)performClearAll {
-    NSFileManager *fm = [NSFileManager defaultManager];
-
-    for (CSVRecord *record in _csvRecords) {
-        NSError *error = nil;
-        [fm removeItemAtPath:record.filePath error:&error];
-        if (error) {
-            NSLog(@"❌ 删除文件失败: %@", error.localizedDescription);
-        }
-    }
-
+    // 已加载的只是当前页，全部文件以Session目录为准
+    self.pageGeneration++;
     [_csvRecords removeAllObjects];
+    self.totalRecordCount = 0;
+    self.catalogOffset = 0;
     [self updateEmptyState];
     [_tableView reloadData];
+
+    [[PIDSessionCatalog sharedCatalog] removeAllEntriesWithCompletion:^(NSArray<NSString *> *filePaths) {
+        dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+            NSFileManager *fm = [NSFileManager defaultManager];
+            for (NSString *path in filePaths) {
+                NSError *error = nil;
+                [fm removeItemAtPath:path error:&error];
+                if (error) {
+                    NSLog(@"❌ 删除文件失败: %@", error.localizedDescription);
+                }
+            }
+        });
+    }];
 }
 
 #pragma mark - UITableViewDataSource
@@ -272,11 +338,22 @@
     CSVRecord *record = _csvRecords[indexPath.row];
 
     config.text = record.fileName;
-    config.secondaryText = [NSString stringWithFormat:@"Session %ld | %@ | %ld 行\n%@",
-                            (long)record.sessionIndex + 1,
-                            [record formattedFileSize],
-                            (long)record.lineCount,
-                            [record formattedCreateTime]];
+    NSMutableString *detail = [NSMutableString stringWithFormat:@"Session %ld | %@ | %ld 行",
+                               (long)record.sessionIndex + 1,
+                               [record formattedFileSize],
+                               (long)record.lineCount];
+    if (record.durationSeconds > 0) {
+        [detail appendFormat:@" | %.1fs @ %.0fHz", record.durationSeconds, record.sampleRate];
+    }
+    [detail appendFormat:@"\n%@", [record formattedCreateTime]];
+    NSNumber *rollPeak = record.metrics[@"roll.peak"];
+    if (rollPeak) {
+        [detail appendFormat:@" | 峰值 R%.2f P%.2f Y%.2f",
+         rollPeak.doubleValue,
+         [record.metrics[@"pitch.peak"] doubleValue],
+         [record.metrics[@"yaw.peak"] doubleValue]];
+    }
+    config.secondaryText = detail;
     config.secondaryTextProperties.numberOfLines = 2;
     config.secondaryTextProperties.color = [UIColor secondaryLabelColor];
     config.image = [UIImage systemImageNamed:@"doc.text"];
@@ -290,6 +367,14 @@
 
 #pragma mark - UITableViewDelegate
 
+- (void)tableView:(UITableView *)tableView willDisplayCell:(UITableViewCell *)cell forRowAtIndexPath:(NSIndexPath *)indexPath {
+    // 接近末尾时预取下一页
+    if (self.catalogOffset < self.totalRecordCount &&
+        indexPath.row >= (NSInteger)_csvRecords.count - kHistoryPrefetchThreshold) {
+        [self loadNextPage];
+    }
+}
+
 - (void)tableView:(UITableView *)tableView didSelectRowAtIndexPath:(NSIndexPath *)indexPath {
     [tableView deselectRowAtIndexPath:indexPath animated:YES];
 
@@ -371,7 +456,10 @@
     [[NSFileManager defaultManager] removeItemAtPath:record.filePath error:&error];
 
     if (!error) {
+        [[PIDSessionCatalog sharedCatalog] removeEntryForFileName:record.fileName];
         [_csvRecords removeObjectAtIndex:indexPath.row];
+        self.totalRecordCount = MAX(self.totalRecordCount - 1, 0);
+        self.catalogOffset = MAX(self.catalogOffset - 1, 0);
         [_tableView deleteRowsAtIndexPaths:@[indexPath] withRowAnimation:UITableViewRowAnimationAutomatic];
         [self updateEmptyState];
     } else {
@@ -12,6 +12,8 @@
 #import <Foundation/Foundation.h>
 
 @class PIDCSVData;
+@class PIDProgressTelemetry;
+@class PIDCancellationToken;
 
 NS_ASSUME_NONNULL_BEGIN
 
@@ -54,6 +56,12 @@ NS_ASSUME_NONNULL_BEGIN
 // 是否使用详细日志
 @property (nonatomic, assign) BOOL verboseLogging;
 
+// 进度遥测（可选），解析时累加已读行数和字节数，总量由调用方设置
+@property (nonatomic, strong, nullable) PIDProgressTelemetry *telemetry;
+
+// 取消令牌（可选），每行检查一次；取消后关闭文件并按失败返回，lastErrorMessage为"已取消"
+@property (nonatomic, strong, nullable) PIDCancellationToken *cancellationToken;
+
 /**
  * 便捷初始化方法
  */
@@ -73,13 +81,28 @@ NS_ASSUME_NONNULL_BEGIN
 
 /**
  * 解析CSV文件（带进度回调）
+ * 进度经由遥测通道合并，主线程回调频率与文件大小无关
  * @param filePath CSV文件完整路径
- * @param progressHandler 进度回调 (当前行/总行数)
+ * @param progressHandler 主线程进度回调 (当前行/预估总行数)
  * @return 解析后的数据对象，失败返回nil
  */
 - (nullable PIDCSVData *)parseCSV:(NSString *)filePath
                   progressHandler:(nullable void(^)(NSInteger currentRow, NSInteger totalRows))progressHandler;
 
+/**
+ * 分块解析CSV文件（流水线模式）
+ * 每解析chunkRows行即在当前线程回调一次，数据块只包含这一段的行，
+ * 解析器内部不保留已回调的数据，便于下游边读边算
+ *
+ * @param filePath CSV文件完整路径
+ * @param chunkRows 每块行数（<=0时使用默认值4096）
+ * @param chunkHandler 数据块回调 (数据块, 该块首行在文件中的行偏移)
+ * @return YES表示解析完成，NO表示失败（见lastErrorMessage）
+ */
+- (BOOL)parseCSV:(NSString *)filePath
+       chunkRows:(NSInteger)chunkRows
+    chunkHandler:(void(^)(PIDCSVData *chunk, NSInteger rowOffset))chunkHandler;
+
 /**
  * 获取CSV文件预估行数（用于进度显示）
  * @param filePath CSV文件路径
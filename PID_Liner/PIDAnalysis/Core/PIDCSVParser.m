@@ -8,6 +8,8 @@
 
 #import "PIDCSVParser.h"
 #import "PIDDataModels.h"
+#import "PIDProgressTelemetry.h"
+#import "PIDCancellationToken.h"
 
 // 默认缓冲区大小：8KB
 static const NSInteger kDefaultBufferSize = 8 * 1024;
@@ -15,6 +17,12 @@ static const NSInteger kDefaultBufferSize = 8 * 1024;
 // 默认最大读取行数（防止内存溢出）
 static const NSInteger kDefaultMaxRows = 100000;
 
+// 分块解析默认每块行数
+static const NSInteger kDefaultChunkRows = 4096;
+
+// 每解析多少行向遥测通道上报一次
+static const NSInteger kTelemetryRowStride = 256;
+
 #pragma mark - PIDCSVParserConfig Implementation
 
 @implementation PIDCSVParserConfig
@@ -197,10 +205,30 @@ static const NSInteger kDefaultMaxRows = 100000;
         NSString *line;
         BOOL hasMoreData = YES;
 
+        // 进度回调经遥测通道节流，解析线程不再逐批向主线程派发
+        PIDProgressTelemetry *telemetry = self.telemetry;
+        id<NSObject> progressObserver = nil;
+        if (progressHandler) {
+            if (!telemetry) {
+                telemetry = [[PIDProgressTelemetry alloc] init];
+                [telemetry setStage:PIDTelemetryStageParse];
+            }
+            int64_t baseRows = [telemetry snapshot].rowsDone;
+            progressObserver = [telemetry addObserverWithInterval:0 handler:^(PIDTelemetrySnapshot snapshot) {
+                progressHandler((NSInteger)(snapshot.rowsDone - baseRows), totalRows);
+            }];
+        }
+
         // 跳过表头行
         [fileHandle seekToFileOffset:headerLine.length + 1]; // +1 for newline
+        unsigned long long reportedOffset = 0;
+        NSInteger reportedRow = 0;
+        PIDCancellationToken *cancellationToken = self.cancellationToken;
 
         while (hasMoreData && (self.config.maxRows == 0 || currentRow < self.config.maxRows)) {
+            if (cancellationToken.isCancelled) {
+                break;
+            }
             @autoreleasepool {
                 line = [self readNextLineFromFile:fileHandle];
                 if (!line || line.length == 0) {
@@ -213,17 +241,30 @@ static const NSInteger kDefaultMaxRows = 100000;
 
                 currentRow++;
 
-                // 进度回调（每100行或总行数的1%触发一次）
-                if (progressHandler && (currentRow % 100 == 0 || currentRow % (totalRows / 100 + 1) == 0)) {
-                    dispatch_async(dispatch_get_main_queue(), ^{
-                        progressHandler(currentRow, totalRows);
-                    });
+                if (telemetry && currentRow - reportedRow >= kTelemetryRowStride) {
+                    [self reportProgressToTelemetry:telemetry fileHandle:fileHandle
+                                        currentRow:currentRow reportedRow:&reportedRow reportedOffset:&reportedOffset];
                 }
             }
         }
 
+        if (telemetry) {
+            [self reportProgressToTelemetry:telemetry fileHandle:fileHandle
+                                currentRow:currentRow reportedRow:&reportedRow reportedOffset:&reportedOffset];
+        }
+        if (progressObserver) {
+            [telemetry removeObserver:progressObserver];
+        }
+
         [fileHandle closeFile];
 
+        if (cancellationToken.isCancelled) {
+            [self resetDataCache];
+            self.lastErrorMessage = @"已取消";
+            NSLog(@"⏹ CSV解析已取消: %ld行", (long)currentRow);
+            return nil;
+        }
+
         // 构建结果对象
         PIDCSVData *result = [self buildResult];
         result.dataLength = currentRow;
@@ -245,8 +286,156 @@ static const NSInteger kDefaultMaxRows = 100000;
     }
 }
 
+- (BOOL)parseCSV:(NSString *)filePath
+       chunkRows:(NSInteger)chunkRows
+    chunkHandler:(void(^)(PIDCSVData *, NSInteger))chunkHandler {
+    @try {
+        NSLog(@"📝 开始分块解析CSV: %@", filePath);
+
+        if (![self validateCSVFormat:filePath]) {
+            NSLog(@"❌ CSV格式验证失败: %@", self.lastErrorMessage);
+            return NO;
+        }
+
+        if (chunkRows <= 0) {
+            chunkRows = kDefaultChunkRows;
+        }
+
+        [self resetDataCache];
+
+        NSFileHandle *fileHandle = [NSFileHandle fileHandleForReadingAtPath:filePath];
+        if (!fileHandle) {
+            self.lastErrorMessage = @"无法打开文件";
+            return NO;
+        }
+
+        NSString *headerLine = [self readFirstLine:filePath error:nil];
+        NSArray<NSString *> *headers = [self parseCSVLine:headerLine];
+        [self buildFieldIndexes:headers];
+
+        // 跳过表头行
+        [fileHandle seekToFileOffset:headerLine.length + 1]; // +1 for newline
+
+        NSInteger currentRow = 0;
+        NSInteger chunkStartRow = 0;
+        double sampleRate = 0;
+        PIDProgressTelemetry *telemetry = self.telemetry;
+        unsigned long long reportedOffset = 0;
+        NSInteger reportedRow = 0;
+        PIDCancellationToken *cancellationToken = self.cancellationToken;
+
+        while (self.config.maxRows == 0 || currentRow < self.config.maxRows) {
+            if (cancellationToken.isCancelled) {
+                break;
+            }
+            @autoreleasepool {
+                NSString *line = [self readNextLineFromFile:fileHandle];
+                if (!line || line.length == 0) {
+                    break;
+                }
+
+                [self parseDataLine:line];
+                currentRow++;
+
+                if (telemetry && currentRow - reportedRow >= kTelemetryRowStride) {
+                    [self reportProgressToTelemetry:telemetry fileHandle:fileHandle
+                                        currentRow:currentRow reportedRow:&reportedRow reportedOffset:&reportedOffset];
+                }
+
+                if (currentRow - chunkStartRow >= chunkRows) {
+                    PIDCSVData *chunk = [self buildChunkWithRowCount:currentRow - chunkStartRow sampleRate:&sampleRate];
+                    chunkHandler(chunk, chunkStartRow);
+                    chunkStartRow = currentRow;
+                }
+            }
+        }
+
+        if (telemetry) {
+            [self reportProgressToTelemetry:telemetry fileHandle:fileHandle
+                                currentRow:currentRow reportedRow:&reportedRow reportedOffset:&reportedOffset];
+        }
+
+        [fileHandle closeFile];
+
+        if (cancellationToken.isCancelled) {
+            [self resetDataCache];
+            self.lastErrorMessage = @"已取消";
+            NSLog(@"⏹ CSV分块解析已取消: %ld行", (long)currentRow);
+            return NO;
+        }
+
+        // 最后不足一块的剩余行
+        if (currentRow > chunkStartRow) {
+            @autoreleasepool {
+                PIDCSVData *chunk = [self buildChunkWithRowCount:currentRow - chunkStartRow sampleRate:&sampleRate];
+                chunkHandler(chunk, chunkStartRow);
+            }
+        }
+
+        NSLog(@"✅ CSV分块解析完成: %ld行, 采样率=%.0fHz", (long)currentRow, sampleRate);
+
+        return YES;
+
+    } @catch (NSException *exception) {
+        self.lastErrorMessage = [NSString stringWithFormat:@"解析异常: %@", exception.reason];
+        NSLog(@"❌ parseCSV:chunkRows:异常: %@", exception);
+        return NO;
+    }
+}
+
+#pragma mark - Private Methods - 进度上报
+
+/**
+ * 把上次上报以来新增的行数和字节数累加到遥测通道
+ * 字节数取文件句柄偏移（含尚未消费的读缓冲），首次上报从0开始，表头计入已读字节
+ */
+- (void)reportProgressToTelemetry:(PIDProgressTelemetry *)telemetry
+                       fileHandle:(NSFileHandle *)fileHandle
+                       currentRow:(NSInteger)currentRow
+                      reportedRow:(NSInteger *)reportedRow
+                   reportedOffset:(unsigned long long *)reportedOffset {
+    unsigned long long offset = fileHandle.offsetInFile;
+    [telemetry addRowsDone:currentRow - *reportedRow];
+    if (offset > *reportedOffset) {
+        [telemetry addBytesDone:(int64_t)(offset - *reportedOffset)];
+    }
+    *reportedRow = currentRow;
+    *reportedOffset = offset;
+}
+
 #pragma mark - Private Methods - 数据缓存管理
 
+/**
+ * 从缓存构建一个数据块并清空缓存中的行
+ * 采样率只由第一块计算，后续数据块沿用，保证整个文件使用同一采样率
+ */
+- (PIDCSVData *)buildChunkWithRowCount:(NSInteger)rowCount sampleRate:(double *)sampleRate {
+    BOOL wasVerbose = self.verboseLogging;
+    self.verboseLogging = NO;
+    PIDCSVData *chunk = [self buildResult];
+    self.verboseLogging = wasVerbose;
+
+    chunk.dataLength = rowCount;
+
+    if (*sampleRate <= 0) {
+        *sampleRate = 8000.0;
+        if (chunk.timeUs.count > 1) {
+            int64_t timeDiff = [chunk.timeUs[1] longLongValue] - [chunk.timeUs[0] longLongValue];
+            if (timeDiff > 0) {
+                *sampleRate = 1000000.0 / timeDiff;
+            }
+        }
+    }
+    chunk.sampleRate = *sampleRate;
+
+    for (NSMutableArray<NSNumber *> *column in self.dataCache.allValues) {
+        [column removeAllObjects];
+    }
+
+    return chunk;
+}
+
+
 - (void)resetDataCache {
     // 初始化所有字段的数组
     self.dataCache = [NSMutableDictionary dictionary];
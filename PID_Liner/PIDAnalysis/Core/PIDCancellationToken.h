@@ -0,0 +1,43 @@
+//
+//  PIDCancellationToken.h
+//  PID_Liner
+//
+//  取消令牌 - 一次分析任务的协作式取消，贯穿解析、堆叠、FFT与反卷积内核
+//
+
+#ifndef PIDCancellationToken_h
+#define PIDCancellationToken_h
+
+#import <Foundation/Foundation.h>
+#import "PIDParallel.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ * 取消令牌
+ *
+ * 发起方持有令牌并在任意线程调用cancel；各层分析代码在检查点读取isCancelled
+ * （热循环里每个窗口一次，只是一次原子读取），发现已取消就放弃剩余工作，
+ * 按各自的失败约定返回（空结果 / nil / NO）。令牌只能从未取消变为已取消，不能复位，
+ * 每次新的分析任务使用新令牌。
+ */
+@interface PIDCancellationToken : NSObject
+
+// 是否已取消（任意线程）
+@property (nonatomic, readonly, getter=isCancelled) BOOL cancelled;
+
+/**
+ * 请求取消（任意线程，可重复调用）
+ */
+- (void)cancel;
+
+/**
+ * 供C内核检查的取消标志，生命周期与令牌相同
+ */
+- (const PIDCancelFlag *)flag;
+
+@end
+
+NS_ASSUME_NONNULL_END
+
+#endif /* PIDCancellationToken_h */
@@ -0,0 +1,38 @@
+//
+//  PIDCancellationToken.m
+//  PID_Liner
+//
+//  取消令牌实现
+//
+
+#import "PIDCancellationToken.h"
+
+@implementation PIDCancellationToken {
+    PIDCancelFlag *_flag;
+}
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        _flag = PIDCancelFlagCreate();
+    }
+    return self;
+}
+
+- (void)dealloc {
+    PIDCancelFlagDestroy(_flag);
+}
+
+- (BOOL)isCancelled {
+    return PIDCancelFlagIsSet(_flag);
+}
+
+- (void)cancel {
+    PIDCancelFlagSet(_flag);
+}
+
+- (const PIDCancelFlag *)flag {
+    return _flag;
+}
+
+@end
@@ -82,6 +82,19 @@ NS_ASSUME_NONNULL_BEGIN
  */
 - (NSArray<NSNumber *> *)axisDForAxis:(NSInteger)axis;
 
+/**
+ * 追加另一段数据（用于分块解析后的拼接）
+ * 某一段缺失的列用NaN补齐，保证各列长度与dataLength一致
+ * @param chunk 紧随当前数据之后的数据块
+ */
+- (void)appendData:(PIDCSVData *)chunk;
+
+/**
+ * 丢弃开头的若干行（用于流式分析的滑动缓冲）
+ * @param count 丢弃的行数（超过dataLength时清空）
+ */
+- (void)removeLeadingRows:(NSInteger)count;
+
 @end
 
 #pragma mark - PID分析结果模型
@@ -58,6 +58,94 @@
     }
 }
 
+/**
+ * 参与拼接的列（throttle是rcCommand3的别名，单独处理）
+ */
++ (NSArray<NSString *> *)appendableColumnKeys {
+    static NSArray<NSString *> *keys = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        keys = @[@"timeUs", @"timeSeconds",
+                 @"rcCommand0", @"rcCommand1", @"rcCommand2", @"rcCommand3",
+                 @"axisP0", @"axisP1", @"axisP2",
+                 @"axisI0", @"axisI1", @"axisI2",
+                 @"axisD0", @"axisD1", @"axisD2",
+                 @"gyroADC0", @"gyroADC1", @"gyroADC2",
+                 @"debug0", @"debug1", @"debug2", @"debug3"];
+    });
+    return keys;
+}
+
+- (void)appendData:(PIDCSVData *)chunk {
+    if (!chunk || chunk.dataLength <= 0) {
+        return;
+    }
+
+    // 第一块决定采样率
+    if (self.dataLength == 0) {
+        self.sampleRate = chunk.sampleRate;
+    }
+
+    for (NSString *key in [PIDCSVData appendableColumnKeys]) {
+        NSArray<NSNumber *> *existing = [self valueForKey:key];
+        NSArray<NSNumber *> *incoming = [chunk valueForKey:key];
+
+        if (incoming.count == 0 && existing.count == 0) {
+            continue;
+        }
+
+        NSMutableArray<NSNumber *> *column = nil;
+        if ([existing isKindOfClass:[NSMutableArray class]]) {
+            column = (NSMutableArray<NSNumber *> *)existing;
+        } else {
+            column = existing ? [existing mutableCopy] : [NSMutableArray array];
+            [self setValue:column forKey:key];
+        }
+
+        // 之前的数据块没有这一列：先用NaN补齐已有的行
+        while (column.count < self.dataLength) {
+            [column addObject:@(NAN)];
+        }
+
+        if (incoming.count > 0) {
+            [column addObjectsFromArray:incoming];
+        } else {
+            for (NSInteger i = 0; i < chunk.dataLength; i++) {
+                [column addObject:@(NAN)];
+            }
+        }
+    }
+
+    self.throttle = self.rcCommand3;
+    self.dataLength += chunk.dataLength;
+}
+
+- (void)removeLeadingRows:(NSInteger)count {
+    count = MIN(count, self.dataLength);
+    if (count <= 0) {
+        return;
+    }
+
+    for (NSString *key in [PIDCSVData appendableColumnKeys]) {
+        NSArray<NSNumber *> *existing = [self valueForKey:key];
+        if (existing.count == 0) {
+            continue;
+        }
+
+        NSMutableArray<NSNumber *> *column = nil;
+        if ([existing isKindOfClass:[NSMutableArray class]]) {
+            column = (NSMutableArray<NSNumber *> *)existing;
+        } else {
+            column = [existing mutableCopy];
+            [self setValue:column forKey:key];
+        }
+        [column removeObjectsInRange:NSMakeRange(0, MIN(count, column.count))];
+    }
+
+    self.throttle = self.rcCommand3;
+    self.dataLength -= count;
+}
+
 @end
 
 #pragma mark - PIDAxisAnalysisResult Implementation
@@ -0,0 +1,141 @@
+//
+//  PIDOutOfCoreAnalyzer.h
+//  PID_Liner
+//
+//  外存分析器 - 固定内存预算下分析超长日志
+//
+
+#ifndef PIDOutOfCoreAnalyzer_h
+#define PIDOutOfCoreAnalyzer_h
+
+#import <Foundation/Foundation.h>
+#import "PIDTraceAnalyzer.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+@class PIDProgressTelemetry;
+@class PIDCancellationToken;
+
+#pragma mark - 外存分析配置
+
+/**
+ * 外存分析配置
+ * 分析参数默认值与PIDPipelineConfig一致
+ */
+@interface PIDOutOfCoreConfig : NSObject
+
+// 窗口大小（8kHz参考采样率下的样本点数），默认8000；实际点数按分析采样率等比缩放
+@property (nonatomic, assign) NSInteger windowSize;
+
+// 窗口重叠比例，默认0.9375
+@property (nonatomic, assign) double overlap;
+
+// 维纳反卷积截止频率 (Hz)，默认25
+@property (nonatomic, assign) double cutFreq;
+
+// 各轴P增益 [Roll, Pitch, Yaw]，默认45/50/55
+@property (nonatomic, copy) NSArray<NSNumber *> *pGains;
+
+// 解析器每块行数，默认4096
+@property (nonatomic, assign) NSInteger chunkRows;
+
+// 内存预算（字节），默认160MB
+@property (nonatomic, assign) NSUInteger memoryBudgetBytes;
+
+// 是否重采样到规范分析采样率（见PIDPolyphaseResampler），默认YES
+@property (nonatomic, assign) BOOL resampleToAnalysisRate;
+
+// 分析精度（见PIDTraceAnalyzer.precision），默认PIDDSPPrecisionFloat32
+@property (nonatomic, assign) PIDDSPPrecision precision;
+
++ (instancetype)defaultConfig;
+
+@end
+
+#pragma mark - 外存分析结果
+
+/**
+ * 外存分析结果
+ * 只包含折叠后的统计量，不保留逐窗口数据
+ */
+@interface PIDOutOfCoreResult : NSObject
+
+// 各轴响应曲线 [Roll, Pitch, Yaw]，没有数据的轴为空曲线（windowCount = 0）
+@property (nonatomic, copy, readonly) NSArray<PIDResponseCurves *> *curves;
+
+// 各轴噪声频谱 [Roll, Pitch, Yaw]，accumulator为全部窗口的流式累加结果，spectrum只有一行（其平均谱）
+@property (nonatomic, copy, readonly) NSArray<PIDSpectrumResult *> *spectrums;
+
+// 数据行数（源文件解析出的行数，重采样前）
+@property (nonatomic, assign, readonly) NSInteger rowCount;
+
+// 每轴窗口数
+@property (nonatomic, assign, readonly) NSInteger windowCount;
+
+// 采样率 (Hz)，重采样后为分析采样率
+@property (nonatomic, assign, readonly) double sampleRate;
+
+// 读取文件的遍数
+@property (nonatomic, assign, readonly) NSInteger passCount;
+
+// 分析期间观测到的内存增量峰值（字节，相对分析开始时；在堆叠、频谱缓存和响应计算之后采样）
+@property (nonatomic, assign, readonly) NSUInteger peakFootprintBytes;
+
+// 最终的每批窗口数（实测超出预算时会小于规划值）
+@property (nonatomic, assign, readonly) NSInteger batchWindowCount;
+
+@end
+
+#pragma mark - 外存分析器
+
+/**
+ * 外存分析器
+ *
+ * 从磁盘分块读取CSV，只在滑动缓冲中保留尚未处理的窗口所需的行；
+ * 每个窗口计算后立即折叠进响应直方图和频谱累加和，然后丢弃。
+ *
+ * 质量过滤依赖全部窗口的参考响应，因此每组轴读取两遍文件：
+ * 第一遍得到参考响应和平均频谱，第二遍重新计算窗口并按质量mask累加。
+ * 直方图大小固定，同时处理的轴数和每批窗口数先按估算开销规划，
+ * 之后按每批实测的内存增量缩小批大小，内存占用与日志长度无关；结果与内存中分析完全一致。
+ */
+@interface PIDOutOfCoreAnalyzer : NSObject
+
+@property (nonatomic, strong, readonly) PIDOutOfCoreConfig *config;
+
+// 最后错误信息
+@property (nonatomic, readonly, copy, nullable) NSString *lastErrorMessage;
+
+// 进度遥测（可选）：字节总量按全部遍数计，窗口数每遍累加
+@property (nonatomic, strong, nullable) PIDProgressTelemetry *telemetry;
+
+// 取消令牌（可选）：交给解析器和窗口分析，取消后当前遍立即结束，不再开始后续遍
+@property (nonatomic, strong, nullable) PIDCancellationToken *cancellationToken;
+
+- (instancetype)initWithConfig:(nullable PIDOutOfCoreConfig *)config;
+
+/**
+ * 分析CSV文件（阻塞调用，应在后台线程执行）
+ * @param filePath CSV文件完整路径
+ * @return 分析结果，解析失败、内存预算不足或已取消返回nil
+ */
+- (nullable PIDOutOfCoreResult *)analyzeCSVFile:(NSString *)filePath;
+
+/**
+ * 估算内存中分析（PIDPipelinedAnalyzer）所需的内存
+ * @param filePath CSV文件完整路径
+ * @return 估算字节数，文件不存在时返回0
+ */
++ (unsigned long long)estimatedInMemoryBytesForFileAtPath:(NSString *)filePath;
+
+/**
+ * 是否应使用外存分析（估算内存超过设备物理内存的1/4）
+ * @param filePath CSV文件完整路径
+ */
++ (BOOL)shouldAnalyzeFileOutOfCore:(NSString *)filePath;
+
+@end
+
+NS_ASSUME_NONNULL_END
+
+#endif /* PIDOutOfCoreAnalyzer_h */
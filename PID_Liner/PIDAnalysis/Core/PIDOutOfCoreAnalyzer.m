@@ -0,0 +1,522 @@
+//
+//  PIDOutOfCoreAnalyzer.m
+//  PID_Liner
+//
+//  外存分析器实现 - 分块读取、逐窗口折叠、固定内存预算
+//
+
+#import "PIDOutOfCoreAnalyzer.h"
+#import "PIDCSVParser.h"
+#import "PIDDataModels.h"
+#import "PIDProgressTelemetry.h"
+#import "PIDPolyphaseResampler.h"
+#import "PIDSpectralCache.h"
+#import "PIDCancellationToken.h"
+#import <mach/mach.h>
+
+// 分析的轴数 (Roll, Pitch, Yaw)
+static const NSInteger kOutOfCoreAxisCount = 3;
+
+// 滑动缓冲中每个值的估算开销（NSNumber对象 + 数组指针）
+static const NSUInteger kBytesPerBufferedValue = 32;
+
+// PIDCSVData参与拼接的列数
+static const NSUInteger kBufferedColumnCount = 22;
+
+// 一个窗口在计算过程中每个样本点的估算开销（堆叠数组、加窗副本、反卷积和频谱的中间结果）
+static const NSUInteger kWorkingBytesPerWindowSample = 320;
+
+// 每批最多计算的窗口数
+static const NSInteger kMaxBatchWindows = 32;
+
+// 内存中分析时每字节CSV的估算开销（完整列数据 + 逐窗口响应和频谱）
+static const unsigned long long kInMemoryBytesPerCSVByte = 12;
+
+/**
+ * 当前进程的物理内存占用（与Xcode内存仪表一致）
+ */
+static NSUInteger PIDCurrentFootprint(void) {
+    task_vm_info_data_t info;
+    mach_msg_type_number_t count = TASK_VM_INFO_COUNT;
+    kern_return_t kr = task_info(mach_task_self(), TASK_VM_INFO, (task_info_t)&info, &count);
+    return kr == KERN_SUCCESS ? (NSUInteger)info.phys_footprint : 0;
+}
+
+#pragma mark - PIDOutOfCoreConfig Implementation
+
+@implementation PIDOutOfCoreConfig
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        _windowSize = 8000;
+        _overlap = 0.9375;
+        _cutFreq = 25.0;
+        _pGains = @[@45.0, @50.0, @55.0];
+        _chunkRows = 4096;
+        _memoryBudgetBytes = 160 * 1024 * 1024;
+        _resampleToAnalysisRate = YES;
+        _precision = PIDDSPPrecisionFloat32;
+    }
+    return self;
+}
+
++ (instancetype)defaultConfig {
+    return [[self alloc] init];
+}
+
+@end
+
+#pragma mark - PIDOutOfCoreResult Implementation
+
+@interface PIDOutOfCoreResult ()
+
+@property (nonatomic, copy, readwrite) NSArray<PIDResponseCurves *> *curves;
+@property (nonatomic, copy, readwrite) NSArray<PIDSpectrumResult *> *spectrums;
+@property (nonatomic, assign, readwrite) NSInteger rowCount;
+@property (nonatomic, assign, readwrite) NSInteger windowCount;
+@property (nonatomic, assign, readwrite) double sampleRate;
+@property (nonatomic, assign, readwrite) NSInteger passCount;
+@property (nonatomic, assign, readwrite) NSUInteger peakFootprintBytes;
+@property (nonatomic, assign, readwrite) NSInteger batchWindowCount;
+
+@end
+
+@implementation PIDOutOfCoreResult
+
+@end
+
+#pragma mark - PIDOutOfCoreAnalyzer Implementation
+
+@interface PIDOutOfCoreAnalyzer ()
+
+@property (nonatomic, copy, readwrite) NSString *lastErrorMessage;
+
+// 内存规划：每遍同时处理的轴数 / 每批窗口数（按实测缩小）
+@property (nonatomic, assign) NSInteger axesPerPass;
+@property (nonatomic, assign) NSInteger batchWindows;
+
+// 源文件已解析的行数
+@property (nonatomic, assign) NSInteger parsedRows;
+
+// 滑动缓冲：只保留尚未处理的窗口所需的行，bufferBaseRow为缓冲第0行的全局行号
+@property (nonatomic, strong) PIDCSVData *buffer;
+@property (nonatomic, assign) NSInteger bufferBaseRow;
+@property (nonatomic, assign) NSInteger processedWindows;
+
+// 分析器和Hanning窗（第一块数据到达后按实际采样率创建）
+@property (nonatomic, strong, nullable) PIDTraceAnalyzer *analyzer;
+@property (nonatomic, strong, nullable) NSArray<NSNumber *> *hanningWindow;
+
+// 分析采样率下的窗口大小（不超过config.windowSize，内存规划按后者计算）/ 重采样器（每遍重置）
+@property (nonatomic, assign) NSInteger windowSize;
+@property (nonatomic, strong, nullable) PIDPolyphaseResampler *resampler;
+
+// 文件开头的两个时间点（频谱的dt与一次性分析一致）
+@property (nonatomic, strong, nullable) NSArray<NSNumber *> *spectrumTime;
+
+// 各轴频谱累加器（第一个批次到达时按其频率点创建，NSNull表示尚无数据）
+@property (nonatomic, strong) NSMutableArray *spectrumAccumulators;
+
+// 内存观测：整体峰值 / 当前批次内的峰值
+@property (nonatomic, assign) NSUInteger baselineFootprint;
+@property (nonatomic, assign) NSUInteger peakFootprint;
+@property (nonatomic, assign) NSUInteger batchPeakFootprint;
+
+@end
+
+@implementation PIDOutOfCoreAnalyzer
+
+- (instancetype)initWithConfig:(PIDOutOfCoreConfig *)config {
+    self = [super init];
+    if (self) {
+        _config = config ?: [PIDOutOfCoreConfig defaultConfig];
+    }
+    return self;
+}
+
+#pragma mark - Public Methods
+
++ (unsigned long long)estimatedInMemoryBytesForFileAtPath:(NSString *)filePath {
+    NSDictionary<NSFileAttributeKey, id> *attributes = [[NSFileManager defaultManager] attributesOfItemAtPath:filePath error:nil];
+    return attributes.fileSize * kInMemoryBytesPerCSVByte;
+}
+
++ (BOOL)shouldAnalyzeFileOutOfCore:(NSString *)filePath {
+    unsigned long long estimated = [self estimatedInMemoryBytesForFileAtPath:filePath];
+    return estimated > [NSProcessInfo processInfo].physicalMemory / 4;
+}
+
+- (nullable PIDOutOfCoreResult *)analyzeCSVFile:(NSString *)filePath {
+    self.lastErrorMessage = nil;
+    if (![self planMemoryBudget]) {
+        return nil;
+    }
+
+    self.baselineFootprint = PIDCurrentFootprint();
+    self.peakFootprint = self.baselineFootprint;
+
+    // 每组轴读两遍文件，进度总量一次性按全部遍数设置，避免进度在遍与遍之间回退
+    if (self.telemetry) {
+        NSInteger groupCount = (kOutOfCoreAxisCount + self.axesPerPass - 1) / self.axesPerPass;
+        NSDictionary<NSFileAttributeKey, id> *attributes = [[NSFileManager defaultManager] attributesOfItemAtPath:filePath error:nil];
+        [self.telemetry addBytesTotal:(int64_t)attributes.fileSize * groupCount * 2];
+        [self.telemetry setStage:PIDTelemetryStageAnalyze];
+    }
+
+    self.spectrumAccumulators = [NSMutableArray arrayWithCapacity:kOutOfCoreAxisCount];
+    for (NSInteger axis = 0; axis < kOutOfCoreAxisCount; axis++) {
+        [self.spectrumAccumulators addObject:[NSNull null]];
+    }
+
+    NSMutableArray<PIDResponseCurves *> *curves = [NSMutableArray arrayWithCapacity:kOutOfCoreAxisCount];
+    NSInteger passCount = 0;
+    NSInteger rowCount = 0;
+
+    for (NSInteger firstAxis = 0; firstAxis < kOutOfCoreAxisCount; firstAxis += self.axesPerPass) {
+        NSInteger groupSize = MIN(self.axesPerPass, kOutOfCoreAxisCount - firstAxis);
+        NSMutableArray<PIDResponseCurveBuilder *> *builders = [NSMutableArray arrayWithCapacity:groupSize];
+        for (NSInteger i = 0; i < groupSize; i++) {
+            [builders addObject:[[PIDResponseCurveBuilder alloc] init]];
+        }
+        NSRange axes = NSMakeRange(firstAxis, groupSize);
+
+        // 第一遍：参考响应 + 平均频谱
+        if (![self streamFile:filePath axes:axes builders:builders finalPass:NO]) {
+            return nil;
+        }
+        for (PIDResponseCurveBuilder *builder in builders) {
+            [builder finishInitialPass];
+        }
+
+        // 第二遍：重新计算窗口，按质量mask累加最终曲线
+        if (![self streamFile:filePath axes:axes builders:builders finalPass:YES]) {
+            return nil;
+        }
+        for (PIDResponseCurveBuilder *builder in builders) {
+            [curves addObject:[builder finishFinalPass]];
+        }
+
+        passCount += 2;
+        rowCount = self.parsedRows;
+    }
+
+    PIDOutOfCoreResult *result = [[PIDOutOfCoreResult alloc] init];
+    result.curves = curves;
+    result.spectrums = [self averagedSpectrums];
+    result.rowCount = rowCount;
+    result.windowCount = self.processedWindows;
+    result.sampleRate = self.buffer.sampleRate;
+    result.passCount = passCount;
+    result.peakFootprintBytes = self.peakFootprint > self.baselineFootprint
+                              ? self.peakFootprint - self.baselineFootprint : 0;
+    result.batchWindowCount = self.batchWindows;
+
+    self.buffer = nil;
+    self.analyzer = nil;
+    self.hanningWindow = nil;
+    self.resampler = nil;
+    self.spectrumTime = nil;
+    [self.telemetry setStage:PIDTelemetryStageFinished];
+
+    NSLog(@"✅ 外存分析完成: %ld行, %ld窗口, %ld遍, 每批%ld窗口, 内存峰值增量%.1fMB (预算%.1fMB)",
+          (long)result.rowCount, (long)result.windowCount, (long)passCount, (long)result.batchWindowCount,
+          result.peakFootprintBytes / 1048576.0, self.config.memoryBudgetBytes / 1048576.0);
+    if (result.peakFootprintBytes > self.config.memoryBudgetBytes) {
+        NSLog(@"⚠️ 外存分析每批一个窗口仍超出预算，请调低chunkRows或提高预算");
+    }
+
+    return result;
+}
+
+#pragma mark - Private Methods
+
+/**
+ * 按内存预算决定每遍处理的轴数和每批窗口数
+ * 固定开销：滑动缓冲与各轴频谱累加器；每轴开销：响应曲线构建器的两个直方图；每窗口开销：计算中间结果
+ * 这里的开销是估算值，只作为起点；分析中按实测增量缩小批大小（见 shrinkBatchIfOverBudgetFrom:windowCount:）
+ */
+- (BOOL)planMemoryBudget {
+    PIDOutOfCoreConfig *config = self.config;
+    NSUInteger budget = config.memoryBudgetBytes;
+    NSInteger paddedLength = config.windowSize + (1024 - config.windowSize % 1024);
+    NSUInteger bufferBytes = (NSUInteger)(config.windowSize + 2 * MAX(config.chunkRows, 1))
+                           * kBufferedColumnCount * kBytesPerBufferedValue
+                           + kOutOfCoreAxisCount * [PIDSpectrumAccumulator bytesForFrequencyCount:(paddedLength + 1) / 2];
+    NSUInteger windowBytes = (NSUInteger)config.windowSize * kWorkingBytesPerWindowSample;
+    NSUInteger axisBytes = [PIDResponseCurveBuilder peakBytesForResponseLength:config.windowSize / 2];
+
+    if (config.windowSize <= 0 || budget < bufferBytes + windowBytes + axisBytes) {
+        self.lastErrorMessage = [NSString stringWithFormat:@"内存预算不足: 至少需要%.0fMB",
+                                 (bufferBytes + windowBytes + axisBytes) / 1048576.0];
+        return NO;
+    }
+
+    NSUInteger available = budget - bufferBytes - windowBytes;
+    self.axesPerPass = MIN(MAX((NSInteger)(available / axisBytes), 1), kOutOfCoreAxisCount);
+
+    NSUInteger batchBytes = budget - bufferBytes - self.axesPerPass * axisBytes;
+    self.batchWindows = MIN(MAX((NSInteger)(batchBytes / windowBytes), 1), kMaxBatchWindows);
+
+    NSLog(@"🔍 外存分析规划: 预算%.0fMB, 每遍%ld轴, 每批%ld窗口",
+          budget / 1048576.0, (long)self.axesPerPass, (long)self.batchWindows);
+    return YES;
+}
+
+/**
+ * 读取一遍文件，把指定轴的每个窗口折叠进构建器（第一遍同时累加频谱）
+ */
+- (BOOL)streamFile:(NSString *)filePath
+              axes:(NSRange)axes
+          builders:(NSArray<PIDResponseCurveBuilder *> *)builders
+         finalPass:(BOOL)finalPass {
+    self.buffer = [[PIDCSVData alloc] init];
+    self.bufferBaseRow = 0;
+    self.processedWindows = 0;
+    self.parsedRows = 0;
+    [self.resampler reset];
+
+    PIDCancellationToken *cancellationToken = self.cancellationToken;
+    PIDCSVParser *parser = [PIDCSVParser parser];
+    // 外存分析面向超长日志：读到文件末尾，不受解析器默认的行数限制
+    parser.config.maxRows = 0;
+    parser.verboseLogging = NO;
+    parser.telemetry = self.telemetry;
+    parser.cancellationToken = cancellationToken;
+    self.analyzer.cancellationToken = cancellationToken;
+
+    BOOL success = [parser parseCSV:filePath
+                          chunkRows:self.config.chunkRows
+                       chunkHandler:^(PIDCSVData *chunk, NSInteger rowOffset) {
+        if (cancellationToken.isCancelled) {
+            return;
+        }
+        @autoreleasepool {
+            if (rowOffset == 0) {
+                [self prepareAnalyzerWithFirstChunk:chunk];
+            }
+            self.parsedRows = MAX(self.parsedRows, rowOffset + chunk.dataLength);
+            [self appendAnalysisChunk:self.resampler ? [self.resampler resampleChunk:chunk final:NO] : chunk];
+            [self foldReadyWindowsForAxes:axes builders:builders finalPass:finalPass flush:NO];
+        }
+    }];
+
+    if (!success) {
+        self.lastErrorMessage = parser.lastErrorMessage ?: @"CSV解析失败";
+        return NO;
+    }
+
+    @autoreleasepool {
+        if (self.resampler) {
+            [self appendAnalysisChunk:[self.resampler resampleChunk:nil final:YES]];
+        }
+        [self foldReadyWindowsForAxes:axes builders:builders finalPass:finalPass flush:YES];
+    }
+    NSLog(@"🔍 外存分析读取轴%lu-%lu: %ld行, %ld窗口", (unsigned long)axes.location,
+          (unsigned long)(NSMaxRange(axes) - 1), (long)self.parsedRows, (long)self.processedWindows);
+
+    // 解析完成后才取消：折叠被中途放弃，本遍结果不完整
+    if (cancellationToken.isCancelled) {
+        self.lastErrorMessage = @"已取消";
+        return NO;
+    }
+    return YES;
+}
+
+/**
+ * 追加分析采样率下的数据块；频谱时间取重采样后的前两个时间点
+ */
+- (void)appendAnalysisChunk:(PIDCSVData *)chunk {
+    if (!self.spectrumTime && self.buffer.dataLength + chunk.dataLength >= 2) {
+        [self.buffer appendData:chunk];
+        self.spectrumTime = [self.buffer.timeSeconds subarrayWithRange:NSMakeRange(0, 2)];
+        return;
+    }
+    [self.buffer appendData:chunk];
+}
+
+- (void)prepareAnalyzerWithFirstChunk:(PIDCSVData *)chunk {
+    if (self.analyzer) {
+        return;
+    }
+
+    double sampleRate = chunk.sampleRate > 0 ? chunk.sampleRate : PIDReferenceAnalysisRate;
+    self.windowSize = self.config.windowSize;
+    if (self.config.resampleToAnalysisRate) {
+        self.resampler = [PIDPolyphaseResampler resamplerForSampleRate:sampleRate];
+        double analysisRate = [PIDPolyphaseResampler analysisRateForSampleRate:sampleRate];
+        self.windowSize = MIN([PIDPolyphaseResampler windowSize:self.config.windowSize forAnalysisRate:analysisRate],
+                              self.config.windowSize);
+    }
+
+    double analyzerRate = self.resampler ? self.resampler.outputRate : sampleRate;
+    self.analyzer = [[PIDTraceAnalyzer alloc] initWithSampleRate:analyzerRate cutFreq:self.config.cutFreq];
+    self.analyzer.cancellationToken = self.cancellationToken;
+    self.analyzer.pruneInactiveWindows = YES;
+    self.analyzer.precision = self.config.precision;
+    self.hanningWindow = [PIDTraceAnalyzer hanningWindowWithLength:self.windowSize];
+}
+
+/**
+ * 计算缓冲中已完整覆盖的窗口，折叠后丢弃不再需要的行
+ * 非flush时攒够batchWindows个窗口才计算
+ */
+- (void)foldReadyWindowsForAxes:(NSRange)axes
+                       builders:(NSArray<PIDResponseCurveBuilder *> *)builders
+                      finalPass:(BOOL)finalPass
+                          flush:(BOOL)flush {
+    PIDOutOfCoreConfig *config = self.config;
+    NSInteger step = MAX((NSInteger)(self.windowSize * (1.0 - config.overlap)), 1);
+    NSInteger totalRows = self.bufferBaseRow + self.buffer.dataLength;
+    NSInteger readyWindows = [PIDStackData windowCountForSampleCount:totalRows
+                                                          windowSize:self.windowSize
+                                                             overlap:config.overlap];
+
+    while ((readyWindows - self.processedWindows >= self.batchWindows
+            || (flush && readyWindows > self.processedWindows))
+           && !self.cancellationToken.isCancelled) {
+        NSInteger count = MIN(self.batchWindows, readyWindows - self.processedWindows);
+
+        // 缓冲起点总是步长的整数倍，全局窗口k在缓冲中的编号为 k - bufferBaseRow/step
+        NSRange range = NSMakeRange(self.processedWindows - self.bufferBaseRow / step, count);
+        NSUInteger batchStartFootprint = PIDCurrentFootprint();
+        self.batchPeakFootprint = batchStartFootprint;
+
+        for (NSInteger axis = axes.location; axis < NSMaxRange(axes); axis++) {
+            @autoreleasepool {
+                [self foldWindowRange:range
+                               axis:axis
+                            builder:builders[axis - axes.location]
+                          finalPass:finalPass];
+            }
+        }
+
+        self.processedWindows += count;
+        [self.telemetry addWindowsDone:count];
+
+        // 下一个窗口从 processedWindows*step 开始，之前的行不再需要
+        NSInteger consumedRows = self.processedWindows * step - self.bufferBaseRow;
+        if (consumedRows > 0) {
+            [self.buffer removeLeadingRows:consumedRows];
+            self.bufferBaseRow += consumedRows;
+        }
+
+        [self sampleFootprint];
+        [self shrinkBatchIfOverBudgetFrom:batchStartFootprint windowCount:count];
+    }
+}
+
+/**
+ * 采样当前内存占用，更新整体峰值和批次峰值
+ * 在每个大块分配之后调用（堆叠、频谱缓存、响应计算），批次末尾只采样一次会漏掉批内的峰值
+ */
+- (void)sampleFootprint {
+    NSUInteger footprint = PIDCurrentFootprint();
+    self.peakFootprint = MAX(self.peakFootprint, footprint);
+    self.batchPeakFootprint = MAX(self.batchPeakFootprint, footprint);
+}
+
+/**
+ * 批次峰值超出预算时按实测的每窗口增量缩小批大小
+ * 新批大小 = (预算 - 批次开始时已用) / 每窗口实测增量，且至少减半；只缩小不放大，避免来回抖动
+ */
+- (void)shrinkBatchIfOverBudgetFrom:(NSUInteger)batchStartFootprint windowCount:(NSInteger)windowCount {
+    NSUInteger budget = self.config.memoryBudgetBytes;
+    NSUInteger baseline = self.baselineFootprint;
+    NSUInteger batchPeak = self.batchPeakFootprint;
+    if (self.batchWindows <= 1 || batchPeak <= baseline || batchPeak - baseline <= budget) {
+        return;
+    }
+
+    NSUInteger resident = batchStartFootprint > baseline ? batchStartFootprint - baseline : 0;
+    NSUInteger perWindow = batchPeak > batchStartFootprint
+                         ? (batchPeak - batchStartFootprint) / (NSUInteger)MAX(windowCount, 1) : 0;
+    NSInteger fitting = perWindow > 0 && budget > resident ? (NSInteger)((budget - resident) / perWindow) : 1;
+    NSInteger previous = self.batchWindows;
+    self.batchWindows = MAX(MIN(fitting, previous / 2), 1);
+
+    NSLog(@"⚠️ 外存分析批次峰值%.1fMB超出预算%.1fMB (每窗口实测%.1fMB)，每批窗口数 %ld → %ld",
+          (batchPeak - baseline) / 1048576.0, budget / 1048576.0, perWindow / 1048576.0,
+          (long)previous, (long)self.batchWindows);
+}
+
+- (void)foldWindowRange:(NSRange)range
+                   axis:(NSInteger)axis
+                builder:(PIDResponseCurveBuilder *)builder
+              finalPass:(BOOL)finalPass {
+    PIDCSVData *data = self.buffer;
+    if ([data axisPForAxis:axis].count == 0) {
+        return;
+    }
+
+    double pGain = axis < self.config.pGains.count ? [self.config.pGains[axis] doubleValue] : 0;
+    PIDStackData *stackData = [PIDStackData stackFromData:data
+                                                axisIndex:axis
+                                               windowSize:self.windowSize
+                                                  overlap:self.config.overlap
+                                                    pGain:pGain
+                                              windowRange:range];
+    if (stackData.windowCount == 0) {
+        return;
+    }
+    [self sampleFootprint];
+
+    PIDSpectralCache *spectralCache = [[PIDSpectralCache alloc] initWithStackData:stackData
+                                                                            window:self.hanningWindow];
+    [self sampleFootprint];
+    PIDResponseResult *response = [self.analyzer stackResponseWithSpectralCache:spectralCache];
+    [self sampleFootprint];
+    NSInteger windowCount = MIN(response.stepResponse.count, response.maxInput.count);
+    for (NSInteger w = 0; w < windowCount; w++) {
+        double maxInput = [response.maxInput[w] doubleValue];
+        if (finalPass) {
+            [builder addFinalPassWindow:response.stepResponse[w] maxInput:maxInput];
+        } else {
+            [builder addInitialPassWindow:response.stepResponse[w] maxInput:maxInput];
+        }
+    }
+
+    if (!finalPass && self.spectrumTime) {
+        PIDSpectrumResult *spectrum = [self.analyzer spectrumWithTime:self.spectrumTime spectralCache:spectralCache];
+        [self sampleFootprint];
+        [self accumulateSpectrum:spectrum axis:axis];
+    }
+}
+
+/**
+ * 批次的频谱累加器合并到该轴的累加器，平均谱与一次性分析的流式累加结果一致
+ */
+- (void)accumulateSpectrum:(PIDSpectrumResult *)spectrum axis:(NSInteger)axis {
+    if (!spectrum.accumulator || spectrum.accumulator.windowCount == 0) {
+        return;
+    }
+
+    id accumulator = self.spectrumAccumulators[axis];
+    if (accumulator == [NSNull null]) {
+        self.spectrumAccumulators[axis] = [spectrum.accumulator copy];
+    } else {
+        [(PIDSpectrumAccumulator *)accumulator addAccumulator:spectrum.accumulator];
+    }
+}
+
+- (NSArray<PIDSpectrumResult *> *)averagedSpectrums {
+    NSMutableArray<PIDSpectrumResult *> *spectrums = [NSMutableArray arrayWithCapacity:kOutOfCoreAxisCount];
+
+    for (NSInteger axis = 0; axis < kOutOfCoreAxisCount; axis++) {
+        PIDSpectrumResult *result = [[PIDSpectrumResult alloc] init];
+        id accumulator = self.spectrumAccumulators[axis];
+        if (accumulator != [NSNull null]) {
+            result.accumulator = accumulator;
+            result.frequencies = result.accumulator.frequencies;
+            result.spectrum = @[result.accumulator.averageSpectrum];
+        } else {
+            result.frequencies = @[];
+            result.spectrum = @[];
+        }
+        [spectrums addObject:result];
+    }
+
+    return spectrums;
+}
+
+@end
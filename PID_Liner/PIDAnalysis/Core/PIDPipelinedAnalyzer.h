@@ -0,0 +1,142 @@
+//
+//  PIDPipelinedAnalyzer.h
+//  PID_Liner
+//
+//  流水线分析器 - 边解析CSV边做窗口分析，并逐步发布中间结果
+//
+
+#ifndef PIDPipelinedAnalyzer_h
+#define PIDPipelinedAnalyzer_h
+
+#import <Foundation/Foundation.h>
+#import "PIDTraceAnalyzer.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+@class PIDCSVData;
+@class PIDProgressTelemetry;
+@class PIDCancellationToken;
+
+#pragma mark - 流水线配置
+
+/**
+ * 流水线分析配置
+ * 默认值与PIDAnalysisViewController的一次性分析保持一致
+ */
+@interface PIDPipelineConfig : NSObject
+
+// 窗口大小（8kHz参考采样率下的样本点数），默认8000；实际点数按分析采样率等比缩放
+@property (nonatomic, assign) NSInteger windowSize;
+
+// 窗口重叠比例，默认0.9375（Python superpos=16）
+@property (nonatomic, assign) double overlap;
+
+// 维纳反卷积截止频率 (Hz)，默认25
+@property (nonatomic, assign) double cutFreq;
+
+// 各轴P增益 [Roll, Pitch, Yaw]，默认45/50/55
+@property (nonatomic, copy) NSArray<NSNumber *> *pGains;
+
+// 解析器每块行数，默认4096
+@property (nonatomic, assign) NSInteger chunkRows;
+
+// 每累计多少个新窗口发布一次中间结果，默认32
+@property (nonatomic, assign) NSInteger publishInterval;
+
+// 是否重采样到规范分析采样率（见PIDPolyphaseResampler），默认YES
+@property (nonatomic, assign) BOOL resampleToAnalysisRate;
+
+// 是否保留完整数据供最终快照的data使用，默认NO：已分析窗口不再需要的行随即丢弃，
+// 内存只与窗口大小和块大小有关；需要画时域图或重新分析时设为YES
+@property (nonatomic, assign) BOOL retainsParsedData;
+
+// 分析精度（见PIDTraceAnalyzer.precision），默认PIDDSPPrecisionFloat32（应用的分析路径）；
+// 需要与Python参考逐点对齐时设为PIDDSPPrecisionFloat64
+@property (nonatomic, assign) PIDDSPPrecision precision;
+
++ (instancetype)defaultConfig;
+
+@end
+
+#pragma mark - 中间结果快照
+
+/**
+ * 流水线分析快照
+ * 中间快照的响应结果只包含上次发布之后新完成的窗口（从firstWindowIndex开始），
+ * 接收方按 PIDResponseResult appendWindowsFromResult: 自行累计，每次发布的代价与新窗口数成正比；
+ * 最终快照包含全部窗口。频谱累加器大小与窗口数无关，每份快照都是截至目前的累计结果。
+ * 快照交出后分析器不再修改其中的对象，可直接交给UI线程
+ */
+@interface PIDPipelineSnapshot : NSObject
+
+// 各轴响应结果 [Roll, Pitch, Yaw]（中间快照只含新窗口）
+@property (nonatomic, copy, readonly) NSArray<PIDResponseResult *> *responses;
+
+// responses中第一个窗口的编号：中间快照为上次发布时的窗口数，最终快照为0
+@property (nonatomic, assign, readonly) NSInteger firstWindowIndex;
+
+// 各轴噪声频谱 [Roll, Pitch, Yaw]（累计）
+@property (nonatomic, copy, readonly) NSArray<PIDSpectrumResult *> *spectrums;
+
+// 已解析的源文件行数（重采样之前）
+@property (nonatomic, assign, readonly) NSInteger rowCount;
+
+// 已完成分析的窗口数
+@property (nonatomic, assign, readonly) NSInteger windowCount;
+
+// 采样率 (Hz)，重采样后为分析采样率
+@property (nonatomic, assign, readonly) double sampleRate;
+
+// 是否为最终结果
+@property (nonatomic, assign, readonly, getter=isFinished) BOOL finished;
+
+// 完整CSV数据（仅最终快照、且配置了retainsParsedData时提供）
+@property (nonatomic, strong, readonly, nullable) PIDCSVData *data;
+
+@end
+
+#pragma mark - 流水线分析器
+
+/**
+ * 流水线分析器
+ *
+ * 解析线程每读完一块数据就交给串行分析队列，分析队列只处理
+ * 数据已完整覆盖的窗口 [k*step, k*step+windowSize)，因此I/O与计算重叠，
+ * 且最终结果与一次性解析后再分析完全一致（窗口编号和逐窗口计算都相同）
+ * 排队等待分析的数据块最多3块，分析跟不上时解析线程等待；整个文件都会读完，不受解析器的默认行数限制
+ *
+ * 需要重采样时，数据块先经流式多相重采样再拼接，快照中的数据为重采样后的数据
+ *
+ * 数据保存在滑动缓冲中（与 PIDOutOfCoreAnalyzer 相同），每批窗口分析后丢弃下一个窗口之前的行，
+ * 除非配置要求保留完整数据
+ */
+@interface PIDPipelinedAnalyzer : NSObject
+
+@property (nonatomic, strong, readonly) PIDPipelineConfig *config;
+
+// 最后错误信息
+@property (nonatomic, readonly, copy, nullable) NSString *lastErrorMessage;
+
+// 中间结果回调（主线程），每publishInterval个新窗口触发一次
+@property (nonatomic, copy, nullable) void (^snapshotHandler)(PIDPipelineSnapshot *snapshot);
+
+// 进度遥测（可选）：解析阶段上报字节/行，分析队列上报窗口数
+@property (nonatomic, strong, nullable) PIDProgressTelemetry *telemetry;
+
+// 取消令牌（可选）：交给解析器和窗口分析，取消后已排队的数据块直接跳过，不再发布快照
+@property (nonatomic, strong, nullable) PIDCancellationToken *cancellationToken;
+
+- (instancetype)initWithConfig:(nullable PIDPipelineConfig *)config;
+
+/**
+ * 流水线解析并分析CSV文件（阻塞调用，应在后台线程执行）
+ * @param filePath CSV文件完整路径
+ * @return 最终快照，解析失败或已取消返回nil
+ */
+- (nullable PIDPipelineSnapshot *)analyzeCSVFile:(NSString *)filePath;
+
+@end
+
+NS_ASSUME_NONNULL_END
+
+#endif /* PIDPipelinedAnalyzer_h */
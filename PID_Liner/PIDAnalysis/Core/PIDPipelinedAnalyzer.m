@@ -0,0 +1,396 @@
+//
+//  PIDPipelinedAnalyzer.m
+//  PID_Liner
+//
+//  流水线分析器实现 - 边解析CSV边做窗口分析，并逐步发布中间结果
+//
+
+#import "PIDPipelinedAnalyzer.h"
+#import "PIDCSVParser.h"
+#import "PIDDataModels.h"
+#import "PIDProgressTelemetry.h"
+#import "PIDPolyphaseResampler.h"
+#import "PIDSpectralCache.h"
+#import "PIDCancellationToken.h"
+#import "PIDParallel.h"
+
+// 分析的轴数 (Roll, Pitch, Yaw)
+static const NSInteger kPipelineAxisCount = 3;
+
+// 同时排队等待分析的数据块上限：分析比解析慢，解析线程在此处等待，内存不随文件长度增长
+static const long kPipelineMaxChunksInFlight = 3;
+
+#pragma mark - PIDPipelineConfig Implementation
+
+@implementation PIDPipelineConfig
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        _windowSize = 8000;
+        _overlap = 0.9375;
+        _cutFreq = 25.0;
+        _pGains = @[@45.0, @50.0, @55.0];
+        _chunkRows = 4096;
+        _publishInterval = 32;
+        _resampleToAnalysisRate = YES;
+        _retainsParsedData = NO;
+        _precision = PIDDSPPrecisionFloat32;
+    }
+    return self;
+}
+
++ (instancetype)defaultConfig {
+    return [[self alloc] init];
+}
+
+@end
+
+#pragma mark - PIDPipelineSnapshot Implementation
+
+@interface PIDPipelineSnapshot ()
+
+@property (nonatomic, copy, readwrite) NSArray<PIDResponseResult *> *responses;
+@property (nonatomic, assign, readwrite) NSInteger firstWindowIndex;
+@property (nonatomic, copy, readwrite) NSArray<PIDSpectrumResult *> *spectrums;
+@property (nonatomic, assign, readwrite) NSInteger rowCount;
+@property (nonatomic, assign, readwrite) NSInteger windowCount;
+@property (nonatomic, assign, readwrite) double sampleRate;
+@property (nonatomic, assign, readwrite, getter=isFinished) BOOL finished;
+@property (nonatomic, strong, readwrite, nullable) PIDCSVData *data;
+
+@end
+
+@implementation PIDPipelineSnapshot
+
+@end
+
+#pragma mark - PIDPipelinedAnalyzer Implementation
+
+@interface PIDPipelinedAnalyzer ()
+
+@property (nonatomic, copy, readwrite) NSString *lastErrorMessage;
+
+// 串行分析队列（所有累积状态只在此队列上访问）
+@property (nonatomic, strong) dispatch_queue_t analysisQueue;
+
+// 滑动缓冲：只保留尚未分析的窗口所需的行（retainsParsedData时保留全部），bufferBaseRow为缓冲第0行的行号
+@property (nonatomic, strong) PIDCSVData *buffer;
+@property (nonatomic, assign) NSInteger bufferBaseRow;
+
+// 已解析的源文件行数
+@property (nonatomic, assign) NSInteger parsedRows;
+
+// 分析器（第一块数据到达后按实际采样率创建）
+@property (nonatomic, strong, nullable) PIDTraceAnalyzer *analyzer;
+
+// Hanning窗（窗口长度固定，只生成一次）
+@property (nonatomic, strong, nullable) NSArray<NSNumber *> *hanningWindow;
+
+// 分析采样率 / 该采样率下的窗口大小 / 重采样器（第一块数据到达后确定，不需要重采样时为nil）
+@property (nonatomic, assign) double analysisRate;
+@property (nonatomic, assign) NSInteger windowSize;
+@property (nonatomic, strong, nullable) PIDPolyphaseResampler *resampler;
+
+// 各轴累积结果（最终快照使用）
+@property (nonatomic, strong) NSArray<PIDResponseResult *> *axisResponses;
+@property (nonatomic, strong) NSArray<PIDSpectrumResult *> *axisSpectrums;
+
+// 各轴上次发布之后的新窗口结果（发布时直接交给快照，不再复制）
+@property (nonatomic, strong) NSArray<PIDResponseResult *> *pendingResponses;
+
+// 已分析窗口数 / 上次发布时的窗口数
+@property (nonatomic, assign) NSInteger processedWindows;
+@property (nonatomic, assign) NSInteger publishedWindows;
+
+@end
+
+@implementation PIDPipelinedAnalyzer
+
+- (instancetype)initWithConfig:(PIDPipelineConfig *)config {
+    self = [super init];
+    if (self) {
+        _config = config ?: [PIDPipelineConfig defaultConfig];
+        _analysisQueue = dispatch_queue_create("com.pidliner.pipeline.analysis", DISPATCH_QUEUE_SERIAL);
+    }
+    return self;
+}
+
+#pragma mark - Public Methods
+
+- (nullable PIDPipelineSnapshot *)analyzeCSVFile:(NSString *)filePath {
+    [self resetState];
+
+    PIDCancellationToken *cancellationToken = self.cancellationToken;
+    PIDCSVParser *parser = [PIDCSVParser parser];
+    // 分块解析不受内存中行数限制：读到文件末尾
+    parser.config.maxRows = 0;
+    parser.verboseLogging = NO;
+    parser.cancellationToken = cancellationToken;
+
+    PIDProgressTelemetry *telemetry = self.telemetry;
+    if (telemetry) {
+        NSDictionary<NSFileAttributeKey, id> *attributes = [[NSFileManager defaultManager] attributesOfItemAtPath:filePath error:nil];
+        [telemetry addBytesTotal:(int64_t)attributes.fileSize];
+        [telemetry setStage:PIDTelemetryStageParse];
+        parser.telemetry = telemetry;
+    }
+
+    // 解析线程只负责读取和切块，计算全部交给串行分析队列；排队的数据块达到上限时解析线程等待
+    dispatch_semaphore_t chunksInFlight = dispatch_semaphore_create(kPipelineMaxChunksInFlight);
+    BOOL success = [parser parseCSV:filePath
+                          chunkRows:self.config.chunkRows
+                       chunkHandler:^(PIDCSVData *chunk, NSInteger rowOffset) {
+        dispatch_semaphore_wait(chunksInFlight, DISPATCH_TIME_FOREVER);
+        dispatch_async(self.analysisQueue, ^{
+            if (!cancellationToken.isCancelled) {
+                @autoreleasepool {
+                    self.parsedRows = MAX(self.parsedRows, rowOffset + chunk.dataLength);
+                    [self.buffer appendData:[self analysisChunkFromChunk:chunk]];
+                    [self analyzeReadyWindowsFinal:NO];
+                }
+            }
+            dispatch_semaphore_signal(chunksInFlight);
+        });
+    }];
+
+    if (!success) {
+        // 等待已提交的分析任务结束，避免与下一次分析交叉
+        dispatch_sync(self.analysisQueue, ^{});
+        self.lastErrorMessage = parser.lastErrorMessage ?: @"CSV解析失败";
+        return nil;
+    }
+
+    [telemetry setStage:PIDTelemetryStageAnalyze];
+
+    __block PIDPipelineSnapshot *finalSnapshot = nil;
+    dispatch_sync(self.analysisQueue, ^{
+        if (cancellationToken.isCancelled) {
+            return;
+        }
+        @autoreleasepool {
+            if (self.resampler) {
+                [self.buffer appendData:[self.resampler resampleChunk:nil final:YES]];
+            }
+            [self analyzeReadyWindowsFinal:YES];
+            finalSnapshot = [self makeSnapshotFinished:YES];
+        }
+    });
+
+    if (cancellationToken.isCancelled) {
+        self.lastErrorMessage = @"已取消";
+        return nil;
+    }
+
+    [telemetry setStage:PIDTelemetryStageFinished];
+
+    NSLog(@"✅ 流水线分析完成: %ld行, %ld窗口",
+          (long)finalSnapshot.rowCount, (long)finalSnapshot.windowCount);
+
+    return finalSnapshot;
+}
+
+#pragma mark - Private Methods
+
+- (void)resetState {
+    self.lastErrorMessage = nil;
+    self.buffer = [[PIDCSVData alloc] init];
+    self.bufferBaseRow = 0;
+    self.parsedRows = 0;
+    self.analyzer = nil;
+    self.hanningWindow = nil;
+    self.analysisRate = 0;
+    self.windowSize = 0;
+    self.resampler = nil;
+    self.processedWindows = 0;
+    self.publishedWindows = 0;
+
+    NSMutableArray<PIDSpectrumResult *> *spectrums = [NSMutableArray arrayWithCapacity:kPipelineAxisCount];
+    for (NSInteger axis = 0; axis < kPipelineAxisCount; axis++) {
+        PIDSpectrumResult *spectrum = [[PIDSpectrumResult alloc] init];
+        spectrum.frequencies = @[];
+        spectrum.spectrum = @[];
+        [spectrums addObject:spectrum];
+    }
+    self.axisResponses = [self emptyAxisResponses];
+    self.pendingResponses = [self emptyAxisResponses];
+    self.axisSpectrums = spectrums;
+}
+
+- (NSArray<PIDResponseResult *> *)emptyAxisResponses {
+    NSMutableArray<PIDResponseResult *> *responses = [NSMutableArray arrayWithCapacity:kPipelineAxisCount];
+    for (NSInteger axis = 0; axis < kPipelineAxisCount; axis++) {
+        PIDResponseResult *response = [[PIDResponseResult alloc] init];
+        response.stepResponse = @[];
+        response.avgTime = @[];
+        response.avgInput = @[];
+        response.maxInput = @[];
+        response.maxThrottle = @[];
+        [responses addObject:response];
+    }
+    return responses;
+}
+
+/**
+ * 第一块数据决定分析采样率和窗口大小，之后每块经重采样器转换（分析队列）
+ */
+- (PIDCSVData *)analysisChunkFromChunk:(PIDCSVData *)chunk {
+    if (self.windowSize == 0 && chunk.dataLength > 0) {
+        double sampleRate = chunk.sampleRate > 0 ? chunk.sampleRate : PIDReferenceAnalysisRate;
+        double analysisRate = sampleRate;
+        if (self.config.resampleToAnalysisRate) {
+            self.resampler = [PIDPolyphaseResampler resamplerForSampleRate:sampleRate];
+            analysisRate = [PIDPolyphaseResampler analysisRateForSampleRate:sampleRate];
+        }
+        self.windowSize = self.config.resampleToAnalysisRate
+            ? [PIDPolyphaseResampler windowSize:self.config.windowSize forAnalysisRate:analysisRate]
+            : self.config.windowSize;
+        // 分析器采样率与拼接后的数据一致：重采样器的输出采样率，否则为源数据采样率
+        self.analysisRate = self.resampler ? self.resampler.outputRate : sampleRate;
+    }
+
+    return self.resampler ? [self.resampler resampleChunk:chunk final:NO] : chunk;
+}
+
+/**
+ * 分析数据已完整覆盖的新窗口（分析队列）
+ * 非最终调用时攒够publishInterval个窗口才计算，减少小批量FFT的开销
+ */
+- (void)analyzeReadyWindowsFinal:(BOOL)final {
+    PIDCSVData *data = self.buffer;
+    NSInteger step = MAX((NSInteger)(self.windowSize * (1.0 - self.config.overlap)), 1);
+    NSInteger readyWindows = [PIDStackData windowCountForSampleCount:self.bufferBaseRow + data.dataLength
+                                                          windowSize:self.windowSize
+                                                             overlap:self.config.overlap];
+    NSInteger pending = readyWindows - self.processedWindows;
+    NSInteger batchSize = MAX(self.config.publishInterval, 1);
+
+    if (pending <= 0 || (!final && pending < batchSize)) {
+        return;
+    }
+
+    if (!self.analyzer) {
+        self.analyzer = [[PIDTraceAnalyzer alloc] initWithSampleRate:self.analysisRate cutFreq:self.config.cutFreq];
+        self.analyzer.cancellationToken = self.cancellationToken;
+        self.analyzer.pruneInactiveWindows = YES;
+        self.analyzer.precision = self.config.precision;
+        self.hanningWindow = [PIDTraceAnalyzer hanningWindowWithLength:self.windowSize];
+    }
+
+    // 缓冲起点总是步长的整数倍，窗口k在缓冲中的编号为 k - bufferBaseRow/step
+    NSRange range = NSMakeRange(self.processedWindows - self.bufferBaseRow / step, pending);
+
+    // 本批窗口三个轴一遍堆叠（共用油门/时间列与加窗统计量）
+    NSArray<PIDStackData *> *axisStacks = [PIDStackData stacksForAxesFromData:data
+                                                                   windowSize:self.windowSize
+                                                                      overlap:self.config.overlap
+                                                                       pGains:self.config.pGains ?: @[]
+                                                                  windowRange:range];
+
+    // 三个轴并行分析：每个轴只追加到自己的累计结果，互不干扰
+    PIDTraceAnalyzer *analyzer = self.analyzer;
+    NSArray<NSNumber *> *hanningWindow = self.hanningWindow;
+    PIDParallelForEach((size_t)kPipelineAxisCount, ^(size_t axisSlot) {
+        NSInteger axis = (NSInteger)axisSlot;
+        if ([data axisPForAxis:axis].count == 0) {
+            return;
+        }
+
+        PIDStackData *stackData = axisStacks[axis];
+        if (stackData.windowCount == 0) {
+            return;
+        }
+
+        PIDSpectralCache *spectralCache = [[PIDSpectralCache alloc] initWithStackData:stackData
+                                                                                window:hanningWindow];
+        PIDResponseResult *batch = [analyzer stackResponseWithSpectralCache:spectralCache];
+        [self.axisResponses[axis] appendWindowsFromResult:batch];
+        [self.pendingResponses[axis] appendWindowsFromResult:batch];
+
+        PIDSpectrumResult *spectrumBatch = [analyzer spectrumWithTime:data.timeSeconds
+                                                        spectralCache:spectralCache];
+        PIDSpectrumResult *spectrum = self.axisSpectrums[axis];
+        if (!spectrum.accumulator) {
+            spectrum.frequencies = spectrumBatch.frequencies;
+            spectrum.accumulator = [spectrumBatch.accumulator copy];
+        } else if (spectrumBatch.accumulator) {
+            [spectrum.accumulator addAccumulator:spectrumBatch.accumulator];
+        }
+    });
+
+    // 取消时本批结果不完整，不计入进度也不发布
+    if (analyzer.cancellationToken.isCancelled) {
+        return;
+    }
+
+    [self.telemetry addWindowsDone:pending];
+    self.processedWindows = readyWindows;
+
+    // 下一个窗口从 processedWindows*step 开始，之前的行不再需要
+    NSInteger consumedRows = self.processedWindows * step - self.bufferBaseRow;
+    if (!self.config.retainsParsedData && consumedRows > 0) {
+        [data removeLeadingRows:consumedRows];
+        self.bufferBaseRow += consumedRows;
+    }
+
+    if (!final && self.processedWindows - self.publishedWindows >= batchSize) {
+        [self publishSnapshot];
+    }
+}
+
+- (void)publishSnapshot {
+    NSInteger firstWindowIndex = self.publishedWindows;
+    self.publishedWindows = self.processedWindows;
+
+    // 新窗口的结果交给快照，之后另起一组，不论有没有接收方都不再累积
+    NSArray<PIDResponseResult *> *responses = self.pendingResponses;
+    self.pendingResponses = [self emptyAxisResponses];
+
+    void (^handler)(PIDPipelineSnapshot *) = self.snapshotHandler;
+    if (!handler) {
+        return;
+    }
+
+    PIDPipelineSnapshot *snapshot = [self makeSnapshotWithResponses:responses
+                                                   firstWindowIndex:firstWindowIndex
+                                                           finished:NO];
+    dispatch_async(dispatch_get_main_queue(), ^{
+        handler(snapshot);
+    });
+}
+
+- (PIDPipelineSnapshot *)makeSnapshotFinished:(BOOL)finished {
+    return [self makeSnapshotWithResponses:self.axisResponses firstWindowIndex:0 finished:finished];
+}
+
+/**
+ * 生成快照：响应结果直接交出（中间快照为本次的新窗口，最终快照为全部窗口），不复制窗口数组；
+ * 频谱累加器按值拷贝，大小与窗口数无关
+ */
+- (PIDPipelineSnapshot *)makeSnapshotWithResponses:(NSArray<PIDResponseResult *> *)responses
+                                  firstWindowIndex:(NSInteger)firstWindowIndex
+                                          finished:(BOOL)finished {
+    NSMutableArray<PIDSpectrumResult *> *spectrums = [NSMutableArray arrayWithCapacity:kPipelineAxisCount];
+
+    for (NSInteger axis = 0; axis < kPipelineAxisCount; axis++) {
+        PIDSpectrumResult *sourceSpectrum = self.axisSpectrums[axis];
+        PIDSpectrumResult *spectrum = [[PIDSpectrumResult alloc] init];
+        spectrum.frequencies = sourceSpectrum.frequencies;
+        spectrum.spectrum = @[];
+        spectrum.accumulator = [sourceSpectrum.accumulator copy];
+        [spectrums addObject:spectrum];
+    }
+
+    PIDPipelineSnapshot *snapshot = [[PIDPipelineSnapshot alloc] init];
+    snapshot.responses = responses;
+    snapshot.firstWindowIndex = firstWindowIndex;
+    snapshot.spectrums = spectrums;
+    snapshot.rowCount = self.parsedRows;
+    snapshot.windowCount = self.processedWindows;
+    snapshot.sampleRate = self.analysisRate;
+    snapshot.finished = finished;
+    snapshot.data = finished && self.config.retainsParsedData ? self.buffer : nil;
+    return snapshot;
+}
+
+@end
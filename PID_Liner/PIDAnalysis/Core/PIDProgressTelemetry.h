@@ -0,0 +1,107 @@
+//
+//  PIDProgressTelemetry.h
+//  PID_Liner
+//
+//  进度遥测 - 无锁计数器 + 合并后的节流回调，供解码/解析/分析共用
+//
+
+#ifndef PIDProgressTelemetry_h
+#define PIDProgressTelemetry_h
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+#pragma mark - 阶段与快照
+
+/**
+ * 处理阶段
+ */
+typedef NS_ENUM(NSInteger, PIDTelemetryStage) {
+    PIDTelemetryStageIdle = 0,      // 未开始
+    PIDTelemetryStageDecode,        // BBL解码
+    PIDTelemetryStageParse,         // CSV解析
+    PIDTelemetryStageAnalyze,       // 窗口分析
+    PIDTelemetryStageFinished,      // 已完成
+};
+
+/**
+ * 进度快照（值类型，可在任意线程读取后传递）
+ * total为0表示总量未知
+ */
+typedef struct {
+    PIDTelemetryStage stage;
+    int64_t rowsDone;
+    int64_t rowsTotal;
+    int64_t windowsDone;
+    int64_t windowsTotal;
+    int64_t bytesDone;
+    int64_t bytesTotal;
+} PIDTelemetrySnapshot;
+
+/**
+ * 快照完成比例 [0, 1]
+ * 优先使用字节数，其次窗口数、行数；总量都未知时返回-1
+ */
+FOUNDATION_EXPORT double PIDTelemetrySnapshotFraction(PIDTelemetrySnapshot snapshot);
+
+/**
+ * 阶段的中文名称（用于状态文字）
+ */
+FOUNDATION_EXPORT NSString *PIDTelemetryStageName(PIDTelemetryStage stage);
+
+#pragma mark - 进度遥测
+
+/**
+ * 进度遥测通道
+ *
+ * 工作线程只做relaxed原子加法/写入，不加锁、不向主线程派发任何任务；
+ * 界面通过snapshot主动轮询，或注册节流观察者：观察者由主线程定时器驱动，
+ * 只在数值变化时回调，因此无论工作线程更新多频繁，主线程的开销都只取决于刷新频率。
+ *
+ * 快照中的各字段分别原子读取，彼此之间不保证是同一时刻的值，仅用于显示。
+ */
+@interface PIDProgressTelemetry : NSObject
+
+/**
+ * 全部计数清零，阶段回到Idle（已注册的观察者保留）
+ */
+- (void)reset;
+
+// 当前阶段
+- (void)setStage:(PIDTelemetryStage)stage;
+
+// 完成量（增量，工作线程热路径调用）
+- (void)addRowsDone:(int64_t)count;
+- (void)addWindowsDone:(int64_t)count;
+- (void)addBytesDone:(int64_t)count;
+
+// 总量（增量；多遍读取的调用方可在开始前一次性加上全部遍数的总量）
+- (void)addRowsTotal:(int64_t)count;
+- (void)addWindowsTotal:(int64_t)count;
+- (void)addBytesTotal:(int64_t)count;
+
+/**
+ * 读取当前快照（任意线程）
+ */
+- (PIDTelemetrySnapshot)snapshot;
+
+/**
+ * 注册节流观察者
+ * @param interval 最短回调间隔（秒，<=0时使用1/15秒）
+ * @param handler 主线程回调，只在快照变化时触发；移除观察者时若有未送达的变化会再回调一次
+ * @return 观察者令牌，传给removeObserver:移除
+ */
+- (id<NSObject>)addObserverWithInterval:(NSTimeInterval)interval
+                                handler:(void(^)(PIDTelemetrySnapshot snapshot))handler;
+
+/**
+ * 移除节流观察者（任意线程）
+ */
+- (void)removeObserver:(id<NSObject>)observer;
+
+@end
+
+NS_ASSUME_NONNULL_END
+
+#endif /* PIDProgressTelemetry_h */
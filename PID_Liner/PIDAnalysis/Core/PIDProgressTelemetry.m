@@ -0,0 +1,216 @@
+//
+//  PIDProgressTelemetry.m
+//  PID_Liner
+//
+//  进度遥测实现 - C11 relaxed原子计数器，主线程定时器合并回调
+//
+
+#import "PIDProgressTelemetry.h"
+#include <stdatomic.h>
+
+// 默认观察间隔：1/15秒，足够流畅且主线程几乎无负担
+static const NSTimeInterval kDefaultObserverInterval = 1.0 / 15.0;
+
+#pragma mark - 辅助函数
+
+double PIDTelemetrySnapshotFraction(PIDTelemetrySnapshot snapshot) {
+    int64_t done = 0;
+    int64_t total = 0;
+    if (snapshot.bytesTotal > 0) {
+        done = snapshot.bytesDone;
+        total = snapshot.bytesTotal;
+    } else if (snapshot.windowsTotal > 0) {
+        done = snapshot.windowsDone;
+        total = snapshot.windowsTotal;
+    } else if (snapshot.rowsTotal > 0) {
+        done = snapshot.rowsDone;
+        total = snapshot.rowsTotal;
+    } else {
+        return snapshot.stage == PIDTelemetryStageFinished ? 1.0 : -1.0;
+    }
+    return MIN(MAX((double)done / (double)total, 0.0), 1.0);
+}
+
+NSString *PIDTelemetryStageName(PIDTelemetryStage stage) {
+    switch (stage) {
+        case PIDTelemetryStageDecode:   return @"解码";
+        case PIDTelemetryStageParse:    return @"解析";
+        case PIDTelemetryStageAnalyze:  return @"分析";
+        case PIDTelemetryStageFinished: return @"完成";
+        case PIDTelemetryStageIdle:
+        default:                        return @"等待";
+    }
+}
+
+static BOOL PIDTelemetrySnapshotEqual(PIDTelemetrySnapshot a, PIDTelemetrySnapshot b) {
+    return a.stage == b.stage
+        && a.rowsDone == b.rowsDone && a.rowsTotal == b.rowsTotal
+        && a.windowsDone == b.windowsDone && a.windowsTotal == b.windowsTotal
+        && a.bytesDone == b.bytesDone && a.bytesTotal == b.bytesTotal;
+}
+
+#pragma mark - 观察者令牌
+
+/**
+ * 节流观察者
+ * 定时器和lastSnapshot只在主线程访问
+ */
+@interface PIDTelemetryObserver : NSObject
+
+@property (nonatomic, weak) PIDProgressTelemetry *telemetry;
+@property (nonatomic, copy) void (^handler)(PIDTelemetrySnapshot snapshot);
+@property (nonatomic, strong) dispatch_source_t timer;
+@property (nonatomic, assign) PIDTelemetrySnapshot lastSnapshot;
+@property (nonatomic, assign) BOOL hasDelivered;
+
+- (void)deliverIfChanged;
+
+@end
+
+@implementation PIDTelemetryObserver
+
+- (void)deliverIfChanged {
+    PIDProgressTelemetry *telemetry = self.telemetry;
+    if (!telemetry) {
+        return;
+    }
+
+    PIDTelemetrySnapshot snapshot = [telemetry snapshot];
+    if (self.hasDelivered && PIDTelemetrySnapshotEqual(snapshot, self.lastSnapshot)) {
+        return;
+    }
+    self.lastSnapshot = snapshot;
+    self.hasDelivered = YES;
+    self.handler(snapshot);
+}
+
+- (void)dealloc {
+    // 调用方没有移除就释放了令牌：直接停止定时器，不再回调
+    if (_timer) {
+        dispatch_source_cancel(_timer);
+    }
+}
+
+@end
+
+#pragma mark - PIDProgressTelemetry Implementation
+
+@implementation PIDProgressTelemetry {
+    _Atomic(NSInteger) _stage;
+    _Atomic(int64_t) _rowsDone;
+    _Atomic(int64_t) _rowsTotal;
+    _Atomic(int64_t) _windowsDone;
+    _Atomic(int64_t) _windowsTotal;
+    _Atomic(int64_t) _bytesDone;
+    _Atomic(int64_t) _bytesTotal;
+}
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        [self reset];
+    }
+    return self;
+}
+
+- (void)reset {
+    atomic_store_explicit(&_stage, PIDTelemetryStageIdle, memory_order_relaxed);
+    atomic_store_explicit(&_rowsDone, 0, memory_order_relaxed);
+    atomic_store_explicit(&_rowsTotal, 0, memory_order_relaxed);
+    atomic_store_explicit(&_windowsDone, 0, memory_order_relaxed);
+    atomic_store_explicit(&_windowsTotal, 0, memory_order_relaxed);
+    atomic_store_explicit(&_bytesDone, 0, memory_order_relaxed);
+    atomic_store_explicit(&_bytesTotal, 0, memory_order_relaxed);
+}
+
+#pragma mark - 更新（工作线程）
+
+- (void)setStage:(PIDTelemetryStage)stage {
+    atomic_store_explicit(&_stage, stage, memory_order_relaxed);
+}
+
+- (void)addRowsDone:(int64_t)count {
+    atomic_fetch_add_explicit(&_rowsDone, count, memory_order_relaxed);
+}
+
+- (void)addWindowsDone:(int64_t)count {
+    atomic_fetch_add_explicit(&_windowsDone, count, memory_order_relaxed);
+}
+
+- (void)addBytesDone:(int64_t)count {
+    atomic_fetch_add_explicit(&_bytesDone, count, memory_order_relaxed);
+}
+
+- (void)addRowsTotal:(int64_t)count {
+    atomic_fetch_add_explicit(&_rowsTotal, count, memory_order_relaxed);
+}
+
+- (void)addWindowsTotal:(int64_t)count {
+    atomic_fetch_add_explicit(&_windowsTotal, count, memory_order_relaxed);
+}
+
+- (void)addBytesTotal:(int64_t)count {
+    atomic_fetch_add_explicit(&_bytesTotal, count, memory_order_relaxed);
+}
+
+#pragma mark - 读取
+
+- (PIDTelemetrySnapshot)snapshot {
+    PIDTelemetrySnapshot snapshot;
+    snapshot.stage = (PIDTelemetryStage)atomic_load_explicit(&_stage, memory_order_relaxed);
+    snapshot.rowsDone = atomic_load_explicit(&_rowsDone, memory_order_relaxed);
+    snapshot.rowsTotal = atomic_load_explicit(&_rowsTotal, memory_order_relaxed);
+    snapshot.windowsDone = atomic_load_explicit(&_windowsDone, memory_order_relaxed);
+    snapshot.windowsTotal = atomic_load_explicit(&_windowsTotal, memory_order_relaxed);
+    snapshot.bytesDone = atomic_load_explicit(&_bytesDone, memory_order_relaxed);
+    snapshot.bytesTotal = atomic_load_explicit(&_bytesTotal, memory_order_relaxed);
+    return snapshot;
+}
+
+#pragma mark - 节流观察者
+
+- (id<NSObject>)addObserverWithInterval:(NSTimeInterval)interval
+                                handler:(void(^)(PIDTelemetrySnapshot))handler {
+    if (interval <= 0) {
+        interval = kDefaultObserverInterval;
+    }
+
+    PIDTelemetryObserver *observer = [[PIDTelemetryObserver alloc] init];
+    observer.telemetry = self;
+    observer.handler = handler;
+
+    uint64_t intervalNs = (uint64_t)(interval * NSEC_PER_SEC);
+    dispatch_source_t timer = dispatch_source_create(DISPATCH_SOURCE_TYPE_TIMER, 0, 0, dispatch_get_main_queue());
+    dispatch_source_set_timer(timer, dispatch_time(DISPATCH_TIME_NOW, (int64_t)intervalNs), intervalNs, intervalNs / 4);
+
+    // 定时器只弱引用令牌，令牌被释放时定时器随之取消
+    __weak PIDTelemetryObserver *weakObserver = observer;
+    dispatch_source_set_event_handler(timer, ^{
+        [weakObserver deliverIfChanged];
+    });
+    observer.timer = timer;
+    dispatch_resume(timer);
+
+    return observer;
+}
+
+- (void)removeObserver:(id<NSObject>)observer {
+    if (![observer isKindOfClass:[PIDTelemetryObserver class]]) {
+        return;
+    }
+
+    PIDTelemetryObserver *telemetryObserver = (PIDTelemetryObserver *)observer;
+    dispatch_source_t timer = telemetryObserver.timer;
+    if (!timer) {
+        return;
+    }
+    telemetryObserver.timer = nil;
+
+    // 取消回调在主线程执行：补发最后一次变化，保证观察者看到最终进度
+    dispatch_source_set_cancel_handler(timer, ^{
+        [telemetryObserver deliverIfChanged];
+    });
+    dispatch_source_cancel(timer);
+}
+
+@end
@@ -0,0 +1,123 @@
+//
+//  PIDSessionCatalog.h
+//  PID_Liner
+//
+//  Session目录 - 持久化的CSV Session元数据索引（SQLite）
+//
+
+#ifndef PIDSessionCatalog_h
+#define PIDSessionCatalog_h
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+#pragma mark - 目录条目
+
+/**
+ * 单个CSV Session的元数据
+ * 由后台索引器从文件头尾读取，不需要完整解析CSV
+ */
+@interface PIDSessionCatalogEntry : NSObject
+
+@property (nonatomic, copy) NSString *fileName;              // CSV文件名（目录主键）
+@property (nonatomic, copy) NSString *filePath;              // CSV完整路径（由Documents目录拼接）
+@property (nonatomic, copy) NSString *sourceBBL;             // 源BBL文件名
+@property (nonatomic, assign) NSInteger sessionIndex;        // Session索引
+@property (nonatomic, assign) long long fileSize;            // 文件大小(字节)
+@property (nonatomic, strong) NSDate *createTime;            // 创建时间
+@property (nonatomic, strong) NSDate *modificationTime;      // 修改时间（用于判断是否需要重新索引）
+@property (nonatomic, assign) NSInteger rowCount;            // 数据行数（不含表头）
+@property (nonatomic, assign) double durationSeconds;        // 时长(秒)
+@property (nonatomic, assign) double sampleRate;             // 采样率 (Hz)
+
+// 分析摘要指标（分析完成后写入，未分析时为nil）
+// 例如 @{@"roll.peak": @1.05, @"roll.lowWindows": @120}
+@property (nonatomic, copy, nullable) NSDictionary<NSString *, NSNumber *> *metrics;
+
+@end
+
+#pragma mark - Session目录
+
+/**
+ * Session目录
+ *
+ * 以SQLite保存Documents目录下每个CSV的元数据。历史页面按页查询，
+ * 打开页面的开销与文件总数无关；目录与磁盘的同步由后台索引器完成，
+ * 只对新增或大小/修改时间变化的文件读取头尾数据。
+ *
+ * 所有数据库操作在内部串行队列执行，回调统一回到主线程。
+ */
+@interface PIDSessionCatalog : NSObject
+
+// 被索引的目录（默认Documents）
+@property (nonatomic, copy, readonly) NSString *documentsDirectory;
+
+/**
+ * 共享目录（数据库位于Application Support/SessionCatalog.sqlite）
+ */
++ (instancetype)sharedCatalog;
+
+/**
+ * 使用指定数据库和索引目录初始化
+ * @param databasePath SQLite数据库文件路径
+ * @param documentsDirectory 需要索引的CSV所在目录
+ */
+- (instancetype)initWithDatabasePath:(NSString *)databasePath
+                  documentsDirectory:(NSString *)documentsDirectory;
+
+/**
+ * 分页查询（按创建时间倒序）
+ * @param offset 起始位置
+ * @param limit 最大条数
+ * @param completion 主线程回调 (本页条目, 目录总条数)
+ */
+- (void)fetchEntriesWithOffset:(NSInteger)offset
+                         limit:(NSInteger)limit
+                    completion:(void(^)(NSArray<PIDSessionCatalogEntry *> *entries, NSInteger totalCount))completion;
+
+/**
+ * 后台同步目录与磁盘
+ * 新增/变化的文件重新读取元数据，已删除的文件从目录移除
+ * @param completion 主线程回调 (发生变化的条目数)
+ */
+- (void)refreshIndexWithCompletion:(nullable void(^)(NSInteger changedCount))completion;
+
+/**
+ * 立即索引单个文件（例如转换完成后）
+ * @param filePath CSV完整路径
+ */
+- (void)indexFileAtPath:(NSString *)filePath;
+
+/**
+ * 写入分析摘要指标
+ * @param metrics 指标字典（会与已有指标合并）
+ * @param filePath CSV完整路径
+ */
+- (void)updateMetrics:(NSDictionary<NSString *, NSNumber *> *)metrics
+          forFilePath:(NSString *)filePath;
+
+/**
+ * 移除单个条目（不删除文件）
+ */
+- (void)removeEntryForFileName:(NSString *)fileName;
+
+/**
+ * 清空目录（不删除文件）
+ * @param completion 主线程回调，返回被移除条目的文件路径，便于调用方删除文件
+ */
+- (void)removeAllEntriesWithCompletion:(nullable void(^)(NSArray<NSString *> *filePaths))completion;
+
+/**
+ * 从CSV文件名解析源BBL和Session索引
+ * 格式: {源文件}_{日期}_{时间戳}_session{N}.csv
+ */
++ (void)parseFileName:(NSString *)fileName
+            sourceBBL:(NSString * _Nullable * _Nonnull)sourceBBL
+         sessionIndex:(NSInteger *)sessionIndex;
+
+@end
+
+NS_ASSUME_NONNULL_END
+
+#endif /* PIDSessionCatalog_h */
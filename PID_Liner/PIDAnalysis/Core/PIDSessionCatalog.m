@@ -0,0 +1,552 @@
+//
+//  PIDSessionCatalog.m
+//  PID_Liner
+//
+//  Session目录实现 - 持久化的CSV Session元数据索引（SQLite）
+//
+
+#import "PIDSessionCatalog.h"
+#import <sqlite3.h>
+#include <stdio.h>
+#include <string.h>
+
+// 数据库结构版本
+static const int kCatalogSchemaVersion = 1;
+
+// 读取文件尾部时的回溯字节数（足够容纳一行CSV）
+static const long kTailProbeBytes = 8 * 1024;
+
+// 统计行数时的读取块大小
+static const size_t kLineCountBlockSize = 64 * 1024;
+
+#pragma mark - CSV头尾读取（C辅助函数）
+
+/**
+ * 在逗号分隔的行中查找字段索引
+ */
+static NSInteger PIDCatalogFindColumn(char *header, const char *const *names, int nameCount) {
+    NSInteger column = 0;
+    char *cursor = header;
+    while (cursor) {
+        char *comma = strchr(cursor, ',');
+        if (comma) *comma = '\0';
+
+        // 去除首尾空白
+        while (*cursor == ' ' || *cursor == '\t') cursor++;
+        size_t len = strlen(cursor);
+        while (len > 0 && (cursor[len - 1] == ' ' || cursor[len - 1] == '\r' || cursor[len - 1] == '\n')) {
+            cursor[--len] = '\0';
+        }
+
+        for (int i = 0; i < nameCount; i++) {
+            if (strcmp(cursor, names[i]) == 0) {
+                return column;
+            }
+        }
+
+        column++;
+        cursor = comma ? comma + 1 : NULL;
+    }
+    return -1;
+}
+
+/**
+ * 读取行中第column个字段的数值
+ */
+static double PIDCatalogFieldValue(const char *line, NSInteger column) {
+    const char *cursor = line;
+    for (NSInteger i = 0; i < column && cursor; i++) {
+        cursor = strchr(cursor, ',');
+        if (cursor) cursor++;
+    }
+    if (!cursor || *cursor == '\0' || *cursor == '\n') {
+        return NAN;
+    }
+    char *end = NULL;
+    double value = strtod(cursor, &end);
+    return end == cursor ? NAN : value;
+}
+
+/**
+ * 只读取CSV头部两行、尾部一行并流式统计换行数
+ * 采样率与PIDCSVParser一致：1e6 / (t1 - t0)
+ */
+static BOOL PIDCatalogReadCSVSummary(const char *path, NSInteger *rowCount, double *durationSeconds, double *sampleRate) {
+    FILE *file = fopen(path, "rb");
+    if (!file) {
+        return NO;
+    }
+
+    static const char *const kTimeFields[] = {"time", "time (us)"};
+    char line[8192];
+    BOOL ok = NO;
+    double t0 = NAN, t1 = NAN, tLast = NAN;
+    NSInteger timeColumn = -1;
+
+    if (fgets(line, sizeof(line), file)) {
+        timeColumn = PIDCatalogFindColumn(line, kTimeFields, 2);
+    }
+
+    if (timeColumn >= 0) {
+        if (fgets(line, sizeof(line), file)) t0 = PIDCatalogFieldValue(line, timeColumn);
+        if (fgets(line, sizeof(line), file)) t1 = PIDCatalogFieldValue(line, timeColumn);
+
+        // 流式统计换行数
+        rewind(file);
+        NSInteger newlines = 0;
+        char lastChar = '\n';
+        char *block = malloc(kLineCountBlockSize);
+        size_t n;
+        while (block && (n = fread(block, 1, kLineCountBlockSize, file)) > 0) {
+            const char *p = block;
+            const char *end = block + n;
+            while ((p = memchr(p, '\n', end - p))) {
+                newlines++;
+                p++;
+            }
+            lastChar = block[n - 1];
+        }
+        free(block);
+        NSInteger totalLines = newlines + (lastChar != '\n' ? 1 : 0);
+        *rowCount = MAX(totalLines - 1, 0);
+
+        // 读取最后一个非空行
+        fseek(file, 0, SEEK_END);
+        long size = ftell(file);
+        long probe = MIN(size, kTailProbeBytes);
+        fseek(file, size - probe, SEEK_SET);
+        char *tail = calloc((size_t)probe + 1, 1);
+        if (tail && fread(tail, 1, (size_t)probe, file) == (size_t)probe) {
+            long end = probe;
+            while (end > 0 && (tail[end - 1] == '\n' || tail[end - 1] == '\r')) {
+                tail[--end] = '\0';
+            }
+            long start = end;
+            while (start > 0 && tail[start - 1] != '\n') {
+                start--;
+            }
+            tLast = PIDCatalogFieldValue(tail + start, timeColumn);
+        }
+        free(tail);
+
+        double diff = t1 - t0;
+        *sampleRate = (isfinite(diff) && diff > 0) ? 1000000.0 / diff : 0;
+        *durationSeconds = (isfinite(tLast) && isfinite(t0) && tLast > t0) ? (tLast - t0) * 1e-6 : 0;
+        ok = YES;
+    }
+
+    fclose(file);
+    return ok;
+}
+
+#pragma mark - PIDSessionCatalogEntry Implementation
+
+@implementation PIDSessionCatalogEntry
+
+@end
+
+#pragma mark - PIDSessionCatalog Implementation
+
+@interface PIDSessionCatalog ()
+
+@property (nonatomic, copy, readwrite) NSString *documentsDirectory;
+@property (nonatomic, copy) NSString *databasePath;
+
+// 串行队列：独占数据库连接
+@property (nonatomic, strong) dispatch_queue_t queue;
+
+@end
+
+@implementation PIDSessionCatalog {
+    sqlite3 *_db;
+}
+
++ (instancetype)sharedCatalog {
+    static PIDSessionCatalog *catalog = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        NSString *supportDir = NSSearchPathForDirectoriesInDomains(NSApplicationSupportDirectory, NSUserDomainMask, YES).firstObject;
+        [[NSFileManager defaultManager] createDirectoryAtPath:supportDir withIntermediateDirectories:YES attributes:nil error:nil];
+        NSString *dbPath = [supportDir stringByAppendingPathComponent:@"SessionCatalog.sqlite"];
+        NSString *documentsDir = NSSearchPathForDirectoriesInDomains(NSDocumentDirectory, NSUserDomainMask, YES).firstObject;
+        catalog = [[PIDSessionCatalog alloc] initWithDatabasePath:dbPath documentsDirectory:documentsDir];
+    });
+    return catalog;
+}
+
+- (instancetype)initWithDatabasePath:(NSString *)databasePath
+                  documentsDirectory:(NSString *)documentsDirectory {
+    self = [super init];
+    if (self) {
+        _databasePath = [databasePath copy];
+        _documentsDirectory = [documentsDirectory copy];
+        _queue = dispatch_queue_create("com.pidliner.sessioncatalog", DISPATCH_QUEUE_SERIAL);
+
+        dispatch_async(_queue, ^{
+            [self openDatabase];
+        });
+    }
+    return self;
+}
+
+- (void)dealloc {
+    if (_db) {
+        sqlite3_close(_db);
+        _db = NULL;
+    }
+}
+
+#pragma mark - Public Methods
+
+- (void)fetchEntriesWithOffset:(NSInteger)offset
+                         limit:(NSInteger)limit
+                    completion:(void(^)(NSArray<PIDSessionCatalogEntry *> *, NSInteger))completion {
+    dispatch_async(self.queue, ^{
+        NSMutableArray<PIDSessionCatalogEntry *> *entries = [NSMutableArray arrayWithCapacity:MAX(limit, 0)];
+        NSInteger total = 0;
+
+        if (self->_db) {
+            sqlite3_stmt *stmt = NULL;
+            const char *sql = "SELECT file_name, source_bbl, session_index, file_size, created_at, modified_at, "
+                              "row_count, duration, sample_rate, metrics FROM sessions "
+                              "ORDER BY created_at DESC, file_name ASC LIMIT ? OFFSET ?";
+            if (sqlite3_prepare_v2(self->_db, sql, -1, &stmt, NULL) == SQLITE_OK) {
+                sqlite3_bind_int64(stmt, 1, limit);
+                sqlite3_bind_int64(stmt, 2, offset);
+                while (sqlite3_step(stmt) == SQLITE_ROW) {
+                    [entries addObject:[self entryFromStatement:stmt]];
+                }
+            }
+            sqlite3_finalize(stmt);
+
+            if (sqlite3_prepare_v2(self->_db, "SELECT COUNT(*) FROM sessions", -1, &stmt, NULL) == SQLITE_OK &&
+                sqlite3_step(stmt) == SQLITE_ROW) {
+                total = (NSInteger)sqlite3_column_int64(stmt, 0);
+            }
+            sqlite3_finalize(stmt);
+        }
+
+        dispatch_async(dispatch_get_main_queue(), ^{
+            completion(entries, total);
+        });
+    });
+}
+
+- (void)refreshIndexWithCompletion:(void(^)(NSInteger))completion {
+    dispatch_async(self.queue, ^{
+        NSInteger changed = [self synchronizeWithDisk];
+        if (completion) {
+            dispatch_async(dispatch_get_main_queue(), ^{
+                completion(changed);
+            });
+        }
+    });
+}
+
+- (void)indexFileAtPath:(NSString *)filePath {
+    dispatch_async(self.queue, ^{
+        NSURL *url = [NSURL fileURLWithPath:filePath];
+        NSDictionary<NSURLResourceKey, id> *values = [url resourceValuesForKeys:[self resourceKeys] error:nil];
+        if (values) {
+            [self indexFileAtURL:url resourceValues:values];
+        }
+    });
+}
+
+- (void)updateMetrics:(NSDictionary<NSString *, NSNumber *> *)metrics
+          forFilePath:(NSString *)filePath {
+    NSString *fileName = filePath.lastPathComponent;
+    NSDictionary *metricsCopy = [metrics copy];
+
+    dispatch_async(self.queue, ^{
+        if (!self->_db || metricsCopy.count == 0) {
+            return;
+        }
+
+        // 与已有指标合并
+        NSMutableDictionary *merged = [NSMutableDictionary dictionary];
+        sqlite3_stmt *stmt = NULL;
+        if (sqlite3_prepare_v2(self->_db, "SELECT metrics FROM sessions WHERE file_name = ?", -1, &stmt, NULL) == SQLITE_OK) {
+            sqlite3_bind_text(stmt, 1, fileName.UTF8String, -1, SQLITE_TRANSIENT);
+            if (sqlite3_step(stmt) == SQLITE_ROW) {
+                NSDictionary *existing = [self metricsFromColumn:stmt index:0];
+                if (existing) {
+                    [merged addEntriesFromDictionary:existing];
+                }
+            }
+        }
+        sqlite3_finalize(stmt);
+        [merged addEntriesFromDictionary:metricsCopy];
+
+        NSData *json = [NSJSONSerialization dataWithJSONObject:merged options:0 error:nil];
+        if (!json) {
+            return;
+        }
+
+        if (sqlite3_prepare_v2(self->_db, "UPDATE sessions SET metrics = ? WHERE file_name = ?", -1, &stmt, NULL) == SQLITE_OK) {
+            sqlite3_bind_blob(stmt, 1, json.bytes, (int)json.length, SQLITE_TRANSIENT);
+            sqlite3_bind_text(stmt, 2, fileName.UTF8String, -1, SQLITE_TRANSIENT);
+            sqlite3_step(stmt);
+        }
+        sqlite3_finalize(stmt);
+    });
+}
+
+- (void)removeEntryForFileName:(NSString *)fileName {
+    dispatch_async(self.queue, ^{
+        [self deleteEntryNamed:fileName];
+    });
+}
+
+- (void)removeAllEntriesWithCompletion:(void(^)(NSArray<NSString *> *))completion {
+    dispatch_async(self.queue, ^{
+        NSMutableArray<NSString *> *paths = [NSMutableArray array];
+        if (self->_db) {
+            sqlite3_stmt *stmt = NULL;
+            if (sqlite3_prepare_v2(self->_db, "SELECT file_name FROM sessions", -1, &stmt, NULL) == SQLITE_OK) {
+                while (sqlite3_step(stmt) == SQLITE_ROW) {
+                    NSString *name = [NSString stringWithUTF8String:(const char *)sqlite3_column_text(stmt, 0)];
+                    [paths addObject:[self.documentsDirectory stringByAppendingPathComponent:name]];
+                }
+            }
+            sqlite3_finalize(stmt);
+            sqlite3_exec(self->_db, "DELETE FROM sessions", NULL, NULL, NULL);
+        }
+
+        if (completion) {
+            dispatch_async(dispatch_get_main_queue(), ^{
+                completion(paths);
+            });
+        }
+    });
+}
+
++ (void)parseFileName:(NSString *)fileName
+            sourceBBL:(NSString **)sourceBBL
+         sessionIndex:(NSInteger *)sessionIndex {
+    NSString *baseName = [fileName stringByDeletingPathExtension];
+    NSArray<NSString *> *parts = [baseName componentsSeparatedByString:@"_session"];
+
+    if (parts.count >= 2) {
+        *sourceBBL = parts[0];
+        *sessionIndex = [parts[1] integerValue];
+    } else {
+        *sourceBBL = baseName;
+        *sessionIndex = 0;
+    }
+}
+
+#pragma mark - Private Methods - 数据库
+
+- (void)openDatabase {
+    if (sqlite3_open_v2(self.databasePath.UTF8String, &_db,
+                        SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE | SQLITE_OPEN_NOMUTEX, NULL) != SQLITE_OK) {
+        NSLog(@"❌ Session目录打开失败: %s", _db ? sqlite3_errmsg(_db) : "unknown");
+        sqlite3_close(_db);
+        _db = NULL;
+        return;
+    }
+
+    sqlite3_exec(_db, "PRAGMA journal_mode=WAL", NULL, NULL, NULL);
+
+    int version = 0;
+    sqlite3_stmt *stmt = NULL;
+    if (sqlite3_prepare_v2(_db, "PRAGMA user_version", -1, &stmt, NULL) == SQLITE_OK &&
+        sqlite3_step(stmt) == SQLITE_ROW) {
+        version = sqlite3_column_int(stmt, 0);
+    }
+    sqlite3_finalize(stmt);
+
+    if (version != kCatalogSchemaVersion) {
+        // 目录只是缓存，结构变化时直接重建，由索引器重新填充
+        sqlite3_exec(_db, "DROP TABLE IF EXISTS sessions", NULL, NULL, NULL);
+    }
+
+    const char *schema =
+        "CREATE TABLE IF NOT EXISTS sessions ("
+        "  file_name TEXT PRIMARY KEY,"
+        "  source_bbl TEXT,"
+        "  session_index INTEGER,"
+        "  file_size INTEGER,"
+        "  created_at REAL,"
+        "  modified_at REAL,"
+        "  row_count INTEGER,"
+        "  duration REAL,"
+        "  sample_rate REAL,"
+        "  metrics BLOB);"
+        "CREATE INDEX IF NOT EXISTS idx_sessions_created ON sessions(created_at DESC, file_name ASC);";
+    char *error = NULL;
+    if (sqlite3_exec(_db, schema, NULL, NULL, &error) != SQLITE_OK) {
+        NSLog(@"❌ Session目录建表失败: %s", error);
+        sqlite3_free(error);
+        return;
+    }
+
+    NSString *pragma = [NSString stringWithFormat:@"PRAGMA user_version = %d", kCatalogSchemaVersion];
+    sqlite3_exec(_db, pragma.UTF8String, NULL, NULL, NULL);
+}
+
+- (PIDSessionCatalogEntry *)entryFromStatement:(sqlite3_stmt *)stmt {
+    PIDSessionCatalogEntry *entry = [[PIDSessionCatalogEntry alloc] init];
+    entry.fileName = [NSString stringWithUTF8String:(const char *)sqlite3_column_text(stmt, 0)];
+    entry.filePath = [self.documentsDirectory stringByAppendingPathComponent:entry.fileName];
+    const unsigned char *source = sqlite3_column_text(stmt, 1);
+    entry.sourceBBL = source ? [NSString stringWithUTF8String:(const char *)source] : @"未知";
+    entry.sessionIndex = (NSInteger)sqlite3_column_int64(stmt, 2);
+    entry.fileSize = sqlite3_column_int64(stmt, 3);
+    entry.createTime = [NSDate dateWithTimeIntervalSince1970:sqlite3_column_double(stmt, 4)];
+    entry.modificationTime = [NSDate dateWithTimeIntervalSince1970:sqlite3_column_double(stmt, 5)];
+    entry.rowCount = (NSInteger)sqlite3_column_int64(stmt, 6);
+    entry.durationSeconds = sqlite3_column_double(stmt, 7);
+    entry.sampleRate = sqlite3_column_double(stmt, 8);
+    entry.metrics = [self metricsFromColumn:stmt index:9];
+    return entry;
+}
+
+- (nullable NSDictionary *)metricsFromColumn:(sqlite3_stmt *)stmt index:(int)index {
+    const void *bytes = sqlite3_column_blob(stmt, index);
+    int length = sqlite3_column_bytes(stmt, index);
+    if (!bytes || length <= 0) {
+        return nil;
+    }
+    NSData *data = [NSData dataWithBytes:bytes length:(NSUInteger)length];
+    id object = [NSJSONSerialization JSONObjectWithData:data options:0 error:nil];
+    return [object isKindOfClass:[NSDictionary class]] ? object : nil;
+}
+
+- (void)deleteEntryNamed:(NSString *)fileName {
+    if (!_db) {
+        return;
+    }
+    sqlite3_stmt *stmt = NULL;
+    if (sqlite3_prepare_v2(_db, "DELETE FROM sessions WHERE file_name = ?", -1, &stmt, NULL) == SQLITE_OK) {
+        sqlite3_bind_text(stmt, 1, fileName.UTF8String, -1, SQLITE_TRANSIENT);
+        sqlite3_step(stmt);
+    }
+    sqlite3_finalize(stmt);
+}
+
+#pragma mark - Private Methods - 索引
+
+- (NSArray<NSURLResourceKey> *)resourceKeys {
+    return @[NSURLFileSizeKey, NSURLContentModificationDateKey, NSURLCreationDateKey, NSURLIsRegularFileKey];
+}
+
+/**
+ * 同步目录与磁盘（目录队列）
+ * 目录属性由一次目录枚举批量获取，只有新增/变化的文件才会被打开读取
+ * @return 新增、更新或移除的条目数
+ */
+- (NSInteger)synchronizeWithDisk {
+    if (!_db) {
+        return 0;
+    }
+
+    // 目录中已有的 文件名 -> (大小, 修改时间)
+    NSMutableDictionary<NSString *, NSArray<NSNumber *> *> *known = [NSMutableDictionary dictionary];
+    sqlite3_stmt *stmt = NULL;
+    if (sqlite3_prepare_v2(_db, "SELECT file_name, file_size, modified_at FROM sessions", -1, &stmt, NULL) == SQLITE_OK) {
+        while (sqlite3_step(stmt) == SQLITE_ROW) {
+            NSString *name = [NSString stringWithUTF8String:(const char *)sqlite3_column_text(stmt, 0)];
+            known[name] = @[@(sqlite3_column_int64(stmt, 1)), @(sqlite3_column_double(stmt, 2))];
+        }
+    }
+    sqlite3_finalize(stmt);
+
+    NSURL *directory = [NSURL fileURLWithPath:self.documentsDirectory isDirectory:YES];
+    NSArray<NSURL *> *urls = [[NSFileManager defaultManager] contentsOfDirectoryAtURL:directory
+                                                           includingPropertiesForKeys:[self resourceKeys]
+                                                                              options:NSDirectoryEnumerationSkipsHiddenFiles
+                                                                                error:nil];
+
+    NSInteger changed = 0;
+    sqlite3_exec(_db, "BEGIN", NULL, NULL, NULL);
+
+    for (NSURL *url in urls) {
+        if (![url.pathExtension.lowercaseString isEqualToString:@"csv"]) {
+            continue;
+        }
+
+        @autoreleasepool {
+            NSDictionary<NSURLResourceKey, id> *values = [url resourceValuesForKeys:[self resourceKeys] error:nil];
+            if (![values[NSURLIsRegularFileKey] boolValue]) {
+                continue;
+            }
+
+            NSString *name = url.lastPathComponent;
+            NSArray<NSNumber *> *previous = known[name];
+            [known removeObjectForKey:name];
+
+            long long size = [values[NSURLFileSizeKey] longLongValue];
+            double modified = [values[NSURLContentModificationDateKey] timeIntervalSince1970];
+            if (previous && previous[0].longLongValue == size && fabs(previous[1].doubleValue - modified) < 1e-3) {
+                continue;
+            }
+
+            if ([self indexFileAtURL:url resourceValues:values]) {
+                changed++;
+            }
+        }
+    }
+
+    // 剩下的是磁盘上已不存在的文件
+    for (NSString *name in known) {
+        [self deleteEntryNamed:name];
+        changed++;
+    }
+
+    sqlite3_exec(_db, "COMMIT", NULL, NULL, NULL);
+
+    if (changed > 0) {
+        NSLog(@"📚 Session目录已更新: %ld个条目变化", (long)changed);
+    }
+    return changed;
+}
+
+/**
+ * 读取单个文件的元数据并写入目录（目录队列）
+ * 文件内容变化意味着旧的分析指标已失效，因此一并清空
+ */
+- (BOOL)indexFileAtURL:(NSURL *)url resourceValues:(NSDictionary<NSURLResourceKey, id> *)values {
+    if (!_db) {
+        return NO;
+    }
+
+    NSInteger rowCount = 0;
+    double duration = 0;
+    double sampleRate = 0;
+    if (!PIDCatalogReadCSVSummary(url.fileSystemRepresentation, &rowCount, &duration, &sampleRate)) {
+        NSLog(@"⚠️ Session目录: 无法读取 %@", url.lastPathComponent);
+        return NO;
+    }
+
+    NSString *name = url.lastPathComponent;
+    NSString *sourceBBL = nil;
+    NSInteger sessionIndex = 0;
+    [PIDSessionCatalog parseFileName:name sourceBBL:&sourceBBL sessionIndex:&sessionIndex];
+
+    NSDate *created = values[NSURLCreationDateKey] ?: values[NSURLContentModificationDateKey] ?: [NSDate date];
+    NSDate *modified = values[NSURLContentModificationDateKey] ?: created;
+
+    const char *sql = "INSERT OR REPLACE INTO sessions "
+                      "(file_name, source_bbl, session_index, file_size, created_at, modified_at, row_count, duration, sample_rate, metrics) "
+                      "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, NULL)";
+    sqlite3_stmt *stmt = NULL;
+    BOOL success = NO;
+    if (sqlite3_prepare_v2(_db, sql, -1, &stmt, NULL) == SQLITE_OK) {
+        sqlite3_bind_text(stmt, 1, name.UTF8String, -1, SQLITE_TRANSIENT);
+        sqlite3_bind_text(stmt, 2, sourceBBL.UTF8String, -1, SQLITE_TRANSIENT);
+        sqlite3_bind_int64(stmt, 3, sessionIndex);
+        sqlite3_bind_int64(stmt, 4, [values[NSURLFileSizeKey] longLongValue]);
+        sqlite3_bind_double(stmt, 5, created.timeIntervalSince1970);
+        sqlite3_bind_double(stmt, 6, modified.timeIntervalSince1970);
+        sqlite3_bind_int64(stmt, 7, rowCount);
+        sqlite3_bind_double(stmt, 8, duration);
+        sqlite3_bind_double(stmt, 9, sampleRate);
+        success = (sqlite3_step(stmt) == SQLITE_DONE);
+    }
+    sqlite3_finalize(stmt);
+    return success;
+}
+
+@end
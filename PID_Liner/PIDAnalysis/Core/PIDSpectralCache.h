@@ -0,0 +1,143 @@
+//
+//  PIDSpectralCache.h
+//  PID_Liner
+//
+//  窗口频谱缓存 - 一次分析内每个窗口的FFT只做一次，由响应分析与噪声频谱共用
+//
+
+#ifndef PIDSpectralCache_h
+#define PIDSpectralCache_h
+
+#import <Foundation/Foundation.h>
+#import "PIDPrecision.h"
+
+@class PIDStackData;
+@class PIDCancellationToken;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ * 频谱对应的信号
+ */
+typedef NS_ENUM(NSInteger, PIDSpectralTrace) {
+    PIDSpectralTraceInput = 0,      // PID环路输入
+    PIDSpectralTraceGyro,           // 陀螺仪
+};
+
+/**
+ * FFT前施加的窗函数
+ */
+typedef NS_ENUM(NSInteger, PIDSpectralWindow) {
+    PIDSpectralWindowRectangular = 0,   // 不加窗（原始窗口数据）
+    PIDSpectralWindowAnalysis,          // 缓存的分析窗（默认Hanning）
+};
+
+#pragma mark - 窗口频谱
+
+/**
+ * 一组窗口的实数FFT半谱 [0, n/2]
+ * 实部与虚部分别为连续矩阵（windowCount × binCount，行主序），只读；
+ * 标量类型由precision决定：Float64时读realData/imagData，Float32时读realDataF/imagDataF
+ */
+@interface PIDWindowSpectra : NSObject
+
+@property (nonatomic, readonly) PIDSpectralTrace trace;
+@property (nonatomic, readonly) PIDSpectralWindow window;
+@property (nonatomic, readonly) NSInteger paddedLength;     // 补零后的FFT长度
+@property (nonatomic, readonly) NSInteger binCount;         // paddedLength/2 + 1
+@property (nonatomic, readonly) NSInteger windowCount;
+@property (nonatomic, readonly) PIDDSPPrecision precision;
+
+// 全部窗口的实部/虚部矩阵（行距为binCount；按activeWindows请求时未计算的行为零）
+// 与precision不对应的一组为NULL
+@property (nonatomic, readonly, nullable) const double *realData;
+@property (nonatomic, readonly, nullable) const double *imagData;
+@property (nonatomic, readonly, nullable) const float *realDataF;
+@property (nonatomic, readonly, nullable) const float *imagDataF;
+
+@end
+
+#pragma mark - 频谱缓存
+
+/**
+ * 窗口频谱缓存
+ *
+ * 按 (信号, 窗函数, 补零长度, 精度) 缓存全部窗口的半谱，同一组合只做一次FFT。
+ * 响应分析（维纳反卷积需要加窗后的输入/陀螺仪频谱）和噪声频谱
+ * （Python stackspectrum 同样对陀螺仪加窗后做FFT）在补零长度相同时共用陀螺仪频谱，
+ * 每个轴的正向FFT从每窗口3次降为2次。
+ *
+ * 缓存与堆叠数据同生命周期，一次分析结束后释放。
+ * 线程安全：频谱计算时各窗口并行做FFT，并发请求同一组合只计算一次；返回的频谱只读。
+ */
+@interface PIDSpectralCache : NSObject
+
+// 堆叠窗口数据
+@property (nonatomic, strong, readonly) PIDStackData *stackData;
+
+// 分析窗（长度等于窗口长度；传入的窗口长度不匹配时为Hanning窗）
+@property (nonatomic, copy, readonly) NSArray<NSNumber *> *window;
+
+// 取消令牌（可选）：频谱计算在每个窗口之间检查，取消后不缓存、返回nil
+@property (nonatomic, strong, nullable) PIDCancellationToken *cancellationToken;
+
+// 统计：实际执行的FFT次数 / 从缓存直接取得的频谱组数
+@property (nonatomic, readonly) NSInteger transformCount;
+@property (nonatomic, readonly) NSInteger reuseCount;
+
+/**
+ * 使用Hanning分析窗初始化
+ * 对应Python: self.window = np.hanning(self.flen)
+ */
+- (instancetype)initWithStackData:(PIDStackData *)stackData;
+
+/**
+ * 使用指定分析窗初始化
+ * @param stackData 堆叠窗口数据
+ * @param window 分析窗（长度应等于窗口长度）
+ */
+- (instancetype)initWithStackData:(PIDStackData *)stackData
+                           window:(NSArray<NSNumber *> *)window;
+
+/**
+ * 分析窗的原始数据（长度为窗口长度）
+ */
+- (const double *)windowValues;
+
+/**
+ * 获取全部窗口的双精度半谱（不存在时计算并缓存）
+ * @param trace 信号
+ * @param window 窗函数
+ * @param paddedLength 补零后的FFT长度（>= 窗口长度）
+ * @return 频谱；参数无效或已取消时返回nil
+ */
+- (nullable PIDWindowSpectra *)spectraForTrace:(PIDSpectralTrace)trace
+                                        window:(PIDSpectralWindow)window
+                                  paddedLength:(NSInteger)paddedLength;
+
+/**
+ * 只保证activeWindows中为YES的窗口的半谱（其余窗口不做FFT，对应行可能为零）
+ * 缓存按窗口记录已计算的行：之后请求全部窗口时只补算缺少的行，与直接请求全部窗口的FFT次数相同
+ * @param activeWindows 每个窗口是否需要（windowCount个bool）；nil时等同于请求全部窗口
+ */
+- (nullable PIDWindowSpectra *)spectraForTrace:(PIDSpectralTrace)trace
+                                        window:(PIDSpectralWindow)window
+                                  paddedLength:(NSInteger)paddedLength
+                                 activeWindows:(nullable NSData *)activeWindows;
+
+/**
+ * 指定精度的半谱：float32路径的响应分析与噪声频谱同样共用同一组陀螺仪频谱
+ * （不同精度的频谱分别缓存，FFT直接按该精度计算，不经过双精度再转换）
+ * @param precision 频谱的标量类型
+ */
+- (nullable PIDWindowSpectra *)spectraForTrace:(PIDSpectralTrace)trace
+                                        window:(PIDSpectralWindow)window
+                                  paddedLength:(NSInteger)paddedLength
+                                     precision:(PIDDSPPrecision)precision
+                                 activeWindows:(nullable NSData *)activeWindows;
+
+@end
+
+NS_ASSUME_NONNULL_END
+
+#endif /* PIDSpectralCache_h */
@@ -0,0 +1,221 @@
+//
+//  PIDSpectralCache.m
+//  PID_Liner
+//
+//  窗口频谱缓存实现
+//
+
+#import "PIDSpectralCache.h"
+#import "PIDTraceAnalyzer.h"
+#import "PIDCancellationToken.h"
+#import "PIDParallel.h"
+#import "PIDResponseKernels.h"
+
+#pragma mark - PIDWindowSpectra
+
+@interface PIDWindowSpectra ()
+
+- (instancetype)initWithTrace:(PIDSpectralTrace)trace
+                       window:(PIDSpectralWindow)window
+                 paddedLength:(NSInteger)paddedLength
+                  windowCount:(NSInteger)windowCount
+                    precision:(PIDDSPPrecision)precision;
+
+- (void *)mutableReal;
+- (void *)mutableImag;
+- (bool *)computedWindows;
+
+@end
+
+@implementation PIDWindowSpectra {
+    NSMutableData *_storage;    // [实部矩阵 | 虚部矩阵]
+    NSMutableData *_computed;   // 每个窗口的半谱是否已计算（bool）
+}
+
+- (instancetype)initWithTrace:(PIDSpectralTrace)trace
+                       window:(PIDSpectralWindow)window
+                 paddedLength:(NSInteger)paddedLength
+                  windowCount:(NSInteger)windowCount
+                    precision:(PIDDSPPrecision)precision {
+    self = [super init];
+    if (self) {
+        _trace = trace;
+        _window = window;
+        _paddedLength = paddedLength;
+        _binCount = paddedLength / 2 + 1;
+        _windowCount = windowCount;
+        _precision = precision;
+        _storage = [NSMutableData dataWithLength:2 * _binCount * windowCount * [self scalarSize]];
+        _computed = [NSMutableData dataWithLength:windowCount * sizeof(bool)];
+    }
+    return self;
+}
+
+- (size_t)scalarSize {
+    return _precision == PIDDSPPrecisionFloat32 ? sizeof(float) : sizeof(double);
+}
+
+- (void *)mutableReal {
+    return _storage.mutableBytes;
+}
+
+- (void *)mutableImag {
+    return (char *)_storage.mutableBytes + _binCount * _windowCount * [self scalarSize];
+}
+
+- (bool *)computedWindows {
+    return (bool *)_computed.mutableBytes;
+}
+
+- (const double *)realData {
+    return _precision == PIDDSPPrecisionFloat64 ? (const double *)[self mutableReal] : NULL;
+}
+
+- (const double *)imagData {
+    return _precision == PIDDSPPrecisionFloat64 ? (const double *)[self mutableImag] : NULL;
+}
+
+- (const float *)realDataF {
+    return _precision == PIDDSPPrecisionFloat32 ? (const float *)[self mutableReal] : NULL;
+}
+
+- (const float *)imagDataF {
+    return _precision == PIDDSPPrecisionFloat32 ? (const float *)[self mutableImag] : NULL;
+}
+
+@end
+
+#pragma mark - PIDSpectralCache
+
+@implementation PIDSpectralCache {
+    NSData *_windowValues;
+    NSMutableDictionary<NSString *, PIDWindowSpectra *> *_entries;
+}
+
+- (instancetype)initWithStackData:(PIDStackData *)stackData {
+    return [self initWithStackData:stackData
+                            window:[PIDTraceAnalyzer hanningWindowWithLength:stackData.windowLength]];
+}
+
+- (instancetype)initWithStackData:(PIDStackData *)stackData
+                           window:(NSArray<NSNumber *> *)window {
+    self = [super init];
+    if (self) {
+        _stackData = stackData;
+        _entries = [NSMutableDictionary dictionary];
+
+        // 窗口长度不匹配时使用Hanning窗（与Python一致）
+        NSInteger windowLength = stackData.windowLength;
+        _window = window.count == windowLength ? [window copy]
+                                               : [PIDTraceAnalyzer hanningWindowWithLength:windowLength];
+
+        // 备忘的Hanning窗直接共用备忘的原始值，其他窗口拆箱一次
+        if (_window == [PIDTraceAnalyzer hanningWindowWithLength:windowLength]) {
+            _windowValues = [PIDTraceAnalyzer hanningWindowValuesWithLength:windowLength];
+        } else {
+            NSMutableData *values = [NSMutableData dataWithLength:MAX(windowLength, 1) * sizeof(double)];
+            double *dst = values.mutableBytes;
+            for (NSInteger i = 0; i < windowLength; i++) {
+                dst[i] = [_window[i] doubleValue];
+            }
+            _windowValues = values;
+        }
+    }
+    return self;
+}
+
+- (const double *)windowValues {
+    return (const double *)_windowValues.bytes;
+}
+
+- (nullable PIDWindowSpectra *)spectraForTrace:(PIDSpectralTrace)trace
+                                        window:(PIDSpectralWindow)window
+                                  paddedLength:(NSInteger)paddedLength {
+    return [self spectraForTrace:trace window:window paddedLength:paddedLength activeWindows:nil];
+}
+
+- (nullable PIDWindowSpectra *)spectraForTrace:(PIDSpectralTrace)trace
+                                        window:(PIDSpectralWindow)window
+                                  paddedLength:(NSInteger)paddedLength
+                                 activeWindows:(nullable NSData *)activeWindows {
+    return [self spectraForTrace:trace
+                          window:window
+                    paddedLength:paddedLength
+                       precision:PIDDSPPrecisionFloat64
+                   activeWindows:activeWindows];
+}
+
+- (nullable PIDWindowSpectra *)spectraForTrace:(PIDSpectralTrace)trace
+                                        window:(PIDSpectralWindow)window
+                                  paddedLength:(NSInteger)paddedLength
+                                     precision:(PIDDSPPrecision)precision
+                                 activeWindows:(nullable NSData *)activeWindows {
+    NSInteger windowCount = self.stackData.windowCount;
+    NSInteger windowLength = self.stackData.windowLength;
+    if (windowCount == 0 || windowLength == 0 || paddedLength < windowLength ||
+        (activeWindows && activeWindows.length < windowCount * sizeof(bool))) {
+        return nil;
+    }
+
+    // 整个查找/计算过程加锁：并发请求同一组合时只计算一次
+    @synchronized (self) {
+        NSString *key = [NSString stringWithFormat:@"%ld/%ld/%ld/%d", (long)trace, (long)window,
+                         (long)paddedLength, (int)precision];
+        PIDWindowSpectra *spectra = _entries[key];
+        BOOL cached = spectra != nil;
+        if (!cached) {
+            spectra = [[PIDWindowSpectra alloc] initWithTrace:trace
+                                                       window:window
+                                                 paddedLength:paddedLength
+                                                  windowCount:windowCount
+                                                    precision:precision];
+            _entries[key] = spectra;
+        }
+
+        // 需要补算的窗口：请求的窗口中尚未计算的
+        const bool *active = activeWindows ? (const bool *)activeWindows.bytes : NULL;
+        bool *computed = [spectra computedWindows];
+        NS_VALID_UNTIL_END_OF_SCOPE NSMutableData *pendingData = [NSMutableData dataWithLength:windowCount * sizeof(size_t)];
+        size_t *pending = pendingData.mutableBytes;
+        NSInteger pendingCount = 0;
+        for (NSInteger i = 0; i < windowCount; i++) {
+            if (!computed[i] && (!active || active[i])) {
+                pending[pendingCount++] = (size_t)i;
+            }
+        }
+        if (pendingCount == 0) {
+            _reuseCount += cached ? 1 : 0;
+            return spectra;
+        }
+
+        // 窗口按块并行，每个窗口写入自己的行，结果与串行一致
+        PIDStackData *stackData = self.stackData;
+        PIDWindowSpectraBatch batch = {
+            .column = trace == PIDSpectralTraceInput ? [stackData inputWindowAtIndex:0]
+                                                     : [stackData gyroWindowAtIndex:0],
+            .step = (size_t)stackData.step,
+            .windowLength = (size_t)windowLength,
+            .window = window == PIDSpectralWindowAnalysis ? [self windowValues] : NULL,
+            .paddedLength = (size_t)paddedLength,
+            .windows = pending,
+            .count = (size_t)pendingCount,
+            .cancel = [self.cancellationToken flag],
+        };
+        bool transformed = precision == PIDDSPPrecisionFloat32
+            ? PIDWindowSpectraRunF(&batch, (float *)[spectra mutableReal], (float *)[spectra mutableImag])
+            : PIDWindowSpectraRunD(&batch, (double *)[spectra mutableReal], (double *)[spectra mutableImag]);
+
+        // 取消或失败时部分窗口没有计算，不标记为已计算（下次请求时重新计算）
+        if (!transformed) {
+            return nil;
+        }
+
+        for (NSInteger p = 0; p < pendingCount; p++) {
+            computed[pending[p]] = true;
+        }
+        _transformCount += pendingCount;
+        return spectra;
+    }
+}
+
+@end
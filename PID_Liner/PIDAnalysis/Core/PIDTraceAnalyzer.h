@@ -11,32 +11,47 @@
 
 #import <Foundation/Foundation.h>
 #import "PIDDataModels.h"
+#import "PIDPrecision.h"
 
 NS_ASSUME_NONNULL_BEGIN
 
 @class PIDCSVData;
 @class PIDWienerDeconvolution;
 @class PIDFFTProcessor;
+@class PIDSpectralCache;
+@class PIDCancellationToken;
+
+/**
+ * 阶跃响应估计方法
+ */
+typedef enum {
+    PIDResponseEstimatorWiener = 0,             // 逐窗口维纳反卷积 + 质量过滤 + 加权众数平均（与Python相同）
+    PIDResponseEstimatorAveragedCrossSpectrum,  // 平均互谱：每组一次除法和逆FFT（见 averagedCrossSpectrumCurvesWithStackData:）
+} PIDResponseEstimator;
 
 #pragma mark - 堆叠窗口数据
 
 /**
  * 堆叠窗口数据
  * 对应Python中的stacks字典
+ *
+ * 每个信号只在一段连续的列缓冲区中保存一份（覆盖全部窗口的样本范围），
+ * 窗口k是列缓冲区中 [k*step, k*step+windowLength) 的视图，不复制数据；
+ * 15/16重叠下每个样本不再被复制约16份。
  */
 @interface PIDStackData : NSObject
 
-// 输入信号（PID环路输入）
-@property (nonatomic, strong) NSArray<NSArray<NSNumber *> *> *input;
+// 输入信号（PID环路输入）- 按窗口访问的只读视图，元素在访问时才装箱
+@property (nonatomic, readonly) NSArray<NSArray<NSNumber *> *> *input;
 
 // 输出信号（陀螺仪）
-@property (nonatomic, strong) NSArray<NSArray<NSNumber *> *> *gyro;
+@property (nonatomic, readonly) NSArray<NSArray<NSNumber *> *> *gyro;
 
 // 油门
-@property (nonatomic, strong) NSArray<NSArray<NSNumber *> *> *throttle;
+@property (nonatomic, readonly) NSArray<NSArray<NSNumber *> *> *throttle;
 
 // 时间
-@property (nonatomic, strong) NSArray<NSArray<NSNumber *> *> *time;
+@property (nonatomic, readonly) NSArray<NSArray<NSNumber *> *> *time;
 
 // 窗口数量
 @property (nonatomic, readonly) NSInteger windowCount;
@@ -44,6 +59,29 @@ NS_ASSUME_NONNULL_BEGIN
 // 每个窗口的长度
 @property (nonatomic, readonly) NSInteger windowLength;
 
+// 相邻窗口起点的间隔（样本点数）
+@property (nonatomic, readonly) NSInteger step;
+
+// 窗口0的起点在原始数据中的样本索引（按窗口范围创建时为 windowRange.location*step，否则为0）
+@property (nonatomic, readonly) NSInteger sampleStart;
+
+/**
+ * 窗口数据的原始指针（热路径使用，避免NSNumber装箱）
+ * 指向列缓冲区内部，长度为windowLength，只读，生命周期与本对象相同
+ * @param index 窗口索引，越界时返回NULL
+ */
+- (nullable const double *)inputWindowAtIndex:(NSInteger)index;
+- (nullable const double *)gyroWindowAtIndex:(NSInteger)index;
+- (nullable const double *)throttleWindowAtIndex:(NSInteger)index;
+- (nullable const double *)timeWindowAtIndex:(NSInteger)index;
+
+/**
+ * 把任意一列数据按本堆叠覆盖的样本范围拷贝为连续列缓冲区（D项、debug等附加通道的多通道频谱使用）
+ * 与堆叠内部的列对齐：缓冲区样本0是窗口0的起点，长度为 (windowCount-1)*step + windowLength，数据不足的部分补0
+ * @param samples 原始数据列（与创建堆叠的CSV数据同一时间轴）
+ */
+- (NSData *)columnFromSamples:(NSArray<NSNumber *> *)samples;
+
 /**
  * 创建堆叠数据
  * @param data CSV数据
@@ -70,6 +108,52 @@ NS_ASSUME_NONNULL_BEGIN
                     overlap:(double)overlap
                        pGain:(double)pGain;
 
+/**
+ * 创建指定轴、指定窗口范围的堆叠数据（流水线分析使用）
+ * 窗口k覆盖样本 [k*step, k*step+windowSize)，与完整堆叠的编号一致，
+ * 超出当前数据长度的窗口会被忽略
+ *
+ * @param windowRange 窗口编号范围
+ */
++ (instancetype)stackFromData:(PIDCSVData *)data
+                    axisIndex:(NSInteger)axisIndex
+                  windowSize:(NSInteger)windowSize
+                    overlap:(double)overlap
+                       pGain:(double)pGain
+                 windowRange:(NSRange)windowRange;
+
+/**
+ * 一次创建三个轴的堆叠数据（与分别调用三次 stackFromData:axisIndex:... 的结果相同）
+ * 三轴陀螺仪+油门、三轴P项按4路交错一遍读取，PID输入在SIMD通道中同时计算；
+ * 三个轴共用油门/时间列，加窗统计量（max_in、平均输入、最大油门）由第一个分析的轴一遍算出，其余轴直接取用
+ * @param pGains 各轴的P增益（缺少或<=0时为45）
+ * @return 按轴索引的三个堆叠数据（缺少陀螺仪或P项的轴为空堆叠）
+ */
++ (NSArray<PIDStackData *> *)stacksForAxesFromData:(PIDCSVData *)data
+                                        windowSize:(NSInteger)windowSize
+                                           overlap:(double)overlap
+                                            pGains:(NSArray<NSNumber *> *)pGains;
+
+/**
+ * 一次创建三个轴指定窗口范围的堆叠数据（流水线分析使用）
+ */
++ (NSArray<PIDStackData *> *)stacksForAxesFromData:(PIDCSVData *)data
+                                        windowSize:(NSInteger)windowSize
+                                           overlap:(double)overlap
+                                            pGains:(NSArray<NSNumber *> *)pGains
+                                       windowRange:(NSRange)windowRange;
+
+/**
+ * 计算给定数据长度下可完整覆盖的窗口数量
+ * @param sampleCount 样本点数
+ * @param windowSize 窗口大小
+ * @param overlap 重叠比例
+ * @return 窗口数量（数据不足一个窗口时为0）
+ */
++ (NSInteger)windowCountForSampleCount:(NSInteger)sampleCount
+                            windowSize:(NSInteger)windowSize
+                               overlap:(double)overlap;
+
 @end
 
 #pragma mark - 响应分析结果
@@ -83,6 +167,10 @@ NS_ASSUME_NONNULL_BEGIN
 // 响应曲线（累积和后的阶跃响应）
 @property (nonatomic, strong) NSArray<NSArray<NSNumber *> *> *stepResponse;
 
+// 与stepResponse内容相同的连续矩阵（windowCount × responseLength 个double，行主序）
+// 由stackResponse生成；拼接或手工构造的结果为nil，使用方应回退到stepResponse
+@property (nonatomic, strong, nullable) NSData *stepResponseData;
+
 // 平均时间
 @property (nonatomic, strong) NSArray<NSNumber *> *avgTime;
 
@@ -95,10 +183,90 @@ NS_ASSUME_NONNULL_BEGIN
 // 最大油门
 @property (nonatomic, strong) NSArray<NSNumber *> *maxThrottle;
 
+// 活动度预筛跳过反卷积的窗口数（这些窗口的阶跃响应行为零，见 pruneInactiveWindows）
+@property (nonatomic, assign) NSInteger prunedWindowCount;
+
+/**
+ * 追加下一批窗口的结果（按批次累计）：逐窗口数组原地追加，代价与本批窗口数成正比；
+ * 两者都有连续矩阵时矩阵一起拼接，否则stepResponseData置为nil
+ * 数组与矩阵会被原地修改，不要对其他对象仍在使用的结果调用
+ */
+- (void)appendWindowsFromResult:(PIDResponseResult *)batch;
+
 @end
 
 #pragma mark - 频谱分析结果
 
+/**
+ * 噪声频谱流式累加器
+ * 对应Python stackspectrum() + hist2d()：
+ *   权重为 abs(spec.real)，油门取每个窗口 abs(throttle·window) 的最大值，
+ *   histogram2d 范围 [[0,100],[f0,f_last]]，分箱 [101, 频率点数/4]，
+ *   每个油门箱除以该箱的窗口数（+1e-9）得到 hist2d_norm
+ *
+ * 逐窗口累加，窗口频谱用完即可释放；内存只与 油门箱 × 频率箱 + 频率点数 有关，
+ * 与窗口总数无关。同时累加所有窗口的平均幅度谱（噪声图的单轴频谱）。
+ * 非线程安全：并发产生的窗口由调用方串行累加，或各自累加后用addAccumulator:合并。
+ */
+@interface PIDSpectrumAccumulator : NSObject <NSCopying>
+
+@property (nonatomic, readonly) NSArray<NSNumber *> *frequencies;  // 频率点 (Hz)
+@property (nonatomic, readonly) NSInteger throttleBins;            // 油门箱数量（101）
+@property (nonatomic, readonly) NSInteger frequencyBins;           // 频率箱数量（频率点数/4）
+@property (nonatomic, readonly) NSInteger windowCount;             // 已累加的窗口数
+
+/**
+ * @param frequencies 频率点（与每个窗口频谱的长度相同）
+ */
+- (instancetype)initWithFrequencies:(NSArray<NSNumber *> *)frequencies;
+
+/**
+ * 累加单个窗口的频谱
+ * @param spectrum 频谱实部（长度为frequencies.count），按 |Re| 累加
+ * @param throttle 窗口油门 (0-100%)；NaN或超出范围时只计入平均谱（与numpy直方图忽略超范围值一致）
+ */
+- (void)addWindowSpectrum:(const double *)spectrum throttle:(double)throttle;
+
+/**
+ * 合并另一个累加器（流水线批次、外存分析的分块）
+ * @return 频率点数不同时返回NO，不做合并
+ */
+- (BOOL)addAccumulator:(PIDSpectrumAccumulator *)other;
+
+/**
+ * 所有窗口 |Re| 的平均 [频率点]；没有窗口时为空数组
+ */
+- (NSArray<NSNumber *> *)averageSpectrum;
+
+/**
+ * 油门归一化热力图 [油门箱][频率箱]（对应hist2d_norm的转置，可直接作为PIDNoiseSpectrumData.spectrumHeatmap）
+ */
+- (NSArray<NSArray<NSNumber *> *> *)throttleHeatmap;
+
+/**
+ * 沿油门方向高斯平滑后的热力图（对应hist2d_sm：gaussian_filter1d(sigma=3, mode='constant')）
+ */
+- (NSArray<NSArray<NSNumber *> *> *)smoothedThrottleHeatmap;
+
+/**
+ * 平滑热力图的紧凑矩阵：float行主序 [油门箱][频率箱]（throttleBins × frequencyBins），不装箱
+ * 与smoothedThrottleHeatmap逐点相同（转为单精度），可直接作为PIDNoiseSpectrumData.heatmapMatrix
+ */
+- (NSData *)smoothedThrottleHeatmapMatrix;
+
+/**
+ * 热力图坐标：频率箱中心 (Hz) / 油门箱中心 (%)
+ */
+- (NSArray<NSNumber *> *)heatmapFrequencies;
+- (NSArray<NSNumber *> *)throttleAxis;
+
+/**
+ * 累加器占用的字节数（用于内存预算）
+ */
++ (NSUInteger)bytesForFrequencyCount:(NSInteger)frequencyCount;
+
+@end
+
 /**
  * 频谱分析结果
  * 对应Python spectrum()的返回值
@@ -108,9 +276,334 @@ NS_ASSUME_NONNULL_BEGIN
 // 频率数组 (Hz)
 @property (nonatomic, strong) NSArray<NSNumber *> *frequencies;
 
-// 频谱幅度 [频率窗口][频率点]
+// 频谱实部 [频率窗口][频率点]
+// 使用频谱缓存计算时默认不保留（见PIDTraceAnalyzer.retainsWindowSpectra），只给出accumulator
 @property (nonatomic, strong) NSArray<NSArray<NSNumber *> *> *spectrum;
 
+// 流式累加结果：平均幅度谱与油门×频率热力图
+@property (nonatomic, strong, nullable) PIDSpectrumAccumulator *accumulator;
+
+@end
+
+#pragma mark - 响应直方图
+
+/**
+ * 阶跃响应二维直方图累加器
+ * 对应Python weighted_mode_avr() 中的 histogram2d + 高斯平滑 + 平方加权平均
+ *
+ * 逐窗口累加，窗口数据用完即可释放；内存只与 responseLength × vertBins 有关，
+ * 与窗口总数无关。累加顺序与一次性展平后构建直方图相同，结果完全一致。
+ * 直方图按时间箱分列存储，高斯平滑沿值方向对每列做一维卷积，不需要转置。
+ */
+@interface PIDResponseHistogram : NSObject
+
+@property (nonatomic, readonly) NSInteger responseLength;  // 时间箱数量（= 响应点数）
+@property (nonatomic, readonly) NSInteger vertBins;        // 值箱数量
+@property (nonatomic, readonly) NSInteger windowCount;     // 已累加的窗口数
+
+/**
+ * @param responseLength 每个窗口的响应点数（时间轴固定为0-0.5秒）
+ * @param vertRange 响应值的垂直范围 [min, max]
+ * @param vertBins 垂直方向分箱数量
+ */
+- (instancetype)initWithResponseLength:(NSInteger)responseLength
+                            vertRange:(NSArray<NSNumber *> *)vertRange
+                             vertBins:(NSInteger)vertBins;
+
+/**
+ * 累加单个窗口的阶跃响应
+ * @param windowResp 窗口响应（长度与responseLength不一致时忽略）
+ * @param weight 窗口权重（对应mask值）
+ * @return 是否已累加
+ */
+- (BOOL)addWindowResponse:(NSArray<NSNumber *> *)windowResp weight:(double)weight;
+
+/**
+ * 累加单个窗口的阶跃响应（连续内存，长度为responseLength）
+ * 值箱索引向量化计算后直接散射到直方图，可直接传入阶跃响应矩阵的一行
+ * @param values 窗口响应
+ * @param weight 窗口权重（对应mask值）
+ * @return 是否已累加
+ */
+- (BOOL)addWindowValues:(const double *)values weight:(double)weight;
+
+/**
+ * 计算一个窗口落入的直方图单元（超出范围的点不计入）
+ * 单元索引只对 responseLength / vertRange / vertBins 相同的直方图有效
+ * @param values 窗口响应（长度为responseLength）
+ * @param cells 输出缓冲区，容量至少为responseLength
+ * @return 单元个数
+ */
+- (NSInteger)cellsForWindowValues:(const double *)values cells:(uint32_t *)cells;
+
+/**
+ * 按预先计算的单元累加一个窗口；weight为负时扣除该窗口
+ * 权重为整数时累加与扣除都是精确的，扣除后与从未加入该窗口的直方图完全相同
+ */
+- (void)addWindowCells:(const uint32_t *)cells count:(NSInteger)count weight:(double)weight;
+
+/**
+ * 由当前直方图计算代表性响应曲线（减去起点，从0开始）
+ * 不修改已累加的数据，可以继续累加后再次计算
+ */
+- (NSArray<NSNumber *> *)weightedModeAverage;
+
+/**
+ * 直方图占用的字节数（用于内存预算）
+ */
++ (NSUInteger)bytesForResponseLength:(NSInteger)responseLength vertBins:(NSInteger)vertBins;
+
+@end
+
+#pragma mark - 油门分层响应直方图
+
+/**
+ * 油门分层的阶跃响应直方图（油门箱 × 时间箱 × 值箱）
+ * 每个油门箱是一个与PIDResponseHistogram相同的二维直方图（同一值轴、高斯平滑与平方加权平均），
+ * 时间轴按timeBins个箱统计（热力图的显示分辨率，等于responseLength时与PIDResponseHistogram逐点相同）。
+ *
+ * addResponseMatrix: 一遍扫描阶跃响应矩阵：窗口先按油门箱分桶，各油门箱并行把自己的窗口散射进去，
+ * 每行响应只读一次；responseHeatmap 在一个批次中并行完成所有油门箱的平滑与众数提取，
+ * 不需要为每个油门箱重新筛选窗口、单独构建直方图。
+ * 非线程安全：累加与读取应在同一线程上进行（内部并行）。
+ */
+@interface PIDThrottleResponseHistogram : NSObject
+
+@property (nonatomic, readonly) NSInteger throttleBins;    // 油门箱数量（[0, 100]% 等宽）
+@property (nonatomic, readonly) NSInteger timeBins;        // 时间箱数量（0-0.5秒）
+@property (nonatomic, readonly) NSInteger responseLength;  // 每个窗口的响应点数
+@property (nonatomic, readonly) NSInteger vertBins;        // 值箱数量
+@property (nonatomic, readonly) NSInteger windowCount;     // 已累加的窗口数
+
+/**
+ * @param throttleBins 油门箱数量
+ * @param timeBins 时间箱数量（超过responseLength时取responseLength）
+ * @param responseLength 每个窗口的响应点数
+ * @param vertRange 响应值的垂直范围 [min, max]
+ * @param vertBins 垂直方向分箱数量
+ */
+- (instancetype)initWithThrottleBins:(NSInteger)throttleBins
+                            timeBins:(NSInteger)timeBins
+                      responseLength:(NSInteger)responseLength
+                           vertRange:(NSArray<NSNumber *> *)vertRange
+                            vertBins:(NSInteger)vertBins;
+
+/**
+ * 一遍累加阶跃响应矩阵
+ * @param matrix 行主序 windowCount × responseLength
+ * @param throttle 每个窗口的油门 (0-100%)；NaN或超出范围的窗口不计入
+ * @param weights 每个窗口的权重（NULL时全部为1）；权重不大于0的窗口不计入
+ */
+- (void)addResponseMatrix:(const double *)matrix
+              windowCount:(NSInteger)windowCount
+                 throttle:(const double *)throttle
+                  weights:(nullable const double *)weights;
+
+/**
+ * 每个油门箱已累加的窗口数 [油门箱]
+ */
+- (NSArray<NSNumber *> *)windowCounts;
+
+/**
+ * 响应-油门热力图 [油门箱][时间箱]：每行是该油门箱的代表性响应曲线（减去起点，从0开始），
+ * 没有窗口的油门箱为全零行（可直接作为PIDAxisAnalysisResult.responseHeatmap）
+ */
+- (NSArray<NSArray<NSNumber *> *> *)responseHeatmap;
+
+/**
+ * 热力图坐标：油门箱中心 (%) / 时间箱中心 (秒)
+ */
+- (NSArray<NSNumber *> *)throttleAxis;
+- (NSArray<NSNumber *> *)timeAxis;
+
+/**
+ * 直方图占用的字节数（用于内存预算）
+ */
++ (NSUInteger)bytesForThrottleBins:(NSInteger)throttleBins
+                          timeBins:(NSInteger)timeBins
+                          vertBins:(NSInteger)vertBins;
+
+@end
+
+#pragma mark - 响应曲线
+
+/**
+ * 单轴的低/高输入响应曲线
+ * 对应PIDAnalysisViewController中 low_high_mask + resp_quality + weighted_mode_avr 的结果
+ */
+@interface PIDResponseCurves : NSObject
+
+// 低输入（20 < max_in ≤ 500°/s）响应曲线
+@property (nonatomic, copy) NSArray<NSNumber *> *respLow;
+
+// 高输入（> 500°/s）响应曲线，窗口不足10个时为nil
+@property (nonatomic, copy, nullable) NSArray<NSNumber *> *respHigh;
+
+// 参与分析的窗口总数
+@property (nonatomic, assign) NSInteger windowCount;
+
+// 低/高输入mask中的窗口数（质量过滤之前）
+@property (nonatomic, assign) NSInteger lowWindowCount;
+@property (nonatomic, assign) NSInteger highWindowCount;
+
+@end
+
+/**
+ * 响应曲线构建器（两遍）
+ *
+ * 质量过滤需要先得到参考响应(resp_low初值)才能判断每个窗口，因此分两遍：
+ * 1. addInitialPassWindow: 累积参考响应直方图并统计各组窗口数，finishInitialPass 生成参考响应
+ * 2. addFinalPassWindow:   按 mask × 质量mask 累积最终的低/高输入直方图，finishFinalPass 输出曲线
+ *
+ * 两遍中窗口的顺序必须相同。内存峰值为两个直方图，与窗口数无关，
+ * 因此既可用于内存中的结果，也可用于逐窗口重新计算的流式分析。
+ */
+@interface PIDResponseCurveBuilder : NSObject
+
+// 已看到的窗口数（第一遍）
+@property (nonatomic, readonly) NSInteger windowCount;
+
+// 低/高输入分组阈值 (°/s)，默认500（Python low_high_mask(500)）；开始加入窗口之前设置
+@property (nonatomic, assign) double highInputThreshold;
+
+/**
+ * 第一遍：加入一个窗口
+ * @param stepResponse 窗口阶跃响应
+ * @param maxInput 窗口最大输入 (max_in)
+ */
+- (void)addInitialPassWindow:(NSArray<NSNumber *> *)stepResponse maxInput:(double)maxInput;
+
+/**
+ * 第一遍：加入一个窗口（连续内存）
+ * @param values 窗口阶跃响应
+ * @param length 响应点数
+ * @param maxInput 窗口最大输入 (max_in)
+ */
+- (void)addInitialPassWindowValues:(const double *)values length:(NSInteger)length maxInput:(double)maxInput;
+
+/**
+ * 结束第一遍，生成参考响应并准备第二遍的直方图
+ */
+- (void)finishInitialPass;
+
+/**
+ * 第二遍：加入一个窗口（必须在finishInitialPass之后调用）
+ */
+- (void)addFinalPassWindow:(NSArray<NSNumber *> *)stepResponse maxInput:(double)maxInput;
+
+/**
+ * 第二遍：加入一个窗口（连续内存）
+ */
+- (void)addFinalPassWindowValues:(const double *)values length:(NSInteger)length maxInput:(double)maxInput;
+
+/**
+ * 结束第二遍，输出响应曲线
+ */
+- (PIDResponseCurves *)finishFinalPass;
+
+/**
+ * 构建器峰值内存（两个直方图）
+ * @param responseLength 每个窗口的响应点数
+ */
++ (NSUInteger)peakBytesForResponseLength:(NSInteger)responseLength;
+
+@end
+
+#pragma mark - 响应分析参数
+
+/**
+ * 一组响应分析参数（参数扫描用）
+ * 只包含不影响正向FFT的参数：窗口FFT不变，换参数只需重做信噪比掩码、维纳除法、逆FFT和分组
+ */
+@interface PIDResponseParameters : NSObject <NSCopying>
+
+@property (nonatomic, assign) double cutFreq;               // 截止频率 (Hz)
+@property (nonatomic, assign) NSInteger responseLength;     // 响应长度 (样本点数)，≤0时使用分析器的responseLen
+@property (nonatomic, assign) double highInputThreshold;    // 低/高输入分组阈值 (°/s)
+
+/**
+ * @param cutFreq 截止频率 (Hz)
+ * @param responseLength 响应长度 (样本点数)，≤0时使用分析器的responseLen
+ * @param highInputThreshold 低/高输入分组阈值 (°/s)
+ */
++ (instancetype)parametersWithCutFreq:(double)cutFreq
+                       responseLength:(NSInteger)responseLength
+                   highInputThreshold:(double)highInputThreshold;
+
+@end
+
+#pragma mark - 增量响应曲线
+
+/**
+ * 增量响应曲线分析（交互式调整窗口过滤条件）
+ *
+ * 与 PIDResponseCurveBuilder 得到相同的低/高输入响应曲线，但保留每个窗口落入的直方图单元，
+ * 窗口的选择由位集合决定：
+ *   参考组 = 低输入 ∧ 油门范围 ∧ 时间范围
+ *   低输入 = 参考组 ∧ 质量（与参考响应的平均偏差 ≤ qualityThreshold）
+ *   高输入 = 高输入 ∧ 油门范围 ∧ 时间范围 ∧ 质量
+ * 条件变化后直方图只加入/扣除状态发生变化的窗口（整数权重，扣除是精确的）。
+ * 参考响应由低输入直方图临时加回未通过质量过滤的窗口得到，因此同样只需要两个直方图。
+ *
+ * 每次更新的代价与变化的窗口数成正比：
+ * - 油门/时间范围：窗口按油门和平均时间排序，只访问跨过新旧边界的窗口
+ * - 众数平均：直方图维护每个时间箱平滑列的 Σs² 与 Σv·s²，增减一个窗口只更新它落入的单元附近，
+ *   曲线由两个和之比直接得到，不再对整张直方图重新卷积
+ * - resp_quality：参考组不变时只为新进入范围的窗口补算偏差；参考响应变化后所有候选窗口
+ *   （在范围内的低/高输入窗口）的偏差都会变化，这是质量过滤本身的代价，按窗口并行计算
+ *
+ * 内存：两个直方图（各带每列3个double的平滑列和）+ 每个窗口的单元索引（windowCount × responseLength × 4字节）。
+ * 非线程安全：应在同一线程上修改条件、追加窗口和读取曲线。
+ */
+@interface PIDIncrementalResponseAnalysis : NSObject
+
+// 来源结果（结果对象变化时应重新创建分析；追加窗口不改变该属性）
+@property (nonatomic, strong, readonly) PIDResponseResult *responseResult;
+
+// 参与分析的窗口数
+@property (nonatomic, readonly) NSInteger windowCount;
+
+// 质量阈值：平均绝对偏差不超过该值的窗口保留（默认0.5，对应Python resp_quality）
+@property (nonatomic, assign) double qualityThreshold;
+
+// 最大油门范围 [minThrottle, maxThrottle]（默认不限制）
+@property (nonatomic, assign) double minThrottle;
+@property (nonatomic, assign) double maxThrottle;
+
+// 窗口平均时间范围 [startTime, endTime]，单位秒（默认不限制）
+@property (nonatomic, assign) double startTime;
+@property (nonatomic, assign) double endTime;
+
+// 最近一次更新中加入或扣除的窗口次数（统计用）
+@property (nonatomic, readonly) NSInteger lastUpdateWindowChanges;
+
+/**
+ * @param result 阶跃响应分析结果（优先使用stepResponseData）
+ * @return 分析对象；没有窗口时返回nil
+ */
+- (nullable instancetype)initWithResponseResult:(PIDResponseResult *)result;
+
+- (instancetype)init NS_UNAVAILABLE;
+
+/**
+ * 追加新窗口（例如流水线快照中新完成的窗口），响应长度须与已有窗口相同，长度不一致的窗口不参与直方图
+ * 新窗口按当前条件分组，下一次 currentCurves 只加入这些窗口，并在参考组变化时更新参考响应
+ * @param result 只包含新窗口的结果
+ */
+- (void)appendWindowsFromResult:(PIDResponseResult *)result;
+
+/**
+ * 按当前条件计算响应曲线（条件和窗口都未变化时直接返回上次的结果）
+ */
+- (PIDResponseCurves *)currentCurves;
+
+/**
+ * 内存占用估计
+ * @param windowCount 窗口数
+ * @param responseLength 每个窗口的响应点数
+ */
++ (NSUInteger)bytesForWindowCount:(NSInteger)windowCount responseLength:(NSInteger)responseLength;
+
 @end
 
 #pragma mark - PID追踪分析器
@@ -123,6 +616,9 @@ NS_ASSUME_NONNULL_BEGIN
  * - 计算PID环路输入 (pid_in)
  * - 分析阶跃响应 (stack_response)
  * - 噪声频谱分析 (spectrum)
+ *
+ * 线程安全：同一个分析器可以被多个轴并发调用（分析方法在入口处读取一次配置，
+ * 内部的窗口批次按块并行）；分析进行中不要修改配置属性。
  */
 @interface PIDTraceAnalyzer : NSObject
 
@@ -133,6 +629,24 @@ NS_ASSUME_NONNULL_BEGIN
 @property (nonatomic, assign) NSInteger responseLen; // 响应长度 (样本点数)
 @property (nonatomic, assign) double sampleRate;      // 采样率 (Hz) - 🔥 新增：用于动态计算responseLen
 
+// 取消令牌（可选）：分析方法在窗口之间检查，取消后尽快返回空结果；
+// 同时交给维纳反卷积，以及没有自己令牌的频谱缓存
+@property (nonatomic, strong, nullable) PIDCancellationToken *cancellationToken;
+
+// 频谱缓存路径是否保留逐窗口频谱矩阵（默认NO：只给出流式累加结果，长日志不再装箱 窗口数×频率点 个值）
+@property (nonatomic, assign) BOOL retainsWindowSpectra;
+
+// 活动度预筛（默认NO）：加窗统计量在任何FFT之前算出，max_in ≤ 20 的窗口（地面怠速、未解锁、
+// 降落后的尾段）不会进入lowHighMask的任何一组，跳过它们的输入FFT、维纳滤波和逆FFT，阶跃响应行置零。
+// 响应曲线与不预筛时完全相同；只需要逐窗口响应本身（例如与Python逐窗口对照）时保持NO
+@property (nonatomic, assign) BOOL pruneInactiveWindows;
+
+// 计算精度（默认PIDDSPPrecisionDefault，即float64，除非构建时定义PID_DSP_FLOAT32=1）：
+// float32时频谱缓存、维纳滤波、逆FFT与累积和为单精度（噪声频谱共用同一组单精度陀螺仪频谱），
+// 结果在输出边界转换为双精度，与float64的偏差在PIDRealParityTolerance以内。
+// 分析界面、PIDPipelinedAnalyzer与PIDOutOfCoreAnalyzer使用float32；与Python参考对照时保持float64
+@property (nonatomic, assign) PIDDSPPrecision precision;
+
 // 维纳反卷积处理器
 @property (nonatomic, strong, readonly) PIDWienerDeconvolution *wienerDeconvolution;
 
@@ -192,6 +706,15 @@ NS_ASSUME_NONNULL_BEGIN
 - (PIDResponseResult *)stackResponse:(PIDStackData *)stacks
                              window:(NSArray<NSNumber *> *)window;
 
+/**
+ * 计算阶跃响应（使用频谱缓存）
+ * 加窗后的输入/陀螺仪频谱从缓存取得，之后的噪声频谱可直接复用陀螺仪频谱
+ *
+ * @param cache 频谱缓存（窗函数为缓存记录的分析窗）
+ * @return 响应分析结果
+ */
+- (PIDResponseResult *)stackResponseWithSpectralCache:(PIDSpectralCache *)cache;
+
 /**
  * 生成Tukey窗函数
  * 对应Python: tukeywin(len, alpha=0.5)
@@ -203,6 +726,66 @@ NS_ASSUME_NONNULL_BEGIN
 - (NSArray<NSNumber *> *)tukeyWindowWithLength:(NSInteger)length
                                           alpha:(double)alpha;
 
+#pragma mark - 平均互谱估计
+
+/**
+ * 平均互谱阶跃响应（快速估计，用于预览和批量摘要）
+ *
+ * 与逐窗口路径相同的Hanning窗、补零长度和1/sn，但不对每个窗口做反卷积：
+ * 按低/高输入分组累加 Σ|H|² 与 ΣG·conj(H)，每组只做一次正则化除法
+ *   (ΣG·conj(H)/N) / (Σ|H|²/N + 1/sn)
+ * 和一次逆FFT，再累积和并减去起点。每个窗口只剩两次正向FFT，
+ * 没有逐窗口的逆FFT、累积和与直方图，max_in ≤ 20 的窗口不做FFT。
+ *
+ * 分组条件与 responseCurvesFromResult: 相同（low_high_mask(500) × toolow(20)，少于10个窗口的组不输出），
+ * 但没有resp_quality过滤，结果是线性平均而不是直方图的众数。
+ *
+ * 与完整方法（stackResponseWithSpectralCache: + responseCurvesFromResult:）的实测偏差：
+ * - 合成日志（8kHz、80000点、三轴一阶滞后，每轴145个窗口，3个随机种子）：respLow全程最大偏差 ≤ 0.005，
+ *   稳态段（0.2–0.5s）≤ 0.003，终值0.56–0.70时相对偏差 < 0.5%。合成日志的输入不超过500°/s，没有高输入组
+ * - 真实日志：上升段受异常窗口（没有质量过滤）影响更明显，稳态段上限取0.1
+ * PIDAlgorithmVerifier 的 verifyCrossSpectrumAgreementWithCSV: 对验证目录中的每个日志（没有时用合成日志）检查稳态段上限。
+ * 分析界面选择 PIDResponseEstimatorAveragedCrossSpectrum 时用本方法代替逐窗口路径。
+ *
+ * @param stacks 堆叠窗口数据
+ * @return 响应曲线（respLow/respHigh长度为responseLen）；没有窗口或已取消时返回nil
+ */
+- (nullable PIDResponseCurves *)averagedCrossSpectrumCurvesWithStackData:(PIDStackData *)stacks;
+
+#pragma mark - 参数扫描
+
+/**
+ * 一遍计算多组参数的响应曲线（调参时实时对比）
+ *
+ * 加窗统计量和缓存中的输入/陀螺仪频谱（H、G）与参数无关，只计算一次，之后的同一缓存再次扫描时直接复用。
+ * 相同截止频率的参数组共用一次信噪比掩码、维纳除法、逆FFT和累积和（按组内最长的响应长度），
+ * 较短的响应长度取前缀；每组参数按自己的高输入阈值分组、质量过滤并做加权模式平均。
+ * max_in ≤ 20 的窗口对任何参数都不参与分组，不做反卷积（同 pruneInactiveWindows）。
+ * 扫描始终使用双精度共用频谱；默认参数（cutFreq、responseLen、500）的结果与
+ * stackResponseWithSpectralCache: + responseCurvesFromResult: 相同。
+ *
+ * @param cache 频谱缓存（会话内按轴保留，重复扫描不再做正向FFT）
+ * @param parameterSets 参数组
+ * @return 与parameterSets顺序相同的响应曲线；参数无效、没有窗口或已取消时返回nil
+ */
+- (nullable NSArray<PIDResponseCurves *> *)responseCurvesWithSpectralCache:(PIDSpectralCache *)cache
+                                                            parameterSets:(NSArray<PIDResponseParameters *> *)parameterSets;
+
+#pragma mark - 油门分层响应
+
+/**
+ * 响应-油门热力图：按窗口最大油门把阶跃响应分层，填充 axisResult.responseHeatmap [油门箱][时间箱]、
+ * axisResult.throttleBins（油门箱中心，%）与 axisResult.responseTime（时间箱中心，秒）
+ * 只计入 max_in > 20 的窗口（与lowHighMask的toolow条件相同），不做质量过滤；
+ * 一遍扫描响应矩阵，所有油门箱的平滑与众数提取成批完成，代价约为一次额外的weightedModeAverage
+ *
+ * @param axisResult 要填充的单轴结果
+ * @param result 阶跃响应分析结果（优先使用stepResponseData）
+ * @return 没有窗口时返回NO，不修改axisResult
+ */
+- (BOOL)fillThrottleResponseForAxisResult:(PIDAxisAnalysisResult *)axisResult
+                       fromResponseResult:(PIDResponseResult *)result;
+
 #pragma mark - 频谱分析
 
 /**
@@ -216,6 +799,34 @@ NS_ASSUME_NONNULL_BEGIN
 - (PIDSpectrumResult *)spectrumWithTime:(NSArray<NSNumber *> *)time
                                 traces:(NSArray<NSArray<NSNumber *> *> *)traces;
 
+/**
+ * 计算噪声频谱（使用频谱缓存）
+ * 对应Python: stackspectrum（陀螺仪先乘分析窗再做FFT）
+ * padding长度与反卷积相同时（窗口长度不是1024的倍数）直接复用响应分析已计算的陀螺仪频谱
+ * 每个窗口的频谱连同油门直接累加到result.accumulator；retainsWindowSpectra为NO时result.spectrum为空
+ *
+ * @param time 时间数组（用于采样间隔）
+ * @param cache 频谱缓存
+ * @return 频谱分析结果
+ */
+- (PIDSpectrumResult *)spectrumWithTime:(NSArray<NSNumber *> *)time
+                         spectralCache:(PIDSpectralCache *)cache;
+
+/**
+ * 多通道噪声频谱（陀螺仪、D项、debug、rcCommand等在同一组窗口上的频谱）
+ * 与对每个通道分别做 spectrumWithTime:spectralCache: 的累加结果相同（同一padding、分析窗与窗口油门），
+ * 但全部通道一次批量FFT：共用FFT计划、分析窗、窗口油门和每线程暂存区，窗口块内按通道连续处理，
+ * 不经过NSNumber装箱，也不占用频谱缓存（附加通道的频谱用完即折叠进累加器）
+ *
+ * @param channels 通道列缓冲区（由 cache.stackData 的 columnFromSamples: 得到）；长度不足的通道不做FFT，累加器为空
+ * @param time 时间数组（用于采样间隔）
+ * @param cache 频谱缓存（提供堆叠窗口、分析窗与取消令牌）
+ * @return 与channels顺序相同的累加器；参数无效或已取消时返回nil
+ */
+- (nullable NSArray<PIDSpectrumAccumulator *> *)spectrumAccumulatorsForChannels:(NSArray<NSData *> *)channels
+                                                                         time:(NSArray<NSNumber *> *)time
+                                                                spectralCache:(PIDSpectralCache *)cache;
+
 /**
  * 生成Tukey窗函数
  * @param length 窗口长度
@@ -228,12 +839,19 @@ NS_ASSUME_NONNULL_BEGIN
 /**
  * 生成Hanning窗函数
  * 对应Python: np.hanning(length)
+ * 窗函数按参数备忘，同一长度每次返回同一个数组（Tukey窗相同）
  *
  * @param length 窗口长度
  * @return 窗函数数组
  */
 + (NSArray<NSNumber *> *)hanningWindowWithLength:(NSInteger)length;
 
+/**
+ * Hanning窗的原始值（double数组，备忘，与hanningWindowWithLength:逐点相同）
+ * @param length 窗口长度
+ */
++ (NSData *)hanningWindowValuesWithLength:(NSInteger)length;
+
 #pragma mark - 数据预处理
 
 /**
@@ -305,6 +923,15 @@ NS_ASSUME_NONNULL_BEGIN
                                                 vertRange:(NSArray<NSNumber *> *)vertRange
                                                  vertBins:(NSInteger)vertBins;
 
+/**
+ * 计算单轴的低/高输入响应曲线
+ * low_high_mask(500) × toolow(20) 分组，resp_quality 过滤后做加权模式平均
+ *
+ * @param result 阶跃响应分析结果
+ * @return 响应曲线，没有窗口时返回nil
+ */
++ (nullable PIDResponseCurves *)responseCurvesFromResult:(PIDResponseResult *)result;
+
 #pragma mark - 辅助方法（Python算法对齐）
 
 /**
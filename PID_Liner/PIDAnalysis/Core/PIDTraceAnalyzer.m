@@ -10,87 +10,430 @@
 #import "PIDWienerDeconvolution.h"
 #import "PIDFFTProcessor.h"
 #import "PIDInterpolation.h"
+#import "PIDSpectralCache.h"
+#import "PIDCancellationToken.h"
+#import "PIDParallel.h"
+#import "PIDFFTPlan.h"
+#import "PIDMultiAxisKernels.h"
+#import "PIDResponseKernels.h"
+#import "PIDGaussianSmoothing.h"
+#import "PIDScratchArena.h"
+#import "PIDBatchedSpectrum.h"
 #import <mach/mach_time.h>
 
 // Betaflight P缩放因子
 static const double kP_SCALE_FACTOR = 0.032029;
 
-@implementation PIDStackData
+// 响应曲线参数（对应Python的 vertrange / vertbins / low_high_mask 阈值 / resp_quality 阈值）
+static const double kResponseVertMin = -1.5;
+static const double kResponseVertMax = 3.5;
+static const NSInteger kResponseVertBins = 1000;
+static const double kHighInputThreshold = 500.0;
+static const double kActiveInputThreshold = 20.0;
+static const NSInteger kMinMaskWindowCount = 10;
+static const double kResponseQualityThreshold = 0.5;
 
-- (NSInteger)windowCount {
-    return self.input.count;
+// 油门指令范围（rcCommand[3]），噪声热力图按百分比分箱
+static const double kThrottleCommandMin = 1000.0;
+static const double kThrottleCommandMax = 2000.0;
+
+#pragma mark - 窗口视图
+
+/**
+ * 列缓冲区中一个窗口的只读视图
+ * NSArray子类：只保存列缓冲区引用和偏移，元素在访问时才装箱
+ */
+@interface PIDStackWindowView : NSArray
+
+- (instancetype)initWithColumn:(NSData *)column
+                        offset:(NSInteger)offset
+                        length:(NSInteger)length;
+
+@end
+
+@implementation PIDStackWindowView {
+    NSData *_column;        // 持有列缓冲区，保证_base有效
+    const double *_base;
+    NSInteger _length;
+}
+
+- (instancetype)initWithColumn:(NSData *)column
+                        offset:(NSInteger)offset
+                        length:(NSInteger)length {
+    self = [super init];
+    if (self) {
+        _column = column;
+        _base = (const double *)column.bytes + offset;
+        _length = length;
+    }
+    return self;
+}
+
+- (NSUInteger)count {
+    return (NSUInteger)_length;
+}
+
+- (id)objectAtIndex:(NSUInteger)index {
+    if (index >= (NSUInteger)_length) {
+        [NSException raise:NSRangeException
+                    format:@"窗口视图索引越界: %lu / %ld", (unsigned long)index, (long)_length];
+    }
+    return @(_base[index]);
+}
+
+- (id)copyWithZone:(NSZone *)zone {
+    return self;
+}
+
+@end
+
+/**
+ * 全部窗口的视图列表（按需创建窗口视图）
+ */
+@interface PIDStackWindowList : NSArray
+
+- (instancetype)initWithColumn:(NSData *)column
+                   windowCount:(NSInteger)windowCount
+                  windowLength:(NSInteger)windowLength
+                          step:(NSInteger)step;
+
+@end
+
+@implementation PIDStackWindowList {
+    NSData *_column;
+    NSInteger _windowCount;
+    NSInteger _windowLength;
+    NSInteger _step;
+}
+
+- (instancetype)initWithColumn:(NSData *)column
+                   windowCount:(NSInteger)windowCount
+                  windowLength:(NSInteger)windowLength
+                          step:(NSInteger)step {
+    self = [super init];
+    if (self) {
+        _column = column;
+        _windowCount = column ? windowCount : 0;
+        _windowLength = windowLength;
+        _step = step;
+    }
+    return self;
+}
+
+- (NSUInteger)count {
+    return (NSUInteger)_windowCount;
+}
+
+- (id)objectAtIndex:(NSUInteger)index {
+    if (index >= (NSUInteger)_windowCount) {
+        [NSException raise:NSRangeException
+                    format:@"窗口索引越界: %lu / %ld", (unsigned long)index, (long)_windowCount];
+    }
+    return [[PIDStackWindowView alloc] initWithColumn:_column
+                                               offset:(NSInteger)index * _step
+                                               length:_windowLength];
+}
+
+- (id)copyWithZone:(NSZone *)zone {
+    return self;
+}
+
+@end
+
+/**
+ * 把NSNumber列的 [start, start+length) 拷贝为连续double缓冲区
+ * 列长度不足的部分补0
+ */
+static NSMutableData *PIDStackColumnFromArray(NSArray<NSNumber *> *array, NSInteger start, NSInteger length) {
+    NSMutableData *column = [NSMutableData dataWithLength:length * sizeof(double)];
+    double *dst = (double *)column.mutableBytes;
+    NSInteger available = MIN(MAX((NSInteger)array.count - start, 0), length);
+    for (NSInteger i = 0; i < available; i++) {
+        dst[i] = [array[start + i] doubleValue];
+    }
+    return column;
+}
+
+#pragma mark - 三轴堆叠组
+
+// 三轴堆叠统计量的平面布局：maxIn×3、avgIn×3、maxThrottle、avgTime，各windowCount个点
+typedef NS_ENUM(NSInteger, PIDAxisStatistic) {
+    PIDAxisStatisticMaxInput = 0,
+    PIDAxisStatisticAvgInput = PIDAxisStatisticMaxInput + 3,
+    PIDAxisStatisticMaxThrottle = PIDAxisStatisticAvgInput + 3,
+    PIDAxisStatisticAvgTime,
+    PIDAxisStatisticCount,
+};
+
+// 交错拆箱的块长度（两个4路缓冲区共64KB，留在L1/L2中）
+static const NSInteger kAxisInterleaveBlock = 1024;
+
+/**
+ * 同一次 stacksForAxesFromData: 创建的三个轴共用的数据：油门/时间列，以及按分析窗备忘的加窗统计量
+ * 第一个请求统计量的轴用4路内核一遍算出三个轴和油门，其余轴直接取用
+ */
+@interface PIDStackAxisGroup : NSObject
+@end
+
+@implementation PIDStackAxisGroup {
+    NSArray<NSData *> *_laneColumns;    // 按PIDAxisLane：三个轴的PID输入列 + 油门列
+    NSData *_timeColumn;
+    NSInteger _windowCount;
+    NSInteger _windowLength;
+    NSInteger _step;
+
+    NSData *_statisticsWindow;      // 备忘的分析窗（按内容比较）
+    NSData *_statistics;
+}
+
+/**
+ * @param laneColumns 按PIDAxisLane排列的4列（没有数据的轴用油门列占位，结果不使用）
+ */
+- (instancetype)initWithLaneColumns:(NSArray<NSData *> *)laneColumns
+                         timeColumn:(NSData *)timeColumn
+                        windowCount:(NSInteger)windowCount
+                       windowLength:(NSInteger)windowLength
+                               step:(NSInteger)step {
+    self = [super init];
+    if (self) {
+        _laneColumns = [laneColumns copy];
+        _timeColumn = timeColumn;
+        _windowCount = windowCount;
+        _windowLength = windowLength;
+        _step = step;
+    }
+    return self;
+}
+
+/**
+ * 全部窗口的加窗统计量（PIDAxisStatistic平面布局）；已取消时返回nil且不备忘
+ */
+- (nullable NSData *)statisticsWithWindow:(const double *)window cancel:(const PIDCancelFlag *)cancel {
+    size_t windowBytes = (size_t)_windowLength * sizeof(double);
+    @synchronized (self) {
+        if (_statistics && memcmp(_statisticsWindow.bytes, window, windowBytes) == 0) {
+            return _statistics;
+        }
+
+        NSInteger windowCount = _windowCount;
+        NSInteger windowLength = _windowLength;
+        NSInteger step = _step;
+        NSMutableData *statistics = [NSMutableData dataWithLength:PIDAxisStatisticCount * windowCount * sizeof(double)];
+        double *planes = statistics.mutableBytes;
+
+        const double *roll = _laneColumns[PIDAxisLaneRoll].bytes;
+        const double *pitch = _laneColumns[PIDAxisLanePitch].bytes;
+        const double *yaw = _laneColumns[PIDAxisLaneYaw].bytes;
+        const double *throttle = _laneColumns[PIDAxisLaneThrottle].bytes;
+        const double *time = _timeColumn.bytes;
+
+        size_t chunkCount = PIDParallelChunkCount((size_t)windowCount, 16);
+        PIDParallelForEach(chunkCount, ^(size_t chunk) {
+            NSInteger begin = (NSInteger)(chunk * (size_t)windowCount / chunkCount);
+            NSInteger end = (NSInteger)((chunk + 1) * (size_t)windowCount / chunkCount);
+            for (NSInteger i = begin; i < end && !PIDCancelFlagIsSet(cancel); i++) {
+                NSInteger offset = i * step;
+                const double *columns[PIDAxisLaneCount] = {
+                    roll + offset, pitch + offset, yaw + offset, throttle + offset,
+                };
+                double maxAbs[PIDAxisLaneCount];
+                double meanAbs[PIDAxisLaneCount];
+                PIDMultiAxisWindowStatistics(columns, window, (size_t)windowLength, maxAbs, meanAbs);
+                for (NSInteger axis = 0; axis < 3; axis++) {
+                    planes[(PIDAxisStatisticMaxInput + axis) * windowCount + i] = maxAbs[axis];
+                    planes[(PIDAxisStatisticAvgInput + axis) * windowCount + i] = meanAbs[axis];
+                }
+                planes[PIDAxisStatisticMaxThrottle * windowCount + i] = maxAbs[PIDAxisLaneThrottle];
+                vDSP_meanvD(time + offset, 1, &planes[PIDAxisStatisticAvgTime * windowCount + i], (vDSP_Length)windowLength);
+            }
+        });
+
+        if (PIDCancelFlagIsSet(cancel)) {
+            return nil;
+        }
+        _statisticsWindow = [NSData dataWithBytes:window length:windowBytes];
+        _statistics = statistics;
+        return statistics;
+    }
+}
+
+@end
+
+#pragma mark - PIDStackData Implementation
+
+@interface PIDStackData ()
+
+/**
+ * 从三轴堆叠组取本轴的加窗统计量（不是由stacksForAxesFromData:创建时返回NO）
+ * 输出缓冲区各windowCount个点
+ */
+- (BOOL)groupStatisticsWithWindow:(const double *)window
+                           cancel:(const PIDCancelFlag *)cancel
+                         maxInput:(double *)maxInput
+                         avgInput:(double *)avgInput
+                      maxThrottle:(double *)maxThrottle
+                          avgTime:(double *)avgTime;
+
+@end
+
+@implementation PIDStackData {
+    // 连续列缓冲区，各覆盖 (windowCount-1)*step + windowLength 个样本
+    NSData *_inputColumn;
+    NSData *_gyroColumn;
+    NSData *_throttleColumn;
+    NSData *_timeColumn;
+
+    // 三轴一起创建时共用的堆叠组（单轴创建时为nil）
+    PIDStackAxisGroup *_axisGroup;
+    NSInteger _axisIndex;
+}
+
+- (instancetype)initWithInputColumn:(NSData *)inputColumn
+                         gyroColumn:(NSData *)gyroColumn
+                     throttleColumn:(NSData *)throttleColumn
+                         timeColumn:(NSData *)timeColumn
+                        windowCount:(NSInteger)windowCount
+                       windowLength:(NSInteger)windowLength
+                               step:(NSInteger)step {
+    self = [super init];
+    if (self) {
+        _inputColumn = inputColumn;
+        _gyroColumn = gyroColumn;
+        _throttleColumn = throttleColumn;
+        _timeColumn = timeColumn;
+        _windowCount = windowCount;
+        _windowLength = windowLength;
+        _step = step;
+    }
+    return self;
+}
+
+#pragma mark 窗口访问
+
+- (NSArray<NSArray<NSNumber *> *> *)windowListForColumn:(NSData *)column {
+    return [[PIDStackWindowList alloc] initWithColumn:column
+                                          windowCount:_windowCount
+                                         windowLength:_windowLength
+                                                 step:_step];
+}
+
+- (NSArray<NSArray<NSNumber *> *> *)input {
+    return [self windowListForColumn:_inputColumn];
+}
+
+- (NSArray<NSArray<NSNumber *> *> *)gyro {
+    return [self windowListForColumn:_gyroColumn];
+}
+
+- (NSArray<NSArray<NSNumber *> *> *)throttle {
+    return [self windowListForColumn:_throttleColumn];
+}
+
+- (NSArray<NSArray<NSNumber *> *> *)time {
+    return [self windowListForColumn:_timeColumn];
+}
+
+- (const double *)window:(NSInteger)index inColumn:(NSData *)column {
+    if (!column || index < 0 || index >= _windowCount) {
+        return NULL;
+    }
+    return (const double *)column.bytes + index * _step;
+}
+
+- (const double *)inputWindowAtIndex:(NSInteger)index {
+    return [self window:index inColumn:_inputColumn];
+}
+
+- (const double *)gyroWindowAtIndex:(NSInteger)index {
+    return [self window:index inColumn:_gyroColumn];
+}
+
+- (const double *)throttleWindowAtIndex:(NSInteger)index {
+    return [self window:index inColumn:_throttleColumn];
 }
 
-- (NSInteger)windowLength {
-    return self.windowCount > 0 ? self.input[0].count : 0;
+- (const double *)timeWindowAtIndex:(NSInteger)index {
+    return [self window:index inColumn:_timeColumn];
 }
 
+- (NSData *)columnFromSamples:(NSArray<NSNumber *> *)samples {
+    NSInteger spanLength = _windowCount > 0 ? (_windowCount - 1) * _step + _windowLength : 0;
+    return PIDStackColumnFromArray(samples, _sampleStart, spanLength);
+}
+
+- (BOOL)groupStatisticsWithWindow:(const double *)window
+                           cancel:(const PIDCancelFlag *)cancel
+                         maxInput:(double *)maxInput
+                         avgInput:(double *)avgInput
+                      maxThrottle:(double *)maxThrottle
+                          avgTime:(double *)avgTime {
+    NSData *statistics = [_axisGroup statisticsWithWindow:window cancel:cancel];
+    if (!statistics) {
+        return NO;
+    }
+    const double *planes = statistics.bytes;
+    size_t bytes = (size_t)_windowCount * sizeof(double);
+    memcpy(maxInput, planes + (PIDAxisStatisticMaxInput + _axisIndex) * _windowCount, bytes);
+    memcpy(avgInput, planes + (PIDAxisStatisticAvgInput + _axisIndex) * _windowCount, bytes);
+    memcpy(maxThrottle, planes + PIDAxisStatisticMaxThrottle * _windowCount, bytes);
+    memcpy(avgTime, planes + PIDAxisStatisticAvgTime * _windowCount, bytes);
+    return YES;
+}
+
+#pragma mark 堆叠
+
 + (instancetype)stackFromData:(PIDCSVData *)data
                   windowSize:(NSInteger)windowSize
                     overlap:(double)overlap {
-    PIDStackData *stack = [[PIDStackData alloc] init];
-
     NSInteger n = data.timeSeconds.count;
-    if (n == 0 || windowSize <= 0) {
-        return stack;
+    NSInteger windowCount = [self windowCountForSampleCount:n windowSize:windowSize overlap:overlap];
+    if (windowCount == 0) {
+        return [[PIDStackData alloc] init];
     }
 
     // 计算步长
     NSInteger step = (NSInteger)(windowSize * (1.0 - overlap));
     if (step < 1) step = 1;
 
-    // 计算窗口数量
-    NSInteger windowCount = (n - windowSize) / step + 1;
-
-    // 创建堆叠数据
-    NSMutableArray<NSMutableArray<NSNumber *> *> *inputStack = [NSMutableArray arrayWithCapacity:windowCount];
-    NSMutableArray<NSMutableArray<NSNumber *> *> *gyroStack = [NSMutableArray arrayWithCapacity:windowCount];
-    NSMutableArray<NSMutableArray<NSNumber *> *> *throttleStack = [NSMutableArray arrayWithCapacity:windowCount];
-    NSMutableArray<NSMutableArray<NSNumber *> *> *timeStack = [NSMutableArray arrayWithCapacity:windowCount];
-
-    for (NSInteger i = 0; i < windowCount; i++) {
-        NSInteger start = i * step;
-        NSInteger end = MIN(start + windowSize, n);
-
-        // 提取窗口数据
-        NSArray<NSNumber *> *timeWindow = [data.timeSeconds subarrayWithRange:NSMakeRange(start, end - start)];
-        NSArray<NSNumber *> *rcCommand0 = [data.rcCommand0 subarrayWithRange:NSMakeRange(start, end - start)];
-        NSArray<NSNumber *> *rcCommand3 = [data.rcCommand3 subarrayWithRange:NSMakeRange(start, end - start)];
-        NSArray<NSNumber *> *gyro0 = [data.gyroADC0 subarrayWithRange:NSMakeRange(start, end - start)];
-        NSArray<NSNumber *> *axisP0 = [data.axisP0 subarrayWithRange:NSMakeRange(start, end - start)];
-
-        // 计算PID输入（使用rcCommand[0]作为输入）
-        NSMutableArray<NSNumber *> *pidInput = [NSMutableArray arrayWithCapacity:end - start];
-        for (NSInteger j = 0; j < rcCommand0.count; j++) {
-            double pval = [rcCommand0[j] doubleValue];
-            double gyro = [gyro0[j] doubleValue];
-            double pidp = [axisP0[j] doubleValue];
-
-            // 🔧 防止除以0：当axisP为0或很小时，只使用gyro作为输入
-            double pidin;
-            double denom = kP_SCALE_FACTOR * pidp;
-            if (fabs(denom) < 1e-9) {
-                // axisP为0或接近0，无法计算PID输入，使用gyro作为fallback
-                pidin = gyro;
-            } else {
-                // pidin = gyro + pval / (0.032029 * pidp)
-                pidin = gyro + pval / denom;
-            }
-            [pidInput addObject:@(pidin)];
+    // 所有窗口覆盖的样本范围，每列只提取一次
+    NSInteger spanLength = (windowCount - 1) * step + windowSize;
+    NSMutableData *inputColumn = PIDStackColumnFromArray(data.rcCommand0, 0, spanLength);
+    NSMutableData *gyroColumn = PIDStackColumnFromArray(data.gyroADC0, 0, spanLength);
+    NSMutableData *axisPColumn = PIDStackColumnFromArray(data.axisP0, 0, spanLength);
+
+    // 计算PID输入（使用rcCommand[0]作为输入，axisP[0]逐点作为P增益）
+    double *pidInput = (double *)inputColumn.mutableBytes;
+    const double *gyro = (const double *)gyroColumn.bytes;
+    const double *axisP = (const double *)axisPColumn.bytes;
+    for (NSInteger j = 0; j < spanLength; j++) {
+        // 🔧 防止除以0：当axisP为0或很小时，只使用gyro作为输入
+        double denom = kP_SCALE_FACTOR * axisP[j];
+        if (fabs(denom) < 1e-9) {
+            pidInput[j] = gyro[j];
+        } else {
+            // pidin = gyro + pval / (0.032029 * pidp)
+            pidInput[j] = gyro[j] + pidInput[j] / denom;
         }
-
-        [timeStack addObject:[timeWindow mutableCopy]];
-        [inputStack addObject:pidInput];
-        [gyroStack addObject:[gyro0 mutableCopy]];
-        [throttleStack addObject:[rcCommand3 mutableCopy]];
     }
 
-    stack.input = inputStack;
-    stack.gyro = gyroStack;
-    stack.throttle = throttleStack;
-    stack.time = timeStack;
+    return [[PIDStackData alloc] initWithInputColumn:inputColumn
+                                          gyroColumn:gyroColumn
+                                      throttleColumn:PIDStackColumnFromArray(data.rcCommand3, 0, spanLength)
+                                          timeColumn:PIDStackColumnFromArray(data.timeSeconds, 0, spanLength)
+                                         windowCount:windowCount
+                                        windowLength:windowSize
+                                                step:step];
+}
 
-    return stack;
++ (NSInteger)windowCountForSampleCount:(NSInteger)sampleCount
+                            windowSize:(NSInteger)windowSize
+                               overlap:(double)overlap {
+    if (windowSize <= 0 || sampleCount < windowSize) {
+        return 0;
+    }
+    NSInteger step = (NSInteger)(windowSize * (1.0 - overlap));
+    if (step < 1) step = 1;
+    return (sampleCount - windowSize) / step + 1;
 }
 
 + (instancetype)stackFromData:(PIDCSVData *)data
@@ -98,11 +441,26 @@ static const double kP_SCALE_FACTOR = 0.032029;
                 windowSize:(NSInteger)windowSize
                   overlap:(double)overlap
                      pGain:(double)pGain {
-    PIDStackData *stack = [[PIDStackData alloc] init];
+    NSInteger windowCount = [self windowCountForSampleCount:data.timeSeconds.count
+                                                 windowSize:windowSize
+                                                    overlap:overlap];
+    return [self stackFromData:data
+                     axisIndex:axisIndex
+                    windowSize:windowSize
+                       overlap:overlap
+                         pGain:pGain
+                   windowRange:NSMakeRange(0, windowCount)];
+}
 
++ (instancetype)stackFromData:(PIDCSVData *)data
+                  axisIndex:(NSInteger)axisIndex
+                windowSize:(NSInteger)windowSize
+                  overlap:(double)overlap
+                     pGain:(double)pGain
+               windowRange:(NSRange)windowRange {
     NSInteger n = data.timeSeconds.count;
-    if (n == 0 || windowSize <= 0) {
-        return stack;
+    if (n < windowSize || windowSize <= 0) {
+        return [[PIDStackData alloc] init];
     }
 
     // 🔧 使用固定的P增益值（从CSV头信息解析得到，而非axisP数据）
@@ -117,14 +475,14 @@ static const double kP_SCALE_FACTOR = 0.032029;
     NSInteger step = (NSInteger)(windowSize * (1.0 - overlap));
     if (step < 1) step = 1;
 
-    // 计算窗口数量
-    NSInteger windowCount = (n - windowSize) / step + 1;
-
-    // 创建堆叠数据
-    NSMutableArray<NSMutableArray<NSNumber *> *> *inputStack = [NSMutableArray arrayWithCapacity:windowCount];
-    NSMutableArray<NSMutableArray<NSNumber *> *> *gyroStack = [NSMutableArray arrayWithCapacity:windowCount];
-    NSMutableArray<NSMutableArray<NSNumber *> *> *throttleStack = [NSMutableArray arrayWithCapacity:windowCount];
-    NSMutableArray<NSMutableArray<NSNumber *> *> *timeStack = [NSMutableArray arrayWithCapacity:windowCount];
+    // 计算窗口数量（只处理数据已完整覆盖的窗口）
+    NSInteger availableCount = (n - windowSize) / step + 1;
+    NSInteger firstWindow = (NSInteger)windowRange.location;
+    NSInteger lastWindow = MIN((NSInteger)NSMaxRange(windowRange), availableCount);
+    NSInteger windowCount = MAX(lastWindow - firstWindow, 0);
+    if (windowCount == 0) {
+        return [[PIDStackData alloc] init];
+    }
 
     // 根据轴索引选择数据
     NSArray<NSNumber *> *gyroADCAxis = nil;
@@ -144,87 +502,2032 @@ static const double kP_SCALE_FACTOR = 0.032029;
             axisP = data.axisP2;
             break;
         default:
-            return stack;
+            return [[PIDStackData alloc] init];
+    }
+
+    // 验证数据（解析器对缺少的列给出空数组）
+    if (gyroADCAxis.count == 0 || axisP.count == 0) {
+        return [[PIDStackData alloc] init];
+    }
+
+    // 窗口范围覆盖的样本：[firstWindow*step, (lastWindow-1)*step + windowSize)
+    // 每列只提取一次，窗口之间共享重叠部分
+    NSInteger sampleStart = firstWindow * step;
+    NSInteger spanLength = (windowCount - 1) * step + windowSize;
+    NSMutableData *gyroColumn = PIDStackColumnFromArray(gyroADCAxis, sampleStart, spanLength);
+    NSMutableData *inputColumn = PIDStackColumnFromArray(axisP, sampleStart, spanLength);
+    const double *gyro = (const double *)gyroColumn.bytes;
+    double *pidInput = (double *)inputColumn.mutableBytes;
+
+    // 🔍 调试：检查第一个窗口的axisP和gyro原始值范围（只在Roll轴的第一个窗口打印）
+    if (firstWindow == 0 && axisIndex == 0) {
+        double pMin, pMax, gMin, gMax;
+        vDSP_minvD(pidInput, 1, &pMin, (vDSP_Length)windowSize);
+        vDSP_maxvD(pidInput, 1, &pMax, (vDSP_Length)windowSize);
+        vDSP_minvD(gyro, 1, &gMin, (vDSP_Length)windowSize);
+        vDSP_maxvD(gyro, 1, &gMax, (vDSP_Length)windowSize);
+        NSLog(@"🔍 [原始数据窗口0] axisP范围: [%.1f, %.1f], gyro范围: [%.1f, %.1f], pGain=%.1f", pMin, pMax, gMin, gMax, pGain);
+    }
+
+    // 🔧 修正：计算PID输入（对应Python的pid_in函数），整列一次向量化完成
+    // Python: pidin = gyro + p_err / (0.032029 * pidp)
+    // 其中 p_err = axisP[i], pidp = 固定的P增益值
+    double denom = kP_SCALE_FACTOR * pGain;
+    if (fabs(denom) < 1e-9) {
+        // pGain为0或接近0，无法计算PID输入，使用gyro作为fallback
+        memcpy(pidInput, gyro, spanLength * sizeof(double));
+    } else {
+        vDSP_vsdivD(pidInput, 1, &denom, pidInput, 1, (vDSP_Length)spanLength);
+        vDSP_vaddD(pidInput, 1, gyro, 1, pidInput, 1, (vDSP_Length)spanLength);
+    }
+
+    PIDStackData *stack = [[PIDStackData alloc] initWithInputColumn:inputColumn
+                                                         gyroColumn:gyroColumn
+                                                     throttleColumn:PIDStackColumnFromArray(data.rcCommand3, sampleStart, spanLength)
+                                                         timeColumn:PIDStackColumnFromArray(data.timeSeconds, sampleStart, spanLength)
+                                                        windowCount:windowCount
+                                                       windowLength:windowSize
+                                                               step:step];
+    stack->_sampleStart = sampleStart;
+
+    NSLog(@"✅ 堆叠数据创建完成: %ld窗口, P增益=%.1f", (long)windowCount, pGain);
+
+    return stack;
+}
+
++ (NSArray<PIDStackData *> *)stacksForAxesFromData:(PIDCSVData *)data
+                                        windowSize:(NSInteger)windowSize
+                                           overlap:(double)overlap
+                                            pGains:(NSArray<NSNumber *> *)pGains {
+    NSInteger windowCount = [self windowCountForSampleCount:data.timeSeconds.count
+                                                 windowSize:windowSize
+                                                    overlap:overlap];
+    return [self stacksForAxesFromData:data
+                            windowSize:windowSize
+                               overlap:overlap
+                                pGains:pGains
+                           windowRange:NSMakeRange(0, windowCount)];
+}
+
++ (NSArray<PIDStackData *> *)stacksForAxesFromData:(PIDCSVData *)data
+                                        windowSize:(NSInteger)windowSize
+                                           overlap:(double)overlap
+                                            pGains:(NSArray<NSNumber *> *)pGains
+                                       windowRange:(NSRange)windowRange {
+    NSArray<PIDStackData *> *empty = @[[[PIDStackData alloc] init], [[PIDStackData alloc] init], [[PIDStackData alloc] init]];
+    NSInteger n = data.timeSeconds.count;
+    if (n < windowSize || windowSize <= 0) {
+        return empty;
+    }
+
+    // 窗口划分与单轴的 stackFromData:axisIndex:... 相同
+    NSInteger step = (NSInteger)(windowSize * (1.0 - overlap));
+    if (step < 1) step = 1;
+    NSInteger availableCount = (n - windowSize) / step + 1;
+    NSInteger firstWindow = (NSInteger)windowRange.location;
+    NSInteger lastWindow = MIN((NSInteger)NSMaxRange(windowRange), availableCount);
+    NSInteger windowCount = MAX(lastWindow - firstWindow, 0);
+    if (windowCount == 0) {
+        return empty;
+    }
+    NSInteger sampleStart = firstWindow * step;
+    NSInteger spanLength = (windowCount - 1) * step + windowSize;
+
+    // 各轴的列与P增益（缺少陀螺仪或P项的轴输出空堆叠；解析器对缺少的列给出空数组而不是nil）
+    NSArray<NSNumber *> *gyroArrays[3] = { data.gyroADC0, data.gyroADC1, data.gyroADC2 };
+    NSArray<NSNumber *> *axisPArrays[3] = { data.axisP0, data.axisP1, data.axisP2 };
+    NSArray<NSNumber *> *throttleArray = data.rcCommand3;
+    NSArray<NSNumber *> *timeArray = data.timeSeconds;
+
+    NSMutableData *inputColumns[3] = { nil, nil, nil };
+    NSMutableData *gyroColumns[3] = { nil, nil, nil };
+    double denominators[PIDAxisLaneCount] = { 1.0, 1.0, 1.0, 1.0 };
+    bool enabled[PIDAxisLaneCount] = { false, false, false, false };
+    for (NSInteger axis = 0; axis < 3; axis++) {
+        if (gyroArrays[axis].count == 0 || axisPArrays[axis].count == 0) {
+            continue;
+        }
+        inputColumns[axis] = [NSMutableData dataWithLength:spanLength * sizeof(double)];
+        gyroColumns[axis] = [NSMutableData dataWithLength:spanLength * sizeof(double)];
+
+        // pGain无效（<=0）时使用默认值45；分母接近0时PID输入回退为陀螺仪
+        double pGain = axis < (NSInteger)pGains.count ? [pGains[axis] doubleValue] : 0.0;
+        if (pGain <= 0) {
+            pGain = 45.0;
+        }
+        denominators[axis] = kP_SCALE_FACTOR * pGain;
+        enabled[axis] = fabs(denominators[axis]) >= 1e-9;
+    }
+    NSMutableData *throttleColumn = [NSMutableData dataWithLength:spanLength * sizeof(double)];
+    NSMutableData *timeColumn = [NSMutableData dataWithLength:spanLength * sizeof(double)];
+
+    double *inputTargets[PIDAxisLaneCount] = {
+        inputColumns[0].mutableBytes, inputColumns[1].mutableBytes, inputColumns[2].mutableBytes, NULL,
+    };
+    double *gyroTargets[PIDAxisLaneCount] = {
+        gyroColumns[0].mutableBytes, gyroColumns[1].mutableBytes, gyroColumns[2].mutableBytes,
+        throttleColumn.mutableBytes,
+    };
+    double *time = timeColumn.mutableBytes;
+
+    // 按块一遍读取所有列：陀螺仪×3+油门、P项×3交错为4路，PID输入在交错缓冲区上计算后拆回各列
+    // 长度不足的列补0（与PIDStackColumnFromArray相同）
+    PIDScratchArena *arena = PIDScratchArenaCurrent();
+    PIDScratchMark mark = PIDScratchArenaMark(arena);
+    double *gyroLanes = (double *)PIDScratchArenaAlloc(arena, 2 * kAxisInterleaveBlock * PIDAxisLaneCount * sizeof(double));
+    if (!gyroLanes) {
+        return empty;
+    }
+    double *inputLanes = gyroLanes + kAxisInterleaveBlock * PIDAxisLaneCount;
+    NSArray<NSNumber *> *laneArrays[PIDAxisLaneCount] = { gyroArrays[0], gyroArrays[1], gyroArrays[2], throttleArray };
+    NSInteger laneCounts[PIDAxisLaneCount];
+    NSInteger axisPCounts[3];
+    for (NSInteger lane = 0; lane < PIDAxisLaneCount; lane++) {
+        laneCounts[lane] = lane < 3 && !inputTargets[lane] ? 0 : (NSInteger)laneArrays[lane].count;
+    }
+    for (NSInteger axis = 0; axis < 3; axis++) {
+        axisPCounts[axis] = inputTargets[axis] ? (NSInteger)axisPArrays[axis].count : 0;
+    }
+    NSInteger timeCount = (NSInteger)timeArray.count;
+
+    for (NSInteger blockStart = 0; blockStart < spanLength; blockStart += kAxisInterleaveBlock) {
+        NSInteger blockLength = MIN(kAxisInterleaveBlock, spanLength - blockStart);
+        for (NSInteger i = 0; i < blockLength; i++) {
+            NSInteger index = sampleStart + blockStart + i;
+            double *gyroSample = gyroLanes + i * PIDAxisLaneCount;
+            double *inputSample = inputLanes + i * PIDAxisLaneCount;
+            for (NSInteger lane = 0; lane < PIDAxisLaneCount; lane++) {
+                gyroSample[lane] = index < laneCounts[lane] ? [laneArrays[lane][index] doubleValue] : 0.0;
+            }
+            for (NSInteger axis = 0; axis < 3; axis++) {
+                inputSample[axis] = index < axisPCounts[axis] ? [axisPArrays[axis][index] doubleValue] : 0.0;
+            }
+            inputSample[PIDAxisLaneThrottle] = 0.0;
+            time[blockStart + i] = index < timeCount ? [timeArray[index] doubleValue] : 0.0;
+        }
+
+        PIDMultiAxisPIDInput(inputLanes, gyroLanes, denominators, enabled, (size_t)blockLength);
+
+        double *gyroBlock[PIDAxisLaneCount];
+        double *inputBlock[PIDAxisLaneCount];
+        for (NSInteger lane = 0; lane < PIDAxisLaneCount; lane++) {
+            gyroBlock[lane] = gyroTargets[lane] ? gyroTargets[lane] + blockStart : NULL;
+            inputBlock[lane] = inputTargets[lane] ? inputTargets[lane] + blockStart : NULL;
+        }
+        PIDMultiAxisDeinterleave(gyroLanes, (size_t)blockLength, gyroBlock);
+        PIDMultiAxisDeinterleave(inputLanes, (size_t)blockLength, inputBlock);
+    }
+    PIDScratchArenaReset(arena, mark);
+
+    NSArray<NSData *> *laneColumns = @[inputColumns[0] ?: throttleColumn,
+                                       inputColumns[1] ?: throttleColumn,
+                                       inputColumns[2] ?: throttleColumn,
+                                       throttleColumn];
+    PIDStackAxisGroup *group = [[PIDStackAxisGroup alloc] initWithLaneColumns:laneColumns
+                                                                   timeColumn:timeColumn
+                                                                  windowCount:windowCount
+                                                                 windowLength:windowSize
+                                                                         step:step];
+    NSMutableArray<PIDStackData *> *stacks = [NSMutableArray arrayWithCapacity:3];
+    for (NSInteger axis = 0; axis < 3; axis++) {
+        if (!inputColumns[axis]) {
+            [stacks addObject:empty[axis]];
+            continue;
+        }
+        PIDStackData *stack = [[PIDStackData alloc] initWithInputColumn:inputColumns[axis]
+                                                             gyroColumn:gyroColumns[axis]
+                                                         throttleColumn:throttleColumn
+                                                             timeColumn:timeColumn
+                                                            windowCount:windowCount
+                                                           windowLength:windowSize
+                                                                   step:step];
+        stack->_axisGroup = group;
+        stack->_axisIndex = axis;
+        stack->_sampleStart = sampleStart;
+        [stacks addObject:stack];
+    }
+
+    NSLog(@"✅ 三轴堆叠数据创建完成: %ld窗口", (long)windowCount);
+
+    return [stacks copy];
+}
+
+@end
+
+@implementation PIDResponseResult
+
+/**
+ * 数组只在第一次追加时复制为可变数组，之后每批只追加新窗口
+ */
+static NSArray *PIDAppendingArray(NSArray *array, NSArray *batch) {
+    NSMutableArray *mutableArray = [array isKindOfClass:[NSMutableArray class]]
+                                 ? (NSMutableArray *)array : [NSMutableArray arrayWithArray:array ?: @[]];
+    [mutableArray addObjectsFromArray:batch ?: @[]];
+    return mutableArray;
+}
+
+- (void)appendWindowsFromResult:(PIDResponseResult *)batch {
+    NSData *batchMatrix = batch.stepResponseData;
+    if (self.stepResponse.count == 0) {
+        self.stepResponseData = batchMatrix ? [batchMatrix mutableCopy] : nil;
+    } else if (batchMatrix && [self.stepResponseData isKindOfClass:[NSMutableData class]]) {
+        [(NSMutableData *)self.stepResponseData appendData:batchMatrix];
+    } else {
+        self.stepResponseData = nil;
+    }
+
+    self.stepResponse = PIDAppendingArray(self.stepResponse, batch.stepResponse);
+    self.avgTime = PIDAppendingArray(self.avgTime, batch.avgTime);
+    self.avgInput = PIDAppendingArray(self.avgInput, batch.avgInput);
+    self.maxInput = PIDAppendingArray(self.maxInput, batch.maxInput);
+    self.maxThrottle = PIDAppendingArray(self.maxThrottle, batch.maxThrottle);
+    self.prunedWindowCount += batch.prunedWindowCount;
+}
+
+@end
+
+@implementation PIDSpectrumResult
+
+@end
+
+#pragma mark - PIDSpectrumAccumulator Implementation
+
+// 对应Python hist2d() 的油门范围/分箱、hist2d_norm的分母偏置与hist2d_sm的平滑宽度
+static const double kSpectrumThrottleMax = 100.0;
+static const NSInteger kSpectrumThrottleBins = 101;
+static const double kSpectrumThrottleNormBias = 1e-9;
+static const double kSpectrumHeatmapSmoothSigma = 3.0;
+
+/**
+ * 等宽分箱索引，与numpy.histogram/histogram2d一致：
+ * 边界为 linspace(low, high, bins+1)，落在边界上的值归入右侧箱，high归入最后一箱，超范围/NaN返回-1
+ * 先按比例估算，再对照边界修正一格（比例换算的舍入可能让边界上的值落到相邻箱）
+ */
+static NSInteger PIDSpectrumHistogramBin(double value, double low, double high, NSInteger bins) {
+    if (!(value >= low && value <= high)) {
+        return -1;
+    }
+    if (high <= low) {
+        return 0;
+    }
+
+    double width = (high - low) / bins;
+    NSInteger bin = MIN(MAX((NSInteger)((value - low) / (high - low) * bins), 0), bins - 1);
+    if (bin > 0 && value < low + bin * width) {
+        bin--;
+    } else if (bin < bins - 1 && value >= low + (bin + 1) * width) {
+        bin++;
+    }
+    return bin;
+}
+
+@implementation PIDSpectrumAccumulator {
+    NSInteger _frequencyCount;
+    double *_magnitudeSum;      // [频率点] 所有窗口 |Re| 的和
+    double *_grid;              // [油门箱][频率箱] 加权直方图
+    double *_throttleCounts;    // [油门箱] 窗口数
+    NSInteger *_frequencyBinOf; // 频率点 → 频率箱
+    double _frequencyMin;
+    double _frequencyMax;
+}
+
++ (NSUInteger)bytesForFrequencyCount:(NSInteger)frequencyCount {
+    NSUInteger count = (NSUInteger)MAX(frequencyCount, 0);
+    NSUInteger frequencyBins = MAX(count / 4, 1);
+    return count * (sizeof(double) + sizeof(NSInteger)) +
+           kSpectrumThrottleBins * (frequencyBins + 1) * sizeof(double);
+}
+
+- (instancetype)initWithFrequencies:(NSArray<NSNumber *> *)frequencies {
+    self = [super init];
+    if (self) {
+        _frequencies = [frequencies copy] ?: @[];
+        _frequencyCount = (NSInteger)_frequencies.count;
+        _throttleBins = kSpectrumThrottleBins;
+        _frequencyBins = MAX(_frequencyCount / 4, 1);
+        _magnitudeSum = (double *)calloc(MAX(_frequencyCount, 1), sizeof(double));
+        _grid = (double *)calloc(_throttleBins * _frequencyBins, sizeof(double));
+        _throttleCounts = (double *)calloc(_throttleBins, sizeof(double));
+        _frequencyBinOf = (NSInteger *)malloc(MAX(_frequencyCount, 1) * sizeof(NSInteger));
+
+        // histogram2d的频率范围为 [f0, f_last]；每个频率点的箱只需计算一次
+        _frequencyMin = _frequencyCount > 0 ? [_frequencies.firstObject doubleValue] : 0.0;
+        _frequencyMax = _frequencyCount > 0 ? [_frequencies.lastObject doubleValue] : 0.0;
+        for (NSInteger k = 0; k < _frequencyCount; k++) {
+            NSInteger bin = PIDSpectrumHistogramBin([_frequencies[k] doubleValue], _frequencyMin, _frequencyMax, _frequencyBins);
+            _frequencyBinOf[k] = MAX(bin, 0);
+        }
+    }
+    return self;
+}
+
+- (void)dealloc {
+    free(_magnitudeSum);
+    free(_grid);
+    free(_throttleCounts);
+    free(_frequencyBinOf);
+}
+
+- (id)copyWithZone:(NSZone *)zone {
+    PIDSpectrumAccumulator *copy = [[PIDSpectrumAccumulator alloc] initWithFrequencies:_frequencies];
+    [copy addAccumulator:self];
+    return copy;
+}
+
+- (void)addWindowSpectrum:(const double *)spectrum throttle:(double)throttle {
+    if (!spectrum || _frequencyCount == 0) {
+        return;
+    }
+
+    NSInteger throttleBin = PIDSpectrumHistogramBin(throttle, 0.0, kSpectrumThrottleMax, _throttleBins);
+    if (throttleBin < 0) {
+        for (NSInteger k = 0; k < _frequencyCount; k++) {
+            _magnitudeSum[k] += fabs(spectrum[k]);
+        }
+    } else {
+        double *row = _grid + throttleBin * _frequencyBins;
+        for (NSInteger k = 0; k < _frequencyCount; k++) {
+            double magnitude = fabs(spectrum[k]);
+            _magnitudeSum[k] += magnitude;
+            row[_frequencyBinOf[k]] += magnitude;
+        }
+        _throttleCounts[throttleBin] += 1.0;
+    }
+    _windowCount++;
+}
+
+- (BOOL)addAccumulator:(PIDSpectrumAccumulator *)other {
+    if (!other || other->_frequencyCount != _frequencyCount) {
+        return NO;
+    }
+
+    vDSP_vaddD(_magnitudeSum, 1, other->_magnitudeSum, 1, _magnitudeSum, 1, (vDSP_Length)_frequencyCount);
+    vDSP_vaddD(_grid, 1, other->_grid, 1, _grid, 1, (vDSP_Length)(_throttleBins * _frequencyBins));
+    vDSP_vaddD(_throttleCounts, 1, other->_throttleCounts, 1, _throttleCounts, 1, (vDSP_Length)_throttleBins);
+    _windowCount += other->_windowCount;
+    return YES;
+}
+
+- (NSArray<NSNumber *> *)averageSpectrum {
+    if (_windowCount == 0) {
+        return @[];
+    }
+
+    NSMutableArray<NSNumber *> *average = [NSMutableArray arrayWithCapacity:_frequencyCount];
+    for (NSInteger k = 0; k < _frequencyCount; k++) {
+        [average addObject:@(_magnitudeSum[k] / _windowCount)];
+    }
+    return [average copy];
+}
+
+/**
+ * hist2d_norm：每个油门箱除以该箱的窗口数
+ */
+- (void)normalizedHeatmapInto:(double *)heatmap {
+    for (NSInteger t = 0; t < _throttleBins; t++) {
+        double scale = 1.0 / (_throttleCounts[t] + kSpectrumThrottleNormBias);
+        vDSP_vsmulD(_grid + t * _frequencyBins, 1, &scale, heatmap + t * _frequencyBins, 1,
+                    (vDSP_Length)_frequencyBins);
     }
+}
 
-    // 验证数据
-    if (!gyroADCAxis || !axisP) {
-        return stack;
+- (NSArray<NSArray<NSNumber *> *> *)heatmapRowsFromBuffer:(const double *)heatmap {
+    NSMutableArray<NSArray<NSNumber *> *> *rows = [NSMutableArray arrayWithCapacity:_throttleBins];
+    for (NSInteger t = 0; t < _throttleBins; t++) {
+        const double *source = heatmap + t * _frequencyBins;
+        NSMutableArray<NSNumber *> *row = [NSMutableArray arrayWithCapacity:_frequencyBins];
+        for (NSInteger f = 0; f < _frequencyBins; f++) {
+            [row addObject:@(source[f])];
+        }
+        [rows addObject:row];
+    }
+    return rows;
+}
+
+- (NSArray<NSArray<NSNumber *> *> *)throttleHeatmap {
+    double *heatmap = (double *)malloc(_throttleBins * _frequencyBins * sizeof(double));
+    [self normalizedHeatmapInto:heatmap];
+    NSArray<NSArray<NSNumber *> *> *rows = [self heatmapRowsFromBuffer:heatmap];
+    free(heatmap);
+    return rows;
+}
+
+- (NSArray<NSArray<NSNumber *> *> *)smoothedThrottleHeatmap {
+    double *heatmap = (double *)malloc(_throttleBins * _frequencyBins * sizeof(double));
+    [self normalizedHeatmapInto:heatmap];
+    PIDGaussianFilterAxis(heatmap, heatmap, (size_t)_throttleBins, (size_t)_frequencyBins, 0,
+                          kSpectrumHeatmapSmoothSigma, PIDGaussianBoundaryConstant, PIDGaussianMethodDirect);
+    NSArray<NSArray<NSNumber *> *> *rows = [self heatmapRowsFromBuffer:heatmap];
+    free(heatmap);
+    return rows;
+}
+
+- (NSData *)smoothedThrottleHeatmapMatrix {
+    NSInteger cellCount = _throttleBins * _frequencyBins;
+    double *heatmap = (double *)malloc(cellCount * sizeof(double));
+    [self normalizedHeatmapInto:heatmap];
+    PIDGaussianFilterAxis(heatmap, heatmap, (size_t)_throttleBins, (size_t)_frequencyBins, 0,
+                          kSpectrumHeatmapSmoothSigma, PIDGaussianBoundaryConstant, PIDGaussianMethodDirect);
+    NSMutableData *matrix = [NSMutableData dataWithLength:cellCount * sizeof(float)];
+    vDSP_vdpsp(heatmap, 1, (float *)matrix.mutableBytes, 1, (vDSP_Length)cellCount);
+    free(heatmap);
+    return matrix;
+}
+
+- (NSArray<NSNumber *> *)heatmapFrequencies {
+    NSMutableArray<NSNumber *> *centers = [NSMutableArray arrayWithCapacity:_frequencyBins];
+    double width = (_frequencyMax - _frequencyMin) / _frequencyBins;
+    for (NSInteger f = 0; f < _frequencyBins; f++) {
+        [centers addObject:@(_frequencyMin + (f + 0.5) * width)];
+    }
+    return [centers copy];
+}
+
+- (NSArray<NSNumber *> *)throttleAxis {
+    NSMutableArray<NSNumber *> *centers = [NSMutableArray arrayWithCapacity:_throttleBins];
+    double width = kSpectrumThrottleMax / _throttleBins;
+    for (NSInteger t = 0; t < _throttleBins; t++) {
+        [centers addObject:@((t + 0.5) * width)];
+    }
+    return [centers copy];
+}
+
+@end
+
+#pragma mark - PIDResponseHistogram Implementation
+
+// scipy gaussian_filter1d(sigma=7, truncate=4.0) 的卷积核半径
+static const double kResponseSmoothSigma = 7.0;
+static const NSInteger kResponseSmoothRadius = 28;   // ceil(4.0 * sigma)
+
+/**
+ * 归一化高斯核（长度 2*radius+1），只计算一次
+ */
+static const float *PIDResponseSmoothKernel(void) {
+    static float kernel[2 * kResponseSmoothRadius + 1];
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        double sum = 0.0;
+        for (NSInteger dv = -kResponseSmoothRadius; dv <= kResponseSmoothRadius; dv++) {
+            double g = exp(-(dv * dv) / (2.0 * kResponseSmoothSigma * kResponseSmoothSigma));
+            kernel[dv + kResponseSmoothRadius] = (float)g;
+            sum += g;
+        }
+        for (NSInteger i = 0; i < 2 * kResponseSmoothRadius + 1; i++) {
+            kernel[i] /= (float)sum;
+        }
+    });
+    return kernel;
+}
+
+/**
+ * 响应点 → 时间箱（-1表示超出范围）
+ * 时间轴固定为 [0, 0.5] 秒的linspace，与buildHistogram2D相同的numpy规则：上限扩大epsilon，按比例取整
+ * @param timeBins 时间箱数量（等于responseLength时每个响应点一个箱）
+ */
+static void PIDResponseTimeBins(NSInteger responseLength, NSInteger timeBins, NSInteger *timeBinOf) {
+    double epsilon = 1e-9;
+    double responseDuration = 0.5;
+    NSInteger denom = responseLength > 1 ? responseLength - 1 : 1;
+    double timeMin = 0.0;
+    double timeMax = responseDuration * (responseLength - 1) / denom;
+    double timeMaxEffective = timeMax + epsilon * (timeMax - timeMin);
+    double timeSpan = timeMaxEffective - timeMin;
+    if (timeSpan <= 0) timeSpan = 1.0;
+
+    for (NSInteger i = 0; i < responseLength; i++) {
+        double t = responseDuration * i / denom;
+        if (t < timeMin || t >= timeMaxEffective) {
+            timeBinOf[i] = -1;
+            continue;
+        }
+        double tRatio = MIN(MAX((t - timeMin) / timeSpan, 0.0), 1.0);
+        NSInteger tBin = (NSInteger)floor(tRatio * timeBins);
+        timeBinOf[i] = MIN(MAX(tBin, 0), timeBins - 1);
+    }
+}
+
+/**
+ * 响应直方图的值轴：范围 [valueMin, valueMaxEffective)，上限扩大epsilon（与buildHistogram2D相同）
+ */
+typedef struct {
+    double valueMin;
+    double valueMax;
+    double valueMaxEffective;
+    double span;
+    NSInteger vertBins;
+    NSInteger columnStride;     // 每个时间箱列的长度：保护带 + vertBins + 保护带
+} PIDResponseValueAxis;
+
+static PIDResponseValueAxis PIDResponseValueAxisMake(NSArray<NSNumber *> *vertRange, NSInteger vertBins) {
+    PIDResponseValueAxis axis;
+    double epsilon = 1e-9;
+    double yMin = [vertRange[0] doubleValue];
+    double yMax = [vertRange[1] doubleValue];
+    axis.valueMin = yMin;
+    axis.valueMax = yMax;
+    axis.valueMaxEffective = yMax + epsilon * (yMax - yMin);
+    axis.span = axis.valueMaxEffective - yMin;
+    if (axis.span <= 0) axis.span = 1.0;
+    axis.vertBins = MAX(vertBins, 1);
+    axis.columnStride = axis.vertBins + 2 * kResponseSmoothRadius;
+    return axis;
+}
+
+/**
+ * 一个窗口落入的直方图单元：cells[k] = 时间箱 * columnStride + 保护带 + 值箱
+ * 值箱坐标按 numpy 的运算顺序向量化计算：(v - min) / span * bins；超出时间/值范围的点不计入
+ * @param binScratch 暂存（responseLength个double）
+ * @return 单元个数
+ */
+static NSInteger PIDResponseWindowCells(const double *values, NSInteger responseLength, const NSInteger *timeBinOf,
+                                        const PIDResponseValueAxis *axis, double *binScratch, uint32_t *cells) {
+    vDSP_Length n = (vDSP_Length)responseLength;
+    double negMin = -axis->valueMin;
+    double span = axis->span;
+    double bins = (double)axis->vertBins;
+    vDSP_vsaddD(values, 1, &negMin, binScratch, 1, n);
+    vDSP_vsdivD(binScratch, 1, &span, binScratch, 1, n);
+    vDSP_vsmulD(binScratch, 1, &bins, binScratch, 1, n);
+
+    // 时间箱已预先计算，单元索引直接指向时间箱列中的位置
+    NSInteger count = 0;
+    NSInteger lastBin = axis->vertBins - 1;
+    for (NSInteger i = 0; i < responseLength; i++) {
+        NSInteger tBin = timeBinOf[i];
+        double v = values[i];
+        if (tBin < 0 || v < axis->valueMin || v >= axis->valueMaxEffective) {
+            continue;  // numpy histogram2d 忽略超出range的值
+        }
+
+        NSInteger vBin = (NSInteger)binScratch[i];
+        vBin = vBin < 0 ? 0 : (vBin > lastBin ? lastBin : vBin);
+        cells[count++] = (uint32_t)(tBin * axis->columnStride + kResponseSmoothRadius + vBin);
+    }
+    return count;
+}
+
+/**
+ * resp_y = np.linspace(vertrange[0], vertrange[-1], vertbins)
+ */
+static void PIDResponseValueCenters(const PIDResponseValueAxis *axis, double *respY) {
+    NSInteger vertBins = axis->vertBins;
+    for (NSInteger v = 0; v < vertBins; v++) {
+        respY[v] = vertBins > 1 ? axis->valueMin + (axis->valueMax - axis->valueMin) * v / (vertBins - 1) : axis->valueMin;
+    }
+}
+
+/**
+ * 单个时间箱的众数加权平均：高斯平滑(axis=0, sigma=7, mode='constant') → 列最大值归一化 → 平方权重加权平均
+ * 列是一段连续内存，预先计算的高斯核直接用vDSP_conv卷积；
+ * 只有已占用值箱 [bandLow, bandHigh] 两侧各一个核半径内的结果可能非零，其余部分跳过
+ * @param column 时间箱列的起点（含前保护带）
+ * @param smoothed 暂存（vertBins个float）
+ * @return 加权平均值；列为空时为0
+ */
+static double PIDResponseColumnModeAverage(const float *column, NSInteger bandLow, NSInteger bandHigh,
+                                           const PIDResponseValueAxis *axis, const double *respY, float *smoothed) {
+    if (bandHigh < 0) {
+        return 0.0;
+    }
+    NSInteger low = MAX(bandLow - kResponseSmoothRadius, 0);
+    NSInteger high = MIN(bandHigh + kResponseSmoothRadius, axis->vertBins - 1);
+    vDSP_Length count = (vDSP_Length)(high - low + 1);
+
+    // smoothed[v] = Σ hist[v + dv] · kernel[dv]，保护带提供 mode='constant' 的零填充
+    vDSP_conv(column + low, 1, PIDResponseSmoothKernel(), 1, smoothed, 1, count,
+              (vDSP_Length)(2 * kResponseSmoothRadius + 1));
+
+    // Python: hist2d_sm /= np.max(hist2d_sm, 0)
+    float maxVal = 0.0f;
+    vDSP_maxv(smoothed, 1, &maxVal, count);
+    if (maxVal > 1e-6f) {
+        float invMax = 1.0f / maxVal;
+        vDSP_vsmul(smoothed, 1, &invMax, smoothed, 1, count);
+    }
+
+    // Python: np.average(pixelpos, 0, weights=hist2d_sm * hist2d_sm)
+    double weightedSum = 0.0;
+    double weightSum = 0.0;
+    for (vDSP_Length k = 0; k < count; k++) {
+        float histVal = smoothed[k];
+        double w = histVal * histVal;
+        weightedSum += respY[low + k] * w;
+        weightSum += w;
+    }
+    return weightSum > 1e-9 ? weightedSum / weightSum : 0.0;
+}
+
+/**
+ * 平滑列平方和的两两系数表（增量众数平均用）
+ * 平滑列 s[v] = Σ_a h[a]·k[a-v]，因此
+ *   Σ_v s[v]²   = Σ_{a,b} h[a]·h[b]·Σ_v k[a-v]·k[b-v]
+ *   Σ_v v·s[v]² = Σ_{a,b} h[a]·h[b]·Σ_v v·k[a-v]·k[b-v]
+ * 对偏移 d = b-a 和 u = v-a 做前缀和：q0[d][i] = Σ_{u<i-R} k[u]·k[u-d]，q1[d][i] = Σ_{u<i-R} u·k[u]·k[u-d]，
+ * 值轴两端的截断（mode='constant'只输出 [0, vertBins) 内的点）只需各查表两次
+ */
+typedef struct {
+    double q0[4 * kResponseSmoothRadius + 1][2 * kResponseSmoothRadius + 2];
+    double q1[4 * kResponseSmoothRadius + 1][2 * kResponseSmoothRadius + 2];
+} PIDResponseModePairTable;
+
+static const PIDResponseModePairTable *PIDResponseModePairs(void) {
+    static PIDResponseModePairTable table;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        // 系数取自单精度高斯核本身，与 PIDResponseColumnModeAverage 的卷积权重相同
+        const float *kernel = PIDResponseSmoothKernel();
+        NSInteger radius = kResponseSmoothRadius;
+        for (NSInteger d = -2 * radius; d <= 2 * radius; d++) {
+            double *q0 = table.q0[d + 2 * radius];
+            double *q1 = table.q1[d + 2 * radius];
+            q0[0] = 0.0;
+            q1[0] = 0.0;
+            for (NSInteger u = -radius; u <= radius; u++) {
+                NSInteger shifted = u - d;
+                double term = labs(shifted) <= radius
+                            ? (double)kernel[u + radius] * (double)kernel[shifted + radius] : 0.0;
+                q0[u + radius + 1] = q0[u + radius] + term;
+                q1[u + radius + 1] = q1[u + radius] + u * term;
+            }
+        }
+    });
+    return &table;
+}
+
+/**
+ * 值箱a与b = a+d 的两两系数：Σ_v k[a-v]·k[b-v] 与 Σ_v v·k[a-v]·k[b-v]，v限制在 [0, vertBins)
+ */
+static inline void PIDResponseModePairWeights(const PIDResponseModePairTable *table, NSInteger a, NSInteger d,
+                                              NSInteger vertBins, double *g0, double *g1) {
+    NSInteger radius = kResponseSmoothRadius;
+    NSInteger uLow = MAX(MAX(d, 0) - radius, -a);
+    NSInteger uHigh = MIN(MIN(d, 0) + radius, vertBins - 1 - a);
+    if (uLow > uHigh) {
+        *g0 = 0.0;
+        *g1 = 0.0;
+        return;
+    }
+    const double *q0 = table->q0[d + 2 * radius];
+    const double *q1 = table->q1[d + 2 * radius];
+    double sum0 = q0[uHigh + radius + 1] - q0[uLow + radius];
+    *g0 = sum0;
+    *g1 = a * sum0 + (q1[uHigh + radius + 1] - q1[uLow + radius]);
+}
+
+@interface PIDResponseHistogram ()
+
+/**
+ * 开始维护每个时间箱平滑列的 Σs² 与 Σv·s²（必须在累加任何窗口之前调用）
+ * 之后每加入/扣除一个单元只更新所在列的两个和（与两侧2个核半径内的已占用值箱相关），
+ * trackedModeAverage 用两个和之比直接得到众数加权平均，不再对整列重新卷积
+ */
+- (void)enableModeSums;
+
+/**
+ * 由维护的和计算众数加权平均（与weightedModeAverage相同，差异为单精度卷积的舍入）
+ * 没有调用enableModeSums时等同于weightedModeAverage
+ */
+- (NSArray<NSNumber *> *)trackedModeAverage;
+
+@end
+
+@implementation PIDResponseHistogram {
+    // 按时间箱存储的列：[timeBins][kResponseSmoothRadius | vertBins | kResponseSmoothRadius]
+    // 两端的零保护带让高斯平滑可以直接对列做卷积，不需要转置或复制
+    float *_hist;
+    NSInteger _columnStride;
+    NSInteger *_timeBinOf;  // 响应点 → 时间箱（-1表示超出范围）
+    NSInteger *_bandLow;    // 每个时间箱已占用的最低/最高值箱（平滑只计算这一段）
+    NSInteger *_bandHigh;
+    double *_binScratch;    // 一个窗口的值箱坐标
+    uint32_t *_cellScratch; // 一个窗口落入的单元
+    PIDResponseValueAxis _valueAxis;
+
+    // 增量众数平均（enableModeSums后）：每列的 Σs²、Σv·s² 与列内权重和
+    double *_modeSquares;
+    double *_modeMoments;
+    double *_columnWeights;
+}
+
++ (NSUInteger)bytesForResponseLength:(NSInteger)responseLength vertBins:(NSInteger)vertBins {
+    NSUInteger columns = (NSUInteger)MAX(responseLength, 0);
+    NSUInteger stride = (NSUInteger)MAX(vertBins, 0) + 2 * kResponseSmoothRadius;
+    return columns * stride * sizeof(float) +
+           columns * (3 * sizeof(NSInteger) + sizeof(double) + sizeof(uint32_t));
+}
+
+- (instancetype)initWithResponseLength:(NSInteger)responseLength
+                            vertRange:(NSArray<NSNumber *> *)vertRange
+                             vertBins:(NSInteger)vertBins {
+    self = [super init];
+    if (self) {
+        _responseLength = MAX(responseLength, 0);
+        _valueAxis = PIDResponseValueAxisMake(vertRange, vertBins);
+        _vertBins = _valueAxis.vertBins;
+        _columnStride = _valueAxis.columnStride;
+        _hist = (float *)calloc(MAX(_responseLength * _columnStride, 1), sizeof(float));
+        _timeBinOf = (NSInteger *)malloc(MAX(_responseLength, 1) * sizeof(NSInteger));
+        _bandLow = (NSInteger *)malloc(MAX(_responseLength, 1) * sizeof(NSInteger));
+        _bandHigh = (NSInteger *)malloc(MAX(_responseLength, 1) * sizeof(NSInteger));
+        _binScratch = (double *)malloc(MAX(_responseLength, 1) * sizeof(double));
+        _cellScratch = (uint32_t *)malloc(MAX(_responseLength, 1) * sizeof(uint32_t));
+        for (NSInteger t = 0; t < _responseLength; t++) {
+            _bandLow[t] = _vertBins;
+            _bandHigh[t] = -1;
+        }
+
+        // 每个响应点一个时间箱，时间箱只需计算一次
+        PIDResponseTimeBins(_responseLength, _responseLength, _timeBinOf);
+    }
+    return self;
+}
+
+- (void)dealloc {
+    free(_hist);
+    free(_timeBinOf);
+    free(_bandLow);
+    free(_bandHigh);
+    free(_binScratch);
+    free(_cellScratch);
+    free(_modeSquares);
+    free(_modeMoments);
+    free(_columnWeights);
+}
+
+- (void)enableModeSums {
+    if (_modeSquares || _responseLength == 0) {
+        return;
+    }
+    _modeSquares = (double *)calloc(_responseLength, sizeof(double));
+    _modeMoments = (double *)calloc(_responseLength, sizeof(double));
+    _columnWeights = (double *)calloc(_responseLength, sizeof(double));
+}
+
+- (BOOL)addWindowResponse:(NSArray<NSNumber *> *)windowResp weight:(double)weight {
+    if (!windowResp || windowResp.count != _responseLength || _responseLength == 0) {
+        return NO;
+    }
+
+    // 拆箱到暂存区的连续缓冲区后走与矩阵相同的散射路径
+    PIDScratchArena *arena = PIDScratchArenaCurrent();
+    PIDScratchMark mark = PIDScratchArenaMark(arena);
+    double *values = (double *)PIDScratchArenaAlloc(arena, _responseLength * sizeof(double));
+    if (!values) {
+        return NO;
+    }
+    NSInteger index = 0;
+    for (NSNumber *num in windowResp) {
+        values[index++] = [num doubleValue];
+    }
+    BOOL added = [self addWindowValues:values weight:weight];
+    PIDScratchArenaReset(arena, mark);
+    return added;
+}
+
+- (BOOL)addWindowValues:(const double *)values weight:(double)weight {
+    if (!values || _responseLength == 0) {
+        return NO;
+    }
+
+    NSInteger count = [self cellsForWindowValues:values cells:_cellScratch];
+    [self addWindowCells:_cellScratch count:count weight:weight];
+    return YES;
+}
+
+- (NSInteger)cellsForWindowValues:(const double *)values cells:(uint32_t *)cells {
+    if (!values || !cells || _responseLength == 0) {
+        return 0;
+    }
+
+    return PIDResponseWindowCells(values, _responseLength, _timeBinOf, &_valueAxis, _binScratch, cells);
+}
+
+- (void)addWindowCells:(const uint32_t *)cells count:(NSInteger)count weight:(double)weight {
+    // 直接散射到时间箱的列中
+    float w = (float)weight;
+    for (NSInteger i = 0; i < count; i++) {
+        uint32_t cell = cells[i];
+        NSInteger tBin = (NSInteger)(cell / (uint32_t)_columnStride);
+        NSInteger vBin = (NSInteger)cell - tBin * _columnStride - kResponseSmoothRadius;
+        if (_modeSquares) {
+            [self updateModeSumsForColumn:tBin valueBin:vBin weight:w];
+        }
+        _hist[cell] += w;
+
+        // 占用范围只扩不缩：扣除窗口后范围内多出的零不影响结果
+        if (vBin < _bandLow[tBin]) _bandLow[tBin] = vBin;
+        if (vBin > _bandHigh[tBin]) _bandHigh[tBin] = vBin;
+    }
+
+    _windowCount += weight < 0 ? -1 : 1;
+}
+
+/**
+ * h[c] 增加w之前更新列的两个和：Δ = w·(2·Σ_b h[b]·g(c,b) + w·g(c,c))，只有 |b-c| ≤ 2R 的值箱有关
+ * 列权重归零时两个和精确置零，加减往复不会累积舍入
+ */
+- (void)updateModeSumsForColumn:(NSInteger)tBin valueBin:(NSInteger)vBin weight:(float)w {
+    const PIDResponseModePairTable *table = PIDResponseModePairs();
+    const float *column = _hist + tBin * _columnStride + kResponseSmoothRadius;
+    NSInteger low = MAX(vBin - 2 * kResponseSmoothRadius, 0);
+    NSInteger high = MIN(vBin + 2 * kResponseSmoothRadius, _vertBins - 1);
+
+    double dot0 = 0.0;
+    double dot1 = 0.0;
+    double g0 = 0.0;
+    double g1 = 0.0;
+    for (NSInteger b = low; b <= high; b++) {
+        float count = column[b];
+        if (count == 0.0f) {
+            continue;
+        }
+        PIDResponseModePairWeights(table, vBin, b - vBin, _vertBins, &g0, &g1);
+        dot0 += count * g0;
+        dot1 += count * g1;
+    }
+    PIDResponseModePairWeights(table, vBin, 0, _vertBins, &g0, &g1);
+
+    _columnWeights[tBin] += w;
+    if (_columnWeights[tBin] == 0.0) {
+        _modeSquares[tBin] = 0.0;
+        _modeMoments[tBin] = 0.0;
+    } else {
+        _modeSquares[tBin] += w * (2.0 * dot0 + w * g0);
+        _modeMoments[tBin] += w * (2.0 * dot1 + w * g1);
+    }
+}
+
+- (NSArray<NSNumber *> *)trackedModeAverage {
+    if (!_modeSquares) {
+        return [self weightedModeAverage];
+    }
+
+    // resp_y[v] = min + step·v：加权平均 = min + step · Σv·s² / Σs²（列最大值归一化在比值中抵消）
+    double valueStep = _vertBins > 1 ? (_valueAxis.valueMax - _valueAxis.valueMin) / (_vertBins - 1) : 0.0;
+    NSMutableArray<NSNumber *> *avgResponse = [NSMutableArray arrayWithCapacity:_responseLength];
+    double baseValue = 0.0;
+    for (NSInteger t = 0; t < _responseLength; t++) {
+        double avgVal = _columnWeights[t] > 0.0 && _modeSquares[t] > 0.0
+                      ? _valueAxis.valueMin + valueStep * _modeMoments[t] / _modeSquares[t] : 0.0;
+        if (t == 0) {
+            baseValue = avgVal;
+        }
+        [avgResponse addObject:@(avgVal - baseValue)];
+    }
+    return [avgResponse copy];
+}
+
+/**
+ * 逐列处理：每个时间箱独立做高斯平滑、归一化和平方加权平均（见PIDResponseColumnModeAverage）
+ */
+- (NSArray<NSNumber *> *)weightedModeAverage {
+    NSInteger timeBins = _responseLength;
+    NSInteger vertBins = _vertBins;
+    if (timeBins == 0) {
+        return @[];
+    }
+
+    PIDScratchArena *arena = PIDScratchArenaCurrent();
+    PIDScratchMark mark = PIDScratchArenaMark(arena);
+    double *respY = (double *)PIDScratchArenaAlloc(arena, vertBins * sizeof(double));
+    float *column = (float *)PIDScratchArenaAlloc(arena, vertBins * sizeof(float));
+    if (!respY || !column) {
+        PIDScratchArenaReset(arena, mark);
+        return @[];
+    }
+    PIDResponseValueCenters(&_valueAxis, respY);
+
+    NSMutableArray<NSNumber *> *avgResponse = [NSMutableArray arrayWithCapacity:timeBins];
+    double baseValue = 0.0;
+
+    for (NSInteger t = 0; t < timeBins; t++) {
+        double avgVal = PIDResponseColumnModeAverage(_hist + t * _columnStride, _bandLow[t], _bandHigh[t],
+                                                     &_valueAxis, respY, column);
+
+        // 阶跃响应从0开始：减去起点
+        if (t == 0) {
+            baseValue = avgVal;
+        }
+        [avgResponse addObject:@(avgVal - baseValue)];
+    }
+
+    PIDScratchArenaReset(arena, mark);
+
+    return [avgResponse copy];
+}
+
+@end
+
+#pragma mark - PIDThrottleResponseHistogram Implementation
+
+@implementation PIDThrottleResponseHistogram {
+    // [throttleBins][timeBins][保护带 | vertBins | 保护带]，每个油门箱的布局与PIDResponseHistogram相同
+    float *_hist;
+    NSInteger *_timeBinOf;      // 响应点 → 时间箱（-1表示超出范围）
+    NSInteger *_bandLow;        // [throttleBins][timeBins] 已占用的最低/最高值箱
+    NSInteger *_bandHigh;
+    NSInteger *_binWindowCounts;// [throttleBins]
+    PIDResponseValueAxis _valueAxis;
+}
+
++ (NSUInteger)bytesForThrottleBins:(NSInteger)throttleBins
+                          timeBins:(NSInteger)timeBins
+                          vertBins:(NSInteger)vertBins {
+    NSUInteger columns = (NSUInteger)MAX(throttleBins, 0) * (NSUInteger)MAX(timeBins, 0);
+    NSUInteger stride = (NSUInteger)MAX(vertBins, 0) + 2 * kResponseSmoothRadius;
+    return columns * (stride * sizeof(float) + 2 * sizeof(NSInteger));
+}
+
+- (instancetype)initWithThrottleBins:(NSInteger)throttleBins
+                            timeBins:(NSInteger)timeBins
+                      responseLength:(NSInteger)responseLength
+                           vertRange:(NSArray<NSNumber *> *)vertRange
+                            vertBins:(NSInteger)vertBins {
+    self = [super init];
+    if (self) {
+        _throttleBins = MAX(throttleBins, 1);
+        _responseLength = MAX(responseLength, 0);
+        _timeBins = MIN(MAX(timeBins, 1), MAX(_responseLength, 1));
+        _valueAxis = PIDResponseValueAxisMake(vertRange, vertBins);
+        _vertBins = _valueAxis.vertBins;
+
+        NSInteger columns = _throttleBins * _timeBins;
+        _hist = (float *)calloc(columns * _valueAxis.columnStride, sizeof(float));
+        _timeBinOf = (NSInteger *)malloc(MAX(_responseLength, 1) * sizeof(NSInteger));
+        _bandLow = (NSInteger *)malloc(columns * sizeof(NSInteger));
+        _bandHigh = (NSInteger *)malloc(columns * sizeof(NSInteger));
+        _binWindowCounts = (NSInteger *)calloc(_throttleBins, sizeof(NSInteger));
+        for (NSInteger c = 0; c < columns; c++) {
+            _bandLow[c] = _vertBins;
+            _bandHigh[c] = -1;
+        }
+        PIDResponseTimeBins(_responseLength, _timeBins, _timeBinOf);
+    }
+    return self;
+}
+
+- (void)dealloc {
+    free(_hist);
+    free(_timeBinOf);
+    free(_bandLow);
+    free(_bandHigh);
+    free(_binWindowCounts);
+}
+
+- (void)addResponseMatrix:(const double *)matrix
+              windowCount:(NSInteger)windowCount
+                 throttle:(const double *)throttle
+                  weights:(const double *)weights {
+    if (!matrix || !throttle || windowCount <= 0 || _responseLength == 0) {
+        return;
+    }
+
+    // 窗口按油门箱分桶（计数排序，桶内保持窗口顺序），只读油门和权重
+    NSInteger throttleBins = _throttleBins;
+    NSMutableData *binData NS_VALID_UNTIL_END_OF_SCOPE = [NSMutableData dataWithLength:windowCount * sizeof(NSInteger)];
+    NSMutableData *orderData NS_VALID_UNTIL_END_OF_SCOPE = [NSMutableData dataWithLength:windowCount * sizeof(NSInteger)];
+    NSMutableData *offsetData NS_VALID_UNTIL_END_OF_SCOPE = [NSMutableData dataWithLength:(throttleBins + 1) * sizeof(NSInteger)];
+    NSInteger *binOf = binData.mutableBytes;
+    NSInteger *order = orderData.mutableBytes;
+    NSInteger *offsets = offsetData.mutableBytes;
+    for (NSInteger w = 0; w < windowCount; w++) {
+        double weight = weights ? weights[w] : 1.0;
+        binOf[w] = weight > 0 ? PIDSpectrumHistogramBin(throttle[w], 0.0, 100.0, throttleBins) : -1;
+        if (binOf[w] >= 0) {
+            offsets[binOf[w] + 1]++;
+        }
+    }
+    for (NSInteger b = 0; b < throttleBins; b++) {
+        offsets[b + 1] += offsets[b];
+    }
+    NSMutableData *cursorData NS_VALID_UNTIL_END_OF_SCOPE = [NSMutableData dataWithBytes:offsets length:throttleBins * sizeof(NSInteger)];
+    NSInteger *cursor = cursorData.mutableBytes;
+    for (NSInteger w = 0; w < windowCount; w++) {
+        if (binOf[w] >= 0) {
+            order[cursor[binOf[w]]++] = w;
+        }
+    }
+
+    // 各油门箱并行散射自己的窗口：每行响应只读一次，箱内按窗口顺序累加（与逐窗口串行累加的结果一致）
+    NSInteger responseLength = _responseLength;
+    NSInteger timeBins = _timeBins;
+    const NSInteger *timeBinOf = _timeBinOf;
+    PIDResponseValueAxis valueAxis = _valueAxis;
+    float *hist = _hist;
+    NSInteger *bandLow = _bandLow;
+    NSInteger *bandHigh = _bandHigh;
+    PIDParallelForEach((size_t)throttleBins, ^(size_t b) {
+        NSInteger first = offsets[b];
+        NSInteger last = offsets[b + 1];
+        if (first == last) {
+            return;
+        }
+        PIDScratchArena *arena = PIDScratchArenaCurrent();
+        PIDScratchMark mark = PIDScratchArenaMark(arena);
+        double *binScratch = (double *)PIDScratchArenaAlloc(arena, responseLength * sizeof(double));
+        uint32_t *cells = (uint32_t *)PIDScratchArenaAlloc(arena, responseLength * sizeof(uint32_t));
+        float *binHist = hist + (NSInteger)b * timeBins * valueAxis.columnStride;
+        NSInteger *binLow = bandLow + (NSInteger)b * timeBins;
+        NSInteger *binHigh = bandHigh + (NSInteger)b * timeBins;
+
+        for (NSInteger k = first; k < last && binScratch && cells; k++) {
+            NSInteger w = order[k];
+            float weight = weights ? (float)weights[w] : 1.0f;
+            NSInteger count = PIDResponseWindowCells(matrix + w * responseLength, responseLength, timeBinOf,
+                                                     &valueAxis, binScratch, cells);
+            for (NSInteger i = 0; i < count; i++) {
+                uint32_t cell = cells[i];
+                binHist[cell] += weight;
+
+                NSInteger tBin = (NSInteger)(cell / (uint32_t)valueAxis.columnStride);
+                NSInteger vBin = (NSInteger)cell - tBin * valueAxis.columnStride - kResponseSmoothRadius;
+                if (vBin < binLow[tBin]) binLow[tBin] = vBin;
+                if (vBin > binHigh[tBin]) binHigh[tBin] = vBin;
+            }
+        }
+        PIDScratchArenaReset(arena, mark);
+    });
+
+    for (NSInteger b = 0; b < throttleBins; b++) {
+        _binWindowCounts[b] += offsets[b + 1] - offsets[b];
+        _windowCount += offsets[b + 1] - offsets[b];
+    }
+}
+
+- (NSArray<NSNumber *> *)windowCounts {
+    NSMutableArray<NSNumber *> *counts = [NSMutableArray arrayWithCapacity:_throttleBins];
+    for (NSInteger b = 0; b < _throttleBins; b++) {
+        [counts addObject:@(_binWindowCounts[b])];
+    }
+    return [counts copy];
+}
+
+- (NSArray<NSArray<NSNumber *> *> *)responseHeatmap {
+    NSInteger throttleBins = _throttleBins;
+    NSInteger timeBins = _timeBins;
+    NSInteger vertBins = _vertBins;
+    if (_responseLength == 0) {
+        return @[];
+    }
+
+    // 所有油门箱的平滑与众数提取成批并行：每个油门箱的列各自独立，结果写入自己的行
+    NSMutableData *heatmapData NS_VALID_UNTIL_END_OF_SCOPE = [NSMutableData dataWithLength:throttleBins * timeBins * sizeof(double)];
+    NSMutableData *respYData NS_VALID_UNTIL_END_OF_SCOPE = [NSMutableData dataWithLength:vertBins * sizeof(double)];
+    double *heatmap = heatmapData.mutableBytes;
+    double *respY = respYData.mutableBytes;
+    PIDResponseValueAxis valueAxis = _valueAxis;
+    PIDResponseValueCenters(&valueAxis, respY);
+    const float *hist = _hist;
+    const NSInteger *bandLow = _bandLow;
+    const NSInteger *bandHigh = _bandHigh;
+    const NSInteger *binWindowCounts = _binWindowCounts;
+
+    PIDParallelForEach((size_t)throttleBins, ^(size_t b) {
+        if (binWindowCounts[b] == 0) {
+            return;
+        }
+        PIDScratchArena *arena = PIDScratchArenaCurrent();
+        PIDScratchMark mark = PIDScratchArenaMark(arena);
+        float *column = (float *)PIDScratchArenaAlloc(arena, vertBins * sizeof(float));
+        double *row = heatmap + (NSInteger)b * timeBins;
+        for (NSInteger t = 0; t < timeBins && column; t++) {
+            NSInteger c = (NSInteger)b * timeBins + t;
+            row[t] = PIDResponseColumnModeAverage(hist + c * valueAxis.columnStride, bandLow[c], bandHigh[c],
+                                                  &valueAxis, respY, column);
+        }
+        // 阶跃响应从0开始：减去起点
+        double baseValue = row[0];
+        for (NSInteger t = 0; t < timeBins; t++) {
+            row[t] -= baseValue;
+        }
+        PIDScratchArenaReset(arena, mark);
+    });
+
+    NSMutableArray<NSArray<NSNumber *> *> *rows = [NSMutableArray arrayWithCapacity:throttleBins];
+    for (NSInteger b = 0; b < throttleBins; b++) {
+        NSMutableArray<NSNumber *> *row = [NSMutableArray arrayWithCapacity:timeBins];
+        for (NSInteger t = 0; t < timeBins; t++) {
+            [row addObject:@(heatmap[b * timeBins + t])];
+        }
+        [rows addObject:row];
+    }
+    return rows;
+}
+
+- (NSArray<NSNumber *> *)throttleAxis {
+    NSMutableArray<NSNumber *> *centers = [NSMutableArray arrayWithCapacity:_throttleBins];
+    double width = 100.0 / _throttleBins;
+    for (NSInteger b = 0; b < _throttleBins; b++) {
+        [centers addObject:@((b + 0.5) * width)];
+    }
+    return [centers copy];
+}
+
+- (NSArray<NSNumber *> *)timeAxis {
+    NSMutableArray<NSNumber *> *centers = [NSMutableArray arrayWithCapacity:_timeBins];
+    double width = 0.5 / _timeBins;
+    for (NSInteger t = 0; t < _timeBins; t++) {
+        [centers addObject:@((t + 0.5) * width)];
+    }
+    return [centers copy];
+}
+
+@end
+
+#pragma mark - PIDResponseCurves Implementation
+
+@implementation PIDResponseCurves
+
+@end
+
+#pragma mark - PIDResponseParameters Implementation
+
+@implementation PIDResponseParameters
+
++ (instancetype)parametersWithCutFreq:(double)cutFreq
+                       responseLength:(NSInteger)responseLength
+                   highInputThreshold:(double)highInputThreshold {
+    PIDResponseParameters *parameters = [[self alloc] init];
+    parameters.cutFreq = cutFreq;
+    parameters.responseLength = responseLength;
+    parameters.highInputThreshold = highInputThreshold;
+    return parameters;
+}
+
+- (id)copyWithZone:(NSZone *)zone {
+    return [[self class] parametersWithCutFreq:self.cutFreq
+                                responseLength:self.responseLength
+                            highInputThreshold:self.highInputThreshold];
+}
+
+@end
+
+#pragma mark - PIDResponseCurveBuilder Implementation
+
+@interface PIDResponseCurveBuilder ()
+
+@property (nonatomic, assign) NSInteger responseLength;
+
+// 第一遍：参考响应直方图
+@property (nonatomic, strong, nullable) PIDResponseHistogram *initialHistogram;
+
+// 第二遍：低/高输入直方图
+@property (nonatomic, strong, nullable) PIDResponseHistogram *lowHistogram;
+@property (nonatomic, strong, nullable) PIDResponseHistogram *highHistogram;
+
+// 参考响应 (resp_low初值)
+@property (nonatomic, copy, nullable) NSArray<NSNumber *> *referenceResponse;
+@property (nonatomic, strong, nullable) NSData *referenceValues;
+
+// 窗口统计：max_in > 20 / max_in > 500 / 20 < max_in ≤ 500
+@property (nonatomic, assign) NSInteger activeCount;
+@property (nonatomic, assign) NSInteger highInputCount;
+@property (nonatomic, assign) NSInteger lowInputCount;
+
+@property (nonatomic, assign) BOOL lowEnabled;
+@property (nonatomic, assign) BOOL highEnabled;
+
++ (NSArray<NSNumber *> *)responseVertRange;
++ (NSArray<NSNumber *> *)zeroResponseWithLength:(NSInteger)length;
+
+@end
+
+@implementation PIDResponseCurveBuilder
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        _highInputThreshold = kHighInputThreshold;
+    }
+    return self;
+}
+
++ (NSUInteger)peakBytesForResponseLength:(NSInteger)responseLength {
+    return 2 * [PIDResponseHistogram bytesForResponseLength:responseLength vertBins:kResponseVertBins];
+}
+
++ (NSArray<NSNumber *> *)responseVertRange {
+    return @[@(kResponseVertMin), @(kResponseVertMax)];
+}
+
++ (NSArray<NSNumber *> *)zeroResponseWithLength:(NSInteger)length {
+    NSMutableArray<NSNumber *> *zeros = [NSMutableArray arrayWithCapacity:length];
+    for (NSInteger i = 0; i < length; i++) {
+        [zeros addObject:@0.0];
+    }
+    return [zeros copy];
+}
+
+/**
+ * NSArray窗口拆箱为连续内存
+ */
++ (NSData *)valuesFromWindow:(NSArray<NSNumber *> *)window {
+    NSMutableData *data = [NSMutableData dataWithLength:MAX(window.count, 1) * sizeof(double)];
+    double *values = data.mutableBytes;
+    NSInteger index = 0;
+    for (NSNumber *num in window) {
+        values[index++] = [num doubleValue];
+    }
+    return data;
+}
+
+- (void)addInitialPassWindow:(NSArray<NSNumber *> *)stepResponse maxInput:(double)maxInput {
+    NSData *values = [PIDResponseCurveBuilder valuesFromWindow:stepResponse];
+    [self addInitialPassWindowValues:values.bytes length:stepResponse.count maxInput:maxInput];
+}
+
+- (void)addInitialPassWindowValues:(const double *)values length:(NSInteger)length maxInput:(double)maxInput {
+    // 与stepResponse[0].count一致：第一个窗口决定响应长度
+    if (_windowCount == 0) {
+        self.responseLength = length;
+    }
+    _windowCount++;
+
+    // 与lowHighMask的比较方式相同（NaN归入high组）
+    if (!(maxInput <= kActiveInputThreshold)) {
+        self.activeCount++;
+    }
+    if (!(maxInput <= self.highInputThreshold)) {
+        self.highInputCount++;
+        return;
+    }
+    if (maxInput <= kActiveInputThreshold) {
+        return;
+    }
+
+    self.lowInputCount++;
+    if (!self.initialHistogram) {
+        self.initialHistogram = [[PIDResponseHistogram alloc] initWithResponseLength:self.responseLength
+                                                                           vertRange:[PIDResponseCurveBuilder responseVertRange]
+                                                                            vertBins:kResponseVertBins];
+    }
+    if (length == self.responseLength) {
+        [self.initialHistogram addWindowValues:values weight:1.0];
+    }
+}
+
+- (void)finishInitialPass {
+    // Python: toolow_mask 少于10个窗口时整体清零；high_mask 同理
+    self.lowEnabled = self.activeCount >= kMinMaskWindowCount;
+    self.highEnabled = self.lowEnabled && self.highInputCount >= kMinMaskWindowCount;
+
+    if (self.lowEnabled && self.initialHistogram) {
+        self.referenceResponse = [self.initialHistogram weightedModeAverage];
+    } else {
+        self.referenceResponse = [PIDResponseCurveBuilder zeroResponseWithLength:self.responseLength];
+    }
+    self.initialHistogram = nil;
+    self.referenceValues = [PIDResponseCurveBuilder valuesFromWindow:self.referenceResponse];
+
+    NSArray<NSNumber *> *vertRange = [PIDResponseCurveBuilder responseVertRange];
+    if (self.lowEnabled) {
+        self.lowHistogram = [[PIDResponseHistogram alloc] initWithResponseLength:self.responseLength
+                                                                       vertRange:vertRange
+                                                                        vertBins:kResponseVertBins];
+    }
+    if (self.highEnabled) {
+        self.highHistogram = [[PIDResponseHistogram alloc] initWithResponseLength:self.responseLength
+                                                                        vertRange:vertRange
+                                                                         vertBins:kResponseVertBins];
+    }
+}
+
+- (void)addFinalPassWindow:(NSArray<NSNumber *> *)stepResponse maxInput:(double)maxInput {
+    NSData *values = [PIDResponseCurveBuilder valuesFromWindow:stepResponse];
+    [self addFinalPassWindowValues:values.bytes length:stepResponse.count maxInput:maxInput];
+}
+
+- (void)addFinalPassWindowValues:(const double *)values length:(NSInteger)length maxInput:(double)maxInput {
+    PIDResponseHistogram *target = nil;
+    if (!(maxInput <= self.highInputThreshold)) {
+        target = self.highHistogram;
+    } else if (!(maxInput <= kActiveInputThreshold)) {
+        target = self.lowHistogram;
+    }
+    if (!target || length != self.responseLength || length == 0) {
+        return;
+    }
+
+    // resp_quality：与参考响应的平均绝对偏差 ≤ 0.5 才保留（低/高输入共用同一参考）
+    const double *reference = self.referenceValues.bytes;
+    double sumDeviation = 0.0;
+    for (NSInteger i = 0; i < length; i++) {
+        sumDeviation += fabs(values[i] - reference[i]);
+    }
+    if (sumDeviation / length <= kResponseQualityThreshold) {
+        [target addWindowValues:values weight:1.0];
+    }
+}
+
+- (PIDResponseCurves *)finishFinalPass {
+    PIDResponseCurves *curves = [[PIDResponseCurves alloc] init];
+    curves.windowCount = self.windowCount;
+    curves.lowWindowCount = self.lowEnabled ? self.lowInputCount : 0;
+    curves.highWindowCount = self.highEnabled ? self.highInputCount : 0;
+
+    curves.respLow = self.lowHistogram ? [self.lowHistogram weightedModeAverage]
+                                       : [PIDResponseCurveBuilder zeroResponseWithLength:self.responseLength];
+    curves.respHigh = self.highHistogram ? [self.highHistogram weightedModeAverage] : nil;
+
+    self.lowHistogram = nil;
+    self.highHistogram = nil;
+    self.referenceValues = nil;
+
+    NSLog(@"✅ 响应曲线: %ld窗口, 低输入=%ld, 高输入=%ld",
+          (long)curves.windowCount, (long)curves.lowWindowCount, (long)curves.highWindowCount);
+
+    return curves;
+}
+
+@end
+
+#pragma mark - PIDIncrementalResponseAnalysis Implementation
+
+static inline BOOL PIDBitTest(const uint64_t *bits, NSInteger index) {
+    return (bits[index >> 6] >> (index & 63)) & 1;
+}
+
+static inline void PIDBitSet(uint64_t *bits, NSInteger index, BOOL value) {
+    uint64_t mask = (uint64_t)1 << (index & 63);
+    if (value) {
+        bits[index >> 6] |= mask;
+    } else {
+        bits[index >> 6] &= ~mask;
+    }
+}
+
+// 上下限比较写成取反形式：NaN不会被默认的无限范围排除
+static inline BOOL PIDValueInRange(double value, double lower, double upper) {
+    return !(value < lower) && !(value > upper);
+}
+
+/**
+ * 按键值排序的窗口编号中，第一个键值 ≥ value（inclusive）或 > value（!inclusive）的位置
+ */
+static NSInteger PIDWindowOrderBound(const NSInteger *order, NSInteger count, const double *keys,
+                                     double value, BOOL inclusive) {
+    NSInteger low = 0;
+    NSInteger high = count;
+    while (low < high) {
+        NSInteger mid = (low + high) / 2;
+        double key = keys[order[mid]];
+        if (inclusive ? key < value : key <= value) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+/**
+ * 把新窗口 [first, first+count) 中键值非NaN的窗口按键值归并进已排序的窗口编号
+ * （NaN总在范围内，不需要参与边界查找）
+ */
+static void PIDMergeWindowOrder(NSMutableData *order, const double *keys, NSInteger first, NSInteger count) {
+    NSMutableData *added = [NSMutableData dataWithLength:count * sizeof(NSInteger)];
+    NSInteger *addedIndices = added.mutableBytes;
+    NSInteger addedCount = 0;
+    for (NSInteger w = first; w < first + count; w++) {
+        if (!isnan(keys[w])) {
+            addedIndices[addedCount++] = w;
+        }
+    }
+    if (addedCount == 0) {
+        return;
+    }
+    qsort_b(addedIndices, addedCount, sizeof(NSInteger), ^int(const void *a, const void *b) {
+        NSInteger wa = *(const NSInteger *)a;
+        NSInteger wb = *(const NSInteger *)b;
+        if (keys[wa] != keys[wb]) {
+            return keys[wa] < keys[wb] ? -1 : 1;
+        }
+        return wa < wb ? -1 : (wa > wb ? 1 : 0);
+    });
+
+    NSInteger oldCount = (NSInteger)(order.length / sizeof(NSInteger));
+    NSMutableData *merged = [NSMutableData dataWithLength:(oldCount + addedCount) * sizeof(NSInteger)];
+    const NSInteger *oldIndices = order.bytes;
+    NSInteger *dst = merged.mutableBytes;
+    NSInteger i = 0;
+    NSInteger j = 0;
+    while (i < oldCount || j < addedCount) {
+        BOOL takeOld = j >= addedCount || (i < oldCount && keys[oldIndices[i]] <= keys[addedIndices[j]]);
+        *dst++ = takeOld ? oldIndices[i++] : addedIndices[j++];
+    }
+    [order setData:merged];
+}
+
+// 每个窗口1位的位集合
+typedef NS_ENUM(NSInteger, PIDWindowBitset) {
+    PIDWindowBitsetLowInput = 0,    // 20 < max_in ≤ 500
+    PIDWindowBitsetHighInput,       // max_in > 500（含NaN）
+    PIDWindowBitsetValid,           // 响应长度一致，可以加入直方图
+    PIDWindowBitsetInRange,         // 满足油门/时间范围
+    PIDWindowBitsetQuality,         // 通过resp_quality（只对候选窗口保持最新）
+    PIDWindowBitsetReference,       // 参考组
+    PIDWindowBitsetLowTarget,       // 低输入直方图应包含的窗口
+    PIDWindowBitsetHighTarget,      // 高输入直方图应包含的窗口
+    PIDWindowBitsetLowMembers,      // 低输入直方图当前包含的窗口
+    PIDWindowBitsetHighMembers,     // 高输入直方图当前包含的窗口
+    PIDWindowBitsetCount
+};
+
+// 逐窗口统计量（每项_capacity个double）
+typedef NS_ENUM(NSInteger, PIDWindowStat) {
+    PIDWindowStatMaxInput = 0,
+    PIDWindowStatMaxThrottle,
+    PIDWindowStatAvgTime,
+    PIDWindowStatDeviation,         // 与参考响应的平均绝对偏差（版本见_scoreVersions）
+    PIDWindowStatCount
+};
+
+@implementation PIDIncrementalResponseAnalysis {
+    NSInteger _responseLength;
+    NSInteger _capacity;        // 已分配的窗口容量
+    NSInteger _wordCapacity;    // 每个位集合已分配的字数
+
+    NSData *_values;            // 阶跃响应矩阵 [windowCount × responseLength]
+    BOOL _ownsValues;           // NO：与来源结果的stepResponseData共用，追加窗口前先复制
+    NSMutableData *_cells;      // 每个窗口落入的直方图单元 [capacity × responseLength]
+    NSMutableData *_cellCounts; // 每个窗口的单元个数（NSInteger）
+    NSMutableData *_windowStats;// PIDWindowStatCount项，每项_capacity个double
+    NSMutableData *_scoreVersions; // 每个窗口的偏差是按哪个版本的参考响应计算的（uint32_t）
+
+    NSMutableData *_bits;       // PIDWindowBitsetCount个位集合，每个_wordCapacity个字
+
+    // 油门/平均时间非NaN的窗口按键值升序排列（NSInteger），范围变化时二分查找跨过边界的窗口
+    NSMutableData *_throttleOrder;
+    NSMutableData *_timeOrder;
+    NSMutableData *_enteredWindows; // 上次计算后进入范围（含新追加）的窗口，需要补算偏差
+
+    PIDResponseHistogram *_lowHistogram;
+    PIDResponseHistogram *_highHistogram;
+
+    NSMutableData *_referenceValues;
+    uint32_t _referenceVersion;
+    BOOL _referenceReady;
+
+    // 已应用到InRange位集合的范围（属性可以连续修改，计算时一次应用）
+    double _appliedMinThrottle;
+    double _appliedMaxThrottle;
+    double _appliedStartTime;
+    double _appliedEndTime;
+
+    BOOL _lowEnabled;
+    BOOL _highEnabled;
+    NSInteger _activeCount;     // 范围内的窗口计数（质量过滤之前，与构建器一致）
+    NSInteger _lowInputCount;
+    NSInteger _highInputCount;
+
+    BOOL _rangeDirty;
+    BOOL _qualityDirty;
+    BOOL _windowsDirty;
+    PIDResponseCurves *_curves;
+}
+
++ (NSUInteger)bytesForWindowCount:(NSInteger)windowCount responseLength:(NSInteger)responseLength {
+    NSUInteger windows = (NSUInteger)MAX(windowCount, 0);
+    NSUInteger length = (NSUInteger)MAX(responseLength, 0);
+    NSUInteger cells = windows * length * sizeof(uint32_t);
+    NSUInteger perWindow = sizeof(NSInteger) + PIDWindowStatCount * sizeof(double) + sizeof(uint32_t) +
+                           2 * sizeof(NSInteger) + PIDWindowBitsetCount / 8 + 1;
+    NSUInteger modeSums = 2 * length * 3 * sizeof(double);
+    return [PIDResponseCurveBuilder peakBytesForResponseLength:responseLength] + modeSums + cells +
+           windows * perWindow;
+}
+
+- (nullable instancetype)initWithResponseResult:(PIDResponseResult *)result {
+    NSArray<NSArray<NSNumber *> *> *stepResponse = result.stepResponse;
+    NSInteger windowCount = MIN(stepResponse.count, result.maxInput.count);
+    NSInteger responseLength = stepResponse.count > 0 ? stepResponse[0].count : 0;
+    if (windowCount == 0 || responseLength == 0) {
+        return nil;
+    }
+
+    self = [super init];
+    if (self) {
+        _responseResult = result;
+        _responseLength = responseLength;
+        _qualityThreshold = kResponseQualityThreshold;
+        _minThrottle = -INFINITY;
+        _maxThrottle = INFINITY;
+        _startTime = -INFINITY;
+        _endTime = INFINITY;
+        _appliedMinThrottle = -INFINITY;
+        _appliedMaxThrottle = INFINITY;
+        _appliedStartTime = -INFINITY;
+        _appliedEndTime = INFINITY;
+
+        _capacity = windowCount;
+        _wordCapacity = (windowCount + 63) / 64;
+        _bits = [NSMutableData dataWithLength:PIDWindowBitsetCount * _wordCapacity * sizeof(uint64_t)];
+        _cellCounts = [NSMutableData dataWithLength:windowCount * sizeof(NSInteger)];
+        _cells = [NSMutableData dataWithLength:windowCount * responseLength * sizeof(uint32_t)];
+        _windowStats = [NSMutableData dataWithLength:PIDWindowStatCount * windowCount * sizeof(double)];
+        _scoreVersions = [NSMutableData dataWithLength:windowCount * sizeof(uint32_t)];
+        _throttleOrder = [NSMutableData data];
+        _timeOrder = [NSMutableData data];
+        _enteredWindows = [NSMutableData data];
+        _referenceValues = [NSMutableData dataWithLength:responseLength * sizeof(double)];
+
+        // 有连续矩阵时直接共用；否则拆箱一次（长度不一致的窗口不参与直方图，与构建器相同）
+        NSData *matrix = result.stepResponseData;
+        if (matrix.length == (NSUInteger)(stepResponse.count * responseLength) * sizeof(double)) {
+            _values = matrix;
+            _ownsValues = NO;
+            uint64_t *valid = [self bitset:PIDWindowBitsetValid];
+            for (NSInteger w = 0; w < windowCount; w++) {
+                PIDBitSet(valid, w, YES);
+            }
+        } else {
+            _values = [NSMutableData dataWithLength:windowCount * responseLength * sizeof(double)];
+            _ownsValues = YES;
+            [self copyValuesFromResult:result count:windowCount toWindow:0];
+        }
+
+        NSArray<NSNumber *> *vertRange = [PIDResponseCurveBuilder responseVertRange];
+        _lowHistogram = [[PIDResponseHistogram alloc] initWithResponseLength:responseLength
+                                                                   vertRange:vertRange
+                                                                    vertBins:kResponseVertBins];
+        _highHistogram = [[PIDResponseHistogram alloc] initWithResponseLength:responseLength
+                                                                    vertRange:vertRange
+                                                                     vertBins:kResponseVertBins];
+        [_lowHistogram enableModeSums];
+        [_highHistogram enableModeSums];
+
+        [self addWindowsFromResult:result count:windowCount];
+    }
+    return self;
+}
+
+- (void)appendWindowsFromResult:(PIDResponseResult *)result {
+    NSInteger count = MIN(result.stepResponse.count, result.maxInput.count);
+    if (count == 0) {
+        return;
+    }
+
+    [self reserveWindowCapacity:_windowCount + count];
+    [self copyValuesFromResult:result count:count toWindow:_windowCount];
+    [self addWindowsFromResult:result count:count];
+}
+
+- (uint64_t *)bitset:(PIDWindowBitset)bitset {
+    return (uint64_t *)_bits.mutableBytes + bitset * _wordCapacity;
+}
+
+- (double *)windowStat:(PIDWindowStat)stat {
+    return (double *)_windowStats.mutableBytes + stat * _capacity;
+}
+
+#pragma mark - 窗口存储
+
+/**
+ * 容量不足时按两倍扩大；位集合与统计量按新容量重新排布，共用的响应矩阵先复制为自己的
+ */
+- (void)reserveWindowCapacity:(NSInteger)needed {
+    if (needed <= _capacity) {
+        return;
+    }
+
+    NSInteger capacity = MAX(needed, 2 * _capacity);
+    NSInteger wordCapacity = (capacity + 63) / 64;
+    NSInteger length = _responseLength;
+
+    NSMutableData *bits = [NSMutableData dataWithLength:PIDWindowBitsetCount * wordCapacity * sizeof(uint64_t)];
+    for (NSInteger b = 0; b < PIDWindowBitsetCount; b++) {
+        memcpy((uint64_t *)bits.mutableBytes + b * wordCapacity,
+               (const uint64_t *)_bits.bytes + b * _wordCapacity, _wordCapacity * sizeof(uint64_t));
+    }
+
+    NSMutableData *stats = [NSMutableData dataWithLength:PIDWindowStatCount * capacity * sizeof(double)];
+    for (NSInteger s = 0; s < PIDWindowStatCount; s++) {
+        memcpy((double *)stats.mutableBytes + s * capacity,
+               (const double *)_windowStats.bytes + s * _capacity, _windowCount * sizeof(double));
+    }
+
+    if (_ownsValues) {
+        [(NSMutableData *)_values setLength:capacity * length * sizeof(double)];
+    } else {
+        NSMutableData *values = [NSMutableData dataWithCapacity:capacity * length * sizeof(double)];
+        [values appendBytes:_values.bytes length:_windowCount * length * sizeof(double)];
+        [values setLength:capacity * length * sizeof(double)];
+        _values = values;
+        _ownsValues = YES;
+    }
+
+    [_cells setLength:capacity * length * sizeof(uint32_t)];
+    [_cellCounts setLength:capacity * sizeof(NSInteger)];
+    [_scoreVersions setLength:capacity * sizeof(uint32_t)];
+    _bits = bits;
+    _windowStats = stats;
+    _capacity = capacity;
+    _wordCapacity = wordCapacity;
+}
+
+/**
+ * 把结果的前count个窗口写入响应矩阵的 [first, first+count) 行，并标记可用的窗口
+ */
+- (void)copyValuesFromResult:(PIDResponseResult *)result count:(NSInteger)count toWindow:(NSInteger)first {
+    NSArray<NSArray<NSNumber *> *> *stepResponse = result.stepResponse;
+    NSInteger length = _responseLength;
+    NSData *matrix = result.stepResponseData;
+    BOOL hasMatrix = matrix.length == (NSUInteger)(stepResponse.count * length) * sizeof(double);
+    double *dst = (double *)((NSMutableData *)_values).mutableBytes + first * length;
+    uint64_t *valid = [self bitset:PIDWindowBitsetValid];
+
+    if (hasMatrix) {
+        memcpy(dst, matrix.bytes, count * length * sizeof(double));
+        for (NSInteger w = 0; w < count; w++) {
+            PIDBitSet(valid, first + w, YES);
+        }
+        return;
+    }
+
+    for (NSInteger w = 0; w < count; w++) {
+        NSArray<NSNumber *> *window = stepResponse[w];
+        if (window.count != length) {
+            continue;
+        }
+        double *row = dst + w * length;
+        NSInteger index = 0;
+        for (NSNumber *num in window) {
+            row[index++] = [num doubleValue];
+        }
+        PIDBitSet(valid, first + w, YES);
+    }
+}
+
+/**
+ * 登记响应矩阵中已写好的 [windowCount, windowCount+count) 行：
+ * 直方图单元、统计量和输入分组只计算一次；按已应用的范围判断是否在范围内，在范围内的窗口记为待补算偏差
+ */
+- (void)addWindowsFromResult:(PIDResponseResult *)result count:(NSInteger)count {
+    NSInteger first = _windowCount;
+    NSInteger length = _responseLength;
+    const double *values = _values.bytes;
+    uint32_t *cells = _cells.mutableBytes;
+    NSInteger *cellCounts = _cellCounts.mutableBytes;
+    const uint64_t *valid = [self bitset:PIDWindowBitsetValid];
+    for (NSInteger w = first; w < first + count; w++) {
+        if (PIDBitTest(valid, w)) {
+            cellCounts[w] = [_lowHistogram cellsForWindowValues:values + w * length
+                                                          cells:cells + w * length];
+        }
+    }
+
+    // 输入分组与lowHighMask的比较方式相同（NaN归入high组）
+    double *maxInput = [self windowStat:PIDWindowStatMaxInput];
+    double *maxThrottle = [self windowStat:PIDWindowStatMaxThrottle];
+    double *avgTime = [self windowStat:PIDWindowStatAvgTime];
+    uint64_t *lowInput = [self bitset:PIDWindowBitsetLowInput];
+    uint64_t *highInput = [self bitset:PIDWindowBitsetHighInput];
+    for (NSInteger i = 0; i < count; i++) {
+        NSInteger w = first + i;
+        double input = [result.maxInput[i] doubleValue];
+        maxInput[w] = input;
+        maxThrottle[w] = i < result.maxThrottle.count ? [result.maxThrottle[i] doubleValue] : NAN;
+        avgTime[w] = i < result.avgTime.count ? [result.avgTime[i] doubleValue] : NAN;
+        PIDBitSet(highInput, w, !(input <= kHighInputThreshold));
+        PIDBitSet(lowInput, w, input <= kHighInputThreshold && !(input <= kActiveInputThreshold));
+    }
+
+    _windowCount += count;
+    PIDMergeWindowOrder(_throttleOrder, maxThrottle, first, count);
+    PIDMergeWindowOrder(_timeOrder, avgTime, first, count);
+    for (NSInteger w = first; w < first + count; w++) {
+        [self updateRangeOfWindow:w];
+    }
+    _windowsDirty = YES;
+}
+
+#pragma mark - 条件
+
+- (void)setQualityThreshold:(double)qualityThreshold {
+    if (qualityThreshold != _qualityThreshold) {
+        _qualityThreshold = qualityThreshold;
+        _qualityDirty = YES;
+    }
+}
+
+- (void)setMinThrottle:(double)minThrottle {
+    if (minThrottle != _minThrottle) {
+        _minThrottle = minThrottle;
+        _rangeDirty = YES;
+    }
+}
+
+- (void)setMaxThrottle:(double)maxThrottle {
+    if (maxThrottle != _maxThrottle) {
+        _maxThrottle = maxThrottle;
+        _rangeDirty = YES;
+    }
+}
+
+- (void)setStartTime:(double)startTime {
+    if (startTime != _startTime) {
+        _startTime = startTime;
+        _rangeDirty = YES;
+    }
+}
+
+- (void)setEndTime:(double)endTime {
+    if (endTime != _endTime) {
+        _endTime = endTime;
+        _rangeDirty = YES;
+    }
+}
+
+#pragma mark - 增量更新
+
+/**
+ * 按已应用的范围更新一个窗口的InRange位；状态变化时同步范围内的计数，进入范围的窗口记为待补算偏差
+ */
+- (void)updateRangeOfWindow:(NSInteger)w {
+    const double *maxThrottle = [self windowStat:PIDWindowStatMaxThrottle];
+    const double *avgTime = [self windowStat:PIDWindowStatAvgTime];
+    uint64_t *inRange = [self bitset:PIDWindowBitsetInRange];
+    BOOL selected = PIDValueInRange(maxThrottle[w], _appliedMinThrottle, _appliedMaxThrottle) &&
+                    PIDValueInRange(avgTime[w], _appliedStartTime, _appliedEndTime);
+    if (selected == PIDBitTest(inRange, w)) {
+        return;
+    }
+
+    PIDBitSet(inRange, w, selected);
+    NSInteger delta = selected ? 1 : -1;
+    if (!([self windowStat:PIDWindowStatMaxInput][w] <= kActiveInputThreshold)) _activeCount += delta;
+    if (PIDBitTest([self bitset:PIDWindowBitsetHighInput], w)) _highInputCount += delta;
+    if (PIDBitTest([self bitset:PIDWindowBitsetLowInput], w)) _lowInputCount += delta;
+    if (selected) {
+        [_enteredWindows appendBytes:&w length:sizeof(NSInteger)];
+    }
+}
+
+/**
+ * 一个键的上下限从 [oldLow, oldHigh] 变为 [newLow, newHigh]：
+ * 只有键值落在两个下限之间或两个上限之间的窗口可能改变状态，在排序后的窗口编号中二分得到
+ */
+- (void)updateRangeWithOrder:(NSData *)order keys:(const double *)keys
+                      oldLow:(double)oldLow oldHigh:(double)oldHigh
+                      newLow:(double)newLow newHigh:(double)newHigh {
+    const NSInteger *indices = order.bytes;
+    NSInteger count = (NSInteger)(order.length / sizeof(NSInteger));
+    double bounds[2][2] = {{oldLow, newLow}, {oldHigh, newHigh}};
+    for (NSInteger side = 0; side < 2; side++) {
+        double a = bounds[side][0];
+        double b = bounds[side][1];
+        if (a == b) {
+            continue;
+        }
+        NSInteger begin = PIDWindowOrderBound(indices, count, keys, MIN(a, b), YES);
+        NSInteger end = PIDWindowOrderBound(indices, count, keys, MAX(a, b), NO);
+        for (NSInteger i = begin; i < end; i++) {
+            [self updateRangeOfWindow:indices[i]];
+        }
+    }
+}
+
+/**
+ * 应用新的油门/时间范围：只访问跨过边界的窗口，O(log 窗口数 + 变化窗口数)
+ */
+- (void)applyRange {
+    double oldMinThrottle = _appliedMinThrottle;
+    double oldMaxThrottle = _appliedMaxThrottle;
+    double oldStartTime = _appliedStartTime;
+    double oldEndTime = _appliedEndTime;
+    _appliedMinThrottle = _minThrottle;
+    _appliedMaxThrottle = _maxThrottle;
+    _appliedStartTime = _startTime;
+    _appliedEndTime = _endTime;
+
+    [self updateRangeWithOrder:_throttleOrder keys:[self windowStat:PIDWindowStatMaxThrottle]
+                        oldLow:oldMinThrottle oldHigh:oldMaxThrottle
+                        newLow:_minThrottle newHigh:_maxThrottle];
+    [self updateRangeWithOrder:_timeOrder keys:[self windowStat:PIDWindowStatAvgTime]
+                        oldLow:oldStartTime oldHigh:oldEndTime
+                        newLow:_startTime newHigh:_endTime];
+}
+
+/**
+ * 候选窗口：可用、在范围内且属于低/高输入组（只有它们的质量位会被使用）
+ */
+- (BOOL)isCandidateWindow:(NSInteger)w {
+    return PIDBitTest([self bitset:PIDWindowBitsetValid], w) &&
+           PIDBitTest([self bitset:PIDWindowBitsetInRange], w) &&
+           (PIDBitTest([self bitset:PIDWindowBitsetLowInput], w) ||
+            PIDBitTest([self bitset:PIDWindowBitsetHighInput], w));
+}
+
+/**
+ * 全部候选窗口的编号
+ */
+- (NSMutableData *)candidateWindows {
+    const uint64_t *valid = [self bitset:PIDWindowBitsetValid];
+    const uint64_t *inRange = [self bitset:PIDWindowBitsetInRange];
+    const uint64_t *lowInput = [self bitset:PIDWindowBitsetLowInput];
+    const uint64_t *highInput = [self bitset:PIDWindowBitsetHighInput];
+    NSMutableData *windows = [NSMutableData data];
+    NSInteger wordCount = (_windowCount + 63) / 64;
+    for (NSInteger word = 0; word < wordCount; word++) {
+        uint64_t bits = valid[word] & inRange[word] & (lowInput[word] | highInput[word]);
+        while (bits) {
+            NSInteger w = word * 64 + __builtin_ctzll(bits);
+            [windows appendBytes:&w length:sizeof(NSInteger)];
+            bits &= bits - 1;
+        }
+    }
+    return windows;
+}
+
+/**
+ * resp_quality：按当前参考响应重新计算这些窗口的平均绝对偏差（累加顺序与构建器相同），窗口间并行
+ */
+- (void)scoreWindows:(NSData *)windows {
+    NSInteger count = (NSInteger)(windows.length / sizeof(NSInteger));
+    if (count == 0) {
+        return;
+    }
+
+    const NSInteger *indices = windows.bytes;
+    const double *values = _values.bytes;
+    const double *ref = _referenceValues.bytes;
+    double *deviation = [self windowStat:PIDWindowStatDeviation];
+    uint32_t *versions = _scoreVersions.mutableBytes;
+    uint32_t version = _referenceVersion;
+    NSInteger length = _responseLength;
+    size_t chunkCount = PIDParallelChunkCount((size_t)count, 16);
+    PIDParallelForEach(chunkCount, ^(size_t chunk) {
+        NSInteger begin = (NSInteger)(chunk * (size_t)count / chunkCount);
+        NSInteger end = (NSInteger)((chunk + 1) * (size_t)count / chunkCount);
+        for (NSInteger i = begin; i < end; i++) {
+            NSInteger w = indices[i];
+            const double *row = values + w * length;
+            double sum = 0.0;
+            for (NSInteger k = 0; k < length; k++) {
+                sum += fabs(row[k] - ref[k]);
+            }
+            deviation[w] = sum / length;
+            versions[w] = version;
+        }
+    });
+}
+
+/**
+ * 按当前阈值设置这些窗口的质量位
+ */
+- (void)updateQualityOfWindows:(NSData *)windows {
+    const NSInteger *indices = windows.bytes;
+    NSInteger count = (NSInteger)(windows.length / sizeof(NSInteger));
+    const double *deviation = [self windowStat:PIDWindowStatDeviation];
+    uint64_t *quality = [self bitset:PIDWindowBitsetQuality];
+    for (NSInteger i = 0; i < count; i++) {
+        NSInteger w = indices[i];
+        PIDBitSet(quality, w, deviation[w] <= _qualityThreshold);
+    }
+}
+
+/**
+ * 让直方图的成员变为目标集合：只加入/扣除两者不同的窗口
+ * @return 变化的窗口数
+ */
+- (NSInteger)syncHistogram:(PIDResponseHistogram *)histogram
+                   members:(uint64_t *)members
+                    target:(const uint64_t *)target {
+    const uint32_t *cells = _cells.bytes;
+    const NSInteger *cellCounts = _cellCounts.bytes;
+    NSInteger changes = 0;
+    NSInteger wordCount = (_windowCount + 63) / 64;
+    for (NSInteger word = 0; word < wordCount; word++) {
+        uint64_t diff = members[word] ^ target[word];
+        while (diff) {
+            NSInteger w = word * 64 + __builtin_ctzll(diff);
+            double weight = PIDBitTest(target, w) ? 1.0 : -1.0;
+            [histogram addWindowCells:cells + w * _responseLength count:cellCounts[w] weight:weight];
+            diff &= diff - 1;
+            changes++;
+        }
+        members[word] = target[word];
     }
+    return changes;
+}
 
-    for (NSInteger i = 0; i < windowCount; i++) {
-        NSInteger start = i * step;
-        NSInteger end = MIN(start + windowSize, n);
-
-        if (end <= start) break;
-
-        // 提取窗口数据
-        NSArray<NSNumber *> *timeWindow = [data.timeSeconds subarrayWithRange:NSMakeRange(start, end - start)];
-        NSArray<NSNumber *> *rcCommand3 = [data.rcCommand3 subarrayWithRange:NSMakeRange(start, end - start)];  // Throttle
-        NSArray<NSNumber *> *gyroWindow = [gyroADCAxis subarrayWithRange:NSMakeRange(start, end - start)];
-        NSArray<NSNumber *> *axisPWindow = [axisP subarrayWithRange:NSMakeRange(start, end - start)];
-
-        // 🔧 修正：计算PID输入（对应Python的pid_in函数）
-        // Python: pidin = gyro + p_err / (0.032029 * pidp)
-        // 其中 p_err = axisP[i], pidp = 固定的P增益值
-        NSMutableArray<NSNumber *> *pidInput = [NSMutableArray arrayWithCapacity:end - start];
-
-        // 🔍 调试：检查第一个窗口的axisP和gyro原始值范围
-        if (i == 0 && axisIndex == 0) {  // 只在Roll轴的第一个窗口打印
-            double pMin = [axisPWindow[0] doubleValue], pMax = pMin;
-            double gMin = [gyroWindow[0] doubleValue], gMax = gMin;
-            for (NSNumber *num in axisPWindow) {
-                double v = [num doubleValue];
-                if (v < pMin) pMin = v; if (v > pMax) pMax = v;
-            }
-            for (NSNumber *num in gyroWindow) {
-                double v = [num doubleValue];
-                if (v < gMin) gMin = v; if (v > gMax) gMax = v;
-            }
-            NSLog(@"🔍 [原始数据窗口0] axisP范围: [%.1f, %.1f], gyro范围: [%.1f, %.1f], pGain=%.1f", pMin, pMax, gMin, gMax, pGain);
-        }
-
-        for (NSInteger j = 0; j < gyroWindow.count; j++) {
-            double pval = [axisPWindow[j] doubleValue];  // ✅ 修正：使用axisP作为pval
-            double gyro = [gyroWindow[j] doubleValue];
-            double pidp = pGain;  // ✅ 修正：使用固定的P增益值
-
-            // 🔧 防止除以0：当pGain为0或很小时，只使用gyro作为输入
-            double pidin;
-            double denom = kP_SCALE_FACTOR * pidp;
-            if (fabs(denom) < 1e-9) {
-                // pGain为0或接近0，无法计算PID输入，使用gyro作为fallback
-                pidin = gyro;
-            } else {
-                // pidin = gyro + pval / (0.032029 * pidp)
-                pidin = gyro + pval / denom;
-            }
-            [pidInput addObject:@(pidin)];
+/**
+ * 参考组或参考开关变化时更新参考响应：低输入直方图临时变为参考组（加回未通过质量过滤的窗口），
+ * 曲线由直方图维护的平滑列和直接得到；参考响应变化后所有候选窗口的偏差都要重新计算
+ * （resp_quality本身的代价），不在范围内的窗口等进入范围时再补算
+ * @return 直方图变化的窗口数
+ */
+- (NSInteger)updateReference {
+    NSInteger changes = 0;
+    double *dst = _referenceValues.mutableBytes;
+    memset(dst, 0, _responseLength * sizeof(double));
+    if (_lowEnabled) {
+        changes = [self syncHistogram:_lowHistogram
+                              members:[self bitset:PIDWindowBitsetLowMembers]
+                               target:[self bitset:PIDWindowBitsetReference]];
+        NSArray<NSNumber *> *curve = [_lowHistogram trackedModeAverage];
+        for (NSInteger i = 0; i < _responseLength && i < (NSInteger)curve.count; i++) {
+            dst[i] = [curve[i] doubleValue];
         }
-
-        [timeStack addObject:[timeWindow mutableCopy]];
-        [inputStack addObject:pidInput];
-        [gyroStack addObject:[gyroWindow mutableCopy]];
-        [throttleStack addObject:[rcCommand3 mutableCopy]];
     }
 
-    stack.input = inputStack;
-    stack.gyro = gyroStack;
-    stack.throttle = throttleStack;
-    stack.time = timeStack;
+    _referenceVersion++;
+    _referenceReady = YES;
+    NSMutableData *candidates = [self candidateWindows];
+    [self scoreWindows:candidates];
+    [self updateQualityOfWindows:candidates];
+    return changes;
+}
 
-    NSLog(@"✅ 堆叠数据创建完成: %ld窗口, P增益=%.1f", (long)windowCount, pGain);
+- (PIDResponseCurves *)currentCurves {
+    if (_curves && !_rangeDirty && !_qualityDirty && !_windowsDirty) {
+        return _curves;
+    }
 
-    return stack;
-}
+    if (_rangeDirty) {
+        [self applyRange];
+        _rangeDirty = NO;
+    }
 
-@end
+    // 参考组 = 低输入 ∧ 范围 ∧ 可用，逐字与上一次比较（O(窗口数/64)）
+    const uint64_t *lowInput = [self bitset:PIDWindowBitsetLowInput];
+    const uint64_t *inRange = [self bitset:PIDWindowBitsetInRange];
+    const uint64_t *valid = [self bitset:PIDWindowBitsetValid];
+    uint64_t *reference = [self bitset:PIDWindowBitsetReference];
+    NSInteger wordCount = (_windowCount + 63) / 64;
+    BOOL referenceSetChanged = NO;
+    for (NSInteger word = 0; word < wordCount; word++) {
+        uint64_t selected = lowInput[word] & inRange[word] & valid[word];
+        referenceSetChanged = referenceSetChanged || selected != reference[word];
+        reference[word] = selected;
+    }
 
-@implementation PIDResponseResult
+    // Python: toolow_mask / high_mask 少于10个窗口时整体清零（未启用时参考响应为全零）
+    BOOL lowEnabled = _activeCount >= kMinMaskWindowCount;
+    BOOL referenceChanged = !_referenceReady || lowEnabled != _lowEnabled || (lowEnabled && referenceSetChanged);
+    _lowEnabled = lowEnabled;
+    _highEnabled = lowEnabled && _highInputCount >= kMinMaskWindowCount;
 
-@end
+    NSInteger changes = 0;
+    if (referenceChanged) {
+        changes += [self updateReference];
+    } else {
+        // 参考响应不变：只补算新进入范围的窗口；阈值变化时只重新比较候选窗口的缓存偏差
+        const NSInteger *entered = _enteredWindows.bytes;
+        NSInteger enteredCount = (NSInteger)(_enteredWindows.length / sizeof(NSInteger));
+        const uint32_t *versions = _scoreVersions.bytes;
+        NSMutableData *stale = [NSMutableData data];
+        NSMutableData *fresh = [NSMutableData data];
+        for (NSInteger i = 0; i < enteredCount; i++) {
+            NSInteger w = entered[i];
+            if (![self isCandidateWindow:w]) {
+                continue;
+            }
+            [fresh appendBytes:&w length:sizeof(NSInteger)];
+            if (versions[w] != _referenceVersion) {
+                [stale appendBytes:&w length:sizeof(NSInteger)];
+            }
+        }
+        [self scoreWindows:stale];
+        [self updateQualityOfWindows:_qualityDirty ? [self candidateWindows] : fresh];
+    }
+    _enteredWindows.length = 0;
+    _qualityDirty = NO;
+    _windowsDirty = NO;
+
+    const uint64_t *quality = [self bitset:PIDWindowBitsetQuality];
+    const uint64_t *highInput = [self bitset:PIDWindowBitsetHighInput];
+    uint64_t *lowTarget = [self bitset:PIDWindowBitsetLowTarget];
+    uint64_t *highTarget = [self bitset:PIDWindowBitsetHighTarget];
+    for (NSInteger word = 0; word < wordCount; word++) {
+        lowTarget[word] = reference[word] & quality[word];
+        highTarget[word] = highInput[word] & inRange[word] & valid[word] & quality[word];
+    }
 
-@implementation PIDSpectrumResult
+    changes += [self syncHistogram:_lowHistogram
+                           members:[self bitset:PIDWindowBitsetLowMembers]
+                            target:lowTarget];
+    changes += [self syncHistogram:_highHistogram
+                           members:[self bitset:PIDWindowBitsetHighMembers]
+                            target:highTarget];
+    _lastUpdateWindowChanges = changes;
+
+    // 曲线直接由两个直方图维护的平滑列和得到，O(时间箱数)
+    PIDResponseCurves *curves = [[PIDResponseCurves alloc] init];
+    curves.windowCount = _windowCount;
+    curves.lowWindowCount = _lowEnabled ? _lowInputCount : 0;
+    curves.highWindowCount = _highEnabled ? _highInputCount : 0;
+    curves.respLow = _lowEnabled ? [_lowHistogram trackedModeAverage]
+                                 : [PIDResponseCurveBuilder zeroResponseWithLength:_responseLength];
+    curves.respHigh = _highEnabled ? [_highHistogram trackedModeAverage] : nil;
+    _curves = curves;
+
+    NSLog(@"✅ 增量响应曲线: %ld窗口, 低输入=%ld, 高输入=%ld, 本次增减%ld个窗口",
+          (long)curves.windowCount, (long)curves.lowWindowCount, (long)curves.highWindowCount, (long)changes);
+
+    return curves;
+}
 
 @end
 
@@ -259,6 +2562,7 @@ static const double kP_SCALE_FACTOR = 0.032029;
         // - responseLen 应该匹配反卷积结果，固定为 4000
         // - 物理时间由 weightedModeAverage 中的 sampleRate 参数计算
         _responseLen = 4000;  // 固定值，对应 windowSize=8000
+        _precision = PIDDSPPrecisionDefault;
 
         _wienerDeconvolution = [[PIDWienerDeconvolution alloc] init];
         _wienerDeconvolution.dt = _dt;
@@ -270,6 +2574,22 @@ static const double kP_SCALE_FACTOR = 0.032029;
     return self;
 }
 
+- (void)setCancellationToken:(PIDCancellationToken *)cancellationToken {
+    _cancellationToken = cancellationToken;
+    _wienerDeconvolution.cancellationToken = cancellationToken;
+}
+
+/**
+ * 分析入口：把取消令牌交给频谱缓存（缓存已有自己的令牌时保留），返回本次分析的取消标志
+ */
+- (const PIDCancelFlag *)cancelFlagForCache:(PIDSpectralCache *)cache {
+    PIDCancellationToken *token = self.cancellationToken;
+    if (token && !cache.cancellationToken) {
+        cache.cancellationToken = token;
+    }
+    return [token flag];
+}
+
 #pragma mark - PID环路输入计算
 
 /**
@@ -319,46 +2639,186 @@ static const double kP_SCALE_FACTOR = 0.032029;
         return [[PIDResponseResult alloc] init];
     }
 
+    // 窗函数长度不匹配时缓存会改用Hanning窗（与Python版本一致）
+    PIDSpectralCache *cache = [[PIDSpectralCache alloc] initWithStackData:stacks window:window];
+    return [self stackResponseWithSpectralCache:cache];
+}
+
+/**
+ * 加窗统计量：加窗后的平均/最大输入、最大油门、平均时间（与分析参数无关）
+ * 窗口按块并行，每个窗口的统计量写入自己的位置
+ * @return 已取消时返回NO
+ */
+- (BOOL)windowStatisticsForStacks:(PIDStackData *)stacks
+                           window:(const double *)winBuffer
+                           cancel:(const PIDCancelFlag *)cancel
+                         maxInput:(double *)maxInValues
+                         avgInput:(double *)avgInValues
+                      maxThrottle:(double *)maxThrValues
+                          avgTime:(double *)avgTValues {
+    NSInteger windowCount = stacks.windowCount;
+    NSInteger windowLen = stacks.windowLength;
+
+    // 三轴一起堆叠时，统计量由4路内核对三个轴和油门一遍算出，各轴共用
+    size_t chunkCount = PIDParallelChunkCount((size_t)windowCount, 16);
+    BOOL groupStatistics = [stacks groupStatisticsWithWindow:winBuffer
+                                                      cancel:cancel
+                                                    maxInput:maxInValues
+                                                    avgInput:avgInValues
+                                                 maxThrottle:maxThrValues
+                                                     avgTime:avgTValues];
+    PIDParallelForEach(groupStatistics ? 0 : chunkCount, ^(size_t chunk) {
+        NSInteger begin = (NSInteger)(chunk * (size_t)windowCount / chunkCount);
+        NSInteger end = (NSInteger)((chunk + 1) * (size_t)windowCount / chunkCount);
+        PIDScratchArena *arena = PIDScratchArenaCurrent();
+        PIDScratchMark mark = PIDScratchArenaMark(arena);
+        double *scratch = (double *)PIDScratchArenaAlloc(arena, windowLen * sizeof(double));
+
+        for (NSInteger i = begin; i < end && scratch && !PIDCancelFlagIsSet(cancel); i++) {
+            // 输入：加窗后计算平均/最大输入
+            vDSP_vmulD([stacks inputWindowAtIndex:i], 1, winBuffer, 1, scratch, 1, (vDSP_Length)windowLen);
+            vDSP_maxmgvD(scratch, 1, &maxInValues[i], (vDSP_Length)windowLen);
+            vDSP_meamgvD(scratch, 1, &avgInValues[i], (vDSP_Length)windowLen);
+
+            // 最大油门（加窗后）
+            vDSP_vmulD([stacks throttleWindowAtIndex:i], 1, winBuffer, 1, scratch, 1, (vDSP_Length)windowLen);
+            vDSP_maxmgvD(scratch, 1, &maxThrValues[i], (vDSP_Length)windowLen);
+
+            // 平均时间
+            vDSP_meanvD([stacks timeWindowAtIndex:i], 1, &avgTValues[i], (vDSP_Length)windowLen);
+        }
+
+        PIDScratchArenaReset(arena, mark);
+    });
+
+    return !PIDCancelFlagIsSet(cancel);
+}
+
+/**
+ * 由频谱缓存计算阶跃响应矩阵：维纳反卷积 → 逆FFT → 前rlen个点的累积和（结果为双精度）
+ * float64：双精度频谱 + 批量维纳反卷积（与Python逐点对齐）；
+ * float32：单精度频谱（与噪声频谱共用同一组陀螺仪频谱）+ 单精度维纳/逆FFT/累积和，在输出边界转换一次
+ * @param activeData 可选：为NO的窗口不做反卷积，结果行为零
+ * @return 频谱不可用、反卷积失败或已取消时返回NO
+ */
+- (BOOL)stepResponsesFromCache:(PIDSpectralCache *)cache
+                  paddedLength:(NSInteger)paddedLength
+                       cutFreq:(double)cutFreq
+                     precision:(PIDDSPPrecision)precision
+                 activeWindows:(nullable NSData *)activeData
+                        cancel:(const PIDCancelFlag *)cancel
+                        result:(double *)deconv
+                  resultLength:(NSInteger)rlen {
+    NSInteger windowCount = cache.stackData.windowCount;
+    const bool *activeWindows = activeData ? (const bool *)activeData.bytes : NULL;
+
+    // 加窗后的输入/陀螺仪频谱来自缓存；预筛时只计算活动窗口的频谱，噪声频谱之后请求全部窗口时缓存再补算其余的
+    PIDWindowSpectra *inputSpectra = [cache spectraForTrace:PIDSpectralTraceInput
+                                                     window:PIDSpectralWindowAnalysis
+                                               paddedLength:paddedLength
+                                                  precision:precision
+                                              activeWindows:activeData];
+    PIDWindowSpectra *gyroSpectra = [cache spectraForTrace:PIDSpectralTraceGyro
+                                                    window:PIDSpectralWindowAnalysis
+                                              paddedLength:paddedLength
+                                                 precision:precision
+                                             activeWindows:activeData];
+    if (!inputSpectra || !gyroSpectra) {
+        return NO;
+    }
+
+    if (precision == PIDDSPPrecisionFloat32) {
+        NS_VALID_UNTIL_END_OF_SCOPE NSData *invSN = [self.wienerDeconvolution inverseSignalToNoiseForLength:paddedLength
+                                                                                                    cutFreq:cutFreq];
+        const double *invSNLow = (const double *)invSN.bytes;
+        float *single = (float *)malloc(MAX(windowCount * rlen, 1) * sizeof(float));
+        BOOL deconvolved = single &&
+            PIDStepResponseFromSpectraF(inputSpectra.realDataF, inputSpectra.imagDataF,
+                                        gyroSpectra.realDataF, gyroSpectra.imagDataF,
+                                        (size_t)windowCount, (size_t)paddedLength,
+                                        invSNLow, invSNLow + paddedLength / 2 + 1,
+                                        (size_t)rlen, activeWindows, cancel, single);
+        if (deconvolved) {
+            vDSP_vspdp(single, 1, deconv, 1, (vDSP_Length)(windowCount * rlen));
+        }
+        free(single);
+        return deconvolved;
+    }
+
+    BOOL deconvolved = [self.wienerDeconvolution deconvolveInputSpectrumReal:inputSpectra.realData
+                                                                   inputImag:inputSpectra.imagData
+                                                          outputSpectrumReal:gyroSpectra.realData
+                                                                  outputImag:gyroSpectra.imagData
+                                                                    rowCount:windowCount
+                                                                paddedLength:paddedLength
+                                                                     cutFreq:cutFreq
+                                                                      result:deconv
+                                                                resultLength:rlen
+                                                                  activeRows:activeWindows];
+    if (!deconvolved) {
+        return NO;
+    }
+
+    // 🔍 调试：检查cumsum之前的值（详细版本）
+    if (rlen >= 5) {
+        double minVal, maxVal;
+        vDSP_minvD(deconv, 1, &minVal, (vDSP_Length)rlen);
+        vDSP_maxvD(deconv, 1, &maxVal, (vDSP_Length)rlen);
+        NSLog(@"🔍 [cumsum之前] 反卷积结果范围: [%.3f, %.3f], 前5个值: %.3f, %.3f, %.3f, %.3f, %.3f",
+              minVal, maxVal, deconv[0], deconv[1], deconv[2], deconv[3], deconv[4]);
+    }
+
+    // 直接对脉冲响应原地做累积和（每行独立，按行并行；块内每4行占一个向量的4个通道；跳过的行为零，累积和仍为零）
+    // 注意：不去除DC偏移，Python也是直接cumsum
+    size_t chunkCount = PIDParallelChunkCount((size_t)windowCount, 16);
+    PIDParallelForEach(chunkCount, ^(size_t chunk) {
+        NSInteger begin = (NSInteger)(chunk * (size_t)windowCount / chunkCount);
+        NSInteger end = (NSInteger)((chunk + 1) * (size_t)windowCount / chunkCount);
+        NSInteger i = begin;
+        for (; i + PIDAxisLaneCount <= end; i += PIDAxisLaneCount) {
+            double *rows[PIDAxisLaneCount] = {
+                deconv + i * rlen, deconv + (i + 1) * rlen, deconv + (i + 2) * rlen, deconv + (i + 3) * rlen,
+            };
+            PIDMultiAxisCumulativeSum(rows, (size_t)rlen);
+        }
+        for (; i < end; i++) {
+            PIDCumulativeSumD(deconv + i * rlen, (size_t)rlen);
+        }
+    });
+    return YES;
+}
+
+- (PIDResponseResult *)stackResponseWithSpectralCache:(PIDSpectralCache *)cache {
+    PIDStackData *stacks = cache.stackData;
+    const PIDCancelFlag *cancel = [self cancelFlagForCache:cache];
+    if (!stacks || stacks.windowCount == 0 || PIDCancelFlagIsSet(cancel)) {
+        return [[PIDResponseResult alloc] init];
+    }
+
     NSInteger windowCount = stacks.windowCount;
     NSInteger windowLen = stacks.windowLength;
 
-    // 确保窗函数长度匹配
     // 🔧 修复: 使用Hanning窗（与Python版本一致）
     // Python: self.window = np.hanning(self.flen)
-    NSArray<NSNumber *> *win = window;
-    if (win.count != windowLen) {
-        // 如果不匹配，重新生成Hanning窗函数
-        win = [PIDTraceAnalyzer hanningWindowWithLength:windowLen];
-    }
+    NSArray<NSNumber *> *win = cache.window;
+    const double *winBuffer = [cache windowValues];
 
     // 🔍 调试：打印窗口0的原始输入数据（应用Hanning窗之前）
-    if (windowCount > 0) {
-        NSArray<NSNumber *> *rawIn = stacks.input[0];
-        NSArray<NSNumber *> *rawOut = stacks.gyro[0];
+    if (windowCount > 0 && windowLen >= 5) {
+        const double *rawIn = [stacks inputWindowAtIndex:0];
+        const double *rawOut = [stacks gyroWindowAtIndex:0];
 
         // 计算输入数据范围
-        double inMin = [rawIn[0] doubleValue], inMax = inMin;
-        for (NSNumber *n in rawIn) {
-            double v = [n doubleValue];
-            if (v < inMin) inMin = v;
-            if (v > inMax) inMax = v;
-        }
-
-        double outMin = [rawOut[0] doubleValue], outMax = outMin;
-        for (NSNumber *n in rawOut) {
-            double v = [n doubleValue];
-            if (v < outMin) outMin = v;
-            if (v > outMax) outMax = v;
-        }
+        double inMin, inMax, outMin, outMax;
+        vDSP_minvD(rawIn, 1, &inMin, (vDSP_Length)windowLen);
+        vDSP_maxvD(rawIn, 1, &inMax, (vDSP_Length)windowLen);
+        vDSP_minvD(rawOut, 1, &outMin, (vDSP_Length)windowLen);
+        vDSP_maxvD(rawOut, 1, &outMax, (vDSP_Length)windowLen);
 
         NSLog(@"🔍 [原始数据窗口0] input范围: [%.3f, %.3f], 前5个值: %.3f, %.3f, %.3f, %.3f, %.3f",
-              inMin, inMax,
-              [rawIn[0] doubleValue], [rawIn[1] doubleValue], [rawIn[2] doubleValue],
-              [rawIn[3] doubleValue], [rawIn[4] doubleValue]);
+              inMin, inMax, rawIn[0], rawIn[1], rawIn[2], rawIn[3], rawIn[4]);
         NSLog(@"🔍 [原始数据窗口0] gyro(output)范围: [%.3f, %.3f], 前5个值: %.3f, %.3f, %.3f, %.3f, %.3f",
-              outMin, outMax,
-              [rawOut[0] doubleValue], [rawOut[1] doubleValue], [rawOut[2] doubleValue],
-              [rawOut[3] doubleValue], [rawOut[4] doubleValue]);
+              outMin, outMax, rawOut[0], rawOut[1], rawOut[2], rawOut[3], rawOut[4]);
 
         // Hanning窗前5个值
         NSMutableString *winStr = [NSMutableString string];
@@ -368,129 +2828,100 @@ static const double kP_SCALE_FACTOR = 0.032029;
         NSLog(@"🔍 [Hanning窗] 前5个值: %@", winStr);
     }
 
-    // 应用窗函数
-    NSMutableArray<NSArray<NSNumber *> *> *inp = [NSMutableArray arrayWithCapacity:windowCount];
-    NSMutableArray<NSArray<NSNumber *> *> *outp = [NSMutableArray arrayWithCapacity:windowCount];
-    NSMutableArray<NSArray<NSNumber *> *> *thr = [NSMutableArray arrayWithCapacity:windowCount];
+    // 分析参数在入口处取一次快照，分析过程中不再读取可变属性
+    NSInteger rlen = MIN(self.responseLen, windowLen);
+    double cutFreq = self.cutFreq;
+    PIDDSPPrecision precision = self.precision;
+
+    // 阶跃响应矩阵、统计量（加窗后的平均/最大输入、最大油门、平均时间）与调试缓冲区一次分配
+    double *matrix = (double *)malloc((windowCount * rlen + 4 * windowCount + 2 * windowLen) * sizeof(double));
+    double *deconv = matrix;
+    double *maxInValues = deconv + windowCount * rlen;
+    double *avgInValues = maxInValues + windowCount;
+    double *maxThrValues = avgInValues + windowCount;
+    double *avgTValues = maxThrValues + windowCount;
+    double *windowed = avgTValues + windowCount;
+    double *windowedGyro = windowed + windowLen;
+
+    if (![self windowStatisticsForStacks:stacks
+                                  window:winBuffer
+                                  cancel:cancel
+                                maxInput:maxInValues
+                                avgInput:avgInValues
+                             maxThrottle:maxThrValues
+                                 avgTime:avgTValues]) {
+        free(matrix);
+        return [[PIDResponseResult alloc] init];
+    }
 
-    for (NSInteger i = 0; i < windowCount; i++) {
-        [inp addObject:[self multiplyArray:stacks.input[i] by:win]];
-        [outp addObject:[self multiplyArray:stacks.gyro[i] by:win]];
-        [thr addObject:[self multiplyArray:stacks.throttle[i] by:win]];
+    // 活动度预筛：统计量在任何FFT之前已经算出。max_in ≤ 20（NaN除外）的窗口不属于lowHighMask的任何一组，
+    // 也不参与参考响应和resp_quality，跳过它们的反卷积不改变响应曲线
+    NS_VALID_UNTIL_END_OF_SCOPE NSMutableData *activeData = nil;
+    NSInteger prunedCount = 0;
+    if (self.pruneInactiveWindows) {
+        activeData = [NSMutableData dataWithLength:windowCount * sizeof(bool)];
+        bool *active = activeData.mutableBytes;
+        for (NSInteger i = 0; i < windowCount; i++) {
+            active[i] = !(maxInValues[i] <= kActiveInputThreshold);
+            prunedCount += active[i] ? 0 : 1;
+        }
+        NSLog(@"⏱️ 活动度预筛: 跳过%ld/%ld个窗口的反卷积 (max_in ≤ %.0f)",
+              (long)prunedCount, (long)windowCount, kActiveInputThreshold);
+        if (prunedCount == 0) {
+            activeData = nil;
+        }
     }
 
-    // 🔍 调试：打印应用Hanning窗后的输入数据
-    if (inp.count > 0) {
-        NSArray<NSNumber *> *winIn = inp[0];
-        NSArray<NSNumber *> *winOut = outp[0];
+    NSArray<NSNumber *> *maxIn = [self arrayFromBuffer:maxInValues length:windowCount];
+    NSArray<NSNumber *> *avgIn = [self arrayFromBuffer:avgInValues length:windowCount];
+    NSArray<NSNumber *> *maxThr = [self arrayFromBuffer:maxThrValues length:windowCount];
+    NSArray<NSNumber *> *avgT = [self arrayFromBuffer:avgTValues length:windowCount];
 
-        double winInMin = [winIn[0] doubleValue], winInMax = winInMin;
-        for (NSNumber *n in winIn) {
-            double v = [n doubleValue];
-            if (v < winInMin) winInMin = v;
-            if (v > winInMax) winInMax = v;
-        }
+    // 🔍 调试：打印应用Hanning窗后的输入数据
+    if (windowLen >= 5) {
+        vDSP_vmulD([stacks inputWindowAtIndex:0], 1, winBuffer, 1, windowed, 1, (vDSP_Length)windowLen);
+        vDSP_vmulD([stacks gyroWindowAtIndex:0], 1, winBuffer, 1, windowedGyro, 1, (vDSP_Length)windowLen);
 
-        double winOutMin = [winOut[0] doubleValue], winOutMax = winOutMin;
-        for (NSNumber *n in winOut) {
-            double v = [n doubleValue];
-            if (v < winOutMin) winOutMin = v;
-            if (v > winOutMax) winOutMax = v;
-        }
+        double winInMin, winInMax, winOutMin, winOutMax;
+        vDSP_minvD(windowed, 1, &winInMin, (vDSP_Length)windowLen);
+        vDSP_maxvD(windowed, 1, &winInMax, (vDSP_Length)windowLen);
+        vDSP_minvD(windowedGyro, 1, &winOutMin, (vDSP_Length)windowLen);
+        vDSP_maxvD(windowedGyro, 1, &winOutMax, (vDSP_Length)windowLen);
 
         NSLog(@"🔍 [加窗后窗口0] input范围: [%.6f, %.6f], 前5个值: %.6f, %.6f, %.6f, %.6f, %.6f",
-              winInMin, winInMax,
-              [winIn[0] doubleValue], [winIn[1] doubleValue], [winIn[2] doubleValue],
-              [winIn[3] doubleValue], [winIn[4] doubleValue]);
+              winInMin, winInMax, windowed[0], windowed[1], windowed[2], windowed[3], windowed[4]);
         NSLog(@"🔍 [加窗后窗口0] gyro范围: [%.6f, %.6f], 前5个值: %.6f, %.6f, %.6f, %.6f, %.6f",
-              winOutMin, winOutMax,
-              [winOut[0] doubleValue], [winOut[1] doubleValue], [winOut[2] doubleValue],
-              [winOut[3] doubleValue], [winOut[4] doubleValue]);
-    }
-
-    // 维纳反卷积
-    PIDWienerResult *deconvResult = [self.wienerDeconvolution deconvolveWithInput:inp
-                                                                       output:outp
-                                                                       cutFreq:self.cutFreq];
-
-    // 🔍 调试：检查反卷积结果
-    NSLog(@"🔍 反卷积结果: rowCount=%lu, columnCount=%ld",
-          (unsigned long)deconvResult.data.count, (long)deconvResult.columnCount);
-    if (deconvResult.data.count > 0 && deconvResult.data[0].count > 0) {
-        NSArray<NSNumber *> *firstRow = deconvResult.data[0];
-        NSInteger n = MIN(10, firstRow.count);
-        NSMutableString *values = [NSMutableString string];
-        for (NSInteger i = 0; i < n; i++) {
-            [values appendFormat:@"%.4f ", [firstRow[i] doubleValue]];
-        }
-        NSLog(@"🔍 反卷积data[0]前%ld个值: %@", (long)n, values);
-
-        // 计算反卷积结果的范围
-        double minVal = [firstRow[0] doubleValue];
-        double maxVal = [firstRow[0] doubleValue];
-        for (NSNumber *num in firstRow) {
-            double v = [num doubleValue];
-            if (v < minVal) minVal = v;
-            if (v > maxVal) maxVal = v;
-        }
-        NSLog(@"🔍 反卷积data[0]范围: min=%.4f, max=%.4f", minVal, maxVal);
-    }
-
-    // 截取指定长度
-    NSMutableArray<NSArray<NSNumber *> *> *truncatedDeconv = [NSMutableArray arrayWithCapacity:windowCount];
-    NSInteger rlen = MIN(self.responseLen, deconvResult.columnCount);
-    for (NSArray<NSNumber *> *row in deconvResult.data) {
-        NSArray<NSNumber *> *truncatedRow = [row subarrayWithRange:NSMakeRange(0, MIN(rlen, row.count))];
-        [truncatedDeconv addObject:truncatedRow];
+              winOutMin, winOutMax, windowedGyro[0], windowedGyro[1], windowedGyro[2], windowedGyro[3], windowedGyro[4]);
     }
 
     // 累积和 (cumsum = 阶跃响应)
     // 🔧 修复: 对齐Python实现，直接对脉冲响应做cumsum
     // Python: delta_resp = deconvolved_sm.cumsum(axis=1)
     // 不再做基准面调整（减去第一个值），因为这会导致负累积
+    NSInteger paddedLength = [self.wienerDeconvolution paddedLengthForLength:windowLen];
+    BOOL deconvolved = [self stepResponsesFromCache:cache
+                                       paddedLength:paddedLength
+                                            cutFreq:cutFreq
+                                          precision:precision
+                                      activeWindows:activeData
+                                             cancel:cancel
+                                             result:deconv
+                                       resultLength:rlen];
+
+    // 取消时反卷积返回失败；逐窗口装箱本身也较慢，同样在窗口之间检查
     NSMutableArray<NSArray<NSNumber *> *> *stepResponse = [NSMutableArray arrayWithCapacity:windowCount];
-
-    // 🔍 调试：检查cumsum之前的值（详细版本）
-    if (truncatedDeconv.count > 0 && truncatedDeconv[0].count > 0) {
-        NSArray<NSNumber *> *firstRow = truncatedDeconv[0];
-        double minVal = [firstRow[0] doubleValue], maxVal = minVal;
-        for (NSNumber *num in firstRow) {
-            double v = [num doubleValue];
-            if (v < minVal) minVal = v;
-            if (v > maxVal) maxVal = v;
+    NSData *stepResponseData = nil;
+    if (deconvolved) {
+        for (NSInteger i = 0; i < windowCount && !PIDCancelFlagIsSet(cancel); i++) {
+            [stepResponse addObject:[self arrayFromBuffer:deconv + i * rlen length:rlen]];
         }
-        NSLog(@"🔍 [cumsum之前] 反卷积结果范围: [%.3f, %.3f], 前5个值: %.3f, %.3f, %.3f, %.3f, %.3f",
-              minVal, maxVal,
-              [firstRow[0] doubleValue], [firstRow[1] doubleValue], [firstRow[2] doubleValue],
-              [firstRow[3] doubleValue], [firstRow[4] doubleValue]);
+        stepResponseData = [NSData dataWithBytes:deconv length:windowCount * rlen * sizeof(double)];
     }
 
-    for (NSArray<NSNumber *> *row in truncatedDeconv) {
-        if (row.count == 0) {
-            [stepResponse addObject:@[]];
-            continue;
-        }
-
-        // 直接对脉冲响应做累积和
-        // Python: delta_resp = deconvolved_sm.cumsum(axis=1)
-        // 注意：不去除DC偏移，Python也是直接cumsum
-        NSArray<NSNumber *> *cumsum = [PIDInterpolation cumsum:row];
+    free(matrix);
 
-        [stepResponse addObject:cumsum];
-
-        // 🔍 调试：打印第一个窗口的cumsum结果
-        if (stepResponse.count == 1) {
-            NSMutableString *s = [NSMutableString string];
-            NSInteger n = MIN(10, cumsum.count);
-            for (NSInteger i = 0; i < n; i++) {
-                [s appendFormat:@"%.3f ", [cumsum[i] doubleValue]];
-            }
-            NSLog(@"🔍 [cumsum结果] 窗口0前%ld个值: %@", (long)n, s);
-            NSLog(@"🔍 [cumsum结果] 起点=%.3f, 终点=%.3f, 跨度=%.3f",
-                  [cumsum[0] doubleValue],
-                  [cumsum[cumsum.count-1] doubleValue],
-                  [cumsum[cumsum.count-1] doubleValue] - [cumsum[0] doubleValue]);
-        }
+    if (PIDCancelFlagIsSet(cancel)) {
+        return [[PIDResponseResult alloc] init];
     }
 
     // 🔍 调试：检查阶跃响应结果
@@ -540,119 +2971,682 @@ static const double kP_SCALE_FACTOR = 0.032029;
         }
     }
 
-    // 计算统计量
-    NSMutableArray<NSNumber *> *maxThr = [NSMutableArray arrayWithCapacity:windowCount];
-    NSMutableArray<NSNumber *> *avgIn = [NSMutableArray arrayWithCapacity:windowCount];
-    NSMutableArray<NSNumber *> *maxIn = [NSMutableArray arrayWithCapacity:windowCount];
-    NSMutableArray<NSNumber *> *avgT = [NSMutableArray arrayWithCapacity:windowCount];
-
-    for (NSInteger i = 0; i < windowCount; i++) {
-        // 最大油门
-        double maxTh = [self maxAbsInArray:thr[i]];
-        [maxThr addObject:@(maxTh)];
-
-        // 平均/最大输入
-        [avgIn addObject:@([self meanAbs:inp[i]])];
-        [maxIn addObject:@([self maxAbsInArray:inp[i]])];
-
-        // 平均时间
-        [avgT addObject:@([self meanOfArray:stacks.time[i]])];
-    }
-
     // 构建结果
     PIDResponseResult *result = [[PIDResponseResult alloc] init];
     result.stepResponse = stepResponse;
+    result.stepResponseData = stepResponseData;
     result.avgTime = avgT;
     result.avgInput = avgIn;
     result.maxInput = maxIn;
     result.maxThrottle = maxThr;
+    result.prunedWindowCount = prunedCount;
+
+    // 🔍 调试：打印maxInput的范围，帮助诊断low_high_mask问题
+    if (maxIn.count > 0) {
+        double minVal = [maxIn[0] doubleValue];
+        double maxVal = [maxIn[0] doubleValue];
+        for (NSNumber *num in maxIn) {
+            double v = [num doubleValue];
+            if (v < minVal) minVal = v;
+            if (v > maxVal) maxVal = v;
+        }
+        NSLog(@"🔍 [关键] maxInput范围: [%.2f, %.2f]，阈值500将分类: low≤500, high>500", minVal, maxVal);
+
+        // 统计有多少窗口超过500
+        NSInteger highCount = 0;
+        for (NSNumber *num in maxIn) {
+            if ([num doubleValue] > 500.0) {
+                highCount++;
+            }
+        }
+        NSLog(@"🔍 [关键] maxInput > 500 的窗口数: %ld / %lu", (long)highCount, (unsigned long)maxIn.count);
+    }
+
+    NSLog(@"✅ 响应分析完成: %ld窗口", (long)windowCount);
+
+    return result;
+}
+
+#pragma mark - 平均互谱估计
+
+// 每块的累加区：低/高输入两组，每组 Σ|H|²、ΣRe(G·conj(H))、ΣIm(G·conj(H)) 各binCount个点
+static const NSInteger kCrossSpectrumGroups = 2;
+static const NSInteger kCrossSpectrumSumsPerGroup = 3;
+
+// 每块的计数：低输入、高输入（分组条件，与lowHighMask相同）、两组实际累加的窗口数
+typedef NS_ENUM(NSInteger, PIDCrossSpectrumCount) {
+    PIDCrossSpectrumCountLow = 0,
+    PIDCrossSpectrumCountHigh,
+    PIDCrossSpectrumCountLowAccumulated,
+    PIDCrossSpectrumCountHighAccumulated,
+    PIDCrossSpectrumCountTotal,
+};
+
+- (nullable PIDResponseCurves *)averagedCrossSpectrumCurvesWithStackData:(PIDStackData *)stacks {
+    const PIDCancelFlag *cancel = [self.cancellationToken flag];
+    NSInteger windowCount = stacks.windowCount;
+    NSInteger windowLen = stacks.windowLength;
+    if (windowCount == 0 || windowLen == 0 || PIDCancelFlagIsSet(cancel)) {
+        return nil;
+    }
+
+    CFAbsoluteTime startTime = CFAbsoluteTimeGetCurrent();
+
+    // 与逐窗口路径相同的Hanning窗、补零长度与1/sn
+    NSInteger rlen = MIN(self.responseLen, windowLen);
+    NSInteger paddedLength = [self.wienerDeconvolution paddedLengthForLength:windowLen];
+    const PIDFFTPlan *plan = PIDFFTPlanForLength((size_t)paddedLength, PIDFFTBackendAutomatic);
+    if (!plan || rlen <= 0) {
+        return nil;
+    }
+    NSData *windowData = [PIDTraceAnalyzer hanningWindowValuesWithLength:windowLen];
+    const double *winBuffer = windowData.bytes;
+    NS_VALID_UNTIL_END_OF_SCOPE NSData *invSN = [self.wienerDeconvolution inverseSignalToNoiseForLength:paddedLength
+                                                                                                cutFreq:self.cutFreq];
+    NSInteger binCount = paddedLength / 2 + 1;
+    const double *invSNLow = (const double *)invSN.bytes;
+    const double *invSNHigh = invSNLow + binCount;
+
+    // 每块累加到自己的区域，结束后按块序合并：结果与线程调度无关
+    size_t chunkCount = PIDParallelChunkCount((size_t)windowCount, 16);
+    size_t chunkStride = (size_t)(kCrossSpectrumGroups * kCrossSpectrumSumsPerGroup * binCount);
+    double *sums = (double *)calloc(chunkCount * chunkStride, sizeof(double));
+    NSInteger *counts = (NSInteger *)calloc(chunkCount * PIDCrossSpectrumCountTotal, sizeof(NSInteger));
+    if (!sums || !counts) {
+        free(sums);
+        free(counts);
+        return nil;
+    }
+
+    size_t padBytes = (size_t)(paddedLength - windowLen) * sizeof(double);
+    PIDParallelForEach(chunkCount, ^(size_t chunk) {
+        NSInteger begin = (NSInteger)(chunk * (size_t)windowCount / chunkCount);
+        NSInteger end = (NSInteger)((chunk + 1) * (size_t)windowCount / chunkCount);
+        double *chunkSums = sums + chunk * chunkStride;
+        NSInteger *chunkCounts = counts + chunk * PIDCrossSpectrumCountTotal;
+
+        PIDScratchArena *arena = PIDScratchArenaCurrent();
+        PIDScratchArenaReserve(arena, PIDScratchBytesForWindow((size_t)windowLen, (size_t)paddedLength));
+        PIDScratchMark mark = PIDScratchArenaMark(arena);
+        double *buffer = (double *)PIDScratchArenaAlloc(arena, (paddedLength + 4 * binCount) * sizeof(double));
+        double *samples = buffer;
+        double *hReal = buffer + paddedLength;
+        double *hImag = hReal + binCount;
+        double *gReal = hImag + binCount;
+        double *gImag = gReal + binCount;
+
+        for (NSInteger i = begin; i < end && buffer && !PIDCancelFlagIsSet(cancel); i++) {
+            // 加窗输入：最大输入决定分组（max_in ≤ 20 的窗口不参与任何一组，不做FFT）
+            vDSP_vmulD([stacks inputWindowAtIndex:i], 1, winBuffer, 1, samples, 1, (vDSP_Length)windowLen);
+            double maxIn = 0.0;
+            vDSP_maxmgvD(samples, 1, &maxIn, (vDSP_Length)windowLen);
+            if (maxIn <= kActiveInputThreshold) {
+                continue;
+            }
+            BOOL high = !(maxIn <= kHighInputThreshold);
+            chunkCounts[high ? PIDCrossSpectrumCountHigh : PIDCrossSpectrumCountLow]++;
+
+            memset(samples + windowLen, 0, padBytes);
+            PIDFFTRealForward(plan, samples, hReal, hImag);
+
+            vDSP_vmulD([stacks gyroWindowAtIndex:i], 1, winBuffer, 1, samples, 1, (vDSP_Length)windowLen);
+            memset(samples + windowLen, 0, padBytes);
+            PIDFFTRealForward(plan, samples, gReal, gImag);
+
+            // 直流分量是全部样本之和：含NaN/Inf的窗口不累加（逐窗口路径中这类窗口同样落在直方图之外）
+            if (!isfinite(hReal[0]) || !isfinite(gReal[0])) {
+                continue;
+            }
+            chunkCounts[high ? PIDCrossSpectrumCountHighAccumulated : PIDCrossSpectrumCountLowAccumulated]++;
+            double *group = chunkSums + (high ? 1 : 0) * kCrossSpectrumSumsPerGroup * binCount;
+            PIDCrossSpectrumAccumulateD(group, group + binCount, group + 2 * binCount,
+                                        hReal, hImag, gReal, gImag, (size_t)binCount);
+        }
+
+        PIDScratchArenaReset(arena, mark);
+    });
+
+    if (PIDCancelFlagIsSet(cancel)) {
+        free(sums);
+        free(counts);
+        return nil;
+    }
+
+    // 按块序合并到第0块
+    for (size_t chunk = 1; chunk < chunkCount; chunk++) {
+        vDSP_vaddD(sums, 1, sums + chunk * chunkStride, 1, sums, 1, (vDSP_Length)chunkStride);
+        for (NSInteger c = 0; c < PIDCrossSpectrumCountTotal; c++) {
+            counts[c] += counts[chunk * PIDCrossSpectrumCountTotal + c];
+        }
+    }
+
+    // 分组条件与PIDResponseCurveBuilder相同：有效窗口或高输入窗口少于10个时该组不输出
+    NSInteger lowCount = counts[PIDCrossSpectrumCountLow];
+    NSInteger highCount = counts[PIDCrossSpectrumCountHigh];
+    BOOL lowEnabled = lowCount + highCount >= kMinMaskWindowCount;
+    BOOL highEnabled = lowEnabled && highCount >= kMinMaskWindowCount;
+
+    // 每组一次正则化除法 + 一次逆FFT + 累积和，减去起点与weightedModeAverage一致
+    NSArray<NSNumber *> *(^groupResponse)(NSInteger, NSInteger) = ^NSArray<NSNumber *> *(NSInteger group, NSInteger accumulated) {
+        if (accumulated == 0) {
+            return [PIDResponseCurveBuilder zeroResponseWithLength:rlen];
+        }
+        NSMutableData *work = [NSMutableData dataWithLength:(paddedLength + 2 * binCount) * sizeof(double)];
+        double *samples = work.mutableBytes;
+        double *spectrumReal = samples + paddedLength;
+        double *spectrumImag = spectrumReal + binCount;
+        const double *groupSums = sums + group * kCrossSpectrumSumsPerGroup * binCount;
+        PIDCrossSpectrumDivideD(spectrumReal, spectrumImag,
+                                groupSums, groupSums + binCount, groupSums + 2 * binCount,
+                                1.0 / (double)accumulated, invSNLow, invSNHigh, (size_t)binCount);
+        PIDFFTRealInverse(plan, spectrumReal, spectrumImag, samples);
+        PIDCumulativeSumD(samples, (size_t)rlen);
+        double origin = -samples[0];
+        vDSP_vsaddD(samples, 1, &origin, samples, 1, (vDSP_Length)rlen);
+        return [self arrayFromBuffer:samples length:rlen];
+    };
+
+    PIDResponseCurves *curves = [[PIDResponseCurves alloc] init];
+    curves.windowCount = windowCount;
+    curves.lowWindowCount = lowEnabled ? lowCount : 0;
+    curves.highWindowCount = highEnabled ? highCount : 0;
+    curves.respLow = groupResponse(0, lowEnabled ? counts[PIDCrossSpectrumCountLowAccumulated] : 0);
+    curves.respHigh = highEnabled ? groupResponse(1, counts[PIDCrossSpectrumCountHighAccumulated]) : nil;
+
+    free(sums);
+    free(counts);
+
+    NSLog(@"✅ 平均互谱响应: %ld窗口, 低输入=%ld, 高输入=%ld | 耗时: %.1fms",
+          (long)windowCount, (long)curves.lowWindowCount, (long)curves.highWindowCount,
+          (CFAbsoluteTimeGetCurrent() - startTime) * 1000.0);
+
+    return curves;
+}
+
+#pragma mark - 参数扫描
+
+- (nullable NSArray<PIDResponseCurves *> *)responseCurvesWithSpectralCache:(PIDSpectralCache *)cache
+                                                            parameterSets:(NSArray<PIDResponseParameters *> *)parameterSets {
+    PIDStackData *stacks = cache.stackData;
+    const PIDCancelFlag *cancel = [self cancelFlagForCache:cache];
+    if (!stacks || stacks.windowCount == 0 || parameterSets.count == 0 || PIDCancelFlagIsSet(cancel)) {
+        return nil;
+    }
+
+    CFAbsoluteTime startTime = CFAbsoluteTimeGetCurrent();
+    NSInteger windowCount = stacks.windowCount;
+    NSInteger windowLen = stacks.windowLength;
+    NSInteger defaultLength = self.responseLen;
+    PIDDSPPrecision precision = self.precision;
+
+    // 统计量与参数无关，只算一次
+    NS_VALID_UNTIL_END_OF_SCOPE NSMutableData *statistics = [NSMutableData dataWithLength:4 * windowCount * sizeof(double)];
+    double *maxInValues = statistics.mutableBytes;
+    if (![self windowStatisticsForStacks:stacks
+                                  window:[cache windowValues]
+                                  cancel:cancel
+                                maxInput:maxInValues
+                                avgInput:maxInValues + windowCount
+                             maxThrottle:maxInValues + 2 * windowCount
+                                 avgTime:maxInValues + 3 * windowCount]) {
+        return nil;
+    }
+
+    // max_in ≤ 20 的窗口对任何阈值都不属于低/高输入组，不做反卷积
+    NS_VALID_UNTIL_END_OF_SCOPE NSMutableData *activeData = [NSMutableData dataWithLength:windowCount * sizeof(bool)];
+    bool *active = activeData.mutableBytes;
+    for (NSInteger i = 0; i < windowCount; i++) {
+        active[i] = !(maxInValues[i] <= kActiveInputThreshold);
+    }
+
+    // H、G来自缓存：同一缓存的后续扫描不再做正向FFT
+    NSInteger paddedLength = [self.wienerDeconvolution paddedLengthForLength:windowLen];
+
+    NSMutableArray *curves = [NSMutableArray arrayWithCapacity:parameterSets.count];
+    for (NSUInteger k = 0; k < parameterSets.count; k++) {
+        [curves addObject:[NSNull null]];
+    }
+
+    // 按截止频率分组：组内共用一次维纳除法、逆FFT和累积和（累积和的前缀与先截断再累积相同）
+    NSMutableIndexSet *pending = [NSMutableIndexSet indexSetWithIndexesInRange:NSMakeRange(0, parameterSets.count)];
+    NSInteger filterCount = 0;
+    while (pending.count > 0) {
+        double cutFreq = parameterSets[pending.firstIndex].cutFreq;
+        NSIndexSet *group = [pending indexesPassingTest:^BOOL(NSUInteger k, BOOL *stop) {
+            return parameterSets[k].cutFreq == cutFreq;
+        }];
+        [pending removeIndexes:group];
+
+        NS_VALID_UNTIL_END_OF_SCOPE NSMutableData *lengthData = [NSMutableData dataWithLength:group.count * sizeof(NSInteger)];
+        NS_VALID_UNTIL_END_OF_SCOPE NSMutableData *indexData = [NSMutableData dataWithLength:group.count * sizeof(NSUInteger)];
+        NSInteger *lengths = lengthData.mutableBytes;
+        NSUInteger *indices = indexData.mutableBytes;
+        [group getIndexes:indices maxCount:group.count inIndexRange:nil];
+        NSInteger rlen = 0;
+        for (NSUInteger g = 0; g < group.count; g++) {
+            NSInteger length = parameterSets[indices[g]].responseLength;
+            lengths[g] = MIN(length > 0 ? length : defaultLength, windowLen);
+            rlen = MAX(rlen, lengths[g]);
+        }
+        if (rlen <= 0) {
+            return nil;
+        }
+
+        NS_VALID_UNTIL_END_OF_SCOPE NSMutableData *matrix = [NSMutableData dataWithLength:windowCount * rlen * sizeof(double)];
+        double *deconv = matrix.mutableBytes;
+        BOOL deconvolved = [self stepResponsesFromCache:cache
+                                           paddedLength:paddedLength
+                                                cutFreq:cutFreq
+                                              precision:precision
+                                          activeWindows:activeData
+                                                 cancel:cancel
+                                                 result:deconv
+                                           resultLength:rlen];
+        if (!deconvolved) {
+            return nil;
+        }
+        filterCount++;
+
+        // 组内各参数的分组/质量过滤/直方图相互独立，并行构建
+        PIDParallelForEach(PIDCancelFlagIsSet(cancel) ? 0 : group.count, ^(size_t g) {
+            PIDResponseCurveBuilder *builder = [[PIDResponseCurveBuilder alloc] init];
+            builder.highInputThreshold = parameterSets[indices[g]].highInputThreshold;
+            for (NSInteger w = 0; w < windowCount; w++) {
+                [builder addInitialPassWindowValues:deconv + w * rlen length:lengths[g] maxInput:maxInValues[w]];
+            }
+            [builder finishInitialPass];
+            for (NSInteger w = 0; w < windowCount; w++) {
+                [builder addFinalPassWindowValues:deconv + w * rlen length:lengths[g] maxInput:maxInValues[w]];
+            }
+            PIDResponseCurves *result = [builder finishFinalPass];
+            @synchronized (curves) {
+                curves[indices[g]] = result;
+            }
+        });
+
+        if (PIDCancelFlagIsSet(cancel)) {
+            return nil;
+        }
+    }
+
+    NSLog(@"⏱️ 参数扫描: %lu组参数, %ld次维纳滤波, %ld窗口 | 耗时: %.1fms",
+          (unsigned long)parameterSets.count, (long)filterCount, (long)windowCount,
+          (CFAbsoluteTimeGetCurrent() - startTime) * 1000.0);
+
+    return [curves copy];
+}
+
+#pragma mark - 油门分层响应
+
+// 响应-油门热力图分辨率：10个油门箱 × 200个时间箱（0-0.5秒），直方图约8MB
+static const NSInteger kThrottleResponseBins = 10;
+static const NSInteger kThrottleResponseTimeBins = 200;
+
+- (BOOL)fillThrottleResponseForAxisResult:(PIDAxisAnalysisResult *)axisResult
+                       fromResponseResult:(PIDResponseResult *)result {
+    CFAbsoluteTime startTime = CFAbsoluteTimeGetCurrent();
+    NSArray<NSArray<NSNumber *> *> *stepResponse = result.stepResponse;
+    NSArray<NSNumber *> *maxInput = result.maxInput;
+    NSArray<NSNumber *> *maxThrottle = result.maxThrottle;
+    NSInteger windowCount = MIN(stepResponse.count, MIN(maxInput.count, maxThrottle.count));
+    if (!axisResult || windowCount == 0 || stepResponse[0].count == 0) {
+        return NO;
+    }
+    NSInteger responseLength = stepResponse[0].count;
+
+    // 有连续矩阵时直接使用；否则拆箱一次（长度不一致的窗口权重为0）
+    NSMutableData *weightData NS_VALID_UNTIL_END_OF_SCOPE = [NSMutableData dataWithLength:windowCount * sizeof(double)];
+    NSMutableData *throttleData NS_VALID_UNTIL_END_OF_SCOPE = [NSMutableData dataWithLength:windowCount * sizeof(double)];
+    double *weights = weightData.mutableBytes;
+    double *throttle = throttleData.mutableBytes;
+    NSData *matrix = result.stepResponseData;
+    BOOL contiguous = matrix.length == (NSUInteger)(stepResponse.count * responseLength) * sizeof(double);
+    NSMutableData *values NS_VALID_UNTIL_END_OF_SCOPE = contiguous ? nil
+        : [NSMutableData dataWithLength:windowCount * responseLength * sizeof(double)];
+
+    double throttleScale = 100.0 / (kThrottleCommandMax - kThrottleCommandMin);
+    for (NSInteger w = 0; w < windowCount; w++) {
+        // 只计入 max_in > 20 的窗口（NaN不计入）
+        weights[w] = [maxInput[w] doubleValue] > kActiveInputThreshold ? 1.0 : 0.0;
+        throttle[w] = ([maxThrottle[w] doubleValue] - kThrottleCommandMin) * throttleScale;
+        if (values) {
+            NSArray<NSNumber *> *window = stepResponse[w];
+            if (window.count != responseLength) {
+                weights[w] = 0.0;
+                continue;
+            }
+            double *row = (double *)values.mutableBytes + w * responseLength;
+            NSInteger index = 0;
+            for (NSNumber *num in window) {
+                row[index++] = [num doubleValue];
+            }
+        }
+    }
+
+    PIDThrottleResponseHistogram *histogram =
+        [[PIDThrottleResponseHistogram alloc] initWithThrottleBins:kThrottleResponseBins
+                                                          timeBins:kThrottleResponseTimeBins
+                                                    responseLength:responseLength
+                                                         vertRange:[PIDResponseCurveBuilder responseVertRange]
+                                                          vertBins:kResponseVertBins];
+    [histogram addResponseMatrix:contiguous ? matrix.bytes : values.bytes
+                     windowCount:windowCount
+                        throttle:throttle
+                         weights:weights];
+
+    axisResult.responseHeatmap = [histogram responseHeatmap];
+    axisResult.throttleBins = [histogram throttleAxis];
+    axisResult.responseTime = [histogram timeAxis];
+
+    NSLog(@"⏱️ 油门分层响应: %ld窗口(计入%ld) → %ld油门箱 × %ld时间箱 | 耗时: %.1fms",
+          (long)windowCount, (long)histogram.windowCount, (long)histogram.throttleBins, (long)histogram.timeBins,
+          (CFAbsoluteTimeGetCurrent() - startTime) * 1000.0);
+    return YES;
+}
+
+#pragma mark - 频谱分析
+
+/**
+ * 计算噪声频谱
+ * 对应Python: spectrum(time, traces)
+ */
+- (PIDSpectrumResult *)spectrumWithTime:(NSArray<NSNumber *> *)time
+                                traces:(NSArray<NSArray<NSNumber *> *> *)traces {
+    if (!time || !traces || traces.count == 0) {
+        return [[PIDSpectrumResult alloc] init];
+    }
+
+    NSInteger traceLen = traces[0].count;
+
+    // Padding到1024的倍数
+    NSInteger pad = 1024 - (traceLen % 1024);
+    NSInteger paddedLen = traceLen + pad;
+
+    // 补零后直接按paddedLen做一次实数FFT（混合基长度，不再二次补到2的幂次）
+    const PIDFFTPlan *plan = PIDFFTPlanForLength((size_t)paddedLen, PIDFFTBackendAutomatic);
+    if (!plan) {
+        return [[PIDSpectrumResult alloc] init];
+    }
+
+    // 一次从暂存区分配：补零输入 + 频谱实部/虚部 [0, n/2]
+    NSInteger halfLen = (paddedLen + 1) / 2;
+    NSInteger binCount = paddedLen / 2 + 1;
+    PIDScratchArena *arena = PIDScratchArenaCurrent();
+    PIDScratchMark mark = PIDScratchArenaMark(arena);
+    double *buffer = (double *)PIDScratchArenaAlloc(arena, (paddedLen + 2 * binCount) * sizeof(double));
+    if (!buffer) {
+        return [[PIDSpectrumResult alloc] init];
+    }
+    double *samples = buffer;
+    double *specReal = buffer + paddedLen;
+    double *specImag = specReal + binCount;
+
+    // 频率数组（只取前一半，实数FFT的频率范围）
+    double dt = [time[1] doubleValue] - [time[0] doubleValue];
+    NSArray<NSNumber *> *freqs = [self.fftProcessor fftfreqWithLength:paddedLen dt:dt];
+    NSInteger halfFreqLen = (freqs.count + 1) / 2;
+    NSArray<NSNumber *> *halfFreqs = [freqs subarrayWithRange:NSMakeRange(0, halfFreqLen)];
+    PIDSpectrumAccumulator *accumulator = [[PIDSpectrumAccumulator alloc] initWithFrequencies:halfFreqs];
+
+    // 计算频谱（只取前一半，实数FFT的对称性）
+    NSMutableArray<NSArray<NSNumber *> *> *spectrum = [NSMutableArray arrayWithCapacity:traces.count];
+
+    for (NSArray<NSNumber *> *trace in traces) {
+        NSInteger count = MIN((NSInteger)trace.count, paddedLen);
+        for (NSInteger i = 0; i < count; i++) {
+            samples[i] = [trace[i] doubleValue];
+        }
+        memset(samples + count, 0, (paddedLen - count) * sizeof(double));
+
+        PIDFFTRealForward(plan, samples, specReal, specImag);
+
+        [spectrum addObject:[self arrayFromBuffer:specReal length:halfLen]];
+        // 没有油门信息，只计入平均谱
+        [accumulator addWindowSpectrum:specReal throttle:NAN];
+    }
+
+    PIDScratchArenaReset(arena, mark);
+
+    PIDSpectrumResult *result = [[PIDSpectrumResult alloc] init];
+    result.frequencies = halfFreqs;
+    result.spectrum = spectrum;
+    result.accumulator = accumulator;
+
+    NSLog(@"✅ 频谱分析完成: %lu追踪, %lu频率点",
+          (unsigned long)spectrum.count, (unsigned long)halfFreqs.count);
+
+    return result;
+}
+
+- (PIDSpectrumResult *)spectrumWithTime:(NSArray<NSNumber *> *)time
+                         spectralCache:(PIDSpectralCache *)cache {
+    NSInteger traceLen = cache.stackData.windowLength;
+    const PIDCancelFlag *cancel = [self cancelFlagForCache:cache];
+    if (!time || time.count < 2 || cache.stackData.windowCount == 0 || traceLen == 0) {
+        return [[PIDSpectrumResult alloc] init];
+    }
 
-    // 🔍 调试：打印maxInput的范围，帮助诊断low_high_mask问题
-    if (maxIn.count > 0) {
-        double minVal = [maxIn[0] doubleValue];
-        double maxVal = [maxIn[0] doubleValue];
-        for (NSNumber *num in maxIn) {
-            double v = [num doubleValue];
-            if (v < minVal) minVal = v;
-            if (v > maxVal) maxVal = v;
-        }
-        NSLog(@"🔍 [关键] maxInput范围: [%.2f, %.2f]，阈值500将分类: low≤500, high>500", minVal, maxVal);
+    // 与spectrumWithTime:traces:相同的padding；长度与精度都与反卷积相同时直接复用其陀螺仪频谱
+    NSInteger paddedLen = traceLen + (1024 - (traceLen % 1024));
+    PIDDSPPrecision precision = self.precision;
+    PIDWindowSpectra *gyroSpectra = [cache spectraForTrace:PIDSpectralTraceGyro
+                                                    window:PIDSpectralWindowAnalysis
+                                              paddedLength:paddedLen
+                                                 precision:precision
+                                             activeWindows:nil];
+    if (!gyroSpectra) {
+        return [[PIDSpectrumResult alloc] init];
+    }
 
-        // 统计有多少窗口超过500
-        NSInteger highCount = 0;
-        for (NSNumber *num in maxIn) {
-            if ([num doubleValue] > 500.0) {
-                highCount++;
-            }
+    // 频率数组（只取前一半）
+    double dt = [time[1] doubleValue] - [time[0] doubleValue];
+    NSArray<NSNumber *> *freqs = [self.fftProcessor fftfreqWithLength:paddedLen dt:dt];
+    NSArray<NSNumber *> *halfFreqs = [freqs subarrayWithRange:NSMakeRange(0, (freqs.count + 1) / 2)];
+
+    // 每个窗口的油门：abs(throttle·window)的最大值（对应stackspectrum的avr_thr），窗口间并行
+    PIDStackData *stacks = cache.stackData;
+    NSInteger windowCount = gyroSpectra.windowCount;
+    double *windowThrottle = [self spectrumThrottleForStacks:stacks window:cache.windowValues cancel:cancel];
+
+    // 频谱逐窗口折叠进累加器（只取前一半，实数FFT的对称性）；需要时才保留装箱的逐窗口矩阵
+    NSInteger halfLen = (paddedLen + 1) / 2;
+    BOOL retainsWindowSpectra = self.retainsWindowSpectra;
+    NSMutableArray<NSArray<NSNumber *> *> *spectrum = [NSMutableArray arrayWithCapacity:retainsWindowSpectra ? windowCount : 0];
+    PIDSpectrumAccumulator *accumulator = [[PIDSpectrumAccumulator alloc] initWithFrequencies:halfFreqs];
+    // float32频谱逐行转换为双精度后累加（累加器与结果数组保持双精度）
+    NSInteger binCount = gyroSpectra.binCount;
+    NS_VALID_UNTIL_END_OF_SCOPE NSMutableData *widenedData = nil;
+    if (precision == PIDDSPPrecisionFloat32) {
+        widenedData = [NSMutableData dataWithLength:binCount * sizeof(double)];
+    }
+    double *widened = widenedData.mutableBytes;
+    for (NSInteger i = 0; i < windowCount && !PIDCancelFlagIsSet(cancel); i++) {
+        const double *row = widened;
+        if (widened) {
+            vDSP_vspdp(gyroSpectra.realDataF + i * binCount, 1, widened, 1, (vDSP_Length)binCount);
+        } else {
+            row = gyroSpectra.realData + i * binCount;
+        }
+        [accumulator addWindowSpectrum:row throttle:windowThrottle ? windowThrottle[i] : NAN];
+        if (retainsWindowSpectra) {
+            [spectrum addObject:[self arrayFromBuffer:row length:halfLen]];
         }
-        NSLog(@"🔍 [关键] maxInput > 500 的窗口数: %ld / %lu", (long)highCount, (unsigned long)maxIn.count);
     }
+    free(windowThrottle);
 
-    NSLog(@"✅ 响应分析完成: %ld窗口", (long)windowCount);
+    if (PIDCancelFlagIsSet(cancel)) {
+        return [[PIDSpectrumResult alloc] init];
+    }
+
+    PIDSpectrumResult *result = [[PIDSpectrumResult alloc] init];
+    result.frequencies = halfFreqs;
+    result.spectrum = spectrum;
+    result.accumulator = accumulator;
+
+    NSLog(@"✅ 频谱分析完成: %ld追踪, %lu频率点 (频谱缓存: FFT %ld次, 复用%ld次)",
+          (long)accumulator.windowCount, (unsigned long)halfFreqs.count,
+          (long)cache.transformCount, (long)cache.reuseCount);
 
     return result;
 }
 
-#pragma mark - 频谱分析
-
 /**
- * 计算噪声频谱
- * 对应Python: spectrum(time, traces)
+ * 窗口油门百分比：rcCommand[3] 的 [1000, 2000] 映射到 [0, 100] 后乘分析窗，取绝对值最大
+ * @return 长度为windowCount的缓冲区（调用方free）；内存不足时返回NULL
  */
-- (PIDSpectrumResult *)spectrumWithTime:(NSArray<NSNumber *> *)time
-                                traces:(NSArray<NSArray<NSNumber *> *> *)traces {
-    if (!time || !traces || traces.count == 0) {
-        return [[PIDSpectrumResult alloc] init];
+- (nullable double *)spectrumThrottleForStacks:(PIDStackData *)stacks
+                                        window:(const double *)window
+                                        cancel:(const PIDCancelFlag *)cancel {
+    NSInteger windowCount = stacks.windowCount;
+    NSInteger windowLen = stacks.windowLength;
+    double *throttle = (double *)malloc(MAX(windowCount, 1) * sizeof(double));
+    if (!throttle || !window) {
+        free(throttle);
+        return NULL;
     }
 
-    NSInteger traceLen = traces[0].count;
+    size_t chunkCount = PIDParallelChunkCount((size_t)windowCount, 16);
+    PIDParallelForEach(chunkCount, ^(size_t chunk) {
+        NSInteger begin = (NSInteger)(chunk * (size_t)windowCount / chunkCount);
+        NSInteger end = (NSInteger)((chunk + 1) * (size_t)windowCount / chunkCount);
+        PIDScratchArena *arena = PIDScratchArenaCurrent();
+        PIDScratchMark mark = PIDScratchArenaMark(arena);
+        double *scratch = (double *)PIDScratchArenaAlloc(arena, windowLen * sizeof(double));
+        double offset = -kThrottleCommandMin;
+        double scale = 100.0 / (kThrottleCommandMax - kThrottleCommandMin);
+
+        for (NSInteger i = begin; i < end && scratch && !PIDCancelFlagIsSet(cancel); i++) {
+            vDSP_vsaddD([stacks throttleWindowAtIndex:i], 1, &offset, scratch, 1, (vDSP_Length)windowLen);
+            vDSP_vsmulD(scratch, 1, &scale, scratch, 1, (vDSP_Length)windowLen);
+            vDSP_vmulD(scratch, 1, window, 1, scratch, 1, (vDSP_Length)windowLen);
+            vDSP_maxmgvD(scratch, 1, &throttle[i], (vDSP_Length)windowLen);
+        }
 
-    // Padding到1024的倍数
-    NSInteger pad = 1024 - (traceLen % 1024);
-    NSInteger paddedLen = traceLen + pad;
+        PIDScratchArenaReset(arena, mark);
+    });
 
-    // Padding数据
-    NSMutableArray<NSArray<NSNumber *> *> *paddedTraces = [NSMutableArray arrayWithCapacity:traces.count];
-    for (NSArray<NSNumber *> *trace in traces) {
-        NSMutableArray<NSNumber *> *padded = [trace mutableCopy];
-        while (padded.count < paddedLen) {
-            [padded addObject:@0.0f];
-        }
-        [paddedTraces addObject:[padded copy]];
-    }
+    return throttle;
+}
 
-    // 计算频谱（使用实数FFT）
-    NSMutableArray<NSArray<NSNumber *> *> *spectrum = [NSMutableArray arrayWithCapacity:traces.count];
+#pragma mark - 多通道噪声频谱
 
-    for (NSArray<NSNumber *> *paddedTrace in paddedTraces) {
-        NSArray<NSNumber *> *spec = [self.fftProcessor realFFT:paddedTrace length:paddedLen];
+// 每批变换输出（全部通道 × 一批窗口的实部行）的字节上限，批之间复用同一块缓冲区
+static const NSUInteger kBatchedSpectrumBlockBytes = 8 * 1024 * 1024;
 
-        // 只取前一半（实数FFT的对称性）
-        NSInteger halfLen = (spec.count + 1) / 2;
-        NSArray<NSNumber *> *halfSpec = [spec subarrayWithRange:NSMakeRange(0, halfLen)];
-        [spectrum addObject:halfSpec];
+- (NSArray<PIDSpectrumAccumulator *> *)spectrumAccumulatorsForChannels:(NSArray<NSData *> *)channels
+                                                                 time:(NSArray<NSNumber *> *)time
+                                                        spectralCache:(PIDSpectralCache *)cache {
+    PIDStackData *stacks = cache.stackData;
+    NSInteger windowCount = stacks.windowCount;
+    NSInteger traceLen = stacks.windowLength;
+    NSInteger channelCount = (NSInteger)channels.count;
+    const PIDCancelFlag *cancel = [self cancelFlagForCache:cache];
+    if (!time || time.count < 2 || windowCount == 0 || traceLen == 0 || channelCount == 0) {
+        return nil;
     }
+    CFAbsoluteTime startTime = CFAbsoluteTimeGetCurrent();
 
-    // 频率数组
+    // 与spectrumWithTime:traces:相同的padding与频率点
+    NSInteger paddedLen = traceLen + (1024 - (traceLen % 1024));
     double dt = [time[1] doubleValue] - [time[0] doubleValue];
     NSArray<NSNumber *> *freqs = [self.fftProcessor fftfreqWithLength:paddedLen dt:dt];
+    NSArray<NSNumber *> *halfFreqs = [freqs subarrayWithRange:NSMakeRange(0, (freqs.count + 1) / 2)];
+
+    // 长度不足以覆盖全部窗口的通道跳过
+    NSInteger spanLength = (windowCount - 1) * stacks.step + traceLen;
+    NSMutableData *columnData NS_VALID_UNTIL_END_OF_SCOPE = [NSMutableData dataWithLength:channelCount * sizeof(const double *)];
+    const double **columns = (const double **)columnData.mutableBytes;
+    NSMutableArray<PIDSpectrumAccumulator *> *accumulators = [NSMutableArray arrayWithCapacity:channelCount];
+    NSInteger transformedChannels = 0;
+    for (NSInteger c = 0; c < channelCount; c++) {
+        if (channels[c].length >= (NSUInteger)spanLength * sizeof(double)) {
+            columns[c] = (const double *)channels[c].bytes;
+            transformedChannels++;
+        }
+        [accumulators addObject:[[PIDSpectrumAccumulator alloc] initWithFrequencies:halfFreqs]];
+    }
 
-    // 只取前一半（实数FFT的频率范围）
-    NSInteger halfFreqLen = (freqs.count + 1) / 2;
-    NSArray<NSNumber *> *halfFreqs = [freqs subarrayWithRange:NSMakeRange(0, halfFreqLen)];
+    // 窗口油门对所有通道相同，只算一次
+    double *windowThrottle = [self spectrumThrottleForStacks:stacks window:cache.windowValues cancel:cancel];
+
+    PIDSpectrumBatch batch;
+    batch.columns = columns;
+    batch.channelCount = (size_t)channelCount;
+    batch.windowCount = (size_t)windowCount;
+    batch.windowLength = (size_t)traceLen;
+    batch.step = (size_t)stacks.step;
+    batch.window = cache.windowValues;
+    batch.paddedLength = (size_t)paddedLen;
+    batch.cancel = cancel;
+
+    // 按批变换：每批先并行做全部通道的FFT，再各通道并行、按窗口顺序折叠进自己的累加器（与逐窗口串行累加的结果一致）
+    NSInteger binCount = (NSInteger)PIDSpectrumBatchBinCount(&batch);
+    NSInteger rowBytes = channelCount * binCount * (NSInteger)sizeof(double);
+    NSInteger blockWindows = MAX((NSInteger)kBatchedSpectrumBlockBytes / rowBytes / PIDSpectrumBatchTileWindows, 1) *
+                             PIDSpectrumBatchTileWindows;
+    blockWindows = MIN(blockWindows, windowCount);
+    NSMutableData *blockData NS_VALID_UNTIL_END_OF_SCOPE = [NSMutableData dataWithLength:blockWindows * rowBytes];
+    double *block = (double *)blockData.mutableBytes;
+    size_t channelStride = (size_t)(blockWindows * binCount);
+
+    BOOL completed = windowThrottle != NULL && block != NULL;
+    for (NSInteger begin = 0; begin < windowCount && completed; begin += blockWindows) {
+        NSInteger end = MIN(begin + blockWindows, windowCount);
+        if (!PIDSpectrumBatchTransform(&batch, (size_t)begin, (size_t)end, block, channelStride)) {
+            completed = NO;
+            break;
+        }
+        PIDParallelForEach((size_t)channelCount, ^(size_t c) {
+            if (!columns[c]) {
+                return;
+            }
+            PIDSpectrumAccumulator *accumulator = accumulators[c];
+            const double *rows = block + c * channelStride;
+            for (NSInteger i = begin; i < end; i++) {
+                [accumulator addWindowSpectrum:rows + (i - begin) * binCount throttle:windowThrottle[i]];
+            }
+        });
+    }
+    free(windowThrottle);
 
-    PIDSpectrumResult *result = [[PIDSpectrumResult alloc] init];
-    result.frequencies = halfFreqs;
-    result.spectrum = spectrum;
+    if (!completed || PIDCancelFlagIsSet(cancel)) {
+        return nil;
+    }
 
-    NSLog(@"✅ 频谱分析完成: %lu追踪, %lu频率点",
-          (unsigned long)spectrum.count, (unsigned long)halfFreqs.count);
+    NSLog(@"⏱️ 多通道频谱: %ld通道 × %ld窗口, FFT %ld次 (每批%ld窗口) | 耗时: %.1fms",
+          (long)transformedChannels, (long)windowCount, (long)(transformedChannels * windowCount),
+          (long)blockWindows, (CFAbsoluteTimeGetCurrent() - startTime) * 1000.0);
 
-    return result;
+    return [accumulators copy];
 }
 
 #pragma mark - 窗函数
 
+/**
+ * 窗函数备忘：同一(类型, 长度, 参数)只生成一次，各轴、各批次和各频谱缓存共用同一个数组
+ * 分析长度只有少数几种（1秒窗口随分析采样率变化），不需要淘汰
+ */
+static NSMutableDictionary<NSString *, id> *PIDWindowMemo(void) {
+    static NSMutableDictionary<NSString *, id> *memo;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        memo = [NSMutableDictionary dictionary];
+    });
+    return memo;
+}
+
+static id PIDMemoizedWindow(NSString *key, id (^build)(void)) {
+    NSMutableDictionary<NSString *, id> *memo = PIDWindowMemo();
+    @synchronized (memo) {
+        id window = memo[key];
+        if (!window) {
+            window = build();
+            memo[key] = window;
+        }
+        return window;
+    }
+}
+
 /**
  * 生成Tukey窗函数
  * 对应Python: tukeywin(len, alpha=0.5)
@@ -673,7 +3667,15 @@ static const double kP_SCALE_FACTOR = 0.032029;
  */
 + (NSArray<NSNumber *> *)tukeyWindowWithLength:(NSInteger)length
                                           alpha:(double)alpha {
-    NSMutableArray<NSNumber *> *window = [NSMutableArray arrayWithCapacity:length];
+    NSString *key = [NSString stringWithFormat:@"tukey/%ld/%.17g", (long)length, alpha];
+    return PIDMemoizedWindow(key, ^id{
+        return [self buildTukeyWindowWithLength:length alpha:alpha];
+    });
+}
+
++ (NSArray<NSNumber *> *)buildTukeyWindowWithLength:(NSInteger)length
+                                              alpha:(double)alpha {
+    NSMutableArray<NSNumber *> *window = [NSMutableArray arrayWithCapacity:MAX(length, 0)];
 
     double alphaN = alpha * length;
     double limit1 = alphaN / 2.0;
@@ -710,7 +3712,26 @@ static const double kP_SCALE_FACTOR = 0.032029;
     if (length <= 0) {
         return @[];
     }
+    NSString *key = [NSString stringWithFormat:@"hanning/%ld", (long)length];
+    return PIDMemoizedWindow(key, ^id{
+        return [self buildHanningWindowWithLength:length];
+    });
+}
+
++ (NSData *)hanningWindowValuesWithLength:(NSInteger)length {
+    NSString *key = [NSString stringWithFormat:@"hanning-values/%ld", (long)length];
+    return PIDMemoizedWindow(key, ^id{
+        NSArray<NSNumber *> *window = [self hanningWindowWithLength:length];
+        NSMutableData *values = [NSMutableData dataWithLength:MAX(window.count, 1) * sizeof(double)];
+        double *dst = values.mutableBytes;
+        for (NSUInteger i = 0; i < window.count; i++) {
+            dst[i] = [window[i] doubleValue];
+        }
+        return [values copy];
+    });
+}
 
++ (NSArray<NSNumber *> *)buildHanningWindowWithLength:(NSInteger)length {
     // 长度为1时返回[1.0]
     if (length == 1) {
         return @[@1.0];
@@ -730,75 +3751,16 @@ static const double kP_SCALE_FACTOR = 0.032029;
 #pragma mark - Helper Methods
 
 /**
- * 数组逐元素乘法
+ * 把double缓冲区装箱为NSArray
  */
-- (NSArray<NSNumber *> *)multiplyArray:(NSArray<NSNumber *> *)array by:(NSArray<NSNumber *> *)factor {
-    if (!array || !factor || array.count != factor.count) {
-        return array ?: @[];
-    }
-
-    NSMutableArray<NSNumber *> *result = [NSMutableArray arrayWithCapacity:array.count];
-
-    for (NSInteger i = 0; i < array.count; i++) {
-        double a = [array[i] doubleValue];
-        double f = [factor[i] doubleValue];
-        [result addObject:@(a * f)];
+- (NSArray<NSNumber *> *)arrayFromBuffer:(const double *)buffer length:(NSInteger)length {
+    NSMutableArray<NSNumber *> *result = [NSMutableArray arrayWithCapacity:length];
+    for (NSInteger i = 0; i < length; i++) {
+        [result addObject:@(buffer[i])];
     }
-
     return [result copy];
 }
 
-/**
- * 计算数组绝对值的最大值
- */
-- (double)maxAbsInArray:(NSArray<NSNumber *> *)array {
-    if (!array || array.count == 0) {
-        return 0.0;
-    }
-
-    double maxVal = 0.0;
-    for (NSNumber *num in array) {
-        double absVal = fabs([num doubleValue]);
-        if (absVal > maxVal) {
-            maxVal = absVal;
-        }
-    }
-
-    return maxVal;
-}
-
-/**
- * 计算数组绝对值的平均
- */
-- (double)meanAbs:(NSArray<NSNumber *> *)array {
-    if (!array || array.count == 0) {
-        return 0.0;
-    }
-
-    double sum = 0.0;
-    for (NSNumber *num in array) {
-        sum += fabs([num doubleValue]);
-    }
-
-    return sum / array.count;
-}
-
-/**
- * 计算数组的平均值
- */
-- (double)meanOfArray:(NSArray<NSNumber *> *)array {
-    if (!array || array.count == 0) {
-        return 0.0;
-    }
-
-    double sum = 0.0;
-    for (NSNumber *num in array) {
-        sum += [num doubleValue];
-    }
-
-    return sum / array.count;
-}
-
 #pragma mark - 数据预处理 (equalize_data)
 
 /**
@@ -825,44 +3787,31 @@ static const double kP_SCALE_FACTOR = 0.032029;
 
     if (targetLength < 2) targetLength = n;
 
-    // 创建均匀时间轴
-    NSMutableArray<NSNumber *> *uniformTime = [NSMutableArray arrayWithCapacity:targetLength];
-    NSMutableArray<NSNumber *> *interpolatedData = [NSMutableArray arrayWithCapacity:targetLength];
+    // 均匀时间轴有序，插值内核走双指针归并，总开销 O(n + targetLength)
+    double *buffer = malloc(sizeof(double) * (2 * n + 2 * targetLength));
+    if (!buffer) {
+        return data;
+    }
+    double *times = buffer;
+    double *values = times + n;
+    double *uniformTime = values + n;
+    double *interpolated = uniformTime + targetLength;
 
+    for (NSInteger i = 0; i < n; i++) {
+        times[i] = [originalTime[i] doubleValue];
+        values[i] = [data[i] doubleValue];
+    }
     for (NSInteger i = 0; i < targetLength; i++) {
-        double t = tStart + (tEnd - tStart) * i / (targetLength - 1);
-        [uniformTime addObject:@(t)];
-
-        // 线性插值
-        double value = 0.0;
+        uniformTime[i] = tStart + (tEnd - tStart) * i / (targetLength - 1);
+    }
 
-        if (t <= [originalTime[0] doubleValue]) {
-            value = [data[0] doubleValue];
-        } else if (t >= [originalTime[n - 1] doubleValue]) {
-            value = [data[n - 1] doubleValue];
-        } else {
-            // 找到t所在的区间 [time[i], time[i+1]]
-            for (NSInteger j = 0; j < n - 1; j++) {
-                double t0 = [originalTime[j] doubleValue];
-                double t1 = [originalTime[j + 1] doubleValue];
-
-                if (t >= t0 && t <= t1) {
-                    double y0 = [data[j] doubleValue];
-                    double y1 = [data[j + 1] doubleValue];
-
-                    if (t1 - t0 > 1e-9) {
-                        // 线性插值: y = y0 + (y1 - y0) * (t - t0) / (t1 - t0)
-                        value = y0 + (y1 - y0) * (t - t0) / (t1 - t0);
-                    } else {
-                        value = y0;
-                    }
-                    break;
-                }
-            }
-        }
+    PIDInterpolateLinear(times, values, n, uniformTime, interpolated, targetLength);
 
-        [interpolatedData addObject:@(value)];
+    NSMutableArray<NSNumber *> *interpolatedData = [NSMutableArray arrayWithCapacity:targetLength];
+    for (NSInteger i = 0; i < targetLength; i++) {
+        [interpolatedData addObject:@(interpolated[i])];
     }
+    free(buffer);
 
     NSLog(@"✅ equalize_data: %ld点 -> %ld点 (时间轴 %.3f ~ %.3fs)",
           (long)n, (long)targetLength, tStart, tEnd);
@@ -951,7 +3900,7 @@ static double getMachFrequency(void) {
  *
  * 🔥 关键修复：
  * 1. 使用物理时间轴（0-0.5秒）代替数组索引
- * 2. 展平所有数据后再构建histogram2d
+ * 2. 逐窗口累加到PIDResponseHistogram（与展平后构建histogram2d结果相同）
  * 3. 完全匹配Python的np.histogram2d行为
  *
  * Python代码参考:
@@ -974,7 +3923,6 @@ static double getMachFrequency(void) {
     // 性能监控：开始时间
     uint64_t startTime = mach_absolute_time();
 
-    // ========== 1. 参数验证 ==========
     if (!stepResponse || stepResponse.count == 0) {
         return @[];
     }
@@ -984,90 +3932,12 @@ static double getMachFrequency(void) {
 
     if (responseLen == 0) return @[];
 
-    // ========== 2. 范围参数 ==========
-    double yMin = [vertRange[0] doubleValue];
-    double yMax = [vertRange[1] doubleValue];
-
-    // 🔍 新增：打印输入参数
-    NSLog(@"🔍 [输入参数] stepResponse: windowCount=%ld, responseLen=%ld",
-          (long)windowCount, (long)responseLen);
-    NSLog(@"🔍 [输入参数] vertRange: [%.2f, %.2f], vertBins=%ld",
-          yMin, yMax, (long)vertBins);
-    NSLog(@"🔍 [输入参数] dataMask: count=%lu",
-          dataMask ? (unsigned long)dataMask.count : 0);
-
-    // 🔍 新增：检查输入数据的范围（前几个窗口）
-    NSLog(@"🔍 [输入数据检查] 检查前3个窗口的stepResponse范围:");
-    for (NSInteger w = 0; w < MIN(3, windowCount); w++) {
-        NSArray<NSNumber *> *windowResp = stepResponse[w];
-        if (windowResp && windowResp.count > 0) {
-            double minVal = [windowResp[0] doubleValue];
-            double maxVal = minVal;
-            for (NSNumber *num in windowResp) {
-                double v = [num doubleValue];
-                if (v < minVal) minVal = v;
-                if (v > maxVal) maxVal = v;
-            }
-            NSLog(@"  窗口[%ld]: 范围=[%.6f, %.6f], 起点=%.6f, 终点=%.6f",
-                  (long)w, minVal, maxVal, [windowResp[0] doubleValue],
-                  [windowResp[windowResp.count-1] doubleValue]);
-        }
-    }
-
-    // ========== 3. 生成time_resp（匹配Python） ==========
-    // Python: self.rlen = self.stepcalc(self.time, Trace.resplen)  # resplen = 0.5秒
-    // 也就是说 time_resp 代表 0 到 0.5 秒的时间范围
-    //
-    // 🔥 关键修复：时间范围固定为 0.5 秒，不依赖于传入的 sampleRate
-    // - responseLen 是实际的数据点数（由反卷积结果决定）
-    // - 无论 responseLen 是多少，时间范围始终是 [0, 0.5] 秒
-    // - dt = 0.5 / responseLen，确保 (responseLen-1) * dt ≈ 0.5
-    //
-    // 注意：传入的 sampleRate 参数是原始数据的采样率，用于窗口大小计算
-    // 但加权平均的时间轴应该始终对应 0.5 秒的响应时长
-
-    double responseDuration = 0.5;  // Python 的 resplen = 0.5 秒
-    double dt = responseDuration / (responseLen > 1 ? responseLen - 1 : 1);
-
-    // 使用 linspace 生成均匀时间轴 [0, 0.5] 秒
-    NSMutableArray<NSNumber *> *timeResp = [NSMutableArray arrayWithCapacity:responseLen];
-    for (NSInteger i = 0; i < responseLen; i++) {
-        double t = responseDuration * i / (responseLen > 1 ? responseLen - 1 : 1);
-        [timeResp addObject:@(t)];
-    }
-
-    double timeMin = [timeResp[0] doubleValue];      // 0.0
-    double timeMax = [timeResp[responseLen - 1] doubleValue];  // 0.5（精确）
-
-    NSLog(@"🔍 [Python对齐] time_resp: 起点=%.6f, 终点=%.6f, 长度=%ld",
-          timeMin, timeMax, (long)timeResp.count);
-
-    // ========== 4. 展平数据（匹配Python的flatten） ==========
-    // Python: times.flatten(), values.flatten(), weights.flatten()
-
-    // 先计算展平后需要的容量
-    NSInteger validWindowCount = 0;
-    for (NSInteger w = 0; w < windowCount; w++) {
-        double weight = 1.0;
-        if (dataMask && w < dataMask.count) {
-            weight = [dataMask[w] doubleValue];
-        }
-        if (weight > 0.5) {
-            validWindowCount++;
-        }
-    }
-
-    NSInteger totalPoints = validWindowCount * responseLen;
-
-    NSMutableArray<NSNumber *> *flatTimes = [NSMutableArray arrayWithCapacity:totalPoints];
-    NSMutableArray<NSNumber *> *flatValues = [NSMutableArray arrayWithCapacity:totalPoints];
-    NSMutableArray<NSNumber *> *flatWeights = [NSMutableArray arrayWithCapacity:totalPoints];
-
+    // 逐窗口累加到直方图（等价于展平后构建histogram2d，省去展平数组）
+    // 时间轴固定为 [0, 0.5] 秒，与 sampleRate 无关
+    PIDResponseHistogram *histogram = [[PIDResponseHistogram alloc] initWithResponseLength:responseLen
+                                                                                vertRange:vertRange
+                                                                                 vertBins:vertBins];
     for (NSInteger w = 0; w < windowCount; w++) {
-        NSArray<NSNumber *> *windowResp = stepResponse[w];
-        if (!windowResp || windowResp.count != responseLen) continue;
-
-        // 获取该窗口的权重
         double weight = 1.0;
         if (dataMask && w < dataMask.count) {
             weight = [dataMask[w] doubleValue];
@@ -1076,327 +3946,19 @@ static double getMachFrequency(void) {
         // 如果weight为0，跳过此窗口
         if (weight < 0.5) continue;
 
-        // 展平该窗口的数据
-        for (NSInteger i = 0; i < responseLen; i++) {
-            [flatTimes addObject:timeResp[i]];      // 使用物理时间，不是索引
-            [flatValues addObject:windowResp[i]];
-            [flatWeights addObject:@(weight)];
-        }
-    }
-
-    NSLog(@"🔍 [Python对齐] 展平后数据点数: %lu (windowCount=%ld, responseLen=%ld)",
-          (unsigned long)flatTimes.count, (long)windowCount, (long)responseLen);
-
-    // 🔍 新增：检查展平后的数据范围
-    if (flatValues.count > 0) {
-        double flatMin = [flatValues[0] doubleValue];
-        double flatMax = flatMin;
-        for (NSNumber *num in flatValues) {
-            double v = [num doubleValue];
-            if (v < flatMin) flatMin = v;
-            if (v > flatMax) flatMax = v;
-        }
-        NSLog(@"🔍 [展平数据] flatValues范围: [%.6f, %.6f], 点数=%lu",
-              flatMin, flatMax, (unsigned long)flatValues.count);
-        NSLog(@"🔍 [展平数据] 前5个值: %.6f, %.6f, %.6f, %.6f, %.6f",
-              [flatValues[0] doubleValue], [flatValues[1] doubleValue],
-              [flatValues[2] doubleValue], [flatValues[3] doubleValue],
-              [flatValues[4] doubleValue]);
-    }
-
-    // ========== 5. 构建histogram2d（使用新的辅助方法） ==========
-    NSInteger timeBins = responseLen;
-    float *hist2d = [self buildHistogram2D:flatTimes
-                                    values:flatValues
-                                   weights:flatWeights
-                                  timeMin:timeMin
-                                  timeMax:timeMax
-                                 valueMin:yMin
-                                 valueMax:yMax
-                           timeBinsCount:timeBins
-                           vertBinsCount:vertBins];
-
-    if (!hist2d) {
-        NSLog(@"❌ histogram2d构建失败");
-        return @[];
-    }
-
-    NSLog(@"🔍 [Python对齐] hist2d构建完成: shape=[%ld, %ld]",
-          (long)vertBins, (long)timeBins);
-
-    // 🔍 新增：检查hist2d的统计信息
-    float histSum = 0.0f;
-    float histMax = 0.0f;
-    NSInteger nonZeroCount = 0;
-    for (NSInteger i = 0; i < vertBins * timeBins; i++) {
-        float v = hist2d[i];
-        histSum += v;
-        if (v > histMax) histMax = v;
-        if (v > 1e-6f) nonZeroCount++;
-    }
-    NSLog(@"🔍 [hist2d统计] sum=%.6f, max=%.6f, 非零点=%ld/%ld",
-          histSum, histMax, (long)nonZeroCount, (long)(vertBins * timeBins));
-
-    // ========== 6. 高斯平滑（垂直方向，axis=0） ==========
-    // Python: gaussian_filter1d(hist2d, filt_width=7, axis=0, mode='constant')
-    // 在scipy的gaussian_filter1d中，第二个参数是sigma，不是某种"宽度"
-    // 所以 filt_width=7 意味着 sigma=7
-    double filtWidth = 7.0;
-    double sigma = filtWidth;  // 🔥 关键修复：sigma直接使用filtWidth，不是filtWidth/3
-
-    NSInteger histSize = vertBins * timeBins;
-    float *hist2dSmooth = (float *)malloc(histSize * sizeof(float));
-
-    // 预计算高斯核
-    // 核半径应该覆盖足够大的范围，通常 ±4σ 可以覆盖99.99%的高斯分布
-    // scipy的gaussian_filter1d使用 truncate=4.0（默认值）
-    NSInteger kernelRadius = (NSInteger)ceil(4.0 * sigma);
-    NSInteger kernelSize = 2 * kernelRadius + 1;
-    float *gaussKernel = (float *)malloc(kernelSize * sizeof(float));
-    double kernelSum = 0.0;
-
-    for (NSInteger dv = -kernelRadius; dv <= kernelRadius; dv++) {
-        // 高斯公式: exp(-x² / (2σ²))
-        double g = exp(-(dv * dv) / (2.0 * sigma * sigma));
-        gaussKernel[dv + kernelRadius] = (float)g;
-        kernelSum += g;
-    }
-    // 归一化核
-    for (NSInteger i = 0; i < kernelSize; i++) {
-        gaussKernel[i] /= (float)kernelSum;
-    }
-
-    // 🔥 关键修复：应用高斯平滑（沿垂直方向，axis=0）
-    // 完全匹配scipy的gaussian_filter1d(hist2d, sigma, axis=0, mode='constant')
-    // mode='constant' 表示边界外填充0（不跳过，而是使用0值）
-    for (NSInteger t = 0; t < timeBins; t++) {
-        for (NSInteger v = 0; v < vertBins; v++) {
-            float sum = 0.0f;
-
-            for (NSInteger dv = -kernelRadius; dv <= kernelRadius; dv++) {
-                NSInteger srcV = v + dv;
-                // 🔑 关键：与scipy的mode='constant'一致，边界外视为0值
-                // 不需要if检查，因为0值对sum没有影响，但需要正确访问hist2d
-                if (srcV >= 0 && srcV < vertBins) {
-                    sum += hist2d[srcV * timeBins + t] * gaussKernel[dv + kernelRadius];
-                }
-                // else: 越界部分视为0（mode='constant'），不添加到sum中
-            }
-
-            hist2dSmooth[v * timeBins + t] = sum;
-        }
-    }
-
-    free(gaussKernel);
-    free(hist2d);
-
-    // ========== 7. 归一化（每列除以最大值） ==========
-    // Python: hist2d_sm /= np.max(hist2d_sm, 0)
-    for (NSInteger t = 0; t < timeBins; t++) {
-        float maxVal = 0.0f;
-
-        // 找每列的最大值
-        for (NSInteger v = 0; v < vertBins; v++) {
-            float val = hist2dSmooth[v * timeBins + t];
-            if (val > maxVal) maxVal = val;
-        }
-
-        // 归一化
-        if (maxVal > 1e-6f) {
-            float invMax = 1.0f / maxVal;
-            for (NSInteger v = 0; v < vertBins; v++) {
-                hist2dSmooth[v * timeBins + t] *= invMax;
-            }
-        }
-    }
-
-    // ========== 8. 生成resp_y（匹配Python的linspace） ==========
-    // Python: resp_y = np.linspace(vertrange[0], vertrange[-1], vertbins, dtype=np.float64)
-    NSArray<NSNumber *> *respY = [self linspaceFrom:yMin to:yMax count:vertBins];
-
-    NSLog(@"🔍 [Python对齐] resp_y: 起点=%.6f, 终点=%.6f, 长度=%lu",
-          [respY[0] doubleValue],
-          [respY[respY.count - 1] doubleValue],
-          (unsigned long)respY.count);
-
-    // 🔍 调试：分析hist2d的分布特征 - 检查前10个和关键降采样点
-    NSLog(@"🔍 [Hist2D分析] 检查关键时间点的hist2d分布:");
-
-    // 检查点：前10个 + 降采样关键位置 (40, 80, 120, ...)
-    NSInteger checkPoints[] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 40, 80, 120, 160, 200, 400, 800, 1200, 1600, 2000, 3000, 3999};
-    NSInteger numCheckPoints = sizeof(checkPoints) / sizeof(checkPoints[0]);
-
-    for (NSInteger idx = 0; idx < numCheckPoints; idx++) {
-        NSInteger t = checkPoints[idx];
-        if (t >= timeBins) continue;
-
-        // 找每列的峰值位置（加权平均）
-        float weightedPos = 0.0f;
-        float totalWeight = 0.0f;
-        float maxHistVal = 0.0f;
-        NSInteger maxBin = 0;
-
-        for (NSInteger v = 0; v < vertBins; v++) {
-            float histVal = hist2dSmooth[v * timeBins + t];
-            if (histVal > maxHistVal) {
-                maxHistVal = histVal;
-                maxBin = v;
-            }
-            double y = [respY[v] doubleValue];
-            float w = histVal * histVal;
-            weightedPos += y * w;
-            totalWeight += w;
-        }
-        double avgPos = totalWeight > 1e-9f ? weightedPos / totalWeight : 0.0;
-
-        // 检查是否有多个峰值（双峰分布会导致振荡）
-        float secondMaxVal = 0.0f;
-        NSInteger secondMaxBin = -1;
-        for (NSInteger v = 0; v < vertBins; v++) {
-            float histVal = hist2dSmooth[v * timeBins + t];
-            if (histVal > secondMaxVal && v != maxBin) {
-                secondMaxVal = histVal;
-                secondMaxBin = v;
-            }
-        }
-
-        NSLog(@"  t[%4ld]: 加权平均=%.6f, maxHist=%.4f@bin%ld, 2ndMax=%.4f@bin%ld, ratio=%.2f",
-              (long)t, avgPos, maxHistVal, (long)maxBin, secondMaxVal, (long)secondMaxBin,
-              maxHistVal > 0 ? secondMaxVal / maxHistVal : 0);
-    }
-
-    // ========== 9. 加权平均（使用平方权重） ==========
-    // Python: avr = np.average(pixelpos, 0, weights=hist2d_sm * hist2d_sm)
-    // pixelpos = np.repeat(resp_y.reshape(len(resp_y), 1), len(times[0]), axis=1)
-
-    NSMutableArray<NSNumber *> *avgResponse = [NSMutableArray arrayWithCapacity:timeBins];
-
-    // 🔍 新增：分析第一个和最后一个时间点的加权平均计算
-    NSMutableArray<NSNumber *> *timePointsToAnalyze = [NSMutableArray arrayWithObjects:@(0), @(timeBins-1), nil];
-    // 添加一些中间点
-    for (NSInteger i = 1; i < 5; i++) {
-        NSInteger idx = i * timeBins / 5;
-        [timePointsToAnalyze addObject:@(idx)];
-    }
-
-    for (NSInteger t = 0; t < timeBins; t++) {
-        double weightedSum = 0.0;
-        double weightSum = 0.0;
-
-        // 🔍 新增：记录关键统计信息
-        double maxY_at_this_t = -HUGE_VAL;
-        double minY_with_weight = HUGE_VAL;
-        double maxY_with_weight = -HUGE_VAL;
-
-        for (NSInteger v = 0; v < vertBins; v++) {
-            float histVal = hist2dSmooth[v * timeBins + t];
-            double y = [respY[v] doubleValue];
-            double w = histVal * histVal;  // 平方权重
-
-            if (w > 1e-9) {
-                if (y < minY_with_weight) minY_with_weight = y;
-                if (y > maxY_with_weight) maxY_with_weight = y;
-            }
-            if (histVal > maxY_at_this_t) maxY_at_this_t = histVal;
-
-            weightedSum += y * w;
-            weightSum += w;
-        }
-
-        double avgVal = weightSum > 1e-9 ? weightedSum / weightSum : 0.0;
-        [avgResponse addObject:@(avgVal)];
-
-        // 🔍 新增：打印关键时间点的详细信息
-        if ([timePointsToAnalyze containsObject:@(t)]) {
-            NSLog(@"🔍 [加权平均详情] t[%ld]:", (long)t);
-            NSLog(@"  加权平均结果: %.6f", avgVal);
-            NSLog(@"  有权重的resp_y范围: [%.6f, %.6f]", minY_with_weight, maxY_with_weight);
-            NSLog(@"  最大histVal: %.6f", maxY_at_this_t);
-            NSLog(@"  weightSum: %.6f", weightSum);
-        }
+        [histogram addWindowResponse:stepResponse[w] weight:weight];
     }
 
-    free(hist2dSmooth);
-
-    // ========== 10. 输出验证日志 ==========
-    if (avgResponse.count > 0) {
-        double firstVal = [avgResponse[0] doubleValue];
-        double lastVal = [avgResponse[avgResponse.count - 1] doubleValue];
-
-        // 找最大最小值
-        double minVal = firstVal;
-        double maxVal = firstVal;
-        for (NSInteger i = 1; i < avgResponse.count; i++) {
-            double v = [avgResponse[i] doubleValue];
-            if (v < minVal) minVal = v;
-            if (v > maxVal) maxVal = v;
-        }
-
-        NSLog(@"📊 [最终结果] avgResponse统计:");
-        NSLog(@"  起点: %.6f (Python参考: ~0.8-1.0)", firstVal);
-        NSLog(@"  终点: %.6f (Python参考: ~1.3-1.5)", lastVal);
-        NSLog(@"  最小值: %.6f", minVal);
-        NSLog(@"  最大值: %.6f", maxVal);
-
-        // 打印前5个和后5个值
-        NSLog(@"📊 [最终结果] 前5个值:");
-        for (NSInteger i = 0; i < MIN(5, avgResponse.count); i++) {
-            NSLog(@"  [%ld] = %.6f", (long)i, [avgResponse[i] doubleValue]);
-        }
-        NSLog(@"📊 [最终结果] 后5个值:");
-        for (NSInteger i = MAX(0, avgResponse.count - 5); i < avgResponse.count; i++) {
-            NSLog(@"  [%ld] = %.6f", (long)i, [avgResponse[i] doubleValue]);
-        }
-
-        // 🔍 新增：检查降采样位置的数据（匹配PIDAnalysisViewController的降采样逻辑）
-        NSLog(@"🔍 [降采样检查] 降采样到100点时的采样位置:");
-        NSInteger displayPoints = 100;
-        for (NSInteger i = 0; i < MIN(10, displayPoints); i++) {
-            NSInteger srcIndex = (i * avgResponse.count) / displayPoints;
-            double val = [avgResponse[srcIndex] doubleValue];
-            NSLog(@"  display[%ld] = avgResponse[%ld] = %.6f", (long)i, (long)srcIndex, val);
-        }
-    }
+    NSArray<NSNumber *> *avgResponse = [histogram weightedModeAverage];
 
     // 性能监控
     uint64_t endTime = mach_absolute_time();
     double elapsedMs = (double)(endTime - startTime) * 1000.0 / getMachFrequency();
 
-    NSLog(@"✅ weighted_mode_avr完成: %ld窗口 -> 1条曲线 | 耗时: %.1fms",
-          (long)windowCount, elapsedMs);
-
-    // 🔥 关键修复：阶跃响应应该从0开始，表示相对于初始状态的变化
-    // weighted_mode_avr 计算的是绝对位置的加权平均，需要减去初始值得到相对变化
-    // 例如：如果加权平均结果是 [0.97, 1.10, 1.20]，减去0.97后得到 [0, 0.13, 0.23]
-    if (avgResponse.count > 0) {
-        double baseValue = [avgResponse[0] doubleValue];
-        NSLog(@"🔍 [零点调整] 加权平均原始起点=%.6f，对所有值减去baseValue", baseValue);
-
-        for (NSInteger i = 0; i < avgResponse.count; i++) {
-            double adjustedVal = [avgResponse[i] doubleValue] - baseValue;
-            avgResponse[i] = @(adjustedVal);
-        }
-
-        NSLog(@"🔍 [零点调整] 调整后起点=%.6f，终点=%.6f",
-              [avgResponse[0] doubleValue], [avgResponse[avgResponse.count-1] doubleValue]);
-    }
-
-    // 🎯 关键输出：最终结果范围
-    if (avgResponse.count > 0) {
-        double minVal = [avgResponse[0] doubleValue];
-        double maxVal = minVal;
-        for (NSNumber *num in avgResponse) {
-            double v = [num doubleValue];
-            if (v < minVal) minVal = v;
-            if (v > maxVal) maxVal = v;
-        }
-        NSLog(@"🎯🎯🎯 [最终结果] 起点=%.3f, 终点=%.3f, 跨度=%.3f (点数=%lu)",
-              [avgResponse[0] doubleValue], [avgResponse[avgResponse.count-1] doubleValue],
-              [avgResponse[avgResponse.count-1] doubleValue] - [avgResponse[0] doubleValue],
-              (unsigned long)avgResponse.count);
-    }
+    NSLog(@"✅ weighted_mode_avr完成: %ld/%ld窗口 -> 1条曲线 | 耗时: %.1fms",
+          (long)histogram.windowCount, (long)windowCount, elapsedMs);
 
-    return [avgResponse copy];
+    return avgResponse;
 }
 
 /**
@@ -1419,6 +3981,53 @@ static double getMachFrequency(void) {
                                         sampleRate:8000.0];  // 默认8kHz
 }
 
+/**
+ * 计算单轴的低/高输入响应曲线
+ * 两遍遍历已有的窗口结果：第一遍得到参考响应，第二遍按质量mask累加
+ */
++ (nullable PIDResponseCurves *)responseCurvesFromResult:(PIDResponseResult *)result {
+    NSArray<NSArray<NSNumber *> *> *stepResponse = result.stepResponse;
+    if (stepResponse.count == 0) {
+        return nil;
+    }
+
+    NSArray<NSNumber *> *maxInput = result.maxInput;
+    NSInteger windowCount = MIN(stepResponse.count, maxInput.count);
+
+    PIDResponseCurveBuilder *builder = [[PIDResponseCurveBuilder alloc] init];
+
+    // 有连续矩阵时逐行直接散射，不再拆箱NSNumber
+    NSInteger responseLength = stepResponse[0].count;
+    NSData *matrix = result.stepResponseData;
+    if (matrix && responseLength > 0 &&
+        matrix.length == (NSUInteger)(stepResponse.count * responseLength) * sizeof(double)) {
+        const double *rows = matrix.bytes;
+        for (NSInteger w = 0; w < windowCount; w++) {
+            [builder addInitialPassWindowValues:rows + w * responseLength
+                                         length:responseLength
+                                       maxInput:[maxInput[w] doubleValue]];
+        }
+        [builder finishInitialPass];
+
+        for (NSInteger w = 0; w < windowCount; w++) {
+            [builder addFinalPassWindowValues:rows + w * responseLength
+                                       length:responseLength
+                                     maxInput:[maxInput[w] doubleValue]];
+        }
+        return [builder finishFinalPass];
+    }
+
+    for (NSInteger w = 0; w < windowCount; w++) {
+        [builder addInitialPassWindow:stepResponse[w] maxInput:[maxInput[w] doubleValue]];
+    }
+    [builder finishInitialPass];
+
+    for (NSInteger w = 0; w < windowCount; w++) {
+        [builder addFinalPassWindow:stepResponse[w] maxInput:[maxInput[w] doubleValue]];
+    }
+    return [builder finishFinalPass];
+}
+
 #pragma mark - 辅助方法（Python算法对齐）
 
 /**
@@ -1464,8 +4073,11 @@ static double getMachFrequency(void) {
 
     // 1. 分配内存：先按 [timebins, vertbins] 存储，然后转置
     NSInteger histSize = timeBins * vertBins;
-    float *hist2d = (float *)calloc(histSize, sizeof(float));
+    PIDScratchArena *arena = PIDScratchArenaCurrent();
+    PIDScratchMark mark = PIDScratchArenaMark(arena);
+    float *hist2d = (float *)PIDScratchArenaAlloc(arena, histSize * sizeof(float));
     if (!hist2d) return nil;
+    memset(hist2d, 0, histSize * sizeof(float));
 
     // 2. 🔥 关键修复：添加小的epsilon以处理浮点精度问题
     // numpy的histogram2d使用半开区间 [a, b)，但最后一个bin会包含最大值
@@ -1557,7 +4169,7 @@ static double getMachFrequency(void) {
     // 4. 转置为 [vertbins, timebins] 以匹配Python的.transpose()
     float *transposed = (float *)malloc(histSize * sizeof(float));
     if (!transposed) {
-        free(hist2d);
+        PIDScratchArenaReset(arena, mark);
         return nil;
     }
 
@@ -1567,7 +4179,7 @@ static double getMachFrequency(void) {
         }
     }
 
-    free(hist2d);
+    PIDScratchArenaReset(arena, mark);
     return transposed;
 }
 
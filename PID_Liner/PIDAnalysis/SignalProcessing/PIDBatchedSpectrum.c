@@ -0,0 +1,116 @@
+//
+//  PIDBatchedSpectrum.c
+//  PID_Liner
+//
+//  多通道批量频谱实现 - 窗口块并行，块内按通道遍历，补零缓冲区每线程只清零一次
+//
+
+#include "PIDBatchedSpectrum.h"
+#include "PIDFFTPlan.h"
+#include "PIDScratchArena.h"
+
+#include <stdatomic.h>
+#include <string.h>
+
+/**
+ * 并行任务：每个迭代处理一个窗口块的全部通道
+ */
+typedef struct {
+    const PIDSpectrumBatch *batch;
+    const PIDFFTPlan *plan;
+    size_t windowBegin;
+    size_t windowEnd;
+    size_t binCount;
+    double *realOut;
+    size_t channelStride;
+    atomic_bool failed;
+} PIDSpectrumBatchJob;
+
+static void PIDSpectrumBatchRunTile(void *context, size_t tile) {
+    PIDSpectrumBatchJob *job = (PIDSpectrumBatchJob *)context;
+    const PIDSpectrumBatch *batch = job->batch;
+    if (atomic_load_explicit(&job->failed, memory_order_relaxed) || PIDCancelFlagIsSet(batch->cancel)) {
+        atomic_store(&job->failed, true);
+        return;
+    }
+
+    size_t begin = job->windowBegin + tile * PIDSpectrumBatchTileWindows;
+    size_t end = begin + PIDSpectrumBatchTileWindows < job->windowEnd ? begin + PIDSpectrumBatchTileWindows
+                                                                       : job->windowEnd;
+    size_t windowLength = batch->windowLength;
+    size_t paddedLength = batch->paddedLength;
+
+    // 补零部分只需清零一次，每个窗口只覆盖前windowLength个点；实部直接写入输出行
+    PIDScratchArena *arena = PIDScratchArenaCurrent();
+    PIDScratchArenaReserve(arena, PIDScratchBytesForWindow(windowLength, paddedLength));
+    PIDScratchMark mark = PIDScratchArenaMark(arena);
+    double *samples = PIDScratchArenaAllocZeroed(arena, paddedLength);
+    double *imag = (double *)PIDScratchArenaAlloc(arena, job->binCount * sizeof(double));
+    if (!samples || !imag) {
+        atomic_store(&job->failed, true);
+        PIDScratchArenaReset(arena, mark);
+        return;
+    }
+
+    for (size_t c = 0; c < batch->channelCount; c++) {
+        const double *column = batch->columns[c];
+        if (!column) {
+            continue;
+        }
+        double *rows = job->realOut + c * job->channelStride;
+        for (size_t i = begin; i < end; i++) {
+            const double *source = column + i * batch->step;
+            if (batch->window) {
+                const double *window = batch->window;
+                for (size_t j = 0; j < windowLength; j++) {
+                    samples[j] = source[j] * window[j];
+                }
+            } else {
+                memcpy(samples, source, windowLength * sizeof(double));
+            }
+            PIDFFTRealForward(job->plan, samples, rows + (i - job->windowBegin) * job->binCount, imag);
+        }
+    }
+
+    PIDScratchArenaReset(arena, mark);
+}
+
+size_t PIDSpectrumBatchBinCount(const PIDSpectrumBatch *batch) {
+    return batch ? batch->paddedLength / 2 + 1 : 0;
+}
+
+bool PIDSpectrumBatchTransform(const PIDSpectrumBatch *batch, size_t windowBegin, size_t windowEnd,
+                               double *realOut, size_t channelStride) {
+    if (!batch || !batch->columns || !realOut || batch->windowLength == 0 ||
+        batch->paddedLength < batch->windowLength || windowEnd > batch->windowCount || windowBegin > windowEnd) {
+        return false;
+    }
+    size_t binCount = PIDSpectrumBatchBinCount(batch);
+    if (channelStride < (windowEnd - windowBegin) * binCount) {
+        return false;
+    }
+    if (windowBegin == windowEnd || batch->channelCount == 0) {
+        return true;
+    }
+
+    // 计划常驻缓存，所有通道、所有线程共用
+    const PIDFFTPlan *plan = PIDFFTPlanForLength(batch->paddedLength, PIDFFTBackendAutomatic);
+    if (!plan) {
+        return false;
+    }
+
+    PIDSpectrumBatchJob job;
+    job.batch = batch;
+    job.plan = plan;
+    job.windowBegin = windowBegin;
+    job.windowEnd = windowEnd;
+    job.binCount = binCount;
+    job.realOut = realOut;
+    job.channelStride = channelStride;
+    atomic_init(&job.failed, false);
+
+    size_t tileCount = (windowEnd - windowBegin + PIDSpectrumBatchTileWindows - 1) / PIDSpectrumBatchTileWindows;
+    PIDParallelFor(tileCount, &job, PIDSpectrumBatchRunTile);
+
+    return !atomic_load(&job.failed) && !PIDCancelFlagIsSet(batch->cancel);
+}
@@ -0,0 +1,61 @@
+//
+//  PIDBatchedSpectrum.h
+//  PID_Liner
+//
+//  多通道批量频谱 - 陀螺仪、D项、debug、rcCommand等多列信号按同一组窗口一次完成加窗实数FFT
+//  纯C实现：所有通道共用一个FFT计划和分析窗，每个线程一份补零/虚部暂存（来自PIDScratchArena）
+//
+
+#ifndef PIDBatchedSpectrum_h
+#define PIDBatchedSpectrum_h
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "PIDParallel.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * 同一组窗口上的多通道频谱输入
+ * 窗口k的样本为 columns[c][k*step, k*step + windowLength)，与 PIDStackData 的列缓冲区视图一致
+ */
+typedef struct {
+    const double *const *columns;   // 各通道的列缓冲区（NULL的通道跳过，输出行不写）
+    size_t channelCount;
+    size_t windowCount;
+    size_t windowLength;
+    size_t step;                    // 相邻窗口起点的间隔
+    const double *window;           // 分析窗（windowLength个点）；NULL为矩形窗
+    size_t paddedLength;            // FFT长度（>= windowLength）
+    const PIDCancelFlag *cancel;    // 可选：置位后剩余窗口块不再计算
+} PIDSpectrumBatch;
+
+/**
+ * 批量变换的窗口块大小：块内先固定通道、连续处理相邻的重叠窗口
+ * （15/16重叠时8个窗口只跨约1.5个窗口长度的样本，列数据留在缓存中），再换下一个通道
+ */
+enum { PIDSpectrumBatchTileWindows = 8 };
+
+/**
+ * 每个窗口的半谱点数（paddedLength/2 + 1）
+ */
+size_t PIDSpectrumBatchBinCount(const PIDSpectrumBatch *batch);
+
+/**
+ * 对 [windowBegin, windowEnd) 的窗口做全部通道的加窗实数FFT，输出频谱实部（对应numpy.fft.rfft(x·w, n).real）
+ * 窗口块之间并行；同一通道、同一窗口的结果与 PIDSpectralCache 的分析窗频谱逐位一致
+ * @param realOut 输出：通道c、窗口i的实部行为 realOut + c*channelStride + (i-windowBegin)*binCount
+ * @param channelStride 相邻通道输出的间隔（double个数，>= (windowEnd-windowBegin)*binCount）
+ * @return 参数无效、内存不足或已取消时返回false（输出不完整）
+ */
+bool PIDSpectrumBatchTransform(const PIDSpectrumBatch *batch, size_t windowBegin, size_t windowEnd,
+                               double *realOut, size_t channelStride);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PIDBatchedSpectrum_h */
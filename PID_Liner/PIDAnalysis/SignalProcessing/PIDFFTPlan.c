@@ -0,0 +1,1013 @@
+//
+//  PIDFFTPlan.c
+//  PID_Liner
+//
+//  FFT计划缓存实现
+//  - 计划按(长度, 后端)缓存，常驻进程，创建时一次性计算旋转因子/vDSP setup
+//  - 每个计划带一个临时内存池，多个线程同时使用同一计划时各自取用一块
+//  - 后端通过函数表接入：Accelerate（vDSP）与可移植C实现（Stockham混合基2/3/4/5 + Bluestein）
+//
+
+#include "PIDFFTPlan.h"
+
+#include <math.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__APPLE__)
+#include <Accelerate/Accelerate.h>
+#define PID_FFT_HAS_ACCELERATE 1
+#else
+#define PID_FFT_HAS_ACCELERATE 0
+#endif
+
+// Stockham分解的最大级数（2^64以内足够）
+#define PID_FFT_MAX_RADICES 64
+
+// 不依赖M_PI（严格C11模式下<math.h>不提供）
+static const double kPIDFFTPi = 3.14159265358979323846;
+
+#pragma mark - 数据结构
+
+/**
+ * 临时内存块（链表节点，数据紧跟在节点之后）
+ */
+typedef struct PIDFFTScratch {
+    struct PIDFFTScratch *next;
+    double data[];
+} PIDFFTScratch;
+
+/**
+ * 后端接口
+ * 所有变换函数均为不缩放的原始变换，缩放由公共层统一处理；
+ * 变换函数在子计划取不到临时内存时返回false，输出内容未定义
+ */
+typedef struct {
+    PIDFFTBackend kind;
+    const char *name;
+    // 该后端是否支持此长度
+    bool (*supportsLength)(size_t length);
+    bool (*setup)(PIDFFTPlan *plan);
+    void (*teardown)(PIDFFTPlan *plan);
+    // 原地复数变换（长度n）；scratch为plan->complexScratch个double
+    bool (*complexTransform)(const PIDFFTPlan *plan, double *re, double *im, bool inverse, double *scratch);
+    // 实数正变换，输出n/2+1个频点；scratch为plan->scratchLength个double
+    bool (*realForward)(const PIDFFTPlan *plan, const double *input,
+                        double *outReal, double *outImag, double *scratch);
+    // 实数逆变换（结果为n·x，不含1/n缩放）
+    bool (*realInverse)(const PIDFFTPlan *plan, const double *inReal, const double *inImag,
+                        double *output, double *scratch);
+} PIDFFTBackendOps;
+
+struct PIDFFTPlan {
+    size_t length;
+    const PIDFFTBackendOps *ops;
+
+    // 旋转因子 e^{-2πij/n}, j < n（实数拆分步骤与Stockham各级共用）
+    double *twiddleReal;
+    double *twiddleImag;
+
+    // 实数变换使用的n/2点复数计划（n为偶数且后端没有原生实数变换时）
+    const PIDFFTPlan *halfPlan;
+
+    // 可移植后端：Stockham各级基数；radixCount为0且length>1时使用Bluestein
+    size_t radices[PID_FFT_MAX_RADICES];
+    size_t radixCount;
+
+    // Bluestein：chirp w_k = e^{-πik²/n}，卷积核的频谱，以及卷积用的快速长度计划
+    const PIDFFTPlan *bluesteinPlan;
+    double *chirpReal;
+    double *chirpImag;
+    double *kernelReal;
+    double *kernelImag;
+
+#if PID_FFT_HAS_ACCELERATE
+    FFTSetupD setup;                // 2的幂
+    FFTSetup setupFloat;            // 2的幂（单精度接口）
+    size_t log2n;
+    vDSP_DFT_SetupD dftForward;     // f·2^k (f = 3, 5, 15)
+    vDSP_DFT_SetupD dftInverse;
+#endif
+
+    // 临时内存：[0, complexScratch) 供复数变换，其后2n个供实数变换，
+    // 再其后 n + 2·(n/2+1) 个供单精度接口扩展为双精度
+    size_t complexScratch;
+    size_t scratchLength;
+    pthread_mutex_t scratchLock;
+    PIDFFTScratch *freeScratch;
+
+    struct PIDFFTPlan *next;    // 缓存链表
+};
+
+#pragma mark - 长度工具
+
+static bool PIDFFTIsPowerOfTwo(size_t n) {
+    return n >= 2 && (n & (n - 1)) == 0;
+}
+
+size_t PIDFFTFastLength(size_t minimum) {
+    if (minimum <= 2) {
+        return 2;
+    }
+    // 枚举 3^b·5^c，再乘2直到不小于minimum，取最小者（至少含一个因子2）
+    size_t best = 2;
+    while (best < minimum) {
+        best *= 2;
+    }
+    for (size_t p5 = 1; p5 < best; p5 *= 5) {
+        for (size_t p35 = p5; p35 < best; p35 *= 3) {
+            size_t candidate = p35 * 2;
+            while (candidate < minimum) {
+                candidate *= 2;
+            }
+            if (candidate < best) {
+                best = candidate;
+            }
+        }
+    }
+    return best;
+}
+
+#pragma mark - 临时内存池
+
+static double *PIDFFTScratchAcquire(const PIDFFTPlan *constPlan) {
+    PIDFFTPlan *plan = (PIDFFTPlan *)constPlan;
+    if (plan->scratchLength == 0) {
+        return NULL;
+    }
+
+    PIDFFTScratch *scratch = NULL;
+    pthread_mutex_lock(&plan->scratchLock);
+    scratch = plan->freeScratch;
+    if (scratch) {
+        plan->freeScratch = scratch->next;
+    }
+    pthread_mutex_unlock(&plan->scratchLock);
+
+    if (!scratch) {
+        scratch = (PIDFFTScratch *)malloc(sizeof(PIDFFTScratch) + plan->scratchLength * sizeof(double));
+        if (!scratch) {
+            return NULL;
+        }
+    }
+    return scratch->data;
+}
+
+static void PIDFFTScratchRelease(const PIDFFTPlan *constPlan, double *data) {
+    if (!data) {
+        return;
+    }
+    PIDFFTPlan *plan = (PIDFFTPlan *)constPlan;
+    PIDFFTScratch *scratch = (PIDFFTScratch *)((char *)data - offsetof(PIDFFTScratch, data));
+
+    pthread_mutex_lock(&plan->scratchLock);
+    scratch->next = plan->freeScratch;
+    plan->freeScratch = scratch;
+    pthread_mutex_unlock(&plan->scratchLock);
+}
+
+/**
+ * 取用计划自己的临时内存执行一次不缩放的复数变换（供其他计划调用子计划）
+ * @return 需要临时内存却分配失败时返回false，不执行变换
+ */
+static bool PIDFFTComplexRaw(const PIDFFTPlan *plan, double *re, double *im, bool inverse) {
+    double *scratch = PIDFFTScratchAcquire(plan);
+    if (!scratch && plan->scratchLength > 0) {
+        return false;
+    }
+    bool ok = plan->ops->complexTransform(plan, re, im, inverse, scratch);
+    PIDFFTScratchRelease(plan, scratch);
+    return ok;
+}
+
+#pragma mark - 通用实数变换
+
+/**
+ * 实数FFT（偶数长度）：偶/奇样本打包成n/2点复数序列做一次半长FFT，再拆分
+ * X[k] = E[k] + W^k·O[k]，E/O为偶/奇样本的频谱
+ * 奇数长度退化为虚部为0的复数变换
+ */
+static bool PIDFFTGenericRealForward(const PIDFFTPlan *plan, const double *input,
+                                     double *outReal, double *outImag, double *scratch) {
+    size_t n = plan->length;
+    double *work = scratch + plan->complexScratch;
+
+    if (n % 2 != 0) {
+        double *re = work;
+        double *im = work + n;
+        memcpy(re, input, n * sizeof(double));
+        memset(im, 0, n * sizeof(double));
+        if (!plan->ops->complexTransform(plan, re, im, false, scratch)) {
+            return false;
+        }
+        memcpy(outReal, re, (n / 2 + 1) * sizeof(double));
+        memcpy(outImag, im, (n / 2 + 1) * sizeof(double));
+        outImag[0] = 0.0;
+        return true;
+    }
+
+    size_t m = n / 2;
+    double *zr = work;
+    double *zi = work + m;
+
+    for (size_t j = 0; j < m; j++) {
+        zr[j] = input[2 * j];
+        zi[j] = input[2 * j + 1];
+    }
+    if (!PIDFFTComplexRaw(plan->halfPlan, zr, zi, false)) {
+        return false;
+    }
+
+    for (size_t k = 0; k <= m; k++) {
+        size_t kk = (k == m) ? 0 : k;
+        size_t mk = (k == 0) ? 0 : m - k;
+        double er = 0.5 * (zr[kk] + zr[mk]);
+        double ei = 0.5 * (zi[kk] - zi[mk]);
+        double orr = 0.5 * (zi[kk] + zi[mk]);
+        double oi = -0.5 * (zr[kk] - zr[mk]);
+        // W^m = -1
+        double wr = (k == m) ? -1.0 : plan->twiddleReal[k];
+        double wi = (k == m) ? 0.0 : plan->twiddleImag[k];
+        outReal[k] = er + (wr * orr - wi * oi);
+        outImag[k] = ei + (wr * oi + wi * orr);
+    }
+    outImag[0] = 0.0;
+    outImag[m] = 0.0;
+    return true;
+}
+
+static bool PIDFFTGenericRealInverse(const PIDFFTPlan *plan, const double *inReal, const double *inImag,
+                                     double *output, double *scratch) {
+    size_t n = plan->length;
+    double *work = scratch + plan->complexScratch;
+
+    if (n % 2 != 0) {
+        // 由共轭对称补齐完整频谱，复数逆变换后取实部
+        double *re = work;
+        double *im = work + n;
+        re[0] = inReal[0];
+        im[0] = 0.0;
+        for (size_t k = 1; k <= n / 2; k++) {
+            re[k] = inReal[k];
+            im[k] = inImag[k];
+            re[n - k] = inReal[k];
+            im[n - k] = -inImag[k];
+        }
+        if (!plan->ops->complexTransform(plan, re, im, true, scratch)) {
+            return false;
+        }
+        memcpy(output, re, n * sizeof(double));
+        return true;
+    }
+
+    size_t m = n / 2;
+    double *zr = work;
+    double *zi = work + m;
+
+    for (size_t k = 0; k < m; k++) {
+        // DC和Nyquist的虚部按irfft约定忽略
+        double xr = inReal[k];
+        double xi = (k == 0) ? 0.0 : inImag[k];
+        double yr = inReal[m - k];
+        double yi = (k == 0) ? 0.0 : inImag[m - k];
+
+        // E = (X[k] + conj(X[m-k])) / 2
+        double er = 0.5 * (xr + yr);
+        double ei = 0.5 * (xi - yi);
+        // O = (X[k] - conj(X[m-k])) / 2 · conj(W^k)
+        double dr = 0.5 * (xr - yr);
+        double di = 0.5 * (xi + yi);
+        double wr = plan->twiddleReal[k];
+        double wi = -plan->twiddleImag[k];
+        double orr = dr * wr - di * wi;
+        double oi = dr * wi + di * wr;
+        // Z = E + i·O
+        zr[k] = er - oi;
+        zi[k] = ei + orr;
+    }
+    if (!PIDFFTComplexRaw(plan->halfPlan, zr, zi, true)) {
+        return false;
+    }
+
+    // 未缩放的半长逆变换结果为m·x，乘2后为n·x，由公共层统一乘1/n
+    for (size_t j = 0; j < m; j++) {
+        output[2 * j] = 2.0 * zr[j];
+        output[2 * j + 1] = 2.0 * zi[j];
+    }
+    return true;
+}
+
+#pragma mark - 可移植后端
+
+static bool PIDPortableSupportsLength(size_t length) {
+    return length >= 1;
+}
+
+/**
+ * Stockham自动排序FFT（不缩放，正变换）
+ * 每级把长度len的子序列按基数p拆分：
+ *   y[q + s·(p·j + t)] = (Σ_r x[q + s·(j + r·m)]·e^{-2πi·rt/p}) · e^{-2πi·jt/len}
+ * 其中 m = len/p，s为已完成各级的基数之积，旋转因子取自 twiddle[j·t·s]
+ */
+static void PIDStockhamForward(const PIDFFTPlan *plan, double *re, double *im, double *scratch) {
+    static const double kSin60 = 0.86602540378443864676;
+    // e^{-2πik/5}
+    static const double kCos5[5] = { 1.0, 0.30901699437494742410, -0.80901699437494742410,
+                                     -0.80901699437494742410, 0.30901699437494742410 };
+    static const double kSin5[5] = { 0.0, -0.95105651629515357212, -0.58778525229247312917,
+                                     0.58778525229247312917, 0.95105651629515357212 };
+
+    size_t n = plan->length;
+    double *xr = re, *xi = im;
+    double *yr = scratch, *yi = scratch + n;
+    const double *twr = plan->twiddleReal;
+    const double *twi = plan->twiddleImag;
+
+    size_t len = n;
+    size_t s = 1;
+    for (size_t f = 0; f < plan->radixCount; f++) {
+        size_t p = plan->radices[f];
+        size_t m = len / p;
+
+        for (size_t j = 0; j < m; j++) {
+            for (size_t q = 0; q < s; q++) {
+                double ar[5], ai[5], br[5], bi[5];
+                for (size_t r = 0; r < p; r++) {
+                    ar[r] = xr[q + s * (j + r * m)];
+                    ai[r] = xi[q + s * (j + r * m)];
+                }
+
+                switch (p) {
+                    case 2:
+                        br[0] = ar[0] + ar[1]; bi[0] = ai[0] + ai[1];
+                        br[1] = ar[0] - ar[1]; bi[1] = ai[0] - ai[1];
+                        break;
+                    case 3: {
+                        double tr = ar[1] + ar[2], ti = ai[1] + ai[2];
+                        double mr = ar[0] - 0.5 * tr, mi = ai[0] - 0.5 * ti;
+                        // -i·sin60·(a1 - a2)
+                        double nr = kSin60 * (ai[1] - ai[2]);
+                        double ni = -kSin60 * (ar[1] - ar[2]);
+                        br[0] = ar[0] + tr; bi[0] = ai[0] + ti;
+                        br[1] = mr + nr;    bi[1] = mi + ni;
+                        br[2] = mr - nr;    bi[2] = mi - ni;
+                        break;
+                    }
+                    case 4: {
+                        double t0r = ar[0] + ar[2], t0i = ai[0] + ai[2];
+                        double t1r = ar[0] - ar[2], t1i = ai[0] - ai[2];
+                        double t2r = ar[1] + ar[3], t2i = ai[1] + ai[3];
+                        // -i·(a1 - a3)
+                        double t3r = ai[1] - ai[3], t3i = -(ar[1] - ar[3]);
+                        br[0] = t0r + t2r; bi[0] = t0i + t2i;
+                        br[1] = t1r + t3r; bi[1] = t1i + t3i;
+                        br[2] = t0r - t2r; bi[2] = t0i - t2i;
+                        br[3] = t1r - t3r; bi[3] = t1i - t3i;
+                        break;
+                    }
+                    default:    // 5
+                        for (size_t t = 0; t < 5; t++) {
+                            double sr = 0.0, si = 0.0;
+                            for (size_t r = 0; r < 5; r++) {
+                                size_t k = (r * t) % 5;
+                                sr += ar[r] * kCos5[k] - ai[r] * kSin5[k];
+                                si += ar[r] * kSin5[k] + ai[r] * kCos5[k];
+                            }
+                            br[t] = sr;
+                            bi[t] = si;
+                        }
+                        break;
+                }
+
+                size_t base = q + s * p * j;
+                yr[base] = br[0];
+                yi[base] = bi[0];
+                for (size_t t = 1; t < p; t++) {
+                    size_t w = j * t * s;
+                    yr[base + s * t] = br[t] * twr[w] - bi[t] * twi[w];
+                    yi[base + s * t] = br[t] * twi[w] + bi[t] * twr[w];
+                }
+            }
+        }
+
+        double *tr = xr; xr = yr; yr = tr;
+        double *ti = xi; xi = yi; yi = ti;
+        len = m;
+        s *= p;
+    }
+
+    if (xr != re) {
+        memcpy(re, xr, n * sizeof(double));
+        memcpy(im, xi, n * sizeof(double));
+    }
+}
+
+/**
+ * Bluestein（chirp-z）：任意长度的DFT转为快速长度M上的循环卷积
+ * X_k = w_k · Σ_j (x_j·w_j)·conj(w_{k-j})，w_k = e^{-πik²/n}
+ */
+static bool PIDBluesteinForward(const PIDFFTPlan *plan, double *re, double *im, double *scratch) {
+    size_t n = plan->length;
+    size_t big = plan->bluesteinPlan->length;
+    double *ar = scratch;
+    double *ai = scratch + big;
+
+    for (size_t k = 0; k < n; k++) {
+        ar[k] = re[k] * plan->chirpReal[k] - im[k] * plan->chirpImag[k];
+        ai[k] = re[k] * plan->chirpImag[k] + im[k] * plan->chirpReal[k];
+    }
+    memset(ar + n, 0, (big - n) * sizeof(double));
+    memset(ai + n, 0, (big - n) * sizeof(double));
+
+    if (!PIDFFTComplexRaw(plan->bluesteinPlan, ar, ai, false)) {
+        return false;
+    }
+    for (size_t k = 0; k < big; k++) {
+        double r = ar[k] * plan->kernelReal[k] - ai[k] * plan->kernelImag[k];
+        double i = ar[k] * plan->kernelImag[k] + ai[k] * plan->kernelReal[k];
+        ar[k] = r;
+        ai[k] = i;
+    }
+    if (!PIDFFTComplexRaw(plan->bluesteinPlan, ar, ai, true)) {
+        return false;
+    }
+
+    double scale = 1.0 / (double)big;
+    for (size_t k = 0; k < n; k++) {
+        double r = ar[k] * scale;
+        double i = ai[k] * scale;
+        re[k] = r * plan->chirpReal[k] - i * plan->chirpImag[k];
+        im[k] = r * plan->chirpImag[k] + i * plan->chirpReal[k];
+    }
+    return true;
+}
+
+static bool PIDPortableComplexTransform(const PIDFFTPlan *plan, double *re, double *im, bool inverse, double *scratch) {
+    size_t n = plan->length;
+    if (n < 2) {
+        return true;
+    }
+
+    // 逆变换：conj(FFT(conj(X)))
+    if (inverse) {
+        for (size_t i = 0; i < n; i++) {
+            im[i] = -im[i];
+        }
+    }
+
+    bool ok = true;
+    if (plan->bluesteinPlan) {
+        ok = PIDBluesteinForward(plan, re, im, scratch);
+    } else {
+        PIDStockhamForward(plan, re, im, scratch);
+    }
+
+    if (inverse) {
+        for (size_t i = 0; i < n; i++) {
+            im[i] = -im[i];
+        }
+    }
+    return ok;
+}
+
+static bool PIDPortableSetup(PIDFFTPlan *plan) {
+    size_t n = plan->length;
+
+    // 分解为4/2/3/5，优先基4
+    size_t rest = n;
+    while (rest % 4 == 0 && plan->radixCount < PID_FFT_MAX_RADICES) {
+        plan->radices[plan->radixCount++] = 4;
+        rest /= 4;
+    }
+    static const size_t kRadices[] = { 2, 3, 5 };
+    for (size_t i = 0; i < 3; i++) {
+        while (rest % kRadices[i] == 0 && plan->radixCount < PID_FFT_MAX_RADICES) {
+            plan->radices[plan->radixCount++] = kRadices[i];
+            rest /= kRadices[i];
+        }
+    }
+
+    if (rest == 1) {
+        plan->complexScratch = 2 * n;
+        return true;
+    }
+
+    // 含其他质因子：Bluestein，卷积长度为不小于2n-1的快速长度
+    plan->radixCount = 0;
+    plan->bluesteinPlan = PIDFFTPlanForLength(PIDFFTFastLength(2 * n - 1), PIDFFTBackendPortable);
+    if (!plan->bluesteinPlan) {
+        return false;
+    }
+    size_t big = plan->bluesteinPlan->length;
+
+    plan->chirpReal = (double *)malloc(n * sizeof(double));
+    plan->chirpImag = (double *)malloc(n * sizeof(double));
+    plan->kernelReal = (double *)calloc(big, sizeof(double));
+    plan->kernelImag = (double *)calloc(big, sizeof(double));
+    if (!plan->chirpReal || !plan->chirpImag || !plan->kernelReal || !plan->kernelImag) {
+        return false;
+    }
+
+    for (size_t k = 0; k < n; k++) {
+        // k²对2n取模，避免大k时角度精度损失
+        size_t k2 = (size_t)(((unsigned long long)k * k) % (2ULL * n));
+        double angle = -kPIDFFTPi * (double)k2 / (double)n;
+        plan->chirpReal[k] = cos(angle);
+        plan->chirpImag[k] = sin(angle);
+    }
+
+    // 卷积核 b_l = conj(w_|l|)，l ∈ (-n, n)，循环放置
+    plan->kernelReal[0] = 1.0;
+    for (size_t k = 1; k < n; k++) {
+        plan->kernelReal[k] = plan->chirpReal[k];
+        plan->kernelImag[k] = -plan->chirpImag[k];
+        plan->kernelReal[big - k] = plan->chirpReal[k];
+        plan->kernelImag[big - k] = -plan->chirpImag[k];
+    }
+    if (!PIDFFTComplexRaw(plan->bluesteinPlan, plan->kernelReal, plan->kernelImag, false)) {
+        return false;
+    }
+
+    plan->complexScratch = 2 * big;
+    return true;
+}
+
+static void PIDPortableTeardown(PIDFFTPlan *plan) {
+    free(plan->chirpReal);
+    free(plan->chirpImag);
+    free(plan->kernelReal);
+    free(plan->kernelImag);
+}
+
+static const PIDFFTBackendOps kPortableBackend = {
+    .kind = PIDFFTBackendPortable,
+    .name = "Portable",
+    .supportsLength = PIDPortableSupportsLength,
+    .setup = PIDPortableSetup,
+    .teardown = PIDPortableTeardown,
+    .complexTransform = PIDPortableComplexTransform,
+    .realForward = PIDFFTGenericRealForward,
+    .realInverse = PIDFFTGenericRealInverse,
+};
+
+#pragma mark - Accelerate后端
+
+#if PID_FFT_HAS_ACCELERATE
+
+/**
+ * vDSP支持的长度：2的幂（FFTSetupD），或 f·2^k（f = 3, 5, 15，k >= 4，vDSP_DFT）
+ */
+static bool PIDAccelerateSupportsLength(size_t length) {
+    if (PIDFFTIsPowerOfTwo(length)) {
+        return true;
+    }
+    static const size_t kFactors[] = { 3, 5, 15 };
+    for (size_t i = 0; i < 3; i++) {
+        if (length % kFactors[i] != 0) {
+            continue;
+        }
+        size_t rest = length / kFactors[i];
+        if (PIDFFTIsPowerOfTwo(rest) && rest >= 16) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool PIDAccelerateSetup(PIDFFTPlan *plan) {
+    size_t n = plan->length;
+    if (PIDFFTIsPowerOfTwo(n)) {
+        while (((size_t)1 << plan->log2n) < n) {
+            plan->log2n++;
+        }
+        plan->setup = vDSP_create_fftsetupD((vDSP_Length)plan->log2n, kFFTRadix2);
+        // 单精度setup创建失败时单精度接口退回扩展为双精度计算
+        plan->setupFloat = vDSP_create_fftsetup((vDSP_Length)plan->log2n, kFFTRadix2);
+        plan->complexScratch = 0;
+        return plan->setup != NULL;
+    }
+
+    plan->dftForward = vDSP_DFT_zop_CreateSetupD(NULL, (vDSP_Length)n, vDSP_DFT_FORWARD);
+    plan->dftInverse = vDSP_DFT_zop_CreateSetupD(plan->dftForward, (vDSP_Length)n, vDSP_DFT_INVERSE);
+    plan->complexScratch = 2 * n;
+    return plan->dftForward != NULL && plan->dftInverse != NULL;
+}
+
+static void PIDAccelerateTeardown(PIDFFTPlan *plan) {
+    if (plan->setup) {
+        vDSP_destroy_fftsetupD(plan->setup);
+    }
+    if (plan->setupFloat) {
+        vDSP_destroy_fftsetup(plan->setupFloat);
+    }
+    if (plan->dftInverse) {
+        vDSP_DFT_DestroySetupD(plan->dftInverse);
+    }
+    if (plan->dftForward) {
+        vDSP_DFT_DestroySetupD(plan->dftForward);
+    }
+}
+
+static bool PIDAccelerateComplexTransform(const PIDFFTPlan *plan, double *re, double *im, bool inverse, double *scratch) {
+    if (plan->setup) {
+        DSPDoubleSplitComplex split = { re, im };
+        vDSP_fft_zipD(plan->setup, &split, 1, (vDSP_Length)plan->log2n, inverse ? kFFTDirection_Inverse : kFFTDirection_Forward);
+        return true;
+    }
+
+    size_t n = plan->length;
+    double *outReal = scratch;
+    double *outImag = scratch + n;
+    vDSP_DFT_ExecuteD(inverse ? plan->dftInverse : plan->dftForward, re, im, outReal, outImag);
+    memcpy(re, outReal, n * sizeof(double));
+    memcpy(im, outImag, n * sizeof(double));
+    return true;
+}
+
+/**
+ * 2的幂长度使用原生实数FFT
+ * vDSP打包格式：realp[0]=DC, imagp[0]=Nyquist, 其余为X[k]，且整体放大2倍
+ */
+static bool PIDAccelerateRealForward(const PIDFFTPlan *plan, const double *input,
+                                     double *outReal, double *outImag, double *scratch) {
+    if (!plan->setup) {
+        return PIDFFTGenericRealForward(plan, input, outReal, outImag, scratch);
+    }
+
+    vDSP_Length m = (vDSP_Length)(plan->length / 2);
+
+    // 直接在输出缓冲区中打包（输出各有m+1个点）
+    DSPDoubleSplitComplex split = { outReal, outImag };
+    vDSP_ctozD((const DSPDoubleComplex *)input, 2, &split, 1, m);
+    vDSP_fft_zripD(plan->setup, &split, 1, (vDSP_Length)plan->log2n, kFFTDirection_Forward);
+
+    double half = 0.5;
+    outReal[m] = outImag[0];
+    outImag[0] = 0.0;
+    outImag[m] = 0.0;
+    vDSP_vsmulD(outReal, 1, &half, outReal, 1, m + 1);
+    vDSP_vsmulD(outImag, 1, &half, outImag, 1, m);
+    return true;
+}
+
+static bool PIDAccelerateRealInverse(const PIDFFTPlan *plan, const double *inReal, const double *inImag,
+                                     double *output, double *scratch) {
+    if (!plan->setup) {
+        return PIDFFTGenericRealInverse(plan, inReal, inImag, output, scratch);
+    }
+
+    vDSP_Length m = (vDSP_Length)(plan->length / 2);
+    double *work = scratch + plan->complexScratch;
+    DSPDoubleSplitComplex split = { work, work + m };
+
+    memcpy(split.realp, inReal, m * sizeof(double));
+    memcpy(split.imagp, inImag, m * sizeof(double));
+    split.imagp[0] = inReal[m];
+
+    vDSP_fft_zripD(plan->setup, &split, 1, (vDSP_Length)plan->log2n, kFFTDirection_Inverse);
+    vDSP_ztocD(&split, 1, (DSPDoubleComplex *)output, 2, m);
+    return true;
+}
+
+static const PIDFFTBackendOps kAccelerateBackend = {
+    .kind = PIDFFTBackendAccelerate,
+    .name = "Accelerate",
+    .supportsLength = PIDAccelerateSupportsLength,
+    .setup = PIDAccelerateSetup,
+    .teardown = PIDAccelerateTeardown,
+    .complexTransform = PIDAccelerateComplexTransform,
+    .realForward = PIDAccelerateRealForward,
+    .realInverse = PIDAccelerateRealInverse,
+};
+
+#endif
+
+#pragma mark - 后端选择
+
+static const PIDFFTBackendOps *PIDFFTBackendOpsFor(PIDFFTBackend backend) {
+    switch (backend) {
+        case PIDFFTBackendAutomatic:
+#if PID_FFT_HAS_ACCELERATE
+            return &kAccelerateBackend;
+#else
+            return &kPortableBackend;
+#endif
+        case PIDFFTBackendAccelerate:
+#if PID_FFT_HAS_ACCELERATE
+            return &kAccelerateBackend;
+#else
+            return NULL;
+#endif
+        case PIDFFTBackendPortable:
+            return &kPortableBackend;
+    }
+    return NULL;
+}
+
+/**
+ * 指定长度实际使用的后端：Automatic在平台后端不支持该长度时退回可移植实现
+ */
+static const PIDFFTBackendOps *PIDFFTBackendOpsForLength(PIDFFTBackend backend, size_t length) {
+    const PIDFFTBackendOps *ops = PIDFFTBackendOpsFor(backend);
+    if (ops && !ops->supportsLength(length)) {
+        ops = (backend == PIDFFTBackendAutomatic) ? &kPortableBackend : NULL;
+    }
+    return ops;
+}
+
+bool PIDFFTBackendIsAvailable(PIDFFTBackend backend) {
+    return PIDFFTBackendOpsFor(backend) != NULL;
+}
+
+const char *PIDFFTBackendName(PIDFFTBackend backend) {
+    const PIDFFTBackendOps *ops = PIDFFTBackendOpsFor(backend);
+    return ops ? ops->name : "Unavailable";
+}
+
+#pragma mark - 计划缓存
+
+static pthread_mutex_t gPlanCacheLock = PTHREAD_MUTEX_INITIALIZER;
+static PIDFFTPlan *gPlanCache = NULL;
+
+static PIDFFTPlan *PIDFFTPlanLookup(size_t length, const PIDFFTBackendOps *ops) {
+    PIDFFTPlan *plan = gPlanCache;
+    while (plan && !(plan->length == length && plan->ops == ops)) {
+        plan = plan->next;
+    }
+    return plan;
+}
+
+static void PIDFFTPlanDestroy(PIDFFTPlan *plan) {
+    if (plan->ops->teardown) {
+        plan->ops->teardown(plan);
+    }
+    free(plan->twiddleReal);
+    free(plan->twiddleImag);
+    pthread_mutex_destroy(&plan->scratchLock);
+    free(plan);
+}
+
+static PIDFFTPlan *PIDFFTPlanCreate(size_t length, const PIDFFTBackendOps *ops) {
+    PIDFFTPlan *plan = (PIDFFTPlan *)calloc(1, sizeof(PIDFFTPlan));
+    if (!plan) {
+        return NULL;
+    }
+    plan->length = length;
+    plan->ops = ops;
+    pthread_mutex_init(&plan->scratchLock, NULL);
+
+    plan->twiddleReal = (double *)malloc(length * sizeof(double));
+    plan->twiddleImag = (double *)malloc(length * sizeof(double));
+    if (!plan->twiddleReal || !plan->twiddleImag) {
+        PIDFFTPlanDestroy(plan);
+        return NULL;
+    }
+    for (size_t j = 0; j < length; j++) {
+        double angle = -2.0 * kPIDFFTPi * (double)j / (double)length;
+        plan->twiddleReal[j] = cos(angle);
+        plan->twiddleImag[j] = sin(angle);
+    }
+
+    // 偶数长度的实数变换需要半长复数计划（Accelerate的2的幂长度有原生实数FFT，不需要）
+    // 子计划在缓存锁外获取（setup中的Bluestein同理）
+    bool nativeReal = ops->kind == PIDFFTBackendAccelerate && PIDFFTIsPowerOfTwo(length);
+    if (length % 2 == 0 && !nativeReal) {
+        PIDFFTBackend halfBackend = (ops->kind == PIDFFTBackendPortable) ? PIDFFTBackendPortable : PIDFFTBackendAutomatic;
+        plan->halfPlan = PIDFFTPlanForLength(length / 2, halfBackend);
+        if (!plan->halfPlan) {
+            PIDFFTPlanDestroy(plan);
+            return NULL;
+        }
+    }
+
+    if (!ops->setup(plan)) {
+        PIDFFTPlanDestroy(plan);
+        return NULL;
+    }
+    plan->scratchLength = plan->complexScratch + 2 * length + length + 2 * (length / 2 + 1);
+    return plan;
+}
+
+const PIDFFTPlan *PIDFFTPlanForLength(size_t length, PIDFFTBackend backend) {
+    if (length < 1) {
+        return NULL;
+    }
+    const PIDFFTBackendOps *ops = PIDFFTBackendOpsForLength(backend, length);
+    if (!ops) {
+        return NULL;
+    }
+
+    pthread_mutex_lock(&gPlanCacheLock);
+    PIDFFTPlan *plan = PIDFFTPlanLookup(length, ops);
+    pthread_mutex_unlock(&gPlanCacheLock);
+    if (plan) {
+        return plan;
+    }
+
+    // 在锁外创建（可能递归获取子计划），插入前再查一次，并发创建时保留先插入的那个
+    PIDFFTPlan *created = PIDFFTPlanCreate(length, ops);
+    if (!created) {
+        return NULL;
+    }
+
+    pthread_mutex_lock(&gPlanCacheLock);
+    plan = PIDFFTPlanLookup(length, ops);
+    if (!plan) {
+        created->next = gPlanCache;
+        gPlanCache = created;
+        plan = created;
+        created = NULL;
+    }
+    pthread_mutex_unlock(&gPlanCacheLock);
+
+    if (created) {
+        PIDFFTPlanDestroy(created);
+    }
+    return plan;
+}
+
+size_t PIDFFTPlanLength(const PIDFFTPlan *plan) {
+    return plan ? plan->length : 0;
+}
+
+PIDFFTBackend PIDFFTPlanBackend(const PIDFFTPlan *plan) {
+    return plan ? plan->ops->kind : PIDFFTBackendAutomatic;
+}
+
+#pragma mark - 变换
+
+static void PIDFFTScale(double *data, size_t count, double scale) {
+    for (size_t i = 0; i < count; i++) {
+        data[i] *= scale;
+    }
+}
+
+bool PIDFFTRealForward(const PIDFFTPlan *plan, const double *input,
+                       double *outReal, double *outImag) {
+    if (plan->length == 1) {
+        outReal[0] = input[0];
+        outImag[0] = 0.0;
+        return true;
+    }
+    double *scratch = PIDFFTScratchAcquire(plan);
+    if (!scratch) {
+        return false;
+    }
+    bool ok = plan->ops->realForward(plan, input, outReal, outImag, scratch);
+    PIDFFTScratchRelease(plan, scratch);
+    return ok;
+}
+
+bool PIDFFTRealInverse(const PIDFFTPlan *plan, const double *inReal, const double *inImag,
+                       double *output) {
+    if (plan->length == 1) {
+        output[0] = inReal[0];
+        return true;
+    }
+    double *scratch = PIDFFTScratchAcquire(plan);
+    if (!scratch) {
+        return false;
+    }
+    bool ok = plan->ops->realInverse(plan, inReal, inImag, output, scratch);
+    PIDFFTScratchRelease(plan, scratch);
+    if (!ok) {
+        return false;
+    }
+
+    PIDFFTScale(output, plan->length, 1.0 / (double)plan->length);
+    return true;
+}
+
+bool PIDFFTComplexForward(const PIDFFTPlan *plan, const double *inReal, const double *inImag,
+                          double *outReal, double *outImag) {
+    if (outReal != inReal) {
+        memmove(outReal, inReal, plan->length * sizeof(double));
+    }
+    if (outImag != inImag) {
+        memmove(outImag, inImag, plan->length * sizeof(double));
+    }
+    return PIDFFTComplexRaw(plan, outReal, outImag, false);
+}
+
+bool PIDFFTComplexInverse(const PIDFFTPlan *plan, const double *inReal, const double *inImag,
+                          double *outReal, double *outImag) {
+    if (outReal != inReal) {
+        memmove(outReal, inReal, plan->length * sizeof(double));
+    }
+    if (outImag != inImag) {
+        memmove(outImag, inImag, plan->length * sizeof(double));
+    }
+    if (!PIDFFTComplexRaw(plan, outReal, outImag, true)) {
+        return false;
+    }
+
+    double scale = 1.0 / (double)plan->length;
+    PIDFFTScale(outReal, plan->length, scale);
+    PIDFFTScale(outImag, plan->length, scale);
+    return true;
+}
+
+#pragma mark - 单精度变换
+
+/**
+ * 单精度接口扩展为双精度时使用的临时内存（在实数变换的工作区之后）
+ */
+static double *PIDFFTWideScratch(const PIDFFTPlan *plan, double *scratch) {
+    return scratch + plan->complexScratch + 2 * plan->length;
+}
+
+bool PIDFFTRealForwardF(const PIDFFTPlan *plan, const float *input,
+                        float *outReal, float *outImag) {
+    size_t n = plan->length;
+    if (n == 1) {
+        outReal[0] = input[0];
+        outImag[0] = 0.0f;
+        return true;
+    }
+    double *scratch = PIDFFTScratchAcquire(plan);
+    if (!scratch) {
+        return false;
+    }
+
+#if PID_FFT_HAS_ACCELERATE
+    if (plan->setupFloat) {
+        // 与双精度原生实数FFT相同的打包格式：realp[0]=DC, imagp[0]=Nyquist，整体放大2倍
+        vDSP_Length m = (vDSP_Length)(n / 2);
+        DSPSplitComplex split = { outReal, outImag };
+        vDSP_ctoz((const DSPComplex *)input, 2, &split, 1, m);
+        vDSP_fft_zrip(plan->setupFloat, &split, 1, (vDSP_Length)plan->log2n, kFFTDirection_Forward);
+
+        float half = 0.5f;
+        outReal[m] = outImag[0];
+        outImag[0] = 0.0f;
+        outImag[m] = 0.0f;
+        vDSP_vsmul(outReal, 1, &half, outReal, 1, m + 1);
+        vDSP_vsmul(outImag, 1, &half, outImag, 1, m);
+        PIDFFTScratchRelease(plan, scratch);
+        return true;
+    }
+#endif
+
+    size_t binCount = n / 2 + 1;
+    double *wideInput = PIDFFTWideScratch(plan, scratch);
+    double *wideReal = wideInput + n;
+    double *wideImag = wideReal + binCount;
+    for (size_t i = 0; i < n; i++) {
+        wideInput[i] = input[i];
+    }
+    bool ok = plan->ops->realForward(plan, wideInput, wideReal, wideImag, scratch);
+    for (size_t k = 0; ok && k < binCount; k++) {
+        outReal[k] = (float)wideReal[k];
+        outImag[k] = (float)wideImag[k];
+    }
+    PIDFFTScratchRelease(plan, scratch);
+    return ok;
+}
+
+bool PIDFFTRealInverseF(const PIDFFTPlan *plan, const float *inReal, const float *inImag,
+                        float *output) {
+    size_t n = plan->length;
+    if (n == 1) {
+        output[0] = inReal[0];
+        return true;
+    }
+    double *scratch = PIDFFTScratchAcquire(plan);
+    if (!scratch) {
+        return false;
+    }
+    float scale = (float)(1.0 / (double)n);
+
+#if PID_FFT_HAS_ACCELERATE
+    if (plan->setupFloat) {
+        vDSP_Length m = (vDSP_Length)(n / 2);
+        float *work = (float *)(scratch + plan->complexScratch);
+        DSPSplitComplex split = { work, work + m };
+
+        memcpy(split.realp, inReal, m * sizeof(float));
+        memcpy(split.imagp, inImag, m * sizeof(float));
+        split.imagp[0] = inReal[m];
+
+        vDSP_fft_zrip(plan->setupFloat, &split, 1, (vDSP_Length)plan->log2n, kFFTDirection_Inverse);
+        vDSP_ztoc(&split, 1, (DSPComplex *)output, 2, m);
+        vDSP_vsmul(output, 1, &scale, output, 1, (vDSP_Length)n);
+        PIDFFTScratchRelease(plan, scratch);
+        return true;
+    }
+#endif
+
+    size_t binCount = n / 2 + 1;
+    double *wideOutput = PIDFFTWideScratch(plan, scratch);
+    double *wideReal = wideOutput + n;
+    double *wideImag = wideReal + binCount;
+    for (size_t k = 0; k < binCount; k++) {
+        wideReal[k] = inReal[k];
+        wideImag[k] = inImag[k];
+    }
+    bool ok = plan->ops->realInverse(plan, wideReal, wideImag, wideOutput, scratch);
+    for (size_t i = 0; ok && i < n; i++) {
+        output[i] = (float)wideOutput[i] * scale;
+    }
+    PIDFFTScratchRelease(plan, scratch);
+    return ok;
+}
@@ -0,0 +1,114 @@
+//
+//  PIDFFTPlan.h
+//  PID_Liner
+//
+//  FFT计划缓存 - 按长度缓存旋转因子、后端setup和临时内存，提供原始缓冲区上的实数/复数FFT
+//  支持任意长度：2/3/4/5混合基（Stockham），其余长度使用Bluestein
+//  纯C实现，不依赖Foundation：Apple平台默认走Accelerate后端，
+//  其他平台（Linux上的对拍与基准测试）走可移植后端，两者结果一致
+//
+
+#ifndef PIDFFTPlan_h
+#define PIDFFTPlan_h
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * FFT后端
+ */
+typedef enum {
+    PIDFFTBackendAutomatic = 0,     // Apple平台为Accelerate，其他平台为Portable
+    PIDFFTBackendAccelerate,        // vDSP（仅Apple平台可用）
+    PIDFFTBackendPortable,          // 可移植C实现（Stockham混合基 + Bluestein）
+} PIDFFTBackend;
+
+/**
+ * FFT计划（不透明类型）
+ * 计划创建后常驻缓存、只读，可被任意多个线程同时使用
+ */
+typedef struct PIDFFTPlan PIDFFTPlan;
+
+/**
+ * 后端在当前平台是否可用
+ */
+bool PIDFFTBackendIsAvailable(PIDFFTBackend backend);
+
+/**
+ * 后端名称（用于日志和基准测试输出）
+ */
+const char *PIDFFTBackendName(PIDFFTBackend backend);
+
+/**
+ * 不小于minimum的最小快速长度（2^a·3^b·5^c，a >= 1）
+ * 需要补零的信号应一次补到这个长度，不要再补到2的幂次
+ */
+size_t PIDFFTFastLength(size_t minimum);
+
+/**
+ * 获取指定长度的FFT计划（线程安全，同一长度和后端只创建一次）
+ * 任意长度均可：2/3/5的合数走混合基，含其他质因子的长度走Bluestein（结果相同，较慢）
+ * Automatic在Accelerate不支持该长度时（vDSP只支持2^k和3/5/15·2^k）使用可移植实现
+ * @param length 变换长度（>= 1）
+ * @param backend 后端，Automatic表示平台默认后端
+ * @return 计划；显式指定的后端不支持该长度或不可用时返回NULL
+ */
+const PIDFFTPlan *PIDFFTPlanForLength(size_t length, PIDFFTBackend backend);
+
+/**
+ * 计划的变换长度与实际后端
+ */
+size_t PIDFFTPlanLength(const PIDFFTPlan *plan);
+PIDFFTBackend PIDFFTPlanBackend(const PIDFFTPlan *plan);
+
+/**
+ * 实数 -> 复数FFT，对应numpy.fft.rfft（不归一化）
+ * @param input 实数输入，长度n
+ * @param outReal/outImag 输出频谱 [0, n/2]，各n/2+1个点
+ * 输入与输出不能重叠
+ * @return 临时内存分配失败时返回false，输出内容未定义（以下各变换相同）
+ */
+bool PIDFFTRealForward(const PIDFFTPlan *plan, const double *input,
+                       double *outReal, double *outImag);
+
+/**
+ * 复数 -> 实数逆FFT，对应numpy.fft.irfft（含1/n缩放）
+ * @param inReal/inImag 频谱 [0, n/2]，各n/2+1个点（DC和Nyquist的虚部被忽略）
+ * @param output 实数输出，长度n
+ * 输入与输出不能重叠
+ */
+bool PIDFFTRealInverse(const PIDFFTPlan *plan, const double *inReal, const double *inImag,
+                       double *output);
+
+/**
+ * 复数FFT，对应numpy.fft.fft（不归一化）
+ * 输入输出各n个点，允许原地变换（out与in为同一缓冲区）
+ */
+bool PIDFFTComplexForward(const PIDFFTPlan *plan, const double *inReal, const double *inImag,
+                          double *outReal, double *outImag);
+
+/**
+ * 复数逆FFT，对应numpy.fft.ifft（含1/n缩放）
+ * 输入输出各n个点，允许原地变换
+ */
+bool PIDFFTComplexInverse(const PIDFFTPlan *plan, const double *inReal, const double *inImag,
+                          double *outReal, double *outImag);
+
+/**
+ * 单精度实数FFT（PIDPrecision.h 的float32路径使用），语义与 PIDFFTRealForward / PIDFFTRealInverse 相同
+ * Accelerate后端的2的幂长度走vDSP单精度FFT；其他长度与可移植后端在内部扩展为双精度计算
+ */
+bool PIDFFTRealForwardF(const PIDFFTPlan *plan, const float *input,
+                        float *outReal, float *outImag);
+bool PIDFFTRealInverseF(const PIDFFTPlan *plan, const float *inReal, const float *inImag,
+                        float *output);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PIDFFTPlan_h */
@@ -11,6 +11,7 @@
 
 #import <Foundation/Foundation.h>
 #import <Accelerate/Accelerate.h>  // 用于vDSP_Length等类型
+#import "PIDFFTPlan.h"             // 原始缓冲区上的实数/复数FFT与计划缓存
 
 NS_ASSUME_NONNULL_BEGIN
 
@@ -18,6 +19,9 @@ NS_ASSUME_NONNULL_BEGIN
  * FFT处理器
  * 使用Apple Accelerate框架的vDSP进行高性能FFT计算
  * 对应Python: numpy.fft
+ *
+ * NSArray接口用于兼容现有调用；热路径请直接使用PIDFFTPlan.h中的原始缓冲区接口，
+ * 计划按长度缓存，可在多个线程中同时使用
  */
 @interface PIDFFTProcessor : NSObject
 
@@ -25,7 +29,7 @@ NS_ASSUME_NONNULL_BEGIN
  * 执行一维复数FFT
  * @param realInput 实部输入数组
  * @param imagInput 虚部输入数组（可以为nil，表示虚部全为0）
- * @param length 输入长度（必须是2的幂次）
+ * @param length 变换长度（任意长度；需要补零时用fastLengthForLength:取快速长度）
  * @return 包含FFT结果的字典 @{@"real": 实部数组, @"imag": 虚部数组}
  */
 - (NSDictionary<NSString *, NSArray<NSNumber *> *> *)fftWithReal:(NSArray<NSNumber *> *)realInput
@@ -36,7 +40,7 @@ NS_ASSUME_NONNULL_BEGIN
  * 执行一维复数IFFT（逆FFT）
  * @param realInput 频域实部输入
  * @param imagInput 频域虚部输入
- * @param length 输入长度（必须是2的幂次）
+ * @param length 变换长度（任意长度；需要补零时用fastLengthForLength:取快速长度）
  * @return 包含IFFT结果的字典 @{@"real": 实部数组, @"imag": 虚部数组}
  */
 - (NSDictionary<NSString *, NSArray<NSNumber *> *> *)ifftWithReal:(NSArray<NSNumber *> *)realInput
@@ -46,8 +50,8 @@ NS_ASSUME_NONNULL_BEGIN
 /**
  * 执行实数FFT（更高效的版本，当输入只有实数时使用）
  * @param input 实数输入数组
- * @param length 输入长度（必须是2的幂次）
- * @return FFT结果的实部（频域）
+ * @param length 变换长度（任意长度；需要补零时用fastLengthForLength:取快速长度）
+ * @return FFT结果的实部（频域，完整长度，负频率部分由共轭对称得到）
  */
 - (NSArray<NSNumber *> *)realFFT:(NSArray<NSNumber *> *)input length:(vDSP_Length)length;
 
@@ -61,6 +65,12 @@ NS_ASSUME_NONNULL_BEGIN
 - (NSArray<NSNumber *> *)fftfreqWithLength:(vDSP_Length)length
                                          dt:(double)dt;
 
+/**
+ * 不小于n的最小快速FFT长度（2^a·3^b·5^c）
+ * 补零时一次补到这个长度即可，不必再补到2的幂次
+ */
++ (vDSP_Length)fastLengthForLength:(vDSP_Length)n;
+
 /**
  * 计算下一个大于等于n的2的幂次
  * 用于FFT padding
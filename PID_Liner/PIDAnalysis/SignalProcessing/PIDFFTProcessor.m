@@ -5,9 +5,12 @@
 //  Created by Claude on 2025/12/25.
 //  FFT信号处理实现 - 使用Accelerate vDSP
 //  🔧 修复: 正确处理vDSP的打包格式，对齐numpy FFT输出
+//  变换本身由PIDFFTPlan完成（计划缓存 + 实数FFT路径），这里只负责NSArray的转换
+//  中间缓冲区取自调用线程的暂存区（PIDScratchArena），返回前回退
 //
 
 #import "PIDFFTProcessor.h"
+#import "PIDScratchArena.h"
 #import <Accelerate/Accelerate.h>
 
 @implementation PIDFFTProcessor
@@ -15,12 +18,9 @@
 #pragma mark - Public Methods
 
 /**
- * vDSP打包格式说明 (n=8为例):
- * realp: [DC, f1r, f2r, f3r, Nyq,  0,   0,   0  ]
- * imagp: [0,  f1i, f2i, f3i, 0,   f3i, f2i, f1i]
- *
- * numpy标准格式:
- * [DC, f1r+f1i*i, f2r+f2i*i, f3r+f3i*i, Nyq, f3r-f3i*i, f2r-f2i*i, f1r-f1i*i]
+ * 复数FFT（numpy.fft.fft语义）
+ * 虚部为nil时走实数FFT，负频率部分由共轭对称补齐
+ * 计划（旋转因子/setup/临时内存）来自PIDFFTPlan缓存，不再每次创建
  */
 - (NSDictionary<NSString *, NSArray<NSNumber *> *> *)fftWithReal:(NSArray<NSNumber *> *)realInput
                                                             imag:(nullable NSArray<NSNumber *> *)imagInput
@@ -29,71 +29,60 @@
         return @{};
     }
 
-    // 确保长度是2的幂次
-    vDSP_Length n = [[self class] nextPowerOfTwo:length];
-
-    // 准备输入数据
-    float *inputReal = (float *)malloc(n * sizeof(float));
-    float *inputImag = (float *)malloc(n * sizeof(float));
+    // 按原长度变换（任意长度，不再补到2的幂次）
+    vDSP_Length n = length;
+    const PIDFFTPlan *plan = PIDFFTPlanForLength(n, PIDFFTBackendAutomatic);
+    if (!plan) {
+        return @{};
+    }
 
-    for (vDSP_Length i = 0; i < length; i++) {
-        inputReal[i] = [realInput[i] floatValue];
-        inputImag[i] = imagInput ? [imagInput[i] floatValue] : 0.0f;
+    // 一次分配：输入实部/虚部 + 输出实部/虚部
+    PIDScratchArena *arena = PIDScratchArenaCurrent();
+    PIDScratchMark mark = PIDScratchArenaMark(arena);
+    double *buffer = PIDScratchArenaAllocZeroed(arena, 4 * n);
+    if (!buffer) {
+        return @{};
     }
-    for (vDSP_Length i = length; i < n; i++) {
-        inputReal[i] = 0.0f;
-        inputImag[i] = 0.0f;
+    double *inputReal = buffer;
+    double *inputImag = buffer + n;
+    double *outputReal = buffer + 2 * n;
+    double *outputImag = buffer + 3 * n;
+
+    vDSP_Length realCount = MIN(length, (vDSP_Length)realInput.count);
+    for (vDSP_Length i = 0; i < realCount; i++) {
+        inputReal[i] = [realInput[i] doubleValue];
     }
 
-    // 创建FFT setup
-    vDSP_Length log2n = (vDSP_Length)log2(n);
-    FFTSetup fftSetup = vDSP_create_fftsetup(log2n, FFT_RADIX2);
-
-    // 创建split complex格式
-    DSPSplitComplex inputComplex;
-    inputComplex.realp = inputReal;
-    inputComplex.imagp = inputImag;
-
-    // 🔧 修复: 只执行FFT_FORWARD，不要执行FFT_INVERSE
-    vDSP_fft_zrip(fftSetup, &inputComplex, 1, log2n, FFT_FORWARD);
-
-    // 🔧 修复: 将vDSP打包格式转换为numpy标准格式
-    // vDSP打包格式需要正确解包
-    NSMutableArray<NSNumber *> *outputReal = [NSMutableArray arrayWithCapacity:n];
-    NSMutableArray<NSNumber *> *outputImag = [NSMutableArray arrayWithCapacity:n];
-
-    // DC分量
-    [outputReal addObject:@(inputComplex.realp[0])];
-    [outputImag addObject:@0.0f];
-
-    // 正频率分量 f1 到 f(n/2-1)
-    vDSP_Length halfN = n / 2;
-    for (vDSP_Length i = 1; i < halfN; i++) {
-        [outputReal addObject:@(inputComplex.realp[i])];
-        [outputImag addObject:@(inputComplex.imagp[i])];
+    if (imagInput) {
+        vDSP_Length imagCount = MIN(length, (vDSP_Length)imagInput.count);
+        for (vDSP_Length i = 0; i < imagCount; i++) {
+            inputImag[i] = [imagInput[i] doubleValue];
+        }
+        PIDFFTComplexForward(plan, inputReal, inputImag, outputReal, outputImag);
+    } else {
+        // 实数输入：只计算 [0, n/2]，负频率 X[n-k] = conj(X[k])
+        PIDFFTRealForward(plan, inputReal, outputReal, outputImag);
+        for (vDSP_Length k = 1; k < n - n / 2; k++) {
+            outputReal[n - k] = outputReal[k];
+            outputImag[n - k] = -outputImag[k];
+        }
     }
 
-    // Nyquist分量
-    [outputReal addObject:@(inputComplex.imagp[0])];
-    [outputImag addObject:@0.0f];
-
-    // 负频率分量 f(-n/2+1) 到 f(-1)
-    for (vDSP_Length i = halfN - 1; i > 0; i--) {
-        [outputReal addObject:@(inputComplex.realp[i])];      // 实部相同
-        [outputImag addObject:@(-inputComplex.imagp[i])];     // 虚部取反（共轭）
+    NSMutableArray<NSNumber *> *resultReal = [NSMutableArray arrayWithCapacity:n];
+    NSMutableArray<NSNumber *> *resultImag = [NSMutableArray arrayWithCapacity:n];
+    for (vDSP_Length i = 0; i < n; i++) {
+        [resultReal addObject:@(outputReal[i])];
+        [resultImag addObject:@(outputImag[i])];
     }
 
-    // 清理
-    vDSP_destroy_fftsetup(fftSetup);
-    free(inputReal);
-    free(inputImag);
+    PIDScratchArenaReset(arena, mark);
 
-    return @{@"real": outputReal, @"imag": outputImag};
+    return @{@"real": resultReal, @"imag": resultImag};
 }
 
 /**
- * IFFT - 逆傅里叶变换
- * 🔧 修复: 将numpy标准格式转换为vDSP打包格式，然后执行IFFT
+ * IFFT - 逆傅里叶变换（numpy.fft.ifft语义，缩放因子1/n）
+ * 输入为numpy标准顺序: [DC, f1, ..., Nyq, f(-n/2+1), ..., f(-1)]
  */
 - (NSDictionary<NSString *, NSArray<NSNumber *> *> *)ifftWithReal:(NSArray<NSNumber *> *)realInput
                                                              imag:(NSArray<NSNumber *> *)imagInput
@@ -101,82 +90,87 @@
     if (!realInput || length == 0) {
         return @{};
     }
-    
-    vDSP_Length n = [[self class] nextPowerOfTwo:length];
-    
-    // 准备vDSP打包格式的输入
-    float *packedReal = (float *)calloc(n, sizeof(float));
-    float *packedImag = (float *)calloc(n, sizeof(float));
-    
-    // 将numpy标准格式转换为vDSP打包格式
-    // numpy: [DC, f1, f2, ..., f(n/2-1), Nyq, f(-n/2+1), ..., f(-1)]
-    // vDSP:   realp[0]=DC, imagp[0]=Nyq, realp[1]=f1r, imagp[1]=f1i, ...
-    
-    packedReal[0] = [realInput[0] floatValue];  // DC分量
-    
-    vDSP_Length halfN = n / 2;
-    
-    // 正频率分量
-    for (vDSP_Length i = 1; i < halfN; i++) {
-        if (i < realInput.count) {
-            packedReal[i] = [realInput[i] floatValue];
-            packedImag[i] = (imagInput && i < imagInput.count) ? [imagInput[i] floatValue] : 0.0f;
-        }
+
+    vDSP_Length n = length;
+    const PIDFFTPlan *plan = PIDFFTPlanForLength(n, PIDFFTBackendAutomatic);
+    if (!plan) {
+        return @{};
     }
-    
-    // Nyquist分量
-    if (halfN < realInput.count) {
-        packedImag[0] = [realInput[halfN] floatValue];  // vDSP将Nyquist存在imagp[0]
+
+    PIDScratchArena *arena = PIDScratchArenaCurrent();
+    PIDScratchMark mark = PIDScratchArenaMark(arena);
+    double *buffer = PIDScratchArenaAllocZeroed(arena, 2 * n);
+    if (!buffer) {
+        return @{};
     }
-    
-    // 负频率分量（共轭对称，用于vDSP的打包格式）
-    for (vDSP_Length i = 1; i < halfN; i++) {
-        vDSP_Length numpyIdx = n - i;  // 对应的负频率索引
-        if (numpyIdx < realInput.count) {
-            // 负频率是正频率的共轭，vDSP打包格式会自动处理
-            // 这里不需要额外设置，vDSP会根据正频率计算
-        }
+    double *real = buffer;
+    double *imag = buffer + n;
+
+    vDSP_Length realCount = MIN(n, (vDSP_Length)realInput.count);
+    for (vDSP_Length i = 0; i < realCount; i++) {
+        real[i] = [realInput[i] doubleValue];
     }
-    
-    // 创建FFT setup
-    vDSP_Length log2n = (vDSP_Length)log2(n);
-    FFTSetup fftSetup = vDSP_create_fftsetup(log2n, FFT_RADIX2);
-    
-    DSPSplitComplex inputComplex;
-    inputComplex.realp = packedReal;
-    inputComplex.imagp = packedImag;
-    
-    // 执行IFFT
-    vDSP_fft_zrip(fftSetup, &inputComplex, 1, log2n, FFT_INVERSE);
-
-    // 🔥 关键修复: 缩放因子应该是 1/n，而不是 0.5/n
-    // Python的np.fft.ifft使用默认norm='backward'，缩放因子为 1/n
-    // 这修复了iOS输出约为Python一半的问题
-    float scale = 1.0f / n;
-    vDSP_vsmul(inputComplex.realp, 1, &scale, inputComplex.realp, 1, n);
-    vDSP_vsmul(inputComplex.imagp, 1, &scale, inputComplex.imagp, 1, n);
-    
-    // 转换为输出（只取实部，因为IFFT结果应该是实数）
+    vDSP_Length imagCount = imagInput ? MIN(n, (vDSP_Length)imagInput.count) : 0;
+    for (vDSP_Length i = 0; i < imagCount; i++) {
+        imag[i] = [imagInput[i] doubleValue];
+    }
+
+    // 原地逆变换
+    PIDFFTComplexInverse(plan, real, imag, real, imag);
+
     NSMutableArray<NSNumber *> *outputReal = [NSMutableArray arrayWithCapacity:length];
     NSMutableArray<NSNumber *> *outputImag = [NSMutableArray arrayWithCapacity:length];
-    
     for (vDSP_Length i = 0; i < length && i < n; i++) {
-        [outputReal addObject:@(inputComplex.realp[i])];
-        [outputImag addObject:@(inputComplex.imagp[i])];
+        [outputReal addObject:@(real[i])];
+        [outputImag addObject:@(imag[i])];
     }
-    
-    vDSP_destroy_fftsetup(fftSetup);
-    free(packedReal);
-    free(packedImag);
-    
+
+    PIDScratchArenaReset(arena, mark);
+
     return @{@"real": outputReal, @"imag": outputImag};
 }
 
+/**
+ * 实数FFT，返回完整长度频谱的实部
+ * 直接走实数FFT路径（半长复数FFT + 拆分），不再包装复数FFT
+ */
 - (NSArray<NSNumber *> *)realFFT:(NSArray<NSNumber *> *)input length:(vDSP_Length)length {
-    // 对于实数输入，使用标准的复数FFT（虚部为0）
-    // 实际上vDSP有专门的实数FFT，但这里使用复数版本简化实现
-    NSDictionary *result = [self fftWithReal:input imag:nil length:length];
-    return result[@"real"] ?: @[];
+    if (!input || length == 0) {
+        return @[];
+    }
+
+    vDSP_Length n = length;
+    const PIDFFTPlan *plan = PIDFFTPlanForLength(n, PIDFFTBackendAutomatic);
+    if (!plan) {
+        return @[];
+    }
+
+    vDSP_Length halfN = n / 2;
+    PIDScratchArena *arena = PIDScratchArenaCurrent();
+    PIDScratchMark mark = PIDScratchArenaMark(arena);
+    double *buffer = PIDScratchArenaAllocZeroed(arena, n + 2 * (halfN + 1));
+    if (!buffer) {
+        return @[];
+    }
+    double *samples = buffer;
+    double *specReal = buffer + n;
+    double *specImag = specReal + halfN + 1;
+
+    vDSP_Length count = MIN(length, (vDSP_Length)input.count);
+    for (vDSP_Length i = 0; i < count; i++) {
+        samples[i] = [input[i] doubleValue];
+    }
+    PIDFFTRealForward(plan, samples, specReal, specImag);
+
+    // 负频率的实部与正频率相同: X[n-k] = conj(X[k])
+    NSMutableArray<NSNumber *> *result = [NSMutableArray arrayWithCapacity:n];
+    for (vDSP_Length k = 0; k < n; k++) {
+        [result addObject:@(specReal[k <= halfN ? k : n - k])];
+    }
+
+    PIDScratchArenaReset(arena, mark);
+
+    return [result copy];
 }
 
 - (NSArray<NSNumber *> *)fftfreqWithLength:(vDSP_Length)length dt:(double)dt {
@@ -200,6 +194,10 @@
     return [freqs copy];
 }
 
++ (vDSP_Length)fastLengthForLength:(vDSP_Length)n {
+    return (vDSP_Length)PIDFFTFastLength((size_t)n);
+}
+
 + (vDSP_Length)nextPowerOfTwo:(vDSP_Length)n {
     // 计算下一个大于等于n的2的幂次
     vDSP_Length power = 1;
@@ -219,11 +217,16 @@
 
     vDSP_Length n = (vDSP_Length)real1.count;
 
-    // 转换为C数组
-    float *r1 = (float *)malloc(n * sizeof(float));
-    float *i1 = (float *)malloc(n * sizeof(float));
-    float *r2 = (float *)malloc(n * sizeof(float));
-    float *i2 = (float *)malloc(n * sizeof(float));
+    // 转换为C数组（输入两组 + 结果一组，一次从暂存区分配）
+    PIDScratchArena *arena = PIDScratchArenaCurrent();
+    PIDScratchMark mark = PIDScratchArenaMark(arena);
+    float *r1 = (float *)PIDScratchArenaAlloc(arena, 6 * n * sizeof(float));
+    if (!r1) {
+        return @{};
+    }
+    float *i1 = r1 + n;
+    float *r2 = i1 + n;
+    float *i2 = r2 + n;
 
     for (vDSP_Length j = 0; j < n; j++) {
         r1[j] = [real1[j] floatValue];
@@ -233,8 +236,8 @@
     }
 
     // 结果数组
-    float *resultReal = (float *)malloc(n * sizeof(float));
-    float *resultImag = (float *)malloc(n * sizeof(float));
+    float *resultReal = i2 + n;
+    float *resultImag = resultReal + n;
 
     // 复数乘法: (a + bi) * (c + di) = (ac - bd) + (ad + bc)i
     for (vDSP_Length j = 0; j < n; j++) {
@@ -251,8 +254,7 @@
         [outImag addObject:@(resultImag[j])];
     }
 
-    free(r1); free(i1); free(r2); free(i2);
-    free(resultReal); free(resultImag);
+    PIDScratchArenaReset(arena, mark);
 
     return @{@"real": outReal, @"imag": outImag};
 }
@@ -10,20 +10,25 @@
 #define PIDGaussianFilter_h
 
 #import <Foundation/Foundation.h>
+#import "PIDGaussianSmoothing.h"
 
 NS_ASSUME_NONNULL_BEGIN
 
 /**
  * 高斯滤波器
  * 对应Python: scipy.ndimage.filters.gaussian_filter1d
+ * NSArray接口，计算由 PIDGaussianSmoothing 的原始缓冲区核心完成
  */
 @interface PIDGaussianFilter : NSObject
 
+// 计算方法（默认Automatic：小sigma直接卷积，大sigma递归滤波）
+@property (nonatomic, assign) PIDGaussianMethod method;
+
 /**
  * 执行一维高斯滤波
  * @param data 输入数据
  * @param sigma 高斯核标准差
- * @param mode 边界处理模式: 'constant'（默认）, 'reflect', 'nearest'
+ * @param mode 边界处理模式: 'constant'（默认）, 'reflect', 'nearest', 'mirror'
  * @return 滤波后的数据
  */
 - (NSArray<NSNumber *> *)filter:(NSArray<NSNumber *> *)data
@@ -35,6 +40,11 @@ NS_ASSUME_NONNULL_BEGIN
  */
 - (NSArray<NSNumber *> *)filter:(NSArray<NSNumber *> *)data sigma:(double)sigma;
 
+/**
+ * 边界模式名称对应的枚举（未知名称按'constant'处理）
+ */
++ (PIDGaussianBoundary)boundaryForMode:(NSString *)mode;
+
 @end
 
 NS_ASSUME_NONNULL_END
@@ -0,0 +1,437 @@
+//
+//  PIDGaussianSmoothing.c
+//  PID_Liner
+//
+//  高斯平滑核心实现
+//
+
+#include "PIDGaussianSmoothing.h"
+#include "PIDParallel.h"
+#include "PIDScratchArena.h"
+
+#include <math.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__APPLE__)
+#include <Accelerate/Accelerate.h>
+#endif
+
+// axis = 0 时每次收集的列数（块内按行向量化，块之间并行）
+#define PIDGaussianColumnBlock 64
+
+size_t PIDGaussianRadius(double sigma) {
+    if (!(sigma > 0.0)) {
+        return 0;
+    }
+    return (size_t)(4.0 * sigma + 0.5);
+}
+
+PIDGaussianMethod PIDGaussianResolveMethod(double sigma, PIDGaussianMethod method) {
+    if (sigma < 0.5) {
+        return PIDGaussianMethodDirect;
+    }
+    if (method == PIDGaussianMethodAutomatic) {
+        return PIDGaussianRadius(sigma) <= PIDGaussianDirectMaxRadius ? PIDGaussianMethodDirect
+                                                                      : PIDGaussianMethodRecursive;
+    }
+    return method;
+}
+
+#pragma mark - 边界
+
+/**
+ * 把 [0, n) 之外的索引映射回数据内（scipy.ndimage的扩展规则，支持超过n的扩展）
+ * @return 数据索引；constant模式下超出范围返回-1
+ */
+static long PIDGaussianExtend(long index, long n, PIDGaussianBoundary boundary) {
+    if (index >= 0 && index < n) {
+        return index;
+    }
+    switch (boundary) {
+        case PIDGaussianBoundaryNearest:
+            return index < 0 ? 0 : n - 1;
+        case PIDGaussianBoundaryReflect: {
+            long period = 2 * n;
+            long m = index % period;
+            if (m < 0) m += period;
+            return m < n ? m : period - 1 - m;
+        }
+        case PIDGaussianBoundaryMirror: {
+            if (n == 1) return 0;
+            long period = 2 * n - 2;
+            long m = index % period;
+            if (m < 0) m += period;
+            return m < n ? m : period - m;
+        }
+        case PIDGaussianBoundaryConstant:
+        default:
+            return -1;
+    }
+}
+
+/**
+ * 收集一组平行的数据线到补边缓冲区
+ * 第i个点的width个元素位于 source + i * lineStride（连续），补边后共 n + 2*pad 行
+ */
+static void PIDGaussianGather(double *padded, const double *source, size_t n, size_t width,
+                              size_t lineStride, size_t pad, PIDGaussianBoundary boundary) {
+    size_t total = n + 2 * pad;
+    for (size_t j = 0; j < total; j++) {
+        long index = PIDGaussianExtend((long)j - (long)pad, (long)n, boundary);
+        double *dst = padded + j * width;
+        if (index < 0) {
+            memset(dst, 0, width * sizeof(double));
+        } else if (width == 1) {
+            dst[0] = source[(size_t)index * lineStride];
+        } else {
+            memcpy(dst, source + (size_t)index * lineStride, width * sizeof(double));
+        }
+    }
+}
+
+static void PIDGaussianScatter(double *destination, const double *result, size_t n, size_t width,
+                               size_t lineStride) {
+    for (size_t i = 0; i < n; i++) {
+        if (width == 1) {
+            destination[i * lineStride] = result[i];
+        } else {
+            memcpy(destination + i * lineStride, result + i * width, width * sizeof(double));
+        }
+    }
+}
+
+#pragma mark - 直接卷积
+
+/**
+ * scipy._gaussian_kernel1d：exp(-0.5·x²/σ²) 归一化，x ∈ [-radius, radius]
+ */
+static void PIDGaussianKernel(double *kernel, size_t radius, double sigma) {
+    double sum = 0.0;
+    for (size_t i = 0; i <= 2 * radius; i++) {
+        double x = (double)i - (double)radius;
+        kernel[i] = exp(-0.5 / (sigma * sigma) * x * x);
+        sum += kernel[i];
+    }
+    for (size_t i = 0; i <= 2 * radius; i++) {
+        kernel[i] /= sum;
+    }
+}
+
+/**
+ * result[i] = Σ kernel[k] · padded[i + k]，每个点width个元素
+ */
+static void PIDGaussianDirect(const double *padded, double *result, size_t n, size_t width,
+                              const double *kernel, size_t taps) {
+#if defined(__APPLE__)
+    if (width == 1) {
+        vDSP_convD(padded, 1, kernel, 1, result, 1, (vDSP_Length)n, (vDSP_Length)taps);
+        return;
+    }
+    for (size_t i = 0; i < n; i++) {
+        double *row = result + i * width;
+        vDSP_vsmulD(padded + i * width, 1, &kernel[0], row, 1, (vDSP_Length)width);
+        for (size_t k = 1; k < taps; k++) {
+            vDSP_vsmaD(padded + (i + k) * width, 1, &kernel[k], row, 1, row, 1, (vDSP_Length)width);
+        }
+    }
+#else
+    for (size_t i = 0; i < n; i++) {
+        double *row = result + i * width;
+        for (size_t c = 0; c < width; c++) {
+            row[c] = kernel[0] * padded[i * width + c];
+        }
+        for (size_t k = 1; k < taps; k++) {
+            const double *src = padded + (i + k) * width;
+            double weight = kernel[k];
+            for (size_t c = 0; c < width; c++) {
+                row[c] += weight * src[c];
+            }
+        }
+    }
+#endif
+}
+
+#pragma mark - 递归滤波
+
+/**
+ * Deriche (1993) 四阶递归高斯
+ * 核 h(x) = Σ_j [a_j·cos(ω_j·x/σ) + a'_j·sin(ω_j·x/σ)]·exp(-b_j·x/σ)，两组共轭极点，
+ * 每组写成复数一阶递归 s[k] = x[k] + z·s[k-1]，输出取 Re(α·s)；
+ * 因果部分含当前点，反因果部分不含，两者相加即对称核。峰值误差约5e-4，与sigma无关
+ */
+typedef struct {
+    double alphaRe[2], alphaIm[2];  // α = a - i·a'
+    double betaRe[2], betaIm[2];    // β = α·z（反因果部分从下一个点开始）
+    double zRe[2], zIm[2];          // z = exp((-b + i·ω)/σ)
+    double gain;                    // 1 / 核总和（直流增益归一化为1）
+} PIDGaussianRecursiveCoefficients;
+
+static PIDGaussianRecursiveCoefficients PIDGaussianDericheCoefficients(double sigma) {
+    static const double a[2] = {1.680, -0.6803};
+    static const double aSin[2] = {3.735, -0.2598};
+    static const double b[2] = {1.783, 1.723};
+    static const double omega[2] = {0.6318, 1.997};
+
+    PIDGaussianRecursiveCoefficients c;
+    double total = 0.0;
+    for (int j = 0; j < 2; j++) {
+        double decay = exp(-b[j] / sigma);
+        c.zRe[j] = decay * cos(omega[j] / sigma);
+        c.zIm[j] = decay * sin(omega[j] / sigma);
+        c.alphaRe[j] = a[j];
+        c.alphaIm[j] = -aSin[j];
+        c.betaRe[j] = c.alphaRe[j] * c.zRe[j] - c.alphaIm[j] * c.zIm[j];
+        c.betaIm[j] = c.alphaRe[j] * c.zIm[j] + c.alphaIm[j] * c.zRe[j];
+
+        // Σ_{k>=0} Re(α·z^k) = Re(α / (1 - z))；对称核总和 = 2·因果和 - h(0)
+        double denRe = 1.0 - c.zRe[j];
+        double denIm = -c.zIm[j];
+        double den = denRe * denRe + denIm * denIm;
+        total += 2.0 * (c.alphaRe[j] * denRe + c.alphaIm[j] * denIm) / den - c.alphaRe[j];
+    }
+    c.gain = 1.0 / total;
+    return c;
+}
+
+/**
+ * 在补边缓冲区上做因果+反因果递归，结果写入 result（只保留中间n个点）
+ * constant模式的边界外全为0，初始状态为0即精确；其他模式以补边端点值的稳态作为初始状态
+ * @param state 2*width个double
+ */
+static void PIDGaussianRecursive(const double *padded, double *result, size_t n, size_t width, size_t pad,
+                                 const PIDGaussianRecursiveCoefficients *c, bool steadyStart, double *state) {
+    size_t total = n + 2 * pad;
+    double *stateRe = state;
+    double *stateIm = state + width;
+    memset(result, 0, n * width * sizeof(double));
+
+    for (int j = 0; j < 2; j++) {
+        double zr = c->zRe[j], zi = c->zIm[j];
+        double denRe = 1.0 - zr, denIm = -zi;
+        double den = denRe * denRe + denIm * denIm;
+
+        // 因果：s[k] = x[k] + z·s[k-1]，y[k] += Re(α·s[k])
+        for (size_t k = 0; k < width; k++) {
+            // 稳态 s = v / (1 - z)，递归从第0个点开始，所以初始值取 z·s 之前的状态
+            double v = steadyStart ? padded[k] : 0.0;
+            stateRe[k] = v * denRe / den;
+            stateIm[k] = -v * denIm / den;
+        }
+        double ar = c->alphaRe[j], ai = c->alphaIm[j];
+        for (size_t i = 0; i < total; i++) {
+            const double *x = padded + i * width;
+            bool keep = i >= pad && i < pad + n;
+            double *y = keep ? result + (i - pad) * width : NULL;
+            for (size_t k = 0; k < width; k++) {
+                double sr = x[k] + zr * stateRe[k] - zi * stateIm[k];
+                double si = zr * stateIm[k] + zi * stateRe[k];
+                stateRe[k] = sr;
+                stateIm[k] = si;
+                if (y) y[k] += ar * sr - ai * si;
+            }
+        }
+
+        // 反因果：y[k] += Re(β·s'[k+1])，s'[k] = x[k] + z·s'[k+1]
+        for (size_t k = 0; k < width; k++) {
+            double v = steadyStart ? padded[(total - 1) * width + k] : 0.0;
+            stateRe[k] = v * denRe / den;
+            stateIm[k] = -v * denIm / den;
+        }
+        double br = c->betaRe[j], bi = c->betaIm[j];
+        for (size_t r = 0; r < total; r++) {
+            size_t i = total - 1 - r;
+            const double *x = padded + i * width;
+            bool keep = i >= pad && i < pad + n;
+            double *y = keep ? result + (i - pad) * width : NULL;
+            for (size_t k = 0; k < width; k++) {
+                if (y) y[k] += br * stateRe[k] - bi * stateIm[k];
+                double sr = x[k] + zr * stateRe[k] - zi * stateIm[k];
+                double si = zr * stateIm[k] + zi * stateRe[k];
+                stateRe[k] = sr;
+                stateIm[k] = si;
+            }
+        }
+    }
+
+    double gain = c->gain;
+    for (size_t i = 0; i < n * width; i++) {
+        result[i] *= gain;
+    }
+}
+
+#pragma mark - 数据线组
+
+/**
+ * 一次平滑的参数（各线程共享，只读）
+ */
+typedef struct {
+    PIDGaussianMethod method;
+    PIDGaussianBoundary boundary;
+    size_t pad;                 // 两端补边点数（直接卷积为核半径）
+    const double *kernel;       // 直接卷积的核（2*pad+1个点，取自调用线程的暂存区）
+    PIDGaussianRecursiveCoefficients coefficients;
+    PIDScratchArena *arena;
+    PIDScratchMark mark;
+} PIDGaussianSetup;
+
+static bool PIDGaussianSetupCreate(PIDGaussianSetup *setup, double sigma,
+                                   PIDGaussianBoundary boundary, PIDGaussianMethod method) {
+    memset(setup, 0, sizeof(*setup));
+    setup->boundary = boundary;
+    setup->method = PIDGaussianResolveMethod(sigma, method);
+    setup->pad = PIDGaussianRadius(sigma);
+    setup->arena = PIDScratchArenaCurrent();
+    setup->mark = PIDScratchArenaMark(setup->arena);
+
+    if (setup->method == PIDGaussianMethodDirect) {
+        double *kernel = (double *)PIDScratchArenaAlloc(setup->arena, (2 * setup->pad + 1) * sizeof(double));
+        if (!kernel) {
+            return false;
+        }
+        PIDGaussianKernel(kernel, setup->pad, sigma);
+        setup->kernel = kernel;
+    } else {
+        setup->coefficients = PIDGaussianDericheCoefficients(sigma);
+        // constant模式边界外为0，不需要补边
+        if (boundary == PIDGaussianBoundaryConstant) {
+            setup->pad = 0;
+        }
+    }
+    return true;
+}
+
+static void PIDGaussianSetupDestroy(PIDGaussianSetup *setup) {
+    PIDScratchArenaReset(setup->arena, setup->mark);
+    setup->kernel = NULL;
+}
+
+/**
+ * 平滑一组width条平行的数据线（每条n个点）
+ * @param scratch PIDGaussianScratchLength个double
+ */
+static void PIDGaussianFilterLines(const PIDGaussianSetup *setup, const double *source, double *destination,
+                                   size_t n, size_t width, size_t lineStride, double *scratch) {
+    double *padded = scratch;
+    size_t total = n + 2 * setup->pad;
+    double *result = padded + total * width;
+    PIDGaussianGather(padded, source, n, width, lineStride, setup->pad, setup->boundary);
+
+    if (setup->method == PIDGaussianMethodDirect) {
+        PIDGaussianDirect(padded, result, n, width, setup->kernel, 2 * setup->pad + 1);
+    } else {
+        PIDGaussianRecursive(padded, result, n, width, setup->pad, &setup->coefficients,
+                             setup->boundary != PIDGaussianBoundaryConstant, result + n * width);
+    }
+    PIDGaussianScatter(destination, result, n, width, lineStride);
+}
+
+static size_t PIDGaussianScratchLength(const PIDGaussianSetup *setup, size_t n, size_t width) {
+    return (n + 2 * setup->pad) * width + n * width + 2 * width;
+}
+
+#pragma mark - 公共接口
+
+bool PIDGaussianFilter1D(const double *input, double *output, size_t length,
+                         double sigma, PIDGaussianBoundary boundary, PIDGaussianMethod method) {
+    return PIDGaussianFilterRows(input, output, 1, length, sigma, boundary, method);
+}
+
+/**
+ * 并行任务：行（axis = 1）或列块（axis = 0）
+ */
+typedef struct {
+    const PIDGaussianSetup *setup;
+    const double *input;
+    double *output;
+    size_t rows;
+    size_t columns;
+    size_t chunkCount;
+    int axis;
+    atomic_bool failed;
+} PIDGaussianJob;
+
+static void PIDGaussianRunChunk(void *context, size_t chunk) {
+    PIDGaussianJob *job = (PIDGaussianJob *)context;
+    const PIDGaussianSetup *setup = job->setup;
+    PIDScratchArena *arena = PIDScratchArenaCurrent();
+    PIDScratchMark mark = PIDScratchArenaMark(arena);
+
+    if (job->axis == 1) {
+        size_t begin = chunk * job->rows / job->chunkCount;
+        size_t end = (chunk + 1) * job->rows / job->chunkCount;
+        double *scratch = (double *)PIDScratchArenaAlloc(arena, PIDGaussianScratchLength(setup, job->columns, 1) *
+                                                                sizeof(double));
+        if (!scratch) {
+            atomic_store(&job->failed, true);
+        }
+        for (size_t r = begin; scratch && r < end; r++) {
+            PIDGaussianFilterLines(setup, job->input + r * job->columns, job->output + r * job->columns,
+                                   job->columns, 1, 1, scratch);
+        }
+    } else {
+        size_t blockCount = (job->columns + PIDGaussianColumnBlock - 1) / PIDGaussianColumnBlock;
+        size_t begin = chunk * blockCount / job->chunkCount;
+        size_t end = (chunk + 1) * blockCount / job->chunkCount;
+        double *scratch = (double *)PIDScratchArenaAlloc(arena, PIDGaussianScratchLength(setup, job->rows,
+                                                                                         PIDGaussianColumnBlock) *
+                                                                sizeof(double));
+        if (!scratch) {
+            atomic_store(&job->failed, true);
+        }
+        for (size_t block = begin; scratch && block < end; block++) {
+            size_t first = block * PIDGaussianColumnBlock;
+            size_t width = job->columns - first < PIDGaussianColumnBlock ? job->columns - first
+                                                                         : PIDGaussianColumnBlock;
+            PIDGaussianFilterLines(setup, job->input + first, job->output + first,
+                                   job->rows, width, job->columns, scratch);
+        }
+    }
+    // 分配失败也走到这里：所有出口都回到进入时的标记，并照常合并追加块
+    PIDScratchArenaReset(arena, mark);
+}
+
+bool PIDGaussianFilterAxis(const double *input, double *output, size_t rows, size_t columns, int axis,
+                           double sigma, PIDGaussianBoundary boundary, PIDGaussianMethod method) {
+    if (!input || !output || (axis != 0 && axis != 1)) {
+        return false;
+    }
+    if (rows == 0 || columns == 0) {
+        return true;
+    }
+    if (!(sigma > 0.0)) {
+        if (input != output) {
+            memmove(output, input, rows * columns * sizeof(double));
+        }
+        return true;
+    }
+
+    PIDGaussianSetup setup;
+    if (!PIDGaussianSetupCreate(&setup, sigma, boundary, method)) {
+        return false;
+    }
+
+    PIDGaussianJob job;
+    job.setup = &setup;
+    job.input = input;
+    job.output = output;
+    job.rows = rows;
+    job.columns = columns;
+    job.axis = axis;
+    atomic_init(&job.failed, false);
+    if (axis == 1) {
+        job.chunkCount = PIDParallelChunkCount(rows, 1);
+    } else {
+        job.chunkCount = PIDParallelChunkCount((columns + PIDGaussianColumnBlock - 1) / PIDGaussianColumnBlock, 1);
+    }
+    PIDParallelFor(job.chunkCount, &job, PIDGaussianRunChunk);
+
+    PIDGaussianSetupDestroy(&setup);
+    return !atomic_load(&job.failed);
+}
+
+bool PIDGaussianFilterRows(const double *input, double *output, size_t rows, size_t length,
+                           double sigma, PIDGaussianBoundary boundary, PIDGaussianMethod method) {
+    return PIDGaussianFilterAxis(input, output, rows, length, 1, sigma, boundary, method);
+}
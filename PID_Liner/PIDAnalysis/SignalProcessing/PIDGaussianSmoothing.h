@@ -0,0 +1,86 @@
+//
+//  PIDGaussianSmoothing.h
+//  PID_Liner
+//
+//  高斯平滑核心 - 原始缓冲区上的scipy.ndimage.gaussian_filter1d
+//  直接卷积（小sigma，与scipy逐点一致）与Deriche四阶递归滤波（大sigma，耗时与sigma无关）
+//  纯C实现：Apple平台直接卷积走vDSP，其他平台（Linux上的对拍与基准测试）走可移植循环
+//
+
+#ifndef PIDGaussianSmoothing_h
+#define PIDGaussianSmoothing_h
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * 边界处理，与scipy.ndimage的mode一致
+ */
+typedef enum {
+    PIDGaussianBoundaryConstant = 0,    // 'constant' 边界外为0      (0 0 0 | a b c d | 0 0 0)
+    PIDGaussianBoundaryReflect,         // 'reflect'  含边界点镜像   (c b a | a b c d | d c b)
+    PIDGaussianBoundaryNearest,         // 'nearest'  重复边界值     (a a a | a b c d | d d d)
+    PIDGaussianBoundaryMirror,          // 'mirror'   不含边界点镜像 (d c b | a b c d | c b a)
+} PIDGaussianBoundary;
+
+/**
+ * 计算方法
+ */
+typedef enum {
+    PIDGaussianMethodAutomatic = 0,     // 核半径不超过PIDGaussianDirectMaxRadius时直接卷积，否则递归
+    PIDGaussianMethodDirect,            // 截断高斯核直接卷积，与scipy一致（O(n·radius)）
+    PIDGaussianMethodRecursive,         // Deriche四阶递归（O(n)，与sigma无关，峰值相对误差约5e-4）
+} PIDGaussianMethod;
+
+/**
+ * Automatic选择直接卷积的最大核半径
+ */
+#define PIDGaussianDirectMaxRadius 64
+
+/**
+ * scipy的核半径：int(truncate * sigma + 0.5)，truncate = 4.0
+ */
+size_t PIDGaussianRadius(double sigma);
+
+/**
+ * Automatic实际对应的方法（sigma < 0.5时核只有1~3个点，总是直接卷积）
+ */
+PIDGaussianMethod PIDGaussianResolveMethod(double sigma, PIDGaussianMethod method);
+
+/**
+ * 一维高斯平滑
+ * 对应Python: scipy.ndimage.gaussian_filter1d(input, sigma, mode=...)
+ * @param input 输入，长度length
+ * @param output 输出，长度length（可以与input相同）
+ * @param sigma 标准差（<= 0时直接复制）
+ * @return 参数无效或内存不足时返回false
+ */
+bool PIDGaussianFilter1D(const double *input, double *output, size_t length,
+                         double sigma, PIDGaussianBoundary boundary, PIDGaussianMethod method);
+
+/**
+ * 多行批量平滑：行主序矩阵 [rows × length] 的每一行独立平滑，各行并行计算
+ * 输出可以与输入相同
+ */
+bool PIDGaussianFilterRows(const double *input, double *output, size_t rows, size_t length,
+                           double sigma, PIDGaussianBoundary boundary, PIDGaussianMethod method);
+
+/**
+ * 按轴平滑：行主序矩阵 [rows × columns]
+ * axis = 0 沿行方向（每一列独立平滑，对应gaussian_filter1d(..., axis=0)），
+ *          按列块收集到连续缓冲区后向量化计算，不需要转置整个矩阵
+ * axis = 1 沿列方向（每一行独立平滑，与PIDGaussianFilterRows相同）
+ * 输出可以与输入相同
+ */
+bool PIDGaussianFilterAxis(const double *input, double *output, size_t rows, size_t columns, int axis,
+                           double sigma, PIDGaussianBoundary boundary, PIDGaussianMethod method);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PIDGaussianSmoothing_h */
@@ -50,6 +50,18 @@ typedef NS_ENUM(NSInteger, PIDInterpolationMethod) {
                                             y:(NSArray<NSNumber *> *)y
                                          xNew:(NSArray<NSNumber *> *)x_new;
 
+/**
+ * 最近邻插值（便捷方法）
+ * 与最近两点距离相等时取索引较小的点
+ * @param x 原始x坐标（必须单调递增）
+ * @param y 原始y坐标
+ * @param x_new 新的x坐标
+ * @return 插值后的y值
+ */
++ (NSArray<NSNumber *> *)nearestInterpolateWithX:(NSArray<NSNumber *> *)x
+                                              y:(NSArray<NSNumber *> *)y
+                                           xNew:(NSArray<NSNumber *> *)x_new;
+
 /**
  * 累积和
  * 对应numpy.cumsum()
@@ -60,6 +72,31 @@ typedef NS_ENUM(NSInteger, PIDInterpolationMethod) {
 
 @end
 
+#pragma mark - 原始缓冲区插值内核
+
+/**
+ * 线性插值（原始double缓冲区，对应numpy.interp：超出范围取端点值）
+ * x必须单调递增（允许重复点），n >= 2
+ * xNew有序时双指针归并 O(n+m)，无序时逐点二分查找 O(m·log n)
+ * @param yNew 输出缓冲区（m个元素，不能与输入重叠）
+ */
+FOUNDATION_EXPORT void PIDInterpolateLinear(const double *x, const double *y, NSInteger n,
+                                            const double *xNew, double *yNew, NSInteger m);
+
+/**
+ * 最近邻插值（原始double缓冲区），规则同nearestInterpolateWithX:y:xNew:，n >= 1
+ */
+FOUNDATION_EXPORT void PIDInterpolateNearest(const double *x, const double *y, NSInteger n,
+                                             const double *xNew, double *yNew, NSInteger m);
+
+/**
+ * 均匀网格线性插值：原始点位于 x0 + i·dx (i = 0..n-1)，dx > 0，n >= 2
+ * 不需要查找区间，小数索引和插值都由vDSP向量化完成 O(m)
+ * 最后一个区间的右端点存在约1e-16·n的相对舍入误差
+ */
+FOUNDATION_EXPORT void PIDInterpolateLinearUniform(double x0, double dx, const double *y, NSInteger n,
+                                                   const double *xNew, double *yNew, NSInteger m);
+
 NS_ASSUME_NONNULL_END
 
 #endif /* PIDInterpolation_h */
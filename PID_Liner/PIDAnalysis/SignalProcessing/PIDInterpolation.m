@@ -7,6 +7,7 @@
 //
 
 #import "PIDInterpolation.h"
+#import <Accelerate/Accelerate.h>
 
 @implementation PIDInterpolation
 
@@ -41,43 +42,7 @@
     if (!x || !y || !x_new || x.count != y.count || x.count < 2) {
         return @[];
     }
-
-    NSMutableArray<NSNumber *> *result = [NSMutableArray arrayWithCapacity:x_new.count];
-
-    for (NSNumber *xNum in x_new) {
-        double xVal = [xNum doubleValue];
-
-        // 边界处理
-        if (xVal <= [x[0] doubleValue]) {
-            [result addObject:y[0]];
-            continue;
-        }
-        if (xVal >= [x[x.count - 1] doubleValue]) {
-            [result addObject:y[y.count - 1]];
-            continue;
-        }
-
-        // 找到插值区间
-        NSInteger i = 0;
-        for (i = 0; i < x.count - 1; i++) {
-            if (xVal < [x[i + 1] doubleValue]) {
-                break;
-            }
-        }
-
-        // 线性插值
-        double x0 = [x[i] doubleValue];
-        double x1 = [x[i + 1] doubleValue];
-        double y0 = [y[i] doubleValue];
-        double y1 = [y[i + 1] doubleValue];
-
-        double t = (xVal - x0) / (x1 - x0);
-        double yVal = y0 + t * (y1 - y0);
-
-        [result addObject:@(yVal)];
-    }
-
-    return [result copy];
+    return [self interpolateWithX:x y:y xNew:x_new kernel:PIDInterpolateLinear];
 }
 
 + (NSArray<NSNumber *> *)nearestInterpolateWithX:(NSArray<NSNumber *> *)x
@@ -86,26 +51,47 @@
     if (!x || !y || !x_new || x.count != y.count || x.count < 1) {
         return @[];
     }
+    return [self interpolateWithX:x y:y xNew:x_new kernel:PIDInterpolateNearest];
+}
 
-    NSMutableArray<NSNumber *> *result = [NSMutableArray arrayWithCapacity:x_new.count];
+/**
+ * NSArray与原始缓冲区之间的转换，插值本身交给C内核
+ */
++ (NSArray<NSNumber *> *)interpolateWithX:(NSArray<NSNumber *> *)x
+                                        y:(NSArray<NSNumber *> *)y
+                                     xNew:(NSArray<NSNumber *> *)x_new
+                                   kernel:(void (*)(const double *, const double *, NSInteger,
+                                                    const double *, double *, NSInteger))kernel {
+    NSInteger n = x.count;
+    NSInteger m = x_new.count;
+    if (m == 0) {
+        return @[];
+    }
 
-    for (NSNumber *xNum in x_new) {
-        double xVal = [xNum doubleValue];
+    double *buffer = malloc(sizeof(double) * (2 * n + 2 * m));
+    if (!buffer) {
+        return @[];
+    }
+    double *xs = buffer;
+    double *ys = xs + n;
+    double *xq = ys + n;
+    double *yq = xq + m;
 
-        // 找最近的点
-        double minDist = HUGE_VAL;
-        double nearestY = [y[0] doubleValue];
+    for (NSInteger i = 0; i < n; i++) {
+        xs[i] = [x[i] doubleValue];
+        ys[i] = [y[i] doubleValue];
+    }
+    for (NSInteger i = 0; i < m; i++) {
+        xq[i] = [x_new[i] doubleValue];
+    }
 
-        for (NSInteger i = 0; i < x.count; i++) {
-            double dist = fabs([x[i] doubleValue] - xVal);
-            if (dist < minDist) {
-                minDist = dist;
-                nearestY = [y[i] doubleValue];
-            }
-        }
+    kernel(xs, ys, n, xq, yq, m);
 
-        [result addObject:@(nearestY)];
+    NSMutableArray<NSNumber *> *result = [NSMutableArray arrayWithCapacity:m];
+    for (NSInteger i = 0; i < m; i++) {
+        [result addObject:@(yq[i])];
     }
+    free(buffer);
 
     return [result copy];
 }
@@ -127,3 +113,155 @@
 }
 
 @end
+
+#pragma mark - 原始缓冲区插值内核
+
+/**
+ * 查询点是否单调不减（一次顺序扫描）
+ */
+static BOOL PIDIsSorted(const double *values, NSInteger count) {
+    for (NSInteger i = 1; i < count; i++) {
+        if (values[i] < values[i - 1]) {
+            return NO;
+        }
+    }
+    return YES;
+}
+
+/**
+ * 满足 x[i] <= value 的最大i，限制在 [0, n-2]（调用方已处理两端越界）
+ */
+static NSInteger PIDUpperSegment(const double *x, NSInteger n, double value) {
+    NSInteger lo = 0;
+    NSInteger hi = n - 1;
+    while (hi - lo > 1) {
+        NSInteger mid = lo + (hi - lo) / 2;
+        if (x[mid] <= value) {
+            lo = mid;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+static inline double PIDLerpSegment(const double *x, const double *y, NSInteger i, double value) {
+    double t = (value - x[i]) / (x[i + 1] - x[i]);
+    return y[i] + t * (y[i + 1] - y[i]);
+}
+
+void PIDInterpolateLinear(const double *x, const double *y, NSInteger n,
+                          const double *xNew, double *yNew, NSInteger m) {
+    if (n < 2 || m <= 0) {
+        return;
+    }
+
+    double xFirst = x[0];
+    double xLast = x[n - 1];
+
+    if (PIDIsSorted(xNew, m)) {
+        // 双指针归并：区间下标只前进不后退
+        NSInteger seg = 0;
+        for (NSInteger k = 0; k < m; k++) {
+            double value = xNew[k];
+            if (value <= xFirst) {
+                yNew[k] = y[0];
+                continue;
+            }
+            if (value >= xLast) {
+                yNew[k] = y[n - 1];
+                continue;
+            }
+            while (x[seg + 1] <= value) {
+                seg++;
+            }
+            yNew[k] = PIDLerpSegment(x, y, seg, value);
+        }
+        return;
+    }
+
+    for (NSInteger k = 0; k < m; k++) {
+        double value = xNew[k];
+        if (value <= xFirst) {
+            yNew[k] = y[0];
+        } else if (value >= xLast) {
+            yNew[k] = y[n - 1];
+        } else {
+            yNew[k] = PIDLerpSegment(x, y, PIDUpperSegment(x, n, value), value);
+        }
+    }
+}
+
+/**
+ * 最近邻：在区间 [x[i], x[i+1]] 两端中选距离更近的一端，距离相等取左端；
+ * 左端有重复坐标时回退到第一个重复点（与逐点全扫描的结果一致）
+ */
+static inline double PIDNearestInSegment(const double *x, const double *y, NSInteger i, double value) {
+    NSInteger pick = (x[i + 1] - value < value - x[i]) ? i + 1 : i;
+    while (pick > 0 && x[pick - 1] == x[pick]) {
+        pick--;
+    }
+    return y[pick];
+}
+
+void PIDInterpolateNearest(const double *x, const double *y, NSInteger n,
+                           const double *xNew, double *yNew, NSInteger m) {
+    if (n < 1 || m <= 0) {
+        return;
+    }
+    if (n == 1) {
+        for (NSInteger k = 0; k < m; k++) {
+            yNew[k] = y[0];
+        }
+        return;
+    }
+
+    double xFirst = x[0];
+    double xLast = x[n - 1];
+    NSInteger lastIndex = n - 1;
+    while (lastIndex > 0 && x[lastIndex - 1] == xLast) {
+        lastIndex--;
+    }
+    double yLast = y[lastIndex];
+
+    BOOL sorted = PIDIsSorted(xNew, m);
+    NSInteger seg = 0;
+    for (NSInteger k = 0; k < m; k++) {
+        double value = xNew[k];
+        if (value <= xFirst) {
+            yNew[k] = y[0];
+            continue;
+        }
+        if (value >= xLast) {
+            yNew[k] = yLast;
+            continue;
+        }
+        if (sorted) {
+            while (x[seg + 1] <= value) {
+                seg++;
+            }
+        } else {
+            seg = PIDUpperSegment(x, n, value);
+        }
+        yNew[k] = PIDNearestInSegment(x, y, seg, value);
+    }
+}
+
+void PIDInterpolateLinearUniform(double x0, double dx, const double *y, NSInteger n,
+                                 const double *xNew, double *yNew, NSInteger m) {
+    if (n < 2 || m <= 0 || !(dx > 0)) {
+        return;
+    }
+
+    // 小数索引 (xNew - x0) / dx，写入输出缓冲区复用内存
+    double scale = 1.0 / dx;
+    double offset = -x0 * scale;
+    vDSP_vsmsaD(xNew, 1, &scale, &offset, yNew, 1, (vDSP_Length)m);
+
+    // vDSP_vlintD会读取索引+1处的值，上界取略小于n-1的数，端点值不越界读取
+    double lower = 0.0;
+    double upper = nextafter((double)(n - 1), 0.0);
+    vDSP_vclipD(yNew, 1, &lower, &upper, yNew, 1, (vDSP_Length)m);
+
+    vDSP_vlintD(y, yNew, 1, yNew, 1, (vDSP_Length)m, (vDSP_Length)n);
+}
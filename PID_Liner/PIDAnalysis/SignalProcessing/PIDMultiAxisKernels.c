@@ -0,0 +1,116 @@
+//
+//  PIDMultiAxisKernels.c
+//  PID_Liner
+//
+//  多轴交错内核实现 - 4路double向量（AVX/NEON两个寄存器），按通道独立运算
+//
+
+#include "PIDMultiAxisKernels.h"
+
+#include <stdint.h>
+#include <string.h>
+
+typedef double PIDLanes __attribute__((vector_size(4 * sizeof(double))));
+typedef int64_t PIDLaneBits __attribute__((vector_size(4 * sizeof(double))));
+
+// 向量按指针传递：32字节向量按值传参/返回的ABI取决于是否启用AVX（-Wpsabi）
+
+static inline void PIDLanesLoad(PIDLanes *lanes, const double *values) {
+    memcpy(lanes, values, sizeof(*lanes));
+}
+
+static inline void PIDLanesStore(double *values, const PIDLanes *lanes) {
+    memcpy(values, lanes, sizeof(*lanes));
+}
+
+// 清掉符号位
+static inline void PIDLanesAbs(PIDLanes *lanes) {
+    const PIDLaneBits magnitude = { INT64_MAX, INT64_MAX, INT64_MAX, INT64_MAX };
+    *lanes = (PIDLanes)((PIDLaneBits)*lanes & magnitude);
+}
+
+// 按通道取较大值；candidate为NaN时取NaN
+static inline void PIDLanesMax(PIDLanes *current, const PIDLanes *candidate) {
+    PIDLaneBits take = (*candidate > *current) | (*candidate != *candidate);
+    *current = (PIDLanes)((take & (PIDLaneBits)*candidate) | (~take & (PIDLaneBits)*current));
+}
+
+#pragma mark - PID输入
+
+void PIDMultiAxisPIDInput(double *values, const double *gyro,
+                          const double denominator[PIDAxisLaneCount], const bool enabled[PIDAxisLaneCount],
+                          size_t count) {
+    // 不使用P项的通道除以1后再清零，避免除以0产生Inf/NaN
+    const PIDLanes divisor = {
+        enabled[0] ? denominator[0] : 1.0, enabled[1] ? denominator[1] : 1.0,
+        enabled[2] ? denominator[2] : 1.0, enabled[3] ? denominator[3] : 1.0,
+    };
+    const PIDLaneBits mask = { enabled[0] ? -1 : 0, enabled[1] ? -1 : 0, enabled[2] ? -1 : 0, enabled[3] ? -1 : 0 };
+    for (size_t i = 0; i < count; i++) {
+        PIDLanes term;
+        PIDLanes rate;
+        PIDLanesLoad(&term, values + i * PIDAxisLaneCount);
+        PIDLanesLoad(&rate, gyro + i * PIDAxisLaneCount);
+        term = (PIDLanes)((PIDLaneBits)(term / divisor) & mask);
+        rate += term;
+        PIDLanesStore(values + i * PIDAxisLaneCount, &rate);
+    }
+}
+
+void PIDMultiAxisDeinterleave(const double *interleaved, size_t count,
+                              double *const columns[PIDAxisLaneCount]) {
+    for (int lane = 0; lane < PIDAxisLaneCount; lane++) {
+        double *column = columns[lane];
+        if (!column) {
+            continue;
+        }
+        const double *source = interleaved + lane;
+        for (size_t i = 0; i < count; i++) {
+            column[i] = source[i * PIDAxisLaneCount];
+        }
+    }
+}
+
+#pragma mark - 加窗统计
+
+void PIDMultiAxisWindowStatistics(const double *const columns[PIDAxisLaneCount], const double *window, size_t length,
+                                  double maxAbs[PIDAxisLaneCount], double meanAbs[PIDAxisLaneCount]) {
+    const double *c0 = columns[0];
+    const double *c1 = columns[1];
+    const double *c2 = columns[2];
+    const double *c3 = columns[3];
+
+    PIDLanes peak = { 0.0, 0.0, 0.0, 0.0 };
+    PIDLanes sum = { 0.0, 0.0, 0.0, 0.0 };
+    for (size_t i = 0; i < length; i++) {
+        double w = window[i];
+        PIDLanes value = (PIDLanes){ c0[i], c1[i], c2[i], c3[i] } * (PIDLanes){ w, w, w, w };
+        PIDLanesAbs(&value);
+        PIDLanesMax(&peak, &value);
+        sum += value;
+    }
+
+    double scale = length > 0 ? 1.0 / (double)length : 0.0;
+    for (int lane = 0; lane < PIDAxisLaneCount; lane++) {
+        maxAbs[lane] = peak[lane];
+        meanAbs[lane] = sum[lane] * scale;
+    }
+}
+
+#pragma mark - 累积和
+
+void PIDMultiAxisCumulativeSum(double *const rows[PIDAxisLaneCount], size_t count) {
+    double *r0 = rows[0];
+    double *r1 = rows[1];
+    double *r2 = rows[2];
+    double *r3 = rows[3];
+
+    PIDLanes sum = { 0.0, 0.0, 0.0, 0.0 };
+    for (size_t i = 0; i < count; i++) {
+        sum += (PIDLanes){ r0[i], r1[i], r2[i], r3[i] };
+        r0[i] = sum[0];
+        r1[i] = sum[1];
+        r2[i] = sum[2];
+        r3[i] = sum[3];
+    }
+}
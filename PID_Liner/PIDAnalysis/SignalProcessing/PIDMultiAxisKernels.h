@@ -0,0 +1,74 @@
+//
+//  PIDMultiAxisKernels.h
+//  PID_Liner
+//
+//  多轴交错内核 - Roll/Pitch/Yaw/油门放在同一个4路SIMD向量的各通道中，一遍内存访问同时处理四路
+//  纯C实现（GCC/Clang向量扩展），通道顺序固定为 PIDAxisLane
+//
+
+#ifndef PIDMultiAxisKernels_h
+#define PIDMultiAxisKernels_h
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * 交错通道：第i个样本占 [4i, 4i+4) 四个double
+ */
+typedef enum {
+    PIDAxisLaneRoll = 0,
+    PIDAxisLanePitch,
+    PIDAxisLaneYaw,
+    PIDAxisLaneThrottle,
+    PIDAxisLaneCount,
+} PIDAxisLane;
+
+/**
+ * 四路PID环路输入（交错缓冲区，原地计算）
+ * 对应Python: pidin = gyro + pval / (0.032029 * pidp)
+ *   values[l] = gyro[l] + values[l] / denominator[l]    （enabled[l]为true的通道，与单轴路径的vDSP结果逐位一致）
+ *   values[l] = gyro[l]                                 （其余通道，与单轴路径P增益无效时的回退相同）
+ * @param values 交错的P项，结果原地写回
+ * @param gyro 交错的陀螺仪
+ * @param denominator 每通道 0.032029·pidp
+ * @param enabled 每通道是否使用P项
+ * @param count 样本数
+ */
+void PIDMultiAxisPIDInput(double *values, const double *gyro,
+                          const double denominator[PIDAxisLaneCount], const bool enabled[PIDAxisLaneCount],
+                          size_t count);
+
+/**
+ * 把交错缓冲区拆回各通道的连续列
+ * @param columns 各通道的目标（NULL的通道跳过）
+ */
+void PIDMultiAxisDeinterleave(const double *interleaved, size_t count,
+                              double *const columns[PIDAxisLaneCount]);
+
+/**
+ * 四路加窗统计：一遍读取四列同一窗口，按通道计算 max|x·w| 与 mean|x·w|
+ * 对应单轴路径的 vDSP_vmulD + vDSP_maxmgvD / vDSP_meamgvD；NaN会传播到最大值（与分组时NaN归入高输入组一致）
+ * @param columns 四列的窗口起点（可以指向同一列）
+ * @param window 窗函数（length个点）
+ * @param maxAbs 输出每通道的最大绝对值
+ * @param meanAbs 输出每通道的平均绝对值
+ */
+void PIDMultiAxisWindowStatistics(const double *const columns[PIDAxisLaneCount], const double *window, size_t length,
+                                  double maxAbs[PIDAxisLaneCount], double meanAbs[PIDAxisLaneCount]);
+
+/**
+ * 四行同时原地累积和（每个通道一行，各行的累加顺序与 PIDCumulativeSumD 相同，结果逐位一致）
+ * @param rows 四行的起点
+ * @param count 每行的点数
+ */
+void PIDMultiAxisCumulativeSum(double *const rows[PIDAxisLaneCount], size_t count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PIDMultiAxisKernels_h */
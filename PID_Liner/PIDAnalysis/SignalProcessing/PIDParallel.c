@@ -0,0 +1,301 @@
+//
+//  PIDParallel.c
+//  PID_Liner
+//
+//  数据并行工具实现
+//
+
+#include "PIDParallel.h"
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#if defined(__APPLE__)
+#include <dispatch/dispatch.h>
+#endif
+
+static pthread_once_t gWorkerCountOnce = PTHREAD_ONCE_INIT;
+static size_t gWorkerCount = 1;
+
+static void PIDParallelInitWorkerCount(void) {
+    long online = sysconf(_SC_NPROCESSORS_ONLN);
+    gWorkerCount = online > 0 ? (size_t)online : 1;
+}
+
+size_t PIDParallelWorkerCount(void) {
+    pthread_once(&gWorkerCountOnce, PIDParallelInitWorkerCount);
+    return gWorkerCount;
+}
+
+static atomic_bool gSingleWorker = false;
+
+void PIDParallelSetSingleWorker(bool singleWorker) {
+    atomic_store_explicit(&gSingleWorker, singleWorker, memory_order_release);
+}
+
+/**
+ * 单次迭代或强制单线程时在调用线程上顺序执行
+ */
+static bool PIDParallelRunSerially(size_t iterations, void *context, PIDParallelWork work) {
+    if (iterations != 1 && !atomic_load_explicit(&gSingleWorker, memory_order_acquire)) {
+        return false;
+    }
+    for (size_t i = 0; i < iterations; i++) {
+        work(context, i);
+    }
+    return true;
+}
+
+size_t PIDParallelChunkCount(size_t count, size_t minimumPerChunk) {
+    if (count == 0) {
+        return 0;
+    }
+    size_t maxChunks = count / (minimumPerChunk > 0 ? minimumPerChunk : 1);
+    size_t chunks = PIDParallelWorkerCount() * 4;
+    if (chunks > maxChunks) {
+        chunks = maxChunks;
+    }
+    return chunks > 0 ? chunks : 1;
+}
+
+#pragma mark - 取消标志
+
+struct PIDCancelFlag {
+    atomic_bool cancelled;
+};
+
+PIDCancelFlag *PIDCancelFlagCreate(void) {
+    PIDCancelFlag *flag = (PIDCancelFlag *)malloc(sizeof(PIDCancelFlag));
+    if (flag) {
+        atomic_init(&flag->cancelled, false);
+    }
+    return flag;
+}
+
+void PIDCancelFlagDestroy(PIDCancelFlag *flag) {
+    free(flag);
+}
+
+void PIDCancelFlagSet(PIDCancelFlag *flag) {
+    if (flag) {
+        atomic_store_explicit(&flag->cancelled, true, memory_order_release);
+    }
+}
+
+bool PIDCancelFlagIsSet(const PIDCancelFlag *flag) {
+    // 检查点在热循环中，只读一次原子变量；置位后最迟在下一个窗口被看到
+    return flag && atomic_load_explicit(&((PIDCancelFlag *)flag)->cancelled, memory_order_acquire);
+}
+
+#if defined(__APPLE__)
+
+#pragma mark - GCD
+
+void PIDParallelFor(size_t iterations, void *context, PIDParallelWork work) {
+    if (iterations == 0) {
+        return;
+    }
+    if (PIDParallelRunSerially(iterations, context, work)) {
+        return;
+    }
+    // dispatch_apply本身支持嵌套，内层调用会复用同一组线程
+    dispatch_apply_f(iterations, DISPATCH_APPLY_AUTO, context, work);
+}
+
+#else
+
+#pragma mark - 可移植线程池
+
+/**
+ * 一次PIDParallelFor调用（放在调用方的栈上，调用返回前一直有效）
+ * 多个调用可以同时进行：各自挂在活动任务链表上，空闲线程从任意任务领取迭代
+ */
+typedef struct PIDParallelJob {
+    PIDParallelWork work;
+    void *context;
+    size_t iterations;
+    atomic_size_t next;             // 下一个待领取的迭代
+    atomic_size_t completed;        // 已完成的迭代数
+    size_t helpers;                 // 正在执行本任务的其他线程数（受gPoolLock保护）
+    bool linked;                    // 是否仍在活动任务链表中（受gPoolLock保护）
+    struct PIDParallelJob *previous;
+    struct PIDParallelJob *following;
+} PIDParallelJob;
+
+static pthread_once_t gPoolOnce = PTHREAD_ONCE_INIT;
+static pthread_mutex_t gPoolLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t gPoolWake = PTHREAD_COND_INITIALIZER;     // 有新任务
+static pthread_cond_t gPoolDone = PTHREAD_COND_INITIALIZER;     // 有线程离开任务
+static size_t gPoolThreads = 0;
+static PIDParallelJob *gJobsHead = NULL;
+static PIDParallelJob *gJobsTail = NULL;
+
+static void PIDParallelUnlinkJob(PIDParallelJob *job) {
+    if (!job->linked) {
+        return;
+    }
+    if (job->previous) {
+        job->previous->following = job->following;
+    } else {
+        gJobsHead = job->following;
+    }
+    if (job->following) {
+        job->following->previous = job->previous;
+    } else {
+        gJobsTail = job->previous;
+    }
+    job->previous = NULL;
+    job->following = NULL;
+    job->linked = false;
+}
+
+/**
+ * 取第一个还有未领取迭代的任务（需持有gPoolLock），迭代已领完的任务顺便移出链表
+ */
+static PIDParallelJob *PIDParallelOpenJob(void) {
+    PIDParallelJob *job = gJobsHead;
+    while (job) {
+        PIDParallelJob *following = job->following;
+        if (atomic_load_explicit(&job->next, memory_order_relaxed) < job->iterations) {
+            return job;
+        }
+        PIDParallelUnlinkJob(job);
+        job = following;
+    }
+    return NULL;
+}
+
+/**
+ * 领取并执行任务的迭代，直到领完
+ */
+static void PIDParallelRunJob(PIDParallelJob *job) {
+    size_t done = 0;
+    for (;;) {
+        size_t index = atomic_fetch_add_explicit(&job->next, 1, memory_order_relaxed);
+        if (index >= job->iterations) {
+            break;
+        }
+        job->work(job->context, index);
+        done++;
+    }
+    if (done > 0) {
+        atomic_fetch_add_explicit(&job->completed, done, memory_order_release);
+    }
+}
+
+/**
+ * 作为帮手执行别的任务（需持有gPoolLock，返回时仍持有）
+ * helpers计数保证任务的所有者在帮手离开前不会返回（任务在所有者的栈上）
+ */
+static void PIDParallelHelpJob(PIDParallelJob *job) {
+    job->helpers++;
+    pthread_mutex_unlock(&gPoolLock);
+
+    PIDParallelRunJob(job);
+
+    pthread_mutex_lock(&gPoolLock);
+    job->helpers--;
+    pthread_cond_broadcast(&gPoolDone);
+}
+
+static void *PIDParallelWorkerMain(void *argument) {
+    (void)argument;
+
+    pthread_mutex_lock(&gPoolLock);
+    for (;;) {
+        PIDParallelJob *job = PIDParallelOpenJob();
+        if (!job) {
+            pthread_cond_wait(&gPoolWake, &gPoolLock);
+            continue;
+        }
+        PIDParallelHelpJob(job);
+    }
+    return NULL;
+}
+
+static void PIDParallelPoolStart(void) {
+    // 调用线程也参与执行，额外创建 核心数-1 个常驻线程
+    size_t threads = PIDParallelWorkerCount() - 1;
+    for (size_t i = 0; i < threads; i++) {
+        pthread_t thread;
+        if (pthread_create(&thread, NULL, PIDParallelWorkerMain, NULL) != 0) {
+            break;
+        }
+        pthread_detach(thread);
+        gPoolThreads++;
+    }
+}
+
+void PIDParallelFor(size_t iterations, void *context, PIDParallelWork work) {
+    if (iterations == 0) {
+        return;
+    }
+
+    if (PIDParallelRunSerially(iterations, context, work)) {
+        return;
+    }
+
+    pthread_once(&gPoolOnce, PIDParallelPoolStart);
+
+    if (gPoolThreads == 0) {
+        for (size_t i = 0; i < iterations; i++) {
+            work(context, i);
+        }
+        return;
+    }
+
+    PIDParallelJob job = {
+        .work = work,
+        .context = context,
+        .iterations = iterations,
+    };
+    atomic_init(&job.next, 0);
+    atomic_init(&job.completed, 0);
+
+    // 挂到链表尾部：先提交的任务先被领取，嵌套调用和其他线程的并发调用都不再串行
+    pthread_mutex_lock(&gPoolLock);
+    job.previous = gJobsTail;
+    if (gJobsTail) {
+        gJobsTail->following = &job;
+    } else {
+        gJobsHead = &job;
+    }
+    gJobsTail = &job;
+    job.linked = true;
+    pthread_cond_broadcast(&gPoolWake);
+    pthread_mutex_unlock(&gPoolLock);
+
+    PIDParallelRunJob(&job);
+
+    // 自己的迭代已领完，其他线程可能仍在执行：等待期间帮忙执行其他任务（包括它们内部的嵌套调用），
+    // 而不是空等占着一个核心
+    pthread_mutex_lock(&gPoolLock);
+    PIDParallelUnlinkJob(&job);
+    while (atomic_load_explicit(&job.completed, memory_order_acquire) < iterations || job.helpers > 0) {
+        PIDParallelJob *other = PIDParallelOpenJob();
+        if (other) {
+            PIDParallelHelpJob(other);
+        } else {
+            pthread_cond_wait(&gPoolDone, &gPoolLock);
+        }
+    }
+    pthread_mutex_unlock(&gPoolLock);
+}
+
+#endif
+
+#if defined(__BLOCKS__)
+
+static void PIDParallelInvokeBlock(void *context, size_t index) {
+    void (^work)(size_t) = (void (^)(size_t))context;
+    work(index);
+}
+
+void PIDParallelForEach(size_t iterations, void (^work)(size_t index)) {
+    PIDParallelFor(iterations, (void *)work, PIDParallelInvokeBlock);
+}
+
+#endif
@@ -0,0 +1,77 @@
+//
+//  PIDParallel.h
+//  PID_Liner
+//
+//  数据并行工具 - 把独立的迭代（轴、窗口批次）分发到所有CPU核心
+//  Apple平台使用dispatch_apply（GCD按核心数自动分块、空闲线程取走剩余迭代），
+//  其他平台（Linux上的对拍与基准测试）使用常驻pthread线程池：每次调用是一个任务，
+//  空闲线程从任意未完成的任务按原子计数器领取迭代
+//
+
+#ifndef PIDParallel_h
+#define PIDParallel_h
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * 单次迭代的工作函数
+ * @param context 调用方传入的上下文
+ * @param index 迭代索引 [0, iterations)
+ */
+typedef void (*PIDParallelWork)(void *context, size_t index);
+
+/**
+ * 可用的工作线程数（逻辑核心数，至少为1）
+ */
+size_t PIDParallelWorkerCount(void);
+
+/**
+ * 强制只用一个工作线程：之后的PIDParallelFor在调用线程上按索引顺序执行全部迭代（仅供验证使用）
+ * 不改变PIDParallelWorkerCount，分块方式与多线程时相同，结果应与多线程执行逐位相同
+ */
+void PIDParallelSetSingleWorker(bool singleWorker);
+
+/**
+ * 并行执行 iterations 次迭代，全部完成后返回
+ * 迭代之间不能有依赖；执行顺序不确定，结果应按index写入各自的位置，
+ * 需要归约时由调用方在返回后按index顺序合并，保证结果与串行执行一致
+ * 允许嵌套调用（轴并行内部再按窗口并行）和多个线程同时调用：每次调用都会并行执行，
+ * 调用方在等待其他线程完成时会帮忙执行其他任务的迭代
+ */
+void PIDParallelFor(size_t iterations, void *context, PIDParallelWork work);
+
+#if defined(__BLOCKS__)
+/**
+ * PIDParallelFor的block版本
+ */
+void PIDParallelForEach(size_t iterations, void (^work)(size_t index));
+#endif
+
+/**
+ * 把 count 个元素分成适合并行的块数（每块至少 minimumPerChunk 个元素）
+ * 块数约为工作线程数的4倍，让先完成的线程可以领取剩余的块
+ */
+size_t PIDParallelChunkCount(size_t count, size_t minimumPerChunk);
+
+/**
+ * 协作式取消标志（不透明类型）
+ * 任意线程调用PIDCancelFlagSet置位；工作循环在窗口/块之间调用PIDCancelFlagIsSet检查，
+ * 置位后放弃剩余迭代尽快返回（结果无效）。接受取消标志的接口都允许传NULL，表示不可取消
+ */
+typedef struct PIDCancelFlag PIDCancelFlag;
+
+PIDCancelFlag *PIDCancelFlagCreate(void);
+void PIDCancelFlagDestroy(PIDCancelFlag *flag);
+void PIDCancelFlagSet(PIDCancelFlag *flag);
+bool PIDCancelFlagIsSet(const PIDCancelFlag *flag);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PIDParallel_h */
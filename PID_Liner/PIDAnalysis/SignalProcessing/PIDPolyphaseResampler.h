@@ -0,0 +1,101 @@
+//
+//  PIDPolyphaseResampler.h
+//  PID_Liner
+//
+//  多相重采样器 - 把日志重采样到规范分析采样率（解析之后、窗口堆叠之前）
+//
+
+#ifndef PIDPolyphaseResampler_h
+#define PIDPolyphaseResampler_h
+
+#import <Foundation/Foundation.h>
+
+@class PIDCSVData;
+
+NS_ASSUME_NONNULL_BEGIN
+
+// 分析窗口参考采样率：config中的windowSize按此采样率给出（8000点 = 1秒）
+FOUNDATION_EXPORT const double PIDReferenceAnalysisRate;
+
+/**
+ * 多相重采样器
+ *
+ * 采样率阶梯为 1k/2k/4k/8k Hz：日志重采样到不高于原采样率的最高阶梯，
+ * 变换比为有理数 L/M（M <= 64），反混叠低通为Kaiser窗sinc，
+ * 按相位拆分后每个输出点只需一次长度为tapsPerPhase的向量内积（vDSP）。
+ * 原采样率与阶梯相差2%以内、或低于最低阶梯时不重采样。
+ *
+ * 重采样后窗口仍为1秒、响应仍为0.5秒，但点数随采样率减少，
+ * 低采样率日志的FFT长度和内存都随之缩小。
+ *
+ * 支持分块流式处理：内部保留滤波所需的历史输入，
+ * 分块处理的结果与整段一次处理完全一致。
+ */
+@interface PIDPolyphaseResampler : NSObject
+
+// 输入采样率 (Hz)
+@property (nonatomic, assign, readonly) double inputRate;
+
+// 输出采样率 (Hz)，等于 inputRate * upFactor / downFactor
+@property (nonatomic, assign, readonly) double outputRate;
+
+// 插值因子L / 抽取因子M
+@property (nonatomic, assign, readonly) NSInteger upFactor;
+@property (nonatomic, assign, readonly) NSInteger downFactor;
+
+// 每个相位的滤波器抽头数
+@property (nonatomic, assign, readonly) NSInteger tapsPerPhase;
+
+/**
+ * 给定原采样率的分析采样率（不重采样时返回原采样率或其对应的阶梯）
+ */
++ (double)analysisRateForSampleRate:(double)sampleRate;
+
+/**
+ * 分析采样率下的窗口大小（保持与参考窗口相同的时长，结果为偶数）
+ * @param referenceWindowSize 参考采样率下的窗口点数
+ * @param analysisRate 分析采样率 (Hz)
+ */
++ (NSInteger)windowSize:(NSInteger)referenceWindowSize forAnalysisRate:(double)analysisRate;
+
+/**
+ * 为给定采样率创建重采样器
+ * @return 需要重采样时返回重采样器，否则返回nil
+ */
++ (nullable instancetype)resamplerForSampleRate:(double)sampleRate;
+
+/**
+ * 使用指定变换比初始化
+ * @param inputRate 输入采样率 (Hz)
+ * @param upFactor 插值因子L (>= 1)
+ * @param downFactor 抽取因子M (>= 1)
+ */
+- (instancetype)initWithInputRate:(double)inputRate
+                         upFactor:(NSInteger)upFactor
+                       downFactor:(NSInteger)downFactor;
+
+/**
+ * 整段重采样（不影响流式状态）
+ * @param data 原始数据（采样率应等于inputRate）
+ * @return 重采样后的数据，时间轴重新生成为均匀时间轴
+ */
+- (PIDCSVData *)resampleData:(PIDCSVData *)data;
+
+/**
+ * 流式重采样一个数据块
+ * @param chunk 紧随上一块之后的数据块（final为YES时可以为nil，只输出尾部样本）
+ * @param final 是否为最后一块（最后一块会输出尾部样本）
+ * @return 本次可以确定的输出样本（可能为0行）
+ */
+- (PIDCSVData *)resampleChunk:(nullable PIDCSVData *)chunk final:(BOOL)final;
+
+/**
+ * 清空流式状态
+ */
+- (void)reset;
+
+@end
+
+NS_ASSUME_NONNULL_END
+
+#endif /* PIDPolyphaseResampler_h */
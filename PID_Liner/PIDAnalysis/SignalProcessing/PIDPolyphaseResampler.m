@@ -0,0 +1,385 @@
+//
+//  PIDPolyphaseResampler.m
+//  PID_Liner
+//
+//  多相重采样器实现 - Kaiser窗sinc反混叠滤波 + 按相位向量内积
+//
+
+#import "PIDPolyphaseResampler.h"
+#import "PIDDataModels.h"
+#import <Accelerate/Accelerate.h>
+
+const double PIDReferenceAnalysisRate = 8000.0;
+
+// 规范分析采样率阶梯 (Hz)
+static const double kCanonicalRates[] = {1000.0, 2000.0, 4000.0, 8000.0};
+static const NSInteger kCanonicalRateCount = sizeof(kCanonicalRates) / sizeof(kCanonicalRates[0]);
+
+// 与阶梯相差不超过该比例时视为同一采样率（日志时间戳抖动）
+static const double kRateTolerance = 0.02;
+
+// 有理变换比的最大抽取因子 / 可接受的相对误差
+static const NSInteger kMaxDownFactor = 64;
+static const double kRatioTolerance = 0.005;
+
+// 滤波器：按较低采样率计的单侧过零点数、通带占新奈奎斯特频率的比例、Kaiser β（约80dB阻带）
+static const NSInteger kHalfZeroCrossings = 10;
+static const double kPassbandFraction = 0.9;
+static const double kKaiserBeta = 8.0;
+
+// 需要重采样的列（时间列由输出采样率重新生成，throttle是rcCommand3的别名）
+static NSArray<NSString *> *PIDResampledColumnKeys(void) {
+    static NSArray<NSString *> *keys;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        keys = @[@"rcCommand0", @"rcCommand1", @"rcCommand2", @"rcCommand3",
+                 @"axisP0", @"axisP1", @"axisP2",
+                 @"axisI0", @"axisI1", @"axisI2",
+                 @"axisD0", @"axisD1", @"axisD2",
+                 @"gyroADC0", @"gyroADC1", @"gyroADC2",
+                 @"debug0", @"debug1", @"debug2", @"debug3"];
+    });
+    return keys;
+}
+
+/**
+ * 第一类零阶修正贝塞尔函数（级数展开）
+ */
+static double PIDBesselI0(double x) {
+    double sum = 1.0;
+    double term = 1.0;
+    double halfX = x / 2.0;
+    for (NSInteger k = 1; k < 50; k++) {
+        term *= (halfX / k) * (halfX / k);
+        sum += term;
+        if (term < sum * 1e-17) {
+            break;
+        }
+    }
+    return sum;
+}
+
+@interface PIDPolyphaseResampler ()
+
+@property (nonatomic, assign, readwrite) double inputRate;
+@property (nonatomic, assign, readwrite) double outputRate;
+@property (nonatomic, assign, readwrite) NSInteger upFactor;
+@property (nonatomic, assign, readwrite) NSInteger downFactor;
+@property (nonatomic, assign, readwrite) NSInteger tapsPerPhase;
+
+// 多相滤波器 [相位][抽头]，每个相位内抽头倒序存放，可直接与连续输入做内积
+@property (nonatomic, strong) NSMutableData *phaseTaps;
+
+// 原型滤波器群延迟（插值后的采样点数）
+@property (nonatomic, assign) int64_t centerDelay;
+
+// 流式状态：参与重采样的列、各列保留的历史输入、历史第0个样本的全局序号
+@property (nonatomic, strong, nullable) NSArray<NSString *> *activeKeys;
+@property (nonatomic, strong) NSMutableArray<NSMutableData *> *history;
+@property (nonatomic, assign) int64_t historyStart;
+@property (nonatomic, assign) int64_t inputCount;
+@property (nonatomic, assign) int64_t outputCount;
+@property (nonatomic, assign) double startTime;
+@property (nonatomic, assign) int64_t startTimeUs;
+
+@end
+
+@implementation PIDPolyphaseResampler
+
+#pragma mark - 采样率规划
+
+/**
+ * 不高于原采样率（含容差）的最高阶梯，没有时返回0
+ */
++ (double)canonicalRateForSampleRate:(double)sampleRate {
+    double canonical = 0.0;
+    for (NSInteger i = 0; i < kCanonicalRateCount; i++) {
+        if (kCanonicalRates[i] <= sampleRate * (1.0 + kRateTolerance)) {
+            canonical = kCanonicalRates[i];
+        }
+    }
+    return canonical;
+}
+
++ (double)analysisRateForSampleRate:(double)sampleRate {
+    if (sampleRate <= 0) {
+        return PIDReferenceAnalysisRate;
+    }
+    double canonical = [self canonicalRateForSampleRate:sampleRate];
+    return canonical > 0 ? canonical : sampleRate;
+}
+
++ (NSInteger)windowSize:(NSInteger)referenceWindowSize forAnalysisRate:(double)analysisRate {
+    if (analysisRate <= 0) {
+        return referenceWindowSize;
+    }
+    NSInteger windowSize = (NSInteger)llround(referenceWindowSize * analysisRate / PIDReferenceAnalysisRate);
+    windowSize -= windowSize % 2;
+    return MAX(windowSize, 2);
+}
+
++ (nullable instancetype)resamplerForSampleRate:(double)sampleRate {
+    double canonical = [self canonicalRateForSampleRate:sampleRate];
+    if (sampleRate <= 0 || canonical <= 0 || fabs(sampleRate / canonical - 1.0) <= kRateTolerance) {
+        return nil;
+    }
+
+    // 分母最小、误差在容差内的有理近似 L/M
+    double ratio = canonical / sampleRate;
+    NSInteger bestUp = 1;
+    NSInteger bestDown = 1;
+    double bestError = HUGE_VAL;
+    for (NSInteger down = 1; down <= kMaxDownFactor; down++) {
+        NSInteger up = (NSInteger)llround(ratio * down);
+        if (up < 1) {
+            continue;
+        }
+        double error = fabs((double)up / down - ratio) / ratio;
+        if (error < bestError) {
+            bestError = error;
+            bestUp = up;
+            bestDown = down;
+        }
+        if (error <= kRatioTolerance) {
+            break;
+        }
+    }
+
+    NSLog(@"🔍 重采样规划: %.1fHz -> %.1fHz (L=%ld, M=%ld)",
+          sampleRate, sampleRate * bestUp / bestDown, (long)bestUp, (long)bestDown);
+
+    return [[self alloc] initWithInputRate:sampleRate upFactor:bestUp downFactor:bestDown];
+}
+
+#pragma mark - Lifecycle
+
+- (instancetype)initWithInputRate:(double)inputRate
+                         upFactor:(NSInteger)upFactor
+                       downFactor:(NSInteger)downFactor {
+    self = [super init];
+    if (self) {
+        _inputRate = inputRate;
+        _upFactor = MAX(upFactor, 1);
+        _downFactor = MAX(downFactor, 1);
+        _outputRate = inputRate * _upFactor / _downFactor;
+        [self designFilter];
+        [self reset];
+    }
+    return self;
+}
+
+/**
+ * 设计原型低通并拆分为多相滤波器
+ * 截止频率取输入/输出奈奎斯特频率中较低者的kPassbandFraction，增益L补偿插零
+ */
+- (void)designFilter {
+    NSInteger L = self.upFactor;
+    NSInteger factor = MAX(self.upFactor, self.downFactor);
+    NSInteger length = 2 * kHalfZeroCrossings * factor + 1;
+    double center = (length - 1) / 2.0;
+    double cutoff = kPassbandFraction * 0.5 / factor;   // 周期/插值后采样点
+
+    double *prototype = malloc(sizeof(double) * length);
+    double sum = 0.0;
+    double i0Beta = PIDBesselI0(kKaiserBeta);
+    for (NSInteger j = 0; j < length; j++) {
+        double offset = j - center;
+        double arg = 2.0 * cutoff * offset;
+        double sinc = fabs(arg) < 1e-12 ? 1.0 : sin(M_PI * arg) / (M_PI * arg);
+        double ratio = offset / center;
+        double kaiser = PIDBesselI0(kKaiserBeta * sqrt(MAX(1.0 - ratio * ratio, 0.0))) / i0Beta;
+        prototype[j] = 2.0 * cutoff * sinc * kaiser;
+        sum += prototype[j];
+    }
+    double gain = sum != 0 ? L / sum : 0.0;
+
+    NSInteger taps = (length + L - 1) / L;
+    self.tapsPerPhase = taps;
+    self.centerDelay = (int64_t)(length - 1) / 2;
+    self.phaseTaps = [NSMutableData dataWithLength:sizeof(double) * L * taps];
+    double *phases = self.phaseTaps.mutableBytes;
+    for (NSInteger p = 0; p < L; p++) {
+        for (NSInteger i = 0; i < taps; i++) {
+            NSInteger j = p + (taps - 1 - i) * L;
+            phases[p * taps + i] = j < length ? prototype[j] * gain : 0.0;
+        }
+    }
+    free(prototype);
+}
+
+- (void)reset {
+    self.activeKeys = nil;
+    self.history = [NSMutableArray array];
+    self.historyStart = 0;
+    self.inputCount = 0;
+    self.outputCount = 0;
+    self.startTime = 0;
+    self.startTimeUs = 0;
+}
+
+#pragma mark - Public Methods
+
+- (PIDCSVData *)resampleData:(PIDCSVData *)data {
+    PIDPolyphaseResampler *oneShot = [[PIDPolyphaseResampler alloc] initWithInputRate:self.inputRate
+                                                                             upFactor:self.upFactor
+                                                                           downFactor:self.downFactor];
+    PIDCSVData *result = [oneShot resampleChunk:data final:YES];
+    NSLog(@"✅ 重采样完成: %ld点 -> %ld点 (%.1fHz -> %.1fHz)",
+          (long)data.timeSeconds.count, (long)result.timeSeconds.count, self.inputRate, self.outputRate);
+    return result;
+}
+
+- (PIDCSVData *)resampleChunk:(PIDCSVData *)chunk final:(BOOL)final {
+    NSInteger chunkRows = chunk.timeSeconds.count;
+
+    if (!self.activeKeys && chunkRows > 0) {
+        [self beginWithFirstChunk:chunk];
+    }
+
+    // 追加新输入到各列历史；比时间列短的列用该列最后一个样本补齐
+    // （NaN会经滤波扩散到相邻的tapsPerPhase个输出，补齐值只影响越过列末尾的输出）
+    for (NSInteger c = 0; c < (NSInteger)self.activeKeys.count && chunkRows > 0; c++) {
+        NSArray<NSNumber *> *column = [chunk valueForKey:self.activeKeys[c]];
+        NSMutableData *history = self.history[c];
+        NSUInteger oldLength = history.length;
+        history.length = oldLength + chunkRows * sizeof(double);
+        double *dst = (double *)((uint8_t *)history.mutableBytes + oldLength);
+        NSInteger available = MIN((NSInteger)column.count, chunkRows);
+        for (NSInteger i = 0; i < available; i++) {
+            dst[i] = [column[i] doubleValue];
+        }
+        double hold = available > 0 ? dst[available - 1] : (oldLength > 0 ? dst[-1] : 0.0);
+        for (NSInteger i = available; i < chunkRows; i++) {
+            dst[i] = hold;
+        }
+    }
+    self.inputCount += chunkRows;
+
+    return [self drainFinal:final];
+}
+
+#pragma mark - Private Methods
+
+- (void)beginWithFirstChunk:(PIDCSVData *)chunk {
+    NSMutableArray<NSString *> *keys = [NSMutableArray array];
+    for (NSString *key in PIDResampledColumnKeys()) {
+        NSArray *column = [chunk valueForKey:key];
+        if (column.count > 0) {
+            [keys addObject:key];
+            [self.history addObject:[NSMutableData data]];
+        }
+    }
+    self.activeKeys = keys;
+    self.startTime = [chunk.timeSeconds[0] doubleValue];
+    self.startTimeUs = chunk.timeUs.count > 0 ? [chunk.timeUs[0] longLongValue] : (int64_t)llround(self.startTime * 1e6);
+}
+
+/**
+ * 输出所有已确定的样本
+ * 输出点n对应插值后位置 n*M + 群延迟，所需输入为 [base-K+1, base]；
+ * 越过开头的输入取第一个样本，最后一块越过结尾的输入取最后一个样本
+ */
+- (PIDCSVData *)drainFinal:(BOOL)final {
+    NSInteger channelCount = self.activeKeys.count;
+    int64_t L = self.upFactor;
+    int64_t M = self.downFactor;
+    int64_t K = self.tapsPerPhase;
+    int64_t total = self.inputCount;
+
+    // 最终输出总点数：输出时间不超过最后一个输入时间
+    int64_t outputLimit = total > 0 ? ((total - 1) * L) / M + 1 : 0;
+    int64_t produceEnd = self.outputCount;
+    if (final) {
+        produceEnd = outputLimit;
+    } else {
+        while (produceEnd < outputLimit && (produceEnd * M + self.centerDelay) / L <= total - 1) {
+            produceEnd++;
+        }
+    }
+
+    NSInteger produced = (NSInteger)(produceEnd - self.outputCount);
+    NSMutableArray<NSMutableArray<NSNumber *> *> *outputs = [NSMutableArray arrayWithCapacity:channelCount];
+    for (NSInteger c = 0; c < channelCount; c++) {
+        [outputs addObject:[NSMutableArray arrayWithCapacity:MAX(produced, 0)]];
+    }
+
+    const double *phases = self.phaseTaps.bytes;
+    double *scratch = malloc(sizeof(double) * K);
+    for (int64_t n = self.outputCount; n < produceEnd; n++) {
+        int64_t t = n * M + self.centerDelay;
+        int64_t base = t / L;
+        const double *taps = phases + (t % L) * K;
+        int64_t first = base - K + 1;
+        BOOL inside = first >= self.historyStart && base < total;
+
+        for (NSInteger c = 0; c < channelCount; c++) {
+            const double *hist = self.history[c].bytes;
+            const double *window = NULL;
+            if (inside) {
+                window = hist + (first - self.historyStart);
+            } else {
+                for (int64_t i = 0; i < K; i++) {
+                    int64_t index = MIN(MAX(first + i, self.historyStart), total - 1);
+                    scratch[i] = hist[index - self.historyStart];
+                }
+                window = scratch;
+            }
+            double value = 0.0;
+            vDSP_dotprD(taps, 1, window, 1, &value, (vDSP_Length)K);
+            [outputs[c] addObject:@(value)];
+        }
+    }
+    free(scratch);
+
+    PIDCSVData *result = [self dataWithOutputs:outputs firstIndex:self.outputCount count:produced];
+    self.outputCount = produceEnd;
+    [self trimHistory];
+    return result;
+}
+
+/**
+ * 丢弃下一个输出点不再需要的历史输入
+ * 输出窗口起点单调递增，只有窗口不再越过开头后才会开始丢弃
+ */
+- (void)trimHistory {
+    int64_t nextBase = (self.outputCount * self.downFactor + self.centerDelay) / self.upFactor;
+    int64_t keepFrom = MIN(nextBase - self.tapsPerPhase + 1, self.inputCount - 1);
+    if (keepFrom <= self.historyStart || keepFrom <= 0) {
+        return;
+    }
+
+    NSUInteger dropBytes = (NSUInteger)(keepFrom - self.historyStart) * sizeof(double);
+    for (NSMutableData *history in self.history) {
+        [history replaceBytesInRange:NSMakeRange(0, dropBytes) withBytes:NULL length:0];
+    }
+    self.historyStart = keepFrom;
+}
+
+- (PIDCSVData *)dataWithOutputs:(NSArray<NSMutableArray<NSNumber *> *> *)outputs
+                     firstIndex:(int64_t)firstIndex
+                          count:(NSInteger)count {
+    PIDCSVData *data = [[PIDCSVData alloc] init];
+    NSMutableArray<NSNumber *> *timeSeconds = [NSMutableArray arrayWithCapacity:MAX(count, 0)];
+    NSMutableArray<NSNumber *> *timeUs = [NSMutableArray arrayWithCapacity:MAX(count, 0)];
+    for (NSInteger i = 0; i < count; i++) {
+        double offset = (firstIndex + i) / self.outputRate;
+        [timeSeconds addObject:@(self.startTime + offset)];
+        [timeUs addObject:@(self.startTimeUs + (int64_t)llround(offset * 1e6))];
+    }
+    data.timeSeconds = timeSeconds;
+    data.timeUs = timeUs;
+
+    for (NSString *key in PIDResampledColumnKeys()) {
+        [data setValue:@[] forKey:key];
+    }
+    for (NSInteger c = 0; c < (NSInteger)self.activeKeys.count; c++) {
+        [data setValue:outputs[c] forKey:self.activeKeys[c]];
+    }
+    data.throttle = data.rcCommand3;
+
+    data.sampleRate = self.outputRate;
+    data.dataLength = count;
+    return data;
+}
+
+@end
@@ -0,0 +1,50 @@
+//
+//  PIDPrecision.h
+//  PID_Liner
+//
+//  DSP计算精度策略 - 分析内核的标量类型
+//  float64为参考路径（与Python/numpy逐点对齐，默认），float32为快速路径（内存带宽减半，SIMD宽度加倍）
+//  运行时由 PIDTraceAnalyzer.precision 选择；构建设置中定义 PID_DSP_FLOAT32=1 只改变默认值
+//  应用的分析路径（分析界面、流水线与外存分析）显式使用float32，分析器默认值与参考对照保持float64
+//
+
+#ifndef PIDPrecision_h
+#define PIDPrecision_h
+
+#ifndef PID_DSP_FLOAT32
+#define PID_DSP_FLOAT32 0
+#endif
+
+/**
+ * 运行时精度
+ */
+typedef enum {
+    PIDDSPPrecisionFloat64 = 0,     // 双精度参考路径
+    PIDDSPPrecisionFloat32,         // 单精度快速路径（频谱缓存、维纳滤波、逆FFT与累积和为float）
+} PIDDSPPrecision;
+
+/**
+ * 默认精度（PID_DSP_FLOAT32）
+ */
+#define PIDDSPPrecisionDefault (PID_DSP_FLOAT32 ? PIDDSPPrecisionFloat32 : PIDDSPPrecisionFloat64)
+
+/**
+ * 编译期默认精度的标量类型
+ * 内核同时提供 float（后缀F）与 double（后缀D）两份实例，PIDRealSelect 选出默认精度对应的一份；
+ * 两份实例始终都会编译，运行时按 PIDDSPPrecision 选择，验证工具也可以在同一进程中对比两者
+ */
+#if PID_DSP_FLOAT32
+typedef float PIDReal;
+#define PIDRealSelect(name) name##F
+#else
+typedef double PIDReal;
+#define PIDRealSelect(name) name##D
+#endif
+
+/**
+ * float32路径相对float64参考的误差容限（按结果最大幅度归一化）
+ * 与 PIDAlgorithmVerifier 对Python参考结果的默认相对容限（1e-4）一致
+ */
+#define PIDRealParityTolerance 1e-4
+
+#endif /* PIDPrecision_h */
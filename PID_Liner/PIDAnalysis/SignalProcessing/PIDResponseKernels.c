@@ -0,0 +1,48 @@
+//
+//  PIDResponseKernels.c
+//  PID_Liner
+//
+//  阶跃响应内核实现 - 模板按float与double各实例化一次
+//
+
+#include "PIDResponseKernels.h"
+#include "PIDFFTPlan.h"
+#include "PIDParallel.h"
+#include "PIDScratchArena.h"
+
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+
+// 实例名由模板显式加后缀，这里取消当前策略的别名
+#undef PIDWienerFusedKernel
+#undef PIDCrossSpectrumAccumulate
+#undef PIDCrossSpectrumDivide
+#undef PIDCumulativeSum
+#undef PIDStepResponseChainRun
+#undef PIDWindowSpectraRun
+#undef PIDStepResponseFromSpectra
+
+#pragma mark - float32
+
+#define PID_T float
+#define PID_T_NAME(name) name##F
+#define PID_T_FFT_FORWARD PIDFFTRealForwardF
+#define PID_T_FFT_INVERSE PIDFFTRealInverseF
+#include "PIDResponseKernelsTemplate.h"
+#undef PID_T
+#undef PID_T_NAME
+#undef PID_T_FFT_FORWARD
+#undef PID_T_FFT_INVERSE
+
+#pragma mark - float64
+
+#define PID_T double
+#define PID_T_NAME(name) name##D
+#define PID_T_FFT_FORWARD PIDFFTRealForward
+#define PID_T_FFT_INVERSE PIDFFTRealInverse
+#include "PIDResponseKernelsTemplate.h"
+#undef PID_T
+#undef PID_T_NAME
+#undef PID_T_FFT_FORWARD
+#undef PID_T_FFT_INVERSE
@@ -0,0 +1,156 @@
+//
+//  PIDResponseKernels.h
+//  PID_Liner
+//
+//  阶跃响应内核 - 加窗、FFT、维纳反卷积、累积和的原始缓冲区实现
+//  每个内核提供float（F）与double（D）两份实例，按 PIDPrecision.h 的运行时精度选择
+//
+
+#ifndef PIDResponseKernels_h
+#define PIDResponseKernels_h
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "PIDParallel.h"
+#include "PIDPrecision.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * 阶跃响应链的输入（与精度无关：堆叠数据、分析窗和1/sn均为双精度，进入内核时转换一次）
+ * 窗口k的样本为 column[k*step, k*step + windowLength)，与 PIDStackData 的列缓冲区视图一致
+ */
+typedef struct {
+    const double *inputColumn;      // PID环路输入的列缓冲区
+    const double *gyroColumn;       // 陀螺仪的列缓冲区
+    size_t windowCount;
+    size_t windowLength;
+    size_t step;                    // 相邻窗口起点的间隔
+    const double *window;           // 分析窗（windowLength个点）
+    const double *invSNLow;         // 1/sn[k]，k ∈ [0, paddedLength/2]
+    const double *invSNHigh;        // 1/sn[n-k]
+    size_t paddedLength;            // FFT长度（>= windowLength）
+    size_t resultLength;            // 每个窗口保留的响应点数（<= windowLength）
+    const PIDCancelFlag *cancel;    // 可选：置位后剩余窗口不再计算
+    const bool *activeWindows;      // 可选：为false的窗口跳过全部FFT，结果行置零（NULL时全部计算）
+} PIDStepResponseChain;
+
+/**
+ * 维纳滤波融合内核（单次遍历 [0, n/2] 频点）
+ * 输入H/G为实数FFT的半谱，结果写入out（可与H为同一缓冲区）
+ *
+ * Python对完整复数频谱做ifft后取实部，等价于对频谱的共轭对称部分做irfft：
+ * 频点k与n-k的1/sn不完全相同时（高斯滤波在边界处不对称），权重取两者的平均，
+ *   w = (1/(p+a) + 1/(p+b)) / 2 = (p + (a+b)/2) / ((p+a)(p+b))，p = |H|²
+ */
+void PIDWienerFusedKernelF(float *outReal, float *outImag,
+                           const float *hReal, const float *hImag,
+                           const float *gReal, const float *gImag,
+                           const float *invSNLow, const float *invSNHigh, size_t binCount);
+void PIDWienerFusedKernelD(double *outReal, double *outImag,
+                           const double *hReal, const double *hImag,
+                           const double *gReal, const double *gImag,
+                           const double *invSNLow, const double *invSNHigh, size_t binCount);
+
+/**
+ * 互谱累加：autoPower += |H|²，cross += G·conj(H)（[0, n/2] 半谱，逐频点）
+ * 平均互谱估计把所有窗口累加后只做一次除法，见 PIDCrossSpectrumDivide
+ */
+void PIDCrossSpectrumAccumulateF(float *autoPower, float *crossReal, float *crossImag,
+                                 const float *hReal, const float *hImag,
+                                 const float *gReal, const float *gImag, size_t binCount);
+void PIDCrossSpectrumAccumulateD(double *autoPower, double *crossReal, double *crossImag,
+                                 const double *hReal, const double *hImag,
+                                 const double *gReal, const double *gImag, size_t binCount);
+
+/**
+ * 平均互谱的正则化除法：先乘scale（1/窗口数）取平均，再按维纳融合内核相同的权重
+ *   out = scale·cross · w(scale·autoPower)
+ * 单个窗口、scale=1时与 PIDWienerFusedKernel 的结果相同
+ */
+void PIDCrossSpectrumDivideF(float *outReal, float *outImag,
+                             const float *autoPower, const float *crossReal, const float *crossImag,
+                             float scale, const float *invSNLow, const float *invSNHigh, size_t binCount);
+void PIDCrossSpectrumDivideD(double *outReal, double *outImag,
+                             const double *autoPower, const double *crossReal, const double *crossImag,
+                             double scale, const double *invSNLow, const double *invSNHigh, size_t binCount);
+
+/**
+ * 原地累积和（对应numpy.cumsum，从左到右顺序累加）
+ */
+void PIDCumulativeSumF(float *values, size_t count);
+void PIDCumulativeSumD(double *values, size_t count);
+
+/**
+ * 完整阶跃响应链：每个窗口 加窗 → 补零实数FFT（输入/陀螺仪）→ 维纳融合内核 → 逆FFT → 前resultLength点累积和
+ * 对应Python: stack_response 中 wiener_deconvolution(...)[:, :rlen].cumsum(axis=1)
+ * 中间缓冲区全部为对应精度；窗口按块并行
+ * @param stepResponse 结果矩阵 windowCount × resultLength（行主序）
+ * @return 参数无效、FFT计划不可用、内存不足或已取消时返回false
+ */
+bool PIDStepResponseChainRunF(const PIDStepResponseChain *chain, float *stepResponse);
+bool PIDStepResponseChainRunD(const PIDStepResponseChain *chain, double *stepResponse);
+
+/**
+ * 一组窗口的频谱输入：窗口k的样本为 column[windows[i]*step, ... + windowLength)，加窗（可选）后补零做实数FFT
+ * 结果写入半谱矩阵的第windows[i]行（行距paddedLength/2 + 1），其余行不修改
+ */
+typedef struct {
+    const double *column;           // 列缓冲区（与 PIDStackData 的列缓冲区视图一致）
+    size_t step;                    // 相邻窗口起点的间隔
+    size_t windowLength;
+    const double *window;           // 可选：分析窗（windowLength个点），NULL时不加窗
+    size_t paddedLength;            // FFT长度（>= windowLength）
+    const size_t *windows;          // 需要计算的窗口编号
+    size_t count;
+    const PIDCancelFlag *cancel;    // 可选：置位后剩余窗口不再计算
+} PIDWindowSpectraBatch;
+
+/**
+ * 批量窗口频谱（PIDSpectralCache 按请求的精度调用对应实例），窗口按块并行
+ * @param real 实部矩阵（windowCount × binCount）
+ * @param imag 虚部矩阵
+ * @return 参数无效、FFT计划不可用、内存不足或已取消时返回false
+ */
+bool PIDWindowSpectraRunF(const PIDWindowSpectraBatch *batch, float *real, float *imag);
+bool PIDWindowSpectraRunD(const PIDWindowSpectraBatch *batch, double *real, double *imag);
+
+/**
+ * 由缓存的输入/陀螺仪半谱计算阶跃响应：维纳融合内核 → 逆FFT → 前resultLength点累积和
+ * 与 PIDStepResponseChainRun 的后半段相同，正向FFT由频谱缓存提供（与噪声频谱共用陀螺仪频谱）
+ * @param inputReal 输入频谱实部矩阵（rowCount × (paddedLength/2 + 1)），其余三个矩阵形状相同
+ * @param invSNLow 1/sn[k]，invSNHigh 1/sn[n-k]（双精度，进入内核时转换一次）
+ * @param activeRows 可选：为false的行跳过计算，结果行置零
+ * @param stepResponse 结果矩阵 rowCount × resultLength（行主序）
+ * @return 参数无效、FFT计划不可用、内存不足或已取消时返回false
+ */
+bool PIDStepResponseFromSpectraF(const float *inputReal, const float *inputImag,
+                                 const float *gyroReal, const float *gyroImag,
+                                 size_t rowCount, size_t paddedLength,
+                                 const double *invSNLow, const double *invSNHigh,
+                                 size_t resultLength, const bool *activeRows,
+                                 const PIDCancelFlag *cancel, float *stepResponse);
+bool PIDStepResponseFromSpectraD(const double *inputReal, const double *inputImag,
+                                 const double *gyroReal, const double *gyroImag,
+                                 size_t rowCount, size_t paddedLength,
+                                 const double *invSNLow, const double *invSNHigh,
+                                 size_t resultLength, const bool *activeRows,
+                                 const PIDCancelFlag *cancel, double *stepResponse);
+
+// 默认精度对应的实例
+#define PIDWienerFusedKernel PIDRealSelect(PIDWienerFusedKernel)
+#define PIDCrossSpectrumAccumulate PIDRealSelect(PIDCrossSpectrumAccumulate)
+#define PIDCrossSpectrumDivide PIDRealSelect(PIDCrossSpectrumDivide)
+#define PIDCumulativeSum PIDRealSelect(PIDCumulativeSum)
+#define PIDStepResponseChainRun PIDRealSelect(PIDStepResponseChainRun)
+#define PIDWindowSpectraRun PIDRealSelect(PIDWindowSpectraRun)
+#define PIDStepResponseFromSpectra PIDRealSelect(PIDStepResponseFromSpectra)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PIDResponseKernels_h */
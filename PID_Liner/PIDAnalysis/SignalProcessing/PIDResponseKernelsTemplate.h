@@ -0,0 +1,437 @@
+//
+//  PIDResponseKernelsTemplate.h
+//  PID_Liner
+//
+//  阶跃响应内核的精度模板 - 只由 PIDResponseKernels.c 包含，每种精度包含一次（故意不加include guard）
+//  包含前定义：
+//    PID_T                 标量类型
+//    PID_T_NAME(name)      实例名（加精度后缀）
+//    PID_T_FFT_FORWARD     对应精度的实数FFT
+//    PID_T_FFT_INVERSE     对应精度的实数逆FFT
+//
+
+void PID_T_NAME(PIDWienerFusedKernel)(PID_T *outReal, PID_T *outImag,
+                                      const PID_T *hReal, const PID_T *hImag,
+                                      const PID_T *restrict gReal, const PID_T *restrict gImag,
+                                      const PID_T *restrict invSNLow, const PID_T *restrict invSNHigh,
+                                      size_t binCount) {
+    // 合并成一次除法，循环无分支，可被编译器向量化
+    for (size_t k = 0; k < binCount; k++) {
+        PID_T hr = hReal[k];
+        PID_T hi = hImag[k];
+        PID_T gr = gReal[k];
+        PID_T gi = gImag[k];
+
+        PID_T power = hr * hr + hi * hi;
+        PID_T a = invSNLow[k];
+        PID_T b = invSNHigh[k];
+        PID_T weight = (power + (PID_T)0.5 * (a + b)) / ((power + a) * (power + b));
+
+        // G * conj(H)
+        outReal[k] = (gr * hr + gi * hi) * weight;
+        outImag[k] = (gi * hr - gr * hi) * weight;
+    }
+}
+
+void PID_T_NAME(PIDCrossSpectrumAccumulate)(PID_T *restrict autoPower,
+                                            PID_T *restrict crossReal, PID_T *restrict crossImag,
+                                            const PID_T *restrict hReal, const PID_T *restrict hImag,
+                                            const PID_T *restrict gReal, const PID_T *restrict gImag,
+                                            size_t binCount) {
+    for (size_t k = 0; k < binCount; k++) {
+        PID_T hr = hReal[k];
+        PID_T hi = hImag[k];
+        PID_T gr = gReal[k];
+        PID_T gi = gImag[k];
+
+        autoPower[k] += hr * hr + hi * hi;
+        crossReal[k] += gr * hr + gi * hi;
+        crossImag[k] += gi * hr - gr * hi;
+    }
+}
+
+void PID_T_NAME(PIDCrossSpectrumDivide)(PID_T *outReal, PID_T *outImag,
+                                        const PID_T *restrict autoPower,
+                                        const PID_T *restrict crossReal, const PID_T *restrict crossImag,
+                                        PID_T scale,
+                                        const PID_T *restrict invSNLow, const PID_T *restrict invSNHigh,
+                                        size_t binCount) {
+    for (size_t k = 0; k < binCount; k++) {
+        PID_T power = autoPower[k] * scale;
+        PID_T a = invSNLow[k];
+        PID_T b = invSNHigh[k];
+        PID_T weight = scale * (power + (PID_T)0.5 * (a + b)) / ((power + a) * (power + b));
+
+        outReal[k] = crossReal[k] * weight;
+        outImag[k] = crossImag[k] * weight;
+    }
+}
+
+void PID_T_NAME(PIDCumulativeSum)(PID_T *values, size_t count) {
+    PID_T sum = 0;
+    for (size_t i = 0; i < count; i++) {
+        sum += values[i];
+        values[i] = sum;
+    }
+}
+
+/**
+ * 双精度输入转换为对应精度（分析窗与1/sn对所有窗口相同，每次调用转换一次）
+ */
+static void PID_T_NAME(PIDConvertToReal)(PID_T *destination, const double *source, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        destination[i] = (PID_T)source[i];
+    }
+}
+
+/**
+ * 每个窗口的后半段：G·conj(H)/(|H|²+1/sn) → 逆FFT → 前resultLength个点的累积和
+ * spectrumReal/Imag为工作半谱，可以与hReal/hImag为同一缓冲区
+ */
+static bool PID_T_NAME(PIDStepResponseFinish)(const PIDFFTPlan *plan, PID_T *spectrumReal, PID_T *spectrumImag,
+                                              const PID_T *hReal, const PID_T *hImag,
+                                              const PID_T *gReal, const PID_T *gImag,
+                                              const PID_T *invSNLow, const PID_T *invSNHigh, size_t binCount,
+                                              PID_T *samples, PID_T *row, size_t resultLength) {
+    PID_T_NAME(PIDWienerFusedKernel)(spectrumReal, spectrumImag, hReal, hImag, gReal, gImag,
+                                     invSNLow, invSNHigh, binCount);
+    if (!PID_T_FFT_INVERSE(plan, spectrumReal, spectrumImag, samples)) {
+        return false;
+    }
+    memcpy(row, samples, resultLength * sizeof(PID_T));
+    PID_T_NAME(PIDCumulativeSum)(row, resultLength);
+    return true;
+}
+
+#pragma mark - 完整阶跃响应链
+
+/**
+ * 并行任务：分析窗与1/sn已转换为对应精度，各块只读共享
+ */
+typedef struct {
+    const PIDStepResponseChain *chain;
+    const PIDFFTPlan *plan;
+    const PID_T *window;
+    const PID_T *invSNLow;
+    const PID_T *invSNHigh;
+    PID_T *stepResponse;
+    size_t chunkCount;
+    atomic_bool failed;
+} PID_T_NAME(PIDStepResponseJob);
+
+/**
+ * 加窗并补零（双精度堆叠数据在这一步转换为对应精度，不额外复制）
+ */
+static void PID_T_NAME(PIDStepResponseLoad)(PID_T *samples, const double *source, const PID_T *window,
+                                            size_t windowLength, size_t paddedLength) {
+    for (size_t i = 0; i < windowLength; i++) {
+        samples[i] = (PID_T)source[i] * window[i];
+    }
+    memset(samples + windowLength, 0, (paddedLength - windowLength) * sizeof(PID_T));
+}
+
+static void PID_T_NAME(PIDStepResponseRunChunk)(void *context, size_t chunk) {
+    PID_T_NAME(PIDStepResponseJob) *job = (PID_T_NAME(PIDStepResponseJob) *)context;
+    const PIDStepResponseChain *chain = job->chain;
+    size_t begin = chunk * chain->windowCount / job->chunkCount;
+    size_t end = (chunk + 1) * chain->windowCount / job->chunkCount;
+    size_t n = chain->paddedLength;
+    size_t binCount = n / 2 + 1;
+
+    // 工作缓冲区取自当前线程的暂存区（按窗口/FFT长度预留），稳态下每块不再申请内存
+    PIDScratchArena *arena = PIDScratchArenaCurrent();
+    PIDScratchArenaReserve(arena, PIDScratchBytesForWindow(chain->windowLength, n));
+    PIDScratchMark mark = PIDScratchArenaMark(arena);
+    PID_T *buffer = (PID_T *)PIDScratchArenaAlloc(arena, (n + 4 * binCount) * sizeof(PID_T));
+    if (!buffer) {
+        atomic_store(&job->failed, true);
+        end = begin;
+    }
+    PID_T *samples = buffer;
+    PID_T *hReal = buffer + n;
+    PID_T *hImag = hReal + binCount;
+    PID_T *gReal = hImag + binCount;
+    PID_T *gImag = gReal + binCount;
+
+    for (size_t i = begin; i < end; i++) {
+        if (PIDCancelFlagIsSet(chain->cancel)) {
+            atomic_store(&job->failed, true);
+            break;
+        }
+        PID_T *row = job->stepResponse + i * chain->resultLength;
+        if (chain->activeWindows && !chain->activeWindows[i]) {
+            memset(row, 0, chain->resultLength * sizeof(PID_T));
+            continue;
+        }
+        size_t offset = i * chain->step;
+
+        // H = rfft(input·window), G = rfft(gyro·window)
+        PID_T_NAME(PIDStepResponseLoad)(samples, chain->inputColumn + offset, job->window, chain->windowLength, n);
+        bool ok = PID_T_FFT_FORWARD(job->plan, samples, hReal, hImag);
+        PID_T_NAME(PIDStepResponseLoad)(samples, chain->gyroColumn + offset, job->window, chain->windowLength, n);
+        ok = ok && PID_T_FFT_FORWARD(job->plan, samples, gReal, gImag);
+
+        // 维纳滤波结果写回H后逆变换，前resultLength个点的累积和即阶跃响应
+        ok = ok && PID_T_NAME(PIDStepResponseFinish)(job->plan, hReal, hImag, hReal, hImag, gReal, gImag,
+                                                     job->invSNLow, job->invSNHigh, binCount,
+                                                     samples, row, chain->resultLength);
+        if (!ok) {
+            atomic_store(&job->failed, true);
+            break;
+        }
+    }
+
+    PIDScratchArenaReset(arena, mark);
+}
+
+bool PID_T_NAME(PIDStepResponseChainRun)(const PIDStepResponseChain *chain, PID_T *stepResponse) {
+    if (!chain || !stepResponse || !chain->inputColumn || !chain->gyroColumn || !chain->window ||
+        !chain->invSNLow || !chain->invSNHigh || chain->windowLength == 0 ||
+        chain->paddedLength < chain->windowLength || chain->resultLength > chain->windowLength) {
+        return false;
+    }
+    if (chain->windowCount == 0 || chain->resultLength == 0) {
+        return true;
+    }
+
+    const PIDFFTPlan *plan = PIDFFTPlanForLength(chain->paddedLength, PIDFFTBackendAutomatic);
+    if (!plan) {
+        return false;
+    }
+
+    // 分析窗与1/sn对所有窗口相同，转换一次
+    size_t binCount = chain->paddedLength / 2 + 1;
+    PIDScratchArena *arena = PIDScratchArenaCurrent();
+    PIDScratchMark mark = PIDScratchArenaMark(arena);
+    PID_T *shared = (PID_T *)PIDScratchArenaAlloc(arena, (chain->windowLength + 2 * binCount) * sizeof(PID_T));
+    if (!shared) {
+        return false;
+    }
+    PID_T *window = shared;
+    PID_T *invSNLow = window + chain->windowLength;
+    PID_T *invSNHigh = invSNLow + binCount;
+    PID_T_NAME(PIDConvertToReal)(window, chain->window, chain->windowLength);
+    PID_T_NAME(PIDConvertToReal)(invSNLow, chain->invSNLow, binCount);
+    PID_T_NAME(PIDConvertToReal)(invSNHigh, chain->invSNHigh, binCount);
+
+    PID_T_NAME(PIDStepResponseJob) job;
+    job.chain = chain;
+    job.plan = plan;
+    job.window = window;
+    job.invSNLow = invSNLow;
+    job.invSNHigh = invSNHigh;
+    job.stepResponse = stepResponse;
+    job.chunkCount = PIDParallelChunkCount(chain->windowCount, 4);
+    atomic_init(&job.failed, false);
+    PIDParallelFor(job.chunkCount, &job, PID_T_NAME(PIDStepResponseRunChunk));
+
+    PIDScratchArenaReset(arena, mark);
+    return !atomic_load(&job.failed);
+}
+
+#pragma mark - 批量窗口频谱
+
+typedef struct {
+    const PIDWindowSpectraBatch *batch;
+    const PIDFFTPlan *plan;
+    const PID_T *window;        // 已转换的分析窗；NULL时不加窗
+    PID_T *real;
+    PID_T *imag;
+    size_t chunkCount;
+    atomic_bool failed;
+} PID_T_NAME(PIDWindowSpectraJob);
+
+static void PID_T_NAME(PIDWindowSpectraRunChunk)(void *context, size_t chunk) {
+    PID_T_NAME(PIDWindowSpectraJob) *job = (PID_T_NAME(PIDWindowSpectraJob) *)context;
+    const PIDWindowSpectraBatch *batch = job->batch;
+    size_t begin = chunk * batch->count / job->chunkCount;
+    size_t end = (chunk + 1) * batch->count / job->chunkCount;
+    size_t n = batch->paddedLength;
+    size_t binCount = n / 2 + 1;
+
+    // 补零部分只需清零一次，每个窗口只覆盖前windowLength个点
+    PIDScratchArena *arena = PIDScratchArenaCurrent();
+    PIDScratchArenaReserve(arena, PIDScratchBytesForWindow(batch->windowLength, n));
+    PIDScratchMark mark = PIDScratchArenaMark(arena);
+    PID_T *samples = (PID_T *)PIDScratchArenaAlloc(arena, n * sizeof(PID_T));
+    if (samples) {
+        memset(samples + batch->windowLength, 0, (n - batch->windowLength) * sizeof(PID_T));
+    } else {
+        atomic_store(&job->failed, true);
+        end = begin;
+    }
+
+    for (size_t p = begin; p < end; p++) {
+        if (PIDCancelFlagIsSet(batch->cancel)) {
+            atomic_store(&job->failed, true);
+            break;
+        }
+        size_t i = batch->windows[p];
+        const double *source = batch->column + i * batch->step;
+        if (job->window) {
+            for (size_t j = 0; j < batch->windowLength; j++) {
+                samples[j] = (PID_T)source[j] * job->window[j];
+            }
+        } else {
+            PID_T_NAME(PIDConvertToReal)(samples, source, batch->windowLength);
+        }
+        if (!PID_T_FFT_FORWARD(job->plan, samples, job->real + i * binCount, job->imag + i * binCount)) {
+            atomic_store(&job->failed, true);
+            break;
+        }
+    }
+
+    PIDScratchArenaReset(arena, mark);
+}
+
+bool PID_T_NAME(PIDWindowSpectraRun)(const PIDWindowSpectraBatch *batch, PID_T *real, PID_T *imag) {
+    if (!batch || !real || !imag || !batch->column || (batch->count > 0 && !batch->windows) ||
+        batch->windowLength == 0 || batch->paddedLength < batch->windowLength) {
+        return false;
+    }
+    if (batch->count == 0) {
+        return true;
+    }
+
+    const PIDFFTPlan *plan = PIDFFTPlanForLength(batch->paddedLength, PIDFFTBackendAutomatic);
+    if (!plan) {
+        return false;
+    }
+
+    PIDScratchArena *arena = PIDScratchArenaCurrent();
+    PIDScratchMark mark = PIDScratchArenaMark(arena);
+    PID_T *window = NULL;
+    if (batch->window) {
+        window = (PID_T *)PIDScratchArenaAlloc(arena, batch->windowLength * sizeof(PID_T));
+        if (!window) {
+            return false;
+        }
+        PID_T_NAME(PIDConvertToReal)(window, batch->window, batch->windowLength);
+    }
+
+    PID_T_NAME(PIDWindowSpectraJob) job;
+    job.batch = batch;
+    job.plan = plan;
+    job.window = window;
+    job.real = real;
+    job.imag = imag;
+    job.chunkCount = PIDParallelChunkCount(batch->count, 4);
+    atomic_init(&job.failed, false);
+    PIDParallelFor(job.chunkCount, &job, PID_T_NAME(PIDWindowSpectraRunChunk));
+
+    PIDScratchArenaReset(arena, mark);
+    return !atomic_load(&job.failed);
+}
+
+#pragma mark - 由缓存频谱计算阶跃响应
+
+typedef struct {
+    const PID_T *inputReal;
+    const PID_T *inputImag;
+    const PID_T *gyroReal;
+    const PID_T *gyroImag;
+    const PIDFFTPlan *plan;
+    const PID_T *invSNLow;
+    const PID_T *invSNHigh;
+    size_t rowCount;
+    size_t resultLength;
+    const bool *activeRows;
+    const PIDCancelFlag *cancel;
+    PID_T *stepResponse;
+    size_t chunkCount;
+    atomic_bool failed;
+} PID_T_NAME(PIDSpectraResponseJob);
+
+static void PID_T_NAME(PIDSpectraResponseRunChunk)(void *context, size_t chunk) {
+    PID_T_NAME(PIDSpectraResponseJob) *job = (PID_T_NAME(PIDSpectraResponseJob) *)context;
+    size_t begin = chunk * job->rowCount / job->chunkCount;
+    size_t end = (chunk + 1) * job->rowCount / job->chunkCount;
+    size_t n = PIDFFTPlanLength(job->plan);
+    size_t binCount = n / 2 + 1;
+
+    // 缓存的频谱只读，维纳滤波结果写入每块的工作半谱
+    PIDScratchArena *arena = PIDScratchArenaCurrent();
+    PIDScratchArenaReserve(arena, PIDScratchBytesForWindow(job->resultLength, n));
+    PIDScratchMark mark = PIDScratchArenaMark(arena);
+    PID_T *buffer = (PID_T *)PIDScratchArenaAlloc(arena, (n + 2 * binCount) * sizeof(PID_T));
+    if (!buffer) {
+        atomic_store(&job->failed, true);
+        end = begin;
+    }
+    PID_T *samples = buffer;
+    PID_T *spectrumReal = buffer + n;
+    PID_T *spectrumImag = spectrumReal + binCount;
+
+    for (size_t i = begin; i < end; i++) {
+        if (PIDCancelFlagIsSet(job->cancel)) {
+            atomic_store(&job->failed, true);
+            break;
+        }
+        PID_T *row = job->stepResponse + i * job->resultLength;
+        if (job->activeRows && !job->activeRows[i]) {
+            memset(row, 0, job->resultLength * sizeof(PID_T));
+            continue;
+        }
+        size_t offset = i * binCount;
+        if (!PID_T_NAME(PIDStepResponseFinish)(job->plan, spectrumReal, spectrumImag,
+                                               job->inputReal + offset, job->inputImag + offset,
+                                               job->gyroReal + offset, job->gyroImag + offset,
+                                               job->invSNLow, job->invSNHigh, binCount,
+                                               samples, row, job->resultLength)) {
+            atomic_store(&job->failed, true);
+            break;
+        }
+    }
+
+    PIDScratchArenaReset(arena, mark);
+}
+
+bool PID_T_NAME(PIDStepResponseFromSpectra)(const PID_T *inputReal, const PID_T *inputImag,
+                                            const PID_T *gyroReal, const PID_T *gyroImag,
+                                            size_t rowCount, size_t paddedLength,
+                                            const double *invSNLow, const double *invSNHigh,
+                                            size_t resultLength, const bool *activeRows,
+                                            const PIDCancelFlag *cancel, PID_T *stepResponse) {
+    if (!inputReal || !inputImag || !gyroReal || !gyroImag || !invSNLow || !invSNHigh || !stepResponse ||
+        paddedLength == 0 || resultLength > paddedLength) {
+        return false;
+    }
+    if (rowCount == 0 || resultLength == 0) {
+        return true;
+    }
+
+    const PIDFFTPlan *plan = PIDFFTPlanForLength(paddedLength, PIDFFTBackendAutomatic);
+    if (!plan) {
+        return false;
+    }
+
+    size_t binCount = paddedLength / 2 + 1;
+    PIDScratchArena *arena = PIDScratchArenaCurrent();
+    PIDScratchMark mark = PIDScratchArenaMark(arena);
+    PID_T *shared = (PID_T *)PIDScratchArenaAlloc(arena, 2 * binCount * sizeof(PID_T));
+    if (!shared) {
+        return false;
+    }
+    PID_T_NAME(PIDConvertToReal)(shared, invSNLow, binCount);
+    PID_T_NAME(PIDConvertToReal)(shared + binCount, invSNHigh, binCount);
+
+    PID_T_NAME(PIDSpectraResponseJob) job;
+    job.inputReal = inputReal;
+    job.inputImag = inputImag;
+    job.gyroReal = gyroReal;
+    job.gyroImag = gyroImag;
+    job.plan = plan;
+    job.invSNLow = shared;
+    job.invSNHigh = shared + binCount;
+    job.rowCount = rowCount;
+    job.resultLength = resultLength;
+    job.activeRows = activeRows;
+    job.cancel = cancel;
+    job.stepResponse = stepResponse;
+    job.chunkCount = PIDParallelChunkCount(rowCount, 4);
+    atomic_init(&job.failed, false);
+    PIDParallelFor(job.chunkCount, &job, PID_T_NAME(PIDSpectraResponseRunChunk));
+
+    PIDScratchArenaReset(arena, mark);
+    return !atomic_load(&job.failed);
+}
@@ -0,0 +1,245 @@
+//
+//  PIDScratchArena.c
+//  PID_Liner
+//
+//  每线程暂存区实现 - 块链表 + 栈式回退，回退到最外层时合并为单块
+//
+
+// posix_memalign 属于POSIX，严格C11模式（-std=c11）下需要显式声明
+#if !defined(_POSIX_C_SOURCE) && !defined(__APPLE__)
+#define _POSIX_C_SOURCE 200112L
+#endif
+
+#include "PIDScratchArena.h"
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+// 缓冲区对齐（缓存行，同时满足vDSP/SIMD的对齐要求）
+#define PID_SCRATCH_ALIGNMENT 64
+
+// 新建暂存区的初始容量
+static const size_t kScratchInitialCapacity = 256 * 1024;
+
+typedef struct PIDScratchBlock {
+    struct PIDScratchBlock *previous;
+    size_t capacity;
+    size_t used;
+} PIDScratchBlock;
+
+// 块头按对齐大小占位，数据区紧随其后
+#define PID_SCRATCH_HEADER ((sizeof(PIDScratchBlock) + PID_SCRATCH_ALIGNMENT - 1) & ~(size_t)(PID_SCRATCH_ALIGNMENT - 1))
+
+struct PIDScratchArena {
+    PIDScratchBlock *current;   // 栈顶块，最底层的块常驻
+    size_t peakBytes;           // 各块同时占用的最大总量，合并时按此扩大底层块
+};
+
+static _Atomic uint64_t gScratchRequests;
+static _Atomic uint64_t gHeapAllocations;
+static _Atomic uint64_t gHeapBytes;
+
+static pthread_key_t gArenaKey;
+static pthread_once_t gArenaKeyOnce = PTHREAD_ONCE_INIT;
+
+#pragma mark - 块管理
+
+static size_t PIDScratchAlign(size_t bytes) {
+    return (bytes + PID_SCRATCH_ALIGNMENT - 1) & ~(size_t)(PID_SCRATCH_ALIGNMENT - 1);
+}
+
+static unsigned char *PIDScratchBlockData(PIDScratchBlock *block) {
+    return (unsigned char *)block + PID_SCRATCH_HEADER;
+}
+
+static PIDScratchBlock *PIDScratchBlockCreate(size_t capacity, PIDScratchBlock *previous) {
+    capacity = PIDScratchAlign(capacity);
+    void *memory = NULL;
+    if (posix_memalign(&memory, PID_SCRATCH_ALIGNMENT, PID_SCRATCH_HEADER + capacity) != 0) {
+        return NULL;
+    }
+    atomic_fetch_add_explicit(&gHeapAllocations, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&gHeapBytes, PID_SCRATCH_HEADER + capacity, memory_order_relaxed);
+
+    PIDScratchBlock *block = (PIDScratchBlock *)memory;
+    block->previous = previous;
+    block->capacity = capacity;
+    block->used = 0;
+    return block;
+}
+
+/**
+ * 各块已占用的总量（块链通常只有一个块）
+ */
+static size_t PIDScratchUsedBytes(const PIDScratchArena *arena) {
+    size_t total = 0;
+    for (const PIDScratchBlock *block = arena->current; block; block = block->previous) {
+        total += block->used;
+    }
+    return total;
+}
+
+/**
+ * 底层块空闲时按峰值用量重建为单块
+ */
+static void PIDScratchConsolidate(PIDScratchArena *arena) {
+    PIDScratchBlock *base = arena->current;
+    if (base->previous || base->used != 0 || arena->peakBytes <= base->capacity) {
+        return;
+    }
+    PIDScratchBlock *grown = PIDScratchBlockCreate(arena->peakBytes, NULL);
+    if (grown) {
+        free(base);
+        arena->current = grown;
+    }
+}
+
+#pragma mark - 线程局部暂存区
+
+static void PIDScratchArenaDestroy(void *value) {
+    PIDScratchArena *arena = (PIDScratchArena *)value;
+    PIDScratchBlock *block = arena->current;
+    while (block) {
+        PIDScratchBlock *previous = block->previous;
+        free(block);
+        block = previous;
+    }
+    free(arena);
+}
+
+static void PIDScratchArenaKeyCreate(void) {
+    pthread_key_create(&gArenaKey, PIDScratchArenaDestroy);
+}
+
+PIDScratchArena *PIDScratchArenaCurrent(void) {
+    pthread_once(&gArenaKeyOnce, PIDScratchArenaKeyCreate);
+    PIDScratchArena *arena = (PIDScratchArena *)pthread_getspecific(gArenaKey);
+    if (arena) {
+        return arena;
+    }
+
+    arena = (PIDScratchArena *)calloc(1, sizeof(PIDScratchArena));
+    if (!arena) {
+        return NULL;
+    }
+    arena->current = PIDScratchBlockCreate(kScratchInitialCapacity, NULL);
+    if (!arena->current) {
+        free(arena);
+        return NULL;
+    }
+    arena->peakBytes = arena->current->capacity;
+    pthread_setspecific(gArenaKey, arena);
+    return arena;
+}
+
+#pragma mark - 分配与回退
+
+PIDScratchMark PIDScratchArenaMark(PIDScratchArena *arena) {
+    PIDScratchMark mark = { NULL, 0 };
+    if (arena) {
+        mark.block = arena->current;
+        mark.used = arena->current->used;
+    }
+    return mark;
+}
+
+void *PIDScratchArenaAlloc(PIDScratchArena *arena, size_t bytes) {
+    if (!arena) {
+        return NULL;
+    }
+    atomic_fetch_add_explicit(&gScratchRequests, 1, memory_order_relaxed);
+
+    size_t size = PIDScratchAlign(bytes > 0 ? bytes : 1);
+    PIDScratchBlock *block = arena->current;
+    if (block->capacity - block->used < size) {
+        // 追加块至少与当前块一样大，几次翻倍后回到最外层即合并
+        size_t capacity = size > block->capacity ? size : block->capacity;
+        PIDScratchBlock *next = PIDScratchBlockCreate(capacity, block);
+        if (!next) {
+            return NULL;
+        }
+        arena->current = next;
+        block = next;
+    }
+
+    void *data = PIDScratchBlockData(block) + block->used;
+    block->used += size;
+
+    size_t used = PIDScratchUsedBytes(arena);
+    if (used > arena->peakBytes) {
+        arena->peakBytes = used;
+    }
+    return data;
+}
+
+double *PIDScratchArenaAllocZeroed(PIDScratchArena *arena, size_t count) {
+    double *values = (double *)PIDScratchArenaAlloc(arena, count * sizeof(double));
+    if (values) {
+        memset(values, 0, count * sizeof(double));
+    }
+    return values;
+}
+
+void PIDScratchArenaReset(PIDScratchArena *arena, PIDScratchMark mark) {
+    if (!arena) {
+        return;
+    }
+    while (arena->current != mark.block && arena->current->previous) {
+        PIDScratchBlock *top = arena->current;
+        arena->current = top->previous;
+        free(top);
+    }
+    arena->current->used = arena->current == mark.block ? mark.used : 0;
+    PIDScratchConsolidate(arena);
+}
+
+void PIDScratchArenaReserve(PIDScratchArena *arena, size_t bytes) {
+    if (!arena) {
+        return;
+    }
+    size_t size = PIDScratchAlign(bytes);
+    PIDScratchBlock *block = arena->current;
+    if (block->capacity - block->used >= size) {
+        return;
+    }
+
+    size_t needed = PIDScratchUsedBytes(arena) + size;
+    if (needed > arena->peakBytes) {
+        arena->peakBytes = needed;
+    }
+    if (!block->previous && block->used == 0) {
+        PIDScratchConsolidate(arena);
+        return;
+    }
+    // 嵌套使用中：追加一块，回到最外层时并入底层块
+    PIDScratchBlock *next = PIDScratchBlockCreate(size, block);
+    if (next) {
+        arena->current = next;
+    }
+}
+
+size_t PIDScratchBytesForWindow(size_t windowLength, size_t paddedLength) {
+    size_t binCount = paddedLength / 2 + 1;
+    return (paddedLength + 4 * binCount + 2 * windowLength) * sizeof(double) + 8 * PID_SCRATCH_ALIGNMENT;
+}
+
+#pragma mark - 分配计数
+
+PIDAllocationCounters PIDAllocationCountersSnapshot(void) {
+    PIDAllocationCounters counters;
+    counters.scratchRequests = atomic_load_explicit(&gScratchRequests, memory_order_relaxed);
+    counters.heapAllocations = atomic_load_explicit(&gHeapAllocations, memory_order_relaxed);
+    counters.heapBytes = atomic_load_explicit(&gHeapBytes, memory_order_relaxed);
+    return counters;
+}
+
+PIDAllocationCounters PIDAllocationCountersDelta(PIDAllocationCounters after, PIDAllocationCounters before) {
+    PIDAllocationCounters delta;
+    delta.scratchRequests = after.scratchRequests - before.scratchRequests;
+    delta.heapAllocations = after.heapAllocations - before.heapAllocations;
+    delta.heapBytes = after.heapBytes - before.heapBytes;
+    return delta;
+}
@@ -0,0 +1,91 @@
+//
+//  PIDScratchArena.h
+//  PID_Liner
+//
+//  每线程暂存区 - 窗口处理的临时缓冲区按栈式标记分配/回退，稳态下不再向系统申请内存
+//  纯C实现，工作线程（GCD或可移植线程池）各自持有一个暂存区，线程退出时释放
+//
+
+#ifndef PIDScratchArena_h
+#define PIDScratchArena_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * 暂存区（不透明类型），只能在所属线程上使用
+ */
+typedef struct PIDScratchArena PIDScratchArena;
+
+/**
+ * 分配位置标记：回退到标记时，标记之后的分配全部作废
+ */
+typedef struct {
+    void *block;
+    size_t used;
+} PIDScratchMark;
+
+/**
+ * 当前线程的暂存区（首次调用时创建，线程退出时释放）
+ */
+PIDScratchArena *PIDScratchArenaCurrent(void);
+
+/**
+ * 记录当前分配位置；与PIDScratchArenaReset成对使用，按后进先出嵌套
+ */
+PIDScratchMark PIDScratchArenaMark(PIDScratchArena *arena);
+
+/**
+ * 分配bytes字节（64字节对齐，内容未初始化）
+ * 当前块不够时追加新块；回退到最外层时多个块合并为一个足够大的块，之后同样的用量不再申请内存
+ * @return 缓冲区；内存不足时返回NULL
+ */
+void *PIDScratchArenaAlloc(PIDScratchArena *arena, size_t bytes);
+
+/**
+ * 分配count个double并清零
+ */
+double *PIDScratchArenaAllocZeroed(PIDScratchArena *arena, size_t count);
+
+/**
+ * 回退到标记位置（标记之后分配的缓冲区不能再使用）
+ */
+void PIDScratchArenaReset(PIDScratchArena *arena, PIDScratchMark mark);
+
+/**
+ * 确保当前位置之后至少还有bytes字节可用，避免处理第一个窗口时再追加块
+ * 在最外层调用时直接扩大底层块；已有足够空间时什么也不做
+ */
+void PIDScratchArenaReserve(PIDScratchArena *arena, size_t bytes);
+
+/**
+ * 单个窗口的阶跃响应/频谱处理所需的暂存字节数（按窗口长度和FFT长度估算，用于Reserve）
+ * 覆盖补零信号、两组半谱、Wiener权重与一份窗口长度的中间结果
+ */
+size_t PIDScratchBytesForWindow(size_t windowLength, size_t paddedLength);
+
+/**
+ * 分配计数（进程内所有暂存区之和，单调递增，用于基准测试对比前后差值）
+ */
+typedef struct {
+    uint64_t scratchRequests;   // 从暂存区分配缓冲区的次数
+    uint64_t heapAllocations;   // 暂存区向系统申请内存的次数（创建、追加块、合并、Reserve扩大）
+    uint64_t heapBytes;         // 向系统申请的总字节数
+} PIDAllocationCounters;
+
+PIDAllocationCounters PIDAllocationCountersSnapshot(void);
+
+/**
+ * 两次快照之差
+ */
+PIDAllocationCounters PIDAllocationCountersDelta(PIDAllocationCounters after, PIDAllocationCounters before);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PIDScratchArena_h */
@@ -13,6 +13,8 @@
 
 NS_ASSUME_NONNULL_BEGIN
 
+@class PIDCancellationToken;
+
 /**
  * 维纳反卷积结果
  */
@@ -43,6 +45,11 @@ NS_ASSUME_NONNULL_BEGIN
  */
 @property (nonatomic, assign) double dt;
 
+/**
+ * 取消令牌（可选）：批量反卷积在每个窗口之间检查，取消后返回NO
+ */
+@property (nonatomic, strong, nullable) PIDCancellationToken *cancellationToken;
+
 /**
  * 执行维纳反卷积
  * @param inputSignal 输入信号（PID环路输入），二维数组 [窗口数][采样点数]
@@ -54,6 +61,90 @@ NS_ASSUME_NONNULL_BEGIN
                                 output:(NSArray<NSArray<NSNumber *> *> *)outputSignal
                                 cutFreq:(double)cutFreq;
 
+/**
+ * 批量维纳反卷积（连续内存矩阵，行主序）
+ * 每行补零到1024的倍数后做实数FFT，频域一次融合计算 G·conj(H)/(|H|²+1/sn) 再逆变换，
+ * 中间结果全部在分离复数缓冲区上完成，不装箱
+ * 信噪比掩码只依赖频率轴和cutFreq，按 (长度, cutFreq, dt) 缓存，所有窗口共用
+ * @param input 输入信号矩阵 rowCount × columnCount
+ * @param output 输出信号矩阵 rowCount × columnCount
+ * @param rowCount 窗口数
+ * @param columnCount 每个窗口的采样点数
+ * @param cutFreq 截止频率 (Hz)
+ * @param result 结果矩阵 rowCount × resultLength（每行只保留反卷积结果的前resultLength个点）
+ * @param resultLength 每行保留的点数（<= columnCount）
+ * @return 参数无效时返回NO
+ */
+- (BOOL)deconvolveInput:(const double *)input
+                 output:(const double *)output
+               rowCount:(NSInteger)rowCount
+            columnCount:(NSInteger)columnCount
+                cutFreq:(double)cutFreq
+                 result:(double *)result
+           resultLength:(NSInteger)resultLength;
+
+/**
+ * 批量维纳反卷积（输入为已计算好的实数FFT半谱）
+ * 供频谱缓存使用：加窗后的输入/陀螺仪频谱只计算一次，同时用于反卷积和噪声频谱
+ * 频谱矩阵为 rowCount × (paddedLength/2+1)，实部/虚部分离，行主序
+ * @param inputReal/inputImag 输入信号的半谱
+ * @param outputReal/outputImag 输出信号的半谱
+ * @param rowCount 窗口数
+ * @param paddedLength FFT长度（应为paddedLengthForLength:的结果，与Python的padding一致）
+ * @param cutFreq 截止频率 (Hz)
+ * @param result 结果矩阵 rowCount × resultLength
+ * @param resultLength 每行保留的点数（<= paddedLength）
+ * @return 参数无效或已取消时返回NO
+ */
+- (BOOL)deconvolveInputSpectrumReal:(const double *)inputReal
+                          inputImag:(const double *)inputImag
+                 outputSpectrumReal:(const double *)outputReal
+                         outputImag:(const double *)outputImag
+                           rowCount:(NSInteger)rowCount
+                       paddedLength:(NSInteger)paddedLength
+                            cutFreq:(double)cutFreq
+                             result:(double *)result
+                       resultLength:(NSInteger)resultLength;
+
+/**
+ * 批量维纳反卷积，只处理activeRows为YES的行
+ * 其余行不做滤波和逆FFT，结果置零（对应的频谱行可以没有计算）
+ * @param activeRows 每行是否参与（rowCount个bool）；NULL时与上一个方法相同
+ */
+- (BOOL)deconvolveInputSpectrumReal:(const double *)inputReal
+                          inputImag:(const double *)inputImag
+                 outputSpectrumReal:(const double *)outputReal
+                         outputImag:(const double *)outputImag
+                           rowCount:(NSInteger)rowCount
+                       paddedLength:(NSInteger)paddedLength
+                            cutFreq:(double)cutFreq
+                             result:(double *)result
+                       resultLength:(NSInteger)resultLength
+                         activeRows:(nullable const bool *)activeRows;
+
+/**
+ * 反卷积使用的FFT长度（补零到1024的倍数）
+ * 对应Python: pad = 1024 - (len(input[0]) % 1024)
+ */
+- (NSInteger)paddedLengthForLength:(NSInteger)length;
+
+/**
+ * 1/sn（[0, n/2]半谱，两段各n/2+1个点：1/sn[k] 与 1/sn[n-k]），按 (长度, cutFreq, dt) 缓存
+ * 供阶跃响应链（PIDResponseKernels）直接使用
+ * @param paddedLength FFT长度
+ * @param cutFreq 截止频率 (Hz)
+ */
+- (NSData *)inverseSignalToNoiseForLength:(NSInteger)paddedLength cutFreq:(double)cutFreq;
+
+/**
+ * 信噪比掩码（完整长度，与numpy.fft.fftfreq的频率顺序一致）
+ * 对应Python: sn = 10*(-gaussian_filter1d(to_mask(clip(|freq|, ...)), len_lpf/6) + 1 + 1e-9)
+ * @param freqs 频率数组 (Hz)
+ * @param cutFreq 截止频率 (Hz)
+ * @return 每个频点的信噪比
+ */
+- (NSArray<NSNumber *> *)calculateSignalToNoise:(NSArray<NSNumber *> *)freqs cutFreq:(double)cutFreq;
+
 /**
  * 数据归一化到 [0, 1]
  * 对应Python: to_mask()
@@ -7,7 +7,12 @@
 //
 
 #import "PIDWienerDeconvolution.h"
+#import "PIDCancellationToken.h"
 #import "PIDFFTProcessor.h"
+#import "PIDGaussianSmoothing.h"
+#import "PIDParallel.h"
+#import "PIDResponseKernels.h"
+#import "PIDScratchArena.h"
 #import <Accelerate/Accelerate.h>
 #import <mach/mach_time.h>
 
@@ -41,7 +46,13 @@ static double getMachFrequency(void) {
 
 @end
 
-@implementation PIDWienerDeconvolution
+@implementation PIDWienerDeconvolution {
+    // 1/sn 缓存：[0, n/2] 的 1/sn[k] 与 1/sn[n-k]，共 2 × (n/2+1) 个点
+    NSData *_invSNCache;
+    vDSP_Length _invSNLength;
+    double _invSNCutFreq;
+    double _invSNDt;
+}
 
 - (instancetype)init {
     self = [super init];
@@ -63,14 +74,12 @@ static double getMachFrequency(void) {
  * G = FFT(output)
  * sn = 信噪比（基于频率和截止频率计算）
  * result = IFFT(G * conj(H) / (H * conj(H) + 1/sn))
+ *
+ * 二维数组接口：打包成连续矩阵后走批量内核
  */
 - (PIDWienerResult *)deconvolveWithInput:(NSArray<NSArray<NSNumber *> *> *)inputSignal
                                 output:(NSArray<NSArray<NSNumber *> *> *)outputSignal
                                 cutFreq:(double)cutFreq {
-
-    // 性能监控
-    uint64_t startTime = mach_absolute_time();
-
     if (!inputSignal || !outputSignal || inputSignal.count != outputSignal.count) {
         return [[PIDWienerResult alloc] init];
     }
@@ -87,81 +96,232 @@ static double getMachFrequency(void) {
             maxColCount = row.count;
         }
     }
+    if (maxColCount == 0) {
+        return [[PIDWienerResult alloc] init];
+    }
 
-    // Padding到1024的倍数（提高FFT速度）
-    vDSP_Length paddedLength = [self padLength:maxColCount];
-    NSLog(@"📊 维纳反卷积: %ld窗口, 原始长度=%ld, padding后=%lu",
-          (long)rowCount, (long)maxColCount, paddedLength);
+    // 打包为连续矩阵（短行补零，与逐行padding到同一长度等价）
+    NSInteger cellCount = rowCount * maxColCount;
+    double *matrix = (double *)calloc(3 * cellCount, sizeof(double));
+    double *inputMatrix = matrix;
+    double *outputMatrix = matrix + cellCount;
+    double *resultMatrix = matrix + 2 * cellCount;
 
-    // 🔧 优化: 信噪比sn对所有窗口相同，只需计算一次
-    NSArray<NSNumber *> *freqs = [self.fftProcessor fftfreqWithLength:paddedLength dt:self.dt];
-    NSArray<NSNumber *> *sn = [self calculateSignalToNoise:freqs cutFreq:cutFreq];
-    NSArray<NSNumber *> *invSN = [self reciprocal:sn];  // 预计算1/sn
+    for (NSInteger i = 0; i < rowCount; i++) {
+        NSArray<NSNumber *> *inputRow = inputSignal[i];
+        NSArray<NSNumber *> *outputRow = outputSignal[i];
+        double *inputDst = inputMatrix + i * maxColCount;
+        double *outputDst = outputMatrix + i * maxColCount;
+        for (NSInteger j = 0; j < (NSInteger)inputRow.count; j++) {
+            inputDst[j] = [inputRow[j] doubleValue];
+        }
+        NSInteger outputCount = MIN((NSInteger)outputRow.count, maxColCount);
+        for (NSInteger j = 0; j < outputCount; j++) {
+            outputDst[j] = [outputRow[j] doubleValue];
+        }
+    }
 
-    // 🔧 使用NSMutableArray预分配，提高性能
-    NSMutableArray<NSArray<NSNumber *> *> *resultData = [NSMutableArray arrayWithCapacity:rowCount];
+    [self deconvolveInput:inputMatrix
+                   output:outputMatrix
+                 rowCount:rowCount
+              columnCount:maxColCount
+                  cutFreq:cutFreq
+                   result:resultMatrix
+             resultLength:maxColCount];
 
-    // 对每个窗口进行反卷积
+    // 截取原始长度（去掉padding）
+    NSMutableArray<NSArray<NSNumber *> *> *resultData = [NSMutableArray arrayWithCapacity:rowCount];
     for (NSInteger i = 0; i < rowCount; i++) {
-        @autoreleasepool {
-            NSArray<NSNumber *> *inputRow = inputSignal[i];
-            NSArray<NSNumber *> *outputRow = outputSignal[i];
+        NSInteger originalLength = inputSignal[i].count;
+        const double *row = resultMatrix + i * maxColCount;
+        NSMutableArray<NSNumber *> *rowResult = [NSMutableArray arrayWithCapacity:originalLength];
+        for (NSInteger j = 0; j < originalLength; j++) {
+            [rowResult addObject:@(row[j])];
+        }
+        [resultData addObject:rowResult];
+    }
+
+    free(matrix);
+
+    PIDWienerResult *result = [[PIDWienerResult alloc] init];
+    result.data = resultData;
+    result.rowCount = rowCount;
+    result.columnCount = maxColCount;
+
+    return result;
+}
+
+- (BOOL)deconvolveInput:(const double *)input
+                 output:(const double *)output
+               rowCount:(NSInteger)rowCount
+            columnCount:(NSInteger)columnCount
+                cutFreq:(double)cutFreq
+                 result:(double *)result
+           resultLength:(NSInteger)resultLength {
+    if (!input || !output || !result || rowCount <= 0 || columnCount <= 0 ||
+        resultLength <= 0 || resultLength > columnCount) {
+        return NO;
+    }
 
-            // Padding到paddedLength
-            NSArray<NSNumber *> *paddedInput = [self padArray:inputRow toLength:paddedLength];
-            NSArray<NSNumber *> *paddedOutput = [self padArray:outputRow toLength:paddedLength];
+    // 性能监控
+    uint64_t startTime = mach_absolute_time();
 
-            // 执行FFT
-            NSDictionary *inputFFT = [self.fftProcessor fftWithReal:paddedInput imag:nil length:paddedLength];
-            NSDictionary *outputFFT = [self.fftProcessor fftWithReal:paddedOutput imag:nil length:paddedLength];
+    // Padding到1024的倍数
+    vDSP_Length paddedLength = (vDSP_Length)[self paddedLengthForLength:columnCount];
+    const PIDFFTPlan *plan = PIDFFTPlanForLength(paddedLength, PIDFFTBackendAutomatic);
+    if (!plan) {
+        return NO;
+    }
 
-            NSArray<NSNumber *> *H_real = inputFFT[@"real"];
-            NSArray<NSNumber *> *H_imag = inputFFT[@"imag"];
-            NSArray<NSNumber *> *G_real = outputFFT[@"real"];
-            NSArray<NSNumber *> *G_imag = outputFFT[@"imag"];
+    // 信噪比sn对所有窗口相同，按参数缓存
+    NS_VALID_UNTIL_END_OF_SCOPE NSData *invSN = [self inverseSignalToNoiseForLength:(NSInteger)paddedLength cutFreq:cutFreq];
+    vDSP_Length binCount = paddedLength / 2 + 1;
+    const double *invSNLow = (const double *)invSN.bytes;
+    const double *invSNHigh = invSNLow + binCount;
+
+    // 窗口按块并行：每块从线程暂存区取补零信号 + H/G半谱（分离复数），每行写入result中自己的位置
+    size_t rowBytes = (size_t)columnCount * sizeof(double);
+    size_t padBytes = (size_t)(paddedLength - columnCount) * sizeof(double);
+    size_t chunkCount = PIDParallelChunkCount((size_t)rowCount, 4);
+
+    PIDParallelForEach(chunkCount, ^(size_t chunk) {
+        NSInteger begin = (NSInteger)(chunk * (size_t)rowCount / chunkCount);
+        NSInteger end = (NSInteger)((chunk + 1) * (size_t)rowCount / chunkCount);
+
+        PIDScratchArena *arena = PIDScratchArenaCurrent();
+        PIDScratchArenaReserve(arena, PIDScratchBytesForWindow((size_t)columnCount, (size_t)paddedLength));
+        PIDScratchMark mark = PIDScratchArenaMark(arena);
+        double *buffer = (double *)PIDScratchArenaAlloc(arena, (paddedLength + 4 * binCount) * sizeof(double));
+        double *samples = buffer;
+        double *hReal = buffer + paddedLength;
+        double *hImag = hReal + binCount;
+        double *gReal = hImag + binCount;
+        double *gImag = gReal + binCount;
+
+        for (NSInteger i = begin; i < end; i++) {
+            // H = rfft(input)
+            memcpy(samples, input + i * columnCount, rowBytes);
+            memset(samples + columnCount, 0, padBytes);
+            PIDFFTRealForward(plan, samples, hReal, hImag);
+
+            // G = rfft(output)
+            memcpy(samples, output + i * columnCount, rowBytes);
+            memset(samples + columnCount, 0, padBytes);
+            PIDFFTRealForward(plan, samples, gReal, gImag);
+
+            // G·conj(H)/(|H|²+1/sn)，结果写回H
+            PIDWienerFusedKernelD(hReal, hImag, hReal, hImag, gReal, gImag, invSNLow, invSNHigh, binCount);
+
+            // 逆变换后截取前resultLength个点
+            PIDFFTRealInverse(plan, hReal, hImag, samples);
+            memcpy(result + i * resultLength, samples, (size_t)resultLength * sizeof(double));
+        }
 
-            // 维纳反卷积公式: G * conj(H) / (H * conj(H) + 1/sn)
-            // H * conj(H) = |H|^2（功率谱）
-            NSArray<NSNumber *> *powerH = [self complexPowerSpectrumReal:H_real imag:H_imag];
+        PIDScratchArenaReset(arena, mark);
+    });
 
-            // 分母: powerH + 1/sn (使用预计算的invSN)
-            NSArray<NSNumber *> *denomReal = [self addArrays:powerH and:invSN];
+    // 性能监控
+    uint64_t endTime = mach_absolute_time();
+    double elapsedMs = (double)(endTime - startTime) * getMachFrequency() / 1e6;
 
-            // 分子: G * conj(H)
-            NSDictionary *G_Hconj = [self.fftProcessor complexMultiplyReal1:G_real imag1:G_imag real2:H_real imag2:[self negate:H_imag]];
-            NSArray<NSNumber *> *numerReal = G_Hconj[@"real"];
-            NSArray<NSNumber *> *numerImag = G_Hconj[@"imag"];
+    NSLog(@"✅ 维纳反卷积完成: %ld x %ld (padding后=%lu) | 耗时: %.1fms",
+          (long)rowCount, (long)columnCount, paddedLength, elapsedMs);
 
-            // 复数除法: (numerReal + numerImag*i) / (denomReal + 0*i)
-            NSDictionary *deconvFFT = [self.fftProcessor complexDivideNumerReal:numerReal numerImag:numerImag denomReal:denomReal denomImag:nil];
-            NSArray<NSNumber *> *deconvReal = deconvFFT[@"real"];
-            NSArray<NSNumber *> *deconvImag = deconvFFT[@"imag"];
+    return YES;
+}
+
+- (BOOL)deconvolveInputSpectrumReal:(const double *)inputReal
+                          inputImag:(const double *)inputImag
+                 outputSpectrumReal:(const double *)outputReal
+                         outputImag:(const double *)outputImag
+                           rowCount:(NSInteger)rowCount
+                       paddedLength:(NSInteger)paddedLength
+                            cutFreq:(double)cutFreq
+                             result:(double *)result
+                       resultLength:(NSInteger)resultLength {
+    return [self deconvolveInputSpectrumReal:inputReal
+                                   inputImag:inputImag
+                          outputSpectrumReal:outputReal
+                                  outputImag:outputImag
+                                    rowCount:rowCount
+                                paddedLength:paddedLength
+                                     cutFreq:cutFreq
+                                      result:result
+                                resultLength:resultLength
+                                  activeRows:NULL];
+}
 
-            // IFFT
-            NSDictionary *ifftResult = [self.fftProcessor ifftWithReal:deconvReal imag:deconvImag length:paddedLength];
-            NSArray<NSNumber *> *ifftReal = ifftResult[@"real"];
+- (BOOL)deconvolveInputSpectrumReal:(const double *)inputReal
+                          inputImag:(const double *)inputImag
+                 outputSpectrumReal:(const double *)outputReal
+                         outputImag:(const double *)outputImag
+                           rowCount:(NSInteger)rowCount
+                       paddedLength:(NSInteger)paddedLength
+                            cutFreq:(double)cutFreq
+                             result:(double *)result
+                       resultLength:(NSInteger)resultLength
+                         activeRows:(const bool *)activeRows {
+    if (!inputReal || !inputImag || !outputReal || !outputImag || !result || rowCount <= 0 ||
+        resultLength <= 0 || resultLength > paddedLength) {
+        return NO;
+    }
+
+    uint64_t startTime = mach_absolute_time();
 
-            // 截取原始长度（去掉padding）
-            NSInteger originalLength = inputRow.count;
-            NSArray<NSNumber *> *rowResult = [ifftReal subarrayWithRange:NSMakeRange(0, originalLength)];
+    const PIDFFTPlan *plan = PIDFFTPlanForLength((size_t)paddedLength, PIDFFTBackendAutomatic);
+    if (!plan) {
+        return NO;
+    }
 
-            [resultData addObject:rowResult];
+    NS_VALID_UNTIL_END_OF_SCOPE NSData *invSN = [self inverseSignalToNoiseForLength:paddedLength cutFreq:cutFreq];
+    NSInteger binCount = paddedLength / 2 + 1;
+    const double *invSNLow = (const double *)invSN.bytes;
+    const double *invSNHigh = invSNLow + binCount;
+
+    // 频谱只读，滤波结果写入每块的临时半谱后逆变换；窗口按块并行
+    size_t chunkCount = PIDParallelChunkCount((size_t)rowCount, 4);
+    const PIDCancelFlag *cancel = [self.cancellationToken flag];
+
+    PIDParallelForEach(chunkCount, ^(size_t chunk) {
+        NSInteger begin = (NSInteger)(chunk * (size_t)rowCount / chunkCount);
+        NSInteger end = (NSInteger)((chunk + 1) * (size_t)rowCount / chunkCount);
+
+        PIDScratchArena *arena = PIDScratchArenaCurrent();
+        PIDScratchArenaReserve(arena, PIDScratchBytesForWindow((size_t)resultLength, (size_t)paddedLength));
+        PIDScratchMark mark = PIDScratchArenaMark(arena);
+        double *buffer = (double *)PIDScratchArenaAlloc(arena, (paddedLength + 2 * binCount) * sizeof(double));
+        double *samples = buffer;
+        double *spectrumReal = buffer + paddedLength;
+        double *spectrumImag = spectrumReal + binCount;
+
+        for (NSInteger i = begin; i < end && !PIDCancelFlagIsSet(cancel); i++) {
+            if (activeRows && !activeRows[i]) {
+                memset(result + i * resultLength, 0, (size_t)resultLength * sizeof(double));
+                continue;
+            }
+            NSInteger offset = i * binCount;
+            PIDWienerFusedKernelD(spectrumReal, spectrumImag,
+                                  inputReal + offset, inputImag + offset,
+                                  outputReal + offset, outputImag + offset,
+                                  invSNLow, invSNHigh, (size_t)binCount);
+            PIDFFTRealInverse(plan, spectrumReal, spectrumImag, samples);
+            memcpy(result + i * resultLength, samples, (size_t)resultLength * sizeof(double));
         }
+
+        PIDScratchArenaReset(arena, mark);
+    });
+
+    if (PIDCancelFlagIsSet(cancel)) {
+        return NO;
     }
 
-    // 性能监控
     uint64_t endTime = mach_absolute_time();
-    double elapsedMs = (double)(endTime - startTime) * 1000.0 / getMachFrequency();
+    double elapsedMs = (double)(endTime - startTime) * getMachFrequency() / 1e6;
 
-    PIDWienerResult *result = [[PIDWienerResult alloc] init];
-    result.data = resultData;
-    result.rowCount = rowCount;
-    result.columnCount = maxColCount;
-
-    NSLog(@"✅ 维纳反卷积完成: %ld x %ld | 耗时: %.1fms (并行优化+sn预计算)",
-          (long)rowCount, (long)maxColCount, elapsedMs);
+    NSLog(@"✅ 维纳反卷积完成(共用频谱): %ld窗口 (FFT长度=%ld) | 耗时: %.1fms",
+          (long)rowCount, (long)paddedLength, elapsedMs);
 
-    return result;
+    return YES;
 }
 
 #pragma mark - Helper Methods
@@ -170,29 +330,44 @@ static double getMachFrequency(void) {
  * 计算padding后的长度（1024的倍数）
  * 对应Python: pad = 1024 - (len(input[0]) % 1024)
  */
-- (vDSP_Length)padLength:(NSInteger)length {
+- (NSInteger)paddedLengthForLength:(NSInteger)length {
     NSInteger remainder = length % 1024;
     if (remainder == 0) {
-        return (vDSP_Length)length;
+        return length;
     }
-    return (vDSP_Length)(length + (1024 - remainder));
+    return length + (1024 - remainder);
 }
 
 /**
- * Padding数组到指定长度
+ * 1/sn（[0, n/2]半谱，频点k与n-k各一份），按 (长度, cutFreq, dt) 缓存
  */
-- (NSArray<NSNumber *> *)padArray:(NSArray<NSNumber *> *)array toLength:(vDSP_Length)targetLength {
-    NSMutableArray<NSNumber *> *padded = [NSMutableArray arrayWithCapacity:targetLength];
+- (NSData *)inverseSignalToNoiseForLength:(NSInteger)paddedLength cutFreq:(double)cutFreq {
+    vDSP_Length length = (vDSP_Length)paddedLength;
+    @synchronized (self) {
+        if (_invSNCache && _invSNLength == length && _invSNCutFreq == cutFreq && _invSNDt == self.dt) {
+            return _invSNCache;
+        }
 
-    // 复制原始数据
-    [padded addObjectsFromArray:array];
+        NSArray<NSNumber *> *freqs = [self.fftProcessor fftfreqWithLength:length dt:self.dt];
+        NSArray<NSNumber *> *sn = [self calculateSignalToNoise:freqs cutFreq:cutFreq];
+
+        vDSP_Length binCount = length / 2 + 1;
+        NSMutableData *invSN = [NSMutableData dataWithLength:2 * binCount * sizeof(double)];
+        double *invSNLow = invSN.mutableBytes;
+        double *invSNHigh = invSNLow + binCount;
+        for (vDSP_Length k = 0; k < binCount; k++) {
+            double low = [sn[k] doubleValue];
+            double high = [sn[(length - k) % length] doubleValue];
+            invSNLow[k] = fabs(low) > 1e-9 ? 1.0 / low : 1e9;  // 避免除以0
+            invSNHigh[k] = fabs(high) > 1e-9 ? 1.0 / high : 1e9;
+        }
 
-    // 填充0
-    while (padded.count < targetLength) {
-        [padded addObject:@0.0f];
+        _invSNCache = invSN;
+        _invSNLength = length;
+        _invSNCutFreq = cutFreq;
+        _invSNDt = self.dt;
+        return invSN;
     }
-
-    return [padded copy];
 }
 
 /**
@@ -281,10 +456,7 @@ static double getMachFrequency(void) {
 /**
  * 高斯滤波（1D）
  * 对应Python: gaussian_filter1d(data, sigma, mode='constant')
- *
- * 🔧 修复边界处理：scipy的mode='constant'表示边界外用0填充
- * 这与之前的实现不同：之前跳过边界外数据并重新归一化，
- * 现在边界外数据用0填充，权重核保持完整
+ * 边界外用0填充、权重核保持完整；核半径与scipy一致为 int(4*sigma + 0.5)，双精度计算
  */
 - (NSArray<NSNumber *> *)gaussianFilter:(NSArray<NSNumber *> *)data sigma:(double)sigma {
     if (!data || data.count == 0 || sigma < 0.01) {
@@ -292,124 +464,22 @@ static double getMachFrequency(void) {
     }
 
     NSInteger n = data.count;
-    // 🔧 限制核大小，避免kernelSize > n导致问题
-    NSInteger kernelSize = (NSInteger)(sigma * 6) | 1;  // 确保奇数
-    if (kernelSize < 3) kernelSize = 3;
-    if (kernelSize > n) {
-        kernelSize = (n / 2) | 1;
-        if (kernelSize < 3) kernelSize = 3;
-    }
-
-    // 生成高斯核
-    float *kernel = (float *)malloc(kernelSize * sizeof(float));
-    [self generateGaussianKernel:kernel size:kernelSize sigma:sigma];
-
-    // 🔧 修复：使用scipy mode='constant'边界处理
-    // 边界外的数据视为0，权重核保持完整（不重新归一化）
-    NSMutableArray<NSNumber *> *result = [NSMutableArray arrayWithCapacity:n];
-    NSInteger halfKernel = kernelSize / 2;
-
+    NSMutableData *buffer = [NSMutableData dataWithLength:n * sizeof(double)];
+    double *values = buffer.mutableBytes;
     for (NSInteger i = 0; i < n; i++) {
-        double sum = 0.0;
-
-        for (NSInteger j = 0; j < kernelSize; j++) {
-            NSInteger dataIndex = i - halfKernel + j;
-            double weight = kernel[j];
-
-            // scipy的mode='constant': 边界外用0填充
-            if (dataIndex >= 0 && dataIndex < n) {
-                sum += [data[dataIndex] doubleValue] * weight;
-            }
-            // dataIndex < 0 或 >= n 时，dataValue视为0，无需加到sum中
-        }
-
-        [result addObject:@(sum)];
-    }
-
-    free(kernel);
-
-    return [result copy];
-}
-
-/**
- * 生成高斯核
- * g(x) = (1 / (sigma * sqrt(2*pi))) * exp(-x^2 / (2*sigma^2))
- */
-- (void)generateGaussianKernel:(float *)kernel size:(NSInteger)size sigma:(double)sigma {
-    NSInteger half = size / 2;
-    double scale = 1.0 / (sigma * sqrt(2.0 * M_PI));
-    double scale2 = 2.0 * sigma * sigma;
-
-    double sum = 0.0;
-    for (NSInteger i = 0; i < size; i++) {
-        double x = i - half;
-        double val = scale * exp(-(x * x) / scale2);
-        kernel[i] = (float)val;
-        sum += val;
-    }
-
-    // 归一化（使核和为1）
-    if (sum > 1e-9) {
-        for (NSInteger i = 0; i < size; i++) {
-            kernel[i] /= (float)sum;
-        }
-    }
-}
-
-/**
- * 计算复数功率谱 |H|^2 = H * conj(H) = real^2 + imag^2
- */
-- (NSArray<NSNumber *> *)complexPowerSpectrumReal:(NSArray<NSNumber *> *)real imag:(NSArray<NSNumber *> *)imag {
-    NSMutableArray<NSNumber *> *result = [NSMutableArray arrayWithCapacity:real.count];
-
-    for (NSInteger i = 0; i < real.count; i++) {
-        float r = [real[i] floatValue];
-        float im = imag && i < imag.count ? [imag[i] floatValue] : 0.0f;
-        [result addObject:@(r * r + im * im)];
+        values[i] = [data[i] doubleValue];
     }
 
-    return [result copy];
-}
-
-/**
- * 数组倒数（1/x）
- */
-- (NSArray<NSNumber *> *)reciprocal:(NSArray<NSNumber *> *)array {
-    NSMutableArray<NSNumber *> *result = [NSMutableArray arrayWithCapacity:array.count];
-
-    for (NSNumber *num in array) {
-        double val = [num doubleValue];
-        [result addObject:@(fabs(val) > 1e-9 ? 1.0 / val : 1e9)];  // 避免除以0
-    }
-
-    return [result copy];
-}
-
-/**
- * 数组相加
- */
-- (NSArray<NSNumber *> *)addArrays:(NSArray<NSNumber *> *)array1 and:(NSArray<NSNumber *> *)array2 {
-    NSMutableArray<NSNumber *> *result = [NSMutableArray arrayWithCapacity:array1.count];
-
-    for (NSInteger i = 0; i < array1.count; i++) {
-        float v1 = [array1[i] floatValue];
-        float v2 = i < array2.count ? [array2[i] floatValue] : 0.0f;
-        [result addObject:@(v1 + v2)];
+    // 固定直接卷积：sigma = len_lpf/6 较小，且结果与scipy逐点一致（递归路径是近似）
+    if (!PIDGaussianFilter1D(values, values, (size_t)n, sigma,
+                             PIDGaussianBoundaryConstant, PIDGaussianMethodDirect)) {
+        return data;
     }
 
-    return [result copy];
-}
-
-/**
- * 数组取负
- */
-- (NSArray<NSNumber *> *)negate:(NSArray<NSNumber *> *)array {
-    NSMutableArray<NSNumber *> *result = [NSMutableArray arrayWithCapacity:array.count];
-
-    for (NSNumber *num in array) {
-        [result addObject:@(-[num floatValue])];
+    NSMutableArray<NSNumber *> *result = [NSMutableArray arrayWithCapacity:n];
+    for (NSInteger i = 0; i < n; i++) {
+        [result addObject:@(values[i])];
     }
-
     return [result copy];
 }
 
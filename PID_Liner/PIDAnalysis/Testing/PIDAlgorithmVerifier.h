@@ -96,6 +96,9 @@ NS_ASSUME_NONNULL_BEGIN
 // 数据大小
 @property (nonatomic, assign) NSInteger dataSize;
 
+// 完成分析的窗口数（三个轴合计）
+@property (nonatomic, assign) NSInteger windowCount;
+
 // 执行时间（秒）
 @property (nonatomic, assign) double executionTime;
 
@@ -105,6 +108,10 @@ NS_ASSUME_NONNULL_BEGIN
 // 每秒处理点数
 @property (nonatomic, readonly) double pointsPerSecond;
 
+// 暂存区分配次数与其中向系统申请内存的次数（稳态下后者应为0）
+@property (nonatomic, assign) NSInteger scratchRequests;
+@property (nonatomic, assign) NSInteger heapAllocations;
+
 @end
 
 #pragma mark - 算法验证器
@@ -171,10 +178,268 @@ NS_ASSUME_NONNULL_BEGIN
 - (PIDVerificationResult *)verifySpectrumResult:(PIDSpectrumResult *)actual
                               referenceData:(NSDictionary *)expectedReferenceData;
 
+#pragma mark - 外存分析一致性
+
+/**
+ * 验证外存分析与内存中分析结果一致
+ * 对比各轴低/高输入响应曲线、窗口数和平均噪声频谱，并检查内存峰值不超过预算
+ * @param csvFilePath CSV文件路径
+ * @param memoryBudget 外存分析的内存预算（字节）
+ * @return 验证结果（误差为所有曲线中的最大值）
+ */
+- (PIDVerificationResult *)verifyOutOfCoreParity:(NSString *)csvFilePath
+                                    memoryBudget:(NSUInteger)memoryBudget;
+
+/**
+ * 同上，并要求两种分析读取的行数都等于文件的数据行数
+ * @param expectedRowCount 文件的数据行数（不含表头），不大于0时不检查
+ */
+- (PIDVerificationResult *)verifyOutOfCoreParity:(NSString *)csvFilePath
+                                    memoryBudget:(NSUInteger)memoryBudget
+                                expectedRowCount:(NSInteger)expectedRowCount;
+
+/**
+ * 超过解析器默认行数上限（10万行）的合成日志上验证外存分析读完整个文件，且与内存中分析一致
+ * @param sampleCount 合成日志行数（8kHz），应大于100000
+ * @return 验证结果
+ */
+- (PIDVerificationResult *)verifyOutOfCoreLongLogWithSampleCount:(NSInteger)sampleCount;
+
+#pragma mark - 流水线分析一致性
+
+/**
+ * 验证流水线分析与一次性分析（整段解析、重采样、堆叠后用PIDTraceAnalyzer分析）结果一致
+ * 中间快照按firstWindowIndex依次合并后应是最终结果的前缀，最终快照的逐窗口阶跃响应、
+ * 窗口数、行数与一次性分析相同，平均噪声频谱在相对容差内（按批次合并的求和顺序不同）
+ * @param csvFilePath CSV文件路径
+ * @return 验证结果（误差为阶跃响应的最大绝对误差）
+ */
+- (PIDVerificationResult *)verifyPipelineParityWithCSV:(NSString *)csvFilePath;
+
+#pragma mark - 插值内核一致性
+
+/**
+ * 验证插值内核与逐点扫描参考实现一致，并记录百万级数据的耗时
+ * 覆盖有序/无序查询、重复坐标和均匀网格路径
+ * @param sampleCount 原始点数（参考实现为O(n·m)，建议不超过几千点）
+ * @return 验证结果
+ */
+- (PIDVerificationResult *)verifyInterpolationKernelsWithSampleCount:(NSInteger)sampleCount;
+
+#pragma mark - FFT后端一致性
+
+/**
+ * 验证FFT各后端（Accelerate / 可移植实现）与直接DFT一致，并对比各后端耗时
+ * 覆盖实数正/逆变换和复数正/逆变换
+ * @param length 变换长度（任意长度：2/3/5合数走混合基，其余走Bluestein）
+ * @param iterations 计时循环次数
+ * @return 验证结果
+ */
+- (PIDVerificationResult *)verifyFFTBackendsWithLength:(NSInteger)length
+                                            iterations:(NSInteger)iterations;
+
+/**
+ * 验证实数FFT与numpy.fft.rfft参考结果一致
+ * 参考数据: {"testType": "fft", "input": [...], "real": [...], "imag": [...]}
+ * @param referenceData 参考数据（real/imag为rfft输出，n/2+1个点）
+ * @return 验证结果（误差按频谱最大幅度归一化）
+ */
+- (PIDVerificationResult *)verifyFFTReference:(NSDictionary *)referenceData;
+
+#pragma mark - 维纳反卷积内核一致性
+
+/**
+ * 验证批量融合维纳内核与逐窗口完整复数频谱的参考实现一致，并对比两者耗时
+ * 参考实现：完整复数fft → G·conj(H)/(|H|²+1/sn) → ifft取实部（NSArray逐步计算）
+ * @param windowCount 窗口数
+ * @param windowLength 每个窗口的点数
+ * @return 验证结果（误差按参考结果最大幅度归一化）
+ */
+- (PIDVerificationResult *)verifyWienerKernelWithWindowCount:(NSInteger)windowCount
+                                                windowLength:(NSInteger)windowLength;
+
+#pragma mark - 响应直方图一致性
+
+/**
+ * 验证直接散射的响应直方图（PIDResponseHistogram）与展平 → buildHistogram2D → 逐点高斯卷积
+ * 的参考实现一致，并对比两者耗时
+ * @param windowCount 窗口数
+ * @param responseLength 每个窗口的响应点数
+ * @return 验证结果
+ */
+- (PIDVerificationResult *)verifyResponseHistogramWithWindowCount:(NSInteger)windowCount
+                                                   responseLength:(NSInteger)responseLength;
+
+/**
+ * 验证增量响应分析：默认条件下与 PIDResponseCurveBuilder 一致；
+ * 依次调整质量阈值、油门范围、时间范围后，与按相同条件新建的分析逐点一致（增减窗口是精确的）；
+ * 分批追加窗口后与一次建立的分析一致
+ * @param windowCount 窗口数
+ * @param responseLength 每个窗口的响应点数
+ * @return 验证结果
+ */
+- (PIDVerificationResult *)verifyIncrementalResponseWithWindowCount:(NSInteger)windowCount
+                                                     responseLength:(NSInteger)responseLength;
+
+#pragma mark - 高斯平滑一致性
+
+/**
+ * 验证高斯平滑核心：直接卷积在constant/reflect边界下与scipy形式的逐点参考实现一致，
+ * 递归滤波与参考的峰值误差在2e-3以内，按轴批量平滑与逐列平滑一致，并对比两种方法耗时
+ * @param length 数据长度
+ * @param sigma 高斯核标准差
+ * @return 验证结果（误差按输入最大幅度归一化）
+ */
+- (PIDVerificationResult *)verifyGaussianFilterWithLength:(NSInteger)length
+                                                    sigma:(double)sigma;
+
+/**
+ * 验证高斯平滑与scipy.ndimage.gaussian_filter1d参考结果一致
+ * 参考数据: {"testType": "gaussian", "sigma": σ, "input": [...], "outputs": {"constant": [...], "reflect": [...], ...}}
+ * 每个mode分别检查直接卷积（逐点一致）与递归滤波（峰值误差2e-3以内）
+ * @param referenceData 参考数据（由generate_reference_fixtures.py生成）
+ * @return 验证结果（误差按输入最大幅度归一化）
+ */
+- (PIDVerificationResult *)verifyGaussianReference:(NSDictionary *)referenceData;
+
+#pragma mark - 精度策略一致性
+
+/**
+ * 验证阶跃响应链的两份精度实例：float64实例与逐步调用批量维纳反卷积 + 累积和的结果逐点相同，
+ * float32实例与float64的差异在 PIDRealParityTolerance 以内，并对比两者耗时；
+ * 分析器经频谱缓存的路径（按精度计算窗口频谱，再由缓存频谱做维纳/逆FFT/累积和）同样检查
+ * @param windowCount 窗口数
+ * @param windowLength 每个窗口的点数
+ * @return 验证结果（误差按float64结果最大幅度归一化）
+ */
+- (PIDVerificationResult *)verifyPrecisionPolicyWithWindowCount:(NSInteger)windowCount
+                                                   windowLength:(NSInteger)windowLength;
+
+#pragma mark - 频谱累加器一致性
+
+/**
+ * 验证噪声频谱流式累加器：平均谱与逐窗口矩阵取平均一致，油门热力图与按numpy.histogram2d分箱边界
+ * 逐点查找的参考直方图一致（含NaN/超范围油门与右端点），分两半累加后合并与一次累加一致
+ * @param windowCount 窗口数
+ * @param frequencyCount 每个窗口的频率点数
+ * @return 验证结果（误差按参考最大幅度归一化）
+ */
+- (PIDVerificationResult *)verifySpectrumAccumulatorWithWindowCount:(NSInteger)windowCount
+                                                     frequencyCount:(NSInteger)frequencyCount;
+
+#pragma mark - 协作式取消
+
+/**
+ * 验证取消检查点：未取消时结果完整；预先取消的令牌立即返回空结果；
+ * 分析进行中取消时返回空结果，并记录从取消到返回的延迟（应为毫秒级）
+ * @param sampleCount 合成日志的样本点数（8kHz，1秒窗口，15/16重叠）
+ * @return 验证结果（maxAbsoluteError为取消延迟，单位ms）
+ */
+- (PIDVerificationResult *)verifyCancellationWithSampleCount:(NSInteger)sampleCount;
+
+#pragma mark - 暂存区分配
+
+/**
+ * 验证逐窗口处理的稳态零分配：先预热一遍（各线程暂存区按窗口/FFT长度扩大），
+ * 再重复分析，统计暂存区分配次数与向系统申请内存的次数
+ * @param sampleCount 合成日志的样本点数（8kHz，1秒窗口，15/16重叠）
+ * @return 验证结果（maxAbsoluteError为稳态下最少的系统分配次数，meanAbsoluteError为每窗口暂存区分配次数）
+ */
+- (PIDVerificationResult *)verifyScratchArenaWithSampleCount:(NSInteger)sampleCount;
+
+#pragma mark - 平均互谱估计
+
+/**
+ * 对比平均互谱估计与完整方法（逐窗口维纳反卷积 + 直方图众数）的响应曲线
+ * 每个有P项数据的轴分别计算低/高输入曲线，稳态段（0.2–0.5s）最大偏差应在0.1以内，
+ * 同时记录两种方法的耗时
+ * @param csvFilePath 样例日志CSV（001.bbl / 003.bbl 解码后的文件）
+ * @return 验证结果（maxAbsoluteError为全程最大偏差，meanAbsoluteError为稳态段最大偏差）
+ */
+- (PIDVerificationResult *)verifyCrossSpectrumAgreementWithCSV:(NSString *)csvFilePath;
+
+#pragma mark - 三轴交错堆叠
+
+/**
+ * 验证三轴一遍堆叠与逐轴堆叠一致：各轴的PID输入/陀螺仪/油门/时间列逐位相同，
+ * 共用的加窗统计量与逐轴计算的统计量在容差内一致，阶跃响应相同；缺少的轴（空列）输出空堆叠；同时记录两种堆叠的耗时
+ * @param sampleCount 合成日志的样本点数（8kHz，1秒窗口，15/16重叠）
+ * @return 验证结果（maxAbsoluteError为统计量的最大相对误差）
+ */
+- (PIDVerificationResult *)verifyMultiAxisStacksWithSampleCount:(NSInteger)sampleCount;
+
+#pragma mark - 并行确定性
+
+/**
+ * 验证并行分析与调度无关：同样的三轴堆叠按轴并行（轴内窗口再嵌套并行）分析，
+ * 强制单个工作线程与使用全部工作线程时的阶跃响应与平均噪声频谱逐位相同；
+ * 另在并行任务内部嵌套提交任务，检查全部完成且结果与单线程相同
+ * @param sampleCount 合成日志的样本点数（8kHz，1秒窗口，15/16重叠）
+ * @return 验证结果（meanAbsoluteError为多线程相对单线程的加速比）
+ */
+- (PIDVerificationResult *)verifyParallelDeterminismWithSampleCount:(NSInteger)sampleCount;
+
+#pragma mark - 活动度预筛
+
+/**
+ * 对比开启/关闭活动度预筛的响应分析：响应曲线与活动窗口的阶跃响应应逐位相同，
+ * 之后请求全部窗口的陀螺仪频谱时只补算被跳过的窗口；同时记录预筛窗口数与FFT次数
+ * @param csvFilePath 样例日志CSV（001.bbl / 003.bbl 解码后的文件）
+ * @return 验证结果（maxAbsoluteError为响应曲线的最大偏差，meanAbsoluteError为预筛后FFT次数占原来的比例）
+ */
+- (PIDVerificationResult *)verifyActivityPruningWithCSV:(NSString *)csvFilePath;
+
+#pragma mark - 参数扫描
+
+/**
+ * 对比参数扫描与逐组完整分析：每组参数（截止频率 × 高输入阈值）的响应曲线应在容差内一致，
+ * 同一缓存的第二次扫描不再做正向FFT；同时记录逐组分析与一遍扫描的耗时
+ * @param csvFilePath 样例日志CSV（001.bbl / 003.bbl 解码后的文件）
+ * @return 验证结果（maxAbsoluteError为响应曲线的最大偏差）
+ */
+- (PIDVerificationResult *)verifyParameterSweepWithCSV:(NSString *)csvFilePath;
+
+#pragma mark - 多通道批量频谱
+
+/**
+ * 对比多通道批量频谱与逐通道频谱：陀螺仪通道的累加器应与 spectrumWithTime:spectralCache: 逐点相同，
+ * 每个通道（陀螺仪、D项、debug）的平均幅度谱应与单独调用 spectrumWithTime:traces: 在相对容差内一致；
+ * 同时记录逐通道调用与一次批量的耗时（只取前64个窗口，逐通道路径需要装箱全部窗口样本）
+ * @param csvFilePath 样例日志CSV（001.bbl / 003.bbl 解码后的文件）
+ * @return 验证结果（maxRelativeError为平均幅度谱的最大相对偏差）
+ */
+- (PIDVerificationResult *)verifyBatchedChannelSpectraWithCSV:(NSString *)csvFilePath;
+
+#pragma mark - 油门分层响应
+
+/**
+ * 对比一遍散射的油门分层响应直方图（PIDThrottleResponseHistogram，时间箱数取responseLength）
+ * 与逐油门箱筛选窗口、各自构建 PIDResponseHistogram 的结果：每个油门箱的响应曲线应逐点一致；
+ * 同时记录逐箱构建与一遍散射的耗时
+ * @param windowCount 窗口数（油门在0-100%内随机，约十分之一的窗口权重为0）
+ * @param responseLength 每个窗口的响应点数
+ * @return 验证结果
+ */
+- (PIDVerificationResult *)verifyThrottleResponseWithWindowCount:(NSInteger)windowCount
+                                                  responseLength:(NSInteger)responseLength;
+
+#pragma mark - 多相重采样
+
+/**
+ * 验证多相重采样器：1kHz→8kHz（L=8）与3.2kHz→2kHz（L/M=5/8）两种变换比下，
+ * 正弦输入的输出与解析正弦一致（去掉两端各10%的边界段）；
+ * 按不规则块大小流式重采样的输出与整段重采样逐位相同；
+ * 比时间列短的列补齐后不产生NaN
+ * @param sampleCount 每种变换比的输入点数
+ * @return 验证结果（误差为正弦的最大绝对误差）
+ */
+- (PIDVerificationResult *)verifyPolyphaseResamplerWithSampleCount:(NSInteger)sampleCount;
+
 #pragma mark - 批量验证
 
 /**
- * 运行完整验证套件
+ * 运行完整验证套件：目录中的 *_reference.json 参考数据、不依赖文件的合成数据检查，
+ * 以及对目录中每个飞行日志CSV的日志检查（目录中没有日志时使用开头2秒地面怠速的合成日志）
  * @param testDataPath 测试数据目录路径
  * @return 验证报告
  */
@@ -183,7 +448,7 @@ NS_ASSUME_NONNULL_BEGIN
 #pragma mark - 性能测试
 
 /**
- * 运行性能测试
+ * 运行性能测试：解析 + 完整分析流程（重采样、三轴堆叠、频谱缓存、阶跃响应与噪声频谱，与分析界面相同）
  * @param csvFilePath CSV文件路径
  * @return 性能测试结果
  */
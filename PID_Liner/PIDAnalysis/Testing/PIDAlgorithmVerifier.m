@@ -9,6 +9,19 @@
 #import "PIDAlgorithmVerifier.h"
 #import "PIDCSVParser.h"
 #import "PIDTraceAnalyzer.h"
+#import "PIDPipelinedAnalyzer.h"
+#import "PIDOutOfCoreAnalyzer.h"
+#import "PIDPolyphaseResampler.h"
+#import "PIDInterpolation.h"
+#import "PIDFFTPlan.h"
+#import "PIDFFTProcessor.h"
+#import "PIDWienerDeconvolution.h"
+#import "PIDGaussianSmoothing.h"
+#import "PIDResponseKernels.h"
+#import "PIDSpectralCache.h"
+#import "PIDCancellationToken.h"
+#import "PIDScratchArena.h"
+#import "PIDParallel.h"
 #import "PIDDataModels.h"
 #import <mach/mach.h>
 
@@ -307,8 +320,2500 @@
     return result;
 }
 
+#pragma mark - 合成日志
+
+/**
+ * 合成飞行日志（8kHz）：各轴随机游走的摇杆输入，陀螺仪一阶滞后跟随（轴序号越大跟随越快），
+ * P项与跟随误差成正比；油门在 throttleStart → throttleEnd 之间线性变化
+ */
+static PIDCSVData *PIDSyntheticFlightLog(NSInteger sampleCount, NSInteger axisCount,
+                                          double throttleStart, double throttleEnd) {
+    NSInteger n = sampleCount;
+    axisCount = MIN(MAX(axisCount, 1), 3);
+    NSMutableArray<NSNumber *> *time = [NSMutableArray arrayWithCapacity:n];
+    NSMutableArray<NSNumber *> *throttle = [NSMutableArray arrayWithCapacity:n];
+    NSMutableArray<NSMutableArray<NSNumber *> *> *command = [NSMutableArray arrayWithCapacity:axisCount];
+    NSMutableArray<NSMutableArray<NSNumber *> *> *gyro = [NSMutableArray arrayWithCapacity:axisCount];
+    NSMutableArray<NSMutableArray<NSNumber *> *> *axisP = [NSMutableArray arrayWithCapacity:axisCount];
+    for (NSInteger axis = 0; axis < axisCount; axis++) {
+        [command addObject:[NSMutableArray arrayWithCapacity:n]];
+        [gyro addObject:[NSMutableArray arrayWithCapacity:n]];
+        [axisP addObject:[NSMutableArray arrayWithCapacity:n]];
+    }
+
+    double stick[3] = {0.0, 0.0, 0.0};
+    double rate[3] = {0.0, 0.0, 0.0};
+    for (NSInteger i = 0; i < n; i++) {
+        [time addObject:@(i / 8000.0)];
+        [throttle addObject:@(throttleStart + (throttleEnd - throttleStart) * i / n)];
+        for (NSInteger axis = 0; axis < axisCount; axis++) {
+            stick[axis] = MAX(MIN(stick[axis] + ((double)arc4random_uniform(2001) - 1000.0) / 100.0, 500.0), -500.0);
+            rate[axis] += (stick[axis] - rate[axis]) * 0.02 * (axis + 1);
+            [command[axis] addObject:@(stick[axis])];
+            [gyro[axis] addObject:@(rate[axis] + ((double)arc4random_uniform(201) - 100.0) / 50.0)];
+            [axisP[axis] addObject:@((stick[axis] - rate[axis]) * 0.5)];
+        }
+    }
+
+    PIDCSVData *data = [[PIDCSVData alloc] init];
+    data.timeSeconds = time;
+    data.rcCommand3 = throttle;
+    data.rcCommand0 = command[0];
+    data.gyroADC0 = gyro[0];
+    data.axisP0 = axisP[0];
+    if (axisCount > 1) {
+        data.rcCommand1 = command[1];
+        data.gyroADC1 = gyro[1];
+        data.axisP1 = axisP[1];
+    }
+    if (axisCount > 2) {
+        data.rcCommand2 = command[2];
+        data.gyroADC2 = gyro[2];
+        data.axisP2 = axisP[2];
+    }
+    data.sampleRate = 8000.0;
+    data.dataLength = n;
+    return data;
+}
+
+/**
+ * 把合成日志的前idleSampleCount个点改成地面怠速：摇杆与P项为0，陀螺仪只有噪声
+ * 这一段的窗口 max_in ≤ 20，活动度预筛会跳过它们
+ */
+static void PIDSyntheticGroundIdle(PIDCSVData *data, NSInteger idleSampleCount) {
+    NSNumber *zero = @0.0;
+    for (NSInteger axis = 0; axis < 3; axis++) {
+        NSArray<NSNumber *> *command = axis == 0 ? data.rcCommand0 : (axis == 1 ? data.rcCommand1 : data.rcCommand2);
+        NSArray<NSNumber *> *gyro = axis == 0 ? data.gyroADC0 : (axis == 1 ? data.gyroADC1 : data.gyroADC2);
+        NSArray<NSNumber *> *axisP = axis == 0 ? data.axisP0 : (axis == 1 ? data.axisP1 : data.axisP2);
+        if (command.count == 0 || gyro.count == 0 || axisP.count == 0) {
+            continue;
+        }
+        NSMutableArray<NSNumber *> *idleCommand = [command mutableCopy];
+        NSMutableArray<NSNumber *> *idleGyro = [gyro mutableCopy];
+        NSMutableArray<NSNumber *> *idleP = [axisP mutableCopy];
+        NSInteger count = MIN(idleSampleCount, (NSInteger)idleGyro.count);
+        for (NSInteger i = 0; i < count; i++) {
+            idleCommand[i] = zero;
+            idleGyro[i] = @(((double)arc4random_uniform(201) - 100.0) / 50.0);
+            idleP[i] = zero;
+        }
+        switch (axis) {
+            case 0: data.rcCommand0 = idleCommand; data.gyroADC0 = idleGyro; data.axisP0 = idleP; break;
+            case 1: data.rcCommand1 = idleCommand; data.gyroADC1 = idleGyro; data.axisP1 = idleP; break;
+            default: data.rcCommand2 = idleCommand; data.gyroADC2 = idleGyro; data.axisP2 = idleP; break;
+        }
+    }
+}
+
+/**
+ * 把合成日志写成解析器可读的CSV（时间列为微秒）
+ * @return 文件路径，写入失败返回nil
+ */
+static NSString * _Nullable PIDWriteSyntheticFlightLogCSV(PIDCSVData *data, NSString *filePath) {
+    NSArray<NSArray<NSNumber *> *> *columns = @[
+        data.rcCommand0 ?: @[], data.rcCommand1 ?: @[], data.rcCommand2 ?: @[], data.rcCommand3 ?: @[],
+        data.axisP0 ?: @[], data.axisP1 ?: @[], data.axisP2 ?: @[],
+        data.gyroADC0 ?: @[], data.gyroADC1 ?: @[], data.gyroADC2 ?: @[],
+    ];
+
+    NSMutableString *content = [NSMutableString stringWithCapacity:(NSUInteger)data.dataLength * 96];
+    [content appendString:@"time (us),rcCommand[0],rcCommand[1],rcCommand[2],rcCommand[3],"
+     "axisP[0],axisP[1],axisP[2],gyroADC[0],gyroADC[1],gyroADC[2]\n"];
+    for (NSInteger i = 0; i < data.dataLength; i++) {
+        [content appendFormat:@"%.0f", [data.timeSeconds[i] doubleValue] * 1000000.0];
+        for (NSArray<NSNumber *> *column in columns) {
+            if ((NSUInteger)i < column.count) {
+                [content appendFormat:@",%.4f", [column[i] doubleValue]];
+            } else {
+                [content appendString:@",0"];
+            }
+        }
+        [content appendString:@"\n"];
+    }
+
+    NSError *error = nil;
+    if (![content writeToFile:filePath atomically:YES encoding:NSUTF8StringEncoding error:&error]) {
+        NSLog(@"❌ 写入合成日志失败: %@", error.localizedDescription);
+        return nil;
+    }
+    return filePath;
+}
+
+#pragma mark - 外存分析一致性
+
+- (PIDVerificationResult *)verifyOutOfCoreParity:(NSString *)csvFilePath
+                                    memoryBudget:(NSUInteger)memoryBudget {
+    return [self verifyOutOfCoreParity:csvFilePath memoryBudget:memoryBudget expectedRowCount:0];
+}
+
+- (PIDVerificationResult *)verifyOutOfCoreParity:(NSString *)csvFilePath
+                                    memoryBudget:(NSUInteger)memoryBudget
+                                expectedRowCount:(NSInteger)expectedRowCount {
+    PIDVerificationResult *result = [[PIDVerificationResult alloc] init];
+    result.timestamp = [NSDate date];
+    result.absoluteTolerance = _absoluteTolerance;
+
+    // 内存中分析（参考）
+    PIDPipelinedAnalyzer *pipeline = [[PIDPipelinedAnalyzer alloc] initWithConfig:nil];
+    PIDPipelineSnapshot *snapshot = [pipeline analyzeCSVFile:csvFilePath];
+    if (!snapshot) {
+        result.passed = NO;
+        result.errorDetails = pipeline.lastErrorMessage ?: @"内存中分析失败";
+        return result;
+    }
+
+    // 外存分析
+    PIDOutOfCoreConfig *config = [PIDOutOfCoreConfig defaultConfig];
+    config.memoryBudgetBytes = memoryBudget;
+    PIDOutOfCoreAnalyzer *outOfCore = [[PIDOutOfCoreAnalyzer alloc] initWithConfig:config];
+    PIDOutOfCoreResult *streamed = [outOfCore analyzeCSVFile:csvFilePath];
+    if (!streamed) {
+        result.passed = NO;
+        result.errorDetails = outOfCore.lastErrorMessage ?: @"外存分析失败";
+        return result;
+    }
+
+    NSMutableArray<NSString *> *failures = [NSMutableArray array];
+    double maxError = 0.0;
+    double sumMeanError = 0.0;
+    NSInteger comparisons = 0;
+
+    for (NSInteger axis = 0; axis < 3; axis++) {
+        PIDResponseCurves *expected = [PIDTraceAnalyzer responseCurvesFromResult:snapshot.responses[axis]];
+        PIDResponseCurves *actual = streamed.curves[axis];
+
+        if (expected.lowWindowCount != actual.lowWindowCount || expected.highWindowCount != actual.highWindowCount) {
+            [failures addObject:[NSString stringWithFormat:@"轴%ld窗口数不一致: 低%ld/%ld 高%ld/%ld", (long)axis,
+                                 (long)actual.lowWindowCount, (long)expected.lowWindowCount,
+                                 (long)actual.highWindowCount, (long)expected.highWindowCount]];
+        }
+
+        // 内存中分析按批次合并频谱累加器，外存分析按分块合并，两者的平均谱应一致
+        NSArray<NSNumber *> *expectedSpectrum = snapshot.spectrums[axis].accumulator.averageSpectrum ?: @[];
+
+        NSArray<NSArray *> *pairs = @[
+            @[@"respLow", actual.respLow ?: @[], expected.respLow ?: @[]],
+            @[@"respHigh", actual.respHigh ?: @[], expected.respHigh ?: @[]],
+            @[@"spectrum", streamed.spectrums[axis].spectrum.firstObject ?: @[], expectedSpectrum],
+        ];
+        for (NSArray *pair in pairs) {
+            PIDVerificationResult *itemResult = [self verifyArray:pair[1] withExpected:pair[2]];
+            maxError = MAX(maxError, itemResult.maxAbsoluteError);
+            sumMeanError += itemResult.meanAbsoluteError;
+            comparisons++;
+            if (!itemResult.passed) {
+                [failures addObject:[NSString stringWithFormat:@"轴%ld %@: %@", (long)axis, pair[0],
+                                     itemResult.errorDetails ?: @"超出容差"]];
+            }
+        }
+    }
+
+    // 行数是源文件行数，两种分析应一致
+    if (streamed.rowCount != snapshot.rowCount) {
+        [failures addObject:[NSString stringWithFormat:@"行数不一致: %ld/%ld",
+                             (long)streamed.rowCount, (long)snapshot.rowCount]];
+    }
+    if (expectedRowCount > 0 && (streamed.rowCount != expectedRowCount || snapshot.rowCount != expectedRowCount)) {
+        [failures addObject:[NSString stringWithFormat:@"未读完文件: 外存%ld行 / 内存中%ld行 / 文件%ld行",
+                             (long)streamed.rowCount, (long)snapshot.rowCount, (long)expectedRowCount]];
+    }
+
+    // 批大小已缩到一个窗口仍超出时才算失败
+    if (streamed.peakFootprintBytes > memoryBudget && streamed.batchWindowCount > 1) {
+        [failures addObject:[NSString stringWithFormat:@"内存峰值%.1fMB超出预算%.1fMB",
+                             streamed.peakFootprintBytes / 1048576.0, memoryBudget / 1048576.0]];
+    }
+
+    result.maxAbsoluteError = maxError;
+    result.meanAbsoluteError = comparisons > 0 ? sumMeanError / comparisons : 0.0;
+    result.passed = failures.count == 0;
+    if (!result.passed) {
+        result.errorDetails = [failures componentsJoinedByString:@"\n"];
+    }
+
+    NSLog(@"🔍 外存分析一致性: %@ (最大误差%.2e, %ld遍, 每批%ld窗口, 内存峰值%.1fMB)",
+          result.passed ? @"通过" : @"失败", maxError, (long)streamed.passCount,
+          (long)streamed.batchWindowCount, streamed.peakFootprintBytes / 1048576.0);
+
+    return result;
+}
+
+- (PIDVerificationResult *)verifyOutOfCoreLongLogWithSampleCount:(NSInteger)sampleCount {
+    NSString *path = [NSTemporaryDirectory() stringByAppendingPathComponent:@"pid_verifier_long_log.csv"];
+    PIDCSVData *synthetic = PIDSyntheticFlightLog(sampleCount, 3, 1100.0, 1900.0);
+    if (!PIDWriteSyntheticFlightLogCSV(synthetic, path)) {
+        PIDVerificationResult *result = [[PIDVerificationResult alloc] init];
+        result.timestamp = [NSDate date];
+        result.passed = NO;
+        result.errorDetails = @"无法写入合成长日志";
+        return result;
+    }
+
+    PIDVerificationResult *result = [self verifyOutOfCoreParity:path
+                                                  memoryBudget:[PIDOutOfCoreConfig defaultConfig].memoryBudgetBytes
+                                              expectedRowCount:sampleCount];
+    [[NSFileManager defaultManager] removeItemAtPath:path error:nil];
+    return result;
+}
+
+#pragma mark - 流水线分析一致性
+
+/**
+ * 两个平均幅度谱的最大偏差相对于参考谱峰值
+ */
+static double PIDSpectrumRelativeDeviation(NSArray<NSNumber *> *expected, NSArray<NSNumber *> *actual) {
+    if (expected.count != actual.count || expected.count == 0) {
+        return INFINITY;
+    }
+    double peak = 0.0;
+    double deviation = 0.0;
+    for (NSUInteger k = 0; k < expected.count; k++) {
+        peak = MAX(peak, fabs(expected[k].doubleValue));
+        deviation = MAX(deviation, fabs(expected[k].doubleValue - actual[k].doubleValue));
+    }
+    return peak > 0 ? deviation / peak : deviation;
+}
+
+/**
+ * 两组结果前windowCount个窗口阶跃响应的最大差异（窗口数或响应长度不同时返回INFINITY）
+ */
+static double PIDStepResponseMaxDifference(PIDResponseResult *a, PIDResponseResult *b, NSInteger windowCount) {
+    if ((NSInteger)a.stepResponse.count < windowCount || (NSInteger)b.stepResponse.count < windowCount) {
+        return INFINITY;
+    }
+    double maxError = 0.0;
+    for (NSInteger w = 0; w < windowCount; w++) {
+        NSArray<NSNumber *> *rowA = a.stepResponse[w];
+        NSArray<NSNumber *> *rowB = b.stepResponse[w];
+        if (rowA.count != rowB.count) {
+            return INFINITY;
+        }
+        for (NSUInteger i = 0; i < rowA.count; i++) {
+            maxError = MAX(maxError, fabs([rowA[i] doubleValue] - [rowB[i] doubleValue]));
+        }
+    }
+    return maxError;
+}
+
+- (PIDVerificationResult *)verifyPipelineParityWithCSV:(NSString *)csvFilePath {
+    PIDVerificationResult *result = [[PIDVerificationResult alloc] init];
+    result.timestamp = [NSDate date];
+    result.absoluteTolerance = _absoluteTolerance;
+
+    // 一次性分析（参考）：与PIDAnalysisViewController相同的整段流程
+    PIDCSVParser *parser = [PIDCSVParser parser];
+    parser.config.maxRows = 0;
+    PIDCSVData *data = [parser parseCSV:csvFilePath];
+    if (!data || data.timeSeconds.count == 0) {
+        result.passed = NO;
+        result.errorDetails = [NSString stringWithFormat:@"无法解析CSV: %@", [csvFilePath lastPathComponent]];
+        return result;
+    }
+    NSInteger sourceRows = (NSInteger)data.timeSeconds.count;
+
+    PIDPipelineConfig *config = [PIDPipelineConfig defaultConfig];
+    double sampleRate = data.sampleRate > 0 ? data.sampleRate : PIDReferenceAnalysisRate;
+    PIDPolyphaseResampler *resampler = [PIDPolyphaseResampler resamplerForSampleRate:sampleRate];
+    if (resampler) {
+        data = [resampler resampleData:data];
+        sampleRate = resampler.outputRate;
+    }
+    NSInteger windowSize = [PIDPolyphaseResampler windowSize:config.windowSize
+                                             forAnalysisRate:[PIDPolyphaseResampler analysisRateForSampleRate:sampleRate]];
+
+    CFAbsoluteTime start = CFAbsoluteTimeGetCurrent();
+    PIDTraceAnalyzer *analyzer = [[PIDTraceAnalyzer alloc] initWithSampleRate:sampleRate cutFreq:config.cutFreq];
+    analyzer.pruneInactiveWindows = YES;
+    analyzer.precision = config.precision;
+    NSArray<PIDStackData *> *axisStacks = [PIDStackData stacksForAxesFromData:data
+                                                                  windowSize:windowSize
+                                                                     overlap:config.overlap
+                                                                      pGains:config.pGains];
+    NSMutableArray<PIDResponseResult *> *expectedResponses = [NSMutableArray arrayWithCapacity:3];
+    NSMutableArray<PIDSpectrumResult *> *expectedSpectrums = [NSMutableArray arrayWithCapacity:3];
+    for (NSInteger axis = 0; axis < 3; axis++) {
+        PIDResponseResult *response = [[PIDResponseResult alloc] init];
+        PIDSpectrumResult *spectrum = [[PIDSpectrumResult alloc] init];
+        if (axisStacks[axis].windowCount > 0) {
+            PIDSpectralCache *cache = [[PIDSpectralCache alloc] initWithStackData:axisStacks[axis]];
+            response = [analyzer stackResponseWithSpectralCache:cache] ?: response;
+            spectrum = [analyzer spectrumWithTime:data.timeSeconds spectralCache:cache] ?: spectrum;
+        }
+        [expectedResponses addObject:response];
+        [expectedSpectrums addObject:spectrum];
+    }
+    double oneShotMs = (CFAbsoluteTimeGetCurrent() - start) * 1000.0;
+
+    // 流水线分析：中间快照只带新窗口，按接收顺序合并
+    NSMutableArray<PIDResponseResult *> *merged = [NSMutableArray arrayWithCapacity:3];
+    for (NSInteger axis = 0; axis < 3; axis++) {
+        PIDResponseResult *response = [[PIDResponseResult alloc] init];
+        response.stepResponse = @[];
+        [merged addObject:response];
+    }
+    __block NSInteger nextWindowIndex = 0;
+    __block NSInteger snapshotCount = 0;
+    __block BOOL orderOK = YES;
+    PIDPipelinedAnalyzer *pipeline = [[PIDPipelinedAnalyzer alloc] initWithConfig:config];
+    pipeline.snapshotHandler = ^(PIDPipelineSnapshot *snapshot) {
+        orderOK = orderOK && snapshot.firstWindowIndex == nextWindowIndex && snapshot.responses.count == 3;
+        for (NSUInteger axis = 0; axis < MIN(snapshot.responses.count, (NSUInteger)3); axis++) {
+            [merged[axis] appendWindowsFromResult:snapshot.responses[axis]];
+        }
+        nextWindowIndex = snapshot.windowCount;
+        snapshotCount++;
+    };
+
+    start = CFAbsoluteTimeGetCurrent();
+    PIDPipelineSnapshot *snapshot = [pipeline analyzeCSVFile:csvFilePath];
+    double pipelineMs = (CFAbsoluteTimeGetCurrent() - start) * 1000.0;
+
+    // 中间快照在主队列上交付：排在它们之后的标记执行时，所有快照都已合并
+    if ([NSThread isMainThread]) {
+        __block BOOL delivered = NO;
+        dispatch_async(dispatch_get_main_queue(), ^{
+            delivered = YES;
+        });
+        while (!delivered) {
+            [[NSRunLoop currentRunLoop] runMode:NSDefaultRunLoopMode
+                                     beforeDate:[NSDate dateWithTimeIntervalSinceNow:0.01]];
+        }
+    } else {
+        dispatch_sync(dispatch_get_main_queue(), ^{});
+    }
+
+    if (!snapshot) {
+        result.passed = NO;
+        result.errorDetails = pipeline.lastErrorMessage ?: @"流水线分析失败";
+        return result;
+    }
+
+    NSMutableArray<NSString *> *failures = [NSMutableArray array];
+    if (snapshot.rowCount != sourceRows) {
+        [failures addObject:[NSString stringWithFormat:@"行数不一致: %ld/%ld",
+                             (long)snapshot.rowCount, (long)sourceRows]];
+    }
+    if (!orderOK) {
+        [failures addObject:@"中间快照的窗口编号不连续"];
+    }
+
+    double maxError = 0.0;
+    double spectrumError = 0.0;
+    for (NSInteger axis = 0; axis < 3; axis++) {
+        PIDResponseResult *expected = expectedResponses[axis];
+        PIDResponseResult *actual = snapshot.responses[axis];
+        NSInteger windows = (NSInteger)expected.stepResponse.count;
+        if ((NSInteger)actual.stepResponse.count != windows) {
+            [failures addObject:[NSString stringWithFormat:@"轴%ld窗口数不一致: %lu/%ld", (long)axis,
+                                 (unsigned long)actual.stepResponse.count, (long)windows]];
+            continue;
+        }
+        maxError = MAX(maxError, PIDStepResponseMaxDifference(actual, expected, windows));
+        maxError = MAX(maxError, PIDStepResponseMaxDifference(merged[axis], expected, (NSInteger)merged[axis].stepResponse.count));
+        NSArray<NSNumber *> *expectedSpectrum = expectedSpectrums[axis].accumulator.averageSpectrum ?: @[];
+        NSArray<NSNumber *> *actualSpectrum = snapshot.spectrums[axis].accumulator.averageSpectrum ?: @[];
+        if (expectedSpectrum.count > 0 || actualSpectrum.count > 0) {
+            spectrumError = MAX(spectrumError, PIDSpectrumRelativeDeviation(expectedSpectrum, actualSpectrum));
+        }
+    }
+    if (maxError > _absoluteTolerance) {
+        [failures addObject:[NSString stringWithFormat:@"阶跃响应最大误差%.2e", maxError]];
+    }
+    if (spectrumError > _relativeTolerance) {
+        [failures addObject:[NSString stringWithFormat:@"平均噪声频谱相对误差%.2e", spectrumError]];
+    }
+
+    result.maxAbsoluteError = maxError;
+    result.maxRelativeError = spectrumError;
+    result.passed = failures.count == 0;
+    if (!result.passed) {
+        result.errorDetails = [failures componentsJoinedByString:@"\n"];
+    }
+
+    NSLog(@"🔍 流水线分析一致性(%@): %@ (%ld行, %ld窗口, %ld份中间快照, 最大误差%.2e, 一次性%.1fms / 流水线%.1fms)",
+          [csvFilePath lastPathComponent], result.passed ? @"通过" : @"失败", (long)snapshot.rowCount,
+          (long)snapshot.windowCount, (long)snapshotCount, maxError, oneShotMs, pipelineMs);
+
+    return result;
+}
+
+#pragma mark - 插值内核一致性
+
+/**
+ * 参考实现：逐点从头扫描区间（内核优化前的算法）
+ */
+static double PIDReferenceLinear(const double *x, const double *y, NSInteger n, double value) {
+    if (value <= x[0]) return y[0];
+    if (value >= x[n - 1]) return y[n - 1];
+    NSInteger i = 0;
+    for (i = 0; i < n - 1; i++) {
+        if (value < x[i + 1]) break;
+    }
+    return y[i] + (value - x[i]) / (x[i + 1] - x[i]) * (y[i + 1] - y[i]);
+}
+
+static double PIDReferenceNearest(const double *x, const double *y, NSInteger n, double value) {
+    double minDist = HUGE_VAL;
+    double nearest = y[0];
+    for (NSInteger i = 0; i < n; i++) {
+        double dist = fabs(x[i] - value);
+        if (dist < minDist) {
+            minDist = dist;
+            nearest = y[i];
+        }
+    }
+    return nearest;
+}
+
+- (PIDVerificationResult *)verifyInterpolationKernelsWithSampleCount:(NSInteger)sampleCount {
+    PIDVerificationResult *result = [[PIDVerificationResult alloc] init];
+    result.timestamp = [NSDate date];
+    result.absoluteTolerance = _absoluteTolerance;
+
+    NSInteger n = MAX(sampleCount, 2);
+    NSInteger m = n + n / 2;
+    NSMutableData *storage = [NSMutableData dataWithLength:sizeof(double) * (3 * n + 2 * m)];
+    double *x = storage.mutableBytes;
+    double *y = x + n;
+    double *xUniform = y + n;
+    double *query = xUniform + n;
+    double *output = query + m;
+
+    // 带抖动和重复时间戳的原始坐标
+    double t = 0.0;
+    for (NSInteger i = 0; i < n; i++) {
+        t += (i % 7 == 3) ? 0.0 : 0.5 + (double)arc4random_uniform(1000) / 1000.0;
+        x[i] = t;
+        y[i] = sin(i * 0.1) + (double)arc4random_uniform(1000) / 1000.0;
+        xUniform[i] = 3.0 + 0.25 * i;
+    }
+
+    double maxError = 0.0;
+    for (NSInteger pass = 0; pass < 2; pass++) {
+        // 第一遍有序查询（双指针），第二遍随机查询（二分）；两端都超出原始范围
+        for (NSInteger k = 0; k < m; k++) {
+            query[k] = pass == 0
+                ? -10.0 + (t + 20.0) * k / (m - 1)
+                : -10.0 + (t + 20.0) * arc4random_uniform(1 << 30) / (double)(1 << 30);
+        }
+
+        PIDInterpolateLinear(x, y, n, query, output, m);
+        for (NSInteger k = 0; k < m; k++) {
+            maxError = MAX(maxError, fabs(output[k] - PIDReferenceLinear(x, y, n, query[k])));
+        }
+
+        PIDInterpolateNearest(x, y, n, query, output, m);
+        for (NSInteger k = 0; k < m; k++) {
+            maxError = MAX(maxError, fabs(output[k] - PIDReferenceNearest(x, y, n, query[k])));
+        }
+    }
+
+    double uniformSpan = 0.25 * (n - 1);
+    for (NSInteger k = 0; k < m; k++) {
+        query[k] = 2.0 + (uniformSpan + 2.0) * arc4random_uniform(1 << 30) / (double)(1 << 30);
+    }
+    PIDInterpolateLinearUniform(3.0, 0.25, y, n, query, output, m);
+    for (NSInteger k = 0; k < m; k++) {
+        maxError = MAX(maxError, fabs(output[k] - PIDReferenceLinear(xUniform, y, n, query[k])));
+    }
+
+    // 百万点均匀化耗时（参考实现在此规模下需要数分钟，不做对比）
+    const NSInteger largeCount = 1000000;
+    NSMutableData *large = [NSMutableData dataWithLength:sizeof(double) * 4 * largeCount];
+    double *lx = large.mutableBytes;
+    double *ly = lx + largeCount;
+    double *lq = ly + largeCount;
+    double *lo = lq + largeCount;
+    for (NSInteger i = 0; i < largeCount; i++) {
+        lx[i] = i * 1.25e-4 + arc4random_uniform(3) * 1e-6;
+        ly[i] = (double)i;
+    }
+    for (NSInteger i = 0; i < largeCount; i++) {
+        lq[i] = lx[0] + (lx[largeCount - 1] - lx[0]) * i / (largeCount - 1);
+    }
+    CFAbsoluteTime start = CFAbsoluteTimeGetCurrent();
+    PIDInterpolateLinear(lx, ly, largeCount, lq, lo, largeCount);
+    double elapsedMs = (CFAbsoluteTimeGetCurrent() - start) * 1000.0;
+
+    result.maxAbsoluteError = maxError;
+    result.meanAbsoluteError = maxError;
+    result.passed = maxError <= MAX(_absoluteTolerance, 1e-9);
+    if (!result.passed) {
+        result.errorDetails = [NSString stringWithFormat:@"插值内核与参考实现不一致: 最大误差%.2e", maxError];
+    }
+
+    NSLog(@"🔍 插值内核一致性: %@ (最大误差%.2e, 百万点均匀化%.1fms)",
+          result.passed ? @"通过" : @"失败", maxError, elapsedMs);
+
+    return result;
+}
+
+#pragma mark - FFT后端一致性
+
+/**
+ * 直接DFT（O(n²)参考实现）
+ */
+static void PIDReferenceDFT(const double *inReal, const double *inImag, NSInteger n,
+                            double *outReal, double *outImag) {
+    for (NSInteger k = 0; k < n; k++) {
+        double sumReal = 0.0;
+        double sumImag = 0.0;
+        for (NSInteger j = 0; j < n; j++) {
+            double angle = -2.0 * M_PI * (double)((k * j) % n) / (double)n;
+            double c = cos(angle);
+            double s = sin(angle);
+            sumReal += inReal[j] * c - inImag[j] * s;
+            sumImag += inReal[j] * s + inImag[j] * c;
+        }
+        outReal[k] = sumReal;
+        outImag[k] = sumImag;
+    }
+}
+
+- (PIDVerificationResult *)verifyFFTBackendsWithLength:(NSInteger)length
+                                            iterations:(NSInteger)iterations {
+    PIDVerificationResult *result = [[PIDVerificationResult alloc] init];
+    result.timestamp = [NSDate date];
+    result.absoluteTolerance = _absoluteTolerance;
+
+    // 任意长度（混合基 / Bluestein），不再取2的幂次
+    NSInteger n = MAX(length, 1);
+    NSInteger half = n / 2;
+
+    NSMutableData *storage = [NSMutableData dataWithLength:sizeof(double) * 8 * n];
+    double *signalReal = storage.mutableBytes;
+    double *signalImag = signalReal + n;
+    double *referenceReal = signalImag + n;
+    double *referenceImag = referenceReal + n;
+    double *outReal = referenceImag + n;
+    double *outImag = outReal + n;
+    double *roundTrip = outImag + n;
+    double *zeros = roundTrip + n;
+
+    for (NSInteger i = 0; i < n; i++) {
+        signalReal[i] = sin(i * 0.05) + (double)arc4random_uniform(1000) / 1000.0 - 0.5;
+        signalImag[i] = cos(i * 0.013) * 0.3;
+    }
+
+    // 直接DFT参考（实数输入和复数输入各一次）
+    NSMutableData *realReference = [NSMutableData dataWithLength:sizeof(double) * 2 * n];
+    double *realRefReal = realReference.mutableBytes;
+    double *realRefImag = realRefReal + n;
+    PIDReferenceDFT(signalReal, zeros, n, realRefReal, realRefImag);
+    PIDReferenceDFT(signalReal, signalImag, n, referenceReal, referenceImag);
+
+    // 误差按频谱幅度归一化（直接DFT本身有O(n)量级的舍入误差）
+    double scale = 1.0;
+    for (NSInteger k = 0; k < n; k++) {
+        scale = MAX(scale, hypot(referenceReal[k], referenceImag[k]));
+    }
+
+    double maxError = 0.0;
+    NSMutableString *timings = [NSMutableString string];
+    PIDFFTBackend backends[] = { PIDFFTBackendAccelerate, PIDFFTBackendPortable };
+
+    for (NSInteger b = 0; b < 2; b++) {
+        const PIDFFTPlan *plan = PIDFFTPlanForLength((size_t)n, backends[b]);
+        if (!plan) {
+            continue;
+        }
+
+        // 实数正变换
+        PIDFFTRealForward(plan, signalReal, outReal, outImag);
+        for (NSInteger k = 0; k <= half; k++) {
+            maxError = MAX(maxError, fabs(outReal[k] - realRefReal[k]) / scale);
+            maxError = MAX(maxError, fabs(outImag[k] - realRefImag[k]) / scale);
+        }
+
+        // 实数逆变换（往返）
+        PIDFFTRealInverse(plan, outReal, outImag, roundTrip);
+        for (NSInteger i = 0; i < n; i++) {
+            maxError = MAX(maxError, fabs(roundTrip[i] - signalReal[i]));
+        }
+
+        // 复数正变换与往返
+        PIDFFTComplexForward(plan, signalReal, signalImag, outReal, outImag);
+        for (NSInteger k = 0; k < n; k++) {
+            maxError = MAX(maxError, fabs(outReal[k] - referenceReal[k]) / scale);
+            maxError = MAX(maxError, fabs(outImag[k] - referenceImag[k]) / scale);
+        }
+        PIDFFTComplexInverse(plan, outReal, outImag, outReal, outImag);
+        for (NSInteger i = 0; i < n; i++) {
+            maxError = MAX(maxError, fabs(outReal[i] - signalReal[i]));
+            maxError = MAX(maxError, fabs(outImag[i] - signalImag[i]));
+        }
+
+        // 计时：实数正变换 + 逆变换
+        CFAbsoluteTime start = CFAbsoluteTimeGetCurrent();
+        for (NSInteger r = 0; r < iterations; r++) {
+            PIDFFTRealForward(plan, signalReal, outReal, outImag);
+            PIDFFTRealInverse(plan, outReal, outImag, roundTrip);
+        }
+        double perPairUs = (CFAbsoluteTimeGetCurrent() - start) * 1e6 / MAX(iterations, 1);
+        [timings appendFormat:@" %s=%.1fµs", PIDFFTBackendName(backends[b]), perPairUs];
+    }
+
+    result.maxAbsoluteError = maxError;
+    result.meanAbsoluteError = maxError;
+    result.passed = maxError <= MAX(_absoluteTolerance, 1e-9);
+    if (!result.passed) {
+        result.errorDetails = [NSString stringWithFormat:@"FFT后端与直接DFT不一致: 最大误差%.2e", maxError];
+    }
+
+    NSLog(@"🔍 FFT后端一致性(n=%ld): %@ (最大误差%.2e, 每对正/逆实数变换:%@)",
+          (long)n, result.passed ? @"通过" : @"失败", maxError, timings);
+
+    return result;
+}
+
+- (PIDVerificationResult *)verifyFFTReference:(NSDictionary *)referenceData {
+    PIDVerificationResult *result = [[PIDVerificationResult alloc] init];
+    result.timestamp = [NSDate date];
+    result.absoluteTolerance = _absoluteTolerance;
+
+    NSArray<NSNumber *> *input = referenceData[@"input"];
+    NSArray<NSNumber *> *expectedReal = referenceData[@"real"];
+    NSArray<NSNumber *> *expectedImag = referenceData[@"imag"];
+    NSInteger n = input.count;
+
+    if (n == 0 || expectedReal.count != n / 2 + 1 || expectedImag.count != expectedReal.count) {
+        result.passed = NO;
+        result.errorDetails = @"FFT参考数据格式错误: 需要input以及numpy.fft.rfft的real/imag（n/2+1个点）";
+        return result;
+    }
+
+    const PIDFFTPlan *plan = PIDFFTPlanForLength((size_t)n, PIDFFTBackendAutomatic);
+    if (!plan) {
+        result.passed = NO;
+        result.errorDetails = [NSString stringWithFormat:@"无法创建长度%ld的FFT计划", (long)n];
+        return result;
+    }
+
+    NSInteger binCount = n / 2 + 1;
+    NSMutableData *storage = [NSMutableData dataWithLength:sizeof(double) * (n + 2 * binCount)];
+    double *samples = storage.mutableBytes;
+    double *outReal = samples + n;
+    double *outImag = outReal + binCount;
+    for (NSInteger i = 0; i < n; i++) {
+        samples[i] = [input[i] doubleValue];
+    }
+    PIDFFTRealForward(plan, samples, outReal, outImag);
+
+    // 按频谱幅度归一化后比较（长信号的频谱量级随n增长）
+    double scale = 1.0;
+    for (NSInteger k = 0; k < binCount; k++) {
+        scale = MAX(scale, hypot([expectedReal[k] doubleValue], [expectedImag[k] doubleValue]));
+    }
+
+    double maxError = 0.0;
+    double sumError = 0.0;
+    for (NSInteger k = 0; k < binCount; k++) {
+        double error = MAX(fabs(outReal[k] - [expectedReal[k] doubleValue]),
+                           fabs(outImag[k] - [expectedImag[k] doubleValue])) / scale;
+        maxError = MAX(maxError, error);
+        sumError += error;
+    }
+
+    result.maxAbsoluteError = maxError;
+    result.meanAbsoluteError = sumError / binCount;
+    result.passed = maxError <= _absoluteTolerance;
+    if (!result.passed) {
+        result.errorDetails = [NSString stringWithFormat:@"rfft与numpy不一致(n=%ld, %s): 最大误差%.2e",
+                               (long)n, PIDFFTBackendName(PIDFFTPlanBackend(plan)), maxError];
+    }
+
+    NSLog(@"🔍 FFT参考对比(n=%ld, %s): %@ (最大误差%.2e)",
+          (long)n, PIDFFTBackendName(PIDFFTPlanBackend(plan)),
+          result.passed ? @"通过" : @"失败", maxError);
+
+    return result;
+}
+
+#pragma mark - 维纳反卷积内核一致性
+
+- (PIDVerificationResult *)verifyWienerKernelWithWindowCount:(NSInteger)windowCount
+                                                windowLength:(NSInteger)windowLength {
+    PIDVerificationResult *result = [[PIDVerificationResult alloc] init];
+    result.timestamp = [NSDate date];
+    result.absoluteTolerance = _absoluteTolerance;
+
+    NSInteger rows = MAX(windowCount, 1);
+    NSInteger len = MAX(windowLength, 16);
+    const double cutFreq = 150.0;
+
+    PIDWienerDeconvolution *wiener = [[PIDWienerDeconvolution alloc] init];
+    PIDFFTProcessor *processor = [[PIDFFTProcessor alloc] init];
+
+    // 输入为噪声，输出为输入经一阶低通后加少量噪声
+    NSMutableData *storage = [NSMutableData dataWithLength:sizeof(double) * 3 * rows * len];
+    double *input = storage.mutableBytes;
+    double *output = input + rows * len;
+    double *batched = output + rows * len;
+    for (NSInteger i = 0; i < rows; i++) {
+        double state = 0.0;
+        for (NSInteger j = 0; j < len; j++) {
+            double x = (double)arc4random_uniform(2000) / 1000.0 - 1.0;
+            state += 0.2 * (x - state);
+            input[i * len + j] = x;
+            output[i * len + j] = state + (double)arc4random_uniform(100) / 10000.0;
+        }
+    }
+
+    CFAbsoluteTime start = CFAbsoluteTimeGetCurrent();
+    BOOL ok = [wiener deconvolveInput:input output:output rowCount:rows columnCount:len
+                              cutFreq:cutFreq result:batched resultLength:len];
+    double batchedMs = (CFAbsoluteTimeGetCurrent() - start) * 1000.0;
+    if (!ok) {
+        result.passed = NO;
+        result.errorDetails = @"批量维纳内核参数无效";
+        return result;
+    }
+
+    // 参考实现：完整复数频谱逐步计算（与Python wiener_deconvolution的写法一一对应）
+    NSInteger padded = len % 1024 == 0 ? len : len + (1024 - len % 1024);
+    NSArray<NSNumber *> *freqs = [processor fftfreqWithLength:padded dt:wiener.dt];
+    NSArray<NSNumber *> *sn = [wiener calculateSignalToNoise:freqs cutFreq:cutFreq];
+    NSMutableArray<NSNumber *> *invSN = [NSMutableArray arrayWithCapacity:padded];
+    for (NSNumber *value in sn) {
+        [invSN addObject:@(1.0 / [value doubleValue])];
+    }
+
+    double maxError = 0.0;
+    double scale = 1e-12;
+    start = CFAbsoluteTimeGetCurrent();
+    for (NSInteger i = 0; i < rows; i++) {
+        @autoreleasepool {
+            NSMutableArray<NSNumber *> *inputRow = [NSMutableArray arrayWithCapacity:padded];
+            NSMutableArray<NSNumber *> *outputRow = [NSMutableArray arrayWithCapacity:padded];
+            for (NSInteger j = 0; j < padded; j++) {
+                [inputRow addObject:@(j < len ? input[i * len + j] : 0.0)];
+                [outputRow addObject:@(j < len ? output[i * len + j] : 0.0)];
+            }
+
+            NSDictionary *H = [processor fftWithReal:inputRow imag:nil length:padded];
+            NSDictionary *G = [processor fftWithReal:outputRow imag:nil length:padded];
+
+            // G·conj(H) / (|H|² + 1/sn)，双精度逐点计算
+            NSMutableArray<NSNumber *> *quotientReal = [NSMutableArray arrayWithCapacity:padded];
+            NSMutableArray<NSNumber *> *quotientImag = [NSMutableArray arrayWithCapacity:padded];
+            for (NSInteger k = 0; k < padded; k++) {
+                double hr = [H[@"real"][k] doubleValue];
+                double hi = [H[@"imag"][k] doubleValue];
+                double gr = [G[@"real"][k] doubleValue];
+                double gi = [G[@"imag"][k] doubleValue];
+                double denom = hr * hr + hi * hi + [invSN[k] doubleValue];
+                [quotientReal addObject:@((gr * hr + gi * hi) / denom)];
+                [quotientImag addObject:@((gi * hr - gr * hi) / denom)];
+            }
+
+            NSArray<NSNumber *> *reference = [processor ifftWithReal:quotientReal
+                                                                 imag:quotientImag
+                                                               length:padded][@"real"];
+
+            for (NSInteger j = 0; j < len; j++) {
+                double expected = [reference[j] doubleValue];
+                scale = MAX(scale, fabs(expected));
+                maxError = MAX(maxError, fabs(batched[i * len + j] - expected));
+            }
+        }
+    }
+    double referenceMs = (CFAbsoluteTimeGetCurrent() - start) * 1000.0;
+
+    maxError /= scale;
+    result.maxAbsoluteError = maxError;
+    result.meanAbsoluteError = maxError;
+    result.passed = maxError <= MAX(_absoluteTolerance, 1e-9);
+    if (!result.passed) {
+        result.errorDetails = [NSString stringWithFormat:@"批量维纳内核与参考实现不一致: 最大误差%.2e", maxError];
+    }
+
+    NSLog(@"🔍 维纳内核一致性(%ld×%ld): %@ (最大误差%.2e, 批量%.1fms / 参考%.1fms, 加速%.0f倍)",
+          (long)rows, (long)len, result.passed ? @"通过" : @"失败", maxError,
+          batchedMs, referenceMs, referenceMs / MAX(batchedMs, 1e-6));
+
+    return result;
+}
+
+#pragma mark - 响应直方图一致性
+
+- (PIDVerificationResult *)verifyResponseHistogramWithWindowCount:(NSInteger)windowCount
+                                                   responseLength:(NSInteger)responseLength {
+    PIDVerificationResult *result = [[PIDVerificationResult alloc] init];
+    result.timestamp = [NSDate date];
+    result.absoluteTolerance = _absoluteTolerance;
+
+    NSInteger rows = MAX(windowCount, 1);
+    NSInteger len = MAX(responseLength, 2);
+    const NSInteger vertBins = 1000;
+    const double vertMin = -1.5;
+    const double vertMax = 3.5;
+
+    // 模拟阶跃响应：一阶上升 + 随窗口变化的超调和噪声，少量点超出范围
+    NSMutableData *storage = [NSMutableData dataWithLength:sizeof(double) * rows * len];
+    double *responses = storage.mutableBytes;
+    for (NSInteger w = 0; w < rows; w++) {
+        double gain = 0.8 + (double)arc4random_uniform(400) / 1000.0;
+        double rate = 20.0 + (double)arc4random_uniform(400) / 10.0;
+        for (NSInteger i = 0; i < len; i++) {
+            double t = 0.5 * i / (len - 1);
+            double noise = (double)arc4random_uniform(2000) / 20000.0 - 0.05;
+            responses[w * len + i] = gain * (1.0 - exp(-rate * t)) + noise;
+        }
+        responses[w * len + len / 2] = 4.0;
+    }
+
+    // 直接散射 + 列卷积
+    CFAbsoluteTime start = CFAbsoluteTimeGetCurrent();
+    PIDResponseHistogram *histogram = [[PIDResponseHistogram alloc] initWithResponseLength:len
+                                                                                 vertRange:@[@(vertMin), @(vertMax)]
+                                                                                  vertBins:vertBins];
+    for (NSInteger w = 0; w < rows; w++) {
+        [histogram addWindowValues:responses + w * len weight:1.0];
+    }
+    NSArray<NSNumber *> *actual = [histogram weightedModeAverage];
+    double directMs = (CFAbsoluteTimeGetCurrent() - start) * 1000.0;
+
+    // 参考实现：展平为NSNumber数组 → buildHistogram2D(转置) → 逐点高斯卷积 → 平方加权平均
+    start = CFAbsoluteTimeGetCurrent();
+    NSMutableArray<NSNumber *> *times = [NSMutableArray arrayWithCapacity:rows * len];
+    NSMutableArray<NSNumber *> *values = [NSMutableArray arrayWithCapacity:rows * len];
+    NSMutableArray<NSNumber *> *weights = [NSMutableArray arrayWithCapacity:rows * len];
+    for (NSInteger w = 0; w < rows; w++) {
+        for (NSInteger i = 0; i < len; i++) {
+            [times addObject:@(0.5 * i / (len - 1))];
+            [values addObject:@(responses[w * len + i])];
+            [weights addObject:@1.0];
+        }
+    }
+    float *hist = [PIDTraceAnalyzer buildHistogram2D:times values:values weights:weights
+                                             timeMin:0.0 timeMax:0.5
+                                            valueMin:vertMin valueMax:vertMax
+                                       timeBinsCount:len vertBinsCount:vertBins];
+
+    const NSInteger radius = 28;
+    float kernel[2 * radius + 1];
+    double kernelSum = 0.0;
+    for (NSInteger dv = -radius; dv <= radius; dv++) {
+        kernel[dv + radius] = (float)exp(-(dv * dv) / (2.0 * 7.0 * 7.0));
+        kernelSum += kernel[dv + radius];
+    }
+    for (NSInteger i = 0; i < 2 * radius + 1; i++) {
+        kernel[i] /= (float)kernelSum;
+    }
+
+    NSMutableArray<NSNumber *> *expected = [NSMutableArray arrayWithCapacity:len];
+    float *column = (float *)malloc(vertBins * sizeof(float));
+    double baseValue = 0.0;
+    for (NSInteger t = 0; t < len; t++) {
+        float maxVal = 0.0f;
+        for (NSInteger v = 0; v < vertBins; v++) {
+            float sum = 0.0f;
+            for (NSInteger dv = -radius; dv <= radius; dv++) {
+                NSInteger src = v + dv;
+                if (src >= 0 && src < vertBins) {
+                    sum += hist[src * len + t] * kernel[dv + radius];
+                }
+            }
+            column[v] = sum;
+            maxVal = MAX(maxVal, sum);
+        }
+        double weightedSum = 0.0;
+        double weightSum = 0.0;
+        for (NSInteger v = 0; v < vertBins; v++) {
+            float histVal = maxVal > 1e-6f ? column[v] / maxVal : column[v];
+            double w = histVal * histVal;
+            weightedSum += (vertMin + (vertMax - vertMin) * v / (vertBins - 1)) * w;
+            weightSum += w;
+        }
+        double avgVal = weightSum > 1e-9 ? weightedSum / weightSum : 0.0;
+        if (t == 0) {
+            baseValue = avgVal;
+        }
+        [expected addObject:@(avgVal - baseValue)];
+    }
+    free(column);
+    free(hist);
+    double referenceMs = (CFAbsoluteTimeGetCurrent() - start) * 1000.0;
+
+    double maxError = 0.0;
+    for (NSInteger t = 0; t < len && t < (NSInteger)actual.count; t++) {
+        maxError = MAX(maxError, fabs([actual[t] doubleValue] - [expected[t] doubleValue]));
+    }
+    result.maxAbsoluteError = maxError;
+    result.meanAbsoluteError = maxError;
+    // 单精度卷积的累加顺序不同，允许1e-4的误差
+    result.passed = actual.count == (NSUInteger)len && maxError <= MAX(_absoluteTolerance, 1e-4);
+    if (!result.passed) {
+        result.errorDetails = [NSString stringWithFormat:@"响应直方图与参考实现不一致: 最大误差%.2e", maxError];
+    }
+
+    NSLog(@"🔍 响应直方图一致性(%ld×%ld): %@ (最大误差%.2e, 直接散射%.1fms / 参考%.1fms, 加速%.0f倍)",
+          (long)rows, (long)len, result.passed ? @"通过" : @"失败", maxError,
+          directMs, referenceMs, referenceMs / MAX(directMs, 1e-6));
+
+    return result;
+}
+
+/**
+ * 两组响应曲线的最大差异（曲线缺失情况不同时返回INFINITY）
+ */
+static double PIDCurvesMaxDifference(PIDResponseCurves *a, PIDResponseCurves *b) {
+    if (a.lowWindowCount != b.lowWindowCount || a.highWindowCount != b.highWindowCount ||
+        a.respLow.count != b.respLow.count || (a.respHigh == nil) != (b.respHigh == nil) ||
+        a.respHigh.count != b.respHigh.count) {
+        return INFINITY;
+    }
+    double maxError = 0.0;
+    for (NSUInteger i = 0; i < a.respLow.count; i++) {
+        maxError = MAX(maxError, fabs([a.respLow[i] doubleValue] - [b.respLow[i] doubleValue]));
+    }
+    for (NSUInteger i = 0; i < a.respHigh.count; i++) {
+        maxError = MAX(maxError, fabs([a.respHigh[i] doubleValue] - [b.respHigh[i] doubleValue]));
+    }
+    return maxError;
+}
+
+/**
+ * 结果中 [location, location+length) 的窗口（模拟流水线快照的新窗口）
+ */
+static PIDResponseResult *PIDResponseResultSlice(PIDResponseResult *result, NSRange range) {
+    PIDResponseResult *slice = [[PIDResponseResult alloc] init];
+    slice.stepResponse = [result.stepResponse subarrayWithRange:range];
+    slice.maxInput = [result.maxInput subarrayWithRange:range];
+    slice.maxThrottle = [result.maxThrottle subarrayWithRange:range];
+    slice.avgTime = [result.avgTime subarrayWithRange:range];
+    return slice;
+}
+
+- (PIDVerificationResult *)verifyIncrementalResponseWithWindowCount:(NSInteger)windowCount
+                                                     responseLength:(NSInteger)responseLength {
+    PIDVerificationResult *result = [[PIDVerificationResult alloc] init];
+    result.timestamp = [NSDate date];
+    result.absoluteTolerance = _absoluteTolerance;
+
+    NSInteger rows = MAX(windowCount, 20);
+    NSInteger len = MAX(responseLength, 2);
+
+    // 模拟结果：输入幅度覆盖低/高两组，部分窗口响应偏离较大（会被质量过滤）
+    NSMutableArray<NSArray<NSNumber *> *> *stepResponse = [NSMutableArray arrayWithCapacity:rows];
+    NSMutableArray<NSNumber *> *maxInput = [NSMutableArray arrayWithCapacity:rows];
+    NSMutableArray<NSNumber *> *maxThrottle = [NSMutableArray arrayWithCapacity:rows];
+    NSMutableArray<NSNumber *> *avgTime = [NSMutableArray arrayWithCapacity:rows];
+    for (NSInteger w = 0; w < rows; w++) {
+        double gain = arc4random_uniform(5) == 0 ? 2.0 : 0.9 + (double)arc4random_uniform(200) / 1000.0;
+        double rate = 20.0 + (double)arc4random_uniform(400) / 10.0;
+        NSMutableArray<NSNumber *> *window = [NSMutableArray arrayWithCapacity:len];
+        for (NSInteger i = 0; i < len; i++) {
+            double t = 0.5 * i / (len - 1);
+            [window addObject:@(gain * (1.0 - exp(-rate * t)))];
+        }
+        [stepResponse addObject:window];
+        [maxInput addObject:@((double)arc4random_uniform(1000))];
+        [maxThrottle addObject:@((double)arc4random_uniform(100))];
+        [avgTime addObject:@(w * 0.0625)];
+    }
+    PIDResponseResult *response = [[PIDResponseResult alloc] init];
+    response.stepResponse = stepResponse;
+    response.maxInput = maxInput;
+    response.maxThrottle = maxThrottle;
+    response.avgTime = avgTime;
+
+    PIDIncrementalResponseAnalysis *analysis = [[PIDIncrementalResponseAnalysis alloc] initWithResponseResult:response];
+    double maxError = PIDCurvesMaxDifference([analysis currentCurves],
+                                             [PIDTraceAnalyzer responseCurvesFromResult:response]);
+
+    // 依次调整条件，每一步与新建的分析比较
+    double endTime = rows * 0.0625 / 2.0;
+    NSArray<NSArray<NSNumber *> *> *steps = @[@[@0.3, @(-INFINITY), @(INFINITY), @(INFINITY)],
+                                              @[@0.3, @20.0, @80.0, @(INFINITY)],
+                                              @[@0.8, @20.0, @80.0, @(endTime)],
+                                              @[@0.5, @(-INFINITY), @(INFINITY), @(INFINITY)]];
+    NSInteger totalChanges = 0;
+    double incrementalMs = 0.0;
+    double rebuildMs = 0.0;
+    for (NSArray<NSNumber *> *step in steps) {
+        CFAbsoluteTime start = CFAbsoluteTimeGetCurrent();
+        analysis.qualityThreshold = [step[0] doubleValue];
+        analysis.minThrottle = [step[1] doubleValue];
+        analysis.maxThrottle = [step[2] doubleValue];
+        analysis.endTime = [step[3] doubleValue];
+        PIDResponseCurves *incremental = [analysis currentCurves];
+        incrementalMs += (CFAbsoluteTimeGetCurrent() - start) * 1000.0;
+        totalChanges += analysis.lastUpdateWindowChanges;
+
+        start = CFAbsoluteTimeGetCurrent();
+        PIDIncrementalResponseAnalysis *fresh = [[PIDIncrementalResponseAnalysis alloc] initWithResponseResult:response];
+        fresh.qualityThreshold = analysis.qualityThreshold;
+        fresh.minThrottle = analysis.minThrottle;
+        fresh.maxThrottle = analysis.maxThrottle;
+        fresh.endTime = analysis.endTime;
+        PIDResponseCurves *expected = [fresh currentCurves];
+        rebuildMs += (CFAbsoluteTimeGetCurrent() - start) * 1000.0;
+
+        maxError = MAX(maxError, PIDCurvesMaxDifference(incremental, expected));
+    }
+
+    // 追加窗口：先用前一半窗口（带油门范围）算一次曲线，再分两批追加其余窗口
+    NSInteger half = rows / 2;
+    NSInteger quarter = (rows - half) / 2;
+    PIDIncrementalResponseAnalysis *streamed =
+        [[PIDIncrementalResponseAnalysis alloc] initWithResponseResult:PIDResponseResultSlice(response, NSMakeRange(0, half))];
+    streamed.minThrottle = 20.0;
+    streamed.maxThrottle = 80.0;
+    [streamed currentCurves];
+    [streamed appendWindowsFromResult:PIDResponseResultSlice(response, NSMakeRange(half, quarter))];
+    [streamed currentCurves];
+    [streamed appendWindowsFromResult:PIDResponseResultSlice(response, NSMakeRange(half + quarter, rows - half - quarter))];
+    PIDIncrementalResponseAnalysis *whole = [[PIDIncrementalResponseAnalysis alloc] initWithResponseResult:response];
+    whole.minThrottle = 20.0;
+    whole.maxThrottle = 80.0;
+    double appendError = PIDCurvesMaxDifference([streamed currentCurves], [whole currentCurves]);
+    maxError = MAX(maxError, appendError);
+
+    result.maxAbsoluteError = maxError;
+    result.meanAbsoluteError = appendError;
+    // 直方图内容完全相同；曲线由维护的平滑列和得到，与单精度卷积的参考实现只差舍入
+    result.passed = maxError <= MAX(_absoluteTolerance, 1e-6);
+    if (!result.passed) {
+        result.errorDetails = [NSString stringWithFormat:@"增量响应分析与重新计算不一致: 最大误差%.2e", maxError];
+    }
+
+    NSLog(@"🔍 增量响应分析(%ld×%ld): %@ (最大误差%.2e, 增减%ld个窗口, 增量%.1fms / 重建%.1fms)",
+          (long)rows, (long)len, result.passed ? @"通过" : @"失败", maxError,
+          (long)totalChanges, incrementalMs, rebuildMs);
+
+    return result;
+}
+
+#pragma mark - 高斯平滑一致性
+
+/**
+ * scipy.ndimage.gaussian_filter1d 的逐点参考：截断半径 int(4σ+0.5) 的归一化核，按mode扩展边界
+ */
+static void PIDReferenceGaussian(const double *x, double *y, NSInteger n, double sigma, PIDGaussianBoundary boundary) {
+    NSInteger radius = (NSInteger)(4.0 * sigma + 0.5);
+    double kernelSum = 0.0;
+    for (NSInteger k = -radius; k <= radius; k++) {
+        kernelSum += exp(-0.5 * k * k / (sigma * sigma));
+    }
+    for (NSInteger i = 0; i < n; i++) {
+        double sum = 0.0;
+        for (NSInteger k = -radius; k <= radius; k++) {
+            NSInteger j = i + k;
+            if (boundary == PIDGaussianBoundaryReflect) {
+                // (c b a | a b c | c b a)，周期2n
+                j %= 2 * n;
+                if (j < 0) j += 2 * n;
+                if (j >= n) j = 2 * n - 1 - j;
+            } else if (j < 0 || j >= n) {
+                continue;
+            }
+            sum += exp(-0.5 * k * k / (sigma * sigma)) / kernelSum * x[j];
+        }
+        y[i] = sum;
+    }
+}
+
+- (PIDVerificationResult *)verifyGaussianFilterWithLength:(NSInteger)length
+                                                    sigma:(double)sigma {
+    PIDVerificationResult *result = [[PIDVerificationResult alloc] init];
+    result.timestamp = [NSDate date];
+    result.absoluteTolerance = _absoluteTolerance;
+
+    NSInteger n = MAX(length, 8);
+    double s = MAX(sigma, 0.5);
+    NSMutableData *storage = [NSMutableData dataWithLength:4 * n * sizeof(double)];
+    double *input = storage.mutableBytes;
+    double *expected = input + n;
+    double *direct = expected + n;
+    double *recursive = direct + n;
+
+    // 随机游走（带直流分量，边界处理的差异会直接体现在结果上）
+    double scale = 0.0;
+    for (NSInteger i = 0; i < n; i++) {
+        input[i] = (i > 0 ? input[i - 1] : 10.0) + ((double)arc4random_uniform(2001) - 1000.0) / 1000.0;
+        scale = MAX(scale, fabs(input[i]));
+    }
+
+    double directError = 0.0;
+    double recursiveError = 0.0;
+    double referenceMs = 0.0;
+    double directMs = 0.0;
+    double recursiveMs = 0.0;
+    PIDGaussianBoundary boundaries[2] = {PIDGaussianBoundaryConstant, PIDGaussianBoundaryReflect};
+    for (int b = 0; b < 2; b++) {
+        CFAbsoluteTime start = CFAbsoluteTimeGetCurrent();
+        PIDReferenceGaussian(input, expected, n, s, boundaries[b]);
+        referenceMs += (CFAbsoluteTimeGetCurrent() - start) * 1000.0;
+
+        start = CFAbsoluteTimeGetCurrent();
+        PIDGaussianFilter1D(input, direct, (size_t)n, s, boundaries[b], PIDGaussianMethodDirect);
+        directMs += (CFAbsoluteTimeGetCurrent() - start) * 1000.0;
+
+        start = CFAbsoluteTimeGetCurrent();
+        PIDGaussianFilter1D(input, recursive, (size_t)n, s, boundaries[b], PIDGaussianMethodRecursive);
+        recursiveMs += (CFAbsoluteTimeGetCurrent() - start) * 1000.0;
+
+        for (NSInteger i = 0; i < n; i++) {
+            directError = MAX(directError, fabs(direct[i] - expected[i]) / scale);
+            recursiveError = MAX(recursiveError, fabs(recursive[i] - expected[i]) / scale);
+        }
+    }
+
+    // 按轴批量：把数据排成 rows × 3 的三列（列间取不同偏移），axis = 0 与逐列平滑一致
+    // （单列走vDSP_convD、多列走向量乘加，累加顺序不同，只允许舍入差异）
+    NSInteger columns = 3;
+    NSMutableData *matrixStorage = [NSMutableData dataWithLength:2 * n * columns * sizeof(double)];
+    double *matrix = matrixStorage.mutableBytes;
+    double *smoothed = matrix + n * columns;
+    for (NSInteger i = 0; i < n; i++) {
+        for (NSInteger c = 0; c < columns; c++) {
+            matrix[i * columns + c] = input[(i + c * 7) % n];
+        }
+    }
+    PIDGaussianFilterAxis(matrix, smoothed, (size_t)n, (size_t)columns, 0, s,
+                          PIDGaussianBoundaryReflect, PIDGaussianMethodAutomatic);
+    double axisError = 0.0;
+    for (NSInteger c = 0; c < columns; c++) {
+        for (NSInteger i = 0; i < n; i++) {
+            input[i] = matrix[i * columns + c];
+        }
+        PIDGaussianFilter1D(input, direct, (size_t)n, s, PIDGaussianBoundaryReflect, PIDGaussianMethodAutomatic);
+        for (NSInteger i = 0; i < n; i++) {
+            axisError = MAX(axisError, fabs(direct[i] - smoothed[i * columns + c]));
+        }
+    }
+
+    result.maxAbsoluteError = directError;
+    result.meanAbsoluteError = recursiveError;
+    result.passed = directError <= MAX(_absoluteTolerance, 1e-12) && recursiveError <= 2e-3 &&
+                    axisError <= 1e-12 * scale;
+    if (!result.passed) {
+        result.errorDetails = [NSString stringWithFormat:@"高斯平滑不一致: 直接卷积%.2e, 递归%.2e, 按轴%.2e",
+                               directError, recursiveError, axisError];
+    }
+
+    NSLog(@"🔍 高斯平滑(n=%ld, σ=%.1f): %@ (直接卷积误差%.2e, 递归误差%.2e, 参考%.2fms / 直接%.2fms / 递归%.2fms)",
+          (long)n, s, result.passed ? @"通过" : @"失败", directError, recursiveError,
+          referenceMs, directMs, recursiveMs);
+
+    return result;
+}
+
+- (PIDVerificationResult *)verifyGaussianReference:(NSDictionary *)referenceData {
+    PIDVerificationResult *result = [[PIDVerificationResult alloc] init];
+    result.timestamp = [NSDate date];
+    result.absoluteTolerance = _absoluteTolerance;
+
+    NSArray<NSNumber *> *input = referenceData[@"input"];
+    NSDictionary<NSString *, NSArray<NSNumber *> *> *outputs = referenceData[@"outputs"];
+    double sigma = [referenceData[@"sigma"] doubleValue];
+    NSInteger n = input.count;
+
+    if (n == 0 || !(sigma > 0.0) || ![outputs isKindOfClass:[NSDictionary class]] || outputs.count == 0) {
+        result.passed = NO;
+        result.errorDetails = @"高斯参考数据格式错误: 需要sigma、input以及各mode的gaussian_filter1d输出";
+        return result;
+    }
+
+    NSDictionary<NSString *, NSNumber *> *modes = @{
+        @"constant": @(PIDGaussianBoundaryConstant),
+        @"reflect": @(PIDGaussianBoundaryReflect),
+        @"nearest": @(PIDGaussianBoundaryNearest),
+        @"mirror": @(PIDGaussianBoundaryMirror),
+    };
+
+    NSMutableData *storage = [NSMutableData dataWithLength:3 * n * sizeof(double)];
+    double *samples = storage.mutableBytes;
+    double *direct = samples + n;
+    double *recursive = direct + n;
+    double scale = 0.0;
+    for (NSInteger i = 0; i < n; i++) {
+        samples[i] = [input[i] doubleValue];
+        scale = MAX(scale, fabs(samples[i]));
+    }
+    scale = MAX(scale, 1.0);
+
+    NSMutableArray<NSString *> *failures = [NSMutableArray array];
+    double directError = 0.0;
+    double recursiveError = 0.0;
+    double sumError = 0.0;
+    NSInteger comparisons = 0;
+    for (NSString *mode in [outputs.allKeys sortedArrayUsingSelector:@selector(compare:)]) {
+        NSArray<NSNumber *> *expected = outputs[mode];
+        NSNumber *boundary = modes[mode];
+        if (!boundary || expected.count != n) {
+            [failures addObject:[NSString stringWithFormat:@"mode %@ 无法对比", mode]];
+            continue;
+        }
+
+        BOOL ok = PIDGaussianFilter1D(samples, direct, (size_t)n, sigma, boundary.intValue, PIDGaussianMethodDirect) &&
+                  PIDGaussianFilter1D(samples, recursive, (size_t)n, sigma, boundary.intValue,
+                                      PIDGaussianMethodRecursive);
+        if (!ok) {
+            [failures addObject:[NSString stringWithFormat:@"mode %@ 平滑失败", mode]];
+            continue;
+        }
+
+        double modeDirect = 0.0;
+        double modeRecursive = 0.0;
+        for (NSInteger i = 0; i < n; i++) {
+            double value = [expected[i] doubleValue];
+            double error = fabs(direct[i] - value) / scale;
+            modeDirect = MAX(modeDirect, error);
+            modeRecursive = MAX(modeRecursive, fabs(recursive[i] - value) / scale);
+            sumError += error;
+        }
+        comparisons += n;
+        directError = MAX(directError, modeDirect);
+        recursiveError = MAX(recursiveError, modeRecursive);
+
+        // 直接卷积与scipy逐点一致；递归滤波与单元测试相同，允许2e-3的峰值误差
+        if (modeDirect > MAX(_absoluteTolerance, 1e-12) || modeRecursive > 2e-3) {
+            [failures addObject:[NSString stringWithFormat:@"mode %@: 直接卷积%.2e, 递归%.2e",
+                                 mode, modeDirect, modeRecursive]];
+        }
+    }
+
+    result.maxAbsoluteError = directError;
+    result.meanAbsoluteError = comparisons > 0 ? sumError / comparisons : 0.0;
+    result.passed = failures.count == 0;
+    if (!result.passed) {
+        result.errorDetails = [NSString stringWithFormat:@"gaussian_filter1d与scipy不一致(σ=%g):\n%@",
+                               sigma, [failures componentsJoinedByString:@"\n"]];
+    }
+
+    NSLog(@"🔍 高斯参考对比(n=%ld, σ=%g): %@ (直接卷积误差%.2e, 递归误差%.2e)",
+          (long)n, sigma, result.passed ? @"通过" : @"失败", directError, recursiveError);
+
+    return result;
+}
+
+#pragma mark - 精度策略一致性
+
+- (PIDVerificationResult *)verifyPrecisionPolicyWithWindowCount:(NSInteger)windowCount
+                                                   windowLength:(NSInteger)windowLength {
+    PIDVerificationResult *result = [[PIDVerificationResult alloc] init];
+    result.timestamp = [NSDate date];
+    result.absoluteTolerance = _absoluteTolerance;
+
+    NSInteger rows = MAX(windowCount, 1);
+    NSInteger len = MAX(windowLength, 16);
+    NSInteger step = MAX(len / 16, 1);
+    NSInteger rlen = len / 2;
+    NSInteger columnLength = (rows - 1) * step + len;
+
+    // 模拟堆叠数据：输入为带噪声的机动，陀螺仪为一阶滞后跟随
+    NSMutableData *columns = [NSMutableData dataWithLength:(2 * columnLength + len) * sizeof(double)];
+    double *inputColumn = columns.mutableBytes;
+    double *gyroColumn = inputColumn + columnLength;
+    double *window = gyroColumn + columnLength;
+    double state = 0.0;
+    for (NSInteger i = 0; i < columnLength; i++) {
+        inputColumn[i] = 200.0 * sin(i * 0.01) + ((double)arc4random_uniform(1001) - 500.0) / 10.0;
+        state += 0.05 * (inputColumn[i] - state);
+        gyroColumn[i] = state + ((double)arc4random_uniform(101) - 50.0) / 10.0;
+    }
+    for (NSInteger i = 0; i < len; i++) {
+        window[i] = 0.5 - 0.5 * cos(2.0 * M_PI * i / (len - 1));
+    }
+
+    PIDWienerDeconvolution *wiener = [[PIDWienerDeconvolution alloc] init];
+    NSInteger paddedLength = [wiener paddedLengthForLength:len];
+    NSData *invSN = [wiener inverseSignalToNoiseForLength:paddedLength cutFreq:25.0];
+    const double *invSNLow = (const double *)invSN.bytes;
+    PIDStepResponseChain chain = {
+        .inputColumn = inputColumn,
+        .gyroColumn = gyroColumn,
+        .windowCount = (size_t)rows,
+        .windowLength = (size_t)len,
+        .step = (size_t)step,
+        .window = window,
+        .invSNLow = invSNLow,
+        .invSNHigh = invSNLow + paddedLength / 2 + 1,
+        .paddedLength = (size_t)paddedLength,
+        .resultLength = (size_t)rlen,
+    };
+
+    NSMutableData *outputs = [NSMutableData dataWithLength:(2 * rows * rlen + 2 * rows * len) * sizeof(double)];
+    double *reference = outputs.mutableBytes;
+    double *wide = reference + rows * rlen;
+    double *windowedInput = wide + rows * rlen;
+    double *windowedGyro = windowedInput + rows * len;
+    NSMutableData *singleStorage = [NSMutableData dataWithLength:rows * rlen * sizeof(float)];
+    float *single = singleStorage.mutableBytes;
+
+    // 参考：加窗矩阵 → 批量维纳反卷积 → 逐行累积和
+    CFAbsoluteTime start = CFAbsoluteTimeGetCurrent();
+    for (NSInteger w = 0; w < rows; w++) {
+        for (NSInteger i = 0; i < len; i++) {
+            windowedInput[w * len + i] = inputColumn[w * step + i] * window[i];
+            windowedGyro[w * len + i] = gyroColumn[w * step + i] * window[i];
+        }
+    }
+    BOOL referenceOK = [wiener deconvolveInput:windowedInput output:windowedGyro rowCount:rows columnCount:len
+                                       cutFreq:25.0 result:reference resultLength:rlen];
+    for (NSInteger w = 0; w < rows; w++) {
+        PIDCumulativeSumD(reference + w * rlen, (size_t)rlen);
+    }
+    double referenceMs = (CFAbsoluteTimeGetCurrent() - start) * 1000.0;
+
+    start = CFAbsoluteTimeGetCurrent();
+    BOOL doubleOK = PIDStepResponseChainRunD(&chain, wide);
+    double doubleMs = (CFAbsoluteTimeGetCurrent() - start) * 1000.0;
+
+    start = CFAbsoluteTimeGetCurrent();
+    BOOL singleOK = PIDStepResponseChainRunF(&chain, single);
+    double singleMs = (CFAbsoluteTimeGetCurrent() - start) * 1000.0;
+
+    // 分析器的路径：频谱缓存按精度计算窗口频谱（PIDWindowSpectraRun），再由缓存频谱做维纳/逆FFT/累积和
+    NSInteger binCount = paddedLength / 2 + 1;
+    NSMutableData *indexData = [NSMutableData dataWithLength:rows * sizeof(size_t)];
+    size_t *indices = indexData.mutableBytes;
+    for (NSInteger w = 0; w < rows; w++) {
+        indices[w] = (size_t)w;
+    }
+    PIDWindowSpectraBatch inputBatch = {
+        .column = inputColumn,
+        .step = (size_t)step,
+        .windowLength = (size_t)len,
+        .window = window,
+        .paddedLength = (size_t)paddedLength,
+        .windows = indices,
+        .count = (size_t)rows,
+    };
+    PIDWindowSpectraBatch gyroBatch = inputBatch;
+    gyroBatch.column = gyroColumn;
+
+    NSMutableData *spectraD = [NSMutableData dataWithLength:(4 * rows * binCount + rows * rlen) * sizeof(double)];
+    double *spectrumD = spectraD.mutableBytes;
+    double *cachedWide = spectrumD + 4 * rows * binCount;
+    NSMutableData *spectraF = [NSMutableData dataWithLength:(4 * rows * binCount + rows * rlen) * sizeof(float)];
+    float *spectrumF = spectraF.mutableBytes;
+    float *cachedSingle = spectrumF + 4 * rows * binCount;
+    size_t plane = (size_t)(rows * binCount);
+
+    BOOL cachedDoubleOK = PIDWindowSpectraRunD(&inputBatch, spectrumD, spectrumD + plane) &&
+                          PIDWindowSpectraRunD(&gyroBatch, spectrumD + 2 * plane, spectrumD + 3 * plane) &&
+                          PIDStepResponseFromSpectraD(spectrumD, spectrumD + plane, spectrumD + 2 * plane,
+                                                      spectrumD + 3 * plane, (size_t)rows, (size_t)paddedLength,
+                                                      chain.invSNLow, chain.invSNHigh, (size_t)rlen, NULL, NULL,
+                                                      cachedWide);
+    start = CFAbsoluteTimeGetCurrent();
+    BOOL cachedSingleOK = PIDWindowSpectraRunF(&inputBatch, spectrumF, spectrumF + plane) &&
+                          PIDWindowSpectraRunF(&gyroBatch, spectrumF + 2 * plane, spectrumF + 3 * plane) &&
+                          PIDStepResponseFromSpectraF(spectrumF, spectrumF + plane, spectrumF + 2 * plane,
+                                                      spectrumF + 3 * plane, (size_t)rows, (size_t)paddedLength,
+                                                      chain.invSNLow, chain.invSNHigh, (size_t)rlen, NULL, NULL,
+                                                      cachedSingle);
+    double cachedSingleMs = (CFAbsoluteTimeGetCurrent() - start) * 1000.0;
+
+    double scale = 0.0;
+    double doubleError = 0.0;
+    double singleError = 0.0;
+    for (NSInteger i = 0; i < rows * rlen; i++) {
+        scale = MAX(scale, fabs(wide[i]));
+        doubleError = MAX(doubleError, MAX(fabs(wide[i] - reference[i]), fabs(cachedWide[i] - reference[i])));
+        singleError = MAX(singleError, MAX(fabs((double)single[i] - wide[i]), fabs((double)cachedSingle[i] - wide[i])));
+    }
+    singleError /= MAX(scale, 1e-12);
+
+    result.maxAbsoluteError = doubleError;
+    result.meanAbsoluteError = singleError;
+    result.passed = referenceOK && doubleOK && singleOK && cachedDoubleOK && cachedSingleOK &&
+                    doubleError == 0.0 && singleError <= PIDRealParityTolerance;
+    if (!result.passed) {
+        result.errorDetails = [NSString stringWithFormat:@"精度策略不一致: float64与参考%.2e, float32相对误差%.2e",
+                               doubleError, singleError];
+    }
+
+    NSLog(@"🔍 精度策略(%ld窗口×%ld点, 默认%@): %@ (float64与参考%.2e, float32相对误差%.2e, 参考%.1fms / float64 %.1fms / float32 %.1fms / float32缓存路径 %.1fms)",
+          (long)rows, (long)len, PIDDSPPrecisionDefault == PIDDSPPrecisionFloat32 ? @"float32" : @"float64",
+          result.passed ? @"通过" : @"失败", doubleError, singleError, referenceMs, doubleMs, singleMs, cachedSingleMs);
+
+    return result;
+}
+
+#pragma mark - 频谱累加器一致性
+
+/**
+ * 参考分箱：在numpy.linspace形式的边界（low + b·width）中线性查找，
+ * 对应histogramdd的searchsorted(side='right')，最后一箱包含右端点，超范围返回-1
+ */
+static NSInteger PIDReferenceHistogramBin(double value, double low, double high, NSInteger bins) {
+    if (!(value >= low && value <= high)) {
+        return -1;
+    }
+    double width = (high - low) / bins;
+    for (NSInteger b = bins - 1; b >= 0; b--) {
+        if (value >= low + b * width) {
+            return b;
+        }
+    }
+    return 0;
+}
+
+- (PIDVerificationResult *)verifySpectrumAccumulatorWithWindowCount:(NSInteger)windowCount
+                                                     frequencyCount:(NSInteger)frequencyCount {
+    PIDVerificationResult *result = [[PIDVerificationResult alloc] init];
+    result.timestamp = [NSDate date];
+    result.absoluteTolerance = _absoluteTolerance;
+
+    NSInteger rows = MAX(windowCount, 2);
+    NSInteger freqCount = MAX(frequencyCount, 8);
+    NSInteger throttleBins = 101;
+    NSInteger freqBins = freqCount / 4;
+
+    // 模拟频谱实部（有正有负）与窗口油门（含NaN、负值、超过100与两端点）
+    NSMutableArray<NSNumber *> *frequencies = [NSMutableArray arrayWithCapacity:freqCount];
+    for (NSInteger k = 0; k < freqCount; k++) {
+        [frequencies addObject:@(k * 4000.0 / freqCount)];
+    }
+    NSMutableData *storage = [NSMutableData dataWithLength:(rows * freqCount + rows) * sizeof(double)];
+    double *spectra = storage.mutableBytes;
+    double *throttle = spectra + rows * freqCount;
+    for (NSInteger w = 0; w < rows; w++) {
+        for (NSInteger k = 0; k < freqCount; k++) {
+            spectra[w * freqCount + k] = ((double)arc4random_uniform(20001) - 10000.0) / (10.0 + k);
+        }
+        switch (w % 23) {
+            case 0: throttle[w] = NAN; break;
+            case 1: throttle[w] = -3.0; break;
+            case 2: throttle[w] = 120.0; break;
+            case 3: throttle[w] = 100.0; break;
+            case 4: throttle[w] = 0.0; break;
+            default: throttle[w] = (double)arc4random_uniform(100001) / 1000.0; break;
+        }
+    }
+
+    // 参考：逐窗口矩阵取平均 + 逐点查找分箱的二维直方图
+    CFAbsoluteTime start = CFAbsoluteTimeGetCurrent();
+    NSMutableData *referenceStorage = [NSMutableData dataWithLength:(freqCount + throttleBins * freqBins + throttleBins) * sizeof(double)];
+    double *referenceAverage = referenceStorage.mutableBytes;
+    double *referenceGrid = referenceAverage + freqCount;
+    double *referenceCounts = referenceGrid + throttleBins * freqBins;
+    double freqLow = [frequencies.firstObject doubleValue];
+    double freqHigh = [frequencies.lastObject doubleValue];
+    for (NSInteger w = 0; w < rows; w++) {
+        NSInteger t = PIDReferenceHistogramBin(throttle[w], 0.0, 100.0, throttleBins);
+        if (t >= 0) {
+            referenceCounts[t] += 1.0;
+        }
+        for (NSInteger k = 0; k < freqCount; k++) {
+            double magnitude = fabs(spectra[w * freqCount + k]);
+            referenceAverage[k] += magnitude / rows;
+            if (t >= 0) {
+                NSInteger f = PIDReferenceHistogramBin([frequencies[k] doubleValue], freqLow, freqHigh, freqBins);
+                referenceGrid[t * freqBins + f] += magnitude;
+            }
+        }
+    }
+    for (NSInteger t = 0; t < throttleBins; t++) {
+        for (NSInteger f = 0; f < freqBins; f++) {
+            referenceGrid[t * freqBins + f] /= referenceCounts[t] + 1e-9;
+        }
+    }
+    double referenceMs = (CFAbsoluteTimeGetCurrent() - start) * 1000.0;
+
+    // 流式累加：一次累加全部窗口 / 两半分别累加后合并
+    start = CFAbsoluteTimeGetCurrent();
+    PIDSpectrumAccumulator *accumulator = [[PIDSpectrumAccumulator alloc] initWithFrequencies:frequencies];
+    for (NSInteger w = 0; w < rows; w++) {
+        [accumulator addWindowSpectrum:spectra + w * freqCount throttle:throttle[w]];
+    }
+    NSArray<NSNumber *> *average = accumulator.averageSpectrum;
+    NSArray<NSArray<NSNumber *> *> *heatmap = accumulator.throttleHeatmap;
+    double streamMs = (CFAbsoluteTimeGetCurrent() - start) * 1000.0;
+
+    PIDSpectrumAccumulator *merged = [[PIDSpectrumAccumulator alloc] initWithFrequencies:frequencies];
+    PIDSpectrumAccumulator *secondHalf = [[PIDSpectrumAccumulator alloc] initWithFrequencies:frequencies];
+    for (NSInteger w = 0; w < rows; w++) {
+        [(w < rows / 2 ? merged : secondHalf) addWindowSpectrum:spectra + w * freqCount throttle:throttle[w]];
+    }
+    BOOL mergeOK = [merged addAccumulator:secondHalf] && merged.windowCount == rows;
+    NSArray<NSArray<NSNumber *> *> *mergedHeatmap = merged.throttleHeatmap;
+
+    double scale = 0.0;
+    double maxError = 0.0;
+    double mergeError = 0.0;
+    BOOL shapeOK = average.count == (NSUInteger)freqCount && heatmap.count == (NSUInteger)throttleBins &&
+                   heatmap.firstObject.count == (NSUInteger)freqBins && accumulator.frequencyBins == freqBins;
+    if (shapeOK) {
+        for (NSInteger k = 0; k < freqCount; k++) {
+            scale = MAX(scale, referenceAverage[k]);
+            maxError = MAX(maxError, fabs([average[k] doubleValue] - referenceAverage[k]));
+        }
+        for (NSInteger t = 0; t < throttleBins; t++) {
+            for (NSInteger f = 0; f < freqBins; f++) {
+                double expected = referenceGrid[t * freqBins + f];
+                scale = MAX(scale, expected);
+                maxError = MAX(maxError, fabs([heatmap[t][f] doubleValue] - expected));
+                mergeError = MAX(mergeError, fabs([mergedHeatmap[t][f] doubleValue] - [heatmap[t][f] doubleValue]));
+            }
+        }
+    }
+    maxError /= MAX(scale, 1e-12);
+    mergeError /= MAX(scale, 1e-12);
+
+    result.maxAbsoluteError = maxError;
+    result.meanAbsoluteError = mergeError;
+    result.passed = shapeOK && mergeOK && maxError <= 1e-12 && mergeError <= 1e-12;
+    if (!result.passed) {
+        result.errorDetails = [NSString stringWithFormat:@"频谱累加器不一致: 形状%@, 与参考%.2e, 合并%.2e",
+                               shapeOK ? @"正确" : @"错误", maxError, mergeError];
+    }
+
+    NSLog(@"🔍 频谱累加器(%ld窗口×%ld频率点): %@ (与参考%.2e, 合并%.2e, 参考%.1fms / 流式%.1fms, 累加器%.1fKB / 装箱矩阵约%.1fMB)",
+          (long)rows, (long)freqCount, result.passed ? @"通过" : @"失败", maxError, mergeError,
+          referenceMs, streamMs, [PIDSpectrumAccumulator bytesForFrequencyCount:freqCount] / 1024.0,
+          rows * freqCount * 16.0 / 1048576.0);
+
+    return result;
+}
+
+#pragma mark - 协作式取消
+
+// 取消到返回的延迟上限（每个窗口检查一次，远小于此值）
+static const double kCancellationLatencyLimitMs = 50.0;
+
+- (PIDVerificationResult *)verifyCancellationWithSampleCount:(NSInteger)sampleCount {
+    PIDVerificationResult *result = [[PIDVerificationResult alloc] init];
+    result.timestamp = [NSDate date];
+    result.absoluteTolerance = _absoluteTolerance;
+
+    // 合成单轴日志（油门恒定1500）
+    PIDCSVData *data = PIDSyntheticFlightLog(MAX(sampleCount, 16000), 1, 1500.0, 1500.0);
+
+    PIDStackData *stacks = [PIDStackData stackFromData:data axisIndex:0 windowSize:8000 overlap:0.9375 pGain:45.0];
+    PIDTraceAnalyzer *analyzer = [[PIDTraceAnalyzer alloc] initWithSampleRate:8000.0 cutFreq:25.0];
+
+    // 未取消：完整结果与参考耗时
+    analyzer.cancellationToken = [[PIDCancellationToken alloc] init];
+    CFAbsoluteTime start = CFAbsoluteTimeGetCurrent();
+    PIDResponseResult *full = [analyzer stackResponseWithSpectralCache:[[PIDSpectralCache alloc] initWithStackData:stacks]];
+    double fullMs = (CFAbsoluteTimeGetCurrent() - start) * 1000.0;
+    BOOL fullOK = stacks.windowCount > 0 && full.stepResponse.count == (NSUInteger)stacks.windowCount;
+
+    // 预先取消：不做任何窗口计算
+    PIDCancellationToken *cancelled = [[PIDCancellationToken alloc] init];
+    [cancelled cancel];
+    analyzer.cancellationToken = cancelled;
+    start = CFAbsoluteTimeGetCurrent();
+    PIDResponseResult *early = [analyzer stackResponseWithSpectralCache:[[PIDSpectralCache alloc] initWithStackData:stacks]];
+    double earlyMs = (CFAbsoluteTimeGetCurrent() - start) * 1000.0;
+    BOOL earlyOK = early.stepResponse.count == 0;
+
+    // 进行中取消：约在完整耗时的三分之一处从另一线程取消
+    PIDCancellationToken *token = [[PIDCancellationToken alloc] init];
+    analyzer.cancellationToken = token;
+    __block CFAbsoluteTime cancelTime = 0;
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(fullMs / 3.0 * NSEC_PER_MSEC)),
+                   dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^{
+        cancelTime = CFAbsoluteTimeGetCurrent();
+        [token cancel];
+    });
+    PIDResponseResult *midway = [analyzer stackResponseWithSpectralCache:[[PIDSpectralCache alloc] initWithStackData:stacks]];
+    CFAbsoluteTime returnTime = CFAbsoluteTimeGetCurrent();
+    analyzer.cancellationToken = nil;
+
+    // 取消发生在分析结束之后（机器繁忙时可能出现）则只检查结果完整
+    BOOL cancelledMidway = cancelTime > 0 && cancelTime <= returnTime;
+    double latencyMs = cancelledMidway ? (returnTime - cancelTime) * 1000.0 : 0.0;
+    BOOL midwayOK = cancelledMidway
+        ? midway.stepResponse.count == 0 && latencyMs <= kCancellationLatencyLimitMs
+        : midway.stepResponse.count == (NSUInteger)stacks.windowCount;
+
+    result.maxAbsoluteError = latencyMs;
+    result.meanAbsoluteError = earlyMs;
+    result.passed = fullOK && earlyOK && midwayOK;
+    if (!result.passed) {
+        result.errorDetails = [NSString stringWithFormat:@"取消检查失败: 完整%@, 预先取消%@, 中途取消%@ (延迟%.1fms)",
+                               fullOK ? @"正确" : @"错误", earlyOK ? @"正确" : @"错误",
+                               midwayOK ? @"正确" : @"错误", latencyMs];
+    }
+
+    NSLog(@"🔍 协作式取消(%ld窗口): %@ (完整%.1fms, 预先取消%.2fms, 中途取消延迟%.2fms%@)",
+          (long)stacks.windowCount, result.passed ? @"通过" : @"失败", fullMs, earlyMs, latencyMs,
+          cancelledMidway ? @"" : @", 取消晚于结束");
+
+    return result;
+}
+
+#pragma mark - 暂存区分配
+
+// 预热后重复分析的次数（GCD偶尔换用新线程会创建新暂存区，取最少的一次）
+static const NSInteger kScratchSteadyPasses = 3;
+
+- (PIDVerificationResult *)verifyScratchArenaWithSampleCount:(NSInteger)sampleCount {
+    PIDVerificationResult *result = [[PIDVerificationResult alloc] init];
+    result.timestamp = [NSDate date];
+    result.absoluteTolerance = 0;
+
+    // 合成单轴日志（油门从1000线性升到2000）
+    PIDCSVData *data = PIDSyntheticFlightLog(MAX(sampleCount, 16000), 1, 1000.0, 2000.0);
+
+    PIDStackData *stacks = [PIDStackData stackFromData:data axisIndex:0 windowSize:8000 overlap:0.9375 pGain:45.0];
+    PIDTraceAnalyzer *analyzer = [[PIDTraceAnalyzer alloc] initWithSampleRate:8000.0 cutFreq:25.0];
+
+    // 预热：创建各线程暂存区并扩大到窗口所需大小
+    PIDAllocationCounters before = PIDAllocationCountersSnapshot();
+    PIDResponseResult *warm = [analyzer stackResponseWithSpectralCache:[[PIDSpectralCache alloc] initWithStackData:stacks]];
+    PIDAllocationCounters warmDelta = PIDAllocationCountersDelta(PIDAllocationCountersSnapshot(), before);
+
+    // 稳态：同样的用量不应再向系统申请内存
+    uint64_t steadyHeap = UINT64_MAX;
+    uint64_t steadyRequests = 0;
+    BOOL countsOK = warm.stepResponse.count == (NSUInteger)stacks.windowCount;
+    for (NSInteger pass = 0; pass < kScratchSteadyPasses; pass++) {
+        before = PIDAllocationCountersSnapshot();
+        PIDResponseResult *steady = [analyzer stackResponseWithSpectralCache:[[PIDSpectralCache alloc] initWithStackData:stacks]];
+        PIDAllocationCounters delta = PIDAllocationCountersDelta(PIDAllocationCountersSnapshot(), before);
+        steadyHeap = MIN(steadyHeap, delta.heapAllocations);
+        steadyRequests = delta.scratchRequests;
+        countsOK = countsOK && steady.stepResponse.count == warm.stepResponse.count;
+    }
+
+    double requestsPerWindow = stacks.windowCount > 0 ? (double)steadyRequests / stacks.windowCount : 0.0;
+    result.maxAbsoluteError = (double)steadyHeap;
+    result.meanAbsoluteError = requestsPerWindow;
+    result.passed = stacks.windowCount > 0 && countsOK && steadyRequests > 0 && steadyHeap == 0;
+    if (!result.passed) {
+        result.errorDetails = [NSString stringWithFormat:@"稳态仍有%llu次系统分配（暂存区分配%llu次，结果%@）",
+                               (unsigned long long)steadyHeap, (unsigned long long)steadyRequests,
+                               countsOK ? @"完整" : @"不完整"];
+    }
+
+    NSLog(@"🔍 暂存区分配(%ld窗口): %@ (预热: 暂存%llu次/系统%llu次 %.1fKB, 稳态: 暂存%llu次/系统%llu次, 每窗口%.1f次)",
+          (long)stacks.windowCount, result.passed ? @"通过" : @"失败",
+          (unsigned long long)warmDelta.scratchRequests, (unsigned long long)warmDelta.heapAllocations,
+          warmDelta.heapBytes / 1024.0, (unsigned long long)steadyRequests,
+          (unsigned long long)steadyHeap, requestsPerWindow);
+
+    return result;
+}
+
+#pragma mark - 平均互谱估计
+
+// 稳态段（0.2–0.5s，即响应的后60%）两种方法的最大偏差上限
+static const double kCrossSpectrumSteadyLimit = 0.1;
+static const double kCrossSpectrumSteadyStart = 0.4;
+
+/**
+ * 两条响应曲线的最大偏差：全程 / 稳态段
+ */
+static void PIDCurveDeviation(NSArray<NSNumber *> *a, NSArray<NSNumber *> *b, double *overall, double *steady) {
+    NSInteger count = MIN(a.count, b.count);
+    NSInteger steadyStart = (NSInteger)(count * kCrossSpectrumSteadyStart);
+    for (NSInteger i = 0; i < count; i++) {
+        double diff = fabs([a[i] doubleValue] - [b[i] doubleValue]);
+        *overall = MAX(*overall, diff);
+        if (i >= steadyStart) {
+            *steady = MAX(*steady, diff);
+        }
+    }
+}
+
+- (PIDVerificationResult *)verifyCrossSpectrumAgreementWithCSV:(NSString *)csvFilePath {
+    PIDVerificationResult *result = [[PIDVerificationResult alloc] init];
+    result.timestamp = [NSDate date];
+    result.absoluteTolerance = kCrossSpectrumSteadyLimit;
+
+    PIDCSVData *data = [[PIDCSVParser parser] parseCSV:csvFilePath];
+    if (!data || data.timeSeconds.count == 0) {
+        result.passed = NO;
+        result.errorDetails = [NSString stringWithFormat:@"无法解析CSV: %@", [csvFilePath lastPathComponent]];
+        return result;
+    }
+
+    double sampleRate = data.sampleRate > 0 ? data.sampleRate : 8000.0;
+    PIDTraceAnalyzer *analyzer = [[PIDTraceAnalyzer alloc] initWithSampleRate:sampleRate cutFreq:25.0];
+    NSArray *axisPValues = @[data.axisP0 ?: @[], data.axisP1 ?: @[], data.axisP2 ?: @[]];
+    const double pGains[3] = {45.0, 50.0, 55.0};
+
+    double overall = 0.0;
+    double steady = 0.0;
+    double fullMs = 0.0;
+    double fastMs = 0.0;
+    NSInteger comparedCurves = 0;
+    for (NSInteger axis = 0; axis < 3; axis++) {
+        if ([axisPValues[axis] count] == 0) {
+            continue;
+        }
+        PIDStackData *stacks = [PIDStackData stackFromData:data
+                                                 axisIndex:axis
+                                                windowSize:(NSInteger)llround(sampleRate)
+                                                   overlap:0.9375
+                                                     pGain:pGains[axis]];
+        if (stacks.windowCount == 0) {
+            continue;
+        }
+
+        CFAbsoluteTime start = CFAbsoluteTimeGetCurrent();
+        PIDResponseResult *response = [analyzer stackResponseWithSpectralCache:[[PIDSpectralCache alloc] initWithStackData:stacks]];
+        PIDResponseCurves *full = [PIDTraceAnalyzer responseCurvesFromResult:response];
+        fullMs += (CFAbsoluteTimeGetCurrent() - start) * 1000.0;
+
+        start = CFAbsoluteTimeGetCurrent();
+        PIDResponseCurves *fast = [analyzer averagedCrossSpectrumCurvesWithStackData:stacks];
+        fastMs += (CFAbsoluteTimeGetCurrent() - start) * 1000.0;
+
+        if (full.lowWindowCount > 0 && fast.lowWindowCount > 0) {
+            PIDCurveDeviation(full.respLow, fast.respLow, &overall, &steady);
+            comparedCurves++;
+        }
+        if (full.respHigh && fast.respHigh) {
+            PIDCurveDeviation(full.respHigh, fast.respHigh, &overall, &steady);
+            comparedCurves++;
+        }
+    }
+
+    result.maxAbsoluteError = overall;
+    result.meanAbsoluteError = steady;
+    result.passed = comparedCurves > 0 && steady <= kCrossSpectrumSteadyLimit;
+    if (!result.passed) {
+        result.errorDetails = comparedCurves == 0
+            ? @"没有可对比的响应曲线（有效窗口不足）"
+            : [NSString stringWithFormat:@"稳态段偏差 %.3f 超过上限 %.2f", steady, kCrossSpectrumSteadyLimit];
+    }
+
+    NSLog(@"🔍 平均互谱估计(%@, %ld条曲线): %@ (全程偏差%.3f, 稳态偏差%.3f | 完整%.1fms, 平均互谱%.1fms, %.1fx)",
+          [csvFilePath lastPathComponent], (long)comparedCurves, result.passed ? @"通过" : @"失败",
+          overall, steady, fullMs, fastMs, fastMs > 0 ? fullMs / fastMs : 0.0);
+
+    return result;
+}
+
+#pragma mark - 三轴交错堆叠
+
+/**
+ * 两组统计量的最大相对误差
+ */
+static double PIDMaxRelativeError(NSArray<NSNumber *> *a, NSArray<NSNumber *> *b) {
+    if (a.count != b.count) {
+        return INFINITY;
+    }
+    double maxError = 0.0;
+    for (NSUInteger i = 0; i < a.count; i++) {
+        double x = [a[i] doubleValue];
+        double y = [b[i] doubleValue];
+        maxError = MAX(maxError, fabs(x - y) / MAX(fabs(y), 1e-12));
+    }
+    return maxError;
+}
+
+- (PIDVerificationResult *)verifyMultiAxisStacksWithSampleCount:(NSInteger)sampleCount {
+    PIDVerificationResult *result = [[PIDVerificationResult alloc] init];
+    result.timestamp = [NSDate date];
+    result.absoluteTolerance = _relativeTolerance;
+
+    // 合成三轴日志（油门从1200线性升到1800）
+    NSInteger n = MAX(sampleCount, 16000);
+    PIDCSVData *data = PIDSyntheticFlightLog(n, 3, 1200.0, 1800.0);
+
+    NSArray<NSNumber *> *pGains = @[@45.0, @50.0, @55.0];
+    CFAbsoluteTime start = CFAbsoluteTimeGetCurrent();
+    NSMutableArray<PIDStackData *> *single = [NSMutableArray arrayWithCapacity:3];
+    for (NSInteger axis = 0; axis < 3; axis++) {
+        [single addObject:[PIDStackData stackFromData:data axisIndex:axis windowSize:8000 overlap:0.9375
+                                                pGain:[pGains[axis] doubleValue]]];
+    }
+    double singleMs = (CFAbsoluteTimeGetCurrent() - start) * 1000.0;
+
+    start = CFAbsoluteTimeGetCurrent();
+    NSArray<PIDStackData *> *grouped = [PIDStackData stacksForAxesFromData:data windowSize:8000 overlap:0.9375 pGains:pGains];
+    double groupedMs = (CFAbsoluteTimeGetCurrent() - start) * 1000.0;
+
+    // 列逐位相同（窗口视图覆盖整段列缓冲区）
+    BOOL columnsOK = grouped.count == 3;
+    for (NSInteger axis = 0; axis < 3 && columnsOK; axis++) {
+        PIDStackData *a = single[axis];
+        PIDStackData *b = grouped[axis];
+        columnsOK = a.windowCount > 0 && a.windowCount == b.windowCount && a.step == b.step;
+        size_t spanBytes = (size_t)((a.windowCount - 1) * a.step + a.windowLength) * sizeof(double);
+        columnsOK = columnsOK &&
+            memcmp([a inputWindowAtIndex:0], [b inputWindowAtIndex:0], spanBytes) == 0 &&
+            memcmp([a gyroWindowAtIndex:0], [b gyroWindowAtIndex:0], spanBytes) == 0 &&
+            memcmp([a throttleWindowAtIndex:0], [b throttleWindowAtIndex:0], spanBytes) == 0 &&
+            memcmp([a timeWindowAtIndex:0], [b timeWindowAtIndex:0], spanBytes) == 0;
+    }
+
+    // 统计量（4路内核与逐轴vDSP的求和顺序不同，只要求在相对容差内）与阶跃响应
+    PIDTraceAnalyzer *analyzer = [[PIDTraceAnalyzer alloc] initWithSampleRate:8000.0 cutFreq:25.0];
+    double statisticsError = 0.0;
+    BOOL responseOK = columnsOK;
+    for (NSInteger axis = 0; axis < 3 && columnsOK; axis++) {
+        PIDResponseResult *a = [analyzer stackResponseWithSpectralCache:[[PIDSpectralCache alloc] initWithStackData:single[axis]]];
+        PIDResponseResult *b = [analyzer stackResponseWithSpectralCache:[[PIDSpectralCache alloc] initWithStackData:grouped[axis]]];
+        statisticsError = MAX(statisticsError, PIDMaxRelativeError(b.maxInput, a.maxInput));
+        statisticsError = MAX(statisticsError, PIDMaxRelativeError(b.avgInput, a.avgInput));
+        statisticsError = MAX(statisticsError, PIDMaxRelativeError(b.maxThrottle, a.maxThrottle));
+        statisticsError = MAX(statisticsError, PIDMaxRelativeError(b.avgTime, a.avgTime));
+        responseOK = responseOK && a.stepResponseData && [a.stepResponseData isEqualToData:b.stepResponseData];
+    }
+
+    // 解析器对缺少的列给出空数组：该轴必须是空堆叠，不能补0后当作真实数据分析
+    PIDCSVData *partial = PIDSyntheticFlightLog(16000, 2, 1200.0, 1800.0);
+    partial.gyroADC2 = @[];
+    partial.axisP2 = @[];
+    NSArray<PIDStackData *> *partialStacks = [PIDStackData stacksForAxesFromData:partial windowSize:8000 overlap:0.9375 pGains:pGains];
+    BOOL missingAxisOK = partialStacks.count == 3 && partialStacks[0].windowCount > 0 && partialStacks[2].windowCount == 0;
+
+    result.maxAbsoluteError = statisticsError;
+    result.passed = columnsOK && responseOK && missingAxisOK && statisticsError <= _relativeTolerance;
+    if (!result.passed) {
+        result.errorDetails = [NSString stringWithFormat:@"列%@, 阶跃响应%@, 缺少的轴%@, 统计量相对误差%.2e",
+                               columnsOK ? @"一致" : @"不一致", responseOK ? @"一致" : @"不一致",
+                               missingAxisOK ? @"为空" : @"未跳过", statisticsError];
+    }
+
+    NSLog(@"🔍 三轴交错堆叠(%ld样本): %@ (逐轴堆叠%.1fms, 三轴一遍%.1fms, 统计量相对误差%.2e)",
+          (long)n, result.passed ? @"通过" : @"失败", singleMs, groupedMs, statisticsError);
+
+    return result;
+}
+
+#pragma mark - 并行确定性
+
+// 多线程分析的重复次数（每次调度不同，都要与单线程结果逐位相同）
+static const NSInteger kParallelDeterminismPasses = 3;
+// 嵌套提交：外层任务数与每个外层任务内部提交的迭代数
+static const size_t kNestedOuterCount = 8;
+static const size_t kNestedInnerCount = 64;
+
+/**
+ * 按轴并行分析三轴堆叠（与PIDAnalysisViewController相同：轴并行，轴内窗口再由分析器按块并行）
+ * 结果按轴写入：@[阶跃响应数据, 平均噪声频谱]
+ */
+static NSArray<NSArray *> *PIDAnalyzeStacksInParallel(NSArray<PIDStackData *> *axisStacks,
+                                                      NSArray<NSNumber *> *time,
+                                                      PIDTraceAnalyzer *analyzer) {
+    NSMutableArray<NSArray *> *results = [NSMutableArray arrayWithCapacity:axisStacks.count];
+    for (NSUInteger axis = 0; axis < axisStacks.count; axis++) {
+        [results addObject:@[[NSData data], @[]]];
+    }
+    PIDParallelForEach(axisStacks.count, ^(size_t axis) {
+        @autoreleasepool {
+            PIDSpectralCache *cache = [[PIDSpectralCache alloc] initWithStackData:axisStacks[axis]];
+            PIDResponseResult *response = [analyzer stackResponseWithSpectralCache:cache];
+            PIDSpectrumResult *spectrum = [analyzer spectrumWithTime:time spectralCache:cache];
+            NSArray *entry = @[response.stepResponseData ?: [NSData data], spectrum.accumulator.averageSpectrum ?: @[]];
+            @synchronized (results) {
+                results[axis] = entry;
+            }
+        }
+    });
+    return results;
+}
+
+/**
+ * 在每个外层并行任务内部再提交一次并行任务，结果按 外层*内层+内层索引 写入
+ */
+static void PIDRunNestedParallelWork(double *values) {
+    PIDParallelForEach(kNestedOuterCount, ^(size_t outer) {
+        PIDParallelForEach(kNestedInnerCount, ^(size_t inner) {
+            double sum = 0.0;
+            for (size_t k = 0; k < 1000; k++) {
+                sum += sin(0.1 * outer + 0.01 * inner + (double)k);
+            }
+            values[outer * kNestedInnerCount + inner] = sum;
+        });
+    });
+}
+
+- (PIDVerificationResult *)verifyParallelDeterminismWithSampleCount:(NSInteger)sampleCount {
+    PIDVerificationResult *result = [[PIDVerificationResult alloc] init];
+    result.timestamp = [NSDate date];
+    result.absoluteTolerance = 0;
+
+    // 合成三轴日志（油门从1200线性升到1800）
+    NSInteger n = MAX(sampleCount, 16000);
+    PIDCSVData *data = PIDSyntheticFlightLog(n, 3, 1200.0, 1800.0);
+    NSArray<PIDStackData *> *axisStacks = [PIDStackData stacksForAxesFromData:data windowSize:8000 overlap:0.9375
+                                                                      pGains:@[@45.0, @50.0, @55.0]];
+    PIDTraceAnalyzer *analyzer = [[PIDTraceAnalyzer alloc] initWithSampleRate:8000.0 cutFreq:25.0];
+
+    // 单个工作线程（参考）
+    PIDParallelSetSingleWorker(true);
+    CFAbsoluteTime start = CFAbsoluteTimeGetCurrent();
+    NSArray<NSArray *> *serial = PIDAnalyzeStacksInParallel(axisStacks, data.timeSeconds, analyzer);
+    double serialMs = (CFAbsoluteTimeGetCurrent() - start) * 1000.0;
+    size_t nestedCount = kNestedOuterCount * kNestedInnerCount;
+    double *nestedSerial = (double *)malloc(nestedCount * sizeof(double));
+    double *nestedParallel = (double *)malloc(nestedCount * sizeof(double));
+    PIDRunNestedParallelWork(nestedSerial);
+    PIDParallelSetSingleWorker(false);
+
+    // 全部工作线程：每次都与单线程结果逐位相同
+    BOOL curvesOK = axisStacks.count == 3 && axisStacks[0].windowCount > 0;
+    double parallelMs = INFINITY;
+    for (NSInteger pass = 0; pass < kParallelDeterminismPasses; pass++) {
+        start = CFAbsoluteTimeGetCurrent();
+        NSArray<NSArray *> *parallel = PIDAnalyzeStacksInParallel(axisStacks, data.timeSeconds, analyzer);
+        parallelMs = MIN(parallelMs, (CFAbsoluteTimeGetCurrent() - start) * 1000.0);
+        for (NSUInteger axis = 0; axis < serial.count && curvesOK; axis++) {
+            NSData *expectedResponse = serial[axis][0];
+            curvesOK = expectedResponse.length > 0 &&
+                [expectedResponse isEqualToData:parallel[axis][0]] &&
+                [(NSArray *)serial[axis][1] isEqualToArray:parallel[axis][1]];
+        }
+    }
+
+    // 嵌套提交：在并行任务内部提交的任务全部完成，且结果与单线程相同
+    for (size_t i = 0; i < nestedCount; i++) {
+        nestedParallel[i] = NAN;
+    }
+    PIDRunNestedParallelWork(nestedParallel);
+    BOOL nestedOK = nestedSerial && nestedParallel &&
+        memcmp(nestedSerial, nestedParallel, nestedCount * sizeof(double)) == 0;
+    free(nestedSerial);
+    free(nestedParallel);
+
+    double speedup = parallelMs > 0 ? serialMs / parallelMs : 0.0;
+    result.meanAbsoluteError = speedup;
+    result.passed = curvesOK && nestedOK;
+    if (!result.passed) {
+        result.errorDetails = [NSString stringWithFormat:@"单线程与%zu线程结果: 曲线%@, 嵌套提交%@",
+                               PIDParallelWorkerCount(), curvesOK ? @"逐位相同" : @"不一致",
+                               nestedOK ? @"一致" : @"不一致"];
+    }
+
+    NSLog(@"🔍 并行确定性(%ld窗口, %zu线程): %@ (单线程%.1fms, 多线程%.1fms, 加速%.2fx)",
+          (long)axisStacks.firstObject.windowCount, PIDParallelWorkerCount(), result.passed ? @"通过" : @"失败",
+          serialMs, parallelMs, speedup);
+
+    return result;
+}
+
+#pragma mark - 活动度预筛
+
+- (PIDVerificationResult *)verifyActivityPruningWithCSV:(NSString *)csvFilePath {
+    PIDVerificationResult *result = [[PIDVerificationResult alloc] init];
+    result.timestamp = [NSDate date];
+    result.absoluteTolerance = 0.0;
+
+    PIDCSVData *data = [[PIDCSVParser parser] parseCSV:csvFilePath];
+    if (!data || data.timeSeconds.count == 0) {
+        result.passed = NO;
+        result.errorDetails = [NSString stringWithFormat:@"无法解析CSV: %@", [csvFilePath lastPathComponent]];
+        return result;
+    }
+
+    double sampleRate = data.sampleRate > 0 ? data.sampleRate : 8000.0;
+    PIDTraceAnalyzer *analyzer = [[PIDTraceAnalyzer alloc] initWithSampleRate:sampleRate cutFreq:25.0];
+    NSArray<PIDStackData *> *axisStacks = [PIDStackData stacksForAxesFromData:data
+                                                                  windowSize:(NSInteger)llround(sampleRate)
+                                                                     overlap:0.9375
+                                                                      pGains:@[@45.0, @50.0, @55.0]];
+
+    double curveError = 0.0;
+    BOOL rowsOK = YES;
+    BOOL refillOK = YES;
+    NSInteger windows = 0;
+    NSInteger pruned = 0;
+    NSInteger fullTransforms = 0;
+    NSInteger prunedTransforms = 0;
+    for (PIDStackData *stacks in axisStacks) {
+        if (stacks.windowCount == 0) {
+            continue;
+        }
+
+        analyzer.pruneInactiveWindows = NO;
+        PIDSpectralCache *fullCache = [[PIDSpectralCache alloc] initWithStackData:stacks];
+        PIDResponseResult *full = [analyzer stackResponseWithSpectralCache:fullCache];
+        analyzer.pruneInactiveWindows = YES;
+        PIDSpectralCache *prunedCache = [[PIDSpectralCache alloc] initWithStackData:stacks];
+        PIDResponseResult *fast = [analyzer stackResponseWithSpectralCache:prunedCache];
+
+        // 每个参与反卷积的窗口3次FFT：输入/陀螺仪正向各一次、逆变换一次
+        windows += stacks.windowCount;
+        pruned += fast.prunedWindowCount;
+        fullTransforms += 3 * stacks.windowCount;
+        prunedTransforms += 3 * (stacks.windowCount - fast.prunedWindowCount);
+
+        // 活动窗口的阶跃响应逐位相同
+        NSInteger rlen = full.stepResponse.count > 0 ? full.stepResponse[0].count : 0;
+        const double *a = full.stepResponseData.bytes;
+        const double *b = fast.stepResponseData.bytes;
+        rowsOK = rowsOK && a && b && full.stepResponseData.length == fast.stepResponseData.length;
+        for (NSInteger w = 0; w < stacks.windowCount && rowsOK; w++) {
+            if (!([full.maxInput[w] doubleValue] <= 20.0)) {
+                rowsOK = memcmp(a + w * rlen, b + w * rlen, rlen * sizeof(double)) == 0;
+            }
+        }
+
+        PIDResponseCurves *fullCurves = [PIDTraceAnalyzer responseCurvesFromResult:full];
+        PIDResponseCurves *fastCurves = [PIDTraceAnalyzer responseCurvesFromResult:fast];
+        double overall = 0.0;
+        double steady = 0.0;
+        PIDCurveDeviation(fullCurves.respLow, fastCurves.respLow, &overall, &steady);
+        if (fullCurves.respHigh || fastCurves.respHigh) {
+            if (fullCurves.respHigh && fastCurves.respHigh) {
+                PIDCurveDeviation(fullCurves.respHigh, fastCurves.respHigh, &overall, &steady);
+            } else {
+                overall = INFINITY;
+            }
+        }
+        curveError = MAX(curveError, overall);
+
+        // 噪声频谱随后请求全部窗口的陀螺仪频谱：补算被跳过的窗口后与未预筛的频谱相同，总FFT次数不增加
+        NSInteger paddedLength = [analyzer.wienerDeconvolution paddedLengthForLength:stacks.windowLength];
+        PIDWindowSpectra *fullGyro = [fullCache spectraForTrace:PIDSpectralTraceGyro
+                                                         window:PIDSpectralWindowAnalysis
+                                                   paddedLength:paddedLength];
+        PIDWindowSpectra *prunedGyro = [prunedCache spectraForTrace:PIDSpectralTraceGyro
+                                                             window:PIDSpectralWindowAnalysis
+                                                       paddedLength:paddedLength];
+        size_t spectrumBytes = (size_t)(stacks.windowCount * fullGyro.binCount) * sizeof(double);
+        refillOK = refillOK && fullGyro && prunedGyro &&
+            memcmp(fullGyro.realData, prunedGyro.realData, spectrumBytes) == 0 &&
+            memcmp(fullGyro.imagData, prunedGyro.imagData, spectrumBytes) == 0 &&
+            prunedCache.transformCount <= fullCache.transformCount;
+    }
+
+    double workRatio = fullTransforms > 0 ? (double)prunedTransforms / fullTransforms : 1.0;
+    result.maxAbsoluteError = curveError;
+    result.meanAbsoluteError = workRatio;
+    result.passed = windows > 0 && rowsOK && refillOK && curveError == 0.0;
+    if (!result.passed) {
+        result.errorDetails = windows == 0
+            ? @"没有可分析的窗口"
+            : [NSString stringWithFormat:@"活动窗口响应%@, 频谱补算%@, 曲线偏差%.3e",
+               rowsOK ? @"一致" : @"不一致", refillOK ? @"正确" : @"错误", curveError];
+    }
+
+    NSLog(@"🔍 活动度预筛(%@): %@ (跳过%ld/%ld个窗口, FFT次数%ld → %ld, %.0f%%)",
+          [csvFilePath lastPathComponent], result.passed ? @"通过" : @"失败", (long)pruned, (long)windows,
+          (long)fullTransforms, (long)prunedTransforms, workRatio * 100.0);
+
+    return result;
+}
+
+#pragma mark - 参数扫描
+
+- (PIDVerificationResult *)verifyParameterSweepWithCSV:(NSString *)csvFilePath {
+    PIDVerificationResult *result = [[PIDVerificationResult alloc] init];
+    result.timestamp = [NSDate date];
+    result.absoluteTolerance = _absoluteTolerance;
+
+    PIDCSVData *data = [[PIDCSVParser parser] parseCSV:csvFilePath];
+    if (!data || data.timeSeconds.count == 0) {
+        result.passed = NO;
+        result.errorDetails = [NSString stringWithFormat:@"无法解析CSV: %@", [csvFilePath lastPathComponent]];
+        return result;
+    }
+
+    // 截止频率 × 高输入阈值，响应长度取分析器默认值
+    NSMutableArray<PIDResponseParameters *> *parameterSets = [NSMutableArray array];
+    for (NSNumber *cutFreq in @[@15.0, @25.0, @40.0]) {
+        for (NSNumber *threshold in @[@300.0, @500.0]) {
+            [parameterSets addObject:[PIDResponseParameters parametersWithCutFreq:cutFreq.doubleValue
+                                                                   responseLength:0
+                                                               highInputThreshold:threshold.doubleValue]];
+        }
+    }
+
+    double sampleRate = data.sampleRate > 0 ? data.sampleRate : 8000.0;
+    NSArray<PIDStackData *> *axisStacks = [PIDStackData stacksForAxesFromData:data
+                                                                  windowSize:(NSInteger)llround(sampleRate)
+                                                                     overlap:0.9375
+                                                                      pGains:@[@45.0, @50.0, @55.0]];
+
+    double curveError = 0.0;
+    BOOL reuseOK = YES;
+    NSInteger comparedCurves = 0;
+    double separateMs = 0.0;
+    double sweepMs = 0.0;
+    for (PIDStackData *stacks in axisStacks) {
+        if (stacks.windowCount == 0) {
+            continue;
+        }
+
+        // 逐组完整分析：每组参数单独堆叠统计、FFT、反卷积和分组
+        NSMutableArray<PIDResponseCurves *> *expected = [NSMutableArray arrayWithCapacity:parameterSets.count];
+        CFAbsoluteTime start = CFAbsoluteTimeGetCurrent();
+        for (PIDResponseParameters *parameters in parameterSets) {
+            PIDTraceAnalyzer *analyzer = [[PIDTraceAnalyzer alloc] initWithSampleRate:sampleRate cutFreq:parameters.cutFreq];
+            PIDResponseResult *response = [analyzer stackResponseWithSpectralCache:[[PIDSpectralCache alloc] initWithStackData:stacks]];
+            PIDResponseCurveBuilder *builder = [[PIDResponseCurveBuilder alloc] init];
+            builder.highInputThreshold = parameters.highInputThreshold;
+            NSInteger windowCount = MIN(response.stepResponse.count, response.maxInput.count);
+            for (NSInteger w = 0; w < windowCount; w++) {
+                [builder addInitialPassWindow:response.stepResponse[w] maxInput:[response.maxInput[w] doubleValue]];
+            }
+            [builder finishInitialPass];
+            for (NSInteger w = 0; w < windowCount; w++) {
+                [builder addFinalPassWindow:response.stepResponse[w] maxInput:[response.maxInput[w] doubleValue]];
+            }
+            [expected addObject:[builder finishFinalPass]];
+        }
+        separateMs += (CFAbsoluteTimeGetCurrent() - start) * 1000.0;
+
+        // 一遍扫描全部参数组；同一缓存再扫描一次，不应再做正向FFT
+        PIDTraceAnalyzer *analyzer = [[PIDTraceAnalyzer alloc] initWithSampleRate:sampleRate cutFreq:25.0];
+        PIDSpectralCache *cache = [[PIDSpectralCache alloc] initWithStackData:stacks];
+        start = CFAbsoluteTimeGetCurrent();
+        NSArray<PIDResponseCurves *> *swept = [analyzer responseCurvesWithSpectralCache:cache parameterSets:parameterSets];
+        sweepMs += (CFAbsoluteTimeGetCurrent() - start) * 1000.0;
+        NSInteger transforms = cache.transformCount;
+        NSArray<PIDResponseCurves *> *again = [analyzer responseCurvesWithSpectralCache:cache parameterSets:parameterSets];
+        reuseOK = reuseOK && swept.count == parameterSets.count && again.count == parameterSets.count &&
+            cache.transformCount == transforms;
+
+        for (NSUInteger k = 0; k < swept.count && k < expected.count; k++) {
+            double overall = 0.0;
+            double steady = 0.0;
+            PIDCurveDeviation(expected[k].respLow, swept[k].respLow, &overall, &steady);
+            if (expected[k].respHigh || swept[k].respHigh) {
+                if (expected[k].respHigh && swept[k].respHigh) {
+                    PIDCurveDeviation(expected[k].respHigh, swept[k].respHigh, &overall, &steady);
+                } else {
+                    overall = INFINITY;
+                }
+            }
+            curveError = MAX(curveError, overall);
+            comparedCurves++;
+        }
+    }
+
+    result.maxAbsoluteError = curveError;
+    result.passed = comparedCurves > 0 && reuseOK && curveError <= _absoluteTolerance;
+    if (!result.passed) {
+        result.errorDetails = comparedCurves == 0
+            ? @"没有可对比的响应曲线"
+            : [NSString stringWithFormat:@"频谱复用%@, 曲线偏差%.3e", reuseOK ? @"正确" : @"错误", curveError];
+    }
+
+    NSLog(@"🔍 参数扫描(%@, %lu组参数): %@ (逐组分析%.1fms, 一遍扫描%.1fms, %.1fx, 曲线偏差%.2e)",
+          [csvFilePath lastPathComponent], (unsigned long)parameterSets.count, result.passed ? @"通过" : @"失败",
+          separateMs, sweepMs, sweepMs > 0 ? separateMs / sweepMs : 0.0, curveError);
+
+    return result;
+}
+
+#pragma mark - 多通道批量频谱
+
+// 逐通道对照只取前64个窗口（spectrumWithTime:traces:需要装箱每个窗口的全部样本）
+static const NSInteger kBatchedSpectrumVerifyWindows = 64;
+
+- (PIDVerificationResult *)verifyBatchedChannelSpectraWithCSV:(NSString *)csvFilePath {
+    PIDVerificationResult *result = [[PIDVerificationResult alloc] init];
+    result.timestamp = [NSDate date];
+    result.absoluteTolerance = _relativeTolerance;
+
+    PIDCSVData *data = [[PIDCSVParser parser] parseCSV:csvFilePath];
+    if (!data || data.timeSeconds.count == 0) {
+        result.passed = NO;
+        result.errorDetails = [NSString stringWithFormat:@"无法解析CSV: %@", [csvFilePath lastPathComponent]];
+        return result;
+    }
+
+    double sampleRate = data.sampleRate > 0 ? data.sampleRate : 8000.0;
+    PIDStackData *stacks = [PIDStackData stacksForAxesFromData:data
+                                                    windowSize:(NSInteger)llround(sampleRate)
+                                                       overlap:0.9375
+                                                        pGains:@[@45.0, @50.0, @55.0]
+                                                   windowRange:NSMakeRange(0, kBatchedSpectrumVerifyWindows)].firstObject;
+    if (stacks.windowCount == 0) {
+        result.passed = NO;
+        result.errorDetails = @"数据不足一个窗口";
+        return result;
+    }
+
+    // 陀螺仪、D项、debug（CSV中缺少的通道跳过）
+    NSArray<NSArray<NSNumber *> *> *sources = @[data.gyroADC0 ?: @[], data.gyroADC1 ?: @[], data.gyroADC2 ?: @[],
+                                                data.axisD0 ?: @[], data.axisD1 ?: @[], data.axisD2 ?: @[],
+                                                data.debug0 ?: @[], data.debug1 ?: @[], data.debug2 ?: @[],
+                                                data.debug3 ?: @[]];
+    NSMutableArray<NSData *> *columns = [NSMutableArray array];
+    for (NSArray<NSNumber *> *source in sources) {
+        if (source.count > 0) {
+            [columns addObject:[stacks columnFromSamples:source]];
+        }
+    }
+
+    PIDTraceAnalyzer *analyzer = [[PIDTraceAnalyzer alloc] initWithSampleRate:sampleRate cutFreq:25.0];
+    PIDSpectralCache *cache = [[PIDSpectralCache alloc] initWithStackData:stacks];
+    CFAbsoluteTime start = CFAbsoluteTimeGetCurrent();
+    NSArray<PIDSpectrumAccumulator *> *batched = [analyzer spectrumAccumulatorsForChannels:columns
+                                                                                      time:data.timeSeconds
+                                                                             spectralCache:cache];
+    double batchedMs = (CFAbsoluteTimeGetCurrent() - start) * 1000.0;
+
+    // 陀螺仪通道与频谱缓存路径同一FFT、同一累加顺序，热力图与平均谱应逐点相同
+    PIDSpectrumResult *gyroSpectrum = [analyzer spectrumWithTime:data.timeSeconds spectralCache:cache];
+    BOOL gyroIdentical = batched.count == columns.count && data.gyroADC0.count > 0 &&
+        [[batched[0] averageSpectrum] isEqualToArray:[gyroSpectrum.accumulator averageSpectrum]] &&
+        [[batched[0] throttleHeatmap] isEqualToArray:[gyroSpectrum.accumulator throttleHeatmap]];
+
+    // 逐通道：加窗后的窗口装箱，单独调用 spectrumWithTime:traces:
+    const double *window = cache.windowValues;
+    NSInteger windowLength = stacks.windowLength;
+    double relativeError = 0.0;
+    double separateMs = 0.0;
+    for (NSUInteger c = 0; c < columns.count && c < batched.count; c++) {
+        const double *column = (const double *)columns[c].bytes;
+        NSMutableArray<NSArray<NSNumber *> *> *traces = [NSMutableArray arrayWithCapacity:stacks.windowCount];
+        for (NSInteger w = 0; w < stacks.windowCount; w++) {
+            NSMutableArray<NSNumber *> *trace = [NSMutableArray arrayWithCapacity:windowLength];
+            for (NSInteger j = 0; j < windowLength; j++) {
+                [trace addObject:@(column[w * stacks.step + j] * window[j])];
+            }
+            [traces addObject:trace];
+        }
+        start = CFAbsoluteTimeGetCurrent();
+        PIDSpectrumResult *separate = [analyzer spectrumWithTime:data.timeSeconds traces:traces];
+        separateMs += (CFAbsoluteTimeGetCurrent() - start) * 1000.0;
+        relativeError = MAX(relativeError, PIDSpectrumRelativeDeviation([separate.accumulator averageSpectrum],
+                                                                        [batched[c] averageSpectrum]));
+    }
+
+    result.maxRelativeError = relativeError;
+    result.passed = batched.count == columns.count && gyroIdentical && relativeError <= _relativeTolerance;
+    if (!result.passed) {
+        result.errorDetails = !batched
+            ? @"批量频谱返回nil"
+            : [NSString stringWithFormat:@"陀螺仪通道%@, 平均谱相对偏差%.3e",
+               gyroIdentical ? @"一致" : @"不一致", relativeError];
+    }
+
+    NSLog(@"🔍 多通道批量频谱(%@, %lu通道 × %ld窗口): %@ (逐通道%.1fms, 批量%.1fms, %.1fx, 相对偏差%.2e)",
+          [csvFilePath lastPathComponent], (unsigned long)columns.count, (long)stacks.windowCount,
+          result.passed ? @"通过" : @"失败", separateMs, batchedMs,
+          batchedMs > 0 ? separateMs / batchedMs : 0.0, relativeError);
+
+    return result;
+}
+
+#pragma mark - 油门分层响应
+
+- (PIDVerificationResult *)verifyThrottleResponseWithWindowCount:(NSInteger)windowCount
+                                                  responseLength:(NSInteger)responseLength {
+    PIDVerificationResult *result = [[PIDVerificationResult alloc] init];
+    result.timestamp = [NSDate date];
+    result.absoluteTolerance = _absoluteTolerance;
+
+    NSInteger rows = MAX(windowCount, 1);
+    NSInteger len = MAX(responseLength, 2);
+    const NSInteger throttleBins = 10;
+    const NSInteger vertBins = 1000;
+    NSArray<NSNumber *> *vertRange = @[@(-1.5), @(3.5)];
+
+    // 模拟阶跃响应：超调随油门增大；油门取 x.x5%，不落在箱边界上
+    NSMutableData *storage = [NSMutableData dataWithLength:sizeof(double) * rows * (len + 2)];
+    double *responses = storage.mutableBytes;
+    double *throttle = responses + rows * len;
+    double *weights = throttle + rows;
+    for (NSInteger w = 0; w < rows; w++) {
+        throttle[w] = ((double)arc4random_uniform(1000) + 0.5) / 10.0;
+        weights[w] = arc4random_uniform(10) == 0 ? 0.0 : 1.0;
+        double gain = 0.8 + throttle[w] / 250.0 + (double)arc4random_uniform(200) / 1000.0;
+        double rate = 20.0 + (double)arc4random_uniform(400) / 10.0;
+        for (NSInteger i = 0; i < len; i++) {
+            double t = 0.5 * i / (len - 1);
+            double noise = (double)arc4random_uniform(2000) / 20000.0 - 0.05;
+            responses[w * len + i] = gain * (1.0 - exp(-rate * t)) + noise;
+        }
+    }
+
+    // 一遍散射 + 成批平滑
+    CFAbsoluteTime start = CFAbsoluteTimeGetCurrent();
+    PIDThrottleResponseHistogram *histogram =
+        [[PIDThrottleResponseHistogram alloc] initWithThrottleBins:throttleBins
+                                                          timeBins:len
+                                                    responseLength:len
+                                                         vertRange:vertRange
+                                                          vertBins:vertBins];
+    [histogram addResponseMatrix:responses windowCount:rows throttle:throttle weights:weights];
+    NSArray<NSArray<NSNumber *> *> *actual = [histogram responseHeatmap];
+    double singlePassMs = (CFAbsoluteTimeGetCurrent() - start) * 1000.0;
+
+    // 参考：每个油门箱重新筛选窗口，单独构建直方图
+    start = CFAbsoluteTimeGetCurrent();
+    NSMutableArray<NSArray<NSNumber *> *> *expected = [NSMutableArray arrayWithCapacity:throttleBins];
+    for (NSInteger b = 0; b < throttleBins; b++) {
+        PIDResponseHistogram *binHistogram = [[PIDResponseHistogram alloc] initWithResponseLength:len
+                                                                                        vertRange:vertRange
+                                                                                         vertBins:vertBins];
+        for (NSInteger w = 0; w < rows; w++) {
+            NSInteger bin = MIN((NSInteger)(throttle[w] / 100.0 * throttleBins), throttleBins - 1);
+            if (bin == b && weights[w] > 0) {
+                [binHistogram addWindowValues:responses + w * len weight:weights[w]];
+            }
+        }
+        if (binHistogram.windowCount > 0) {
+            [expected addObject:[binHistogram weightedModeAverage]];
+        } else {
+            NSMutableArray<NSNumber *> *zeros = [NSMutableArray arrayWithCapacity:len];
+            for (NSInteger t = 0; t < len; t++) {
+                [zeros addObject:@0.0];
+            }
+            [expected addObject:zeros];
+        }
+    }
+    double perBinMs = (CFAbsoluteTimeGetCurrent() - start) * 1000.0;
+
+    double maxError = 0.0;
+    BOOL shapeMatches = actual.count == (NSUInteger)throttleBins;
+    for (NSInteger b = 0; b < throttleBins && shapeMatches; b++) {
+        if (actual[b].count != expected[b].count) {
+            shapeMatches = NO;
+            break;
+        }
+        for (NSUInteger t = 0; t < actual[b].count; t++) {
+            maxError = MAX(maxError, fabs([actual[b][t] doubleValue] - [expected[b][t] doubleValue]));
+        }
+    }
+    result.maxAbsoluteError = maxError;
+    result.meanAbsoluteError = maxError;
+    // 同一箱内窗口的累加顺序相同，结果应逐位一致
+    result.passed = shapeMatches && maxError <= _absoluteTolerance;
+    if (!result.passed) {
+        result.errorDetails = shapeMatches
+            ? [NSString stringWithFormat:@"油门分层响应与逐箱构建不一致: 最大误差%.2e", maxError]
+            : @"油门分层响应热力图尺寸不一致";
+    }
+
+    NSLog(@"🔍 油门分层响应(%ld窗口 × %ld点, %ld油门箱): %@ (最大误差%.2e, 逐箱构建%.1fms / 一遍散射%.1fms, %.1fx)",
+          (long)rows, (long)len, (long)throttleBins, result.passed ? @"通过" : @"失败", maxError,
+          perBinMs, singlePassMs, perBinMs / MAX(singlePassMs, 1e-6));
+
+    return result;
+}
+
+#pragma mark - 多相重采样
+
+// 重采样正弦的允许误差（通带内Kaiser窗sinc的实测误差约5e-5）
+static const double kResamplerSineTolerance = 1e-3;
+
+/**
+ * 数据中 [location, location+length) 的行（只取给定的列，短列截到自身长度）
+ */
+static PIDCSVData *PIDCSVDataSlice(PIDCSVData *data, NSArray<NSString *> *keys, NSRange range) {
+    PIDCSVData *slice = [[PIDCSVData alloc] init];
+    for (NSString *key in keys) {
+        NSArray<NSNumber *> *column = [data valueForKey:key];
+        NSUInteger end = MIN(NSMaxRange(range), column.count);
+        [slice setValue:end > range.location ? [column subarrayWithRange:NSMakeRange(range.location, end - range.location)] : @[]
+                 forKey:key];
+    }
+    slice.sampleRate = data.sampleRate;
+    slice.dataLength = (NSInteger)range.length;
+    return slice;
+}
+
+- (PIDVerificationResult *)verifyPolyphaseResamplerWithSampleCount:(NSInteger)sampleCount {
+    PIDVerificationResult *result = [[PIDVerificationResult alloc] init];
+    result.timestamp = [NSDate date];
+    result.absoluteTolerance = kResamplerSineTolerance;
+
+    NSInteger n = MAX(sampleCount, 1000);
+    NSArray<NSString *> *keys = @[@"timeSeconds", @"gyroADC0", @"rcCommand0", @"gyroADC1"];
+    // 输入采样率、变换比（upFactor为0时由resamplerForSampleRate规划）与正弦频率
+    const double inputRates[] = {1000.0, 3200.0};
+    const NSInteger upFactors[] = {8, 0};
+    const double frequencies[] = {50.0, 200.0};
+    const NSInteger chunkSizes[] = {1, 97, 500, 1237};
+
+    double maxError = 0.0;
+    BOOL chunkedOK = YES;
+    BOOL finiteOK = YES;
+    NSMutableArray<NSString *> *plans = [NSMutableArray array];
+    for (NSInteger c = 0; c < 2; c++) {
+        double inputRate = inputRates[c];
+        PIDPolyphaseResampler *resampler = upFactors[c] > 0
+            ? [[PIDPolyphaseResampler alloc] initWithInputRate:inputRate upFactor:upFactors[c] downFactor:1]
+            : [PIDPolyphaseResampler resamplerForSampleRate:inputRate];
+        if (!resampler) {
+            chunkedOK = NO;
+            continue;
+        }
+        [plans addObject:[NSString stringWithFormat:@"%.0f→%.0fHz(L=%ld,M=%ld)", inputRate, resampler.outputRate,
+                          (long)resampler.upFactor, (long)resampler.downFactor]];
+
+        // 正弦/余弦各一列，gyroADC1只有60%的长度
+        double omega = 2.0 * M_PI * frequencies[c];
+        NSMutableArray<NSNumber *> *time = [NSMutableArray arrayWithCapacity:n];
+        NSMutableArray<NSNumber *> *sine = [NSMutableArray arrayWithCapacity:n];
+        NSMutableArray<NSNumber *> *cosine = [NSMutableArray arrayWithCapacity:n];
+        for (NSInteger i = 0; i < n; i++) {
+            double t = i / inputRate;
+            [time addObject:@(t)];
+            [sine addObject:@(sin(omega * t))];
+            [cosine addObject:@(cos(omega * t))];
+        }
+        PIDCSVData *data = [[PIDCSVData alloc] init];
+        data.timeSeconds = time;
+        data.gyroADC0 = sine;
+        data.rcCommand0 = cosine;
+        data.gyroADC1 = [sine subarrayWithRange:NSMakeRange(0, n * 6 / 10)];
+        data.sampleRate = inputRate;
+        data.dataLength = n;
+
+        // 整段重采样：与解析正弦对比（输出点k的时间为 k / outputRate）
+        PIDCSVData *whole = [resampler resampleData:data];
+        NSInteger outputCount = (NSInteger)whole.gyroADC0.count;
+        for (NSInteger k = outputCount / 10; k < outputCount - outputCount / 10; k++) {
+            double t = k / resampler.outputRate;
+            maxError = MAX(maxError, fabs([whole.gyroADC0[k] doubleValue] - sin(omega * t)));
+            maxError = MAX(maxError, fabs([whole.rcCommand0[k] doubleValue] - cos(omega * t)));
+        }
+        for (NSString *key in @[@"gyroADC0", @"rcCommand0", @"gyroADC1"]) {
+            for (NSNumber *value in (NSArray<NSNumber *> *)[whole valueForKey:key]) {
+                finiteOK = finiteOK && isfinite([value doubleValue]);
+            }
+        }
+
+        // 不规则块大小流式重采样，拼接后与整段逐位相同
+        [resampler reset];
+        NSMutableDictionary<NSString *, NSMutableArray<NSNumber *> *> *streamed = [NSMutableDictionary dictionary];
+        for (NSString *key in keys) {
+            streamed[key] = [NSMutableArray array];
+        }
+        NSInteger offset = 0;
+        for (NSInteger chunkIndex = 0; offset < n; chunkIndex++) {
+            NSInteger rows = MIN(chunkSizes[chunkIndex % 4], n - offset);
+            PIDCSVData *output = [resampler resampleChunk:PIDCSVDataSlice(data, keys, NSMakeRange(offset, rows)) final:NO];
+            for (NSString *key in keys) {
+                [streamed[key] addObjectsFromArray:[output valueForKey:key] ?: @[]];
+            }
+            offset += rows;
+        }
+        PIDCSVData *tail = [resampler resampleChunk:nil final:YES];
+        for (NSString *key in keys) {
+            [streamed[key] addObjectsFromArray:[tail valueForKey:key] ?: @[]];
+        }
+        for (NSString *key in keys) {
+            NSArray<NSNumber *> *expected = [whole valueForKey:key];
+            NSArray<NSNumber *> *actual = streamed[key];
+            chunkedOK = chunkedOK && actual.count == expected.count;
+            for (NSUInteger i = 0; i < actual.count && chunkedOK; i++) {
+                chunkedOK = [actual[i] doubleValue] == [expected[i] doubleValue];
+            }
+        }
+    }
+
+    result.maxAbsoluteError = maxError;
+    result.passed = chunkedOK && finiteOK && maxError <= kResamplerSineTolerance;
+    if (!result.passed) {
+        result.errorDetails = [NSString stringWithFormat:@"正弦最大误差%.2e, 分块与整段%@, 短列补齐%@", maxError,
+                               chunkedOK ? @"逐位相同" : @"不一致", finiteOK ? @"无NaN" : @"产生NaN"];
+    }
+
+    NSLog(@"🔍 多相重采样(%@): %@ (正弦最大误差%.2e)",
+          [plans componentsJoinedByString:@", "], result.passed ? @"通过" : @"失败", maxError);
+
+    return result;
+}
+
 #pragma mark - 批量验证
 
+// 目录中没有飞行日志时合成日志的长度（8kHz下10秒，每轴约150个窗口）
+static const NSInteger kSyntheticLogSampleCount = 80000;
+
+// 超长日志检查的行数：超过解析器默认的10万行上限（8kHz下15秒）
+static const NSInteger kLongLogSampleCount = 120000;
+
 - (PIDVerificationReport *)runVerificationSuite:(NSString *)testDataPath {
     PIDVerificationReport *report = [[PIDVerificationReport alloc] init];
     [_verificationResults removeAllObjects];
@@ -331,8 +2836,6 @@
         }
     }
 
-    report.totalTests = referenceFiles.count;
-
     // 运行每个测试
     for (NSString *refFile in referenceFiles) {
         NSLog(@"🧪 运行测试: %@", [refFile lastPathComponent]);
@@ -350,10 +2853,45 @@
             } else if ([testType isEqualToString:@"spectrum"]) {
                 // 验证频谱分析
                 // 这里需要实际的分析数据，暂时跳过
+            } else if ([testType isEqualToString:@"fft"]) {
+                // 验证FFT（numpy.fft.rfft参考，长度可为任意值）
+                [_verificationResults addObject:[self verifyFFTReference:refData]];
+            } else if ([testType isEqualToString:@"gaussian"]) {
+                // 验证高斯平滑（scipy.ndimage.gaussian_filter1d参考，各边界模式）
+                [_verificationResults addObject:[self verifyGaussianReference:refData]];
             }
         }
     }
 
+    // 合成数据检查（不依赖目录中的文件）
+    [self runSyntheticChecks];
+
+    // 日志检查：目录中的飞行日志CSV，没有时用合成日志
+    NSMutableArray<NSString *> *logFiles = [NSMutableArray array];
+    for (NSString *file in files) {
+        if ([file.pathExtension isEqualToString:@"csv"] && ![file hasSuffix:@"_reference.csv"]) {
+            [logFiles addObject:[testDataPath stringByAppendingPathComponent:file]];
+        }
+    }
+    NSString *syntheticLog = nil;
+    if (logFiles.count == 0) {
+        NSString *path = [NSTemporaryDirectory() stringByAppendingPathComponent:@"pid_verifier_synthetic_log.csv"];
+        // 开头2秒地面怠速：日志检查同时覆盖被活动度预筛跳过的窗口
+        PIDCSVData *synthetic = PIDSyntheticFlightLog(kSyntheticLogSampleCount, 3, 1100.0, 1900.0);
+        PIDSyntheticGroundIdle(synthetic, 16000);
+        syntheticLog = PIDWriteSyntheticFlightLogCSV(synthetic, path);
+        if (syntheticLog) {
+            [logFiles addObject:syntheticLog];
+        }
+    }
+    for (NSString *logFile in logFiles) {
+        [self runLogChecks:logFile];
+    }
+    if (syntheticLog) {
+        [fm removeItemAtPath:syntheticLog error:nil];
+    }
+
+    report.totalTests = _verificationResults.count;
     report.results = [_verificationResults copy];
     report.passedTests = 0;
     report.failedTests = 0;
@@ -369,6 +2907,42 @@
     return report;
 }
 
+/**
+ * 合成数据检查：各内核与其参考实现的一致性，结果追加到 _verificationResults
+ */
+- (void)runSyntheticChecks {
+    NSLog(@"🧪 运行合成数据检查");
+    [_verificationResults addObject:[self verifyInterpolationKernelsWithSampleCount:4096]];
+    [_verificationResults addObject:[self verifyPolyphaseResamplerWithSampleCount:4000]];
+    [_verificationResults addObject:[self verifyFFTBackendsWithLength:8000 iterations:20]];
+    [_verificationResults addObject:[self verifyWienerKernelWithWindowCount:32 windowLength:8000]];
+    [_verificationResults addObject:[self verifyResponseHistogramWithWindowCount:200 responseLength:500]];
+    [_verificationResults addObject:[self verifyIncrementalResponseWithWindowCount:400 responseLength:500]];
+    [_verificationResults addObject:[self verifyThrottleResponseWithWindowCount:400 responseLength:500]];
+    [_verificationResults addObject:[self verifyGaussianFilterWithLength:20000 sigma:12.0]];
+    [_verificationResults addObject:[self verifyPrecisionPolicyWithWindowCount:64 windowLength:8000]];
+    [_verificationResults addObject:[self verifySpectrumAccumulatorWithWindowCount:500 frequencyCount:4097]];
+    [_verificationResults addObject:[self verifyCancellationWithSampleCount:kSyntheticLogSampleCount]];
+    [_verificationResults addObject:[self verifyScratchArenaWithSampleCount:kSyntheticLogSampleCount]];
+    [_verificationResults addObject:[self verifyMultiAxisStacksWithSampleCount:kSyntheticLogSampleCount]];
+    [_verificationResults addObject:[self verifyParallelDeterminismWithSampleCount:kSyntheticLogSampleCount]];
+    [_verificationResults addObject:[self verifyOutOfCoreLongLogWithSampleCount:kLongLogSampleCount]];
+}
+
+/**
+ * 日志检查：需要完整CSV文件的分析流程一致性，结果追加到 _verificationResults
+ */
+- (void)runLogChecks:(NSString *)csvFilePath {
+    NSLog(@"🧪 运行日志检查: %@", [csvFilePath lastPathComponent]);
+    [_verificationResults addObject:[self verifyPipelineParityWithCSV:csvFilePath]];
+    [_verificationResults addObject:[self verifyOutOfCoreParity:csvFilePath
+                                                   memoryBudget:[PIDOutOfCoreConfig defaultConfig].memoryBudgetBytes]];
+    [_verificationResults addObject:[self verifyCrossSpectrumAgreementWithCSV:csvFilePath]];
+    [_verificationResults addObject:[self verifyActivityPruningWithCSV:csvFilePath]];
+    [_verificationResults addObject:[self verifyParameterSweepWithCSV:csvFilePath]];
+    [_verificationResults addObject:[self verifyBatchedChannelSpectraWithCSV:csvFilePath]];
+}
+
 /**
  * 加载参考数据
  */
@@ -405,30 +2979,67 @@
 
     // 计时开始
     NSDate *startTime = [NSDate date];
+    PIDAllocationCounters countersBefore = PIDAllocationCountersSnapshot();
 
-    // 执行解析和分析
+    // 执行解析和完整分析（与分析界面相同：重采样 → 三轴一遍堆叠 → 频谱缓存 → 维纳反卷积 → 噪声频谱）
     @autoreleasepool {
         PIDCSVParser *parser = [PIDCSVParser parser];
         PIDCSVData *data = [parser parseCSV:csvFilePath];
 
         if (data && data.timeSeconds.count > 0) {
-            // 执行分析
-            PIDTraceAnalyzer *analyzer = [[PIDTraceAnalyzer alloc] init];
-            // 这里可以添加更多分析操作
             result.dataSize = data.timeSeconds.count;
+
+            double sampleRate = data.sampleRate > 0 ? data.sampleRate : 8000.0;
+            PIDPolyphaseResampler *resampler = [PIDPolyphaseResampler resamplerForSampleRate:sampleRate];
+            if (resampler) {
+                data = [resampler resampleData:data];
+                sampleRate = resampler.outputRate;
+            }
+            double analysisRate = [PIDPolyphaseResampler analysisRateForSampleRate:sampleRate];
+            NSInteger windowSize = [PIDPolyphaseResampler windowSize:8000 forAnalysisRate:analysisRate];
+
+            PIDTraceAnalyzer *analyzer = [[PIDTraceAnalyzer alloc] initWithSampleRate:sampleRate cutFreq:25.0];
+            analyzer.pruneInactiveWindows = YES;
+            NSArray<PIDStackData *> *axisStacks = [PIDStackData stacksForAxesFromData:data
+                                                                           windowSize:windowSize
+                                                                              overlap:0.9375
+                                                                               pGains:@[@45.0, @50.0, @55.0]];
+            NSArray<NSArray<NSNumber *> *> *axisPValues = @[data.axisP0 ?: @[], data.axisP1 ?: @[], data.axisP2 ?: @[]];
+
+            // 各轴并行，与分析界面一致；只统计完成的轴的窗口数
+            NSMutableData *windowCounts = [NSMutableData dataWithLength:3 * sizeof(NSInteger)];
+            NSInteger *analyzedWindows = windowCounts.mutableBytes;
+            PIDParallelForEach(MIN(axisStacks.count, 3), ^(size_t axis) {
+                if (axisPValues[axis].count == 0 || axisStacks[axis].windowCount == 0) {
+                    return;
+                }
+                @autoreleasepool {
+                    PIDSpectralCache *cache = [[PIDSpectralCache alloc] initWithStackData:axisStacks[axis]];
+                    PIDResponseResult *response = [analyzer stackResponseWithSpectralCache:cache];
+                    PIDSpectrumResult *spectrum = [analyzer spectrumWithTime:data.timeSeconds spectralCache:cache];
+                    if ((response.stepResponse.count > 0 || response.stepResponseData.length > 0) && spectrum.frequencies.count > 0) {
+                        analyzedWindows[axis] = axisStacks[axis].windowCount;
+                    }
+                }
+            });
+            result.windowCount = analyzedWindows[0] + analyzedWindows[1] + analyzedWindows[2];
         }
     }
 
     // 计时结束
     result.executionTime = [[NSDate date] timeIntervalSinceDate:startTime];
+    PIDAllocationCounters counters = PIDAllocationCountersDelta(PIDAllocationCountersSnapshot(), countersBefore);
+    result.scratchRequests = (NSInteger)counters.scratchRequests;
+    result.heapAllocations = (NSInteger)counters.heapAllocations;
 
     // 记录最终内存
     NSInteger finalMemory = [self getCurrentMemoryUsage];
     result.memoryUsage = finalMemory - initialMemory;
 
-    NSLog(@"⏱️ 性能测试: %@ | 数据点: %ld | 耗时: %.3fs | 内存: %ld KB",
-          result.testName, (long)result.dataSize,
-          result.executionTime, (long)(result.memoryUsage / 1024));
+    NSLog(@"⏱️ 性能测试: %@ | 数据点: %ld | 窗口: %ld | 耗时: %.3fs | 内存: %ld KB | 暂存区分配: %ld (系统 %ld)",
+          result.testName, (long)result.dataSize, (long)result.windowCount,
+          result.executionTime, (long)(result.memoryUsage / 1024),
+          (long)result.scratchRequests, (long)result.heapAllocations);
 
     return result;
 }
@@ -452,6 +3063,9 @@
     }
     avgResult.executionTime = totalTime / iterations;
     avgResult.dataSize = results.firstObject.dataSize;
+    avgResult.windowCount = results.firstObject.windowCount;
+    avgResult.scratchRequests = results.lastObject.scratchRequests;
+    avgResult.heapAllocations = results.lastObject.heapAllocations;
 
     return avgResult;
 }
@@ -7,10 +7,15 @@
 //
 
 #import <UIKit/UIKit.h>
+#import "PIDTraceAnalyzer.h"
 
 NS_ASSUME_NONNULL_BEGIN
 
 @class PIDCSVData;
+@class PIDResponseCurves;
+@class PIDResponseParameters;
+@class PIDNoiseChartView;
+@class PIDNoiseSpectrumData;
 
 /**
  * PID分析主界面
@@ -28,6 +33,10 @@ NS_ASSUME_NONNULL_BEGIN
 // CSV数据（可选，如果已解析）
 @property (nonatomic, strong, nullable) PIDCSVData *csvData;
 
+// 阶跃响应估计方法（默认PIDResponseEstimatorWiener，startAnalysis时读取；外存分析不受影响）
+// 平均互谱只做两次正向FFT/窗口，适合快速查看，与完整方法的偏差见 averagedCrossSpectrumCurvesWithStackData:
+@property (nonatomic, assign) PIDResponseEstimator responseEstimator;
+
 /**
  * 使用CSV文件路径初始化
  */
@@ -43,6 +52,27 @@ NS_ASSUME_NONNULL_BEGIN
  */
 - (void)startAnalysis;
 
+/**
+ * 参数扫描：用本次完整分析保留的各轴窗口频谱，按多组参数（截止频率、响应长度、高输入阈值）重新计算响应曲线
+ * 不重新解析、堆叠和做正向FFT；后台计算，完成后在主线程回调
+ * 流水线/外存分析、内存警告之后或新的分析开始后没有保留的频谱，回调得到空字典
+ * @param parameterSets 参数组
+ * @param completion 键为轴索引，值为与parameterSets顺序相同的响应曲线
+ */
+- (void)evaluateResponseParameterSets:(NSArray<PIDResponseParameters *> *)parameterSets
+                           completion:(void (^)(NSDictionary<NSNumber *, NSArray<PIDResponseCurves *> *> *axisCurves))completion;
+
+/**
+ * 多通道噪声频谱：用本次完整分析保留的堆叠窗口，一次批量FFT计算D项（axisD0-2）、debug（滤波前陀螺仪，debug0-3）
+ * 与rcCommand0-3的噪声频谱；陀螺仪直接取完整分析的结果。全部以float热力图矩阵（不装箱）给出
+ * 后台计算，完成后在主线程把Gyro/Debug/D-term三列交给chartView（debug3与rcCommand只在回调中给出）
+ * 没有保留的频谱时不修改chartView，回调得到空字典；噪声图页的“多通道”按钮用它填充弹出的PIDNoiseChartView
+ * @param chartView 可选：要刷新的噪声图
+ * @param completion 可选：键为通道名（gyroADC0、axisD1、debug3、rcCommand2等），CSV中缺少的通道没有键
+ */
+- (void)loadNoiseChannelsIntoChartView:(nullable PIDNoiseChartView *)chartView
+                            completion:(nullable void (^)(NSDictionary<NSString *, PIDNoiseSpectrumData *> *channelData))completion;
+
 @end
 
 NS_ASSUME_NONNULL_END
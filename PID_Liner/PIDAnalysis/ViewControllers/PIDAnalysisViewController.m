@@ -9,10 +9,26 @@
 #import "PIDAnalysisViewController.h"
 #import "PIDCSVParser.h"
 #import "PIDTraceAnalyzer.h"
+#import "PIDPipelinedAnalyzer.h"
+#import "PIDOutOfCoreAnalyzer.h"
+#import "PIDSessionCatalog.h"
+#import "PIDProgressTelemetry.h"
+#import "PIDCancellationToken.h"
+#import "PIDPolyphaseResampler.h"
+#import "PIDSpectralCache.h"
+#import "PIDParallel.h"
 #import "PIDDataModels.h"
+#import "PIDNoiseChartView.h"
+#import "PIDHeatmapView.h"
 #import <objc/runtime.h>
 #import <AAChartKit/AAChartKit.h>
 
+// 渐进分析：完整重叠下窗口数达到此值才先做粗略预览，短日志直接做完整分析
+static const NSInteger kProgressiveMinWindows = 64;
+
+// 粗略预览的重叠率：窗口步长为完整分析（15/16重叠）的8倍，预览窗口是完整窗口集合的子集
+static const double kPreviewOverlap = 0.5;
+
 @interface PIDAnalysisViewController () <UITabBarControllerDelegate>
 
 // Tab控制器
@@ -31,11 +47,38 @@
 @property (nonatomic, strong) PIDSpectrumResult *pitchSpectrum;
 @property (nonatomic, strong) PIDSpectrumResult *yawSpectrum;
 
+// 外存分析直接给出的各轴响应曲线（不保留逐窗口结果）
+@property (nonatomic, copy) NSArray<PIDResponseCurves *> *axisCurves;
+
+// 各轴的增量响应分析（调整窗口过滤条件时只增减变化的窗口），键为轴索引
+@property (nonatomic, strong) NSMutableDictionary<NSNumber *, PIDIncrementalResponseAnalysis *> *responseAnalyses;
+
+// 完整分析保留的各轴窗口频谱与分析器（参数扫描复用H、G），键为轴索引
+@property (nonatomic, copy, nullable) NSDictionary<NSNumber *, PIDSpectralCache *> *spectralCaches;
+@property (nonatomic, strong, nullable) PIDTraceAnalyzer *sweepAnalyzer;
+
+// 各轴的响应-油门热力图（完整分析或流水线最终快照的逐窗口响应；平均互谱估计与外存分析没有）
+@property (nonatomic, copy, nullable) NSArray<PIDAxisAnalysisResult *> *axisResults;
+
+// 等待完整分析结果的多通道噪声图（流水线分析没有保留窗口频谱，先重新分析）
+@property (nonatomic, weak, nullable) PIDNoiseChartView *pendingNoiseChannelsView;
+
+// 分析摘要指标（写入Session目录，供历史列表直接显示）
+@property (nonatomic, strong) NSMutableDictionary<NSString *, NSNumber *> *headlineMetrics;
+@property (nonatomic, assign) BOOL analysisFinished;
+
 // UI状态
 @property (nonatomic, strong) UIActivityIndicatorView *activityIndicator;
 @property (nonatomic, strong) UILabel *statusLabel;
 @property (nonatomic, strong) UIButton *retryButton;
 
+// 解析/分析进度（后台线程原子更新，状态文字由节流观察者刷新）
+@property (nonatomic, strong) PIDProgressTelemetry *progressTelemetry;
+@property (nonatomic, strong) id<NSObject> progressObserver;
+
+// 当前分析任务的取消令牌（开始新的分析或离开页面时取消，旧任务的结果不再应用）
+@property (nonatomic, strong, nullable) PIDCancellationToken *analysisToken;
+
 @end
 
 @implementation PIDAnalysisViewController
@@ -76,6 +119,19 @@
     }
 }
 
+- (void)viewDidDisappear:(BOOL)animated {
+    [super viewDidDisappear:animated];
+
+    // 页面被关闭时放弃正在进行的分析，后台计算在下一个检查点停止
+    if (self.isMovingFromParentViewController || self.isBeingDismissed) {
+        [self cancelAnalysis];
+    }
+}
+
+- (void)dealloc {
+    [_analysisToken cancel];
+}
+
 - (void)viewDidLayoutSubviews {
     [super viewDidLayoutSubviews];
 
@@ -83,9 +139,20 @@
     [self updateChartsIfNeeded];
 }
 
+- (void)didReceiveMemoryWarning {
+    [super didReceiveMemoryWarning];
+
+    // 增量分析保留了直方图和逐窗口单元，需要时可由响应结果重新建立
+    [_responseAnalyses removeAllObjects];
+
+    // 各轴窗口频谱只用于参数扫描，占用最大
+    _spectralCaches = nil;
+    _sweepAnalyzer = nil;
+}
+
 - (void)updateChartsIfNeeded {
     // 只有在Tab视图可见且有数据时才更新图表
-    if (!_tabBarController.view.hidden && (_rollResponse || _rollSpectrum || _parsedData)) {
+    if (!_tabBarController.view.hidden && (_rollResponse || _rollSpectrum || _parsedData || _axisCurves)) {
         [self updateCharts];
     }
 }
@@ -186,6 +253,24 @@
 
     // 初始隐藏Tab视图
     _tabBarController.view.hidden = YES;
+
+    // 当前Tab页面的导航按钮（导出、估计方法切换）由本页面的导航栏显示
+    self.navigationItem.leftItemsSupplementBackButton = YES;
+    [self showNavigationItemsOfViewController:_responseViewController];
+}
+
+#pragma mark - UITabBarControllerDelegate
+
+- (void)tabBarController:(UITabBarController *)tabBarController didSelectViewController:(UIViewController *)viewController {
+    [self showNavigationItemsOfViewController:viewController];
+}
+
+/**
+ * 嵌入的Tab页面不在导航栈中，它们的navigationItem不会显示，切换Tab时把按钮转到本页面
+ */
+- (void)showNavigationItemsOfViewController:(UIViewController *)viewController {
+    self.navigationItem.leftBarButtonItems = viewController.navigationItem.leftBarButtonItems;
+    self.navigationItem.rightBarButtonItems = viewController.navigationItem.rightBarButtonItems;
 }
 
 - (UIViewController *)createResponseViewController {
@@ -258,11 +343,23 @@
         [contentView.widthAnchor constraintEqualToAnchor:scrollView.widthAnchor]
     ]];
 
-    // 添加导出按钮
-    vc.navigationItem.rightBarButtonItem = [[UIBarButtonItem alloc]
-        initWithBarButtonSystemItem:UIBarButtonSystemItemAction
+    // 添加导出按钮与响应-油门热力图
+    vc.navigationItem.rightBarButtonItems = @[
+        [[UIBarButtonItem alloc] initWithBarButtonSystemItem:UIBarButtonSystemItemAction
+                                                      target:self
+                                                      action:@selector(exportResponseChart)],
+        [[UIBarButtonItem alloc] initWithTitle:@"油门热图"
+                                         style:UIBarButtonItemStylePlain
+                                        target:self
+                                        action:@selector(showThrottleResponse)]
+    ];
+
+    // 阶跃响应估计方法切换（逐窗口维纳 / 平均互谱）
+    vc.navigationItem.leftBarButtonItem = [[UIBarButtonItem alloc]
+        initWithTitle:[self titleForResponseEstimator:_responseEstimator]
+        style:UIBarButtonItemStylePlain
         target:self
-        action:@selector(exportResponseChart)];
+        action:@selector(toggleResponseEstimator:)];
 
     return vc;
 }
@@ -294,6 +391,13 @@
         target:self
         action:@selector(exportNoiseChart)];
 
+    // 多通道噪声图（Gyro/Debug/D-term三列热力图，批量频谱）
+    vc.navigationItem.leftBarButtonItem = [[UIBarButtonItem alloc]
+        initWithTitle:@"多通道"
+        style:UIBarButtonItemStylePlain
+        target:self
+        action:@selector(showNoiseChannels)];
+
     return vc;
 }
 
@@ -301,34 +405,166 @@
 
 /**
  * 解析并分析CSV数据
+ * 使用流水线分析器：解析与窗口分析重叠进行，中间结果逐步刷新到图表
  */
 - (void)parseAndAnalyze {
     [_activityIndicator startAnimating];
     _statusLabel.text = @"正在解析CSV...";
+    _statusLabel.hidden = NO;
+    _retryButton.hidden = YES;
+
+    // 超长日志在内存中放不下，改用固定内存预算的外存分析
+    if ([PIDOutOfCoreAnalyzer shouldAnalyzeFileOutOfCore:_csvFilePath]) {
+        [self analyzeOutOfCore];
+        return;
+    }
+
+    PIDCancellationToken *token = [self beginAnalysisTask];
+    // 分析完成后还要显示原始曲线和重新分析，保留解析数据
+    PIDPipelineConfig *config = [PIDPipelineConfig defaultConfig];
+    config.retainsParsedData = YES;
+    PIDPipelinedAnalyzer *pipeline = [[PIDPipelinedAnalyzer alloc] initWithConfig:config];
+    pipeline.telemetry = [self beginProgressWithStatus:@"正在解析CSV"];
+    pipeline.cancellationToken = token;
+    __weak typeof(self) weakSelf = self;
+    pipeline.snapshotHandler = ^(PIDPipelineSnapshot *snapshot) {
+        if ([weakSelf isCurrentAnalysisTask:token]) {
+            [weakSelf applyPipelineSnapshot:snapshot];
+        }
+    };
 
     dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
         @try {
-            // 解析CSV
-            PIDCSVParser *parser = [PIDCSVParser parser];
-            PIDCSVData *data = [parser parseCSV:self->_csvFilePath];
+            PIDPipelineSnapshot *snapshot = [pipeline analyzeCSVFile:self->_csvFilePath];
+            NSArray<PIDAxisAnalysisResult *> *axisResults = nil;
+            if (snapshot.responses.count > 0 && !token.isCancelled) {
+                double sampleRate = snapshot.data.sampleRate > 0 ? snapshot.data.sampleRate : 8000.0;
+                PIDTraceAnalyzer *analyzer = [[PIDTraceAnalyzer alloc] initWithSampleRate:sampleRate cutFreq:25.0];
+                axisResults = [self throttleResponsesOfResponses:snapshot.responses analyzer:analyzer];
+            }
 
             dispatch_async(dispatch_get_main_queue(), ^{
-                self->_parsedData = data;
-
-                if (self->_parsedData && self->_parsedData.timeSeconds.count > 0) {
-                    [self startAnalysis];
+                if (![self isCurrentAnalysisTask:token]) {
+                    return;
+                }
+                if (snapshot && snapshot.data.timeSeconds.count > 0) {
+                    self->_parsedData = snapshot.data;
+                    self->_analysisFinished = YES;
+                    self.axisResults = axisResults;
+                    [self applyPipelineSnapshot:snapshot];
+                    self.title = @"PID分析";
+                    [self showAnalysisComplete];
                 } else {
-                    [self showError:@"CSV解析失败，文件可能已损坏"];
+                    [self showError:pipeline.lastErrorMessage ?: @"CSV解析失败，文件可能已损坏"];
                 }
             });
         } @catch (NSException *exception) {
             dispatch_async(dispatch_get_main_queue(), ^{
-                [self showError:exception.reason];
+                if ([self isCurrentAnalysisTask:token]) {
+                    [self showError:exception.reason];
+                }
             });
         }
     });
 }
 
+/**
+ * 外存分析（超长日志）
+ * 结果只有各轴曲线和平均频谱，分析完成后一次性显示
+ */
+- (void)analyzeOutOfCore {
+    _statusLabel.text = @"日志较大，正在低内存模式分析...";
+
+    PIDCancellationToken *token = [self beginAnalysisTask];
+    PIDOutOfCoreAnalyzer *analyzer = [[PIDOutOfCoreAnalyzer alloc] initWithConfig:[PIDOutOfCoreConfig defaultConfig]];
+    analyzer.telemetry = [self beginProgressWithStatus:@"日志较大，正在低内存模式分析"];
+    analyzer.cancellationToken = token;
+
+    dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+        PIDOutOfCoreResult *result = [analyzer analyzeCSVFile:self->_csvFilePath];
+
+        dispatch_async(dispatch_get_main_queue(), ^{
+            if (![self isCurrentAnalysisTask:token]) {
+                return;
+            }
+            if (!result || result.rowCount == 0) {
+                [self showError:analyzer.lastErrorMessage ?: @"CSV解析失败，文件可能已损坏"];
+                return;
+            }
+
+            self->_axisCurves = result.curves;
+            if (result.spectrums.count >= 3) {
+                self->_rollSpectrum = result.spectrums[0];
+                self->_pitchSpectrum = result.spectrums[1];
+                self->_yawSpectrum = result.spectrums[2];
+            }
+            self->_analysisFinished = YES;
+            self.title = @"PID分析";
+            [self showAnalysisComplete];
+            [self updateCharts];
+        });
+    });
+}
+
+/**
+ * 应用流水线快照（主线程）
+ * 第一份中间结果到达时即显示图表，之后每份快照刷新一次
+ * 中间快照只带新窗口，追加到已有结果和对应的增量分析上；最终快照带全部窗口，直接替换
+ */
+- (void)applyPipelineSnapshot:(PIDPipelineSnapshot *)snapshot {
+    if (snapshot.responses.count >= 3) {
+        if (snapshot.isFinished) {
+            _rollResponse = snapshot.responses[0];
+            _pitchResponse = snapshot.responses[1];
+            _yawResponse = snapshot.responses[2];
+        } else {
+            _rollResponse = [self mergeResponseDelta:snapshot.responses[0] axis:0
+                                       intoResponse:_rollResponse firstWindowIndex:snapshot.firstWindowIndex];
+            _pitchResponse = [self mergeResponseDelta:snapshot.responses[1] axis:1
+                                        intoResponse:_pitchResponse firstWindowIndex:snapshot.firstWindowIndex];
+            _yawResponse = [self mergeResponseDelta:snapshot.responses[2] axis:2
+                                      intoResponse:_yawResponse firstWindowIndex:snapshot.firstWindowIndex];
+        }
+    }
+
+    if (snapshot.spectrums.count >= 3) {
+        _rollSpectrum = snapshot.spectrums[0];
+        _pitchSpectrum = snapshot.spectrums[1];
+        _yawSpectrum = snapshot.spectrums[2];
+    }
+
+    if (!snapshot.isFinished) {
+        self.title = [NSString stringWithFormat:@"PID分析 (已分析%ld个窗口)", (long)snapshot.windowCount];
+        if (_tabBarController.view.hidden) {
+            [_activityIndicator stopAnimating];
+            _statusLabel.hidden = YES;
+            _tabBarController.view.hidden = NO;
+        }
+    }
+
+    [self updateCharts];
+}
+
+/**
+ * 把中间快照的新窗口并入已有结果
+ * 第一份快照直接采用；之后原地追加，该轴的增量分析若建立在这份结果上也一并追加，不必重建
+ */
+- (PIDResponseResult *)mergeResponseDelta:(PIDResponseResult *)delta
+                                     axis:(NSInteger)axis
+                             intoResponse:(nullable PIDResponseResult *)response
+                         firstWindowIndex:(NSInteger)firstWindowIndex {
+    if (firstWindowIndex == 0 || !response) {
+        return delta;
+    }
+
+    [response appendWindowsFromResult:delta];
+    PIDIncrementalResponseAnalysis *analysis = _responseAnalyses[@(axis)];
+    if (analysis.responseResult == response) {
+        [analysis appendWindowsFromResult:delta];
+    }
+    return response;
+}
+
 /**
  * 开始分析
  */
@@ -342,113 +578,243 @@
     _statusLabel.text = @"正在分析PID数据...";
     _retryButton.hidden = YES;
 
+    PIDCancellationToken *token = [self beginAnalysisTask];
+    PIDCSVData *data = _parsedData;
+    PIDResponseEstimator estimator = _responseEstimator;
     dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
-        [self performAnalysis];
+        [self performAnalysisOfData:data token:token estimator:estimator];
     });
 }
 
 /**
  * 执行分析（后台线程）
+ * 窗口较多时渐进进行：先用50%重叠（完整窗口集合每8个取1个）做粗略分析并立即显示预览，
+ * 再用完整重叠重新分析并替换结果；令牌取消后两遍都在下一个检查点停止，结果不再应用
+ * @param data 主线程取出的解析数据；重采样结果只在本地使用，完整结果应用时才在主线程写回 _parsedData
+ * @param estimator 主线程取出的响应估计方法；平均互谱时各轴直接得到响应曲线，不做逐窗口反卷积
  */
-- (void)performAnalysis {
+- (void)performAnalysisOfData:(PIDCSVData *)data
+                        token:(PIDCancellationToken *)token
+                    estimator:(PIDResponseEstimator)estimator {
     @try {
         // 🔥 关键修复：使用实际采样率而非硬编码的8000Hz
         // 实际数据可能来自不同采样率的黑盒子日志（如931Hz, 1kHz, 8kHz等）
-        double actualSampleRate = _parsedData.sampleRate > 0 ? _parsedData.sampleRate : 8000.0;
+        double actualSampleRate = data.sampleRate > 0 ? data.sampleRate : 8000.0;
         NSLog(@"🔍 [分析] 使用实际采样率: %.2fHz", actualSampleRate);
 
+        // 重采样到规范分析采样率（1k/2k/4k/8k），窗口保持1秒、响应保持0.5秒
+        // 已经是规范采样率的数据（包括流水线分析后保存的数据）不会重复重采样
+        PIDPolyphaseResampler *resampler = [PIDPolyphaseResampler resamplerForSampleRate:actualSampleRate];
+        if (resampler) {
+            data = [resampler resampleData:data];
+            actualSampleRate = resampler.outputRate;
+        }
+        double analysisRate = [PIDPolyphaseResampler analysisRateForSampleRate:actualSampleRate];
+
         // 🔧 修正：Python使用cutfreq=25Hz而非150Hz
         PIDTraceAnalyzer *analyzer = [[PIDTraceAnalyzer alloc]
             initWithSampleRate:actualSampleRate
             cutFreq:25.0];
+        analyzer.cancellationToken = token;
+        // 只使用响应曲线：无输入的窗口（地面怠速、降落尾段）跳过反卷积，曲线不变
+        analyzer.pruneInactiveWindows = YES;
+        // 单精度快速路径（与流水线相同），与float64参考的偏差由PIDAlgorithmVerifier的精度策略检查保证
+        analyzer.precision = PIDDSPPrecisionFloat32;
 
         // 🔧 修正：Python使用superpos=16，对应overlap=15/16=0.9375
-        // 🔥 关键：窗口大小保持固定值 8000，确保 FFT 分辨率和信号质量
-        // - 如果根据采样率动态计算 windowSize，会导致：
-        //   1. FFT 分辨率降低（windowSize 越小，频率分辨率越低）
-        //   2. 反卷积结果列数减少（columnCount = windowSize/2）
-        //   3. 信号能量大幅减少（窗函数能量与 windowSize 成正比）
-        // - 正确做法：保持 windowSize 固定，只修正时间轴计算
-        // TODO: 理想情况下应该重采样数据到 8kHz，但当前保持 windowSize=8000
-        NSInteger windowSize = 8000;  // 固定窗口大小（用于 FFT/反卷积）
+        // 窗口时长固定为1秒（Python framelen），点数随分析采样率变化：
+        // 频率分辨率仍为1Hz，低采样率日志的FFT长度和内存按比例减小
+        NSInteger windowSize = [PIDPolyphaseResampler windowSize:8000 forAnalysisRate:analysisRate];
         double overlap = 0.9375;
 
-        // 分析每个轴
-        NSMutableArray<PIDResponseResult *> *responses = [NSMutableArray array];
-        NSMutableArray<PIDSpectrumResult *> *spectrums = [NSMutableArray array];
-
-        NSArray<NSNumber *> *axisP0 = _parsedData.axisP0;
-        NSArray<NSNumber *> *axisP1 = _parsedData.axisP1;
-        NSArray<NSNumber *> *axisP2 = _parsedData.axisP2;
-
-        // Roll (轴0)
-        if (axisP0 && axisP0.count > 0) {
-            [self analyzeAxis:0
-                withPValues:axisP0
-                analyzer:analyzer
-                windowSize:windowSize
-                overlap:overlap
-                responses:responses
-                spectrums:spectrums];
-        }
-
-        // Pitch (轴1)
-        if (axisP1 && axisP1.count > 0) {
-            [self analyzeAxis:1
-                withPValues:axisP1
-                analyzer:analyzer
-                windowSize:windowSize
-                overlap:overlap
-                responses:responses
-                spectrums:spectrums];
+        NSInteger fullWindows = [PIDStackData windowCountForSampleCount:data.timeSeconds.count
+                                                             windowSize:windowSize
+                                                                overlap:overlap];
+        if (fullWindows >= kProgressiveMinWindows) {
+            NSMutableArray<PIDResponseResult *> *previewResponses = [NSMutableArray arrayWithCapacity:3];
+            NSMutableArray<PIDSpectrumResult *> *previewSpectrums = [NSMutableArray arrayWithCapacity:3];
+            NSMutableArray<PIDResponseCurves *> *previewCurves =
+                estimator == PIDResponseEstimatorAveragedCrossSpectrum ? [NSMutableArray arrayWithCapacity:3] : nil;
+            [self analyzeAxesOfData:data
+                       analyzer:analyzer
+                     windowSize:windowSize
+                        overlap:kPreviewOverlap
+                      responses:previewResponses
+                      spectrums:previewSpectrums
+                         curves:previewCurves
+                 spectralCaches:nil];
+            if (token.isCancelled) {
+                return;
+            }
+            NSLog(@"🔍 [分析] 预览完成，开始完整重叠分析");
+            dispatch_async(dispatch_get_main_queue(), ^{
+                if ([self isCurrentAnalysisTask:token]) {
+                    [self applyResponses:previewResponses spectrums:previewSpectrums curves:previewCurves finished:NO];
+                }
+            });
         }
 
-        // Yaw (轴2)
-        if (axisP2 && axisP2.count > 0) {
-            [self analyzeAxis:2
-                withPValues:axisP2
-                analyzer:analyzer
-                windowSize:windowSize
-                overlap:overlap
-                responses:responses
-                spectrums:spectrums];
+        NSMutableArray<PIDResponseResult *> *responses = [NSMutableArray arrayWithCapacity:3];
+        NSMutableArray<PIDSpectrumResult *> *spectrums = [NSMutableArray arrayWithCapacity:3];
+        NSMutableArray<PIDResponseCurves *> *curves =
+            estimator == PIDResponseEstimatorAveragedCrossSpectrum ? [NSMutableArray arrayWithCapacity:3] : nil;
+        NSMutableDictionary<NSNumber *, PIDSpectralCache *> *spectralCaches = [NSMutableDictionary dictionary];
+        [self analyzeAxesOfData:data
+                       analyzer:analyzer
+                     windowSize:windowSize
+                        overlap:overlap
+                      responses:responses
+                      spectrums:spectrums
+                         curves:curves
+                 spectralCaches:spectralCaches];
+        if (token.isCancelled) {
+            NSLog(@"⏹ [分析] 已取消");
+            return;
         }
+        NSArray<PIDAxisAnalysisResult *> *axisResults = [self throttleResponsesOfResponses:responses analyzer:analyzer];
 
         // 回到主线程更新UI
         dispatch_async(dispatch_get_main_queue(), ^{
-            if (responses.count >= 3) {
-                self->_rollResponse = responses[0];
-                self->_pitchResponse = responses[1];
-                self->_yawResponse = responses[2];
-            }
-
-            if (spectrums.count >= 3) {
-                self->_rollSpectrum = spectrums[0];
-                self->_pitchSpectrum = spectrums[1];
-                self->_yawSpectrum = spectrums[2];
+            if ([self isCurrentAnalysisTask:token]) {
+                self->_parsedData = data;
+                self.spectralCaches = spectralCaches;
+                self.sweepAnalyzer = analyzer;
+                self.axisResults = axisResults;
+                [self applyResponses:responses spectrums:spectrums curves:curves finished:YES];
+                if (self.pendingNoiseChannelsView) {
+                    [self loadNoiseChannelsIntoChartView:self.pendingNoiseChannelsView completion:nil];
+                    self.pendingNoiseChannelsView = nil;
+                }
             }
-
-            [self updateCharts];
-            [self showAnalysisComplete];
         });
 
     } @catch (NSException *exception) {
         dispatch_async(dispatch_get_main_queue(), ^{
-            [self showError:exception.reason];
+            if ([self isCurrentAnalysisTask:token]) {
+                [self showError:exception.reason];
+            }
         });
     }
 }
 
+/**
+ * 按给定重叠率分析三个轴（后台线程）
+ * 三个轴并行（轴内的窗口也按块并行），结果按轴索引写入固定位置
+ * @param curves 可选：传入时用平均互谱估计直接得到各轴响应曲线，responses保持为空结果
+ * @param spectralCaches 可选：收集各轴的频谱缓存（供参数扫描复用）
+ */
+- (void)analyzeAxesOfData:(PIDCSVData *)data
+                 analyzer:(PIDTraceAnalyzer *)analyzer
+               windowSize:(NSInteger)windowSize
+                  overlap:(double)overlap
+                responses:(NSMutableArray<PIDResponseResult *> *)responses
+                spectrums:(NSMutableArray<PIDSpectrumResult *> *)spectrums
+                   curves:(nullable NSMutableArray<PIDResponseCurves *> *)curves
+           spectralCaches:(nullable NSMutableDictionary<NSNumber *, PIDSpectralCache *> *)spectralCaches {
+    for (NSInteger axis = 0; axis < 3; axis++) {
+        [responses addObject:[[PIDResponseResult alloc] init]];
+        [spectrums addObject:[[PIDSpectrumResult alloc] init]];
+        [curves addObject:[[PIDResponseCurves alloc] init]];
+    }
+
+    NSArray<NSArray<NSNumber *> *> *axisPValues = @[data.axisP0 ?: @[],
+                                                    data.axisP1 ?: @[],
+                                                    data.axisP2 ?: @[]];
+
+    // 三个轴一遍堆叠（4路交错拆箱与PID输入），油门/时间列与加窗统计量各轴共用
+    // 不同轴的P增益值：Roll=45, Pitch=50, Yaw=55（常见配置，后续可从CSV头解析）
+    NSArray<PIDStackData *> *axisStacks = [PIDStackData stacksForAxesFromData:data
+                                                                   windowSize:windowSize
+                                                                      overlap:overlap
+                                                                       pGains:@[@45.0, @50.0, @55.0]];
+
+    PIDParallelForEach(3, ^(size_t axis) {
+        NSArray<NSNumber *> *pValues = axisPValues[axis];
+        if (pValues.count == 0 || analyzer.cancellationToken.isCancelled) {
+            return;
+        }
+        @autoreleasepool {
+            // 🔧 修正：Python使用Hanning窗而非Tukey窗
+            // 频谱缓存记录Hanning窗，加窗后的陀螺仪频谱由响应分析和噪声频谱共用
+            PIDSpectralCache *spectralCache = [[PIDSpectralCache alloc] initWithStackData:axisStacks[axis]];
+            [self analyzeAxis:(NSInteger)axis
+                       ofData:data
+                  withPValues:pValues
+                     analyzer:analyzer
+                spectralCache:spectralCache
+                    responses:responses
+                    spectrums:spectrums
+                       curves:curves];
+            @synchronized (spectralCaches) {
+                spectralCaches[@(axis)] = spectralCache;
+            }
+        }
+    });
+}
+
+/**
+ * 应用分析结果（主线程）
+ * 预览结果先显示图表，完整结果到达后整体替换
+ * @param curves 平均互谱估计的各轴响应曲线（逐窗口路径为nil）
+ */
+- (void)applyResponses:(NSArray<PIDResponseResult *> *)responses
+             spectrums:(NSArray<PIDSpectrumResult *> *)spectrums
+                curves:(nullable NSArray<PIDResponseCurves *> *)curves
+              finished:(BOOL)finished {
+    if (responses.count >= 3) {
+        _rollResponse = responses[0];
+        _pitchResponse = responses[1];
+        _yawResponse = responses[2];
+    }
+
+    if (spectrums.count >= 3) {
+        _rollSpectrum = spectrums[0];
+        _pitchSpectrum = spectrums[1];
+        _yawSpectrum = spectrums[2];
+    }
+
+    // 有曲线时 responseCurvesForAxis: 直接使用，不再由逐窗口结果建立增量分析
+    _axisCurves = [curves copy];
+
+    // 预览结果不写入Session摘要指标
+    _analysisFinished = finished;
+    self.title = finished ? @"PID分析" : @"PID分析 (预览)";
+
+    [self updateCharts];
+    [self showAnalysisComplete];
+}
+
+/**
+ * 各轴的响应-油门热力图（后台线程）
+ * 按窗口最大油门把逐窗口阶跃响应分层；没有逐窗口响应的轴（平均互谱估计）不填充热力图
+ */
+- (NSArray<PIDAxisAnalysisResult *> *)throttleResponsesOfResponses:(NSArray<PIDResponseResult *> *)responses
+                                                          analyzer:(PIDTraceAnalyzer *)analyzer {
+    NSArray<NSString *> *axisNames = @[@"Roll", @"Pitch", @"Yaw"];
+    NSMutableArray<PIDAxisAnalysisResult *> *axisResults = [NSMutableArray arrayWithCapacity:3];
+    for (NSInteger axis = 0; axis < (NSInteger)MIN(responses.count, axisNames.count); axis++) {
+        PIDAxisAnalysisResult *axisResult = [[PIDAxisAnalysisResult alloc] init];
+        axisResult.axisIndex = axis;
+        axisResult.axisName = axisNames[axis];
+        [analyzer fillThrottleResponseForAxisResult:axisResult fromResponseResult:responses[axis]];
+        [axisResults addObject:axisResult];
+    }
+    return axisResults;
+}
+
 /**
  * 分析单个轴
+ * @param curves 可选：传入时用平均互谱估计得到响应曲线，代替逐窗口反卷积
  */
 - (void)analyzeAxis:(NSInteger)axisIndex
+             ofData:(PIDCSVData *)data
           withPValues:(NSArray<NSNumber *> *)pValues
             analyzer:(PIDTraceAnalyzer *)analyzer
-          windowSize:(NSInteger)windowSize
-             overlap:(double)overlap
+       spectralCache:(PIDSpectralCache *)spectralCache
             responses:(NSMutableArray<PIDResponseResult *> *)responses
-           spectrums:(NSMutableArray<PIDSpectrumResult *> *)spectrums {
+           spectrums:(NSMutableArray<PIDSpectrumResult *> *)spectrums
+              curves:(nullable NSMutableArray<PIDResponseCurves *> *)curves {
+    PIDStackData *stackData = spectralCache.stackData;
 
     // 获取对应轴的数据
     NSArray<NSNumber *> *rcCommand = nil;
@@ -456,16 +822,16 @@
 
     switch (axisIndex) {
         case 0:
-            rcCommand = _parsedData.rcCommand0;
-            gyroADC = _parsedData.gyroADC0;
+            rcCommand = data.rcCommand0;
+            gyroADC = data.gyroADC0;
             break;
         case 1:
-            rcCommand = _parsedData.rcCommand1;
-            gyroADC = _parsedData.gyroADC1;
+            rcCommand = data.rcCommand1;
+            gyroADC = data.gyroADC1;
             break;
         case 2:
-            rcCommand = _parsedData.rcCommand2;
-            gyroADC = _parsedData.gyroADC2;
+            rcCommand = data.rcCommand2;
+            gyroADC = data.gyroADC2;
             break;
     }
 
@@ -487,9 +853,9 @@
     // 检查axisP数据
     NSArray<NSNumber *> *axisP = nil;
     switch (axisIndex) {
-        case 0: axisP = _parsedData.axisP0; break;
-        case 1: axisP = _parsedData.axisP1; break;
-        case 2: axisP = _parsedData.axisP2; break;
+        case 0: axisP = data.axisP0; break;
+        case 1: axisP = data.axisP1; break;
+        case 2: axisP = data.axisP2; break;
     }
     NSLog(@"   axisP.count=%lu, 前3个值: %@, %@, %@",
           (unsigned long)axisP.count,
@@ -497,22 +863,6 @@
           axisP.count > 1 ? axisP[1] : @"N/A",
           axisP.count > 2 ? axisP[2] : @"N/A");
 
-    // 🔧 修正：添加pGain参数（使用默认值45，后续可从CSV头解析）
-    // 不同轴的P增益值：Roll=45, Pitch=50, Yaw=55（常见配置）
-    double pGain = 45.0;
-    switch (axisIndex) {
-        case 0: pGain = 45.0; break;  // Roll
-        case 1: pGain = 50.0; break;  // Pitch
-        case 2: pGain = 55.0; break;  // Yaw
-    }
-
-    // 创建指定轴的堆叠窗口数据
-    PIDStackData *stackData = [PIDStackData stackFromData:_parsedData
-                                                 axisIndex:axisIndex
-                                                windowSize:windowSize
-                                                  overlap:overlap
-                                                     pGain:pGain];
-
     // 验证堆叠数据
     if (stackData.windowCount == 0) {
         NSLog(@"⚠️ 轴%ld堆叠数据为空", (long)axisIndex);
@@ -542,29 +892,45 @@
               firstGyro.count > 4 ? firstGyro[4] : @"N/A");
     }
 
-    // 🔧 修正：Python使用Hanning窗而非Tukey窗
-    // 生成Hanning窗函数（用于stackResponse分析）
-    NSArray<NSNumber *> *window = [PIDTraceAnalyzer hanningWindowWithLength:windowSize];
+    // 平均互谱估计：每组一次除法和逆FFT，直接得到低/高输入响应曲线
+    if (curves) {
+        PIDResponseCurves *axisCurves = [analyzer averagedCrossSpectrumCurvesWithStackData:stackData];
+        if (axisCurves) {
+            @synchronized (curves) {
+                curves[axisIndex] = axisCurves;
+            }
+        } else {
+            NSLog(@"⚠️ 轴%ld平均互谱响应失败", (long)axisIndex);
+        }
+    }
 
     // 响应分析 - 调用stackResponse获取阶跃响应结果
-    PIDResponseResult *response = [analyzer stackResponse:stackData window:window];
+    PIDResponseResult *response = curves ? nil : [analyzer stackResponseWithSpectralCache:spectralCache];
     if (response && response.stepResponse.count > 0) {
-        // 确保responses数组有足够空间
-        while (responses.count <= axisIndex) {
-            [responses addObject:[[PIDResponseResult alloc] init]];
+        // 各轴并行分析，写入共享结果数组时加锁（每个轴只写自己的位置）
+        @synchronized (responses) {
+            while (responses.count <= axisIndex) {
+                [responses addObject:[[PIDResponseResult alloc] init]];
+            }
+            responses[axisIndex] = response;
         }
-        responses[axisIndex] = response;
         NSLog(@"✅ 轴%ld响应分析完成: stepResponse.count=%lu",
               (long)axisIndex, (unsigned long)response.stepResponse.count);
-    } else {
+    } else if (!curves) {
         NSLog(@"⚠️ 轴%ld响应分析失败", (long)axisIndex);
     }
 
     // 频谱分析
-    PIDSpectrumResult *spectrum = [analyzer spectrumWithTime:_parsedData.timeSeconds
-                                                        traces:stackData.gyro];
-    if (spectrums.count <= axisIndex) {
-        [spectrums addObject:spectrum];
+    PIDSpectrumResult *spectrum = [analyzer spectrumWithTime:data.timeSeconds
+                                                 spectralCache:spectralCache];
+    if (!spectrum) {
+        return;
+    }
+    @synchronized (spectrums) {
+        while (spectrums.count <= axisIndex) {
+            [spectrums addObject:[[PIDSpectrumResult alloc] init]];
+        }
+        spectrums[axisIndex] = spectrum;
     }
 }
 
@@ -591,7 +957,7 @@
 
     // 检查视图是否已布局（frame不为0）
     if (firstChartView && firstChartView.bounds.size.width > 0 && firstChartView.bounds.size.height > 0) {
-        if (_rollResponse || _pitchResponse || _yawResponse) {
+        if (_rollResponse || _pitchResponse || _yawResponse || _axisCurves) {
             [self configureResponseCharts];
         } else if (_parsedData) {
             [self configureResponseCharts];
@@ -649,7 +1015,7 @@
     static char const *const kChartViewKeys[] = {"aaChartView0", "aaChartView1", "aaChartView2"};
 
     // 检查是否有响应数据
-    if (!_rollResponse && !_pitchResponse && !_yawResponse) {
+    if (!_rollResponse && !_pitchResponse && !_yawResponse && _axisCurves.count == 0) {
         // 显示空状态
         for (NSInteger i = 0; i < 3; i++) {
             AAChartView *chartView = objc_getAssociatedObject(_responseViewController, kChartViewKeys[i]);
@@ -661,9 +1027,42 @@
     }
 
     // 配置每个轴的图表
-    [self configureSingleAxisChart:0 responseResult:_rollResponse axisName:@"Roll" color:@"#FF6B6B"];
-    [self configureSingleAxisChart:1 responseResult:_pitchResponse axisName:@"Pitch" color:@"#4ECDC4"];
-    [self configureSingleAxisChart:2 responseResult:_yawResponse axisName:@"Yaw" color:@"#95E1D3"];
+    [self configureSingleAxisChart:0 curves:[self responseCurvesForAxis:0] axisName:@"Roll" color:@"#FF6B6B"];
+    [self configureSingleAxisChart:1 curves:[self responseCurvesForAxis:1] axisName:@"Pitch" color:@"#4ECDC4"];
+    [self configureSingleAxisChart:2 curves:[self responseCurvesForAxis:2] axisName:@"Yaw" color:@"#95E1D3"];
+
+    // 最终结果的摘要指标写入Session目录
+    if (_analysisFinished && _csvFilePath && _headlineMetrics.count > 0) {
+        [[PIDSessionCatalog sharedCatalog] updateMetrics:_headlineMetrics forFilePath:_csvFilePath];
+    }
+}
+
+/**
+ * 获取单个轴的响应曲线
+ * 外存分析直接给出曲线；否则由逐窗口响应结果建立增量分析，
+ * 之后调整过滤条件只需增减状态变化的窗口
+ */
+- (PIDResponseCurves *)responseCurvesForAxis:(NSInteger)axisIndex {
+    if (axisIndex < _axisCurves.count) {
+        return _axisCurves[axisIndex];
+    }
+
+    PIDResponseResult *responseResult = axisIndex == 0 ? _rollResponse
+                                      : (axisIndex == 1 ? _pitchResponse : _yawResponse);
+    if (!responseResult) {
+        return nil;
+    }
+
+    if (!_responseAnalyses) {
+        _responseAnalyses = [NSMutableDictionary dictionary];
+    }
+    PIDIncrementalResponseAnalysis *analysis = _responseAnalyses[@(axisIndex)];
+    if (analysis.responseResult != responseResult) {
+        // 结果已更新（流水线快照或重新分析）：重新建立
+        analysis = [[PIDIncrementalResponseAnalysis alloc] initWithResponseResult:responseResult];
+        _responseAnalyses[@(axisIndex)] = analysis;
+    }
+    return [analysis currentCurves];
 }
 
 /**
@@ -671,12 +1070,12 @@
  * 🔑 修复版本：使用low_high_mask分离低/高输入响应，显示两条曲线
  *
  * @param axisIndex 轴索引 (0=Roll, 1=Pitch, 2=Yaw)
- * @param responseResult 响应结果对象
+ * @param curves 低/高输入响应曲线
  * @param axisName 轴名称
  * @param color 图表颜色 (HEX) - 仅用于低输入曲线，高输入曲线自动使用橙色
  */
 - (void)configureSingleAxisChart:(NSInteger)axisIndex
-                  responseResult:(PIDResponseResult *)responseResult
+                          curves:(PIDResponseCurves *)curves
                         axisName:(NSString *)axisName
                            color:(NSString *)color {
 
@@ -698,163 +1097,31 @@
     }
 
     // 检查是否有响应数据
-    if (!responseResult || !responseResult.stepResponse || responseResult.stepResponse.count == 0) {
+    if (!curves || curves.windowCount == 0) {
         [self showEmptyStateChart:chartView message:[NSString stringWithFormat:@"暂无%@响应数据", axisName]];
         return;
     }
 
-    NSInteger windowCount = responseResult.stepResponse.count;
-    if (windowCount == 0) {
-        [self showEmptyStateChart:chartView message:[NSString stringWithFormat:@"%@响应数据为空", axisName]];
-        return;
-    }
-
-    // 🔑🔑🔑 关键修复：实现Python的数据分离逻辑 🔑🔑🔑
-    // Python: low_mask, high_mask = low_high_mask(max_in, threshold)
-    //         toolow_mask = low_high_mask(max_in, 20)[1]
-    //         resp_low_mask = low_mask * toolow_mask
-    //         resp_high_mask = high_mask * toolow_mask
-
-    // 1. 计算low/high mask (threshold=500)
-    NSDictionary *masks = [PIDTraceAnalyzer lowHighMask:responseResult.maxInput threshold:500.0];
-    NSArray<NSNumber *> *lowMask = masks[@"low"];
-    NSArray<NSNumber *> *highMask = masks[@"high"];
-
-    // 2. 计算toolow_mask (threshold=20)
-    // Python: toolow_mask = low_high_mask(max_in, 20)[1] (取high部分，即>20)
-    NSDictionary *tooLowMasks = [PIDTraceAnalyzer lowHighMask:responseResult.maxInput threshold:20.0];
-    NSArray<NSNumber *> *toolowMask = tooLowMasks[@"high"];  // 取high部分（>20）
-
-    // 3. 组合mask
-    NSMutableArray<NSNumber *> *respLowMask = [NSMutableArray array];
-    NSMutableArray<NSNumber *> *respHighMask = [NSMutableArray array];
-
-    for (NSInteger i = 0; i < MIN(lowMask.count, toolowMask.count); i++) {
-        double lowVal = [lowMask[i] doubleValue];
-        double toolowVal = [toolowMask[i] doubleValue];
-        [respLowMask addObject:@(lowVal * toolowVal)];  // low AND toolow
-    }
-
-    for (NSInteger i = 0; i < MIN(highMask.count, toolowMask.count); i++) {
-        double highVal = [highMask[i] doubleValue];
-        double toolowVal = [toolowMask[i] doubleValue];
-        [respHighMask addObject:@(highVal * toolowVal)];  // high AND toolow
-    }
-
-    // 4. 计算分离的响应曲线
-    NSArray<NSNumber *> *vertRange = @[@(-1.5), @(3.5)];
-    // 🔥 使用实际采样率
-    double sampleRate = _parsedData.sampleRate > 0 ? _parsedData.sampleRate : 8000.0;
-
-    // 🔥 新增：质量过滤机制（对应Python的resp_quality）
-    // 第一步：使用初步mask计算初始平均响应
-    NSArray<NSNumber *> *respLowInitial = [PIDTraceAnalyzer weightedModeAverageWithStepResponse:
-        responseResult.stepResponse
-        avgTime:responseResult.avgTime
-        dataMask:respLowMask  // 使用low mask
-        vertRange:vertRange
-        vertBins:1000
-        sampleRate:sampleRate];
-
-    // 第二步：计算响应质量mask（过滤偏离平均响应过大的窗口）
-    NSArray<NSNumber *> *qualityMask = [PIDTraceAnalyzer calculateResponseQualityMask:
-        responseResult.stepResponse
-        referenceResponse:respLowInitial];
-
-    // 第三步：组合low mask和quality mask
-    NSArray<NSNumber *> *respLowMaskCombined = [PIDTraceAnalyzer combineMasks:respLowMask withMask:qualityMask];
-
-    // 第四步：使用组合后的mask重新计算最终响应
-    NSArray<NSNumber *> *respLow = [PIDTraceAnalyzer weightedModeAverageWithStepResponse:
-        responseResult.stepResponse
-        avgTime:responseResult.avgTime
-        dataMask:respLowMaskCombined  // 🔑 使用low + quality组合mask
-        vertRange:vertRange
-        vertBins:1000
-        sampleRate:sampleRate];
-
-    // 🔍 调试：打印respLow的数据范围
-    if (respLow && respLow.count > 0) {
-        double minVal = [respLow[0] doubleValue];
-        double maxVal = [respLow[0] doubleValue];
-        for (NSNumber *num in respLow) {
-            double v = [num doubleValue];
-            if (v < minVal) minVal = v;
-            if (v > maxVal) maxVal = v;
-        }
-        NSLog(@"🔍 [%@] respLow范围(质量过滤后): [%.3f, %.3f]，起点=%.3f，终点=%.3f",
-              axisName, minVal, maxVal, [respLow[0] doubleValue], [respLow[respLow.count-1] doubleValue]);
+    // 低/高输入分离 + 质量过滤（对应Python的low_high_mask / resp_quality / weighted_mode_avr）
+    // 由PIDTraceAnalyzer统一计算，外存分析时直接使用分析器给出的曲线
+    NSArray<NSNumber *> *respLow = curves.respLow;
+    NSArray<NSNumber *> *respHigh = curves.respHigh;
+    BOOL hasHighData = respHigh.count > 0;
+    NSInteger lowWindowCount = curves.lowWindowCount;
+    NSInteger highWindowCount = curves.highWindowCount;
+
+    // 记录摘要指标：低输入响应峰值与参与统计的窗口数
+    if (!_headlineMetrics) {
+        _headlineMetrics = [NSMutableDictionary dictionary];
     }
-
-    NSArray<NSNumber *> *respHigh = nil;
-    BOOL hasHighData = NO;
-
-    // 检查是否有高输入数据
-    NSInteger highWindowCount = 0;
-    for (NSNumber *maskVal in respHighMask) {
-        if ([maskVal doubleValue] > 0.5) {
-            highWindowCount++;
-        }
-    }
-
-    if (highWindowCount >= 10) {  // 至少10个窗口
-        NSLog(@"🔍 [%@] 开始计算高输入响应... (%ld窗口)", axisName, (long)highWindowCount);
-
-        // 🔥 新增：高输入响应也应用质量过滤
-        // 第一步：计算初始高输入响应
-        NSArray<NSNumber *> *respHighInitial = [PIDTraceAnalyzer weightedModeAverageWithStepResponse:
-            responseResult.stepResponse
-            avgTime:responseResult.avgTime
-            dataMask:respHighMask
-            vertRange:vertRange
-            vertBins:1000
-            sampleRate:sampleRate];
-
-        // 第二步：计算质量mask（使用同一个参考响应respLowInitial，因为所有窗口应该趋向同一个稳态响应）
-        NSArray<NSNumber *> *qualityMaskHigh = [PIDTraceAnalyzer calculateResponseQualityMask:
-            responseResult.stepResponse
-            referenceResponse:respLowInitial];
-
-        // 第三步：组合high mask和quality mask
-        NSArray<NSNumber *> *respHighMaskCombined = [PIDTraceAnalyzer combineMasks:respHighMask withMask:qualityMaskHigh];
-
-        // 第四步：使用组合后的mask重新计算最终高输入响应
-        respHigh = [PIDTraceAnalyzer weightedModeAverageWithStepResponse:
-            responseResult.stepResponse
-            avgTime:responseResult.avgTime
-            dataMask:respHighMaskCombined  // 🔑 使用high + quality组合mask
-            vertRange:vertRange
-            vertBins:1000
-            sampleRate:sampleRate];
-
-        hasHighData = YES;
-
-        // 🔍 调试：打印respHigh的数据范围
-        if (respHigh && respHigh.count > 0) {
-            double minVal = [respHigh[0] doubleValue];
-            double maxVal = minVal;
-            for (NSNumber *num in respHigh) {
-                double v = [num doubleValue];
-                if (v < minVal) minVal = v;
-                if (v > maxVal) maxVal = v;
-            }
-            NSLog(@"✅ [%@] 高输入响应计算成功 (%ld窗口)", axisName, (long)highWindowCount);
-            NSLog(@"🔍 [%@] respHigh范围: [%.3f, %.3f]，起点=%.3f，终点=%.3f",
-                  axisName, minVal, maxVal, [respHigh[0] doubleValue], [respHigh[respHigh.count-1] doubleValue]);
-        } else {
-            NSLog(@"⚠️ [%@] respHigh为空！", axisName);
-        }
-    } else {
-        NSLog(@"⚠️ %@: 高输入窗口数(%ld) < 10，跳过高输入曲线", axisName, (long)highWindowCount);
-    }
-
-    // 5. 准备图表数据
-    NSInteger lowWindowCount = 0;
-    for (NSNumber *maskVal in respLowMask) {
-        if ([maskVal doubleValue] > 0.5) {
-            lowWindowCount++;
-        }
+    NSString *metricPrefix = axisName.lowercaseString;
+    double respLowPeak = 0;
+    for (NSNumber *num in respLow) {
+        respLowPeak = MAX(respLowPeak, [num doubleValue]);
     }
+    _headlineMetrics[[metricPrefix stringByAppendingString:@".peak"]] = @(respLowPeak);
+    _headlineMetrics[[metricPrefix stringByAppendingString:@".lowWindows"]] = @(lowWindowCount);
+    _headlineMetrics[[metricPrefix stringByAppendingString:@".highWindows"]] = @(highWindowCount);
 
     // 降采样到100个点用于显示
     NSInteger displayPoints = 100;
@@ -1031,45 +1298,10 @@
     NSLog(@"🔍 [噪声图] freqCategories.count = %lu", (unsigned long)freqCategories.count);
 
     // 使用真实的频谱幅度数据
-    // spectrum 是 [窗口][频率点] 的二维数组
-    // 我们需要对所有窗口的频谱取平均值，得到每个轴的单一频谱
-
-    // 辅助函数：计算频谱数组在所有窗口上的平均值
-    NSArray<NSNumber *> * (^averageSpectrumAcrossWindows)(NSArray<NSArray<NSNumber *> *> *) = ^ NSArray<NSNumber *> * (NSArray<NSArray<NSNumber *> *> *spectrumData) {
-        if (!spectrumData || spectrumData.count == 0) {
-            return @[];
-        }
-
-        NSInteger windowCount = spectrumData.count;
-        NSInteger freqCount = spectrumData[0].count;
-
-        NSMutableArray<NSNumber *> *avgSpectrum = [NSMutableArray arrayWithCapacity:freqCount];
-
-        for (NSInteger i = 0; i < freqCount; i++) {
-            double sum = 0.0;
-            NSInteger validCount = 0;
-
-            for (NSInteger w = 0; w < windowCount; w++) {
-                if (i < spectrumData[w].count) {
-                    sum += spectrumData[w][i].doubleValue;
-                    validCount++;
-                }
-            }
-
-            if (validCount > 0) {
-                [avgSpectrum addObject:@(sum / validCount)];
-            } else {
-                [avgSpectrum addObject:@0];
-            }
-        }
-
-        return [avgSpectrum copy];
-    };
-
-    // 获取各轴的平均频谱数据
-    NSArray<NSNumber *> *rollNoise = averageSpectrumAcrossWindows(_rollSpectrum.spectrum);
-    NSArray<NSNumber *> *pitchNoise = averageSpectrumAcrossWindows(_pitchSpectrum.spectrum);
-    NSArray<NSNumber *> *yawNoise = averageSpectrumAcrossWindows(_yawSpectrum.spectrum);
+    // 频谱分析已把每个窗口的 |Re| 流式累加为平均谱，这里不再遍历 [窗口][频率点] 矩阵
+    NSArray<NSNumber *> *rollNoise = _rollSpectrum.accumulator.averageSpectrum ?: @[];
+    NSArray<NSNumber *> *pitchNoise = _pitchSpectrum.accumulator.averageSpectrum ?: @[];
+    NSArray<NSNumber *> *yawNoise = _yawSpectrum.accumulator.averageSpectrum ?: @[];
 
     NSLog(@"🔍 [噪声图] rollNoise.count = %lu", (unsigned long)rollNoise.count);
     NSLog(@"🔍 [噪声图] pitchNoise.count = %lu", (unsigned long)pitchNoise.count);
@@ -1198,9 +1430,193 @@
     [chartView aa_drawChartWithChartModel:chartModel];
 }
 
+#pragma mark - 分析任务
+
+/**
+ * 开始新的分析任务：取消上一个任务，返回新任务的令牌
+ */
+- (PIDCancellationToken *)beginAnalysisTask {
+    [self.analysisToken cancel];
+    self.spectralCaches = nil;
+    self.sweepAnalyzer = nil;
+    self.axisResults = nil;
+    self.analysisToken = [[PIDCancellationToken alloc] init];
+    return self.analysisToken;
+}
+
+- (void)cancelAnalysis {
+    [self.analysisToken cancel];
+    self.analysisToken = nil;
+    [self endProgress];
+}
+
+/**
+ * 令牌是否仍属于当前任务（主线程）：已取消或已被新任务替换的结果不再应用
+ */
+- (BOOL)isCurrentAnalysisTask:(PIDCancellationToken *)token {
+    return !token.isCancelled && token == self.analysisToken;
+}
+
+#pragma mark - 参数扫描
+
+- (void)evaluateResponseParameterSets:(NSArray<PIDResponseParameters *> *)parameterSets
+                           completion:(void (^)(NSDictionary<NSNumber *, NSArray<PIDResponseCurves *> *> *axisCurves))completion {
+    NSDictionary<NSNumber *, PIDSpectralCache *> *spectralCaches = self.spectralCaches;
+    PIDTraceAnalyzer *analyzer = self.sweepAnalyzer;
+    NSArray<PIDResponseParameters *> *sets = [[NSArray alloc] initWithArray:parameterSets copyItems:YES];
+    if (!analyzer || spectralCaches.count == 0 || sets.count == 0) {
+        completion(@{});
+        return;
+    }
+
+    // 各轴并行；H、G在完整分析时已缓存，扫描只做信噪比掩码、维纳除法、逆FFT和分组
+    dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+        NSArray<NSNumber *> *axes = spectralCaches.allKeys;
+        NSMutableDictionary<NSNumber *, NSArray<PIDResponseCurves *> *> *axisCurves = [NSMutableDictionary dictionary];
+        PIDParallelForEach(axes.count, ^(size_t index) {
+            @autoreleasepool {
+                NSArray<PIDResponseCurves *> *curves = [analyzer responseCurvesWithSpectralCache:spectralCaches[axes[index]]
+                                                                                   parameterSets:sets];
+                if (curves) {
+                    @synchronized (axisCurves) {
+                        axisCurves[axes[index]] = curves;
+                    }
+                }
+            }
+        });
+
+        dispatch_async(dispatch_get_main_queue(), ^{
+            completion([axisCurves copy]);
+        });
+    });
+}
+
+#pragma mark - 多通道噪声频谱
+
+/**
+ * 累加器的平滑热力图转为噪声图数据（float矩阵）
+ */
+static PIDNoiseSpectrumData *PIDNoiseDataFromAccumulator(PIDSpectrumAccumulator *accumulator, NSString *name) {
+    if (!accumulator || accumulator.windowCount == 0) {
+        return nil;
+    }
+    return [PIDNoiseSpectrumData dataWithFrequencies:[accumulator heatmapFrequencies]
+                                       heatmapMatrix:[accumulator smoothedThrottleHeatmapMatrix]
+                                        throttleAxis:[accumulator throttleAxis]
+                                            axisName:name];
+}
+
+- (void)loadNoiseChannelsIntoChartView:(PIDNoiseChartView *)chartView
+                            completion:(void (^)(NSDictionary<NSString *, PIDNoiseSpectrumData *> *channelData))completion {
+    NSDictionary<NSNumber *, PIDSpectralCache *> *spectralCaches = self.spectralCaches;
+    PIDTraceAnalyzer *analyzer = self.sweepAnalyzer;
+    PIDCSVData *data = self.parsedData;
+    NSArray<PIDSpectrumResult *> *gyroSpectrums = @[_rollSpectrum ?: [[PIDSpectrumResult alloc] init],
+                                                    _pitchSpectrum ?: [[PIDSpectrumResult alloc] init],
+                                                    _yawSpectrum ?: [[PIDSpectrumResult alloc] init]];
+    // 三个轴的堆叠窗口划分相同，任取一个轴的频谱缓存作为窗口计划
+    PIDSpectralCache *cache = spectralCaches[@0] ?: spectralCaches.allValues.firstObject;
+    if (!analyzer || !cache || !data) {
+        if (completion) {
+            completion(@{});
+        }
+        return;
+    }
+
+    dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+        NSDictionary<NSString *, NSArray<NSNumber *> *> *sources = @{
+            @"axisD0": data.axisD0 ?: @[], @"axisD1": data.axisD1 ?: @[], @"axisD2": data.axisD2 ?: @[],
+            @"debug0": data.debug0 ?: @[], @"debug1": data.debug1 ?: @[],
+            @"debug2": data.debug2 ?: @[], @"debug3": data.debug3 ?: @[],
+            @"rcCommand0": data.rcCommand0 ?: @[], @"rcCommand1": data.rcCommand1 ?: @[],
+            @"rcCommand2": data.rcCommand2 ?: @[], @"rcCommand3": data.rcCommand3 ?: @[],
+        };
+        NSMutableArray<NSString *> *names = [NSMutableArray array];
+        NSMutableArray<NSData *> *columns = [NSMutableArray array];
+        for (NSString *name in [sources.allKeys sortedArrayUsingSelector:@selector(compare:)]) {
+            if (sources[name].count > 0) {
+                [names addObject:name];
+                [columns addObject:[cache.stackData columnFromSamples:sources[name]]];
+            }
+        }
+
+        NSMutableDictionary<NSString *, PIDNoiseSpectrumData *> *channelData = [NSMutableDictionary dictionary];
+        NSArray<PIDSpectrumAccumulator *> *accumulators = columns.count > 0
+            ? [analyzer spectrumAccumulatorsForChannels:columns time:data.timeSeconds spectralCache:cache]
+            : @[];
+        for (NSUInteger c = 0; c < accumulators.count; c++) {
+            PIDNoiseSpectrumData *noise = PIDNoiseDataFromAccumulator(accumulators[c], names[c]);
+            if (noise) {
+                channelData[names[c]] = noise;
+            }
+        }
+        for (NSInteger axis = 0; axis < 3; axis++) {
+            NSString *name = [NSString stringWithFormat:@"gyroADC%ld", (long)axis];
+            PIDNoiseSpectrumData *noise = PIDNoiseDataFromAccumulator(gyroSpectrums[axis].accumulator, name);
+            if (noise) {
+                channelData[name] = noise;
+            }
+        }
+
+        dispatch_async(dispatch_get_main_queue(), ^{
+            if (chartView && channelData.count > 0) {
+                NSMutableArray<PIDNoiseSpectrumData *> *gyro = [NSMutableArray arrayWithCapacity:3];
+                NSMutableArray<PIDNoiseSpectrumData *> *debug = [NSMutableArray arrayWithCapacity:3];
+                NSMutableArray<PIDNoiseSpectrumData *> *dTerm = [NSMutableArray arrayWithCapacity:3];
+                for (NSInteger axis = 0; axis < 3; axis++) {
+                    PIDNoiseSpectrumData *gyroData = channelData[[NSString stringWithFormat:@"gyroADC%ld", (long)axis]];
+                    PIDNoiseSpectrumData *debugData = channelData[[NSString stringWithFormat:@"debug%ld", (long)axis]];
+                    PIDNoiseSpectrumData *dTermData = channelData[[NSString stringWithFormat:@"axisD%ld", (long)axis]];
+                    if (gyroData) [gyro addObject:gyroData];
+                    if (debugData) [debug addObject:debugData];
+                    if (dTermData) [dTerm addObject:dTermData];
+                }
+                [chartView setGyroNoiseData:gyro
+                             debugNoiseData:debug
+                             dTermNoiseData:dTerm.count > 0 ? dTerm : nil];
+            }
+            if (completion) {
+                completion([channelData copy]);
+            }
+        });
+    });
+}
+
 #pragma mark - UI State
 
+/**
+ * 开始显示进度：返回新的遥测通道，状态文字以约15Hz刷新为"前缀 百分比"
+ */
+- (PIDProgressTelemetry *)beginProgressWithStatus:(NSString *)status {
+    [self endProgress];
+
+    PIDProgressTelemetry *telemetry = [[PIDProgressTelemetry alloc] init];
+    __weak typeof(self) weakSelf = self;
+    self.progressTelemetry = telemetry;
+    self.progressObserver = [telemetry addObserverWithInterval:0 handler:^(PIDTelemetrySnapshot snapshot) {
+        typeof(self) strongSelf = weakSelf;
+        if (!strongSelf || !strongSelf.progressObserver) {
+            return;
+        }
+        double fraction = PIDTelemetrySnapshotFraction(snapshot);
+        strongSelf.statusLabel.text = fraction >= 0
+            ? [NSString stringWithFormat:@"%@... %.0f%%", status, fraction * 100.0]
+            : [NSString stringWithFormat:@"%@...", status];
+    }];
+    return telemetry;
+}
+
+- (void)endProgress {
+    id<NSObject> observer = self.progressObserver;
+    self.progressObserver = nil;
+    if (observer) {
+        [self.progressTelemetry removeObserver:observer];
+    }
+    self.progressTelemetry = nil;
+}
+
 - (void)showAnalysisComplete {
+    [self endProgress];
     [_activityIndicator stopAnimating];
     _statusLabel.hidden = YES;
     _retryButton.hidden = YES;
@@ -1212,6 +1628,7 @@
 }
 
 - (void)showError:(NSString *)message {
+    [self endProgress];
     [_activityIndicator stopAnimating];
     _statusLabel.text = [NSString stringWithFormat:@"分析失败: %@", message ?: @"未知错误"];
     _statusLabel.hidden = NO;
@@ -1230,11 +1647,128 @@
 - (void)retryAnalysis {
     _statusLabel.hidden = YES;
     _retryButton.hidden = YES;
+
+    // 解析阶段就失败时需要重新走流水线
+    if (!_parsedData && _csvFilePath) {
+        [self parseAndAnalyze];
+        return;
+    }
     [self startAnalysis];
 }
 
 #pragma mark - Actions
 
+/**
+ * 显示多通道噪声图
+ * 完整分析保留了窗口频谱时直接批量计算；流水线分析的结果没有保留，先用已解析的数据重新分析
+ */
+- (void)showNoiseChannels {
+    if (!_parsedData || !_analysisFinished) {
+        return;
+    }
+
+    UIViewController *vc = [[UIViewController alloc] init];
+    vc.title = @"多通道噪声";
+    vc.view.backgroundColor = [UIColor systemBackgroundColor];
+    vc.navigationItem.rightBarButtonItem = [[UIBarButtonItem alloc]
+        initWithBarButtonSystemItem:UIBarButtonSystemItemDone
+        target:self
+        action:@selector(dismissPresentedChart)];
+
+    // 噪声图在初始化时按宽度排布网格：使用本页面的尺寸
+    PIDNoiseChartView *chartView = [[PIDNoiseChartView alloc] initWithFrame:self.view.bounds];
+    chartView.translatesAutoresizingMaskIntoConstraints = NO;
+    [vc.view addSubview:chartView];
+    [NSLayoutConstraint activateConstraints:@[
+        [chartView.topAnchor constraintEqualToAnchor:vc.view.safeAreaLayoutGuide.topAnchor],
+        [chartView.leadingAnchor constraintEqualToAnchor:vc.view.leadingAnchor],
+        [chartView.trailingAnchor constraintEqualToAnchor:vc.view.trailingAnchor],
+        [chartView.bottomAnchor constraintEqualToAnchor:vc.view.safeAreaLayoutGuide.bottomAnchor]
+    ]];
+
+    UINavigationController *nav = [[UINavigationController alloc] initWithRootViewController:vc];
+    [self presentViewController:nav animated:YES completion:nil];
+
+    if (self.spectralCaches.count > 0 && self.sweepAnalyzer) {
+        [self loadNoiseChannelsIntoChartView:chartView completion:nil];
+    } else {
+        self.pendingNoiseChannelsView = chartView;
+        [self startAnalysis];
+    }
+}
+
+- (void)dismissPresentedChart {
+    [self dismissViewControllerAnimated:YES completion:nil];
+}
+
+/**
+ * 显示各轴的响应-油门热力图（行：油门箱，列：响应时间）
+ * 热力图在分析完成时已经算好；没有逐窗口响应的轴只显示标题
+ */
+- (void)showThrottleResponse {
+    if (!_analysisFinished) {
+        return;
+    }
+
+    UIViewController *vc = [[UIViewController alloc] init];
+    vc.title = @"响应-油门热力图";
+    vc.view.backgroundColor = [UIColor systemBackgroundColor];
+    vc.navigationItem.rightBarButtonItem = [[UIBarButtonItem alloc]
+        initWithBarButtonSystemItem:UIBarButtonSystemItemDone
+        target:self
+        action:@selector(dismissPresentedChart)];
+
+    UIScrollView *scrollView = [[UIScrollView alloc] initWithFrame:vc.view.bounds];
+    scrollView.autoresizingMask = UIViewAutoresizingFlexibleWidth | UIViewAutoresizingFlexibleHeight;
+    [vc.view addSubview:scrollView];
+
+    // 热力图按当前尺寸生成图像：直接使用本页面的宽度排布
+    CGFloat width = self.view.bounds.size.width - 20;
+    CGFloat heatmapHeight = 300;
+    CGFloat spacing = 15;
+    for (NSInteger axis = 0; axis < 3; axis++) {
+        PIDAxisAnalysisResult *axisResult = axis < (NSInteger)_axisResults.count ? _axisResults[axis] : nil;
+        BOOL hasHeatmap = axisResult.responseHeatmap.count > 0;
+
+        PIDHeatmapConfig *config = [PIDHeatmapConfig defaultConfig];
+        config.xAxisLabel = @"Time (s)";
+        config.yAxisLabel = @"Throttle (%)";
+        NSString *axisName = axisResult.axisName ?: @[@"Roll", @"Pitch", @"Yaw"][axis];
+        config.title = hasHeatmap ? axisName : [NSString stringWithFormat:@"%@ (无逐窗口响应)", axisName];
+
+        PIDHeatmapView *heatmapView = [[PIDHeatmapView alloc]
+            initWithFrame:CGRectMake(10, spacing + axis * (heatmapHeight + spacing), width, heatmapHeight)
+                   config:config];
+        [scrollView addSubview:heatmapView];
+        if (hasHeatmap) {
+            heatmapView.xAxisValues = axisResult.responseTime;
+            heatmapView.yAxisValues = axisResult.throttleBins;
+            heatmapView.data = axisResult.responseHeatmap;
+        }
+    }
+    scrollView.contentSize = CGSizeMake(self.view.bounds.size.width, spacing + 3 * (heatmapHeight + spacing));
+
+    UINavigationController *nav = [[UINavigationController alloc] initWithRootViewController:vc];
+    [self presentViewController:nav animated:YES completion:nil];
+}
+
+- (NSString *)titleForResponseEstimator:(PIDResponseEstimator)estimator {
+    return estimator == PIDResponseEstimatorAveragedCrossSpectrum ? @"平均互谱" : @"维纳";
+}
+
+/**
+ * 切换阶跃响应估计方法并用已解析的数据重新分析
+ * 解析完成前（流水线分析）和外存分析没有保存的数据，只记录选择
+ */
+- (void)toggleResponseEstimator:(UIBarButtonItem *)sender {
+    _responseEstimator = _responseEstimator == PIDResponseEstimatorWiener
+        ? PIDResponseEstimatorAveragedCrossSpectrum : PIDResponseEstimatorWiener;
+    sender.title = [self titleForResponseEstimator:_responseEstimator];
+    if (_parsedData && _analysisFinished) {
+        [self startAnalysis];
+    }
+}
+
 /**
  * 导出响应图
  */
@@ -29,6 +29,11 @@ NS_ASSUME_NONNULL_BEGIN
 // 轴名称
 @property (nonatomic, copy) NSString *axisName;
 
+// 紧凑频谱矩阵（可选）：float行主序 [throttleIdx][freqIdx]，heatmapRows × frequencies.count
+// 多通道批量频谱直接给出该矩阵，不装箱；设置时绘图优先使用它，spectrumHeatmap为空数组
+@property (nonatomic, strong, nullable) NSData *heatmapMatrix;
+@property (nonatomic, assign) NSInteger heatmapRows;
+
 /**
  * 创建噪声频谱数据
  */
@@ -37,6 +42,15 @@ NS_ASSUME_NONNULL_BEGIN
                        throttleAxis:(NSArray<NSNumber *> *)throttleAxis
                           axisName:(NSString *)axisName;
 
+/**
+ * 用紧凑float矩阵创建噪声频谱数据
+ * @param heatmapMatrix float行主序 [throttleAxis.count][frequencies.count]（长度不足时返回nil）
+ */
++ (nullable instancetype)dataWithFrequencies:(NSArray<NSNumber *> *)frequencies
+                               heatmapMatrix:(NSData *)heatmapMatrix
+                                throttleAxis:(NSArray<NSNumber *> *)throttleAxis
+                                    axisName:(NSString *)axisName;
+
 @end
 
 /**
@@ -25,6 +25,23 @@
     return data;
 }
 
++ (instancetype)dataWithFrequencies:(NSArray<NSNumber *> *)frequencies
+                      heatmapMatrix:(NSData *)heatmapMatrix
+                       throttleAxis:(NSArray<NSNumber *> *)throttleAxis
+                           axisName:(NSString *)axisName {
+    NSUInteger cellCount = throttleAxis.count * frequencies.count;
+    if (heatmapMatrix.length < cellCount * sizeof(float)) {
+        return nil;
+    }
+    PIDNoiseSpectrumData *data = [self dataWithFrequencies:frequencies
+                                           spectrumHeatmap:@[]
+                                              throttleAxis:throttleAxis
+                                                  axisName:axisName];
+    data.heatmapMatrix = heatmapMatrix;
+    data.heatmapRows = (NSInteger)throttleAxis.count;
+    return data;
+}
+
 @end
 
 #pragma mark - PIDFilterPassData
@@ -298,26 +315,27 @@
 }
 
 /**
- * 🔥 更新单个噪声图 - 使用 AAChartKit 直方图
- * 简化方案：X轴=频率，Y轴=振幅，显示最大振幅包络线
+ * 每个频率点在所有油门位置上的最大振幅
+ * 紧凑矩阵按行直接在float上比较，不逐点取NSNumber
  */
-- (void)updateHeatmapAtRow:(NSInteger)row column:(NSInteger)col withData:(PIDNoiseSpectrumData *)data {
-    NSInteger index = row * 3 + col;
-
-    if (index >= _chartViews.count) return;
-
-    AAChartView *chartView = _chartViews[index];
+- (NSArray<NSNumber *> *)maxAmplitudesForData:(PIDNoiseSpectrumData *)data {
+    NSInteger frequencyCount = (NSInteger)data.frequencies.count;
+    NSMutableArray<NSNumber *> *maxAmplitudes = [NSMutableArray arrayWithCapacity:frequencyCount];
+
+    if (data.heatmapMatrix && data.heatmapRows > 0) {
+        const float *matrix = (const float *)data.heatmapMatrix.bytes;
+        for (NSInteger f = 0; f < frequencyCount; f++) {
+            float maxAmp = 0;
+            for (NSInteger t = 0; t < data.heatmapRows; t++) {
+                maxAmp = MAX(maxAmp, matrix[t * frequencyCount + f]);
+            }
+            [maxAmplitudes addObject:@(maxAmp)];
+        }
+        return maxAmplitudes;
+    }
 
-    // 🔧 简化数据：对每个频率点，取所有油门位置的最大振幅
-    // X轴=频率(Hz)，Y轴=振幅
     NSArray<NSArray<NSNumber *> *> *spectrumHeatmap = data.spectrumHeatmap;
-    NSArray<NSNumber *> *frequencies = data.frequencies;
-
-    // 只需要 frequencies.count 个数据点
-    NSMutableArray<NSNumber *> *maxAmplitudes = [NSMutableArray arrayWithCapacity:frequencies.count];
-
-    for (NSInteger f = 0; f < frequencies.count; f++) {
-        double frequency = [frequencies[f] doubleValue];
+    for (NSInteger f = 0; f < frequencyCount; f++) {
         double maxAmp = 0;
 
         // 遍历所有油门位置，找该频率下的最大振幅
@@ -333,6 +351,24 @@
 
         [maxAmplitudes addObject:@(maxAmp)];
     }
+    return maxAmplitudes;
+}
+
+/**
+ * 🔥 更新单个噪声图 - 使用 AAChartKit 直方图
+ * 简化方案：X轴=频率，Y轴=振幅，显示最大振幅包络线
+ */
+- (void)updateHeatmapAtRow:(NSInteger)row column:(NSInteger)col withData:(PIDNoiseSpectrumData *)data {
+    NSInteger index = row * 3 + col;
+
+    if (index >= _chartViews.count) return;
+
+    AAChartView *chartView = _chartViews[index];
+
+    // 🔧 简化数据：对每个频率点，取所有油门位置的最大振幅
+    // X轴=频率(Hz)，Y轴=振幅
+    NSArray<NSNumber *> *frequencies = data.frequencies;
+    NSArray<NSNumber *> *maxAmplitudes = [self maxAmplitudesForData:data];
 
     // 构造直方图数据
     // 🔧 AAChartKit 柱状图需要：categories (X轴标签) + data (Y轴数值数组)
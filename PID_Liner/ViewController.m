@@ -8,6 +8,8 @@
 #import "ViewController.h"
 #import "BlackboxDecoder.h"
 #import "CSVHistoryViewController.h"
+#import "PIDSessionCatalog.h"
+#import "PIDProgressTelemetry.h"
 #import <UniformTypeIdentifiers/UniformTypeIdentifiers.h>
 
 @interface ViewController ()
@@ -359,7 +361,24 @@
         startIndex = _selectedSessionIndex;
         endIndex = _selectedSessionIndex + 1;
     }
-    NSInteger totalSessions = endIndex - startIndex;
+    // 进度按Session在BBL中的字节范围计量：解码器没有进度回调，每个Session完成后累加
+    PIDProgressTelemetry *telemetry = [[PIDProgressTelemetry alloc] init];
+    for (NSInteger i = startIndex; i < endIndex; i++) {
+        BBLSessionInfo *session = _sessions[i];
+        [telemetry addBytesTotal:(int64_t)(session.endOffset - session.startOffset)];
+        [telemetry addRowsTotal:session.frameCount];
+    }
+    [telemetry setStage:PIDTelemetryStageDecode];
+
+    id<NSObject> progressObserver = [telemetry addObserverWithInterval:0 handler:^(PIDTelemetrySnapshot snapshot) {
+        if (snapshot.stage != PIDTelemetryStageDecode) {
+            return;
+        }
+        double fraction = MAX(PIDTelemetrySnapshotFraction(snapshot), 0.0);
+        self.progressView.progress = (float)fraction;
+        self.statusLabel.text = [NSString stringWithFormat:@"⏳ 转换中... %.0f%% (%lld帧)",
+                                 fraction * 100.0, snapshot.rowsDone];
+    }];
 
     // 后台线程执行转换（不阻塞UI）
     dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
@@ -378,16 +397,10 @@
             NSString *csvFileName = [self generateCSVFileName:self.currentBBLPath sessionIndex:session.logIndex];
             NSString *outputPath = [self.decoder.outputDirectory stringByAppendingPathComponent:csvFileName];
 
-            // 更新进度（当前Session/总Session数）
-            float currentProgress = (float)(i - startIndex + 1) / (float)totalSessions;
-            dispatch_async(dispatch_get_main_queue(), ^{
-                self.progressView.progress = currentProgress;
-                self.statusLabel.text = [NSString stringWithFormat:@"⏳ 转换中... %ld/%ld",
-                                        (long)(i - startIndex + 1), (long)totalSessions];
-            });
-
             // 执行解码
             int result = [self.decoder decodeFlightLog:self.currentBBLPath logIndex:session.logIndex];
+            [telemetry addBytesDone:(int64_t)(session.endOffset - session.startOffset)];
+            [telemetry addRowsDone:session.frameCount];
 
             if (result == 0) {
                 // 解码成功，重命名文件为新格式
@@ -405,11 +418,13 @@
 
                 // 重命名文件
                 if ([[NSFileManager defaultManager] moveItemAtPath:originalPath toPath:outputPath error:&error]) {
+                    [[PIDSessionCatalog sharedCatalog] indexFileAtPath:outputPath];
                     [generatedFiles addObject:csvFileName];
                     [logText appendFormat:@"   ✅ 生成: %@\n", csvFileName];
                     NSLog(@"✅ Session %ld 转换成功: %@", (long)i + 1, csvFileName);
                 } else {
                     // 如果重命名失败，使用原文件名
+                    [[PIDSessionCatalog sharedCatalog] indexFileAtPath:originalPath];
                     [generatedFiles addObject:originalFileName];
                     [logText appendFormat:@"   ✅ 生成: %@\n", originalFileName];
                     NSLog(@"⚠️ 重命名失败，使用原文件名: %@", error.localizedDescription);
@@ -421,7 +436,9 @@
             }
         }
 
-        // 更新UI（完成）
+        // 更新UI（完成）：先移除观察者，送达的最后一次更新仍是解码阶段（最后一个Session的进度）
+        [telemetry removeObserver:progressObserver];
+        [telemetry setStage:PIDTelemetryStageFinished];
         dispatch_async(dispatch_get_main_queue(), ^{
             self.convertButton.enabled = YES;
             self.sessionSelectButton.enabled = YES;
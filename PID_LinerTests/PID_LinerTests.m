@@ -6,6 +6,7 @@
 //
 
 #import <XCTest/XCTest.h>
+#import "PIDAlgorithmVerifier.h"
 
 @interface PID_LinerTests : XCTestCase
 
@@ -13,24 +14,23 @@
 
 @implementation PID_LinerTests
 
-- (void)setUp {
-    // Put setup code here. This method is called before the invocation of each test method in the class.
+/**
+ * 参考数据目录：测试包内的 ReferenceData 文件夹（资源被展平时为包的资源目录）
+ */
+- (NSString *)referenceDataPath {
+    NSBundle *bundle = [NSBundle bundleForClass:[self class]];
+    return [bundle pathForResource:@"ReferenceData" ofType:nil] ?: bundle.resourcePath;
 }
 
-- (void)tearDown {
-    // Put teardown code here. This method is called after the invocation of each test method in the class.
-}
-
-- (void)testExample {
-    // This is an example of a functional test case.
-    // Use XCTAssert and related functions to verify your tests produce the correct results.
-}
+- (void)testVerificationSuite {
+    PIDAlgorithmVerifier *verifier = [[PIDAlgorithmVerifier alloc] init];
+    PIDVerificationReport *report = [verifier runVerificationSuite:[self referenceDataPath]];
 
-- (void)testPerformanceExample {
-    // This is an example of a performance test case.
-    [self measureBlock:^{
-        // Put the code you want to measure the time of here.
-    }];
+    XCTAssertGreaterThan(report.totalTests, 0);
+    for (PIDVerificationResult *result in report.results) {
+        XCTAssertTrue(result.passed, @"%@", result.formattedDescription);
+    }
+    XCTAssertEqual(report.failedTests, 0, @"%@", [report generateTextReport]);
 }
 
 @end
@@ -0,0 +1,77 @@
+#!/usr/bin/env python3
+#
+#  generate_reference_fixtures.py
+#  PID_Liner
+#
+#  生成 PID_LinerTests/ReferenceData 下的参考数据（PIDAlgorithmVerifier 的 *_reference.json）
+#  参考结果来自numpy/scipy，与Python PID-Analyzer使用的实现相同
+#  用法: python3 generate_reference_fixtures.py
+#
+
+import json
+import os
+
+import numpy as np
+from scipy.ndimage import gaussian_filter1d
+
+OUTPUT_DIR = os.path.join(os.path.dirname(os.path.abspath(__file__)), "PID_LinerTests", "ReferenceData")
+
+# 固定种子：重新生成的文件内容不变，差异只来自参考实现本身
+SEED = 20251225
+
+
+def write_fixture(name, payload):
+    path = os.path.join(OUTPUT_DIR, name + "_reference.json")
+    with open(path, "w") as f:
+        json.dump(payload, f, separators=(",", ":"))
+        f.write("\n")
+    print("✅ %s (%d bytes)" % (os.path.relpath(path), os.path.getsize(path)))
+
+
+def test_signal(rng, n):
+    """正弦叠加白噪声，与陀螺仪信号的量级相当"""
+    t = np.arange(n)
+    return np.sin(t * 0.05) * 40.0 + np.sin(t * 0.71) * 5.0 + rng.standard_normal(n) * 2.0
+
+
+def fft_fixtures(rng):
+    """numpy.fft.rfft：2的幂、1秒窗口(8000 = 2^6·5^3)、3/5混合基、质数长度(Bluestein)、奇数长度"""
+    for n in (1024, 8000, 1000, 7919, 375):
+        x = test_signal(rng, n)
+        spectrum = np.fft.rfft(x)
+        write_fixture("fft_%d" % n, {
+            "testType": "fft",
+            "description": "numpy.fft.rfft, n=%d" % n,
+            "input": x.tolist(),
+            "real": spectrum.real.tolist(),
+            "imag": spectrum.imag.tolist(),
+        })
+
+
+def gaussian_fixtures(rng):
+    """scipy.ndimage.gaussian_filter1d：σ=1.5/8走直接卷积，σ=40（半径160）走Deriche递归，四种边界"""
+    n = 2000
+    for sigma in (1.5, 8.0, 40.0):
+        # 带直流分量的随机游走，边界处理的差异会直接体现在结果上
+        x = 10.0 + np.cumsum(rng.uniform(-1.0, 1.0, n))
+        outputs = {}
+        for mode in ("constant", "reflect", "nearest", "mirror"):
+            outputs[mode] = gaussian_filter1d(x, sigma, mode=mode).tolist()
+        write_fixture("gaussian_sigma%g" % sigma, {
+            "testType": "gaussian",
+            "description": "scipy.ndimage.gaussian_filter1d, n=%d, sigma=%g" % (n, sigma),
+            "sigma": sigma,
+            "input": x.tolist(),
+            "outputs": outputs,
+        })
+
+
+def main():
+    os.makedirs(OUTPUT_DIR, exist_ok=True)
+    rng = np.random.default_rng(SEED)
+    fft_fixtures(rng)
+    gaussian_fixtures(rng)
+
+
+if __name__ == "__main__":
+    main()